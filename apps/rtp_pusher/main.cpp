@@ -6,288 +6,640 @@
  * SPDX-License-Identifier: MIT
  */
 
+#include <signal.h>
+
+#include <algorithm>
+#include <atomic>
 #include <chrono>
-#include <fstream>
+#include <cstring>
+#include <functional>
+#include <iomanip>
 #include <iostream>
 #include <memory>
+#include <queue>
 #include <string>
 #include <thread>
 #include <vector>
 
 #include "lmcore/data_buffer.h"
+#include "lmcore/mapped_file.h"
+#include "lmrtsp/clock.h"
+#include "lmrtsp/cpu_affinity.h"
+#include "lmrtsp/frame_classifier.h"
+#include "lmrtsp/lmrtsp_logger.h"
 #include "lmrtsp/media_types.h"
 #include "lmrtsp/rtp_source_session.h"
 #include "lmrtsp/transport_config.h"
 
 using namespace lmshao::lmrtsp;
 
-class H264FileSender {
+std::atomic<bool> g_running{true};
+
+void SignalHandler(int signal)
+{
+    std::cout << "\nReceived signal " << signal << ", shutting down..." << std::endl;
+    g_running = false;
+}
+
+struct Destination {
+    std::string ip;
+    uint16_t port = 0;
+};
+
+struct PusherOptions {
+    std::string file;
+    std::vector<Destination> destinations; // Streams are spread round-robin over the destinations
+    uint32_t fps = 24;
+    size_t streams = 1;              // Streams pushed in parallel
+    uint16_t port_step = 0;          // Port offset between streams sharing a destination, 0 sends them to one port
+    uint32_t ssrc_base = 0x10000000; // Stream i uses ssrc_base + i
+    size_t threads = 0;              // Sender threads, 0 for min(streams, hardware threads)
+    std::vector<int> cpus;           // Sender thread i is pinned to cpus[i % size]
+    bool io_uring = false;           // io_uring backend, submits each frame's packets in one batch
+    bool loop = false;               // Restart at the first frame instead of stopping at the end of the file
+    uint32_t duration_s = 0;         // Stop after this many seconds, 0 runs until the end of the file or Ctrl+C
+    uint32_t report_interval_s = 1;
+    uint32_t spin_us = 200; // Busy-wait this long before each deadline instead of sleeping through it
+    uint32_t mtu = 1400;
+};
+
+/**
+ * Access units of an H.264 Annex B file, built once from the mapped file and shared read-only by every stream.
+ * IDR access units carry the most recent SPS and PPS in front, so a receiver can join at any key frame.
+ */
+class FrameIndex {
 public:
-    H264FileSender(const std::string &file_path, const std::string &dest_ip, uint16_t dest_port, uint32_t fps = 24)
-        : file_path_(file_path), dest_ip_(dest_ip), dest_port_(dest_port), frame_rate_(fps)
+    struct Frame {
+        std::shared_ptr<lmshao::lmcore::DataBuffer> data;
+        VideoParam video_param; // Picture type, classified once when the index is built
+    };
+
+    bool Build(const std::string &path)
     {
+        auto mapped_file = lmshao::lmcore::MappedFile::Open(path);
+        if (!mapped_file || !mapped_file->IsValid()) {
+            std::cerr << "Failed to map H.264 file: " << path << std::endl;
+            return false;
+        }
+
+        const uint8_t *data = mapped_file->Data();
+        const uint8_t *end = data + mapped_file->Size();
+
+        const uint8_t *nalu = FindStartCode(data, end);
+        while (nalu < end) {
+            nalu += (nalu[2] == 1) ? 3 : 4;
+            const uint8_t *next = FindStartCode(nalu, end);
+            const uint8_t *nalu_end = next;
+            // Leading zero of a 4-byte start code and trailing_zero_8bits belong to neither NALU
+            while (nalu_end > nalu && nalu_end[-1] == 0) {
+                --nalu_end;
+            }
+            if (nalu_end > nalu) {
+                AddNalu(nalu, static_cast<size_t>(nalu_end - nalu));
+            }
+            nalu = next;
+        }
+        FlushAccessUnit();
+
+        if (frames_.empty()) {
+            std::cerr << "No H.264 frames found in " << path << std::endl;
+            return false;
+        }
+        return true;
     }
 
-    bool Initialize()
+    const std::vector<Frame> &Frames() const { return frames_; }
+    size_t TotalBytes() const { return total_bytes_; }
+    size_t KeyFrameCount() const { return key_frames_; }
+
+private:
+    // Returns the first byte of the next 00 00 01 or 00 00 00 01 start code, or end
+    static const uint8_t *FindStartCode(const uint8_t *begin, const uint8_t *end)
     {
-        // Open H.264 file
-        file_.open(file_path_, std::ios::binary);
-        if (!file_.is_open()) {
-            std::cerr << "Failed to open H.264 file: " << file_path_ << std::endl;
-            return false;
+        const uint8_t *p = begin + 2;
+        while (p < end) {
+            p = static_cast<const uint8_t *>(memchr(p, 0x01, static_cast<size_t>(end - p)));
+            if (!p) {
+                return end;
+            }
+            if (p[-1] == 0 && p[-2] == 0) {
+                return (p - 3 >= begin && p[-3] == 0) ? p - 3 : p - 2;
+            }
+            p += 3;
+        }
+        return end;
+    }
+
+    void AddNalu(const uint8_t *nalu, size_t size)
+    {
+        uint8_t nalu_type = nalu[0] & 0x1F;
+        switch (nalu_type) {
+            case 7: // SPS
+                FlushAccessUnit();
+                sps_.assign(nalu, nalu + size);
+                break;
+            case 8: // PPS
+                FlushAccessUnit();
+                pps_.assign(nalu, nalu + size);
+                break;
+            case 1: // Non-IDR slice
+            case 5: // IDR slice
+            {
+                // first_mb_in_slice is ue(v), a 1 bit in front means 0, the first slice of a new picture
+                bool first_slice = size < 2 || (nalu[1] & 0x80) != 0;
+                if (first_slice) {
+                    FlushAccessUnit();
+                }
+                if (access_unit_.empty() && nalu_type == 5 && !sps_.empty() && !pps_.empty()) {
+                    AppendNalu(sps_.data(), sps_.size());
+                    AppendNalu(pps_.data(), pps_.size());
+                }
+                AppendNalu(nalu, size);
+                key_frame_ = key_frame_ || nalu_type == 5;
+                break;
+            }
+            default: // SEI, AUD and others are not sent, same as before
+                break;
         }
+    }
+
+    void AppendNalu(const uint8_t *nalu, size_t size)
+    {
+        static const uint8_t start_code[] = {0x00, 0x00, 0x00, 0x01};
+        access_unit_.insert(access_unit_.end(), start_code, start_code + sizeof(start_code));
+        access_unit_.insert(access_unit_.end(), nalu, nalu + size);
+    }
+
+    void FlushAccessUnit()
+    {
+        if (access_unit_.empty()) {
+            return;
+        }
+        Frame frame;
+        frame.data = lmshao::lmcore::DataBuffer::Create(access_unit_.size());
+        frame.data->Append(access_unit_.data(), access_unit_.size());
+        classifier_.Classify(access_unit_.data(), access_unit_.size(), frame.video_param);
+        frame.video_param.is_key_frame = key_frame_;
+        frames_.push_back(std::move(frame));
+
+        total_bytes_ += access_unit_.size();
+        key_frames_ += key_frame_ ? 1 : 0;
+        access_unit_.clear();
+        key_frame_ = false;
+    }
+
+    std::vector<Frame> frames_;
+    size_t total_bytes_ = 0;
+    size_t key_frames_ = 0;
+
+    // Parser state
+    std::vector<uint8_t> sps_;
+    std::vector<uint8_t> pps_;
+    std::vector<uint8_t> access_unit_;
+    bool key_frame_ = false;
+    FrameClassifier classifier_{MediaType::H264};
+};
+
+/**
+ * Pacing error histogram with 1 us buckets, written by one sender thread and read by the reporter. Counters only
+ * grow, the reporter takes the difference of two snapshots for per-interval figures
+ */
+class PacingStats {
+public:
+    static constexpr size_t BUCKETS = 20000; // Errors of 20 ms and more land in the last bucket
+
+    void Record(int64_t error_ns, size_t bytes)
+    {
+        int64_t error_us = std::max<int64_t>(error_ns, 0) / 1000;
+        buckets_[std::min<size_t>(static_cast<size_t>(error_us), BUCKETS - 1)].fetch_add(1, std::memory_order_relaxed);
+        error_sum_us_.fetch_add(static_cast<uint64_t>(error_us), std::memory_order_relaxed);
+        frames_.fetch_add(1, std::memory_order_relaxed);
+        bytes_.fetch_add(bytes, std::memory_order_relaxed);
+    }
+
+    void RecordFailure() { failures_.fetch_add(1, std::memory_order_relaxed); }
+
+    uint64_t Frames() const { return frames_.load(std::memory_order_relaxed); }
+    uint64_t Bytes() const { return bytes_.load(std::memory_order_relaxed); }
+    uint64_t Failures() const { return failures_.load(std::memory_order_relaxed); }
+    uint64_t ErrorSumUs() const { return error_sum_us_.load(std::memory_order_relaxed); }
+    uint64_t Bucket(size_t index) const { return buckets_[index].load(std::memory_order_relaxed); }
 
-        // Configure RTP source session
+private:
+    std::atomic<uint64_t> buckets_[BUCKETS] = {};
+    std::atomic<uint64_t> error_sum_us_{0};
+    std::atomic<uint64_t> frames_{0};
+    std::atomic<uint64_t> bytes_{0};
+    std::atomic<uint64_t> failures_{0};
+};
+
+class PushStream {
+public:
+    PushStream(size_t index, const Destination &destination, uint32_t ssrc)
+        : index_(index), destination_(destination), ssrc_(ssrc)
+    {
+    }
+
+    bool Initialize(const PusherOptions &options)
+    {
         RtpSourceSessionConfig config;
-        config.session_id = "h264_sender_session";
-        config.ssrc = 0; // Auto-generate
+        config.session_id = "rtp_pusher_" + std::to_string(index_);
+        config.ssrc = ssrc_;
         config.video_type = MediaType::H264;
         config.video_payload_type = 96;
-        config.mtu_size = 1400;
+        config.mtu_size = options.mtu;
         config.enable_rtcp = false;
 
-        // Configure UDP transport
         config.transport.type = TransportConfig::Type::UDP;
-        config.transport.client_ip = dest_ip_;
-        config.transport.client_rtp_port = dest_port_;
+        config.transport.client_ip = destination_.ip;
+        config.transport.client_rtp_port = destination_.port;
+        if (options.io_uring) {
+            config.transport.backend = TransportConfig::Backend::IO_URING;
+        } else {
+            // One sendmmsg per frame on the default sockets too
+            config.transport.batch_send = true;
+        }
 
-        // Initialize RTP session
-        rtpSession_ = std::make_unique<RtpSourceSession>();
-        if (!rtpSession_->Initialize(config)) {
-            std::cerr << "Failed to initialize RTP source session" << std::endl;
+        session_ = std::make_unique<RtpSourceSession>();
+        if (!session_->Initialize(config) || !session_->Start()) {
+            std::cerr << "Failed to start stream " << index_ << " to " << destination_.ip << ":" << destination_.port
+                      << std::endl;
             return false;
         }
 
-        std::cout << "RTP sender initialized successfully" << std::endl;
-        std::cout << "Destination: " << dest_ip_ << ":" << dest_port_ << std::endl;
-        std::cout << "H.264 file: " << file_path_ << std::endl;
-
+        // The session packetizes synchronously, so one MediaFrame is reused for every send
+        frame_ = std::make_shared<MediaFrame>();
+        frame_->media_type = MediaType::H264;
         return true;
     }
 
-    bool Start()
+    bool Send(const FrameIndex::Frame &frame, uint32_t timestamp)
     {
-        if (!rtpSession_->Start()) {
-            std::cerr << "Failed to start RTP session" << std::endl;
-            return false;
-        }
-
-        std::cout << "Starting H.264 file streaming..." << std::endl;
-        return SendFile();
+        frame_->data = frame.data;
+        frame_->timestamp = timestamp;
+        frame_->video_param = frame.video_param;
+        return session_->SendFrame(frame_);
     }
 
     void Stop()
     {
-        if (rtpSession_) {
-            rtpSession_->Stop();
-        }
-        if (file_.is_open()) {
-            file_.close();
+        if (session_) {
+            session_->Stop();
         }
     }
 
+    // Schedule position, only touched by the owning sender thread
+    int64_t start_ns_ = 0;
+    uint64_t frames_sent_ = 0;
+
 private:
-    bool SendFile()
-    {
-        const uint32_t frame_interval_ms = 1000 / frame_rate_;
-        uint32_t timestamp = 0;
-        const uint32_t timestamp_increment = 90000 / frame_rate_; // 90kHz clock
-
-        std::vector<uint8_t> sps_data, pps_data; // Store SPS/PPS for reuse with video frames
-        std::vector<uint8_t> access_unit_buffer; // Buffer for building complete access unit
-        size_t frames_sent = 0;
-        size_t total_nalus_read = 0;
-
-        // Use absolute time points for accurate frame timing
-        auto start_time = std::chrono::steady_clock::now();
-        auto next_frame_time = start_time;
-
-        while (true) {
-            // Read next NALU from file
-            std::vector<uint8_t> nalu_data;
-            bool read_result = ReadNextNALU(nalu_data);
-
-            if (!read_result) {
-                std::cout << "End of file reached" << std::endl;
-                break;
-            }
+    size_t index_;
+    Destination destination_;
+    uint32_t ssrc_;
+    std::unique_ptr<RtpSourceSession> session_;
+    std::shared_ptr<MediaFrame> frame_;
+};
 
-            if (nalu_data.empty()) {
-                continue;
-            }
+class RtpPusher {
+public:
+    explicit RtpPusher(const PusherOptions &options) : options_(options) {}
 
-            total_nalus_read++;
-            uint8_t nalu_type = nalu_data[0] & 0x1F;
+    bool Initialize()
+    {
+        if (!index_.Build(options_.file)) {
+            return false;
+        }
+        std::cout << "Indexed " << index_.Frames().size() << " frames (" << index_.KeyFrameCount() << " key frames, "
+                  << index_.TotalBytes() << " bytes) from " << options_.file << std::endl;
+
+        size_t destination_count = options_.destinations.size();
+        for (size_t i = 0; i < options_.streams; ++i) {
+            Destination destination = options_.destinations[i % destination_count];
+            destination.port = static_cast<uint16_t>(destination.port + (i / destination_count) * options_.port_step);
+            auto stream = std::make_unique<PushStream>(i, destination, options_.ssrc_base + static_cast<uint32_t>(i));
+            if (!stream->Initialize(options_)) {
+                return false;
+            }
+            streams_.push_back(std::move(stream));
+        }
 
-            // Handle different NALU types according to H.264 standard
-            if (nalu_type == 7) { // SPS (Sequence Parameter Set)
-                sps_data = nalu_data;
-                std::cout << "Stored SPS (" << sps_data.size() << " bytes)" << std::endl;
-                continue;
-            } else if (nalu_type == 8) { // PPS (Picture Parameter Set)
-                pps_data = nalu_data;
-                std::cout << "Stored PPS (" << pps_data.size() << " bytes)" << std::endl;
-                continue;
-            } else if (nalu_type == 6) { // SEI
-                continue;
-            } else if (nalu_type == 5 || nalu_type == 1) { // IDR or non-IDR frame
-                // Build complete access unit with proper H.264 structure
-                access_unit_buffer.clear();
-
-                // For IDR frames, prepend SPS and PPS to create complete access unit
-                if (nalu_type == 5 && !sps_data.empty() && !pps_data.empty()) {
-                    uint8_t start_code[] = {0x00, 0x00, 0x00, 0x01};
-                    access_unit_buffer.insert(access_unit_buffer.end(), start_code, start_code + 4);
-                    access_unit_buffer.insert(access_unit_buffer.end(), sps_data.begin(), sps_data.end());
-                    access_unit_buffer.insert(access_unit_buffer.end(), start_code, start_code + 4);
-                    access_unit_buffer.insert(access_unit_buffer.end(), pps_data.begin(), pps_data.end());
-                }
+        size_t threads = options_.threads;
+        if (threads == 0) {
+            threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+        }
+        threads = std::min(threads, streams_.size());
+        for (size_t i = 0; i < threads; ++i) {
+            stats_.push_back(std::make_unique<PacingStats>());
+        }
 
-                // Add video frame with H.264 start code
-                uint8_t start_code[] = {0x00, 0x00, 0x00, 0x01};
-                access_unit_buffer.insert(access_unit_buffer.end(), start_code, start_code + 4);
-                access_unit_buffer.insert(access_unit_buffer.end(), nalu_data.begin(), nalu_data.end());
-
-                // Create MediaFrame with complete access unit for RTP transmission
-                auto data_buffer = lmshao::lmcore::DataBuffer::Create(access_unit_buffer.size());
-                data_buffer->Append(access_unit_buffer.data(), access_unit_buffer.size());
-                auto media_frame = std::make_shared<MediaFrame>();
-                media_frame->data = data_buffer;
-                media_frame->timestamp = timestamp;
-                media_frame->media_type = MediaType::H264;
-                media_frame->video_param.is_key_frame = (nalu_type == 5);
-
-                // Send frame via RTP
-                if (!rtpSession_->SendFrame(media_frame)) {
-                    std::cerr << "Failed to send frame " << frames_sent << std::endl;
-                    break;
-                }
+        std::cout << "Pushing " << streams_.size() << " streams at " << options_.fps << " fps from " << threads
+                  << " threads" << (options_.io_uring ? " (io_uring)" : "") << std::endl;
+        return true;
+    }
 
-                frames_sent++;
-                if (frames_sent % 100 == 0) {
-                    std::cout << "Sent " << frames_sent << " frames (" << (nalu_type == 5 ? "IDR" : "P") << ")"
-                              << std::endl;
-                }
+    void Run()
+    {
+        // Streams start staggered across one frame interval so their bursts do not line up
+        int64_t interval_ns = 1000000000LL / options_.fps;
+        int64_t start_ns = FastMonotonicNs() + 100000000LL;
+        for (size_t i = 0; i < streams_.size(); ++i) {
+            int64_t offset_ns = static_cast<int64_t>(i) * interval_ns / static_cast<int64_t>(streams_.size());
+            streams_[i]->start_ns_ = start_ns + offset_ns;
+        }
 
-                // Update timestamp for next frame (90kHz clock)
-                timestamp += timestamp_increment;
+        active_workers_ = stats_.size();
+        std::vector<std::thread> workers;
+        for (size_t i = 0; i < stats_.size(); ++i) {
+            workers.emplace_back(&RtpPusher::SenderLoop, this, i);
+        }
 
-                // Calculate next frame time and sleep until then
-                next_frame_time += std::chrono::milliseconds(frame_interval_ms);
-                std::this_thread::sleep_until(next_frame_time);
+        auto run_start = std::chrono::steady_clock::now();
+        auto last_report = run_start;
+        PacingSnapshot start;
+        PacingSnapshot last = start;
+        while (g_running && active_workers_ > 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            auto now = std::chrono::steady_clock::now();
+            if (options_.duration_s > 0 && now - run_start >= std::chrono::seconds(options_.duration_s)) {
+                break;
+            }
+            if (now - last_report >= std::chrono::seconds(options_.report_interval_s)) {
+                PacingSnapshot current = Collect();
+                Report(std::chrono::duration<double>(now - run_start).count(),
+                       std::chrono::duration<double>(now - last_report).count(), current, last);
+                last = std::move(current);
+                last_report = now;
             }
         }
 
-        std::cout << "Total NALUs read: " << total_nalus_read << std::endl;
-        std::cout << "Total frames sent: " << frames_sent << std::endl;
-        return true;
+        stop_ = true;
+        for (auto &worker : workers) {
+            worker.join();
+        }
+
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - run_start).count();
+        std::cout << "Summary (whole run):" << std::endl;
+        Report(elapsed, elapsed, Collect(), start);
     }
 
-    bool ReadNextNALU(std::vector<uint8_t> &nalu_data)
+    void Stop()
     {
-        nalu_data.clear();
-        uint8_t byte;
-        std::vector<uint8_t> buffer;
+        for (auto &stream : streams_) {
+            stream->Stop();
+        }
+    }
 
-        // Look for the next start code
-        uint32_t start_code_candidate = 0;
-        bool found_start = false;
+private:
+    void SenderLoop(size_t worker)
+    {
+        if (!options_.cpus.empty()) {
+            CpuAffinity::PinCurrentThread({options_.cpus[worker % options_.cpus.size()]});
+        }
 
-        while (file_.read(reinterpret_cast<char *>(&byte), 1)) {
-            start_code_candidate = (start_code_candidate << 8) | byte;
+        PacingStats &stats = *stats_[worker];
+        const auto &frames = index_.Frames();
+        const int64_t spin_ns = static_cast<int64_t>(options_.spin_us) * 1000;
 
-            // Check for 4-byte start code (0x00000001)
-            if (start_code_candidate == 0x00000001) {
-                found_start = true;
-                break;
+        // Min-heap of (deadline, stream) over the streams this thread owns
+        using Deadline = std::pair<int64_t, PushStream *>;
+        std::priority_queue<Deadline, std::vector<Deadline>, std::greater<Deadline>> schedule;
+        for (size_t i = worker; i < streams_.size(); i += stats_.size()) {
+            schedule.emplace(streams_[i]->start_ns_, streams_[i].get());
+        }
+
+        while (!stop_ && !schedule.empty()) {
+            auto [deadline, stream] = schedule.top();
+            schedule.pop();
+
+            int64_t now = FastMonotonicNs();
+            if (deadline - now > spin_ns) {
+                std::this_thread::sleep_for(std::chrono::nanoseconds(deadline - now - spin_ns));
+            }
+            while ((now = FastMonotonicNs()) < deadline) {
+                if (stop_) {
+                    break;
+                }
             }
-            // Check for 3-byte start code (0x000001)
-            else if ((start_code_candidate & 0x00FFFFFF) == 0x000001) {
-                found_start = true;
+            if (stop_) {
                 break;
             }
-        }
 
-        if (!found_start) {
-            return false;
+            const auto &frame = frames[stream->frames_sent_ % frames.size()];
+            // Timestamps and deadlines from the exact ratio, a truncated per-frame step drifts whenever fps does not
+            // divide 90000 or 1e9 (e.g. 90000 / 7)
+            uint32_t timestamp = static_cast<uint32_t>(stream->frames_sent_ * 90000 / options_.fps);
+            if (stream->Send(frame, timestamp)) {
+                stats.Record(now - deadline, frame.data->Size());
+            } else {
+                stats.RecordFailure();
+            }
+
+            ++stream->frames_sent_;
+            if (!options_.loop && stream->frames_sent_ >= frames.size()) {
+                continue;
+            }
+            // Deadlines come from the frame count, not the previous send, so late sends do not accumulate drift
+            uint64_t offset_ns = stream->frames_sent_ * 1000000000ULL / options_.fps;
+            int64_t next = stream->start_ns_ + static_cast<int64_t>(offset_ns);
+            schedule.emplace(next, stream);
         }
 
-        // Now read NALU data until next start code or EOF
-        uint32_t next_start_candidate = 0;
+        --active_workers_;
+    }
 
-        while (file_.read(reinterpret_cast<char *>(&byte), 1)) {
-            next_start_candidate = (next_start_candidate << 8) | byte;
+    // Counters of all sender threads at one point in time
+    struct PacingSnapshot {
+        uint64_t frames = 0;
+        uint64_t bytes = 0;
+        uint64_t failures = 0;
+        uint64_t error_sum_us = 0;
+        std::vector<uint64_t> histogram = std::vector<uint64_t>(PacingStats::BUCKETS, 0);
+    };
 
-            // Check for next start code
-            if (next_start_candidate == 0x00000001) {
-                file_.seekg(-4, std::ios::cur);
-                break;
-            } else if ((next_start_candidate & 0x00FFFFFF) == 0x000001) {
-                file_.seekg(-3, std::ios::cur);
-                break;
+    PacingSnapshot Collect() const
+    {
+        PacingSnapshot snapshot;
+        for (const auto &stats : stats_) {
+            snapshot.frames += stats->Frames();
+            snapshot.bytes += stats->Bytes();
+            snapshot.failures += stats->Failures();
+            snapshot.error_sum_us += stats->ErrorSumUs();
+            for (size_t i = 0; i < PacingStats::BUCKETS; ++i) {
+                snapshot.histogram[i] += stats->Bucket(i);
             }
+        }
+        return snapshot;
+    }
 
-            buffer.push_back(byte);
+    // Figures for the frames sent between the two snapshots
+    void Report(double elapsed, double interval, const PacingSnapshot &current, const PacingSnapshot &previous)
+    {
+        uint64_t frames = current.frames - previous.frames;
+        uint64_t p99_us = 0;
+        uint64_t max_us = 0;
+        uint64_t counted = 0;
+        for (size_t i = 0; i < PacingStats::BUCKETS; ++i) {
+            uint64_t count = current.histogram[i] - previous.histogram[i];
+            if (count == 0) {
+                continue;
+            }
+            max_us = i;
+            if (counted * 100 < frames * 99) {
+                counted += count;
+                p99_us = i;
+            }
         }
 
-        nalu_data = buffer;
-        return !nalu_data.empty();
+        double fps = frames / interval;
+        double mbps = (current.bytes - previous.bytes) * 8.0 / interval / 1000000.0;
+        double target_fps = static_cast<double>(options_.fps) * streams_.size();
+        uint64_t error_sum_us = current.error_sum_us - previous.error_sum_us;
+        std::cout << std::fixed << std::setprecision(1) << "[" << std::setw(7) << elapsed << "s] "
+                  << "frames/s " << fps << " (target " << target_fps << "), " << mbps << " Mbit/s, pacing error mean "
+                  << (frames > 0 ? error_sum_us / frames : 0) << " us, p99 " << p99_us << " us, max " << max_us
+                  << " us, send failures " << current.failures - previous.failures << std::endl;
     }
 
-private:
-    std::string file_path_;
-    std::string dest_ip_;
-    uint16_t dest_port_;
-    uint32_t frame_rate_;
-    std::ifstream file_;
-    std::unique_ptr<RtpSourceSession> rtpSession_;
+    PusherOptions options_;
+    FrameIndex index_;
+    std::vector<std::unique_ptr<PushStream>> streams_;
+    std::vector<std::unique_ptr<PacingStats>> stats_;
+    std::atomic<bool> stop_{false};
+    std::atomic<size_t> active_workers_{0};
 };
 
 void PrintUsage(const char *program_name)
 {
-    std::cout << "Usage: " << program_name << " <h264_file> <dest_ip> <dest_port> [fps]" << std::endl;
-    std::cout << "  fps: Frame rate (default: 24)" << std::endl;
-    std::cout << "Example: " << program_name << " test.h264 192.168.1.100 5006 30" << std::endl;
+    std::cout << "Usage: " << program_name << " <h264_file> <dest_ip> <dest_port> [fps] [options]" << std::endl;
+    std::cout << "Options:" << std::endl;
+    std::cout << "  -f, --fps <n>           Frame rate per stream (default: 24)" << std::endl;
+    std::cout << "  -n, --streams <n>       Number of streams (default: 1)" << std::endl;
+    std::cout << "  --dest <ip:port>        Additional destination, streams are spread round-robin" << std::endl;
+    std::cout << "  --port-step <n>         Port offset between streams sharing a destination" << std::endl;
+    std::cout << "                          (default: 0, all streams on one port told apart by SSRC)" << std::endl;
+    std::cout << "  --ssrc-base <n>         SSRC of the first stream, stream i uses base + i (default: 0x10000000)"
+              << std::endl;
+    std::cout << "  -t, --threads <n>       Sender threads (default: min(streams, hardware threads))" << std::endl;
+    std::cout << "  --cpus <list>           Pin sender threads to CPUs, e.g. 0-3,8" << std::endl;
+    std::cout << "  --io-uring              Submit each frame's packets through the io_uring backend instead of"
+              << std::endl;
+    std::cout << "                          one sendmmsg per frame on the default sockets" << std::endl;
+    std::cout << "  --loop                  Restart the file at its end" << std::endl;
+    std::cout << "  -d, --duration <s>      Stop after this many seconds" << std::endl;
+    std::cout << "  --report <s>            Report interval (default: 1)" << std::endl;
+    std::cout << "  --spin-us <n>           Busy-wait before each deadline for accurate pacing (default: 200)"
+              << std::endl;
+    std::cout << "  --mtu <n>               RTP packet size limit (default: 1400)" << std::endl;
+    std::cout << "  -h, --help              Show this help message" << std::endl;
+    std::cout << "Examples:" << std::endl;
+    std::cout << "  " << program_name << " test.h264 192.168.1.100 5006 30" << std::endl;
+    std::cout << "  " << program_name << " test.h264 192.168.1.100 5006 -n 500 --port-step 2 --loop -d 60"
+              << std::endl;
+}
+
+bool ParseDestination(const std::string &text, Destination &destination)
+{
+    size_t colon = text.rfind(':');
+    if (colon == std::string::npos || colon == 0) {
+        return false;
+    }
+    destination.ip = text.substr(0, colon);
+    unsigned long port = std::stoul(text.substr(colon + 1));
+    if (port == 0 || port > 65535) {
+        return false;
+    }
+    destination.port = static_cast<uint16_t>(port);
+    return true;
 }
 
 int main(int argc, char *argv[])
 {
     try {
-        if (argc < 4 || argc > 5) {
-            PrintUsage(argv[0]);
-            return 1;
+        PusherOptions options;
+        std::vector<std::string> positional;
+        std::vector<Destination> extra_destinations;
+
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            bool has_value = i + 1 < argc;
+            if (arg == "-h" || arg == "--help") {
+                PrintUsage(argv[0]);
+                return 0;
+            } else if ((arg == "-f" || arg == "--fps") && has_value) {
+                options.fps = static_cast<uint32_t>(std::stoul(argv[++i]));
+            } else if ((arg == "-n" || arg == "--streams") && has_value) {
+                options.streams = std::stoul(argv[++i]);
+            } else if (arg == "--dest" && has_value) {
+                Destination destination;
+                if (!ParseDestination(argv[++i], destination)) {
+                    std::cerr << "Invalid destination: " << argv[i] << std::endl;
+                    return 1;
+                }
+                extra_destinations.push_back(destination);
+            } else if (arg == "--port-step" && has_value) {
+                options.port_step = static_cast<uint16_t>(std::stoul(argv[++i]));
+            } else if (arg == "--ssrc-base" && has_value) {
+                options.ssrc_base = static_cast<uint32_t>(std::stoul(argv[++i], nullptr, 0));
+            } else if ((arg == "-t" || arg == "--threads") && has_value) {
+                options.threads = std::stoul(argv[++i]);
+            } else if (arg == "--cpus" && has_value) {
+                if (!CpuAffinity::ParseCpuList(argv[++i], options.cpus)) {
+                    std::cerr << "Invalid CPU list: " << argv[i] << std::endl;
+                    return 1;
+                }
+            } else if (arg == "--io-uring") {
+                options.io_uring = true;
+            } else if (arg == "--loop") {
+                options.loop = true;
+            } else if ((arg == "-d" || arg == "--duration") && has_value) {
+                options.duration_s = static_cast<uint32_t>(std::stoul(argv[++i]));
+            } else if (arg == "--report" && has_value) {
+                options.report_interval_s = static_cast<uint32_t>(std::stoul(argv[++i]));
+            } else if (arg == "--spin-us" && has_value) {
+                options.spin_us = static_cast<uint32_t>(std::stoul(argv[++i]));
+            } else if (arg == "--mtu" && has_value) {
+                options.mtu = static_cast<uint32_t>(std::stoul(argv[++i]));
+            } else if (!arg.empty() && arg[0] != '-') {
+                positional.push_back(arg);
+            } else {
+                std::cerr << "Unknown option: " << arg << std::endl;
+                PrintUsage(argv[0]);
+                return 1;
+            }
         }
 
-        std::string h264_file = argv[1];
-        std::string dest_ip = argv[2];
-        uint16_t dest_port = static_cast<uint16_t>(std::stoi(argv[3]));
-        uint32_t fps = (argc == 5) ? static_cast<uint32_t>(std::stoi(argv[4])) : 24;
-
-        std::cout << "RTP H.264 File Sender" << std::endl;
-        std::cout << "=====================" << std::endl;
-        std::cout << "Frame rate: " << fps << " FPS" << std::endl;
-
-        H264FileSender sender(h264_file, dest_ip, dest_port, fps);
-
-        if (!sender.Initialize()) {
-            std::cerr << "Failed to initialize sender" << std::endl;
+        if (positional.size() < 3 || positional.size() > 4) {
+            PrintUsage(argv[0]);
             return 1;
         }
-
-        std::cout << "About to start streaming..." << std::endl;
-        if (!sender.Start()) {
-            std::cerr << "Failed to start streaming" << std::endl;
+        options.file = positional[0];
+        options.destinations.push_back({positional[1], static_cast<uint16_t>(std::stoi(positional[2]))});
+        options.destinations.insert(options.destinations.end(), extra_destinations.begin(), extra_destinations.end());
+        if (positional.size() == 4) {
+            options.fps = static_cast<uint32_t>(std::stoul(positional[3]));
+        }
+        if (options.fps == 0 || options.streams == 0 || options.report_interval_s == 0) {
+            std::cerr << "fps, streams and report interval must be positive" << std::endl;
             return 1;
         }
 
-        std::cout << "Streaming completed, about to stop sender..." << std::endl;
-        sender.Stop();
-        std::cout << "Sender stopped, waiting for callbacks to complete..." << std::endl;
+        // Per-frame library logs would dominate the send path at load-test rates
+        InitLmrtspLogger(lmshao::lmcore::LogLevel::kWarn);
+        signal(SIGINT, SignalHandler);
+        signal(SIGTERM, SignalHandler);
 
-        // Sleep to ensure all callbacks complete before main process exits
-        std::this_thread::sleep_for(std::chrono::seconds(3));
-        std::cout << "Wait completed, about to exit main..." << std::endl;
+        std::cout << "RTP H.264 Pusher" << std::endl;
+        std::cout << "================" << std::endl;
 
+        RtpPusher pusher(options);
+        if (!pusher.Initialize()) {
+            std::cerr << "Failed to initialize pusher" << std::endl;
+            pusher.Stop();
+            return 1;
+        }
+
+        pusher.Run();
+        pusher.Stop();
         return 0;
     } catch (const std::exception &e) {
         std::cerr << "Exception in main: " << e.what() << std::endl;
@@ -296,4 +648,4 @@ int main(int argc, char *argv[])
         std::cerr << "Unknown exception in main" << std::endl;
         return 1;
     }
-}
\ No newline at end of file
+}
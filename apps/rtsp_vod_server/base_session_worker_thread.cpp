@@ -8,11 +8,22 @@
 
 #include "base_session_worker_thread.h"
 
+#include <lmrtsp/rtsp_server.h>
+
+#include <algorithm>
 #include <iostream>
 
+namespace {
+constexpr int64_t MAX_SLEEP_US = 10000;          // Recheck the session state at least every 10 ms
+constexpr int64_t MAX_LATENESS_US = 1000000;     // Further behind, the schedule moves instead of bursting
+constexpr int64_t MAX_PTS_STEP_NS = 10000000000; // Larger pts jumps are discontinuities
+constexpr int64_t KERNEL_PACING_LEAD_US = 5000;  // Kernel-paced units are handed over this early
+} // namespace
+
 BaseSessionWorkerThread::BaseSessionWorkerThread(std::shared_ptr<RtspServerSession> session,
                                                  const std::string &file_path)
-    : session_(session), file_path_(file_path), running_(false), should_stop_(false), data_sent_(0), bytes_sent_(0)
+    : session_(session), file_path_(file_path), running_(false), should_stop_(false), data_sent_(0), bytes_sent_(0),
+      read_ahead_underruns_(0)
 {
     if (session_) {
         session_id_ = session_->GetSessionId();
@@ -46,8 +57,36 @@ bool BaseSessionWorkerThread::Start()
     should_stop_.store(false);
     data_sent_.store(0);
     bytes_sent_.store(0);
-    start_time_ = std::chrono::steady_clock::now();
+    read_ahead_underruns_.store(0);
+    start_time_ = clock_->MonotonicUs();
     last_data_time_ = start_time_;
+    has_pending_ = false;
+    next_interval_time_ = start_time_;
+    pts_offset_ns_ = 0;
+    last_pts_ns_ = -1;
+    last_pts_step_ns_ = 0;
+    pts_generation_ = generation_.load();
+    cpu_account_ = session_->GetCpuAccount(GetTrackIndex());
+
+    // Send from the session's NUMA node and read ahead on the same node, so both allocate node-local memory
+    int home_cpu = session_->GetHomeCpu();
+    int node = -1;
+    cpus_.clear();
+    if (home_cpu >= 0) {
+        if (auto server = session_->GetRTSPServer().lock()) {
+            cpus_ = CpuAffinity::GetNodeCpus(server->GetCpuAffinity().sender_cpus, home_cpu);
+        }
+        node = CpuAffinity::GetNumaNode(home_cpu);
+    }
+
+    // Size the read-ahead queue to cover the configured time ahead of the playout cursor
+    auto &pool = ReadAheadPool::GetInstance();
+    auto interval_us = std::max<int64_t>(GetDataInterval().count(), 1);
+    size_t capacity = static_cast<size_t>(pool.GetReadAheadMs()) * 1000 / static_cast<size_t>(interval_us);
+    read_ahead_ = std::make_unique<ReadAheadQueue>(std::clamp<size_t>(capacity, 4, 1024));
+    reader_eof_ = false;
+    read_ahead_id_ = pool.Register([this]() { FillReadAhead(); }, node);
+    pool.Schedule(read_ahead_id_);
 
     // Start worker thread
     worker_thread_ = std::make_unique<std::thread>(&BaseSessionWorkerThread::WorkerThreadFunc, this);
@@ -74,6 +113,11 @@ void BaseSessionWorkerThread::Stop()
 
     worker_thread_.reset();
 
+    // Wait for a running fill before the reader goes away
+    ReadAheadPool::GetInstance().Unregister(read_ahead_id_);
+    read_ahead_id_ = 0;
+    read_ahead_.reset();
+
     // Cleanup reader and file (implemented by derived class)
     CleanupReader();
     ReleaseFile();
@@ -81,14 +125,21 @@ void BaseSessionWorkerThread::Stop()
     running_.store(false);
 
     std::cout << "Worker thread stopped for session: " << session_id_ << ", stats: " << data_sent_.load()
-              << " data units, " << bytes_sent_.load() << " bytes" << std::endl;
+              << " data units, " << bytes_sent_.load() << " bytes, " << read_ahead_underruns_.load()
+              << " read-ahead underruns" << std::endl;
+
+    auto egress = session_->GetEgressStats(GetTrackIndex());
+    if (egress.dropped_frames > 0) {
+        std::cout << "Session " << session_id_ << " dropped " << egress.dropped_frames << " frames ("
+                  << egress.dropped_bytes << " bytes) over its egress caps, " << egress.dropped_non_reference
+                  << " non-reference" << std::endl;
+    }
 }
 
 void BaseSessionWorkerThread::WorkerThreadFunc()
 {
     std::cout << "Worker thread started for session: " << session_id_ << std::endl;
-
-    auto data_interval = GetDataInterval();
+    CpuAffinity::PinCurrentThread(cpus_);
 
     while (!should_stop_.load()) {
         // Check if session is still active
@@ -97,23 +148,49 @@ void BaseSessionWorkerThread::WorkerThreadFunc()
             break;
         }
 
-        auto current_time = std::chrono::steady_clock::now();
-        auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(current_time - last_data_time_);
+        int64_t current_time = clock_->MonotonicUs();
+
+        // A reset/seek after the unit was taken makes it stale as well
+        if (has_pending_ && pending_.generation != generation_.load()) {
+            has_pending_ = false;
+        }
 
-        // Send data if enough time has passed
-        if (elapsed >= data_interval) {
-            if (!SendNextData()) {
-                // End of file or error
-                HandleEOF();
+        if (!has_pending_) {
+            if (!TakeReadAhead(pending_)) {
+                // I/O stage fell behind, retry on the next tick
+                if (std::chrono::microseconds(current_time - last_data_time_) >= GetDataInterval()) {
+                    read_ahead_underruns_++;
+                }
+                clock_->SleepUs(100);
                 continue;
             }
+            has_pending_ = true;
+            pending_due_ = GetDueTime(pending_, current_time);
+            // Checked per unit, the transport drops back to userspace pacing when the kernel rejects departure times
+            kernel_pacing_ = session_->HasKernelPacing(GetTrackIndex());
+        }
 
-            last_data_time_ = current_time;
-            data_sent_++;
+        // Sleep until the unit is due, in slices so Stop() and teardown are noticed. Kernel-paced units go out
+        // early and the qdisc holds their packets until the due time
+        int64_t send_time = kernel_pacing_ ? pending_due_ - KERNEL_PACING_LEAD_US : pending_due_;
+        if (current_time < send_time) {
+            clock_->SleepUs(std::min(send_time - current_time, MAX_SLEEP_US));
+            continue;
         }
 
-        // Sleep for a short time to avoid busy waiting
-        std::this_thread::sleep_for(std::chrono::microseconds(100));
+        has_pending_ = false;
+        if (kernel_pacing_) {
+            // Half the interval keeps the frame's packets from bursting without running into the next frame
+            pending_.departure_ns = pending_due_ * 1000;
+            pending_.departure_span_ns = GetDataInterval().count() * 1000 / 2;
+        }
+        if (pending_.eof || !SendData(pending_)) {
+            // End of file or error
+            HandleEOF();
+            continue;
+        }
+        last_data_time_ = current_time;
+        data_sent_++;
     }
 
     std::cout << "Worker thread finished for session: " << session_id_ << std::endl;
@@ -143,8 +220,100 @@ void BaseSessionWorkerThread::HandleEOF()
 {
     // Default behavior: loop back to beginning
     std::cout << "Session " << session_id_ << " reached EOF, looping back" << std::endl;
-    ResetReader();
-    start_time_ = std::chrono::steady_clock::now();
-    last_data_time_ = start_time_;
+    {
+        std::lock_guard<std::mutex> lock(reader_mutex_);
+        ResetReader();
+        DiscardReadAhead();
+    }
+    // The schedule keeps running, the next generation's pts continue the stream time
     data_sent_.store(0);
 }
+
+void BaseSessionWorkerThread::DiscardReadAhead()
+{
+    generation_++;
+    reader_eof_ = false;
+    if (read_ahead_id_ != 0) {
+        ReadAheadPool::GetInstance().Schedule(read_ahead_id_);
+    }
+}
+
+void BaseSessionWorkerThread::FillReadAhead()
+{
+    std::lock_guard<std::mutex> lock(reader_mutex_);
+    CpuScope cpu_scope(cpu_account_.get(), CpuStage::READ);
+    while (!reader_eof_ && !read_ahead_->Full()) {
+        ReadAheadUnit unit;
+        if (!ReadNextData(unit)) {
+            unit = ReadAheadUnit{};
+            unit.eof = true;
+            reader_eof_ = true;
+        }
+        unit.generation = generation_.load();
+        read_ahead_->Push(std::move(unit));
+    }
+}
+
+bool BaseSessionWorkerThread::TakeReadAhead(ReadAheadUnit &unit)
+{
+    while (read_ahead_->Pop(unit)) {
+        // Units read before a reset/seek are stale
+        if (unit.generation != generation_.load()) {
+            continue;
+        }
+
+        // Refill in batches once half the queue is consumed
+        if (read_ahead_->Size() <= read_ahead_->Capacity() / 2) {
+            ReadAheadPool::GetInstance().Schedule(read_ahead_id_);
+        }
+        return true;
+    }
+
+    ReadAheadPool::GetInstance().Schedule(read_ahead_id_);
+    return false;
+}
+
+int64_t BaseSessionWorkerThread::GetDueTime(ReadAheadUnit &unit, int64_t now)
+{
+    if (unit.eof) {
+        return now;
+    }
+
+    int64_t due = 0;
+    if (unit.pts_ns < 0) {
+        // Due times advance by whole intervals, so late sends do not shift the rest of the stream
+        due = next_interval_time_;
+        next_interval_time_ += GetDataInterval().count();
+    } else {
+        // The stream time starts at 0 and continues one step past the last unit when the reader restarts its pts,
+        // on a loop, seek or rendition switch, or on a jump in the file's own timestamps
+        int64_t pts = unit.pts_ns + pts_offset_ns_;
+        if (last_pts_ns_ < 0) {
+            pts_offset_ns_ = -unit.pts_ns;
+        } else if (unit.generation != pts_generation_ || pts < last_pts_ns_ - MAX_PTS_STEP_NS ||
+                   pts > last_pts_ns_ + MAX_PTS_STEP_NS) {
+            pts_offset_ns_ = last_pts_ns_ + last_pts_step_ns_ - unit.pts_ns;
+        }
+        pts_generation_ = unit.generation;
+        pts = unit.pts_ns + pts_offset_ns_;
+
+        // Reordered pictures are behind the latest pts and go out right away
+        if (pts > last_pts_ns_) {
+            if (last_pts_ns_ >= 0) {
+                last_pts_step_ns_ = pts - last_pts_ns_;
+            }
+            last_pts_ns_ = pts;
+        }
+        unit.pts_ns = pts;
+        due = start_time_ + pts / 1000;
+    }
+
+    if (now - due > MAX_LATENESS_US) {
+        std::cout << "Session " << session_id_ << " fell " << (now - due) / 1000 << " ms behind, rescheduling"
+                  << std::endl;
+        start_time_ += now - due;
+        next_interval_time_ += now - due;
+        due = now;
+    }
+    return due;
+}
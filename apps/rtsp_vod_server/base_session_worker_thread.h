@@ -9,13 +9,19 @@
 #ifndef LMSHAO_RTSP_BASE_SESSION_WORKER_THREAD_H
 #define LMSHAO_RTSP_BASE_SESSION_WORKER_THREAD_H
 
+#include <lmrtsp/clock.h>
+#include <lmrtsp/cpu_affinity.h>
 #include <lmrtsp/rtsp_server_session.h>
 
 #include <atomic>
 #include <chrono>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <thread>
+#include <vector>
+
+#include "read_ahead_pool.h"
 
 using namespace lmshao::lmrtsp;
 
@@ -26,10 +32,12 @@ using namespace lmshao::lmrtsp;
  * - Thread lifecycle management (Start, Stop, IsRunning)
  * - Session management (GetSessionId, IsSessionActive)
  * - Common state tracking (running, should_stop, statistics)
+ * - Read-ahead through ReadAheadPool, so the worker thread only sends data already in memory
  *
  * Derived classes should implement:
  * - InitializeReader() - Initialize the specific reader
- * - SendNextData() - Send next frame/packet to client
+ * - ReadNextData() - Read next frame/packet from the reader (runs on the read-ahead pool)
+ * - SendData() - Send a read-ahead frame/packet to client
  * - GetDataInterval() - Calculate interval between data units
  * - ResetReader() - Reset the reader to beginning
  */
@@ -94,13 +102,26 @@ protected:
     virtual bool InitializeReader() = 0;
 
     /**
-     * @brief Send next data unit (frame/packet) to client
-     * @return true if sent successfully, false if EOF or error
+     * @brief Read next data unit (frame/packet) from the reader
+     *
+     * Called on a read-ahead pool thread with reader_mutex_ held.
+     * @param unit Output unit, data must be copied out of the file mapping
+     * @return true if a unit was read, false if EOF or error
+     */
+    virtual bool ReadNextData(ReadAheadUnit &unit) = 0;
+
+    /**
+     * @brief Send a data unit (frame/packet) to client
+     * @param unit Unit produced by ReadNextData(), pts_ns is rewritten to the continuous stream time: it keeps
+     *             increasing across loops and seeks
+     * @return true if sent successfully, false on error
      */
-    virtual bool SendNextData() = 0;
+    virtual bool SendData(const ReadAheadUnit &unit) = 0;
 
     /**
      * @brief Get interval between data units
+     *
+     * Paces units without pts_ns and sizes the read-ahead queue.
      * @return Interval duration
      */
     virtual std::chrono::microseconds GetDataInterval() const = 0;
@@ -121,10 +142,40 @@ protected:
     virtual void ReleaseFile() = 0;
 
     /**
-     * @brief Handle end of file (called when SendNextData returns false)
+     * @brief Handle end of file (called at the EOF unit or when SendData returns false)
      */
     virtual void HandleEOF();
 
+    /**
+     * @brief RTSP track this worker feeds, selects the CPU account reads are charged to
+     * @return Track index, -1 for single-track sessions
+     */
+    virtual int GetTrackIndex() const { return -1; }
+
+    /**
+     * @brief Convert a stream time to an RTP timestamp
+     * @param pts_ns Stream time in nanoseconds, as passed to SendData()
+     * @param clock_rate RTP clock rate in Hz
+     * @return RTP timestamp, wrapping at 32 bits
+     */
+    static uint32_t ToRtpTimestamp(int64_t pts_ns, uint32_t clock_rate = 90000)
+    {
+        // Split at whole seconds, so the product does not overflow
+        int64_t seconds = pts_ns / 1000000000;
+        int64_t rest_ns = pts_ns % 1000000000;
+        return static_cast<uint32_t>(seconds * clock_rate + rest_ns * clock_rate / 1000000000);
+    }
+
+    /**
+     * @brief Drop read-ahead data after the reader was repositioned
+     *
+     * Must be called with reader_mutex_ held, right after Reset/Seek on the reader.
+     */
+    void DiscardReadAhead();
+
+    // Reader access is shared with the read-ahead pool, lock around Reset/Seek
+    std::mutex reader_mutex_;
+
     // Session management
     std::shared_ptr<RtspServerSession> session_;
     std::string session_id_;
@@ -135,13 +186,58 @@ protected:
     std::atomic<bool> running_;
     std::atomic<bool> should_stop_;
 
-    // Timing control
-    std::chrono::steady_clock::time_point start_time_;
-    std::chrono::steady_clock::time_point last_data_time_;
+    // Timing control, monotonic microseconds of clock_. Units are due at start_time_ plus their stream time
+    std::shared_ptr<Clock> clock_ = Clock::Get();
+    int64_t start_time_ = 0;
+    int64_t last_data_time_ = 0;
 
     // Statistics
     std::atomic<size_t> data_sent_;
     std::atomic<size_t> bytes_sent_;
+    std::atomic<size_t> read_ahead_underruns_;
+
+private:
+    /**
+     * @brief Fill the read-ahead queue (runs on the read-ahead pool)
+     */
+    void FillReadAhead();
+
+    /**
+     * @brief Take the next current unit from the read-ahead queue
+     * @return false if nothing has been read ahead yet
+     */
+    bool TakeReadAhead(ReadAheadUnit &unit);
+
+    /**
+     * @brief Get the monotonic time a unit is due at and map its pts to the stream time
+     * @param unit Unit just taken from the read-ahead queue, pts_ns is rewritten
+     * @param now Current monotonic time in microseconds
+     * @return Due time in microseconds
+     */
+    int64_t GetDueTime(ReadAheadUnit &unit, int64_t now);
+
+    // Sender CPUs on the NUMA node of the session's home CPU, empty leaves placement to the OS
+    std::vector<int> cpus_;
+
+    // Read-ahead stage
+    std::unique_ptr<ReadAheadQueue> read_ahead_;
+    uint64_t read_ahead_id_ = 0;
+    std::atomic<uint64_t> generation_{0};
+    bool reader_eof_ = false; // Guarded by reader_mutex_
+
+    // Absolute pacing, send thread only. Stream time is the unit pts plus pts_offset_ns_
+    ReadAheadUnit pending_;          // Taken from the queue, waiting for its due time
+    bool has_pending_ = false;
+    int64_t pending_due_ = 0;        // Due time of pending_ in microseconds
+    int64_t next_interval_time_ = 0; // Due time of the next unit without pts
+    int64_t pts_offset_ns_ = 0;
+    int64_t last_pts_ns_ = -1;     // Latest stream time sent, -1 before the first timed unit
+    int64_t last_pts_step_ns_ = 0; // Last forward step of the stream time, continues it after a loop or seek
+    uint64_t pts_generation_ = 0;  // Reader generation pts_offset_ns_ belongs to
+    bool kernel_pacing_ = false;   // The session's transport releases units at their due time
+
+    // Charged with read time while CPU accounting is enabled
+    std::shared_ptr<CpuAccount> cpu_account_;
 };
 
 #endif // LMSHAO_RTSP_BASE_SESSION_WORKER_THREAD_H
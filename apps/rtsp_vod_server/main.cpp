@@ -16,20 +16,25 @@
 #include <lmrtsp/media_types.h>
 #include <lmrtsp/rtsp_server.h>
 #include <lmrtsp/rtsp_server_session.h>
+#include <pthread.h>
 #include <signal.h>
 
 #include <algorithm>
 #include <chrono>
 #include <filesystem>
 #include <fstream>
+#include <iomanip>
 #include <iostream>
 #include <map>
 #include <memory>
+#include <sstream>
+#include <stdexcept>
 #include <thread>
 #include <vector>
 
 #include "aac_file_reader.h"
 #include "file_manager.h"
+#include "read_ahead_pool.h"
 #include "session_aac_worker_thread.h"
 #include "session_h264_reader.h"
 #include "session_h264_worker_thread.h"
@@ -52,6 +57,8 @@ struct MediaFile {
     std::string file_path;     // Full file path
     std::string codec;         // H264, H265, AAC, MP2T, MKV
     uint64_t track_number = 0; // For MKV files (0 = not used)
+    // H.264 rendition set, bitrate (kbps) -> file path, see ParseRenditionName()
+    std::map<uint32_t, std::string> renditions;
     // Note: No longer storing H264FileReader, using MappedFile through FileManager
 };
 
@@ -318,10 +325,16 @@ public:
                 }
             }
 
+            // Renditions to adapt between, lowest bitrate first
+            std::vector<std::string> rendition_paths;
+            for (const auto &[kbps, path] : media.renditions) {
+                rendition_paths.push_back(path);
+            }
+
             // Start H264 worker thread for this session
             // Pass track_index to StartSession (will be used if >= 0, otherwise -1 for single-track)
             if (!SessionManager::GetInstance().StartSession(session, media.file_path, Codec::H264, frame_rate, 2000000,
-                                                            0, track_index)) {
+                                                            0, track_index, "", rendition_paths)) {
                 std::cout << "Failed to start H264 worker thread for session: " << session_id << std::endl;
             }
         } else if (media.codec == Codec::MP2T) {
@@ -499,6 +512,26 @@ std::string GetCodecFromExtension(const std::string &filename)
     return "";
 }
 
+// Split a rendition file name "<name>@<kbps>k.<ext>" into its stream name "<name>.<ext>" and bitrate
+bool ParseRenditionName(const std::string &filename, std::string &stream_name, uint32_t &kbps)
+{
+    std::filesystem::path path(filename);
+    std::string stem = path.stem().string();
+    size_t at = stem.rfind('@');
+    if (at == std::string::npos || at == 0 || stem.size() < at + 3 || ::tolower(stem.back()) != 'k') {
+        return false;
+    }
+
+    std::string digits = stem.substr(at + 1, stem.size() - at - 2);
+    if (digits.size() > 7 || !std::all_of(digits.begin(), digits.end(), ::isdigit)) {
+        return false;
+    }
+
+    kbps = static_cast<uint32_t>(std::stoul(digits));
+    stream_name = stem.substr(0, at) + path.extension().string();
+    return kbps > 0;
+}
+
 // Scan media directory and register streams
 bool ScanMediaDirectory(const std::string &directory)
 {
@@ -535,6 +568,28 @@ bool ScanMediaDirectory(const std::string &directory)
             media.file_path = filepath;
             media.codec = codec;
 
+            // Renditions of one H.264 stream share a path, the first one found is announced in the SDP
+            std::string renditionName;
+            uint32_t renditionKbps = 0;
+            if (codec == Codec::H264 && ParseRenditionName(filename, renditionName, renditionKbps)) {
+                streamPath = "/" + renditionName;
+                media.stream_path = streamPath;
+                media.renditions[renditionKbps] = filepath;
+
+                std::lock_guard<std::mutex> lock(g_media_mutex);
+                auto it = g_media_files.find(streamPath);
+                if (it != g_media_files.end()) {
+                    if (it->second.renditions.empty()) {
+                        std::cerr << "Warning: " << filename << " conflicts with " << it->second.filename << std::endl;
+                    } else {
+                        it->second.renditions[renditionKbps] = filepath;
+                        std::cout << "      Rendition:  " << filename << " (" << renditionKbps << " kbps) -> "
+                                  << streamPath << std::endl;
+                    }
+                    continue;
+                }
+            }
+
             // For H.264 files, load parameters using MappedFile
             if (codec == Codec::H264) {
                 // Use FileManager to get shared MappedFile
@@ -964,9 +1019,28 @@ void PrintUsage(const char *programName)
     std::cout << "" << std::endl;
 
     std::cout << "Options:" << std::endl;
-    std::cout << "  -ip <address>    Server IP (default: 0.0.0.0)" << std::endl;
-    std::cout << "  -port <number>   Port number (default: 8554)" << std::endl;
-    std::cout << "  -h, --help       Show this help message" << std::endl;
+    std::cout << "  -ip <address>         Server IP (default: 0.0.0.0)" << std::endl;
+    std::cout << "  -port <number>        Port number (default: 8554)" << std::endl;
+    std::cout << "  -max-sessions <n>     Admit at most n sessions, reject with 503" << std::endl;
+    std::cout << "  -max-egress-mbps <n>  Admit up to n Mbps aggregate, reject with 453" << std::endl;
+    std::cout << "  -session-cap-mbps <n> Cap each session at n Mbps, dropping whole frames beyond it" << std::endl;
+    std::cout << "  -client-cap-mbps <n>  Cap each client IP at n Mbps over all of its sessions" << std::endl;
+    std::cout << "  -io-uring             Send UDP RTP through io_uring (Linux, ENABLE_IO_URING build)" << std::endl;
+    std::cout << "  -txtime               Pace UDP RTP in the kernel with SO_TXTIME (Linux, needs the fq qdisc)"
+              << std::endl;
+    std::cout << "  -read-ahead-ms <n>    Read media n ms ahead of playout (default: 500)" << std::endl;
+    std::cout << "  -io-threads <n>       Read-ahead I/O threads (default: 2)" << std::endl;
+    std::cout << "  -thread-stack-kb <n>  Stack size of per-session threads (default: 256, Linux)" << std::endl;
+    std::cout << "  -cpu-stats            Account CPU time per session, print it per stream and codec" << std::endl;
+    std::cout << "  -parallel-packetize-kb <n>  Packetize H.264 frames of at least n KB on all cores (default: off)"
+              << std::endl;
+    std::cout << "  -reactor-cpus <list>  Pin network reactor threads to these CPUs, e.g. 0-3" << std::endl;
+    std::cout << "  -sender-cpus <list>   Pin session send and read-ahead threads to these CPUs, sessions stay on one"
+              << std::endl;
+    std::cout << "                        NUMA node, e.g. 4-15,20-31" << std::endl;
+    std::cout << "  -ts-drop-null         Do not send TS null packets (PID 0x1FFF stuffing)" << std::endl;
+    std::cout << "  -ts-stream-types <list>  Send only these PMT stream types of TS files, e.g. 0x1b,0x0f" << std::endl;
+    std::cout << "  -h, --help            Show this help message" << std::endl;
     std::cout << "" << std::endl;
 
     std::cout << "Examples:" << std::endl;
@@ -979,6 +1053,10 @@ void PrintUsage(const char *programName)
     std::cout << "  The server will automatically discover all media files in the directory." << std::endl;
     std::cout << "  For file \"movie.h264\", use: rtsp://server:8554/movie.h264" << std::endl;
     std::cout << "  For MKV file with multiple tracks, use: rtsp://server:8554/movie.mkv/track1" << std::endl;
+    std::cout << "  H.264 renditions with aligned GOPs, e.g. \"movie@800k.h264\" and \"movie@3000k.h264\","
+              << std::endl;
+    std::cout << "  share rtsp://server:8554/movie.h264 and switch at keyframes as network conditions change"
+              << std::endl;
     std::cout << "" << std::endl;
     std::cout << "  ffplay rtsp://localhost:8554/movie.h264" << std::endl;
     std::cout << "  ffplay rtsp://localhost:8554/movie.mkv/track1" << std::endl;
@@ -996,6 +1074,15 @@ int main(int argc, char *argv[])
     // Default parameters
     std::string ip = "0.0.0.0";
     uint16_t port = 8554;
+    bool use_io_uring = false;
+    bool kernel_pacing = false;
+    bool cpu_stats = false;
+    size_t thread_stack_kb = 256;
+    size_t parallel_packetize_kb = 0;
+    AdmissionLimits admission_limits;
+    EgressLimits egress_limits;
+    TSFilterConfig ts_filter;
+    CpuAffinityConfig cpu_affinity;
 
     // Check for help
     if (argc >= 2) {
@@ -1020,6 +1107,77 @@ int main(int argc, char *argv[])
                 std::cerr << "Error: Invalid port number" << std::endl;
                 return 1;
             }
+        } else if (arg == "-io-uring") {
+            use_io_uring = true;
+        } else if (arg == "-txtime") {
+            kernel_pacing = true;
+        } else if (arg == "-cpu-stats") {
+            cpu_stats = true;
+        } else if ((arg == "-reactor-cpus" || arg == "-sender-cpus") && argIndex + 1 < argc) {
+            auto &cpus = arg == "-reactor-cpus" ? cpu_affinity.reactor_cpus : cpu_affinity.sender_cpus;
+            if (!CpuAffinity::ParseCpuList(argv[++argIndex], cpus)) {
+                std::cerr << "Error: Invalid CPU list for " << arg << std::endl;
+                return 1;
+            }
+        } else if (arg == "-ts-drop-null") {
+            ts_filter.drop_null_packets = true;
+        } else if (arg == "-ts-stream-types" && argIndex + 1 < argc) {
+            std::stringstream types(argv[++argIndex]);
+            std::string type;
+            while (std::getline(types, type, ',')) {
+                try {
+                    unsigned long value = std::stoul(type, nullptr, 0);
+                    if (value > 0xFF) {
+                        throw std::out_of_range(type);
+                    }
+                    ts_filter.stream_types.push_back(static_cast<uint8_t>(value));
+                } catch (...) {
+                    std::cerr << "Error: Invalid TS stream type: " << type << std::endl;
+                    return 1;
+                }
+            }
+        } else if ((arg == "-max-sessions" || arg == "-max-egress-mbps") && argIndex + 1 < argc) {
+            try {
+                unsigned long value = std::stoul(argv[++argIndex]);
+                if (arg == "-max-sessions") {
+                    admission_limits.max_sessions = value;
+                } else {
+                    admission_limits.max_egress_bps = static_cast<uint64_t>(value) * 1000000;
+                }
+            } catch (...) {
+                std::cerr << "Error: Invalid value for " << arg << std::endl;
+                return 1;
+            }
+        } else if ((arg == "-session-cap-mbps" || arg == "-client-cap-mbps") && argIndex + 1 < argc) {
+            try {
+                uint64_t bps = static_cast<uint64_t>(std::stoul(argv[++argIndex])) * 1000000;
+                if (arg == "-session-cap-mbps") {
+                    egress_limits.session_bps = bps;
+                } else {
+                    egress_limits.client_ip_bps = bps;
+                }
+            } catch (...) {
+                std::cerr << "Error: Invalid value for " << arg << std::endl;
+                return 1;
+            }
+        } else if ((arg == "-read-ahead-ms" || arg == "-io-threads" || arg == "-thread-stack-kb" ||
+                    arg == "-parallel-packetize-kb") &&
+                   argIndex + 1 < argc) {
+            try {
+                unsigned long value = std::stoul(argv[++argIndex]);
+                if (arg == "-read-ahead-ms") {
+                    ReadAheadPool::GetInstance().SetReadAheadMs(static_cast<uint32_t>(value));
+                } else if (arg == "-io-threads") {
+                    ReadAheadPool::GetInstance().SetThreadCount(value);
+                } else if (arg == "-thread-stack-kb") {
+                    thread_stack_kb = value;
+                } else {
+                    parallel_packetize_kb = value;
+                }
+            } catch (...) {
+                std::cerr << "Error: Invalid value for " << arg << std::endl;
+                return 1;
+            }
         } else if (arg[0] != '-') {
             // This is the media directory
             g_media_directory = arg;
@@ -1053,6 +1211,40 @@ int main(int argc, char *argv[])
     // Get server instance
     g_server = RtspServer::GetInstance();
 
+    if (use_io_uring) {
+        g_server->SetTransportBackend(TransportConfig::Backend::IO_URING);
+        std::cout << "UDP transport backend: io_uring (falls back to sockets if unavailable)" << std::endl;
+    }
+    if (kernel_pacing) {
+        g_server->SetKernelPacing(true);
+        std::cout << "UDP kernel pacing: SO_TXTIME (falls back to userspace pacing if unavailable)" << std::endl;
+    }
+
+    g_server->SetAdmissionLimits(admission_limits);
+    g_server->SetEgressLimits(egress_limits);
+    g_server->SetCpuAccounting(cpu_stats);
+
+    if (parallel_packetize_kb > 0) {
+        g_server->SetParallelPacketizeBytes(parallel_packetize_kb * 1024);
+        std::cout << "Parallel packetization for H.264 frames >= " << parallel_packetize_kb << " KB" << std::endl;
+    }
+
+    if (!cpu_affinity.reactor_cpus.empty() || !cpu_affinity.sender_cpus.empty()) {
+        g_server->SetCpuAffinity(cpu_affinity);
+        ReadAheadPool::GetInstance().SetCpus(cpu_affinity.sender_cpus);
+        std::cout << "CPU affinity: " << cpu_affinity.reactor_cpus.size() << " reactor CPUs, "
+                  << cpu_affinity.sender_cpus.size() << " sender CPUs" << std::endl;
+    }
+
+    if (ts_filter.IsEnabled()) {
+        g_server->SetTSFilter(ts_filter);
+        std::cout << "TS remux:" << (ts_filter.drop_null_packets ? " dropping null packets" : "");
+        if (!ts_filter.stream_types.empty()) {
+            std::cout << " keeping " << ts_filter.stream_types.size() << " stream types";
+        }
+        std::cout << std::endl;
+    }
+
     // Set session event listener
     auto listener = std::make_shared<SessionEventListener>();
     g_server->SetListener(listener);
@@ -1084,6 +1276,20 @@ int main(int argc, char *argv[])
         return 1;
     }
 
+#if defined(__linux__) && defined(__GLIBC__)
+    // Threads created from here on are per-session (workers, RTCP timers) or the read-ahead pool; none needs the
+    // 8 MB glibc default, which dominates the footprint of many concurrent sessions
+    pthread_attr_t thread_attr;
+    pthread_attr_init(&thread_attr);
+    if (pthread_attr_setstacksize(&thread_attr, thread_stack_kb * 1024) != 0 ||
+        pthread_setattr_default_np(&thread_attr) != 0) {
+        std::cerr << "Warning: Failed to set thread stack size to " << thread_stack_kb << " KB" << std::endl;
+    }
+    pthread_attr_destroy(&thread_attr);
+#else
+    (void)thread_stack_kb;
+#endif
+
     std::cout << "\n=== Server is running, press Ctrl+C to stop ===" << std::endl;
 
     // Print prominent URLs for all local IPs (if bound to 0.0.0.0) or the bound IP
@@ -1112,8 +1318,32 @@ int main(int argc, char *argv[])
             size_t active_count = SessionManager::GetInstance().GetActiveSessionCount();
             size_t cached_files = FileManager::GetInstance().GetCachedFileCount();
 
+            // Approximate library-side memory of all RTSP sessions, idle ones hold no RTP session
+            size_t session_count = 0;
+            size_t session_memory = 0;
+            size_t rtp_sessions = 0;
+            for (const auto &[session_id, session] : g_server->GetSessions()) {
+                auto usage = session->GetMemoryUsage();
+                session_count++;
+                session_memory += usage.Total();
+                rtp_sessions += usage.rtp_sessions;
+            }
+
             std::cout << "Server stats - Active sessions: " << active_count << ", Cached files: " << cached_files
-                      << std::endl;
+                      << ", RTSP sessions: " << session_count << " (" << rtp_sessions << " RTP, "
+                      << session_memory / 1024 << " KB)" << std::endl;
+
+            if (cpu_stats) {
+                for (const auto &stream : g_server->GetCpuStats()) {
+                    const auto &usage = stream.usage;
+                    std::cout << "  CPU " << stream.stream << " [" << stream.codec << "]: " << std::fixed
+                              << std::setprecision(0) << usage.UsPerSecond() << " us/s, " << usage.UsPerMB()
+                              << " us/MB (read " << usage.stage_us[static_cast<size_t>(CpuStage::READ)]
+                              << " us, packetize " << usage.stage_us[static_cast<size_t>(CpuStage::PACKETIZE)]
+                              << " us, send " << usage.stage_us[static_cast<size_t>(CpuStage::SEND)] << " us, "
+                              << usage.frames << " frames)" << std::defaultfloat << std::endl;
+                }
+            }
 
             last_stats_time = current_time;
         }
@@ -0,0 +1,218 @@
+/**
+ * @author SHAO Liming <lmshao@163.com>
+ * @copyright Copyright (c) 2025 SHAO Liming
+ * @license MIT
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "read_ahead_pool.h"
+
+#include <lmrtsp/cpu_affinity.h>
+
+#include <algorithm>
+#include <iostream>
+
+using lmshao::lmrtsp::CpuAffinity;
+
+ReadAheadQueue::ReadAheadQueue(size_t capacity)
+{
+    size_t size = 2;
+    while (size < capacity) {
+        size <<= 1;
+    }
+    slots_.resize(size);
+    mask_ = size - 1;
+}
+
+bool ReadAheadQueue::Push(ReadAheadUnit &&unit)
+{
+    size_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail - head_.load(std::memory_order_acquire) >= slots_.size()) {
+        return false;
+    }
+
+    slots_[tail & mask_] = std::move(unit);
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+}
+
+bool ReadAheadQueue::Pop(ReadAheadUnit &unit)
+{
+    size_t head = head_.load(std::memory_order_relaxed);
+    if (head == tail_.load(std::memory_order_acquire)) {
+        return false;
+    }
+
+    unit = std::move(slots_[head & mask_]);
+    slots_[head & mask_] = ReadAheadUnit{};
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+size_t ReadAheadQueue::Size() const
+{
+    return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+}
+
+ReadAheadPool &ReadAheadPool::GetInstance()
+{
+    static ReadAheadPool instance;
+    return instance;
+}
+
+ReadAheadPool::~ReadAheadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    work_cv_.notify_all();
+
+    for (auto &thread : threads_) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+}
+
+void ReadAheadPool::SetThreadCount(size_t count)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!threads_.empty()) {
+        std::cout << "Read-ahead pool already running with " << threads_.size() << " threads" << std::endl;
+        return;
+    }
+    thread_count_ = count > 0 ? count : 1;
+}
+
+void ReadAheadPool::SetCpus(const std::vector<int> &cpus)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!threads_.empty()) {
+        std::cout << "Read-ahead pool already running, CPU set ignored" << std::endl;
+        return;
+    }
+    cpus_ = cpus;
+}
+
+void ReadAheadPool::Start()
+{
+    // Called with mutex_ held
+    for (int cpu : cpus_) {
+        int node = CpuAffinity::GetNumaNode(cpu);
+        auto it = std::find_if(lanes_.begin(), lanes_.end(), [node](const Lane &lane) { return lane.node == node; });
+        if (it == lanes_.end()) {
+            lanes_.push_back(Lane{node, {}, {}});
+            it = lanes_.end() - 1;
+        }
+        it->cpus.push_back(cpu);
+    }
+    if (lanes_.empty()) {
+        lanes_.emplace_back();
+    }
+
+    // At least one thread per lane
+    size_t count = std::max(thread_count_, lanes_.size());
+    for (size_t i = 0; i < count; ++i) {
+        threads_.emplace_back(&ReadAheadPool::WorkerFunc, this, i % lanes_.size());
+    }
+    std::cout << "Read-ahead pool started: " << count << " threads in " << lanes_.size() << " lanes, "
+              << read_ahead_ms_.load() << " ms ahead" << std::endl;
+}
+
+uint64_t ReadAheadPool::Register(FillCallback fill, int node)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    // Start the I/O threads on first use
+    if (threads_.empty()) {
+        Start();
+    }
+
+    uint64_t id = next_id_++;
+    Task &task = tasks_[id];
+    task.fill = std::move(fill);
+    for (size_t i = 0; i < lanes_.size(); ++i) {
+        if (lanes_[i].node == node) {
+            task.lane = i;
+            break;
+        }
+    }
+    return id;
+}
+
+void ReadAheadPool::Unregister(uint64_t id)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto it = tasks_.find(id);
+    if (it == tasks_.end()) {
+        return;
+    }
+
+    idle_cv_.wait(lock, [this, id]() { return !tasks_[id].running; });
+    tasks_.erase(id);
+    // A stale ID left in a lane is skipped by the worker
+}
+
+void ReadAheadPool::Schedule(uint64_t id)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = tasks_.find(id);
+        if (it == tasks_.end() || it->second.queued) {
+            return;
+        }
+
+        if (it->second.running) {
+            it->second.rerun = true;
+            return;
+        }
+
+        it->second.queued = true;
+        lanes_[it->second.lane].ready.push_back(id);
+    }
+    // Waiters of every lane share the condition variable
+    work_cv_.notify_all();
+}
+
+void ReadAheadPool::WorkerFunc(size_t lane)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    CpuAffinity::PinCurrentThread(lanes_[lane].cpus);
+
+    std::deque<uint64_t> &ready = lanes_[lane].ready;
+    while (true) {
+        work_cv_.wait(lock, [this, &ready]() { return stop_ || !ready.empty(); });
+        if (stop_) {
+            break;
+        }
+
+        uint64_t id = ready.front();
+        ready.pop_front();
+
+        auto it = tasks_.find(id);
+        if (it == tasks_.end()) {
+            continue;
+        }
+
+        it->second.queued = false;
+        it->second.running = true;
+        FillCallback fill = it->second.fill;
+
+        lock.unlock();
+        fill();
+        lock.lock();
+
+        // The task cannot have been erased while running, Unregister() waits for it
+        Task &task = tasks_[id];
+        task.running = false;
+        if (task.rerun) {
+            task.rerun = false;
+            task.queued = true;
+            ready.push_back(id);
+            work_cv_.notify_all();
+        }
+        idle_cv_.notify_all();
+    }
+}
@@ -0,0 +1,166 @@
+/**
+ * @author SHAO Liming <lmshao@163.com>
+ * @copyright Copyright (c) 2025 SHAO Liming
+ * @license MIT
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef LMSHAO_RTSP_READ_AHEAD_POOL_H
+#define LMSHAO_RTSP_READ_AHEAD_POOL_H
+
+#include <lmcore/data_buffer.h>
+#include <lmrtsp/media_types.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief One data unit (frame/packet) read ahead of the playout cursor
+ */
+struct ReadAheadUnit {
+    std::shared_ptr<lmshao::lmcore::DataBuffer> data;
+    bool is_keyframe = false;
+    bool eof = false;        // Reader reached the end of file, no data
+    uint64_t generation = 0; // Reader position epoch, bumped on reset/seek
+    int64_t pts_ns = -1;     // Presentation time from the reader, -1 paces the unit by GetDataInterval()
+
+    // Picture type of video units, classified by the reader, see lmrtsp::VideoParam
+    lmshao::lmrtsp::FrameType frame_type = lmshao::lmrtsp::FrameType::UNKNOWN;
+    bool is_reference = true;
+    uint8_t temporal_id = 0;
+
+    // Set by the worker when the session is kernel-paced, see lmrtsp::MediaFrame::departure_ns
+    int64_t departure_ns = 0;
+    int64_t departure_span_ns = 0;
+};
+
+/**
+ * @brief Single-producer single-consumer ring of read-ahead units
+ *
+ * The read-ahead pool is the only producer and the session worker thread the only consumer.
+ */
+class ReadAheadQueue {
+public:
+    /**
+     * @brief Constructor
+     * @param capacity Requested capacity, rounded up to a power of two
+     */
+    explicit ReadAheadQueue(size_t capacity);
+
+    bool Push(ReadAheadUnit &&unit);
+    bool Pop(ReadAheadUnit &unit);
+
+    size_t Size() const;
+    size_t Capacity() const { return slots_.size(); }
+    bool Full() const { return Size() >= Capacity(); }
+
+private:
+    std::vector<ReadAheadUnit> slots_;
+    size_t mask_;
+    alignas(64) std::atomic<size_t> head_{0}; // Next slot to pop, written by the consumer
+    alignas(64) std::atomic<size_t> tail_{0}; // Next slot to push, written by the producer
+};
+
+/**
+ * @brief Shared I/O stage that reads media ahead of the session worker threads
+ *
+ * Sessions register a fill callback and schedule it whenever their queue runs low. A small set of threads runs the
+ * scheduled callbacks, so page faults and slow reads happen here instead of right before a send deadline. A session
+ * is filled by at most one thread at a time.
+ *
+ * With a CPU set the threads are split into one lane per NUMA node of the set, and a session registered for a node is
+ * filled by that node's threads, so the buffers it reads into are allocated on the node its worker sends from.
+ */
+class ReadAheadPool {
+public:
+    using FillCallback = std::function<void()>;
+
+    /**
+     * @brief Get the singleton instance
+     * @return Reference to the ReadAheadPool instance
+     */
+    static ReadAheadPool &GetInstance();
+
+    /**
+     * @brief Set the number of I/O threads, only effective before the first Register()
+     */
+    void SetThreadCount(size_t count);
+
+    /**
+     * @brief Pin the I/O threads to these CPUs, one lane per NUMA node, only effective before the first Register()
+     */
+    void SetCpus(const std::vector<int> &cpus);
+
+    /**
+     * @brief Set how far ahead of the playout cursor sessions read
+     */
+    void SetReadAheadMs(uint32_t ms) { read_ahead_ms_.store(ms); }
+    uint32_t GetReadAheadMs() const { return read_ahead_ms_.load(); }
+
+    /**
+     * @brief Register a session fill callback
+     * @param node NUMA node whose threads fill the session, -1 for any
+     * @return Registration ID used with Schedule() and Unregister()
+     */
+    uint64_t Register(FillCallback fill, int node = -1);
+
+    /**
+     * @brief Remove a registration, waits for a running fill of it to finish
+     */
+    void Unregister(uint64_t id);
+
+    /**
+     * @brief Queue a fill of the given session
+     */
+    void Schedule(uint64_t id);
+
+private:
+    ReadAheadPool() = default;
+    ~ReadAheadPool();
+
+    // Non-copyable and non-movable
+    ReadAheadPool(const ReadAheadPool &) = delete;
+    ReadAheadPool &operator=(const ReadAheadPool &) = delete;
+    ReadAheadPool(ReadAheadPool &&) = delete;
+    ReadAheadPool &operator=(ReadAheadPool &&) = delete;
+
+    void Start();
+    void WorkerFunc(size_t lane);
+
+    struct Lane {
+        int node = -1;
+        std::vector<int> cpus; // Empty leaves the lane's threads unpinned
+        std::deque<uint64_t> ready;
+    };
+
+    struct Task {
+        FillCallback fill;
+        size_t lane = 0;
+        bool queued = false;
+        bool running = false;
+        bool rerun = false; // Scheduled again while running
+    };
+
+    std::mutex mutex_;
+    std::condition_variable work_cv_;
+    std::condition_variable idle_cv_;
+    std::unordered_map<uint64_t, Task> tasks_;
+    std::vector<Lane> lanes_; // Fixed once the threads are started
+    std::vector<std::thread> threads_;
+    size_t thread_count_ = 2;
+    std::vector<int> cpus_;
+    uint64_t next_id_ = 1;
+    bool stop_ = false;
+    std::atomic<uint32_t> read_ahead_ms_{500};
+};
+
+#endif // LMSHAO_RTSP_READ_AHEAD_POOL_H
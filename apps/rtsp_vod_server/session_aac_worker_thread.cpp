@@ -85,7 +85,9 @@ void SessionAacWorkerThread::ReleaseFile()
 
 void SessionAacWorkerThread::Reset()
 {
+    std::lock_guard<std::mutex> lock(reader_mutex_);
     ResetReader();
+    DiscardReadAhead();
 }
 
 void SessionAacWorkerThread::ResetReader()
@@ -95,9 +97,9 @@ void SessionAacWorkerThread::ResetReader()
     }
 }
 
-bool SessionAacWorkerThread::SendNextData()
+bool SessionAacWorkerThread::ReadNextData(ReadAheadUnit &unit)
 {
-    if (!reader_ || !session_) {
+    if (!reader_) {
         return false;
     }
 
@@ -106,6 +108,18 @@ bool SessionAacWorkerThread::SendNextData()
         return false; // EOF or error
     }
 
+    // Copy frame data to DataBuffer
+    unit.data = lmshao::lmcore::DataBuffer::Create(frame_data.size());
+    unit.data->Assign(frame_data.data(), frame_data.size());
+    return true;
+}
+
+bool SessionAacWorkerThread::SendData(const ReadAheadUnit &unit)
+{
+    if (!unit.data || !reader_ || !session_) {
+        return false;
+    }
+
     // Create MediaFrame
     lmshao::lmrtsp::MediaFrame frame;
     frame.media_type = lmshao::lmrtsp::MediaType::AAC;
@@ -115,10 +129,9 @@ bool SessionAacWorkerThread::SendNextData()
     frame.timestamp = static_cast<uint32_t>(frame_counter_.load() * rtp_timestamp_increment_);
     frame.audio_param.sample_rate = sample_rate_;
     frame.audio_param.channels = reader_->GetChannels();
-
-    // Copy frame data to DataBuffer
-    frame.data = lmshao::lmcore::DataBuffer::Create(frame_data.size());
-    frame.data->Assign(frame_data.data(), frame_data.size());
+    frame.data = unit.data;
+    frame.departure_ns = unit.departure_ns;
+    frame.departure_span_ns = unit.departure_span_ns;
 
     // Send frame to session using PushFrame
     bool success = session_->PushFrame(frame);
@@ -44,7 +44,8 @@ public:
 
 protected:
     bool InitializeReader() override;
-    bool SendNextData() override;
+    bool ReadNextData(ReadAheadUnit &unit) override;
+    bool SendData(const ReadAheadUnit &unit) override;
     std::chrono::microseconds GetDataInterval() const override;
     void ResetReader() override;
     void CleanupReader() override;
@@ -8,14 +8,25 @@
 
 #include "session_h264_reader.h"
 
+#include <lmcore/data_buffer.h>
+
 #include <algorithm>
+#include <cmath>
 #include <cstring>
 #include <iomanip>
 #include <iostream>
 
+namespace {
+// first_mb_in_slice is ue(v), a leading 1 bit means 0, the first slice of the picture
+bool IsFirstSlice(const uint8_t *nalu, size_t size, size_t header)
+{
+    return header + 1 < size && (nalu[header + 1] & 0x80) != 0;
+}
+} // namespace
+
 SessionH264Reader::SessionH264Reader(std::shared_ptr<lmshao::lmcore::MappedFile> mapped_file)
     : mapped_file_(mapped_file), current_offset_(0), current_frame_index_(0), current_timestamp_(0.0),
-      index_built_(false), frame_rate_(25) // Default 25fps
+      last_nalu_offset_(0), index_built_(false), frame_rate_(25) // Default 25fps
       ,
       parameter_sets_extracted_(false)
 {
@@ -38,13 +49,14 @@ bool SessionH264Reader::ReadNextFrame(LocalMediaFrame &frame)
 
     frame.data = std::move(frame_data);
     frame.timestamp = static_cast<uint64_t>(current_timestamp_ * 1000); // Convert to milliseconds
-    frame.is_keyframe = false;                                          // Will be set based on NALU type
+    frame.pts_ns = pts_base_ns_ + TicksToNs(last_ticks_);
 
-    // Check if this is a keyframe (IDR frame)
-    if (!frame.data.empty() && frame.data.size() > 4) {
-        uint8_t nalu_type = frame.data[4] & 0x1F;
-        frame.is_keyframe = (nalu_type == 5); // IDR frame
-    }
+    // Classified once here, the send path reads the type from the MediaFrame
+    lmshao::lmrtsp::VideoParam param;
+    classifier_.Classify(frame.data.data(), frame.data.size(), param);
+    frame.is_keyframe = param.is_key_frame;
+    frame.frame_type = param.frame_type;
+    frame.is_reference = param.is_reference;
 
     return true;
 }
@@ -65,10 +77,34 @@ bool SessionH264Reader::ReadNextFrame(std::vector<uint8_t> &frame_data)
     const uint8_t *data = mapped_file_->Data();
     frame_data.assign(data + nalu_start, data + nalu_start + nalu_size);
 
+    if (!parameter_sets_extracted_) {
+        ExtractParameterSets();
+    }
+
+    // A picture starts at its first slice, the NALUs before it belong to the next picture
+    size_t header = (data[nalu_start + 2] == 0x00) ? 4 : 3;
+    if (nalu_type >= 1 && nalu_type <= 5) {
+        if (IsFirstSlice(data + nalu_start, nalu_size, header)) {
+            picture_ticks_ = next_picture_ticks_;
+            next_picture_ticks_ += next_picture_duration_;
+            next_picture_duration_ = 2;
+        }
+        last_ticks_ = picture_ticks_;
+    } else {
+        if (nalu_type == 6) {
+            uint32_t duration = GetPictureDuration(data + nalu_start, nalu_size);
+            if (duration > 0) {
+                next_picture_duration_ = duration;
+            }
+        }
+        last_ticks_ = next_picture_ticks_;
+    }
+
     // Update session state
+    last_nalu_offset_ = nalu_start;
     current_offset_ = nalu_start + nalu_size;
     current_frame_index_++;
-    current_timestamp_ = current_frame_index_ / static_cast<double>(frame_rate_);
+    current_timestamp_ = (pts_base_ns_ + TicksToNs(last_ticks_)) / 1e9;
 
     std::cout << "Session read frame " << current_frame_index_ << ", size: " << nalu_size << " bytes"
               << ", timestamp: " << std::fixed << std::setprecision(2) << current_timestamp_ << "s"
@@ -92,7 +128,7 @@ bool SessionH264Reader::SeekToFrame(size_t frame_index)
     const auto &frame_info = frame_index_[frame_index];
     current_offset_ = frame_info.offset_;
     current_frame_index_ = frame_index;
-    current_timestamp_ = frame_info.timestamp_;
+    SeekToTicks(frame_info.ticks_);
 
     std::cout << "Session seeked to frame " << frame_index << ", offset: " << current_offset_
               << ", timestamp: " << std::fixed << std::setprecision(2) << current_timestamp_ << "s" << std::endl;
@@ -118,11 +154,49 @@ bool SessionH264Reader::SeekToTime(double timestamp)
     return SeekToFrame(frame_index);
 }
 
+bool SessionH264Reader::SeekToKeyframe(size_t ordinal)
+{
+    if (!index_built_) {
+        BuildFrameIndex();
+    }
+
+    if (ordinal >= keyframe_offsets_.size()) {
+        std::cout << "Keyframe " << ordinal << " out of range (total: " << keyframe_offsets_.size() << ")"
+                  << std::endl;
+        return false;
+    }
+
+    size_t offset = keyframe_offsets_[ordinal];
+    auto it = std::lower_bound(frame_index_.begin(), frame_index_.end(), offset,
+                               [](const FrameInfo &frame, size_t off) { return frame.offset_ < off; });
+    current_offset_ = offset;
+    current_frame_index_ = std::distance(frame_index_.begin(), it);
+    SeekToTicks((it != frame_index_.end()) ? it->ticks_ : 0);
+
+    std::cout << "Session seeked to keyframe " << ordinal << ", offset: " << current_offset_ << std::endl;
+    return true;
+}
+
+bool SessionH264Reader::GetKeyframeOrdinal(size_t &ordinal) const
+{
+    if (!index_built_) {
+        BuildFrameIndex();
+    }
+
+    auto it = std::lower_bound(keyframe_offsets_.begin(), keyframe_offsets_.end(), last_nalu_offset_);
+    if (it == keyframe_offsets_.end() || *it != last_nalu_offset_) {
+        return false;
+    }
+
+    ordinal = static_cast<size_t>(std::distance(keyframe_offsets_.begin(), it));
+    return true;
+}
+
 void SessionH264Reader::Reset()
 {
     current_offset_ = 0;
     current_frame_index_ = 0;
-    current_timestamp_ = 0.0;
+    SeekToTicks(0);
 
     std::cout << "Session reset to beginning" << std::endl;
 }
@@ -172,6 +246,31 @@ uint32_t SessionH264Reader::GetFrameRate() const
     return frame_rate_;
 }
 
+void SessionH264Reader::SetDefaultFrameRate(uint32_t fps)
+{
+    if (fps == 0 || HasTimingInfo()) {
+        return;
+    }
+
+    // Keep the time already reached, later pictures advance at the new rate
+    pts_base_ns_ += TicksToNs(next_picture_ticks_);
+    picture_ticks_ = 0;
+    next_picture_ticks_ = 0;
+    last_ticks_ = 0;
+    frame_rate_ = fps;
+    num_units_in_tick_ = 1;
+    time_scale_ = fps * 2;
+    index_built_ = false;
+}
+
+bool SessionH264Reader::HasTimingInfo() const
+{
+    if (!parameter_sets_extracted_) {
+        ExtractParameterSets();
+    }
+    return video_info_.timing_info_present;
+}
+
 // Private methods implementation
 
 int SessionH264Reader::FindStartCode(const uint8_t *data, size_t start_pos, size_t data_size)
@@ -240,9 +339,17 @@ void SessionH264Reader::BuildFrameIndex() const
 
     std::cout << "Building frame index for file: " << mapped_file_->Path() << std::endl;
 
+    if (!parameter_sets_extracted_) {
+        ExtractParameterSets();
+    }
+
     frame_index_.clear();
+    keyframe_offsets_.clear();
+    const uint8_t *data = mapped_file_->Data();
     size_t offset = 0;
-    size_t frame_count = 0;
+    uint64_t picture_ticks = 0;
+    uint64_t next_picture_ticks = 0;
+    uint32_t next_picture_duration = 2;
 
     while (offset < mapped_file_->Size()) {
         size_t nalu_start, nalu_size;
@@ -253,17 +360,34 @@ void SessionH264Reader::BuildFrameIndex() const
             break;
         }
 
-        // Only count actual frame NALUs (not SPS/PPS/SEI)
+        // Only count actual frame NALUs (not SPS/PPS/SEI), timed like ReadNextFrame()
+        size_t header = (data[nalu_start + 2] == 0x00) ? 4 : 3;
         if (nalu_type >= 1 && nalu_type <= 5) {
+            bool first_slice = IsFirstSlice(data + nalu_start, nalu_size, header);
+            if (first_slice) {
+                picture_ticks = next_picture_ticks;
+                next_picture_ticks += next_picture_duration;
+                next_picture_duration = 2;
+            }
+
             FrameInfo frame_info;
             frame_info.offset_ = nalu_start;
             frame_info.size_ = nalu_size;
-            frame_info.timestamp_ = frame_count / static_cast<double>(frame_rate_);
+            frame_info.timestamp_ = TicksToNs(picture_ticks) / 1e9;
+            frame_info.ticks_ = picture_ticks;
             frame_info.is_keyframe_ = (nalu_type == 5); // IDR frame
             frame_info.nalu_type_ = nalu_type;
 
             frame_index_.push_back(frame_info);
-            frame_count++;
+
+            if (nalu_type == 5 && first_slice) {
+                keyframe_offsets_.push_back(nalu_start);
+            }
+        } else if (nalu_type == 6) {
+            uint32_t duration = GetPictureDuration(data + nalu_start, nalu_size);
+            if (duration > 0) {
+                next_picture_duration = duration;
+            }
         }
 
         offset = nalu_start + nalu_size;
@@ -297,7 +421,7 @@ void SessionH264Reader::ExtractParameterSets() const
             break;
         }
 
-        if (nalu_type == 7) { // SPS
+        if (nalu_type == 7 && sps_.empty()) { // SPS
             sps_.assign(data + nalu_start, data + nalu_start + nalu_size);
             std::cout << "Found SPS, size: " << nalu_size << " bytes" << std::endl;
         } else if (nalu_type == 8) { // PPS
@@ -315,6 +439,27 @@ void SessionH264Reader::ExtractParameterSets() const
 
     parameter_sets_extracted_ = true;
 
+    // Time pictures from the VUI when present, otherwise keep the default frame rate
+    if (!sps_.empty()) {
+        size_t header = (sps_[2] == 0x00) ? 4 : 3;
+        auto sps = lmshao::lmcore::DataBuffer::Create(sps_.size() - header);
+        sps->Assign(sps_.data() + header, sps_.size() - header);
+        video_info_ = lmshao::lmrtsp::H264Parser::ParseSPS(sps);
+    }
+    if (video_info_.timing_info_present) {
+        num_units_in_tick_ = video_info_.num_units_in_tick;
+        time_scale_ = video_info_.time_scale;
+        frame_rate_ = static_cast<uint32_t>(std::lround(time_scale_ / (2.0 * num_units_in_tick_)));
+        frame_rate_ = std::max<uint32_t>(frame_rate_, 1);
+        std::cout << "VUI timing: " << num_units_in_tick_ << "/" << time_scale_ << " s per tick, "
+                  << (video_info_.fixed_frame_rate_flag ? "fixed" : "maximum") << " frame rate "
+                  << std::fixed << std::setprecision(3) << time_scale_ / (2.0 * num_units_in_tick_) << " fps"
+                  << (video_info_.pic_struct_present_flag ? ", picture timing SEI" : "") << std::endl;
+    } else {
+        num_units_in_tick_ = 1;
+        time_scale_ = frame_rate_ * 2;
+    }
+
     if (sps_.empty()) {
         std::cout << "No SPS found in file: " << mapped_file_->Path() << std::endl;
     }
@@ -340,10 +485,40 @@ bool SessionH264Reader::SeekToOffset(size_t offset)
     for (size_t i = 0; i < frame_index_.size(); ++i) {
         if (frame_index_[i].offset_ >= offset) {
             current_frame_index_ = i;
-            current_timestamp_ = frame_index_[i].timestamp_;
+            SeekToTicks(frame_index_[i].ticks_);
             break;
         }
     }
 
     return true;
-}
\ No newline at end of file
+}
+
+void SessionH264Reader::SeekToTicks(uint64_t ticks)
+{
+    picture_ticks_ = ticks;
+    next_picture_ticks_ = ticks;
+    next_picture_duration_ = 2;
+    last_ticks_ = ticks;
+    pts_base_ns_ = 0;
+    current_timestamp_ = TicksToNs(ticks) / 1e9;
+}
+
+uint32_t SessionH264Reader::GetPictureDuration(const uint8_t *sei, size_t size) const
+{
+    if (!video_info_.pic_struct_present_flag) {
+        return 0;
+    }
+
+    auto buffer = lmshao::lmcore::DataBuffer::Create(size);
+    buffer->Assign(sei, size);
+    int32_t ticks = lmshao::lmrtsp::H264Parser::GetPictureTicks(buffer, video_info_);
+    return ticks > 0 ? static_cast<uint32_t>(ticks) : 0;
+}
+
+int64_t SessionH264Reader::TicksToNs(uint64_t ticks) const
+{
+    // Split at whole seconds, so long files do not overflow
+    uint64_t units = ticks * num_units_in_tick_;
+    return static_cast<int64_t>((units / time_scale_) * 1000000000ULL +
+                                (units % time_scale_) * 1000000000ULL / time_scale_);
+}
@@ -13,14 +13,19 @@
 #include <vector>
 
 #include "lmcore/mapped_file.h"
+#include "lmrtsp/frame_classifier.h"
+#include "lmrtsp/h264_parser.h"
 
 /**
  * @brief Local frame structure for SessionH264Reader
  */
 struct LocalMediaFrame {
-    std::vector<uint8_t> data; ///< Frame data
-    uint64_t timestamp;        ///< Timestamp in milliseconds
-    bool is_keyframe;          ///< Whether this is a keyframe
+    std::vector<uint8_t> data;            ///< Frame data
+    uint64_t timestamp;                   ///< Timestamp in milliseconds
+    int64_t pts_ns;                       ///< Presentation time of the picture in nanoseconds
+    bool is_keyframe;                     ///< Whether this is a keyframe
+    lmshao::lmrtsp::FrameType frame_type; ///< Picture type of a slice NALU, UNKNOWN for other NALUs
+    bool is_reference;                    ///< Whether later pictures predict from this one
 };
 
 /**
@@ -29,6 +34,10 @@ struct LocalMediaFrame {
  * This class provides thread-safe H.264 frame reading from a shared
  * MappedFile instance. Each session maintains its own reading position
  * and playback state while sharing the underlying file mapping.
+ *
+ * Pictures are timed in clock ticks of the SPS VUI timing info, two per frame unless a picture timing SEI gives the
+ * picture's pic_struct. Without VUI timing a tick is half a frame at the default frame rate. Parameter sets and SEI
+ * carry the time of the picture they precede, all slices of a picture share its time.
  */
 class SessionH264Reader {
 public:
@@ -71,6 +80,20 @@ public:
      */
     bool SeekToFrame(size_t frame_index);
 
+    /**
+     * @brief Seek to the start of an IDR picture
+     * @param ordinal 0-based IDR picture number in the file, as given by GetKeyframeOrdinal()
+     * @return true if successful, false if the file has fewer IDR pictures
+     */
+    bool SeekToKeyframe(size_t ordinal);
+
+    /**
+     * @brief Check whether the last read NALU starts an IDR picture
+     * @param ordinal Output, 0-based IDR picture number in the file
+     * @return true if the last read NALU is the first slice of an IDR picture
+     */
+    bool GetKeyframeOrdinal(size_t &ordinal) const;
+
     /**
      * @brief Reset to the beginning of the file
      */
@@ -113,10 +136,21 @@ public:
 
     /**
      * @brief Get frame rate
-     * @return Frame rate in fps
+     * @return Frame rate in fps, rounded from the VUI timing when the SPS has it
      */
     uint32_t GetFrameRate() const;
 
+    /**
+     * @brief Set the frame rate used when the SPS has no VUI timing
+     * @param fps Frames per second
+     */
+    void SetDefaultFrameRate(uint32_t fps);
+
+    /**
+     * @brief Check whether picture times come from the SPS VUI timing
+     */
+    bool HasTimingInfo() const;
+
 private:
     /**
      * @brief Frame information structure for indexing
@@ -125,6 +159,7 @@ private:
         size_t offset_;     ///< Frame offset in file
         size_t size_;       ///< Frame size in bytes
         double timestamp_;  ///< Frame timestamp in seconds
+        uint64_t ticks_;    ///< Picture time in clock ticks
         bool is_keyframe_;  ///< Whether this is a keyframe (IDR)
         uint8_t nalu_type_; ///< NALU type
     };
@@ -135,20 +170,37 @@ private:
     size_t current_offset_;      ///< Current reading position
     size_t current_frame_index_; ///< Current frame index
     double current_timestamp_;   ///< Current timestamp
+    size_t last_nalu_offset_;    ///< Offset of the last read NALU
+
+    // Picture timing in clock ticks
+    uint64_t picture_ticks_ = 0;         ///< Time of the picture being read
+    uint64_t next_picture_ticks_ = 0;    ///< Time of the next picture
+    uint32_t next_picture_duration_ = 2; ///< Duration of the next picture, from its picture timing SEI
+    uint64_t last_ticks_ = 0;            ///< Time of the last read NALU
+    int64_t pts_base_ns_ = 0;            ///< Time of tick 0, moves when the default frame rate changes
+
+    lmshao::lmrtsp::FrameClassifier classifier_{lmshao::lmrtsp::MediaType::H264}; ///< Picture type of each NALU read
 
     // Frame index cache (built lazily)
     mutable std::vector<FrameInfo> frame_index_;
+    mutable std::vector<size_t> keyframe_offsets_; ///< Offsets of the first slice of each IDR picture
     mutable bool index_built_;
     mutable std::vector<uint8_t> sps_;
     mutable std::vector<uint8_t> pps_;
     mutable uint32_t frame_rate_;
     mutable bool parameter_sets_extracted_;
+    mutable lmshao::lmrtsp::H264VideoInfo video_info_;
+    mutable uint32_t num_units_in_tick_ = 1; ///< Clock tick is num_units_in_tick_ / time_scale_ seconds
+    mutable uint32_t time_scale_ = 50;
 
     // Internal methods
     bool FindNextNALU(size_t start_offset, size_t &nalu_start, size_t &nalu_size, uint8_t &nalu_type);
     void BuildFrameIndex() const;
     void ExtractParameterSets() const;
     bool SeekToOffset(size_t offset);
+    void SeekToTicks(uint64_t ticks);
+    uint32_t GetPictureDuration(const uint8_t *sei, size_t size) const;
+    int64_t TicksToNs(uint64_t ticks) const;
     int FindStartCode(const uint8_t *data, size_t start_pos, size_t data_size);
 };
 
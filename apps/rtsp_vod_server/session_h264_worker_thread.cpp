@@ -18,6 +18,18 @@
 #include "file_manager.h"
 #include "session_h264_reader.h"
 
+namespace {
+// Rendition adaptation thresholds
+constexpr int64_t ADAPT_CHECK_INTERVAL_US = 500000;  // Evaluate delivery stats twice a second
+constexpr int64_t STEP_UP_CLEAN_US = 10000000;       // Clean period before stepping up
+constexpr int64_t REPORT_MAX_AGE_MS = 10000;         // Older receiver reports are ignored
+constexpr uint8_t STEP_DOWN_LOSS = 13;               // ~5% loss, in 1/256
+constexpr uint8_t CLEAN_LOSS = 2;                    // ~1% loss
+constexpr uint32_t STEP_DOWN_RTT_MS = 400;           // Clean below half of it
+constexpr size_t STEP_DOWN_QUEUE_BYTES = 128 * 1024; // Half the interleaved congestion threshold
+constexpr size_t CLEAN_QUEUE_BYTES = 32 * 1024;
+} // namespace
+
 SessionH264WorkerThread::SessionH264WorkerThread(std::shared_ptr<RtspServerSession> session,
                                                  const std::string &file_path, uint32_t frame_rate, int track_index)
     : BaseSessionWorkerThread(session, file_path), frame_rate_(frame_rate), frame_counter_(0), track_index_(track_index)
@@ -36,6 +48,20 @@ SessionH264WorkerThread::~SessionH264WorkerThread()
     std::cout << "SessionH264WorkerThread destroyed for session: " << session_id_ << std::endl;
 }
 
+void SessionH264WorkerThread::SetRenditions(std::vector<std::string> rendition_paths)
+{
+    auto it = std::find(rendition_paths.begin(), rendition_paths.end(), file_path_);
+    if (rendition_paths.size() < 2 || it == rendition_paths.end()) {
+        std::cout << "Session " << session_id_ << " ignoring rendition set without " << file_path_ << std::endl;
+        return;
+    }
+
+    size_t start = static_cast<size_t>(std::distance(rendition_paths.begin(), it));
+    rendition_paths_ = std::move(rendition_paths);
+    active_rendition_.store(start);
+    target_rendition_.store(start);
+}
+
 bool SessionH264WorkerThread::InitializeReader()
 {
     // Get shared MappedFile through FileManager
@@ -45,20 +71,41 @@ bool SessionH264WorkerThread::InitializeReader()
         return false;
     }
 
+    uint32_t fps = frame_rate_.load();
+    if (fps == 0) {
+        fps = 25; // Default fallback
+    }
+
     // Create SessionH264Reader for independent playback
     h264_reader_ = std::make_unique<SessionH264Reader>(mapped_file);
+    h264_reader_->SetDefaultFrameRate(fps);
     frame_counter_.store(0);
 
-    // Calculate RTP timestamp increment based on frame rate
-    // RTP clock is 90kHz, so increment = 90000 / fps
-    uint32_t fps = frame_rate_.load();
-    if (fps == 0) {
-        fps = 25; // Default fallback
+    // Readers for the other renditions, positioned on switch
+    rendition_readers_.clear();
+    rendition_readers_.resize(rendition_paths_.size());
+    for (size_t i = 0; i < rendition_paths_.size(); ++i) {
+        if (i == active_rendition_.load()) {
+            continue;
+        }
+        auto rendition_file = FileManager::GetInstance().GetMappedFile(rendition_paths_[i]);
+        if (!rendition_file) {
+            std::cout << "Failed to get MappedFile for rendition: " << rendition_paths_[i] << std::endl;
+            return false;
+        }
+        rendition_readers_[i] = std::make_unique<SessionH264Reader>(rendition_file);
+        rendition_readers_[i]->SetDefaultFrameRate(fps);
     }
-    rtp_timestamp_increment_ = 90000 / fps;
+    next_adapt_check_us_ = 0;
+    clean_since_us_ = clock_->MonotonicUs();
 
-    std::cout << "RTP timestamp increment: " << rtp_timestamp_increment_ << " (90kHz clock, fps=" << fps << ")"
-              << std::endl;
+    // RTP timestamps follow the picture times, exact rational ticks from the SPS VUI or the frame rate
+    if (h264_reader_->HasTimingInfo()) {
+        std::cout << "Session " << session_id_ << " timed by SPS VUI, " << h264_reader_->GetFrameRate() << " fps"
+                  << std::endl;
+    } else {
+        std::cout << "Session " << session_id_ << " has no SPS VUI timing, using " << fps << " fps" << std::endl;
+    }
 
     return true;
 }
@@ -66,6 +113,7 @@ bool SessionH264WorkerThread::InitializeReader()
 void SessionH264WorkerThread::CleanupReader()
 {
     h264_reader_.reset();
+    rendition_readers_.clear();
 }
 
 void SessionH264WorkerThread::ReleaseFile()
@@ -73,6 +121,11 @@ void SessionH264WorkerThread::ReleaseFile()
     if (!file_path_.empty()) {
         FileManager::GetInstance().ReleaseMappedFile(file_path_);
     }
+    for (const auto &path : rendition_paths_) {
+        if (path != file_path_) {
+            FileManager::GetInstance().ReleaseMappedFile(path);
+        }
+    }
 }
 
 SessionH264Reader::PlaybackInfo SessionH264WorkerThread::GetPlaybackInfo() const
@@ -85,8 +138,10 @@ SessionH264Reader::PlaybackInfo SessionH264WorkerThread::GetPlaybackInfo() const
 
 bool SessionH264WorkerThread::SeekToFrame(size_t frame_index)
 {
+    std::lock_guard<std::mutex> lock(reader_mutex_);
     if (h264_reader_) {
         bool result = h264_reader_->SeekToFrame(frame_index);
+        DiscardReadAhead();
         if (result) {
             std::cout << "Session " << session_id_ << " seeked to frame: " << frame_index << std::endl;
         }
@@ -97,8 +152,10 @@ bool SessionH264WorkerThread::SeekToFrame(size_t frame_index)
 
 bool SessionH264WorkerThread::SeekToTime(double timestamp)
 {
+    std::lock_guard<std::mutex> lock(reader_mutex_);
     if (h264_reader_) {
         bool result = h264_reader_->SeekToTime(timestamp);
+        DiscardReadAhead();
         if (result) {
             std::cout << "Session " << session_id_ << " seeked to time: " << std::fixed << std::setprecision(2)
                       << timestamp << "s" << std::endl;
@@ -110,7 +167,11 @@ bool SessionH264WorkerThread::SeekToTime(double timestamp)
 
 void SessionH264WorkerThread::Reset()
 {
-    ResetReader();
+    {
+        std::lock_guard<std::mutex> lock(reader_mutex_);
+        ResetReader();
+        DiscardReadAhead();
+    }
     frame_counter_.store(0);
     std::cout << "Session " << session_id_ << " reset to beginning" << std::endl;
 }
@@ -126,6 +187,12 @@ void SessionH264WorkerThread::SetFrameRate(uint32_t fps)
 {
     if (fps > 0 && fps <= 120) { // Reasonable range
         frame_rate_.store(fps);
+        {
+            std::lock_guard<std::mutex> lock(reader_mutex_);
+            if (h264_reader_) {
+                h264_reader_->SetDefaultFrameRate(fps);
+            }
+        }
         std::cout << "Session " << session_id_ << " frame rate set to: " << fps << " fps" << std::endl;
     } else {
         std::cout << "Invalid frame rate: " << fps << ", keeping current: " << frame_rate_.load() << std::endl;
@@ -139,9 +206,44 @@ uint32_t SessionH264WorkerThread::GetFrameRate() const
 
 // Protected methods implementation
 
-bool SessionH264WorkerThread::SendNextData()
+bool SessionH264WorkerThread::ReadNextData(ReadAheadUnit &unit)
+{
+    if (!h264_reader_) {
+        return false;
+    }
+
+    LocalMediaFrame frame;
+    if (!h264_reader_->ReadNextFrame(frame)) {
+        return false; // EOF or error
+    }
+
+    // Switch at an IDR picture, the new rendition's parameter sets go in-band ahead of its IDR
+    size_t target = target_rendition_.load();
+    size_t keyframe_ordinal = 0;
+    if (target != active_rendition_.load() && h264_reader_->GetKeyframeOrdinal(keyframe_ordinal) &&
+        SwitchRendition(target, keyframe_ordinal)) {
+        if (!h264_reader_->ReadNextFrame(frame)) {
+            return false;
+        }
+        std::vector<uint8_t> sps = h264_reader_->GetSPS();
+        std::vector<uint8_t> pps = h264_reader_->GetPPS();
+        sps.insert(sps.end(), pps.begin(), pps.end());
+        frame.data.insert(frame.data.begin(), sps.begin(), sps.end());
+    }
+
+    // Copy out of the file mapping here, so page faults hit the read-ahead thread
+    unit.data = lmshao::lmcore::DataBuffer::Create(frame.data.size());
+    unit.data->Assign(frame.data.data(), frame.data.size());
+    unit.is_keyframe = frame.is_keyframe;
+    unit.frame_type = frame.frame_type;
+    unit.is_reference = frame.is_reference;
+    unit.pts_ns = frame.pts_ns;
+    return true;
+}
+
+bool SessionH264WorkerThread::SendData(const ReadAheadUnit &unit)
 {
-    return SendNextFrame();
+    return SendNextFrame(unit);
 }
 
 std::chrono::microseconds SessionH264WorkerThread::GetDataInterval() const
@@ -156,30 +258,23 @@ std::chrono::microseconds SessionH264WorkerThread::GetDataInterval() const
 
 // Private methods implementation
 
-bool SessionH264WorkerThread::SendNextFrame()
+bool SessionH264WorkerThread::SendNextFrame(const ReadAheadUnit &unit)
 {
-    if (!h264_reader_ || !session_) {
+    if (!unit.data || !session_) {
         return false;
     }
 
-    LocalMediaFrame frame;
-    if (!h264_reader_->ReadNextFrame(frame)) {
-        return false; // EOF or error
-    }
-
-    // Convert std::vector<uint8_t> to DataBuffer
-    auto data_buffer = lmshao::lmcore::DataBuffer::Create(frame.data.size());
-    data_buffer->Assign(frame.data.data(), frame.data.size());
-
     // Create MediaFrame for RTSP session
     lmshao::lmrtsp::MediaFrame rtsp_frame;
-    rtsp_frame.data = data_buffer;
-    // Calculate RTP timestamp using frame counter and increment
-    // RTP timestamp must be in 90kHz clock units for proper playback synchronization
-    // Using frame_counter ensures continuous, monotonic timestamps that VLC requires
-    rtsp_frame.timestamp = static_cast<uint32_t>(frame_counter_.load() * rtp_timestamp_increment_);
+    rtsp_frame.data = unit.data;
+    // RTP timestamp in 90kHz clock units from the stream time, which stays continuous across loops as VLC requires
+    rtsp_frame.timestamp = ToRtpTimestamp(unit.pts_ns);
     rtsp_frame.media_type = MediaType::H264;
-    rtsp_frame.video_param.is_key_frame = frame.is_keyframe;
+    rtsp_frame.departure_ns = unit.departure_ns;
+    rtsp_frame.departure_span_ns = unit.departure_span_ns;
+    rtsp_frame.video_param.is_key_frame = unit.is_keyframe;
+    rtsp_frame.video_param.frame_type = unit.frame_type;
+    rtsp_frame.video_param.is_reference = unit.is_reference;
 
     // Send frame to session
     // Use track_index if >= 0 (multi-track mode), otherwise use single-track mode
@@ -189,10 +284,14 @@ bool SessionH264WorkerThread::SendNextFrame()
     bool success =
         (track_index_ >= 0) ? session_->PushFrame(rtsp_frame, track_index_) : session_->PushFrame(rtsp_frame);
 
+    if (rendition_paths_.size() > 1) {
+        UpdateTargetRendition();
+    }
+
     if (success) {
         data_sent_++;
         bytes_sent_ += rtsp_frame.data->Size();
-        frame_counter_++; // Increment after successful send for next frame's RTP timestamp
+        frame_counter_++;
 
         std::cout << "Session " << session_id_ << " sent frame " << data_sent_.load()
                   << ", size: " << rtsp_frame.data->Size() << " bytes, RTP timestamp: " << rtsp_frame.timestamp
@@ -202,4 +301,65 @@ bool SessionH264WorkerThread::SendNextFrame()
     }
 
     return success;
-}
\ No newline at end of file
+}
+
+void SessionH264WorkerThread::UpdateTargetRendition()
+{
+    int64_t now = clock_->MonotonicUs();
+    if (now < next_adapt_check_us_) {
+        return;
+    }
+    next_adapt_check_us_ = now + ADAPT_CHECK_INTERVAL_US;
+
+    // A switch is still waiting for the next IDR picture
+    size_t active = active_rendition_.load();
+    if (target_rendition_.load() != active) {
+        return;
+    }
+
+    DeliveryStats stats = session_->GetDeliveryStats(track_index_);
+    bool fresh_report = stats.has_receiver_report && stats.report_age_ms <= REPORT_MAX_AGE_MS;
+    bool congested = stats.send_queue_bytes >= STEP_DOWN_QUEUE_BYTES ||
+                     (fresh_report && (stats.fraction_lost >= STEP_DOWN_LOSS || stats.rtt_ms >= STEP_DOWN_RTT_MS));
+    bool clean = stats.send_queue_bytes < CLEAN_QUEUE_BYTES &&
+                 (!fresh_report || (stats.fraction_lost <= CLEAN_LOSS && stats.rtt_ms < STEP_DOWN_RTT_MS / 2));
+
+    if (!clean) {
+        clean_since_us_ = now;
+    }
+
+    size_t target = active;
+    if (congested && active > 0) {
+        target = active - 1;
+    } else if (clean && active + 1 < rendition_paths_.size() && now - clean_since_us_ >= STEP_UP_CLEAN_US) {
+        target = active + 1;
+        clean_since_us_ = now;
+    }
+
+    if (target != active) {
+        std::cout << "Session " << session_id_ << " rendition " << active << " -> " << target
+                  << " requested, loss: " << static_cast<int>(stats.fraction_lost) << "/256, rtt: " << stats.rtt_ms
+                  << " ms, send queue: " << stats.send_queue_bytes << " bytes" << std::endl;
+        target_rendition_.store(target);
+    }
+}
+
+bool SessionH264WorkerThread::SwitchRendition(size_t target, size_t keyframe_ordinal)
+{
+    size_t active = active_rendition_.load();
+    if (target >= rendition_readers_.size() || !rendition_readers_[target] ||
+        !rendition_readers_[target]->SeekToKeyframe(keyframe_ordinal)) {
+        std::cout << "Session " << session_id_ << " cannot switch to rendition " << target << " at keyframe "
+                  << keyframe_ordinal << ", GOPs not aligned" << std::endl;
+        target_rendition_.store(active);
+        return false;
+    }
+
+    rendition_readers_[active].swap(h264_reader_);
+    h264_reader_.swap(rendition_readers_[target]);
+    active_rendition_.store(target);
+
+    std::cout << "Session " << session_id_ << " switched to rendition " << target << " (" << rendition_paths_[target]
+              << ") at keyframe " << keyframe_ordinal << std::endl;
+    return true;
+}
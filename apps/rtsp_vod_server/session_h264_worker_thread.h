@@ -17,6 +17,7 @@
 #include <chrono>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "base_session_worker_thread.h"
 #include "file_manager.h"
@@ -33,6 +34,7 @@ using namespace lmshao::lmcore;
  * - Maintains independent playback progress with SessionH264Reader
  * - Runs in its own thread for concurrent client support
  * - Handles frame timing and streaming control
+ * - Optionally switches between renditions of the same content (see SetRenditions)
  */
 class SessionH264WorkerThread : public BaseSessionWorkerThread {
 public:
@@ -80,7 +82,7 @@ public:
     void Reset() override;
 
     /**
-     * @brief Set frame rate for streaming
+     * @brief Set frame rate for streaming, used when the SPS has no VUI timing
      * @param fps Frames per second
      */
     void SetFrameRate(uint32_t fps);
@@ -91,6 +93,24 @@ public:
      */
     uint32_t GetFrameRate() const;
 
+    /**
+     * @brief Serve a set of renditions of the same content, call before Start()
+     *
+     * The renditions must share frame rate and GOP structure, so the n-th IDR picture is the same instant in all of
+     * them. The worker steps down on receiver loss, RTT or a growing TCP send queue and steps up again after a clean
+     * period. Switches happen at the next IDR picture: RTP sequence numbers and timestamps continue, and the new SPS
+     * and PPS are sent in-band with the IDR.
+     * @param rendition_paths Rendition files ordered from lowest to highest bitrate, one of them the file given at
+     *                        construction
+     */
+    void SetRenditions(std::vector<std::string> rendition_paths);
+
+    /**
+     * @brief Get the rendition currently being sent
+     * @return Index into the rendition list, 0 without renditions
+     */
+    size_t GetActiveRendition() const { return active_rendition_.load(); }
+
 protected:
     /**
      * @brief Initialize the reader (called by Start())
@@ -99,10 +119,18 @@ protected:
     bool InitializeReader() override;
 
     /**
-     * @brief Send next frame to client
-     * @return true if frame sent successfully, false if EOF or error
+     * @brief Read next frame from the H.264 reader (runs on the read-ahead pool)
+     * @param unit Output unit
+     * @return true if a frame was read, false if EOF or error
      */
-    bool SendNextData() override;
+    bool ReadNextData(ReadAheadUnit &unit) override;
+
+    /**
+     * @brief Send a read-ahead frame to client
+     * @param unit Read-ahead unit holding the frame
+     * @return true if frame sent successfully, false on error
+     */
+    bool SendData(const ReadAheadUnit &unit) override;
 
     /**
      * @brief Calculate frame interval based on frame rate
@@ -120,6 +148,11 @@ protected:
      */
     void CleanupReader() override;
 
+    /**
+     * @brief RTSP track index given at construction
+     */
+    int GetTrackIndex() const override { return track_index_; }
+
     /**
      * @brief Release file resources (called by Stop())
      */
@@ -127,24 +160,44 @@ protected:
 
 private:
     /**
-     * @brief Send next frame to client (internal implementation)
-     * @return true if frame sent successfully, false if EOF or error
+     * @brief Send a read-ahead frame to client (internal implementation)
+     * @param unit Read-ahead unit holding the frame
+     * @return true if frame sent successfully, false on error
+     */
+    bool SendNextFrame(const ReadAheadUnit &unit);
+
+    /**
+     * @brief Pick the rendition to switch to from the session's delivery stats (send thread)
+     */
+    void UpdateTargetRendition();
+
+    /**
+     * @brief Make the target rendition the active one, positioned at an IDR picture (read-ahead thread)
+     * @param target Rendition index
+     * @param keyframe_ordinal IDR picture to continue from
+     * @return true if switched
      */
-    bool SendNextFrame();
+    bool SwitchRendition(size_t target, size_t keyframe_ordinal);
 
     // H.264 reader for independent playback
     std::unique_ptr<SessionH264Reader> h264_reader_;
 
-    // Streaming parameters
+    // Streaming parameters, the frame rate only times files without SPS VUI timing
     std::atomic<uint32_t> frame_rate_;
     std::atomic<uint64_t> frame_counter_;
 
-    // RTP timestamp increment per frame (90kHz clock)
-    // Calculated as: 90000 / fps
-    uint32_t rtp_timestamp_increment_;
-
     // Track index for multi-track sessions (-1 for single-track)
     int track_index_;
+
+    // Renditions ordered by bitrate. The active reader is h264_reader_, its slot in rendition_readers_ is empty
+    std::vector<std::string> rendition_paths_;
+    std::vector<std::unique_ptr<SessionH264Reader>> rendition_readers_;
+    std::atomic<size_t> active_rendition_{0};
+    std::atomic<size_t> target_rendition_{0};
+
+    // Adaptation state, send thread only
+    int64_t next_adapt_check_us_ = 0;
+    int64_t clean_since_us_ = 0;
 };
 
 #endif // LMSHAO_RTSP_SESSION_H264_WORKER_THREAD_H
\ No newline at end of file
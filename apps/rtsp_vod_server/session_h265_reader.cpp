@@ -8,11 +8,27 @@
 
 #include "session_h265_reader.h"
 
+#include <lmcore/data_buffer.h>
+
 #include <algorithm>
+#include <cmath>
 #include <cstring>
 #include <iomanip>
 #include <iostream>
 
+namespace {
+bool IsVclNalu(uint8_t nalu_type)
+{
+    return nalu_type <= 9 || (nalu_type >= 16 && nalu_type <= 21);
+}
+
+// first_slice_segment_in_pic_flag is the first bit after the two-byte NALU header
+bool IsFirstSlice(const uint8_t *nalu, size_t size, size_t header)
+{
+    return header + 2 < size && (nalu[header + 2] & 0x80) != 0;
+}
+} // namespace
+
 SessionH265Reader::SessionH265Reader(std::shared_ptr<lmshao::lmcore::MappedFile> mapped_file)
     : mapped_file_(mapped_file), current_offset_(0), current_frame_index_(0), current_timestamp_(0.0),
       index_built_(false), frame_rate_(25), parameter_sets_extracted_(false)
@@ -35,14 +51,15 @@ bool SessionH265Reader::ReadNextFrame(LocalMediaFrameH265 &frame)
 
     frame.data = std::move(frame_data);
     frame.timestamp = static_cast<uint64_t>(current_timestamp_ * 1000);
-    frame.is_keyframe = false;
+    frame.pts_ns = pts_base_ns_ + TicksToNs(last_ticks_);
 
-    // Check if this is a keyframe (IDR/CRA frame)
-    if (!frame.data.empty() && frame.data.size() > 4) {
-        // H.265 NAL unit type is in bits [1-6] of the first byte after start code
-        uint8_t nalu_type = (frame.data[4] >> 1) & 0x3F;
-        frame.is_keyframe = (nalu_type >= 19 && nalu_type <= 21); // IDR or CRA
-    }
+    // Classified once here, IRAP pictures (IDR, CRA, BLA) are keyframes
+    lmshao::lmrtsp::VideoParam param;
+    classifier_.Classify(frame.data.data(), frame.data.size(), param);
+    frame.is_keyframe = param.is_key_frame;
+    frame.frame_type = param.frame_type;
+    frame.is_reference = param.is_reference;
+    frame.temporal_id = param.temporal_id;
 
     return true;
 }
@@ -62,9 +79,25 @@ bool SessionH265Reader::ReadNextFrame(std::vector<uint8_t> &frame_data)
     const uint8_t *data = mapped_file_->Data();
     frame_data.assign(data + nalu_start, data + nalu_start + nalu_size);
 
+    if (!parameter_sets_extracted_) {
+        ExtractParameterSets();
+    }
+
+    // A picture starts at its first slice, the NALUs before it belong to the next picture
+    size_t header = (data[nalu_start + 2] == 0x00) ? 4 : 3;
+    if (IsVclNalu(nalu_type)) {
+        if (IsFirstSlice(data + nalu_start, nalu_size, header)) {
+            picture_ticks_ = next_picture_ticks_;
+            next_picture_ticks_++;
+        }
+        last_ticks_ = picture_ticks_;
+    } else {
+        last_ticks_ = next_picture_ticks_;
+    }
+
     current_offset_ = nalu_start + nalu_size;
     current_frame_index_++;
-    current_timestamp_ = current_frame_index_ / static_cast<double>(frame_rate_);
+    current_timestamp_ = (pts_base_ns_ + TicksToNs(last_ticks_)) / 1e9;
 
     std::cout << "Session read frame " << current_frame_index_ << ", size: " << nalu_size << " bytes"
               << ", timestamp: " << std::fixed << std::setprecision(2) << current_timestamp_ << "s"
@@ -88,7 +121,7 @@ bool SessionH265Reader::SeekToFrame(size_t frame_index)
     const auto &frame_info = frame_index_[frame_index];
     current_offset_ = frame_info.offset_;
     current_frame_index_ = frame_index;
-    current_timestamp_ = frame_info.timestamp_;
+    SeekToTicks(frame_info.ticks_);
 
     std::cout << "Session seeked to frame " << frame_index << ", offset: " << current_offset_
               << ", timestamp: " << std::fixed << std::setprecision(2) << current_timestamp_ << "s" << std::endl;
@@ -117,7 +150,7 @@ void SessionH265Reader::Reset()
 {
     current_offset_ = 0;
     current_frame_index_ = 0;
-    current_timestamp_ = 0.0;
+    SeekToTicks(0);
 
     std::cout << "Session reset to beginning" << std::endl;
 }
@@ -175,6 +208,31 @@ uint32_t SessionH265Reader::GetFrameRate() const
     return frame_rate_;
 }
 
+void SessionH265Reader::SetDefaultFrameRate(uint32_t fps)
+{
+    if (fps == 0 || HasTimingInfo()) {
+        return;
+    }
+
+    // Keep the time already reached, later pictures advance at the new rate
+    pts_base_ns_ += TicksToNs(next_picture_ticks_);
+    picture_ticks_ = 0;
+    next_picture_ticks_ = 0;
+    last_ticks_ = 0;
+    frame_rate_ = fps;
+    num_units_in_tick_ = 1;
+    time_scale_ = fps;
+    index_built_ = false;
+}
+
+bool SessionH265Reader::HasTimingInfo() const
+{
+    if (!parameter_sets_extracted_) {
+        ExtractParameterSets();
+    }
+    return video_info_.timing_info_present;
+}
+
 int SessionH265Reader::FindStartCode(const uint8_t *data, size_t start_pos, size_t data_size)
 {
     if (start_pos + 3 >= data_size) {
@@ -236,9 +294,15 @@ void SessionH265Reader::BuildFrameIndex() const
 
     std::cout << "Building frame index for file: " << mapped_file_->Path() << std::endl;
 
+    if (!parameter_sets_extracted_) {
+        ExtractParameterSets();
+    }
+
     frame_index_.clear();
+    const uint8_t *data = mapped_file_->Data();
     size_t offset = 0;
-    size_t frame_count = 0;
+    uint64_t picture_ticks = 0;
+    uint64_t next_picture_ticks = 0;
 
     while (offset < mapped_file_->Size()) {
         size_t nalu_start, nalu_size;
@@ -249,17 +313,23 @@ void SessionH265Reader::BuildFrameIndex() const
             break;
         }
 
-        // H.265 frame NALU types: 0-9 (VCL NAL units), 16-21 (IDR/CRA/BLA)
-        if ((nalu_type >= 0 && nalu_type <= 9) || (nalu_type >= 16 && nalu_type <= 21)) {
+        // H.265 frame NALU types: 0-9 (VCL NAL units), 16-21 (IDR/CRA/BLA), timed like ReadNextFrame()
+        if (IsVclNalu(nalu_type)) {
+            size_t header = (data[nalu_start + 2] == 0x00) ? 4 : 3;
+            if (IsFirstSlice(data + nalu_start, nalu_size, header)) {
+                picture_ticks = next_picture_ticks;
+                next_picture_ticks++;
+            }
+
             FrameInfo frame_info;
             frame_info.offset_ = nalu_start;
             frame_info.size_ = nalu_size;
-            frame_info.timestamp_ = frame_count / static_cast<double>(frame_rate_);
+            frame_info.timestamp_ = TicksToNs(picture_ticks) / 1e9;
+            frame_info.ticks_ = picture_ticks;
             frame_info.is_keyframe_ = (nalu_type >= 19 && nalu_type <= 21);
             frame_info.nalu_type_ = nalu_type;
 
             frame_index_.push_back(frame_info);
-            frame_count++;
         }
 
         offset = nalu_start + nalu_size;
@@ -295,7 +365,7 @@ void SessionH265Reader::ExtractParameterSets() const
         if (nalu_type == 32) { // VPS
             vps_.assign(data + nalu_start, data + nalu_start + nalu_size);
             std::cout << "Found VPS, size: " << nalu_size << " bytes" << std::endl;
-        } else if (nalu_type == 33) { // SPS
+        } else if (nalu_type == 33 && sps_.empty()) { // SPS
             sps_.assign(data + nalu_start, data + nalu_start + nalu_size);
             std::cout << "Found SPS, size: " << nalu_size << " bytes" << std::endl;
         } else if (nalu_type == 34) { // PPS
@@ -312,6 +382,25 @@ void SessionH265Reader::ExtractParameterSets() const
 
     parameter_sets_extracted_ = true;
 
+    // Time pictures from the VUI when present, otherwise keep the default frame rate
+    if (!sps_.empty()) {
+        auto sps = lmshao::lmcore::DataBuffer::Create(sps_.size());
+        sps->Assign(sps_.data(), sps_.size());
+        video_info_ = lmshao::lmrtsp::H265Parser::ParseSPS(sps);
+    }
+    if (video_info_.timing_info_present) {
+        num_units_in_tick_ = video_info_.num_units_in_tick;
+        time_scale_ = video_info_.time_scale;
+        frame_rate_ = static_cast<uint32_t>(std::lround(time_scale_ / static_cast<double>(num_units_in_tick_)));
+        frame_rate_ = std::max<uint32_t>(frame_rate_, 1);
+        std::cout << "VUI timing: " << num_units_in_tick_ << "/" << time_scale_ << " s per picture, " << std::fixed
+                  << std::setprecision(3) << time_scale_ / static_cast<double>(num_units_in_tick_) << " fps"
+                  << std::endl;
+    } else {
+        num_units_in_tick_ = 1;
+        time_scale_ = frame_rate_;
+    }
+
     if (vps_.empty()) {
         std::cout << "No VPS found in file: " << mapped_file_->Path() << std::endl;
     }
@@ -338,10 +427,27 @@ bool SessionH265Reader::SeekToOffset(size_t offset)
     for (size_t i = 0; i < frame_index_.size(); ++i) {
         if (frame_index_[i].offset_ >= offset) {
             current_frame_index_ = i;
-            current_timestamp_ = frame_index_[i].timestamp_;
+            SeekToTicks(frame_index_[i].ticks_);
             break;
         }
     }
 
     return true;
 }
+
+void SessionH265Reader::SeekToTicks(uint64_t ticks)
+{
+    picture_ticks_ = ticks;
+    next_picture_ticks_ = ticks;
+    last_ticks_ = ticks;
+    pts_base_ns_ = 0;
+    current_timestamp_ = TicksToNs(ticks) / 1e9;
+}
+
+int64_t SessionH265Reader::TicksToNs(uint64_t ticks) const
+{
+    // Split at whole seconds, so long files do not overflow
+    uint64_t units = ticks * num_units_in_tick_;
+    return static_cast<int64_t>((units / time_scale_) * 1000000000ULL +
+                                (units % time_scale_) * 1000000000ULL / time_scale_);
+}
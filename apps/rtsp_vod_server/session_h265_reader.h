@@ -13,6 +13,8 @@
 #include <vector>
 
 #include "lmcore/mapped_file.h"
+#include "lmrtsp/frame_classifier.h"
+#include "lmrtsp/h265_parser.h"
 
 /**
  * @brief Local frame structure for SessionH265Reader
@@ -20,11 +22,18 @@
 struct LocalMediaFrameH265 {
     std::vector<uint8_t> data;
     uint64_t timestamp;
+    int64_t pts_ns; // Presentation time of the picture in nanoseconds
     bool is_keyframe;
+    lmshao::lmrtsp::FrameType frame_type; // Picture type of a slice NALU, UNKNOWN for other NALUs
+    bool is_reference;                    // Whether later pictures of the same temporal layer predict from this one
+    uint8_t temporal_id;                  // TemporalId of the NALU
 };
 
 /**
  * @brief Session-specific H.265 reader with independent playback state
+ *
+ * Pictures last one clock tick of the SPS VUI timing info, or one frame at the default frame rate without it.
+ * Parameter sets and SEI carry the time of the picture they precede, all slices of a picture share its time.
  */
 class SessionH265Reader {
 public:
@@ -52,12 +61,15 @@ public:
     std::vector<uint8_t> GetSPS() const;
     std::vector<uint8_t> GetPPS() const;
     uint32_t GetFrameRate() const;
+    void SetDefaultFrameRate(uint32_t fps);
+    bool HasTimingInfo() const;
 
 private:
     struct FrameInfo {
         size_t offset_;
         size_t size_;
         double timestamp_;
+        uint64_t ticks_;
         bool is_keyframe_;
         uint8_t nalu_type_;
     };
@@ -68,6 +80,15 @@ private:
     size_t current_frame_index_;
     double current_timestamp_;
 
+    // Picture timing in clock ticks
+    uint64_t picture_ticks_ = 0;
+    uint64_t next_picture_ticks_ = 0;
+    uint64_t last_ticks_ = 0;
+    int64_t pts_base_ns_ = 0;
+
+    // Keeps num_extra_slice_header_bits of the PPS NALUs read before the slices
+    lmshao::lmrtsp::FrameClassifier classifier_{lmshao::lmrtsp::MediaType::H265};
+
     mutable std::vector<FrameInfo> frame_index_;
     mutable bool index_built_;
     mutable std::vector<uint8_t> vps_;
@@ -75,11 +96,16 @@ private:
     mutable std::vector<uint8_t> pps_;
     mutable uint32_t frame_rate_;
     mutable bool parameter_sets_extracted_;
+    mutable lmshao::lmrtsp::H265VideoInfo video_info_;
+    mutable uint32_t num_units_in_tick_ = 1;
+    mutable uint32_t time_scale_ = 25;
 
     bool FindNextNALU(size_t start_offset, size_t &nalu_start, size_t &nalu_size, uint8_t &nalu_type);
     void BuildFrameIndex() const;
     void ExtractParameterSets() const;
     bool SeekToOffset(size_t offset);
+    void SeekToTicks(uint64_t ticks);
+    int64_t TicksToNs(uint64_t ticks) const;
     int FindStartCode(const uint8_t *data, size_t start_pos, size_t data_size);
 };
 
@@ -20,8 +20,7 @@
 
 SessionH265WorkerThread::SessionH265WorkerThread(std::shared_ptr<RtspServerSession> session,
                                                  const std::string &file_path, uint32_t frame_rate)
-    : BaseSessionWorkerThread(session, file_path), frame_rate_(frame_rate), frame_counter_(0),
-      rtp_timestamp_increment_(3600)
+    : BaseSessionWorkerThread(session, file_path), frame_rate_(frame_rate), frame_counter_(0)
 {
     if (!session_) {
         std::cout << "Invalid RtspServerSession provided to SessionH265WorkerThread" << std::endl;
@@ -45,19 +44,22 @@ bool SessionH265WorkerThread::InitializeReader()
         return false;
     }
 
-    h265_reader_ = std::make_unique<SessionH265Reader>(mapped_file);
-    frame_counter_.store(0);
-
-    // Calculate RTP timestamp increment based on frame rate
-    // RTP clock is 90kHz, so increment = 90000 / fps
     uint32_t fps = frame_rate_.load();
     if (fps == 0) {
         fps = 25; // Default fallback
     }
-    rtp_timestamp_increment_ = 90000 / fps;
 
-    std::cout << "RTP timestamp increment: " << rtp_timestamp_increment_ << " (90kHz clock, fps=" << fps << ")"
-              << std::endl;
+    h265_reader_ = std::make_unique<SessionH265Reader>(mapped_file);
+    h265_reader_->SetDefaultFrameRate(fps);
+    frame_counter_.store(0);
+
+    // RTP timestamps follow the picture times, exact rational ticks from the SPS VUI or the frame rate
+    if (h265_reader_->HasTimingInfo()) {
+        std::cout << "Session " << session_id_ << " timed by SPS VUI, " << h265_reader_->GetFrameRate() << " fps"
+                  << std::endl;
+    } else {
+        std::cout << "Session " << session_id_ << " has no SPS VUI timing, using " << fps << " fps" << std::endl;
+    }
 
     return true;
 }
@@ -84,8 +86,10 @@ SessionH265Reader::PlaybackInfo SessionH265WorkerThread::GetPlaybackInfo() const
 
 bool SessionH265WorkerThread::SeekToFrame(size_t frame_index)
 {
+    std::lock_guard<std::mutex> lock(reader_mutex_);
     if (h265_reader_) {
         bool result = h265_reader_->SeekToFrame(frame_index);
+        DiscardReadAhead();
         if (result) {
             std::cout << "Session " << session_id_ << " seeked to frame: " << frame_index << std::endl;
         }
@@ -96,8 +100,10 @@ bool SessionH265WorkerThread::SeekToFrame(size_t frame_index)
 
 bool SessionH265WorkerThread::SeekToTime(double timestamp)
 {
+    std::lock_guard<std::mutex> lock(reader_mutex_);
     if (h265_reader_) {
         bool result = h265_reader_->SeekToTime(timestamp);
+        DiscardReadAhead();
         if (result) {
             std::cout << "Session " << session_id_ << " seeked to time: " << std::fixed << std::setprecision(2)
                       << timestamp << "s" << std::endl;
@@ -109,7 +115,11 @@ bool SessionH265WorkerThread::SeekToTime(double timestamp)
 
 void SessionH265WorkerThread::Reset()
 {
-    ResetReader();
+    {
+        std::lock_guard<std::mutex> lock(reader_mutex_);
+        ResetReader();
+        DiscardReadAhead();
+    }
     frame_counter_.store(0);
     std::cout << "Session " << session_id_ << " reset to beginning" << std::endl;
 }
@@ -125,6 +135,12 @@ void SessionH265WorkerThread::SetFrameRate(uint32_t fps)
 {
     if (fps > 0 && fps <= 120) {
         frame_rate_.store(fps);
+        {
+            std::lock_guard<std::mutex> lock(reader_mutex_);
+            if (h265_reader_) {
+                h265_reader_->SetDefaultFrameRate(fps);
+            }
+        }
         std::cout << "Session " << session_id_ << " frame rate set to: " << fps << " fps" << std::endl;
     } else {
         std::cout << "Invalid frame rate: " << fps << ", keeping current: " << frame_rate_.load() << std::endl;
@@ -136,9 +152,31 @@ uint32_t SessionH265WorkerThread::GetFrameRate() const
     return frame_rate_.load();
 }
 
-bool SessionH265WorkerThread::SendNextData()
+bool SessionH265WorkerThread::ReadNextData(ReadAheadUnit &unit)
 {
-    return SendNextFrame();
+    if (!h265_reader_) {
+        return false;
+    }
+
+    LocalMediaFrameH265 frame;
+    if (!h265_reader_->ReadNextFrame(frame)) {
+        return false; // EOF or error
+    }
+
+    // Copy out of the file mapping here, so page faults hit the read-ahead thread
+    unit.data = lmshao::lmcore::DataBuffer::Create(frame.data.size());
+    unit.data->Assign(frame.data.data(), frame.data.size());
+    unit.is_keyframe = frame.is_keyframe;
+    unit.frame_type = frame.frame_type;
+    unit.is_reference = frame.is_reference;
+    unit.temporal_id = frame.temporal_id;
+    unit.pts_ns = frame.pts_ns;
+    return true;
+}
+
+bool SessionH265WorkerThread::SendData(const ReadAheadUnit &unit)
+{
+    return SendNextFrame(unit);
 }
 
 std::chrono::microseconds SessionH265WorkerThread::GetDataInterval() const
@@ -150,28 +188,23 @@ std::chrono::microseconds SessionH265WorkerThread::GetDataInterval() const
     return std::chrono::microseconds(1000000 / fps);
 }
 
-bool SessionH265WorkerThread::SendNextFrame()
+bool SessionH265WorkerThread::SendNextFrame(const ReadAheadUnit &unit)
 {
-    if (!h265_reader_ || !session_) {
+    if (!unit.data || !session_) {
         return false;
     }
 
-    LocalMediaFrameH265 frame;
-    if (!h265_reader_->ReadNextFrame(frame)) {
-        return false;
-    }
-
-    auto data_buffer = lmshao::lmcore::DataBuffer::Create(frame.data.size());
-    data_buffer->Assign(frame.data.data(), frame.data.size());
-
     lmshao::lmrtsp::MediaFrame rtsp_frame;
-    rtsp_frame.data = data_buffer;
-    // Calculate RTP timestamp using frame counter and increment
-    // RTP timestamp must be in 90kHz clock units for proper playback synchronization
-    // Using frame_counter ensures continuous, monotonic timestamps that VLC requires
-    rtsp_frame.timestamp = static_cast<uint32_t>(frame_counter_.load() * rtp_timestamp_increment_);
+    rtsp_frame.data = unit.data;
+    // RTP timestamp in 90kHz clock units from the stream time, which stays continuous across loops as VLC requires
+    rtsp_frame.timestamp = ToRtpTimestamp(unit.pts_ns);
     rtsp_frame.media_type = MediaType::H265;
-    rtsp_frame.video_param.is_key_frame = frame.is_keyframe;
+    rtsp_frame.departure_ns = unit.departure_ns;
+    rtsp_frame.departure_span_ns = unit.departure_span_ns;
+    rtsp_frame.video_param.is_key_frame = unit.is_keyframe;
+    rtsp_frame.video_param.frame_type = unit.frame_type;
+    rtsp_frame.video_param.is_reference = unit.is_reference;
+    rtsp_frame.video_param.temporal_id = unit.temporal_id;
 
     bool success = session_->PushFrame(rtsp_frame);
 
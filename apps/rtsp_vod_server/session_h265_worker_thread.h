@@ -43,21 +43,19 @@ public:
 
 protected:
     bool InitializeReader() override;
-    bool SendNextData() override;
+    bool ReadNextData(ReadAheadUnit &unit) override;
+    bool SendData(const ReadAheadUnit &unit) override;
     std::chrono::microseconds GetDataInterval() const override;
     void ResetReader() override;
     void CleanupReader() override;
     void ReleaseFile() override;
 
 private:
-    bool SendNextFrame();
+    bool SendNextFrame(const ReadAheadUnit &unit);
     std::unique_ptr<SessionH265Reader> h265_reader_;
+    // The frame rate only times files without SPS VUI timing
     std::atomic<uint32_t> frame_rate_;
     std::atomic<uint64_t> frame_counter_;
-
-    // RTP timestamp increment per frame (90kHz clock)
-    // Calculated as: 90000 / fps
-    uint32_t rtp_timestamp_increment_;
 };
 
 #endif // LMSHAO_RTSP_SESSION_H265_WORKER_THREAD_H
@@ -39,7 +39,8 @@ bool SessionManager::StartSession(std::shared_ptr<RtspServerSession> session, co
 
 bool SessionManager::StartSession(std::shared_ptr<RtspServerSession> session, const std::string &file_path,
                                   const std::string &codec, uint32_t frame_rate, uint32_t bitrate,
-                                  uint64_t track_number, int rtsp_track_index, const std::string &custom_session_id)
+                                  uint64_t track_number, int rtsp_track_index, const std::string &custom_session_id,
+                                  const std::vector<std::string> &rendition_paths)
 {
     if (!session) {
         std::cout << "Cannot start session: invalid RtspServerSession" << std::endl;
@@ -65,6 +66,9 @@ bool SessionManager::StartSession(std::shared_ptr<RtspServerSession> session, co
         // Use rtsp_track_index for H264 if >= 0 (multi-track mode), otherwise -1 (single-track)
         int track_index = (rtsp_track_index >= 0) ? rtsp_track_index : -1;
         auto h264_worker = std::make_shared<SessionH264WorkerThread>(session, file_path, frame_rate, track_index);
+        if (rendition_paths.size() > 1) {
+            h264_worker->SetRenditions(rendition_paths);
+        }
         if (!h264_worker->Start()) {
             std::cout << "Failed to start H264 worker thread for session: " << session_id << std::endl;
             return false;
@@ -16,6 +16,7 @@
 #include <mutex>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "isession_worker.h"
 
@@ -63,11 +64,13 @@ public:
      * @param track_number Track number for MKV (0 for single track)
      * @param rtsp_track_index RTSP track index for MKV multi-track (0, 1, 2...)
      * @param custom_session_id Optional custom session ID (for multi-track sessions)
+     * @param rendition_paths H.264 renditions to switch between, lowest bitrate first, including file_path
      * @return true if started successfully, false otherwise
      */
     bool StartSession(std::shared_ptr<RtspServerSession> session, const std::string &file_path,
                       const std::string &codec, uint32_t frame_rate = 25, uint32_t bitrate = 2000000,
-                      uint64_t track_number = 0, int rtsp_track_index = -1, const std::string &custom_session_id = "");
+                      uint64_t track_number = 0, int rtsp_track_index = -1, const std::string &custom_session_id = "",
+                      const std::vector<std::string> &rendition_paths = {});
 
     /**
      * @brief Stop a session worker thread
@@ -56,6 +56,7 @@ void SessionMkvReader::ReaderListener::OnFrame(const MkvFrame &frame)
     LocalMediaFrameMkv local_frame;
     local_frame.data.assign(frame.data, frame.data + frame.size);
     local_frame.timestamp = frame.timecode_ns / 1000000; // Convert ns to ms
+    local_frame.timestamp_ns = frame.timecode_ns;
     local_frame.is_keyframe = frame.keyframe;
 
     parent_->frame_queue_.push(std::move(local_frame));
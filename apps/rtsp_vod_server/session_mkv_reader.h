@@ -24,7 +24,8 @@
  */
 struct LocalMediaFrameMkv {
     std::vector<uint8_t> data;
-    uint64_t timestamp; // in milliseconds
+    uint64_t timestamp;   // in milliseconds
+    int64_t timestamp_ns; // Block timecode in nanoseconds
     bool is_keyframe;
 };
 
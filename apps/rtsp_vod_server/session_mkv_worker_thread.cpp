@@ -21,7 +21,7 @@
 SessionMkvWorkerThread::SessionMkvWorkerThread(std::shared_ptr<RtspServerSession> session, const std::string &file_path,
                                                uint64_t track_number, int rtsp_track_index, uint32_t frame_rate)
     : BaseSessionWorkerThread(session, file_path), track_number_(track_number), rtsp_track_index_(rtsp_track_index),
-      frame_rate_(frame_rate), frame_counter_(0), rtp_timestamp_increment_(3600)
+      frame_rate_(frame_rate), frame_counter_(0)
 {
     if (!session_) {
         std::cout << "Invalid RtspServerSession provided to SessionMkvWorkerThread" << std::endl;
@@ -65,24 +65,13 @@ bool SessionMkvWorkerThread::InitializeReader()
         std::cout << "Using configured frame rate: " << frame_rate_.load() << std::endl;
     }
 
-    // Calculate RTP timestamp increment based on actual frame rate
-    // RTP clock is 90kHz, so increment = 90000 / fps
-    uint32_t fps = frame_rate_.load();
-    if (fps == 0) {
-        fps = 25; // Default fallback
-    }
-
-    if (fps > 1000) {
-        // Audio: fps is scaled by 1000, actual fps = fps / 1000
-        // For audio, RTP clock is typically 48kHz, but we use 90kHz for consistency
-        // Increment = 90000 / (fps / 1000) = 90000 * 1000 / fps
-        rtp_timestamp_increment_ = (90000 * 1000) / fps;
-    } else {
-        // Video: normal fps
-        rtp_timestamp_increment_ = 90000 / fps;
-    }
-
-    std::cout << "RTP timestamp increment: " << rtp_timestamp_increment_ << " (90kHz clock)" << std::endl;
+    // RTP timestamps use the 90kHz clock for video and, for consistency, audio. Video frames carry their block
+    // timecodes, audio frames are counted so the sample clock does not pick up the timecode rounding
+    MediaType media_type = GetMediaType();
+    is_video_ = media_type == MediaType::H264 || media_type == MediaType::H265;
+    audio_frames_ = 0;
+    std::cout << "RTP timestamps from " << (is_video_ ? "block timecodes" : "audio frame count") << " (90kHz clock)"
+              << std::endl;
 
     frame_counter_.store(0);
     return true;
@@ -110,7 +99,11 @@ SessionMkvReader::PlaybackInfo SessionMkvWorkerThread::GetPlaybackInfo() const
 
 void SessionMkvWorkerThread::Reset()
 {
-    ResetReader();
+    {
+        std::lock_guard<std::mutex> lock(reader_mutex_);
+        ResetReader();
+        DiscardReadAhead();
+    }
     frame_counter_.store(0);
     std::cout << "Session " << session_id_ << " reset to beginning" << std::endl;
 }
@@ -120,11 +113,39 @@ void SessionMkvWorkerThread::ResetReader()
     if (mkv_reader_) {
         mkv_reader_->Reset();
     }
+    audio_frames_ = 0;
+}
+
+bool SessionMkvWorkerThread::ReadNextData(ReadAheadUnit &unit)
+{
+    if (!mkv_reader_) {
+        return false;
+    }
+
+    LocalMediaFrameMkv frame;
+    if (!mkv_reader_->ReadNextFrame(frame)) {
+        return false; // EOF or error
+    }
+
+    // Copy out here, so demuxer refills and page faults hit the read-ahead thread
+    unit.data = lmshao::lmcore::DataBuffer::Create(frame.data.size());
+    unit.data->Assign(frame.data.data(), frame.data.size());
+    unit.is_keyframe = frame.is_keyframe;
+
+    if (is_video_) {
+        unit.pts_ns = frame.timestamp_ns;
+    } else {
+        // Audio rates are scaled by 1000, a frame lasts 1000 / fps seconds. Split at whole seconds against overflow
+        uint64_t fps = std::max<uint32_t>(frame_rate_.load(), 1);
+        uint64_t scaled = audio_frames_++ * (fps > 1000 ? 1000 : 1);
+        unit.pts_ns = static_cast<int64_t>((scaled / fps) * 1000000000ULL + (scaled % fps) * 1000000000ULL / fps);
+    }
+    return true;
 }
 
-bool SessionMkvWorkerThread::SendNextData()
+bool SessionMkvWorkerThread::SendData(const ReadAheadUnit &unit)
 {
-    return SendNextFrame();
+    return SendNextFrame(unit);
 }
 
 std::chrono::microseconds SessionMkvWorkerThread::GetDataInterval() const
@@ -147,29 +168,29 @@ std::chrono::microseconds SessionMkvWorkerThread::GetDataInterval() const
     return std::chrono::microseconds(static_cast<long long>(interval_us));
 }
 
-bool SessionMkvWorkerThread::SendNextFrame()
+bool SessionMkvWorkerThread::SendNextFrame(const ReadAheadUnit &unit)
 {
-    if (!mkv_reader_ || !session_) {
+    if (!unit.data || !session_) {
         std::cout << "Session " << session_id_ << " track " << rtsp_track_index_
-                  << " SendNextFrame: reader or session is null" << std::endl;
+                  << " SendNextFrame: data or session is null" << std::endl;
         return false;
     }
 
-    LocalMediaFrameMkv frame;
-    if (!mkv_reader_->ReadNextFrame(frame)) {
-        return false; // EOF or error
-    }
-
-    // Convert std::vector<uint8_t> to DataBuffer
-    auto data_buffer = lmshao::lmcore::DataBuffer::Create(frame.data.size());
-    data_buffer->Assign(frame.data.data(), frame.data.size());
-
     // Create MediaFrame for RTSP session
     lmshao::lmrtsp::MediaFrame rtsp_frame;
-    rtsp_frame.data = data_buffer;
-    // Use calculated RTP timestamp increment based on actual frame rate
-    rtsp_frame.timestamp = static_cast<uint32_t>(frame_counter_.load() * rtp_timestamp_increment_);
+    rtsp_frame.data = unit.data;
+    // RTP timestamp from the stream time, exact for both block timecodes and counted audio frames
+    rtsp_frame.timestamp = ToRtpTimestamp(unit.pts_ns);
     rtsp_frame.media_type = GetMediaType();
+    rtsp_frame.departure_ns = unit.departure_ns;
+    rtsp_frame.departure_span_ns = unit.departure_span_ns;
+    if (is_video_) {
+        // Matroska marks random access points on the block, the picture type is not known without parsing
+        rtsp_frame.video_param.is_key_frame = unit.is_keyframe;
+        if (unit.is_keyframe) {
+            rtsp_frame.video_param.frame_type = FrameType::IDR;
+        }
+    }
 
     // Send frame to session (multi-track version)
     bool success = session_->PushFrame(rtsp_frame, rtsp_track_index_);
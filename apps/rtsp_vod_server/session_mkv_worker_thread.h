@@ -59,18 +59,21 @@ public:
 
 protected:
     bool InitializeReader() override;
-    bool SendNextData() override;
+    bool ReadNextData(ReadAheadUnit &unit) override;
+    bool SendData(const ReadAheadUnit &unit) override;
     std::chrono::microseconds GetDataInterval() const override;
     void ResetReader() override;
     void CleanupReader() override;
     void ReleaseFile() override;
+    int GetTrackIndex() const override { return rtsp_track_index_; }
 
 private:
     /**
-     * @brief Send next frame to client (internal implementation)
-     * @return true if frame sent successfully, false if EOF or error
+     * @brief Send a read-ahead frame to client (internal implementation)
+     * @param unit Read-ahead unit holding the frame
+     * @return true if frame sent successfully, false on error
      */
-    bool SendNextFrame();
+    bool SendNextFrame(const ReadAheadUnit &unit);
 
     /**
      * @brief Determine media type from codec ID
@@ -82,7 +85,8 @@ private:
     std::unique_ptr<SessionMkvReader> mkv_reader_;
     std::atomic<uint32_t> frame_rate_; // frames per second (video) or samples per second (audio)
     std::atomic<uint64_t> frame_counter_;
-    uint32_t rtp_timestamp_increment_; // RTP timestamp increment per frame (90kHz clock)
+    bool is_video_ = false;     // Video frames are timed by their block timecodes
+    uint64_t audio_frames_ = 0; // Audio frames read, their time is counted exactly, guarded by reader_mutex_
 };
 
 #endif // LMSHAO_RTSP_SESSION_MKV_WORKER_THREAD_H
@@ -97,7 +97,11 @@ SessionTSReader::PlaybackInfo SessionTSWorkerThread::GetPlaybackInfo() const
 
 void SessionTSWorkerThread::Reset()
 {
-    ResetReader();
+    {
+        std::lock_guard<std::mutex> lock(reader_mutex_);
+        ResetReader();
+        DiscardReadAhead();
+    }
     packet_counter_.store(0);
     use_pcr_ = false;
     last_pcr_ = 0;
@@ -113,9 +117,25 @@ void SessionTSWorkerThread::ResetReader()
     }
 }
 
-bool SessionTSWorkerThread::SendNextData()
+bool SessionTSWorkerThread::ReadNextData(ReadAheadUnit &unit)
 {
-    return SendNextPacket();
+    if (!ts_reader_) {
+        return false;
+    }
+
+    std::vector<uint8_t> packet_data;
+    if (!ts_reader_->ReadNextPacket(packet_data)) {
+        return false; // EOF or error
+    }
+
+    unit.data = lmshao::lmcore::DataBuffer::Create(packet_data.size());
+    unit.data->Assign(packet_data.data(), packet_data.size());
+    return true;
+}
+
+bool SessionTSWorkerThread::SendData(const ReadAheadUnit &unit)
+{
+    return SendNextPacket(unit);
 }
 
 std::chrono::microseconds SessionTSWorkerThread::GetDataInterval() const
@@ -133,20 +153,15 @@ std::chrono::microseconds SessionTSWorkerThread::GetDataInterval() const
     return std::chrono::microseconds(static_cast<long long>(interval_us));
 }
 
-bool SessionTSWorkerThread::SendNextPacket()
+bool SessionTSWorkerThread::SendNextPacket(const ReadAheadUnit &unit)
 {
-    if (!ts_reader_ || !session_) {
+    if (!unit.data || !session_) {
         return false;
     }
 
-    std::vector<uint8_t> packet_data;
-    if (!ts_reader_->ReadNextPacket(packet_data)) {
-        return false; // EOF or error
-    }
-
     // Parse TS packet to extract PCR
     TSPacketInfo packet_info;
-    bool packet_valid = TSParser::ParsePacket(packet_data.data(), packet_info);
+    bool packet_valid = TSParser::ParsePacket(unit.data->Data(), packet_info);
 
     // Calculate RTP timestamp
     uint32_t rtp_timestamp = 0;
@@ -200,15 +215,13 @@ bool SessionTSWorkerThread::SendNextPacket()
         }
     }
 
-    // Convert std::vector<uint8_t> to DataBuffer
-    auto data_buffer = lmshao::lmcore::DataBuffer::Create(packet_data.size());
-    data_buffer->Assign(packet_data.data(), packet_data.size());
-
     // Create MediaFrame for RTSP session
     lmshao::lmrtsp::MediaFrame rtsp_frame;
-    rtsp_frame.data = data_buffer;
+    rtsp_frame.data = unit.data;
     rtsp_frame.timestamp = rtp_timestamp;
     rtsp_frame.media_type = MediaType::MP2T;
+    rtsp_frame.departure_ns = unit.departure_ns;
+    rtsp_frame.departure_span_ns = unit.departure_span_ns;
 
     // Send frame to session
     bool success = session_->PushFrame(rtsp_frame);
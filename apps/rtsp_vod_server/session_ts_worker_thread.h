@@ -59,7 +59,8 @@ public:
 
 protected:
     bool InitializeReader() override;
-    bool SendNextData() override;
+    bool ReadNextData(ReadAheadUnit &unit) override;
+    bool SendData(const ReadAheadUnit &unit) override;
     std::chrono::microseconds GetDataInterval() const override;
     void ResetReader() override;
     void CleanupReader() override;
@@ -67,10 +68,11 @@ protected:
 
 private:
     /**
-     * @brief Send next TS packet to client (internal implementation)
-     * @return true if packet sent successfully, false if EOF or error
+     * @brief Send a read-ahead TS packet to client (internal implementation)
+     * @param unit Read-ahead unit holding the TS packet
+     * @return true if packet sent successfully, false on error
      */
-    bool SendNextPacket();
+    bool SendNextPacket(const ReadAheadUnit &unit);
 
     // TS reader for independent playback
     std::unique_ptr<SessionTSReader> ts_reader_;
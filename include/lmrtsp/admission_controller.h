@@ -0,0 +1,164 @@
+/**
+ * @author SHAO Liming <lmshao@163.com>
+ * @copyright Copyright (c) 2025 SHAO Liming
+ * @license MIT
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef LMSHAO_LMRTSP_ADMISSION_CONTROLLER_H
+#define LMSHAO_LMRTSP_ADMISSION_CONTROLLER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "lmrtsp/clock.h"
+
+namespace lmshao::lmrtsp {
+
+/**
+ * @brief Admission limits, a zero value disables the corresponding check
+ */
+struct AdmissionLimits {
+    size_t max_sessions = 0;                // Sessions holding a SETUP reservation
+    uint64_t max_egress_bps = 0;            // Aggregate egress budget in bits per second
+    uint64_t default_stream_bps = 2000000;  // Estimate used when MediaStreamInfo::bitrate is unknown
+    double max_sender_utilization = 0.0;    // Share of all cores spent sending media, 0.0 - 1.0
+    size_t max_send_queue_bytes = 0;        // Bytes queued in socket send buffers, summed over sessions
+    uint32_t retry_after_seconds = 5;       // Retry-After value sent with rejections
+};
+
+/**
+ * @brief Sender load sampled by AdmissionController through its load sampler
+ */
+struct SenderLoadSample {
+    uint64_t cpu_us = 0;         // CPU time spent sending since startup, never decreases
+    size_t send_queue_bytes = 0; // Bytes currently queued in socket send buffers
+};
+
+/**
+ * @brief Snapshot of the admission state
+ */
+struct AdmissionStats {
+    size_t admitted_sessions = 0;
+    uint64_t reserved_bps = 0;
+    uint64_t measured_bps = 0;
+    double sender_utilization = 0.0;
+    size_t send_queue_bytes = 0;
+    uint64_t rejected_bandwidth = 0;
+    uint64_t rejected_overload = 0;
+};
+
+/**
+ * @brief Result of an admission check
+ */
+struct AdmissionDecision {
+    bool admitted = true;
+    int status_code = 200;    // 453 Not Enough Bandwidth or 503 Service Unavailable when rejected
+    uint32_t retry_after = 0; // Seconds
+    bool reserved = false;    // AdmitSetup made a new track reservation, undo it with CancelSetup
+    std::string reason;
+};
+
+/**
+ * @brief Admission control for RTSP sessions
+ *
+ * SETUP reserves the stream bitrate for the session and track and is checked against the session count and the
+ * egress budget, using the larger of the reserved and the measured egress rate. PLAY is only checked against the
+ * sender load, since its bandwidth was already reserved at SETUP. The sender load comes from the load sampler, called
+ * by admission checks at most every 200 ms; utilization is the CPU time it reports over that window, as a share of
+ * all cores.
+ */
+class AdmissionController {
+public:
+    using LoadSampler = std::function<SenderLoadSample()>;
+
+    AdmissionController();
+
+    void SetLimits(const AdmissionLimits &limits);
+    AdmissionLimits GetLimits() const;
+
+    /**
+     * @brief Check a SETUP and reserve its bitrate if admitted
+     *
+     * @param session_id RTSP session ID, SETUPs for more tracks add to the same reservation
+     * @param track Track the SETUP is for, a repeated SETUP of a reserved track is admitted without a new reservation
+     * @param stream_bps Stream bitrate, 0 uses default_stream_bps
+     * @return Admission decision
+     */
+    AdmissionDecision AdmitSetup(const std::string &session_id, const std::string &track, uint64_t stream_bps);
+
+    /**
+     * @brief Check a PLAY against the current sender load
+     */
+    AdmissionDecision AdmitPlay(const std::string &session_id);
+
+    /**
+     * @brief Undo a track reservation made by AdmitSetup, e.g. when the SETUP failed afterwards
+     */
+    void CancelSetup(const std::string &session_id, const std::string &track);
+
+    /**
+     * @brief Drop all reservations of a session
+     */
+    void Release(const std::string &session_id);
+
+    /**
+     * @brief Account media bytes sent, feeds the measured egress rate
+     */
+    void OnBytesSent(size_t bytes) { bytesSent_.fetch_add(bytes, std::memory_order_relaxed); }
+
+    /**
+     * @brief Set the source of the sender load, only called while a utilization or send-queue limit is set
+     * @note Called without the controller lock held, it may take locks of its own
+     */
+    void SetLoadSampler(LoadSampler sampler);
+
+    AdmissionStats GetStats();
+
+private:
+    struct Reservation {
+        uint64_t bps = 0;
+        std::unordered_map<std::string, uint64_t> tracks; // Track -> reserved bps
+    };
+
+    uint64_t EffectiveBps(uint64_t stream_bps) const;
+    void SampleEgress(int64_t now_ms);
+    void SampleLoad(int64_t now_ms);
+    bool IsOverloaded(std::string &reason) const;
+    AdmissionDecision Reject(int status_code, const std::string &reason);
+
+private:
+    mutable std::mutex mutex_;
+    AdmissionLimits limits_;
+    std::unordered_map<std::string, Reservation> reservations_;
+    uint64_t reservedBps_ = 0;
+
+    // Measured egress
+    std::atomic<uint64_t> bytesSent_{0};
+    uint64_t lastSampleBytes_ = 0;
+    int64_t lastSampleMs_ = 0;
+    uint64_t measuredBps_ = 0;
+
+    // Sampled load
+    LoadSampler loadSampler_;
+    unsigned cores_ = 1;
+    double senderUtilization_ = 0.0;
+    size_t sendQueueBytes_ = 0;
+    uint64_t lastCpuUs_ = 0;
+    int64_t lastLoadSampleMs_ = 0;
+
+    std::shared_ptr<Clock> clock_ = Clock::Get();
+
+    uint64_t rejectedBandwidth_ = 0;
+    uint64_t rejectedOverload_ = 0;
+};
+
+} // namespace lmshao::lmrtsp
+
+#endif // LMSHAO_LMRTSP_ADMISSION_CONTROLLER_H
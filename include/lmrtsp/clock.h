@@ -0,0 +1,157 @@
+/**
+ * @author SHAO Liming <lmshao@163.com>
+ * @copyright Copyright (c) 2025 SHAO Liming
+ * @license MIT
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef LMSHAO_LMRTSP_CLOCK_H
+#define LMSHAO_LMRTSP_CLOCK_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace lmshao::lmrtsp {
+
+/**
+ * @brief Cheap monotonic time in nanoseconds
+ *
+ * Reads the TSC on x86-64 CPUs with an invariant TSC, calibrated once against CLOCK_MONOTONIC_RAW, and falls back to
+ * clock_gettime(CLOCK_MONOTONIC_RAW) elsewhere. Cheap enough for per-packet use, but the hot paths still take one
+ * reading per frame.
+ */
+int64_t FastMonotonicNs();
+
+/**
+ * @brief Repeating timer created by a Clock
+ *
+ * Destroying the timer cancels its tasks and waits for a running one to return.
+ */
+class Timer {
+public:
+    using TimerId = uint64_t;
+
+    virtual ~Timer() = default;
+
+    /**
+     * @brief Run a task every interval_ms, first after one interval
+     * @return Timer ID, 0 on failure
+     */
+    virtual TimerId ScheduleRepeating(std::function<void()> task, uint32_t interval_ms) = 0;
+    virtual void Cancel(TimerId id) = 0;
+};
+
+/**
+ * @brief Time source for pacing, RTCP timing, report timers and session timeouts
+ *
+ * The library and the sample servers take time from Clock::Get() instead of the system clocks, so tests can install a
+ * SimulatedClock and run timing-dependent code deterministically and faster than real time. Install the clock before
+ * any session is created, sessions keep the clock they were created with.
+ */
+class Clock {
+public:
+    virtual ~Clock() = default;
+
+    /**
+     * @brief Wall-clock time in milliseconds since the Unix epoch, used for RTCP NTP timestamps and timeouts
+     */
+    virtual int64_t NowMs() const = 0;
+
+    /**
+     * @brief Monotonic time in nanoseconds, used for pacing and RTP send/arrival times
+     */
+    virtual int64_t MonotonicNs() const = 0;
+
+    int64_t MonotonicUs() const { return MonotonicNs() / 1000; }
+
+    /**
+     * @brief Block the calling thread for the given monotonic duration
+     */
+    virtual void SleepUs(int64_t us) = 0;
+
+    virtual std::unique_ptr<Timer> CreateTimer() = 0;
+
+    /**
+     * @brief Get the process-wide clock, the system clock unless another one was installed
+     */
+    static std::shared_ptr<Clock> Get();
+
+    /**
+     * @brief Install the process-wide clock, nullptr restores the system clock
+     */
+    static void Set(std::shared_ptr<Clock> clock);
+};
+
+/**
+ * @brief Clock backed by the system clocks and lmcore::AsyncTimer, monotonic time comes from FastMonotonicNs()
+ */
+class SystemClock : public Clock {
+public:
+    SystemClock();
+
+    int64_t NowMs() const override;
+    int64_t MonotonicNs() const override;
+    void SleepUs(int64_t us) override;
+    std::unique_ptr<Timer> CreateTimer() override;
+};
+
+/**
+ * @brief Clock that only moves when told to
+ *
+ * Time advances through Advance(), which runs due timer tasks in deadline order on the calling thread. With auto
+ * advance enabled (the default) SleepUs() advances the clock itself, so a single paced thread runs without waiting;
+ * otherwise SleepUs() blocks until another thread advances the clock past the deadline.
+ */
+class SimulatedClock : public Clock, public std::enable_shared_from_this<SimulatedClock> {
+public:
+    explicit SimulatedClock(int64_t start_ms = 1700000000000);
+
+    int64_t NowMs() const override;
+    int64_t MonotonicNs() const override;
+    void SleepUs(int64_t us) override;
+    std::unique_ptr<Timer> CreateTimer() override;
+
+    /**
+     * @brief Move time forward, running every timer task that becomes due
+     */
+    void Advance(int64_t us);
+
+    void SetAutoAdvance(bool enable);
+
+private:
+    friend class SimulatedTimer;
+
+    struct Task {
+        const void *owner;
+        int64_t due_us;
+        int64_t interval_us;
+        std::function<void()> run;
+    };
+
+    Timer::TimerId AddTask(const void *owner, std::function<void()> task, uint32_t interval_ms);
+    void CancelTask(Timer::TimerId id);
+    void CancelOwner(const void *owner);
+
+    const int64_t startMs_;
+    mutable std::mutex mutex_;
+    std::condition_variable advanced_;
+    std::condition_variable taskDone_;
+    int64_t nowUs_ = 0;
+    bool autoAdvance_ = true;
+    std::map<Timer::TimerId, Task> tasks_;
+    Timer::TimerId nextId_ = 1;
+    // Task being run by Advance(), cancelling it waits for the run to return
+    Timer::TimerId runningId_ = 0;
+    const void *runningOwner_ = nullptr;
+    std::thread::id runningThread_;
+};
+
+} // namespace lmshao::lmrtsp
+
+#endif // LMSHAO_LMRTSP_CLOCK_H
@@ -0,0 +1,214 @@
+/**
+ * @author SHAO Liming <lmshao@163.com>
+ * @copyright Copyright (c) 2025 SHAO Liming
+ * @license MIT
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef LMSHAO_LMRTSP_CPU_ACCOUNTING_H
+#define LMSHAO_LMRTSP_CPU_ACCOUNTING_H
+
+#include <time.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "lmrtsp/clock.h"
+
+namespace lmshao::lmrtsp {
+
+/**
+ * @brief Units of work CPU time is attributed to
+ */
+enum class CpuStage : uint8_t {
+    READ = 0,      // Reading media from storage, reported by the application
+    PACKETIZE = 1, // Packetizing and handing packets to the transport, includes socket sends of unbatched transports
+    SEND = 2,      // Transport flush, e.g. io_uring submission
+    COUNT
+};
+
+/**
+ * @brief CPU cost of a stream
+ */
+struct CpuUsage {
+    uint64_t stage_us[static_cast<size_t>(CpuStage::COUNT)] = {};
+    uint64_t bytes = 0;     // Media bytes sent
+    uint64_t frames = 0;    // Frames sent
+    uint64_t active_ms = 0; // Wall time with work going on, pauses excluded
+
+    uint64_t TotalUs() const
+    {
+        uint64_t total = 0;
+        for (uint64_t us : stage_us) {
+            total += us;
+        }
+        return total;
+    }
+
+    // CPU microseconds per second of streaming
+    double UsPerSecond() const { return active_ms > 0 ? TotalUs() * 1000.0 / active_ms : 0.0; }
+
+    // CPU microseconds per MB of media sent
+    double UsPerMB() const { return bytes > 0 ? TotalUs() * 1048576.0 / bytes : 0.0; }
+
+    CpuUsage &operator+=(const CpuUsage &other)
+    {
+        for (size_t i = 0; i < static_cast<size_t>(CpuStage::COUNT); ++i) {
+            stage_us[i] += other.stage_us[i];
+        }
+        bytes += other.bytes;
+        frames += other.frames;
+        active_ms += other.active_ms;
+        return *this;
+    }
+};
+
+/**
+ * @brief CPU cost of one stream of a session, or the aggregate of a stream path and codec
+ */
+struct StreamCpuUsage {
+    std::string stream; // Stream path, e.g. /movie.mkv/track0
+    std::string codec;  // Codec name, see MediaTypeToCodec()
+    CpuUsage usage;
+};
+
+/**
+ * @brief Thread-safe accumulator of the CPU time spent on one stream
+ *
+ * Accounting is off by default. When enabled, each scheduled unit of work reads CLOCK_THREAD_CPUTIME_ID before and
+ * after, which costs a clock_gettime() pair per frame and stage.
+ */
+class CpuAccount {
+public:
+    static void SetEnabled(bool enabled) { EnabledFlag().store(enabled, std::memory_order_relaxed); }
+    static bool IsEnabled() { return EnabledFlag().load(std::memory_order_relaxed); }
+
+    // CPU time consumed by the calling thread in nanoseconds, 0 where unsupported
+    static uint64_t ThreadCpuTimeNs()
+    {
+#if defined(CLOCK_THREAD_CPUTIME_ID)
+        timespec ts;
+        if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) == 0) {
+            return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<uint64_t>(ts.tv_nsec);
+        }
+#endif
+        return 0;
+    }
+
+    void AddCpu(CpuStage stage, uint64_t ns)
+    {
+        stageNs_[static_cast<size_t>(stage)].fetch_add(ns, std::memory_order_relaxed);
+        Touch();
+    }
+
+    void AddSent(size_t bytes)
+    {
+        bytes_.fetch_add(bytes, std::memory_order_relaxed);
+        frames_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    CpuUsage Snapshot() const
+    {
+        CpuUsage usage;
+        for (size_t i = 0; i < static_cast<size_t>(CpuStage::COUNT); ++i) {
+            usage.stage_us[i] = stageNs_[i].load(std::memory_order_relaxed) / 1000;
+        }
+        usage.bytes = bytes_.load(std::memory_order_relaxed);
+        usage.frames = frames_.load(std::memory_order_relaxed);
+        usage.active_ms = activeMs_.load(std::memory_order_relaxed);
+        return usage;
+    }
+
+private:
+    // Gaps longer than this are pauses or stalls and do not count as streaming time
+    static constexpr int64_t MAX_ACTIVE_GAP_MS = 1000;
+
+    static std::atomic<bool> &EnabledFlag()
+    {
+        static std::atomic<bool> enabled{false};
+        return enabled;
+    }
+
+    void Touch()
+    {
+        int64_t now = clock_->MonotonicNs() / 1000000;
+        int64_t last = lastMs_.exchange(now, std::memory_order_relaxed);
+        if (last >= 0 && now > last && now - last <= MAX_ACTIVE_GAP_MS) {
+            activeMs_.fetch_add(static_cast<uint64_t>(now - last), std::memory_order_relaxed);
+        }
+    }
+
+    std::atomic<uint64_t> stageNs_[static_cast<size_t>(CpuStage::COUNT)] = {};
+    std::atomic<uint64_t> bytes_{0};
+    std::atomic<uint64_t> frames_{0};
+    std::atomic<uint64_t> activeMs_{0};
+    std::atomic<int64_t> lastMs_{-1};
+    std::shared_ptr<Clock> clock_ = Clock::Get();
+};
+
+/**
+ * @brief Attribute the calling thread's CPU time within a scope to an account, no-op while accounting is disabled
+ *
+ * Work the scope hands to other threads, e.g. PacketizerWorkerPool chunks, is charged to the same account and stage
+ * through CurrentAccount() and CurrentStage(). Scopes nest: a nested scope's time goes to its own account and stage
+ * only, not to the enclosing one as well.
+ */
+class CpuScope {
+public:
+    CpuScope(CpuAccount *account, CpuStage stage)
+        : account_(account && CpuAccount::IsEnabled() ? account : nullptr), stage_(stage)
+    {
+        if (account_) {
+            previous_ = Current();
+            Current() = {account_, stage_, this};
+            startNs_ = CpuAccount::ThreadCpuTimeNs();
+        }
+    }
+
+    ~CpuScope()
+    {
+        if (account_) {
+            // Time spent in nested scopes is theirs, the enclosing scope is charged only for the rest
+            uint64_t elapsed = CpuAccount::ThreadCpuTimeNs() - startNs_;
+            account_->AddCpu(stage_, elapsed > nestedNs_ ? elapsed - nestedNs_ : 0);
+            Current() = previous_;
+            if (previous_.scope) {
+                previous_.scope->nestedNs_ += elapsed;
+            }
+        }
+    }
+
+    CpuScope(const CpuScope &) = delete;
+    CpuScope &operator=(const CpuScope &) = delete;
+
+    // Account and stage of the innermost active scope on the calling thread, nullptr outside any
+    static CpuAccount *CurrentAccount() { return Current().account; }
+    static CpuStage CurrentStage() { return Current().stage; }
+
+private:
+    struct Charge {
+        CpuAccount *account = nullptr;
+        CpuStage stage = CpuStage::PACKETIZE;
+        CpuScope *scope = nullptr;
+    };
+
+    static Charge &Current()
+    {
+        thread_local Charge charge;
+        return charge;
+    }
+
+    CpuAccount *account_;
+    CpuStage stage_;
+    Charge previous_;
+    uint64_t startNs_ = 0;
+    uint64_t nestedNs_ = 0;
+};
+
+} // namespace lmshao::lmrtsp
+
+#endif // LMSHAO_LMRTSP_CPU_ACCOUNTING_H
@@ -0,0 +1,83 @@
+/**
+ * @author SHAO Liming <lmshao@163.com>
+ * @copyright Copyright (c) 2025 SHAO Liming
+ * @license MIT
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef LMSHAO_LMRTSP_CPU_AFFINITY_H
+#define LMSHAO_LMRTSP_CPU_AFFINITY_H
+
+#include <string>
+#include <vector>
+
+namespace lmshao::lmrtsp {
+
+/**
+ * @brief CPU sets threads are pinned to, empty sets leave placement to the OS
+ */
+struct CpuAffinityConfig {
+    std::vector<int> reactor_cpus; // lmnet reactor threads, which run the RTSP and RTCP socket callbacks
+    std::vector<int> sender_cpus;  // Packetizer pool and per-session send threads
+};
+
+/**
+ * @brief Thread placement helpers for CPU pinning and NUMA locality
+ *
+ * There is no libnuma dependency: NUMA nodes are read from sysfs, and memory placement relies on the kernel's
+ * first-touch policy, so buffers allocated and filled by a thread pinned to one node live on that node. Linux only,
+ * elsewhere every call is a no-op that reports failure or node 0.
+ */
+class CpuAffinity {
+public:
+    /**
+     * @brief Parse a CPU list such as "0-7,16-23"
+     *
+     * @return false, with cpus cleared, if the list is empty or any entry is not a CPU number or ascending range
+     */
+    static bool ParseCpuList(const std::string &list, std::vector<int> &cpus);
+
+    /**
+     * @brief Restrict the calling thread to the given CPUs, an empty set is a no-op
+     */
+    static bool PinCurrentThread(const std::vector<int> &cpus);
+
+    /**
+     * @brief CPU the calling thread runs on, -1 if unknown
+     */
+    static int GetCurrentCpu();
+
+    /**
+     * @brief NUMA node of a CPU, 0 when the system exposes no NUMA topology
+     */
+    static int GetNumaNode(int cpu);
+
+    /**
+     * @brief CPUs of the set on the NUMA node of home_cpu, the whole set if home_cpu < 0 or none are on that node
+     */
+    static std::vector<int> GetNodeCpus(const std::vector<int> &cpus, int home_cpu);
+
+    /**
+     * @brief Pick the CPU a new session is served from
+     *
+     * Prefers the CPU that receives the client's packets (see GetIncomingCpu()) or another CPU of the set on its node,
+     * so the session's memory and its socket processing share a node. Falls back to round robin over the set.
+     * @return CPU from the set, -1 if the set is empty
+     */
+    static int SelectHomeCpu(const std::vector<int> &cpus, int incoming_cpu);
+
+    /**
+     * @brief SO_INCOMING_CPU of a socket: the CPU its packets were last processed on, -1 if unknown
+     */
+    static int GetIncomingCpu(int fd);
+
+    /**
+     * @brief Set SO_INCOMING_CPU, which steers packets to this socket within an SO_REUSEPORT group
+     */
+    static bool SetIncomingCpu(int fd, int cpu);
+};
+
+} // namespace lmshao::lmrtsp
+
+#endif // LMSHAO_LMRTSP_CPU_AFFINITY_H
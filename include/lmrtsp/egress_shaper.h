@@ -0,0 +1,148 @@
+/**
+ * @author SHAO Liming <lmshao@163.com>
+ * @copyright Copyright (c) 2025 SHAO Liming
+ * @license MIT
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef LMSHAO_LMRTSP_EGRESS_SHAPER_H
+#define LMSHAO_LMRTSP_EGRESS_SHAPER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_set>
+
+#include "lmrtsp/clock.h"
+#include "lmrtsp/media_types.h"
+
+namespace lmshao::lmrtsp {
+
+/**
+ * @brief Egress caps, a zero rate disables the corresponding cap
+ */
+struct EgressLimits {
+    uint64_t session_bps = 0;   // Per RTSP session, all of its tracks together
+    uint64_t client_ip_bps = 0; // Per client IP, all of its sessions together
+    uint32_t burst_ms = 200;    // Bucket depth, how far a burst may run ahead of the cap rate
+};
+
+/**
+ * @brief Frames passed and dropped by an EgressShaper
+ */
+struct EgressStats {
+    uint64_t sent_frames = 0;
+    uint64_t sent_bytes = 0;
+    uint64_t dropped_frames = 0; // All dropped frames, including the two counts below
+    uint64_t dropped_bytes = 0;
+    uint64_t dropped_non_reference = 0;   // Frames no other picture predicts from
+    uint64_t dropped_until_key_frame = 0; // Reference frames that did not fit, and the rest of their GOP
+
+    EgressStats &operator+=(const EgressStats &other)
+    {
+        sent_frames += other.sent_frames;
+        sent_bytes += other.sent_bytes;
+        dropped_frames += other.dropped_frames;
+        dropped_bytes += other.dropped_bytes;
+        dropped_non_reference += other.dropped_non_reference;
+        dropped_until_key_frame += other.dropped_until_key_frame;
+        return *this;
+    }
+};
+
+/**
+ * @brief Token bucket in bytes, filled at a fixed rate up to its burst depth
+ *
+ * The balance may go negative: frames that must go out are charged anyway and the debt is repaid by later refills.
+ * Thread-safe, one bucket can be shared by the streams it caps.
+ */
+class TokenBucket {
+public:
+    /**
+     * @param rate_bps Fill rate in bits per second
+     * @param burst_ms Depth in milliseconds at the fill rate, the bucket starts full
+     */
+    TokenBucket(uint64_t rate_bps, uint32_t burst_ms);
+
+    /**
+     * @brief Check whether bytes can be charged without the balance dropping below -allowance
+     *
+     * @param bytes Bytes to send
+     * @param now_ns Current monotonic time in nanoseconds
+     * @param allowance Debt the charge may run into, in bytes
+     */
+    bool Fits(size_t bytes, int64_t now_ns, int64_t allowance = 0);
+
+    /**
+     * @brief Charge bytes unconditionally
+     */
+    void Consume(size_t bytes, int64_t now_ns);
+
+    int64_t GetBurstBytes() const { return burstBytes_; }
+    uint64_t GetRateBps() const { return rateBps_; }
+
+private:
+    void Refill(int64_t now_ns);
+
+    std::mutex mutex_;
+    uint64_t rateBps_;
+    int64_t burstBytes_;
+    int64_t tokens_;
+    int64_t lastNs_ = -1;
+};
+
+/**
+ * @brief Per-stream egress policy against a session bucket and a client IP bucket
+ *
+ * Frames are never queued: a frame either fits the caps now or is dropped whole. Non-reference video frames are
+ * dropped first. Reference frames may borrow up to one burst; a reference frame that does not fit even then is
+ * dropped together with the rest of its GOP, since nothing up to the next key frame can be decoded without it.
+ * Key frames always go out and are charged as debt. MP2T is cut at PES boundaries only: a PES that starts over the
+ * caps is dropped up to the next PES start on its PID, one that already started is finished as debt. Audio and
+ * unclassified video carry no picture type to drop by, so they are charged but never dropped.
+ */
+class EgressShaper {
+public:
+    /**
+     * @param session_bucket Bucket shared by the session's tracks, may be null
+     * @param client_bucket Bucket shared by the sessions of the client IP, may be null
+     */
+    EgressShaper(std::shared_ptr<TokenBucket> session_bucket, std::shared_ptr<TokenBucket> client_bucket);
+
+    /**
+     * @brief Decide whether a frame is sent, charging both buckets if so
+     *
+     * Called on the stream's send thread only.
+     * @param frame Frame about to be packetized, video_param is read for H.264 and H.265
+     * @param bytes Bytes the frame takes on the wire
+     * @return true to send the frame, false to drop it
+     */
+    bool Admit(const MediaFrame &frame, size_t bytes);
+
+    EgressStats GetStats() const;
+
+private:
+    bool AdmitTransportStream(const MediaFrame &frame, size_t bytes, int64_t now_ns);
+    bool Fits(size_t bytes, int64_t now_ns, bool borrow) const;
+    void Consume(size_t bytes, int64_t now_ns);
+    bool Drop(size_t bytes, bool reference);
+
+    std::shared_ptr<TokenBucket> sessionBucket_;
+    std::shared_ptr<TokenBucket> clientBucket_;
+    std::shared_ptr<Clock> clock_ = Clock::Get();
+    bool waitKeyFrame_ = false;
+    std::unordered_set<uint16_t> droppingPids_; // MP2T PIDs whose current PES was cut
+
+    std::atomic<uint64_t> sentFrames_{0};
+    std::atomic<uint64_t> sentBytes_{0};
+    std::atomic<uint64_t> droppedBytes_{0};
+    std::atomic<uint64_t> droppedNonReference_{0};
+    std::atomic<uint64_t> droppedUntilKeyFrame_{0};
+};
+
+} // namespace lmshao::lmrtsp
+
+#endif // LMSHAO_LMRTSP_EGRESS_SHAPER_H
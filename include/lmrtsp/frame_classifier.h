@@ -0,0 +1,56 @@
+/**
+ * @author SHAO Liming <lmshao@163.com>
+ * @copyright Copyright (c) 2025 SHAO Liming
+ * @license MIT
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef LMSHAO_LMRTSP_FRAME_CLASSIFIER_H
+#define LMSHAO_LMRTSP_FRAME_CLASSIFIER_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "media_types.h"
+
+namespace lmshao::lmrtsp {
+
+/**
+ * @brief Labels H.264/H.265 frames with their picture type
+ *
+ * Reads the NAL unit headers up to the first slice and the leading fields of its slice header, a few bytes per frame.
+ * Frame producers (file readers, depacketizers) classify each frame once, and the send path reads the result from
+ * MediaFrame::video_param instead of parsing the bitstream again.
+ *
+ * Use one instance per stream: num_extra_slice_header_bits of the last H.265 PPS passed in is kept for later slices.
+ */
+class FrameClassifier {
+public:
+    explicit FrameClassifier(MediaType media_type) : mediaType_(media_type) {}
+
+    /**
+     * @brief Classify one frame
+     * @param data Annex B access unit or NAL unit, a buffer without start code is one NAL unit
+     * @param size Size in bytes
+     * @param param Output, frame_type, is_reference and temporal_id are set, is_key_frame is set for IDR frames
+     * @return true if the data holds a slice and param was updated
+     */
+    bool Classify(const uint8_t *data, size_t size, VideoParam &param);
+
+    /**
+     * @brief Classify frame.data into frame.video_param, other codecs are left unchanged
+     */
+    bool Classify(MediaFrame &frame);
+
+private:
+    bool ClassifyH264(const uint8_t *nalu, size_t size, VideoParam &param, bool &done);
+    bool ClassifyH265(const uint8_t *nalu, size_t size, VideoParam &param, bool &done);
+
+    MediaType mediaType_;
+    uint32_t extraSliceHeaderBits_ = 0; // num_extra_slice_header_bits of the last H.265 PPS
+};
+
+} // namespace lmshao::lmrtsp
+
+#endif // LMSHAO_LMRTSP_FRAME_CLASSIFIER_H
@@ -30,6 +30,28 @@ struct H264VideoInfo {
     int32_t bit_depth_chroma = 8;    // Bit depth for chroma samples
     bool frame_mbs_only_flag = true; // True if only progressive frames
     bool valid = false;              // True if parsing was successful
+
+    // VUI timing, a clock tick is num_units_in_tick / time_scale seconds and a frame lasts two ticks
+    bool timing_info_present = false;      // True if num_units_in_tick and time_scale are set
+    uint32_t num_units_in_tick = 0;        // Time units per clock tick
+    uint32_t time_scale = 0;               // Time units per second
+    bool fixed_frame_rate_flag = false;    // True if every frame lasts two ticks, otherwise the rate is a maximum
+    bool pic_struct_present_flag = false;  // True if picture timing SEI carries pic_struct
+    bool cpb_dpb_delays_present = false;   // True if picture timing SEI carries the HRD removal and output delays
+    uint8_t cpb_removal_delay_length = 24; // Bit length of cpb_removal_delay
+    uint8_t dpb_output_delay_length = 24;  // Bit length of dpb_output_delay
+};
+
+/**
+ * @brief Leading fields of an H.264 slice header, the part that needs neither SPS nor PPS
+ */
+struct H264SliceHeader {
+    uint8_t nal_unit_type = 0;         // 1 non-IDR, 5 IDR, 2-4 data partitions
+    uint8_t nal_ref_idc = 0;           // 0 if no other picture references this one
+    uint32_t first_mb_in_slice = 0;    // 0 for the first slice of a picture
+    uint8_t slice_type = 0;            // 0 P, 1 B, 2 I, 3 SP, 4 SI
+    uint32_t pic_parameter_set_id = 0; // PPS the slice refers to
+    bool valid = false;                // True if the NAL unit is a slice and the fields were read
 };
 
 /**
@@ -49,6 +71,27 @@ public:
      */
     static H264VideoInfo ParseSPS(const std::shared_ptr<lmcore::DataBuffer> &sps);
 
+    /**
+     * @brief Get the display duration of a picture from its picture timing SEI
+     *
+     * Telecined and variable frame rate streams signal per-picture durations through pic_struct, e.g. 3 ticks for a
+     * frame shown for three fields.
+     * @param sei SEI NAL unit (with or without start code)
+     * @param info Video information of the active SPS
+     * @return Picture duration in clock ticks, 0 if the SEI has no picture timing or the SPS does not enable pic_struct
+     */
+    static int32_t GetPictureTicks(const std::shared_ptr<lmcore::DataBuffer> &sei, const H264VideoInfo &info);
+
+    /**
+     * @brief Parse the start of a slice header
+     *
+     * Reads the NAL unit in place, cheap enough to run on every slice.
+     * @param nalu Slice NAL unit (with or without start code)
+     * @param size NAL unit size in bytes
+     * @return Slice header fields, valid is false for other NAL unit types or truncated data
+     */
+    static H264SliceHeader ParseSliceHeader(const uint8_t *nalu, size_t size);
+
     /**
      * @brief Get video resolution from SPS
      *
@@ -117,55 +160,6 @@ public:
      * @return Level string (e.g., "4.0", "5.1")
      */
     static std::string GetLevelString(int32_t level_idc);
-
-private:
-    /**
-     * @brief Read unsigned Exp-Golomb coded value
-     *
-     * @param buf Buffer containing bitstream
-     * @param len Buffer length in bytes
-     * @param pos Bit position (will be updated)
-     * @return Decoded value
-     */
-    static uint32_t ReadUE(const uint8_t *buf, uint32_t len, uint32_t &pos);
-
-    /**
-     * @brief Read signed Exp-Golomb coded value
-     *
-     * @param buf Buffer containing bitstream
-     * @param len Buffer length in bytes
-     * @param pos Bit position (will be updated)
-     * @return Decoded value
-     */
-    static int32_t ReadSE(const uint8_t *buf, uint32_t len, uint32_t &pos);
-
-    /**
-     * @brief Read fixed-length bits from bitstream
-     *
-     * @param bit_count Number of bits to read
-     * @param buf Buffer containing bitstream
-     * @param pos Bit position (will be updated)
-     * @return Decoded value
-     */
-    static uint32_t ReadBits(uint32_t bit_count, const uint8_t *buf, uint32_t &pos);
-
-    /**
-     * @brief Remove emulation prevention bytes (0x03) from RBSP
-     *
-     * @param buf Buffer containing RBSP data
-     * @param size Pointer to size (will be updated)
-     */
-    static void RemoveEmulationPrevention(uint8_t *buf, uint32_t &size);
-
-    /**
-     * @brief Skip scaling list in SPS
-     *
-     * @param buf Buffer containing bitstream
-     * @param len Buffer length in bytes
-     * @param pos Bit position (will be updated)
-     * @param size_of_scaling_list Size of scaling list to skip
-     */
-    static void SkipScalingList(const uint8_t *buf, uint32_t len, uint32_t &pos, int32_t size_of_scaling_list);
 };
 
 } // namespace lmshao::lmrtsp
@@ -29,6 +29,23 @@ struct H265VideoInfo {
     int32_t bit_depth_luma = 8;    // Bit depth for luma samples
     int32_t bit_depth_chroma = 8;  // Bit depth for chroma samples
     bool valid = false;            // True if parsing was successful
+
+    // VUI timing, a picture lasts one clock tick of num_units_in_tick / time_scale seconds
+    bool timing_info_present = false; // True if num_units_in_tick and time_scale are set
+    uint32_t num_units_in_tick = 0;   // Time units per clock tick
+    uint32_t time_scale = 0;          // Time units per second
+};
+
+/**
+ * @brief Leading fields of an H.265 slice segment header
+ */
+struct H265SliceHeader {
+    uint8_t nal_unit_type = 0;                    // 0-9 trailing/leading pictures, 16-21 IRAP pictures
+    uint8_t temporal_id = 0;                      // TemporalId from the NAL header
+    bool first_slice_segment_in_pic_flag = false; // True for the first slice segment of a picture
+    uint32_t pic_parameter_set_id = 0;            // PPS the slice refers to
+    int32_t slice_type = -1;                      // 0 B, 1 P, 2 I, -1 for later slice segments
+    bool valid = false;                           // True if the NAL unit is a slice and the fields were read
 };
 
 /**
@@ -47,6 +64,35 @@ public:
      */
     static H265VideoInfo ParseSPS(const std::shared_ptr<lmcore::DataBuffer> &sps);
 
+    /**
+     * @brief Parse the start of a slice segment header
+     *
+     * Reads the NAL unit in place, cheap enough to run on every slice. The slice type is only read from the first
+     * slice segment of a picture, later segments code their address first with a length that needs the SPS.
+     * @param nalu Slice NAL unit (with or without start code)
+     * @param size NAL unit size in bytes
+     * @param num_extra_slice_header_bits From the PPS, see GetNumExtraSliceHeaderBits()
+     * @return Slice header fields, valid is false for other NAL unit types or truncated data
+     */
+    static H265SliceHeader ParseSliceHeader(const uint8_t *nalu, size_t size, uint32_t num_extra_slice_header_bits = 0);
+
+    /**
+     * @brief Get num_extra_slice_header_bits from a PPS
+     *
+     * @param pps PPS data buffer (with or without start code)
+     * @return Number of extra bits before the slice type, -1 if the PPS is invalid
+     */
+    static int32_t GetNumExtraSliceHeaderBits(const std::shared_ptr<lmcore::DataBuffer> &pps);
+
+    /**
+     * @brief Get num_extra_slice_header_bits from a PPS
+     *
+     * @param pps PPS NAL unit (with or without start code)
+     * @param size NAL unit size in bytes
+     * @return Number of extra bits before the slice type, -1 if the PPS is invalid
+     */
+    static int32_t GetNumExtraSliceHeaderBits(const uint8_t *pps, size_t size);
+
     /**
      * @brief Get video resolution from SPS
      *
@@ -117,27 +163,6 @@ public:
      * @return Level string (e.g., "4.0", "5.1")
      */
     static std::string GetLevelString(int32_t level_idc);
-
-private:
-    /**
-     * @brief Read unsigned Exp-Golomb coded value
-     */
-    static uint32_t ReadUE(const uint8_t *buf, uint32_t len, uint32_t &pos);
-
-    /**
-     * @brief Read signed Exp-Golomb coded value
-     */
-    static int32_t ReadSE(const uint8_t *buf, uint32_t len, uint32_t &pos);
-
-    /**
-     * @brief Read fixed-length bits from bitstream
-     */
-    static uint32_t ReadBits(uint32_t bit_count, const uint8_t *buf, uint32_t &pos);
-
-    /**
-     * @brief Remove emulation prevention bytes (0x03) from RBSP
-     */
-    static void RemoveEmulationPrevention(uint8_t *buf, uint32_t &size);
 };
 
 } // namespace lmshao::lmrtsp
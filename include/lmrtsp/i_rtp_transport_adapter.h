@@ -13,6 +13,8 @@
 #include <string>
 #include <utility>
 
+#include "lmrtsp/priority_send_queue.h"
+
 namespace lmshao::lmrtsp {
 
 struct TransportConfig {
@@ -26,6 +28,12 @@ struct TransportConfig {
         SINK    ///< RTP Sink (receiver)
     };
 
+    enum class Backend {
+        DEFAULT,  ///< lmnet UDP sockets
+        IO_URING, ///< io_uring rings (Linux, falls back to DEFAULT when unavailable)
+        SHARED    ///< RtspClientRuntime receive reactors (SINK only, falls back to DEFAULT when unavailable)
+    };
+
     Type type = Type::UDP;
     Mode mode = Mode::SOURCE;
     std::string client_ip;
@@ -37,6 +45,10 @@ struct TransportConfig {
     uint8_t rtcpChannel = 1;
     std::pair<uint8_t, uint8_t> interleavedChannels = {0, 1};
     bool unicast = true;
+    Backend backend = Backend::DEFAULT;
+    int incoming_cpu = -1;      ///< SO_INCOMING_CPU for UDP sockets, -1 leaves steering to the kernel
+    bool kernel_pacing = false; ///< SO_TXTIME departure times on UDP SOURCE sockets (Linux, fq qdisc)
+    bool batch_send = false;    ///< DEFAULT backend SOURCE: send each frame's packets in one sendmmsg at Flush (Linux)
 };
 
 class IRtpTransportAdapter {
@@ -46,9 +58,26 @@ public:
     virtual bool Setup(const TransportConfig &config) = 0;
     virtual bool SendPacket(const uint8_t *data, size_t size) = 0;
     virtual bool SendRtcpPacket(const uint8_t *data, size_t size) = 0;
+    // Called once per frame after all its packets were handed to SendPacket; batching backends submit here
+    virtual void Flush() {}
+    // Priority of the packets handed to SendPacket until the next call; transports sharing a link schedule by it
+    virtual void SetSendPriority(SendPriority priority) { (void)priority; }
+    // Departure of the packets handed to SendPacket until Flush, spread evenly over spanNs from startNs in
+    // Clock::MonotonicNs() time; the kernel holds them until then. Ignored unless HasKernelPacing()
+    virtual void SetDeparture(int64_t startNs, int64_t spanNs)
+    {
+        (void)startNs;
+        (void)spanNs;
+    }
+    // Whether packets may be handed over before they are due, otherwise the caller paces in userspace
+    virtual bool HasKernelPacing() const { return false; }
     virtual void Close() = 0;
     virtual std::string GetTransportInfo() const = 0;
     virtual bool IsActive() const = 0;
+    // Approximate memory held by the transport in bytes, kernel socket buffers excluded
+    virtual size_t GetMemoryUsage() const { return 0; }
+    // Bytes of sent RTP waiting in the kernel socket send buffer, 0 where unknown
+    virtual size_t GetSendQueueBytes() const { return 0; }
 };
 
 } // namespace lmshao::lmrtsp
@@ -40,6 +40,7 @@ struct MediaStreamInfo {
     uint8_t payload_type = 96;
     uint32_t ssrc = 0;
     uint32_t clock_rate = 90000;
+    bool rtcp_reduced_size = false; // Peer accepts reduced-size RTCP (RFC 5506), a=rtcp-rsize in its SDP
 
     // Transport parameters
     uint16_t rtp_port = 0;
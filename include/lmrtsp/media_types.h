@@ -164,11 +164,25 @@ inline const char *MediaTypeToMediaKind(MediaType type)
     }
 }
 
+/**
+ * @brief Picture type of a video frame, from its NAL unit header and first slice header
+ */
+enum class FrameType : uint8_t {
+    UNKNOWN = 0, // Not classified, or the frame carries no slice
+    IDR,         // Random access point, H.264 IDR or H.265 IRAP (IDR, CRA, BLA)
+    I,           // Intra picture that is not a random access point
+    P,           // Predicted picture
+    B,           // Bi-predicted picture
+};
+
 struct VideoParam {
     uint32_t width = 0;
     uint32_t height = 0;
     uint32_t frame_rate = 0;
     bool is_key_frame = false;
+    FrameType frame_type = FrameType::UNKNOWN;
+    bool is_reference = true; // False if no later picture of the same temporal layer predicts from this one
+    uint8_t temporal_id = 0;  // H.265 TemporalId, 0 for H.264
 };
 
 struct AudioParam {
@@ -180,6 +194,10 @@ struct MediaFrame {
     std::shared_ptr<lmcore::DataBuffer> data;
     uint32_t timestamp = 0;
     MediaType media_type = MediaType::H264;
+    // Clock::MonotonicNs() the first packet is due at, 0 sends right away. Honoured by transports with kernel
+    // pacing, which spread the frame's packets over departure_span_ns
+    int64_t departure_ns = 0;
+    int64_t departure_span_ns = 0;
     union {
         VideoParam video_param;
         AudioParam audio_param;
@@ -0,0 +1,234 @@
+/**
+ * @author SHAO Liming <lmshao@163.com>
+ * @copyright Copyright (c) 2025 SHAO Liming
+ * @license MIT
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef LMSHAO_LMRTSP_PRIORITY_SEND_QUEUE_H
+#define LMSHAO_LMRTSP_PRIORITY_SEND_QUEUE_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <iterator>
+#include <utility>
+
+namespace lmshao::lmrtsp {
+
+/**
+ * @brief Outbound packet classes, highest priority first
+ */
+enum class SendPriority : uint8_t {
+    CONTROL = 0,       // Audio and RTCP, always sent first
+    KEY = 1,           // IDR / IRAP slices and parameter sets
+    REFERENCE = 2,     // Frames other frames depend on
+    NON_REFERENCE = 3, // Disposable frames, dropped first under pressure
+};
+
+/**
+ * @brief Outbound queue with strict priority for CONTROL and deficit round robin for video classes
+ *
+ * CONTROL always drains first. KEY, REFERENCE and NON_REFERENCE share the remaining capacity by deficit round robin,
+ * weighted 4:2:1, so a steady stream of key data cannot starve the other classes completely. When the queued bytes
+ * exceed the limit, the oldest frames of the lowest non-empty class are dropped until the new packet fits. Packets
+ * carry the frame they belong to, a frame is dropped as a whole, including its packets pushed later, since a decoder
+ * cannot use the rest of a frame anyway. Not thread-safe, owners serialize access.
+ *
+ * @tparam T Queued item, typically a serialized packet plus routing data
+ */
+template <typename T>
+class PrioritySendQueue {
+public:
+    static constexpr size_t CLASS_COUNT = 4;
+
+    explicit PrioritySendQueue(size_t maxBytes = 2 * 1024 * 1024, size_t quantum = 1500)
+        : maxBytes_(maxBytes), quantum_(quantum)
+    {
+    }
+
+    /**
+     * @brief Queue an item
+     *
+     * @param frame Nonzero ID of the frame the item belongs to, 0 for an item that stands alone
+     * @return false if the item was dropped because higher classes already fill the queue or its frame was dropped
+     */
+    bool Push(SendPriority priority, T item, size_t bytes, uint64_t frame = 0)
+    {
+        size_t cls = static_cast<size_t>(priority);
+        while (bytes_ + bytes > maxBytes_) {
+            if (!DropLowest(cls)) {
+                Discard(frame);
+                dropped_[cls]++;
+                return false;
+            }
+        }
+
+        // The frame may have been dropped just now to make room, or earlier
+        if (IsDiscarded(frame)) {
+            dropped_[cls]++;
+            return false;
+        }
+
+        queues_[cls].push_back(Entry{std::move(item), bytes, frame});
+        bytes_ += bytes;
+        return true;
+    }
+
+    /**
+     * @brief Take the next item according to the schedule
+     *
+     * @return false if the queue is empty
+     */
+    bool Pop(T &item)
+    {
+        if (!queues_[0].empty()) {
+            item = Take(0);
+            return true;
+        }
+
+        if (Empty()) {
+            return false;
+        }
+
+        // Deficit round robin across the video classes, each visit credits one quantum and serves the class until its
+        // deficit runs out
+        for (;;) {
+            size_t cls = 1 + cursor_;
+            auto &queue = queues_[cls];
+            if (queue.empty()) {
+                deficit_[cls] = 0;
+                NextClass();
+                continue;
+            }
+
+            if (!credited_) {
+                deficit_[cls] += quantum_ * WEIGHTS[cls];
+                credited_ = true;
+            }
+
+            if (deficit_[cls] >= queue.front().bytes) {
+                deficit_[cls] -= queue.front().bytes;
+                item = Take(cls);
+                return true;
+            }
+            NextClass();
+        }
+    }
+
+    bool Empty() const { return Count() == 0; }
+    size_t Bytes() const { return bytes_; }
+    size_t Count() const
+    {
+        size_t count = 0;
+        for (const auto &queue : queues_) {
+            count += queue.size();
+        }
+        return count;
+    }
+
+    uint64_t GetDropped(SendPriority priority) const { return dropped_[static_cast<size_t>(priority)]; }
+
+    void Clear()
+    {
+        for (auto &queue : queues_) {
+            queue.clear();
+        }
+        deficit_.fill(0);
+        credited_ = false;
+        bytes_ = 0;
+    }
+
+private:
+    struct Entry {
+        T item;
+        size_t bytes;
+        uint64_t frame;
+    };
+
+    static constexpr size_t WEIGHTS[CLASS_COUNT] = {0, 4, 2, 1};
+
+    void NextClass()
+    {
+        cursor_ = (cursor_ + 1) % (CLASS_COUNT - 1);
+        credited_ = false;
+    }
+
+    T Take(size_t cls)
+    {
+        Entry entry = std::move(queues_[cls].front());
+        queues_[cls].pop_front();
+        bytes_ -= entry.bytes;
+        return std::move(entry.item);
+    }
+
+    // Drop the oldest frame of the lowest class that is not above the incoming one. Its first packets may already be
+    // sent, the rest goes all the same
+    bool DropLowest(size_t incoming)
+    {
+        for (size_t cls = CLASS_COUNT; cls-- > incoming;) {
+            auto &queue = queues_[cls];
+            if (queue.empty()) {
+                continue;
+            }
+
+            uint64_t frame = queue.front().frame;
+            DropEntry(cls, queue.begin());
+            if (frame != 0) {
+                for (auto it = queue.begin(); it != queue.end();) {
+                    it = it->frame == frame ? DropEntry(cls, it) : std::next(it);
+                }
+                Discard(frame);
+            }
+            return true;
+        }
+        return false;
+    }
+
+    typename std::deque<Entry>::iterator DropEntry(size_t cls, typename std::deque<Entry>::iterator it)
+    {
+        bytes_ -= it->bytes;
+        dropped_[cls]++;
+        return queues_[cls].erase(it);
+    }
+
+    // Frames are pushed in order, a few recent ones cover frames still arriving on every stream
+    void Discard(uint64_t frame)
+    {
+        if (frame != 0 && !IsDiscarded(frame)) {
+            discarded_[discardedNext_] = frame;
+            discardedNext_ = (discardedNext_ + 1) % discarded_.size();
+        }
+    }
+
+    bool IsDiscarded(uint64_t frame) const
+    {
+        if (frame == 0) {
+            return false;
+        }
+        for (uint64_t discarded : discarded_) {
+            if (discarded == frame) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    std::array<std::deque<Entry>, CLASS_COUNT> queues_;
+    std::array<size_t, CLASS_COUNT> deficit_{};
+    std::array<uint64_t, CLASS_COUNT> dropped_{};
+    std::array<uint64_t, 16> discarded_{};
+    size_t discardedNext_ = 0;
+    size_t cursor_ = 0;
+    bool credited_ = false; // The class at cursor_ got its quantum for this visit
+    size_t bytes_ = 0;
+    size_t maxBytes_;
+    size_t quantum_;
+};
+
+} // namespace lmshao::lmrtsp
+
+#endif // LMSHAO_LMRTSP_PRIORITY_SEND_QUEUE_H
@@ -11,14 +11,55 @@
 
 #include <lmcore/data_buffer.h>
 
+#include <atomic>
 #include <cstdint>
+#include <deque>
+#include <functional>
 #include <map>
 #include <memory>
+#include <mutex>
 
+#include "clock.h"
 #include "rtcp_packet.h"
 
 namespace lmshao::lmrtsp {
 
+/**
+ * Latest receiver report seen by a sender, see RtcpSenderContext::GetReceiverFeedback()
+ */
+struct RtcpReceiverFeedback {
+    bool valid = false;         // A receiver report has arrived
+    uint8_t fraction_lost = 0;  // Fraction lost in the last report interval, in 1/256
+    uint32_t rtt_ms = 0;        // Round-trip time from LSR/DLSR, 0 until an SR has been echoed
+    int64_t report_time_ms = 0; // Clock::NowMs() when the report arrived
+    uint32_t nack_packets = 0;  // Generic NACK packets received
+    uint32_t pli_packets = 0;   // Picture Loss Indications received
+};
+
+/**
+ * Latest RTCP XR report (RFC 3611) seen by a sender, see RtcpSenderContext::GetXrStats()
+ *
+ * The loss runs are decoded from the Loss RLE block: many isolated losses point to random loss that FEC can repair,
+ * few long bursts to congestion. Jitter values are in RTP timestamp units.
+ */
+struct RtcpXrStats {
+    bool valid = false;            // An XR report with loss, duplicate or summary blocks has arrived
+    int64_t report_time_ms = 0;    // Clock::NowMs() when it arrived
+    uint16_t begin_seq = 0;        // First sequence number covered by the report
+    uint16_t end_seq = 0;          // Last sequence number covered plus one
+    uint32_t received_packets = 0; // Packets received in the range, from the Loss RLE block
+    uint32_t lost_packets = 0;     // Packets lost in the range, from the Loss RLE block or the summary
+    uint32_t dup_packets = 0;      // Duplicates in the range, from the Duplicate RLE block or the summary
+    uint32_t loss_bursts = 0;      // Runs of consecutive lost packets
+    uint32_t isolated_losses = 0;  // Runs of exactly one lost packet
+    uint32_t max_burst_length = 0; // Longest run of lost packets
+    bool has_jitter = false;       // The statistics summary carried jitter
+    uint32_t min_jitter = 0;       // Smallest transit time difference
+    uint32_t max_jitter = 0;       // Largest transit time difference
+    uint32_t mean_jitter = 0;      // Mean transit time difference
+    uint32_t dev_jitter = 0;       // Standard deviation of the transit time difference
+};
+
 /**
  * Base class for RTCP context management
  * Handles RTP/RTCP statistics and packet generation
@@ -46,11 +87,11 @@ public:
      * Process outgoing RTP packet (for statistics)
      * @param seq RTP sequence number
      * @param timestamp RTP timestamp
-     * @param ntpTimestampMs NTP timestamp in milliseconds
+     * @param timeNs Send or arrival time in nanoseconds, from GetClock().MonotonicNs()
      * @param sampleRate Sample rate (e.g., 90000 for video)
      * @param bytes RTP packet size in bytes
      */
-    virtual void OnRtp(uint16_t seq, uint32_t timestamp, uint64_t ntpTimestampMs, uint32_t sampleRate, size_t bytes);
+    virtual void OnRtp(uint16_t seq, uint32_t timestamp, int64_t timeNs, uint32_t sampleRate, size_t bytes);
 
     /**
      * Create RTCP Sender Report
@@ -80,14 +121,42 @@ public:
     virtual std::shared_ptr<lmcore::DataBuffer> CreateRtcpBye(const std::string &reason = "");
 
     /**
-     * Create compound RTCP packet (SR/RR + SDES)
-     * @param cname Canonical name for SDES
+     * Create RTCP Extended Report (RFC 3611)
+     * @return Data buffer containing XR packet, or nullptr if there is nothing to report
+     */
+    virtual std::shared_ptr<lmcore::DataBuffer> CreateRtcpXr();
+
+    /**
+     * Create compound RTCP packet (SR/RR + SDES + XR)
+     * @param cname Canonical name for SDES, no SDES if empty
      * @param name Optional user name for SDES
      * @return Data buffer containing compound packet, or nullptr if not initialized
      */
     virtual std::shared_ptr<lmcore::DataBuffer> CreateCompoundPacket(const std::string &cname,
                                                                      const std::string &name = "");
 
+    /**
+     * Use reduced-size RTCP (RFC 5506), only when both sides signalled a=rtcp-rsize
+     *
+     * Feedback then goes out as a single packet right away instead of inside an SR/RR + SDES compound. Regular
+     * reports from CreateCompoundPacket() stay compound.
+     */
+    void SetReducedSize(bool enabled) { reducedSize_ = enabled; }
+
+    /**
+     * Whether reduced-size RTCP is in use
+     */
+    bool IsReducedSize() const { return reducedSize_; }
+
+    /**
+     * Prepare a feedback packet for sending
+     * @param feedback Feedback packet, e.g. from RtcpReceiverContext::CreateNack()
+     * @param cname Canonical name for SDES, unused with reduced-size RTCP
+     * @return The feedback packet alone with reduced-size RTCP, otherwise SR/RR + SDES + feedback
+     */
+    std::shared_ptr<lmcore::DataBuffer> CreateFeedbackPacket(const std::shared_ptr<lmcore::DataBuffer> &feedback,
+                                                             const std::string &cname);
+
     /**
      * Get total lost packets
      */
@@ -108,13 +177,20 @@ public:
      */
     virtual size_t GetExpectedPacketsInterval() const { return 0; }
 
+    /**
+     * Clock used for NTP timestamps and for the times callers pass to OnRtp()
+     */
+    Clock &GetClock() const { return *clock_; }
+
 protected:
-    uint32_t rtcpSsrc_ = 0;           // SSRC for RTCP packets
-    uint32_t rtpSsrc_ = 0;            // SSRC for RTP stream
-    uint32_t lastRtpTimestamp_ = 0;   // Last RTP timestamp
-    size_t totalBytes_ = 0;           // Total bytes sent/received
-    size_t totalPackets_ = 0;         // Total packets sent/received
-    uint64_t lastNtpTimestampMs_ = 0; // Last NTP timestamp in milliseconds
+    uint32_t rtcpSsrc_ = 0;         // SSRC for RTCP packets
+    uint32_t rtpSsrc_ = 0;          // SSRC for RTP stream
+    uint32_t lastRtpTimestamp_ = 0; // Last RTP timestamp
+    size_t totalBytes_ = 0;         // Total bytes sent/received
+    size_t totalPackets_ = 0;       // Total packets sent/received
+    int64_t lastRtpTimeNs_ = 0;     // Send or arrival time of the last RTP packet
+    bool reducedSize_ = false;      // Reduced-size RTCP negotiated
+    std::shared_ptr<Clock> clock_ = Clock::Get();
 };
 
 /**
@@ -124,6 +200,8 @@ protected:
 class RtcpSenderContext : public RtcpContext {
 public:
     using Ptr = std::shared_ptr<RtcpSenderContext>;
+    using NackCallback = std::function<void(const std::vector<uint16_t> &lostSeqs)>;
+    using PliCallback = std::function<void()>;
 
     /**
      * Create sender context
@@ -153,12 +231,60 @@ public:
      */
     uint32_t GetAverageRtt() const;
 
+    /**
+     * Create XR packet with a DLRR block answering the receiver reference times received since the last one
+     */
+    std::shared_ptr<lmcore::DataBuffer> CreateRtcpXr() override;
+
+    /**
+     * Get the latest receiver report, safe to call from any thread
+     */
+    RtcpReceiverFeedback GetReceiverFeedback() const;
+
+    /**
+     * Get the latest extended report, safe to call from any thread
+     */
+    RtcpXrStats GetXrStats() const;
+
+    /**
+     * Set handler for Generic NACK about our stream, called on the thread calling OnRtcp()
+     * @note Set before RTCP starts arriving
+     */
+    void SetNackCallback(NackCallback callback) { nackCallback_ = std::move(callback); }
+
+    /**
+     * Set handler for Picture Loss Indication about our stream, called on the thread calling OnRtcp()
+     * @note Set before RTCP starts arriving
+     */
+    void SetPliCallback(PliCallback callback) { pliCallback_ = std::move(callback); }
+
 private:
+    struct ReferenceTime {
+        uint32_t lastRr;     // Middle 32 bits of the receiver's NTP timestamp
+        uint64_t receivedMs; // Clock::NowMs() when it arrived
+    };
+
     void ProcessReceiverReport(const RtcpReceiverReport *rr);
+    void ProcessExtendedReport(const uint8_t *data, size_t size);
+    void ProcessFeedback(const RtcpFeedback *fb);
+
+    NackCallback nackCallback_;
+    PliCallback pliCallback_;
+    std::atomic<uint32_t> nackPackets_{0};
+    std::atomic<uint32_t> pliPackets_{0};
+
+    // Latest report block, read by other threads without locking
+    std::atomic<uint32_t> lastFractionLost_{0};
+    std::atomic<uint32_t> lastRttMs_{0};
+    std::atomic<int64_t> lastReportTimeMs_{0};
 
+    // Reports arrive on the network thread while SRs are built on the RTCP timer
+    mutable std::mutex reportMutex_;
     std::map<uint32_t, uint32_t> rttMap_;                // SSRC -> RTT (ms)
     std::map<uint32_t, uint64_t> senderReportNtpMap_;    // LSR -> NTP timestamp (ms)
     std::map<uint32_t, uint64_t> receiverReportTimeMap_; // SSRC -> RR receive time (ms)
+    std::map<uint32_t, ReferenceTime> referenceTimeMap_; // SSRC -> XR receiver reference time not yet answered
+    RtcpXrStats xrStats_;
 };
 
 /**
@@ -182,13 +308,45 @@ public:
     /**
      * Process incoming RTP packet
      */
-    void OnRtp(uint16_t seq, uint32_t timestamp, uint64_t ntpTimestampMs, uint32_t sampleRate, size_t bytes) override;
+    void OnRtp(uint16_t seq, uint32_t timestamp, int64_t timeNs, uint32_t sampleRate, size_t bytes) override;
 
     /**
      * Create RTCP Receiver Report
      */
     std::shared_ptr<lmcore::DataBuffer> CreateRtcpRr() override;
 
+    /**
+     * Add XR reports to compound packets, off by default
+     *
+     * Each XR packet carries a receiver reference time, so a sender answering with DLRR gives this receiver its RTT,
+     * and Loss RLE, Duplicate RLE and statistics summary blocks for the packets received since the previous one.
+     */
+    void SetXrEnabled(bool enabled) { xrEnabled_ = enabled; }
+
+    /**
+     * Create XR packet, nullptr unless enabled with SetXrEnabled()
+     */
+    std::shared_ptr<lmcore::DataBuffer> CreateRtcpXr() override;
+
+    /**
+     * Get RTT from the sender's DLRR answer to our receiver reference time
+     * @return RTT in milliseconds, 0 until a DLRR block has arrived
+     */
+    uint32_t GetRtt() const { return xrRttMs_.load(std::memory_order_relaxed); }
+
+    /**
+     * Create Generic NACK for lost packets of the sender's stream, see CreateFeedbackPacket()
+     * @param lostSeqs Lost RTP sequence numbers
+     * @return Data buffer containing the NACK packet, or nullptr if not initialized or nothing is lost
+     */
+    std::shared_ptr<lmcore::DataBuffer> CreateNack(const std::vector<uint16_t> &lostSeqs);
+
+    /**
+     * Create Picture Loss Indication for the sender's stream, see CreateFeedbackPacket()
+     * @return Data buffer containing the PLI packet, or nullptr if not initialized
+     */
+    std::shared_ptr<lmcore::DataBuffer> CreatePli();
+
     /**
      * Get total lost packets
      */
@@ -221,9 +379,14 @@ public:
 
 private:
     void ProcessSenderReport(const RtcpSenderReport *sr);
+    void ProcessExtendedReport(const uint8_t *data, size_t size);
+    void RecordXrPacket(uint16_t seq);
     void InitSequence(uint16_t seq);
     void UpdateSequence(uint16_t seq);
-    void UpdateJitter(uint32_t timestamp, uint64_t ntpTimestampMs, uint32_t sampleRate);
+    void UpdateJitter(uint32_t timestamp, int64_t arrivalNs, uint32_t sampleRate);
+
+    // Packets arrive on the network thread while RR and XR are built on the RTCP timer
+    mutable std::mutex stateMutex_;
 
     // Sequence number tracking
     uint16_t maxSeq_ = 0;         // Highest sequence number seen
@@ -237,13 +400,31 @@ private:
     uint64_t lastSrNtpMs_ = 0; // Last SR NTP timestamp (ms)
 
     // Jitter calculation
-    double jitter_ = 0.0;            // Interarrival jitter
-    uint64_t lastArrivalTimeMs_ = 0; // Last packet arrival time
+    double jitter_ = 0.0;           // Interarrival jitter
+    bool haveArrival_ = false;      // A packet was received before
+    int64_t lastArrivalNs_ = 0;     // Last packet arrival time
+    uint32_t lastArrivalRtpTs_ = 0; // RTP timestamp of the last packet
 
     // Loss tracking
     size_t lastLost_ = 0;         // Lost packets at last interval
     size_t lastExpected_ = 0;     // Expected packets at last interval
     size_t lastCyclePackets_ = 0; // Packets in last cycle
+
+    // XR reporting interval, at most XR_MAX_SEQ_SPAN sequence numbers, older ones slide out of the report
+    static constexpr size_t XR_MAX_SEQ_SPAN = 4096;
+    bool xrEnabled_ = false;
+    uint32_t xrBeginSeq_ = 0;      // Extended sequence number of xrCounts_[0]
+    std::deque<uint8_t> xrCounts_; // Times each sequence number was received, saturating
+    uint32_t xrJitterSamples_ = 0; // Transit time differences seen in the interval
+    double xrMinJitter_ = 0.0;
+    double xrMaxJitter_ = 0.0;
+    double xrJitterSum_ = 0.0;
+    double xrJitterSquares_ = 0.0;
+
+    // Receiver reference time of the last XR, answered by the sender's DLRR
+    uint32_t lastRrtLrr_ = 0;
+    uint64_t lastRrtMs_ = 0;
+    std::atomic<uint32_t> xrRttMs_{0};
 };
 
 } // namespace lmshao::lmrtsp
@@ -77,12 +77,26 @@ enum class RtpfbType : uint8_t {
     TWCC = 15        // Transport Wide Congestion Control
 };
 
+/**
+ * Extended Report block types (RFC 3611)
+ */
+enum class XrBlockType : uint8_t {
+    LOSS_RLE = 1,                // Loss RLE Report Block
+    DUPLICATE_RLE = 2,           // Duplicate RLE Report Block
+    PACKET_RECEIPT_TIMES = 3,    // Packet Receipt Times Report Block
+    RECEIVER_REFERENCE_TIME = 4, // Receiver Reference Time Report Block
+    DLRR = 5,                    // DLRR Report Block
+    STATISTICS_SUMMARY = 6,      // Statistics Summary Report Block
+    VOIP_METRICS = 7             // VoIP Metrics Report Block
+};
+
 // RTCP constants
 constexpr uint8_t RTCP_VERSION = 2;
 constexpr size_t RTCP_HEADER_SIZE = 4;
 constexpr size_t RTCP_SR_SIZE = 28;
 constexpr size_t RTCP_RR_SIZE = 8;
 constexpr size_t RTCP_REPORT_BLOCK_SIZE = 24;
+constexpr size_t RTCP_XR_BLOCK_HEADER_SIZE = 4;
 
 // NTP constants
 constexpr uint64_t NTP_OFFSET_US = 2208988800000000ULL; // NTP epoch offset in microseconds
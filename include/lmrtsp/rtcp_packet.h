@@ -249,6 +249,22 @@ struct RtcpFeedback : public RtcpHeader {
      * Create RTPFB packet
      */
     static std::shared_ptr<RtcpFeedback> CreateRtpfb(RtpfbType fmt, const void *fci = nullptr, size_t fciLen = 0);
+
+    /**
+     * Create Generic NACK (RFC 4585 6.2.1), up to 17 lost sequence numbers are packed into each PID/BLP item
+     */
+    static std::shared_ptr<RtcpFeedback> CreateNack(uint32_t senderSsrcValue, uint32_t mediaSsrcValue,
+                                                    const std::vector<uint16_t> &lostSeqs);
+
+    /**
+     * Create Picture Loss Indication (RFC 4585 6.3.1)
+     */
+    static std::shared_ptr<RtcpFeedback> CreatePli(uint32_t senderSsrcValue, uint32_t mediaSsrcValue);
+
+    /**
+     * Get lost sequence numbers of a Generic NACK, the packet must be complete
+     */
+    std::vector<uint16_t> GetNackSequences() const;
 };
 
 /**
@@ -261,6 +277,90 @@ struct NackItem {
     NackItem(uint16_t packetId, uint16_t bitmask);
 };
 
+/**
+ * Loss RLE or Duplicate RLE report (RFC 3611 4.1, 4.2), decoded to one flag per sequence number
+ */
+struct XrRleReport {
+    uint32_t ssrc = 0;       // SSRC of the reported source
+    uint16_t beginSeq = 0;   // First sequence number covered
+    uint16_t endSeq = 0;     // Last sequence number covered plus one
+    std::vector<bool> flags; // From beginSeq, true if received (loss RLE) or duplicated (duplicate RLE)
+};
+
+/**
+ * Statistics Summary report (RFC 3611 4.6), jitter values in RTP timestamp units
+ */
+struct XrStatisticsSummary {
+    uint32_t ssrc = 0;        // SSRC of the reported source
+    uint16_t beginSeq = 0;    // First sequence number covered
+    uint16_t endSeq = 0;      // Last sequence number covered plus one
+    bool hasLoss = false;     // L flag, lostPackets is set
+    bool hasDup = false;      // D flag, dupPackets is set
+    bool hasJitter = false;   // J flag, the jitter fields are set
+    uint32_t lostPackets = 0; // Packets lost in the interval
+    uint32_t dupPackets = 0;  // Duplicates received in the interval
+    uint32_t minJitter = 0;   // Smallest relative transit time difference
+    uint32_t maxJitter = 0;   // Largest relative transit time difference
+    uint32_t meanJitter = 0;  // Mean relative transit time difference
+    uint32_t devJitter = 0;   // Standard deviation of the relative transit time difference
+};
+
+/**
+ * DLRR sub-block (RFC 3611 4.5), the answer to a Receiver Reference Time block
+ */
+struct XrDlrrItem {
+    uint32_t ssrc = 0;             // SSRC of the receiver that sent the reference time
+    uint32_t lastRr = 0;           // Middle 32 bits of its NTP timestamp
+    uint32_t delaySinceLastRr = 0; // Delay since it arrived, in 1/65536 seconds
+};
+
+/**
+ * Report blocks of one RTCP XR packet
+ */
+struct RtcpXrReport {
+    uint32_t ssrc = 0;                // SSRC of the XR sender
+    std::vector<XrRleReport> lossRle; // Loss RLE blocks
+    std::vector<XrRleReport> dupRle;  // Duplicate RLE blocks
+    std::vector<XrDlrrItem> dlrr;     // DLRR sub-blocks
+    std::vector<XrStatisticsSummary> statisticsSummary;
+    bool hasReferenceTime = false; // A Receiver Reference Time block is present
+    uint32_t referenceNtpH = 0;    // Its NTP timestamp, most significant word
+    uint32_t referenceNtpL = 0;    // Its NTP timestamp, least significant word
+};
+
+/**
+ * RTCP Extended Report (XR) Packet (RFC 3611)
+ *
+ *  0                   1                   2                   3
+ *  0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1
+ * +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ * |V=2|P|reserved |   PT=XR=207   |             length            |
+ * +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ * |                              SSRC                             |
+ * +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ * :                         report blocks                         :
+ * +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ *
+ * Each block starts with BT (8 bits), type-specific (8 bits) and its length in 32-bit words minus one.
+ */
+struct RtcpXr : public RtcpHeader {
+    uint32_t ssrc; // SSRC of packet sender
+
+    /**
+     * Create XR packet from report blocks, RLE blocks are run-length encoded without thinning
+     */
+    static std::shared_ptr<RtcpXr> Create(const RtcpXrReport &report);
+
+    /**
+     * Parse an XR packet
+     * @param data Packet data, starting at the RTCP header
+     * @param size Packet size in bytes
+     * @param report Output, blocks of unknown types are skipped
+     * @return true if the packet is a well-formed XR packet
+     */
+    static bool Parse(const uint8_t *data, size_t size, RtcpXrReport &report);
+};
+
 /**
  * Helper functions for NTP timestamp conversion
  */
@@ -59,6 +59,9 @@ public:
     // Serialize to a DataBuffer in network byte order
     std::shared_ptr<lmcore::DataBuffer> Serialize() const;
 
+    // Serialize into a caller-provided buffer, returns the packet size or 0 if invalid or too large
+    size_t SerializeTo(uint8_t *buffer, size_t capacity) const;
+
     // Parse from a raw buffer (char* + length) in network byte order
     bool Parse(char *data, size_t length);
 
@@ -10,9 +10,11 @@
 #define LMSHAO_LMRTSP_RTP_SINK_SESSION_H
 
 #include <memory>
+#include <mutex>
 #include <string>
+#include <vector>
 
-#include "lmcore/async_timer.h"
+#include "lmrtsp/clock.h"
 #include "lmrtsp/media_types.h"
 #include "lmrtsp/transport_config.h"
 
@@ -45,6 +47,8 @@ struct RtpSinkSessionConfig {
     uint32_t rtcp_interval_ms = 5000; // RTCP report interval in milliseconds
     std::string rtcp_cname;           // RTCP CNAME (Canonical Name)
     std::string rtcp_name;            // RTCP NAME (User Name)
+    bool enable_rtcp_xr = false;      // Add RTCP XR (RFC 3611) loss, duplicate and reference time reports
+    bool rtcp_reduced_size = false;   // Reduced-size RTCP (RFC 5506), only if the SDP carries a=rtcp-rsize
 };
 
 class RtpSinkSession {
@@ -64,6 +68,19 @@ public:
     // Get RTCP context (for statistics)
     RtcpReceiverContext *GetRtcpContext() const { return rtcpContext_.get(); }
 
+    /**
+     * Ask the sender to retransmit lost packets with a Generic NACK, sent right away
+     * @param lostSeqs Lost RTP sequence numbers
+     * @return true if the feedback was sent
+     */
+    bool SendNack(const std::vector<uint16_t> &lostSeqs);
+
+    /**
+     * Ask the sender for a new key frame with a Picture Loss Indication, sent right away
+     * @return true if the feedback was sent
+     */
+    bool SendPli();
+
 private:
     class DepacketizerListener;
     class TransportListener;
@@ -78,6 +95,7 @@ private:
     void StartRtcpTimer();
     void StopRtcpTimer();
     void SendRtcpReport();
+    bool SendRtcpFeedback(const std::shared_ptr<lmcore::DataBuffer> &feedback);
 
     RtpSinkSessionConfig config_{};
     bool initialized_ = false;
@@ -97,8 +115,10 @@ private:
 
     // RTCP support
     std::shared_ptr<RtcpReceiverContext> rtcpContext_;
-    std::unique_ptr<lmcore::AsyncTimer> rtcpTimer_;
-    lmcore::AsyncTimer::TimerId rtcpTimerId_ = 0;
+    std::mutex rtcpMutex_; // Serializes reports from the RTCP timer with feedback from the caller
+    std::shared_ptr<Clock> clock_;
+    std::unique_ptr<Timer> rtcpTimer_;
+    Timer::TimerId rtcpTimerId_ = 0;
 };
 
 } // namespace lmshao::lmrtsp
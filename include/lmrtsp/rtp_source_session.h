@@ -9,12 +9,15 @@
 #ifndef LMSHAO_LMRTSP_RTP_SOURCE_SESSION_H
 #define LMSHAO_LMRTSP_RTP_SOURCE_SESSION_H
 
+#include <lmcore/data_buffer.h>
+
 #include <memory>
 #include <string>
 
-#include "lmcore/async_timer.h"
+#include "lmrtsp/clock.h"
 #include "lmrtsp/media_types.h"
 #include "lmrtsp/transport_config.h"
+#include "lmrtsp/ts_parser.h"
 
 namespace lmshao::lmrtsp {
 
@@ -24,6 +27,8 @@ class IRtpPacketizer;
 class IRtpPacketizerListener;
 class RtspServerSession;
 class RtcpSenderContext;
+class CpuAccount;
+class EgressShaper;
 
 struct RtpSourceSessionConfig {
     std::string session_id; // Unique session identifier
@@ -35,6 +40,13 @@ struct RtpSourceSessionConfig {
     TransportConfig transport;
     uint32_t mtu_size = 1400; // Maximum transmission unit
 
+    // H.264 frames of at least this many bytes are packetized across the shared worker pool, 0 disables.
+    // Worth enabling for very high bitrate streams whose IDR frames take longer than a frame interval to packetize.
+    size_t parallel_packetize_bytes = 0;
+
+    // MP2T only: null packets and elementary streams to drop before packetizing
+    TSFilterConfig ts_filter;
+
     bool enable_rtcp = false;          // Enable RTCP
     uint32_t rtcp_interval_ms = 5000;  // RTCP report interval in milliseconds
     std::string rtcp_cname;            // RTCP CNAME (Canonical Name)
@@ -43,6 +55,12 @@ struct RtpSourceSessionConfig {
 
     // For TCP interleaved mode
     std::weak_ptr<RtspServerSession> rtsp_session;
+
+    // Optional, receives the packetize and send CPU time while CpuAccount accounting is enabled
+    std::shared_ptr<CpuAccount> cpu_account;
+
+    // Optional, frames it rejects are dropped whole before packetizing; SendFrame() still reports them as handled
+    std::shared_ptr<EgressShaper> egress_shaper;
 };
 
 class RtpSourceSession {
@@ -67,9 +85,18 @@ public:
     // Get RTCP context (for statistics)
     RtcpSenderContext *GetRtcpContext() const { return rtcpContext_.get(); }
 
+    // Feed an RTCP packet from the receiver (RR), arrives on the RTCP socket or interleaved channel
+    void OnRtcpData(const lmcore::DataBuffer &buffer);
+
+    uint32_t GetSsrc() const { return config_.ssrc; }
+
+    // Approximate memory held by the session, its packetizer, RTCP state and transport (thread stacks excluded)
+    size_t GetMemoryUsage() const;
+
 private:
     // Forward declaration for listener
     class PacketizerListener;
+    class TransportListener;
 
     // RTCP methods
     void StartRtcpTimer();
@@ -88,11 +115,17 @@ private:
     std::unique_ptr<IRtpTransportAdapter> transportAdapter_;
     std::unique_ptr<IRtpPacketizer> videoPacketizer_;
     std::shared_ptr<IRtpPacketizerListener> videoListener_;
+    std::shared_ptr<TransportListener> transportListener_;
+
+    // Codec/transport pipeline picked from the static dispatch table in Initialize(), see rtp/rtp_pipeline.h
+    void (*pipeline_)(IRtpPacketizer &, IRtpTransportAdapter &, RtcpSenderContext *, const MediaFrame &,
+                      int64_t) = nullptr;
 
     // RTCP support
     std::shared_ptr<RtcpSenderContext> rtcpContext_;
-    std::unique_ptr<lmcore::AsyncTimer> rtcpTimer_;
-    lmcore::AsyncTimer::TimerId rtcpTimerId_ = 0;
+    std::shared_ptr<Clock> clock_;
+    std::unique_ptr<Timer> rtcpTimer_;
+    Timer::TimerId rtcpTimerId_ = 0;
 };
 
 } // namespace lmshao::lmrtsp
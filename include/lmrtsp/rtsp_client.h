@@ -13,6 +13,8 @@
 #include <lmnet/tcp_client.h>
 
 #include <atomic>
+#include <condition_variable>
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <mutex>
@@ -20,6 +22,7 @@
 #include <unordered_map>
 
 #include "lmrtsp/irtsp_client_listener.h"
+#include "lmrtsp/rtsp_client_runtime.h"
 #include "lmrtsp/rtsp_request.h"
 #include "lmrtsp/rtsp_response.h"
 
@@ -59,6 +62,20 @@ public:
     void SetTimeout(int timeout_ms);
     int GetTimeout() const;
 
+    // Pipelined handshake: DESCRIBE goes out right behind OPTIONS instead of one round trip later
+    void SetPipelining(bool enable);
+    bool GetPipelining() const;
+
+    // Shared client runtime: RTP reception, RTCP timers, keep-alives and reconnects run on RtspClientRuntime threads
+    // instead of threads of this client. Takes effect on the next Start().
+    void SetSharedRuntime(bool enable);
+    bool GetSharedRuntime() const;
+
+    // Keep-alive OPTIONS interval while playing and delay between reconnect attempts, shared runtime only, 0 disables.
+    // The reconnect delay doubles with each failed attempt up to max_interval_ms
+    void SetKeepAliveInterval(int interval_ms);
+    void SetReconnectInterval(int interval_ms, int max_interval_ms = 60000);
+
     // Statistics
     std::string GetServerIP() const;
     uint16_t GetServerPort() const;
@@ -72,7 +89,7 @@ private:
     bool Connect(const std::string &url, int timeout_ms = 5000);
     bool Disconnect();
     bool IsConnected() const;
-    bool SendOptionsRequest(const std::string &url);
+    bool SendOptionsRequest(const std::string &url, const std::string &session_id = "");
     bool SendDescribeRequest(const std::string &url);
     bool SendSetupRequest(const std::string &url, const std::string &transport);
     bool SendPlayRequest(const std::string &url, const std::string &session_id = "");
@@ -96,6 +113,8 @@ private:
     std::atomic<bool> playing_{false};            // Playing state
     std::atomic<bool> handshake_complete_{false}; // Handshake completion flag
     std::atomic<bool> handshake_failed_{false};   // Handshake failure flag
+    std::mutex handshakeMutex_;
+    std::condition_variable handshakeCv_; // Signalled when the handshake completes or fails
 
     // Session management
     mutable std::mutex sessionsMutex_;
@@ -109,22 +128,43 @@ private:
     // Configuration
     std::string userAgent_ = "lmrtsp-client/1.0";
     int timeoutMs_ = 5000;
+    bool pipelining_ = false;
+    bool sharedRuntime_ = false;
+
+    // Shared runtime state, the tick runs on the runtime's timer thread and reconnects on its pool
+    std::mutex lifecycleMutex_;               // Serializes Start(), Stop() and reconnects
+    std::atomic<bool> runtimeActive_{false};  // Registered with the runtime, cleared by Stop()
+    std::atomic<bool> reconnecting_{false};   // A reconnect attempt is queued or running
+    ClientHousekeeping housekeeping_;         // Keep-alive and reconnect deadlines, guarded by lifecycleMutex_
+    uint16_t runtimePort_ = 0;                // Client port pair reserved from the runtime
 
     // Request handling
     std::atomic<uint32_t> cseq_{1}; // CSeq counter
     mutable std::mutex requestMutex_;
+    std::unordered_map<int, std::string> pendingRequests_; // CSeq -> method of requests awaiting a response
+    RtspResponseFramer responseFramer_;                    // Partial response data, reactor thread only
 
     // Internal helper methods
     std::string GenerateCSeq();
     bool SendRequest(const RtspRequest &request);
+    void OnReceiveData(const char *data, size_t size);
     void HandleResponse(const RtspResponse &response);
+    std::string TakePendingMethod(int cseq);
+    void SetHandshakeResult(bool success);
     void ParseUrl(const std::string &url, std::string &host, uint16_t &port, std::string &path);
     bool PerformRTSPHandshake(); // Internal RTSP handshake
+    bool StartStream();          // Start() with lifecycleMutex_ held
+
+    // Shared runtime callbacks
+    void OnRuntimeTick(int64_t now_ms);
+    void Reconnect();
 
     // Error handling
     void NotifyError(int error_code, const std::string &error_message);
     void NotifyListener(std::function<void(IRtspClientListener *)> func);
 
+    friend class RtspClientRuntime;
+
     // Friend classes for state machine to access private methods
     friend class RtspClientSessionState;
     friend class ClientInitialState;
@@ -0,0 +1,200 @@
+/**
+ * @author SHAO Liming <lmshao@163.com>
+ * @copyright Copyright (c) 2025 SHAO Liming
+ * @license MIT
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef LMSHAO_LMRTSP_RTSP_CLIENT_RUNTIME_H
+#define LMSHAO_LMRTSP_RTSP_CLIENT_RUNTIME_H
+
+#include <lmcore/data_buffer.h>
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "lmrtsp/clock.h"
+
+namespace lmshao::lmrtsp {
+
+class RtspClient;
+
+struct RtspClientRuntimeConfig {
+    size_t reactor_count = 0;         // UDP receive reactors, 0 for one per hardware thread
+    std::vector<int> reactor_cpus;    // Reactor i is pinned to reactor_cpus[i % size], empty leaves placement to the OS
+    size_t reconnect_threads = 2;     // Threads running reconnect attempts, which block in connect and the handshake
+    uint32_t tick_interval_ms = 1000; // Resolution of keep-alive and reconnect deadlines
+};
+
+/**
+ * @brief Keep-alive and reconnect deadlines of one client, advanced by the runtime's housekeeping tick
+ *
+ * While playing, a keep-alive is due one interval after the first tick and every interval after that. Once the
+ * connection is lost, the first reconnect attempt is due at once; each failed attempt doubles the delay to the next,
+ * up to the maximum, and a successful one resets it. Not thread-safe, the owner serializes access.
+ */
+class ClientHousekeeping {
+public:
+    enum class Action {
+        NONE,
+        KEEP_ALIVE,
+        RECONNECT
+    };
+
+    // 0 disables keep-alives or reconnects
+    void SetKeepAliveInterval(int interval_ms) { keepAliveIntervalMs_ = interval_ms; }
+    void SetReconnectInterval(int interval_ms, int max_interval_ms);
+
+    /**
+     * @brief Advance the deadlines
+     * @return What the client has to do now
+     */
+    Action OnTick(int64_t now_ms, bool connected, bool playing);
+
+    /**
+     * @brief Report the outcome of a reconnect attempt returned by OnTick()
+     */
+    void OnReconnectResult(int64_t now_ms, bool success);
+
+    // Delay from a failed attempt to the next one
+    int64_t GetReconnectDelay() const;
+
+private:
+    int keepAliveIntervalMs_ = 30000;
+    int reconnectIntervalMs_ = 5000;
+    int maxReconnectIntervalMs_ = 60000;
+    int64_t nextKeepAliveMs_ = 0; // 0 until the first tick after PLAY
+    int64_t nextReconnectMs_ = 0; // Earliest time of the next reconnect attempt
+    uint32_t failedAttempts_ = 0;
+};
+
+/**
+ * @brief Process-wide runtime shared by RtspClient instances that opt in with SetSharedRuntime()
+ *
+ * Pulling many cameras from one process with a thread set per client does not scale. The runtime replaces the
+ * per-client threads with shared ones:
+ * - A fixed set of epoll reactors receives RTP and RTCP. Each local port is one socket served by one reactor, and
+ *   datagrams are routed to receivers by port, then by SSRC when several streams share a port.
+ * - One timer thread runs the RTCP report timers of all sessions and a single housekeeping tick that sends client
+ *   keep-alives and schedules reconnects.
+ * - A small pool runs reconnect attempts, so a dead camera never stalls the timer or a reactor.
+ *
+ * RTSP control connections already share the lmnet reactor. Threads are started on first use. Linux only,
+ * elsewhere AddReceiver() fails and clients fall back to the DEFAULT backend.
+ */
+class RtspClientRuntime {
+public:
+    enum class PacketType {
+        RTP,
+        RTCP
+    };
+
+    using ReceiveHandler = std::function<void(std::shared_ptr<lmcore::DataBuffer> buffer)>;
+    using ReceiverId = uint64_t;
+
+    static RtspClientRuntime &GetInstance();
+
+    /**
+     * @brief Set thread counts and placement, only effective before the runtime starts
+     */
+    void SetConfig(const RtspClientRuntimeConfig &config);
+
+    /**
+     * @brief Receive datagrams arriving on a local port
+     *
+     * The port's socket is opened by the first receiver and closed with the last one. A receiver with ssrc 0 takes
+     * every packet of the port that no other receiver claims by SSRC.
+     * @return Receiver ID, 0 if the socket cannot be opened or the port/SSRC pair is taken
+     */
+    ReceiverId AddReceiver(uint16_t port, PacketType type, uint32_t ssrc, ReceiveHandler handler);
+
+    /**
+     * @brief Remove a receiver, waits for a running handler call to return unless called from that handler
+     */
+    void RemoveReceiver(ReceiverId id);
+
+    /**
+     * @brief Reserve an idle local port pair for a client session, RTCP is RTP + 1
+     * @return RTP port of the pair, 0 on failure
+     */
+    uint16_t AllocatePortPair();
+    void ReleasePortPair(uint16_t rtp_port);
+
+    /**
+     * @brief Timer whose tasks run on the runtime's shared timer thread
+     *
+     * Tasks must return quickly. Destroying the timer cancels its tasks and waits for a running one to return.
+     */
+    std::unique_ptr<Timer> CreateTimer();
+
+    /**
+     * @brief Add a client to the housekeeping tick, the runtime holds it weakly
+     */
+    void RegisterClient(const std::shared_ptr<RtspClient> &client);
+    void UnregisterClient(const RtspClient *client);
+
+    /**
+     * @brief Run a blocking task on the reconnect pool
+     */
+    void PostTask(std::function<void()> task);
+
+    size_t GetReactorCount() const;
+    size_t GetClientCount() const;
+
+private:
+    class SharedTimer;
+    struct Receiver;
+    struct Socket;
+    struct Reactor;
+
+    RtspClientRuntime();
+    ~RtspClientRuntime();
+
+    // Non-copyable and non-movable
+    RtspClientRuntime(const RtspClientRuntime &) = delete;
+    RtspClientRuntime &operator=(const RtspClientRuntime &) = delete;
+    RtspClientRuntime(RtspClientRuntime &&) = delete;
+    RtspClientRuntime &operator=(RtspClientRuntime &&) = delete;
+
+    bool StartReactors();
+    void ReactorLoop(Reactor *reactor, int cpu);
+    void ReceiveFrom(Reactor *reactor, const std::shared_ptr<Socket> &socket);
+    std::shared_ptr<Timer> GetSharedTimer();
+    void Tick();
+    void WorkerFunc();
+
+    RtspClientRuntimeConfig config_;
+
+    // Receive reactors, mutex_ serializes adding and removing sockets
+    mutable std::mutex mutex_;
+    std::vector<std::unique_ptr<Reactor>> reactors_;
+    std::unordered_map<ReceiverId, std::shared_ptr<Receiver>> receivers_;
+    ReceiverId nextReceiverId_ = 1;
+
+    // Shared timer and housekeeping tick
+    std::mutex timerMutex_;
+    std::shared_ptr<Timer> timer_; // Shared with the SharedTimer instances, which may outlive the runtime
+    Timer::TimerId tickId_ = 0;
+
+    mutable std::mutex clientsMutex_;
+    std::unordered_map<const RtspClient *, std::weak_ptr<RtspClient>> clients_;
+
+    // Reconnect pool
+    std::mutex taskMutex_;
+    std::condition_variable taskCv_;
+    std::deque<std::function<void()>> tasks_;
+    std::vector<std::thread> workers_;
+    bool stop_ = false;
+};
+
+} // namespace lmshao::lmrtsp
+
+#endif // LMSHAO_LMRTSP_RTSP_CLIENT_RUNTIME_H
@@ -0,0 +1,190 @@
+/**
+ * @author SHAO Liming <lmshao@163.com>
+ * @copyright Copyright (c) 2025 SHAO Liming
+ * @license MIT
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef LMSHAO_LMRTSP_RTSP_HEADER_MAP_H
+#define LMSHAO_LMRTSP_RTSP_HEADER_MAP_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace lmshao::lmrtsp {
+
+// Well-known RTSP headers, resolved once from their names at parse time
+enum class RtspHeaderId : uint8_t {
+    UNKNOWN = 0,
+
+    // General headers
+    CSEQ,
+    DATE,
+    SESSION,
+    TRANSPORT,
+    RANGE,
+    LOCATION,
+    REQUIRE,
+    PROXY_REQUIRE,
+
+    // Request headers
+    ACCEPT,
+    ACCEPT_ENCODING,
+    ACCEPT_LANGUAGE,
+    AUTHORIZATION,
+    FROM,
+    IF_MODIFIED_SINCE,
+    REFERER,
+    USER_AGENT,
+
+    // Response headers
+    PROXY_AUTHENTICATE,
+    PUBLIC,
+    RETRY_AFTER,
+    SERVER,
+    VARY,
+    WWW_AUTHENTICATE,
+    RTP_INFO,
+
+    // Entity headers
+    CONTENT_TYPE,
+    CONTENT_LENGTH,
+
+    COUNT
+};
+
+/**
+ * @brief Resolve a header name, case-insensitive
+ * @return The header id, UNKNOWN for names that are not well-known
+ */
+RtspHeaderId LookupRtspHeader(std::string_view name);
+
+/**
+ * @brief Canonical name of a well-known header, "" for UNKNOWN
+ */
+const char *GetRtspHeaderName(RtspHeaderId id);
+
+/**
+ * @brief Split "Name: value" into its trimmed name and value without copying
+ * @return false if the line has no colon
+ */
+bool SplitRtspHeaderLine(std::string_view line, std::string_view &name, std::string_view &value);
+
+/**
+ * @brief Compact header container of RtspRequest and RtspResponse
+ *
+ * Entries are (header id, value) pairs in a small inline array, lookups of well-known headers are integer compares.
+ * Headers with unknown names, and any beyond the inline capacity, go to an overflow list. Names of unknown headers
+ * and all values live in one storage string owned by the map, so a typical message costs at most one allocation.
+ * Values are returned as string_views into that storage, valid until the map is modified or destroyed.
+ *
+ * Iteration and find() / at() / count() follow std::map. Iteration yields (name, value) string_view pairs, inline
+ * entries first, each list in insertion order.
+ */
+class RtspHeaderMap {
+public:
+    using value_type = std::pair<std::string_view, std::string_view>;
+
+    class const_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = RtspHeaderMap::value_type;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const value_type *;
+        using reference = const value_type &;
+
+        const_iterator() = default;
+
+        reference operator*() const { return current_; }
+        pointer operator->() const { return &current_; }
+        const_iterator &operator++();
+        const_iterator operator++(int);
+        bool operator==(const const_iterator &other) const { return index_ == other.index_; }
+        bool operator!=(const const_iterator &other) const { return index_ != other.index_; }
+
+    private:
+        friend class RtspHeaderMap;
+        const_iterator(const RtspHeaderMap *map, size_t index);
+        void Load();
+
+        const RtspHeaderMap *map_ = nullptr;
+        size_t index_ = 0;
+        value_type current_;
+    };
+
+    RtspHeaderMap() = default;
+
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, size()); }
+
+    const_iterator find(RtspHeaderId id) const;
+    const_iterator find(std::string_view name) const;
+    size_t count(RtspHeaderId id) const { return find(id) != end() ? 1 : 0; }
+    size_t count(std::string_view name) const { return find(name) != end() ? 1 : 0; }
+
+    /**
+     * @brief Value of a header, throws std::out_of_range if it is absent like std::map::at()
+     */
+    std::string_view at(RtspHeaderId id) const;
+    std::string_view at(std::string_view name) const;
+
+    size_t size() const { return inlineCount_ + overflow_.size(); }
+    bool empty() const { return size() == 0; }
+    void clear();
+
+    /**
+     * @brief Value of a header, "" if it is absent
+     */
+    std::string_view Get(RtspHeaderId id) const;
+
+    /**
+     * @brief Integer value of a header such as CSeq, default_value if it is absent or not a number
+     */
+    int GetInt(RtspHeaderId id, int default_value = 0) const;
+
+    /**
+     * @brief Add a header or replace its value
+     */
+    void Set(RtspHeaderId id, std::string_view value);
+    void Set(std::string_view name, std::string_view value);
+
+    /**
+     * @brief Reserve value storage, e.g. the size of a header block about to be parsed
+     */
+    void Reserve(size_t bytes) { storage_.reserve(bytes); }
+
+private:
+    struct Entry {
+        RtspHeaderId id = RtspHeaderId::UNKNOWN;
+        uint32_t nameOffset = 0; // Unknown headers only
+        uint32_t nameSize = 0;
+        uint32_t valueOffset = 0;
+        uint32_t valueSize = 0;
+    };
+
+    static constexpr size_t INLINE_ENTRIES = 8;
+
+    const Entry &EntryAt(size_t index) const;
+    Entry &EntryAt(size_t index);
+    size_t FindIndex(RtspHeaderId id) const;
+    size_t FindIndex(std::string_view name) const;
+    std::string_view NameOf(const Entry &entry) const;
+    std::string_view ValueOf(const Entry &entry) const;
+    void StoreValue(Entry &entry, std::string_view value);
+
+    std::array<Entry, INLINE_ENTRIES> inline_;
+    size_t inlineCount_ = 0;
+    std::vector<Entry> overflow_;
+    std::string storage_;
+};
+
+} // namespace lmshao::lmrtsp
+
+#endif // LMSHAO_LMRTSP_RTSP_HEADER_MAP_H
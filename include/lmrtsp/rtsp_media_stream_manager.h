@@ -18,12 +18,15 @@
 #include <string>
 #include <thread>
 
+#include "lmrtsp/egress_shaper.h"
 #include "lmrtsp/media_types.h"
+#include "lmrtsp/rtcp_context.h"
 #include "lmrtsp/transport_config.h"
 
 namespace lmshao::lmrtsp {
 class RtspServerSession;
 class RtpSourceSession;
+class CpuAccount;
 // Stream state enumeration and RtspMediaStreamManager should be inside this namespace
 enum class StreamState {
     IDLE,
@@ -35,6 +38,9 @@ enum class StreamState {
 /**
  * Media stream manager for RTSP sessions
  * Replaces the functionality of RtpStream with better separation of concerns
+ *
+ * The RTP source session (packetizer, RTCP context and timer, transport sockets) only exists while playing. SETUP
+ * reserves the UDP server ports, PLAY creates the session on them and PAUSE releases it again.
  */
 class RtspMediaStreamManager {
 public:
@@ -49,13 +55,13 @@ public:
     bool Setup(const lmshao::lmrtsp::TransportConfig &config);
 
     /**
-     * Start playing the media stream
+     * Start playing the media stream, creating the RTP session on the reserved ports
      * @return true if started successfully, false otherwise
      */
     bool Play();
 
     /**
-     * Pause the media stream
+     * Pause the media stream and release the RTP session, keeping the ports reserved
      * @return true if paused successfully, false otherwise
      */
     bool Pause();
@@ -96,7 +102,82 @@ public:
      */
     bool IsActive() const;
 
+    /**
+     * Get approximate memory held by this stream
+     * @return Bytes held by the manager and its RTP session, if any
+     */
+    size_t GetMemoryUsage() const;
+
+    /**
+     * Check whether the RTP session currently exists
+     * @return true while playing
+     */
+    bool HasRtpSession() const;
+
+    /**
+     * Get the CPU account of this stream, kept across PAUSE
+     * @return CPU account, never null
+     */
+    std::shared_ptr<CpuAccount> GetCpuAccount() const { return cpuAccount_; }
+
+    /**
+     * Feed RTCP received on a TCP interleaved channel to the RTP session
+     * @param channel Interleaved channel the packet arrived on
+     * @param buffer RTCP packet
+     * @return true if the channel is this stream's RTCP channel
+     */
+    bool OnInterleavedRtcp(uint8_t channel, const lmcore::DataBuffer &buffer);
+
+    /**
+     * Get the latest receiver report of the RTP session
+     * @return Feedback, invalid while no RTP session exists or no report has arrived
+     */
+    RtcpReceiverFeedback GetReceiverFeedback() const;
+
+    /**
+     * Get the latest RTCP XR report of the RTP session, for clients that send XR
+     * @return Stats, invalid while no RTP session exists or no XR report has arrived
+     */
+    RtcpXrStats GetXrStats() const;
+
+    /**
+     * Check whether the RTP transport releases packets at their departure time
+     * @return true if frames may be pushed ahead of time with MediaFrame::departure_ns set
+     */
+    bool HasKernelPacing() const;
+
+    /**
+     * Get the bytes of sent RTP still queued in the UDP socket send buffer
+     * @return Bytes queued, 0 while no RTP session exists or for TCP interleaved transport
+     */
+    size_t GetSendQueueBytes() const;
+
+    /**
+     * Get the frames sent and dropped by the egress caps, kept across PAUSE
+     * @return Stats, all zero while the server has no egress caps
+     */
+    EgressStats GetEgressStats() const;
+
+    /**
+     * Get the codec resolved at SETUP
+     * @return Media type
+     */
+    MediaType GetMediaType() const { return mediaType_; }
+
+    /**
+     * Get the transport config persisted at SETUP
+     * @return Transport config
+     */
+    const TransportConfig &GetTransportConfig() const { return transport_config_; }
+
 private:
+    /**
+     * Create and initialize the RTP source session from the persisted transport config
+     * Caller holds rtpSessionMutex_
+     * @return true if created successfully, false otherwise
+     */
+    bool CreateRtpSession();
+
     /**
      * Media sending thread function
      */
@@ -110,9 +191,18 @@ private:
 
     std::weak_ptr<lmshao::lmrtsp::RtspServerSession> RtspServerSession_;
     std::unique_ptr<RtpSourceSession> rtpSession_;
+    mutable std::mutex rtpSessionMutex_;
 
     // Persist the transport config to build proper Transport header
     lmshao::lmrtsp::TransportConfig transport_config_{};
+    uint16_t reservedRtpPort_ = 0; // UDP server port pair kept while no RTP session exists
+
+    // Codec resolved at SETUP, used when the RTP session is created
+    MediaType mediaType_ = MediaType::H264;
+    uint8_t payloadType_ = 96;
+
+    std::shared_ptr<CpuAccount> cpuAccount_;
+    std::shared_ptr<EgressShaper> egressShaper_; // Created with the first RTP session, null without egress caps
 
     StreamState state_;
     std::atomic<bool> active_;
@@ -129,7 +219,7 @@ private:
     // RTP parameters
     uint16_t sequenceNumber_;
     uint32_t timestamp_;
-    uint32_t ssrc_;
+    uint32_t ssrc_; // Kept across PAUSE so a resumed stream keeps its SSRC
 };
 
 } // namespace lmshao::lmrtsp
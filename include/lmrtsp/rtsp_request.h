@@ -9,11 +9,11 @@
 #ifndef LMSHAO_LMRTSP_RTSP_REQUEST_H
 #define LMSHAO_LMRTSP_RTSP_REQUEST_H
 
-#include <map>
 #include <optional>
 #include <string>
 #include <vector>
 
+#include "lmrtsp/rtsp_header_map.h"
 #include "lmrtsp/rtsp_headers.h"
 
 namespace lmshao::lmrtsp {
@@ -45,14 +45,14 @@ public:
     std::string ToString() const;
     static RtspRequest FromString(const std::string &req_str);
 
-    std::map<std::string, std::string> entity_header_;
+    RtspHeaderMap entity_header_;
     std::optional<std::string> messageBody_;
 
 public:
     std::string method_;
     std::string uri_;
     std::string version_;
-    std::map<std::string, std::string> general_header_;
+    RtspHeaderMap general_header_;
     RequestHeader requestHeader_;
 };
 
@@ -20,9 +20,16 @@
 #include <mutex>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
+#include "lmrtsp/admission_controller.h"
+#include "lmrtsp/cpu_accounting.h"
+#include "lmrtsp/cpu_affinity.h"
+#include "lmrtsp/egress_shaper.h"
 #include "lmrtsp/irtsp_server_listener.h"
 #include "lmrtsp/media_stream_info.h"
+#include "lmrtsp/transport_config.h"
+#include "lmrtsp/ts_parser.h"
 
 namespace lmshao::lmrtsp {
 using namespace lmshao::lmcore;
@@ -74,6 +81,54 @@ public:
     std::string GetServerIP() const;
     uint16_t GetServerPort() const;
 
+    // Admission control
+    // A sender utilization limit turns on CPU accounting, which feeds it
+    void SetAdmissionLimits(const AdmissionLimits &limits);
+    AdmissionStats GetAdmissionStats() { return admission_.GetStats(); }
+    AdmissionController &GetAdmissionController() { return admission_; }
+
+    // UDP transport backend used for sessions set up after this call
+    void SetTransportBackend(TransportConfig::Backend backend) { transportBackend_.store(backend); }
+    TransportConfig::Backend GetTransportBackend() const { return transportBackend_.load(); }
+
+    // SO_TXTIME pacing on the DEFAULT UDP backend for sessions set up after this call, see
+    // TransportConfig::kernel_pacing. Off by default
+    void SetKernelPacing(bool enabled) { kernelPacing_.store(enabled); }
+    bool GetKernelPacing() const { return kernelPacing_.load(); }
+
+    // H.264 frames of at least this size are packetized on the shared worker pool, 0 disables
+    void SetParallelPacketizeBytes(size_t bytes) { parallelPacketizeBytes_.store(bytes); }
+    size_t GetParallelPacketizeBytes() const { return parallelPacketizeBytes_.load(); }
+
+    // TS packets dropped before packetizing for MP2T sessions set up after this call, off by default
+    void SetTSFilter(const TSFilterConfig &filter)
+    {
+        std::lock_guard<std::mutex> lock(tsFilterMutex_);
+        tsFilter_ = filter;
+    }
+    TSFilterConfig GetTSFilter() const
+    {
+        std::lock_guard<std::mutex> lock(tsFilterMutex_);
+        return tsFilter_;
+    }
+
+    // Egress caps for sessions set up after this call, off by default. A client IP's bucket keeps the rate it was
+    // created with while any session of that client holds it
+    void SetEgressLimits(const EgressLimits &limits);
+    EgressLimits GetEgressLimits() const;
+    // Bucket shared by the sessions of a client IP, null while client_ip_bps is 0
+    std::shared_ptr<TokenBucket> GetClientEgressBucket(const std::string &client_ip);
+
+    // Thread placement: lmnet reactor threads are pinned on their next callback, the packetizer pool when it starts,
+    // and sessions set up afterwards are served from the NUMA node of a sender CPU, see RtspServerSession::GetHomeCpu
+    void SetCpuAffinity(const CpuAffinityConfig &config);
+    CpuAffinityConfig GetCpuAffinity() const;
+
+    // Per-session CPU accounting, off by default
+    void SetCpuAccounting(bool enabled) { CpuAccount::SetEnabled(enabled); }
+    // CPU usage aggregated per stream path and codec, over live and removed sessions
+    std::vector<StreamCpuUsage> GetCpuStats();
+
 protected:
     RtspServer();
 
@@ -84,6 +139,14 @@ private:
     std::string serverIP_;
     uint16_t serverPort_;
     std::atomic<bool> running_{false};
+    std::atomic<TransportConfig::Backend> transportBackend_{TransportConfig::Backend::DEFAULT};
+    std::atomic<bool> kernelPacing_{false};
+    std::atomic<size_t> parallelPacketizeBytes_{0};
+    mutable std::mutex tsFilterMutex_;
+    TSFilterConfig tsFilter_;
+    mutable std::mutex affinityMutex_;
+    CpuAffinityConfig affinity_;
+    std::atomic<uint64_t> affinityGeneration_{0};
 
     // Session management
     mutable std::mutex sessionsMutex_;
@@ -97,9 +160,24 @@ private:
     mutable std::mutex streamsMutex_;
     std::map<std::string, std::shared_ptr<MediaStreamInfo>> mediaStreams_;
 
+    // Admission control
+    AdmissionController admission_;
+
+    // Egress caps, client buckets live as long as a session of the client holds them
+    mutable std::mutex egressMutex_;
+    EgressLimits egressLimits_;
+    std::unordered_map<std::string, std::weak_ptr<TokenBucket>> clientEgressBuckets_;
+
+    // CPU usage of removed sessions, by stream path and codec
+    mutable std::mutex cpuStatsMutex_;
+    std::map<std::pair<std::string, std::string>, CpuUsage> retiredCpu_;
+
     // Internal helper methods
     std::string GetClientIP(std::shared_ptr<RtspServerSession> session) const;
+    void SendAdmissionRejection(std::shared_ptr<lmnet::Session> lmnetSession, const RtspRequest &request,
+                                const AdmissionDecision &decision);
     void NotifyListener(std::function<void(IRtspServerListener *)> func);
+    void PinReactorThread();
 };
 
 } // namespace lmshao::lmrtsp
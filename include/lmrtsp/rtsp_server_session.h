@@ -20,7 +20,11 @@
 #include <string>
 #include <vector>
 
+#include "lmrtsp/clock.h"
+#include "lmrtsp/cpu_accounting.h"
+#include "lmrtsp/egress_shaper.h"
 #include "lmrtsp/media_stream_info.h"
+#include "lmrtsp/priority_send_queue.h"
 #include "lmrtsp/rtsp_media_stream_manager.h"
 #include "lmrtsp/rtsp_request.h"
 #include "lmrtsp/rtsp_response.h"
@@ -33,6 +37,29 @@ class RtspServer;
 class RtspMediaStreamManager;
 struct MediaFrame;
 
+/**
+ * @brief Approximate memory held by a server session, thread stacks and kernel socket buffers excluded
+ */
+struct SessionMemoryUsage {
+    size_t session_bytes = 0;    // Session object, SDP and transport strings
+    size_t stream_bytes = 0;     // Stream managers and their RTP sessions
+    size_t send_queue_bytes = 0; // Queued TCP interleaved packets
+    size_t rtp_sessions = 0;     // Live RTP sessions, 0 while idle
+
+    size_t Total() const { return session_bytes + stream_bytes + send_queue_bytes; }
+};
+
+/**
+ * @brief Delivery conditions of one track, inputs for adapting the bitrate sent to the client
+ */
+struct DeliveryStats {
+    bool has_receiver_report = false; // RTCP RR received while playing
+    uint8_t fraction_lost = 0;        // Loss in the last RR interval, in 1/256
+    uint32_t rtt_ms = 0;              // RTT from the last RR, 0 if unknown
+    int64_t report_age_ms = 0;        // Time since the last RR
+    size_t send_queue_bytes = 0;      // Unsent bytes in the TCP socket and the interleaved queue, 0 for UDP
+};
+
 /**
  * @brief RTSP Server Session state enum
  */
@@ -106,7 +133,50 @@ public:
     std::string GetStreamUri() const; // Get saved stream URI for RTP-Info in PLAY response
 
     // TCP interleaved data sending (for TcpInterleavedTransportAdapter)
-    bool SendInterleavedData(uint8_t channel, const uint8_t *data, size_t size);
+    // All tracks share the connection, so packets are queued by priority while the socket send queue is backed up
+    // frame groups the packets of one media frame, the send queue drops them together; 0 for standalone packets
+    bool SendInterleavedData(uint8_t channel, const uint8_t *data, size_t size,
+                             SendPriority priority = SendPriority::REFERENCE, uint64_t frame = 0);
+    uint64_t GetInterleavedDropped(SendPriority priority) const;
+
+    // RTCP from the client on an interleaved channel, dispatched to the track owning the channel
+    void OnInterleavedData(uint8_t channel, const uint8_t *data, size_t size);
+
+    // Receiver feedback and send backlog for rate adaptation. Track index -1 selects the single-track stream
+    DeliveryStats GetDeliveryStats(int track_index = -1) const;
+
+    // Whether frames may be pushed ahead of time with a departure time. Track index -1 selects the single-track stream
+    bool HasKernelPacing(int track_index = -1) const;
+
+    // Unsent media bytes in the UDP socket buffers of all tracks, the RTSP socket and the interleaved queue
+    size_t GetSendQueueBytes() const;
+
+    /**
+     * @brief Create the egress policy of one track, against the session and client IP caps of the server
+     *
+     * The tracks of a session share one session bucket.
+     * @return Shaper, null when the server has no egress caps
+     */
+    std::shared_ptr<EgressShaper> CreateEgressShaper();
+
+    // Frames sent and dropped by the egress caps. Track index -1 selects the single-track stream
+    EgressStats GetEgressStats(int track_index = -1) const;
+
+    /**
+     * @brief CPU this session is served from, chosen once from the server's sender CPUs
+     *
+     * Send threads pin themselves to the NUMA node of this CPU so the buffers they allocate are node-local, and UDP
+     * sockets are tagged with it through SO_INCOMING_CPU.
+     * @return CPU number, -1 when no sender CPUs are configured
+     */
+    int GetHomeCpu();
+
+    // Memory accounting, idle (SETUP or PAUSED) sessions hold no RTP session
+    SessionMemoryUsage GetMemoryUsage() const;
+
+    // CPU accounting, see CpuAccount. Track index -1 selects the single-track stream
+    std::shared_ptr<CpuAccount> GetCpuAccount(int track_index = -1) const;
+    std::vector<StreamCpuUsage> GetCpuUsage() const;
 
     // Multi-track support: get track information
     struct TrackInfo {
@@ -120,6 +190,11 @@ public:
 private:
     // Helper methods
     static std::string GenerateSessionId();
+    bool IsSendCongested() const;
+    size_t GetSocketSendQueueBytes() const;
+    bool DrainInterleavedQueue(); // Caller holds interleavedMutex_
+    void StartDrainTimer();       // Caller holds interleavedMutex_
+    void StopDrainTimer();        // Caller holds interleavedMutex_
 
     std::string sessionId_;
     RtspServerSessionState *currentState_;
@@ -161,9 +236,25 @@ private:
     // Session timeout
     uint32_t timeout_;                    // Session timeout (seconds)
     std::atomic<int64_t> lastActiveTime_; // Last active time (milliseconds)
+    std::atomic<int> homeCpu_{-2}; // -2 until GetHomeCpu() has chosen
+    std::shared_ptr<Clock> clock_ = Clock::Get();
+
+    // Egress cap shared by all tracks, created with the first track's shaper
+    std::mutex egressMutex_;
+    std::shared_ptr<TokenBucket> egressBucket_;
 
     // Stream URI for RTP-Info in PLAY response
     std::string streamUri_;
+
+    // TCP interleaved send queue, shared by all tracks
+    PrioritySendQueue<std::vector<uint8_t>> interleavedQueue_;
+    mutable std::mutex interleavedMutex_;
+    uint64_t congestionFrame_ = 0; // Frame sendCongested_ was read for, 0 to read it again on the next packet
+    bool sendCongested_ = false;
+    Timer::TimerId drainTaskId_ = 0;
+    // Drains the queue once the socket takes data again, created when the queue holds packets back and destroyed
+    // once it is empty again. Declared last so it stops before the members its task uses are destroyed
+    std::unique_ptr<Timer> drainTimer_;
 };
 
 } // namespace lmshao::lmrtsp
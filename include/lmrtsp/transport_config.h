@@ -26,6 +26,12 @@ struct TransportConfig {
         SINK    ///< RTP Sink (receiver)
     };
 
+    enum class Backend {
+        DEFAULT,  ///< lmnet UDP sockets
+        IO_URING, ///< io_uring rings (Linux, falls back to DEFAULT when unavailable)
+        SHARED    ///< RtspClientRuntime receive reactors (SINK only, falls back to DEFAULT when unavailable)
+    };
+
     Type type = Type::UDP;
     Mode mode = Mode::SOURCE;
     std::string client_ip;
@@ -37,6 +43,10 @@ struct TransportConfig {
     uint8_t rtcpChannel = 1;
     std::pair<uint8_t, uint8_t> interleavedChannels = {0, 1};
     bool unicast = true;
+    Backend backend = Backend::DEFAULT;
+    int incoming_cpu = -1;      ///< SO_INCOMING_CPU for UDP sockets, -1 leaves steering to the kernel
+    bool kernel_pacing = false; ///< SO_TXTIME departure times on UDP SOURCE sockets (Linux, fq qdisc)
+    bool batch_send = false;    ///< DEFAULT backend SOURCE: send each frame's packets in one sendmmsg at Flush (Linux)
 };
 
 } // namespace lmshao::lmrtsp
@@ -9,7 +9,11 @@
 #ifndef LMSHAO_LMRTSP_TS_PARSER_H
 #define LMSHAO_LMRTSP_TS_PARSER_H
 
+#include <bitset>
+#include <cstddef>
 #include <cstdint>
+#include <map>
+#include <vector>
 
 namespace lmshao::lmrtsp {
 
@@ -23,6 +27,35 @@ struct TSPacketInfo {
     bool has_adaptation_field = false; ///< Whether adaptation field is present
     bool discontinuity = false;        ///< Discontinuity indicator (PCR may be discontinuous)
     bool random_access = false;        ///< Random access indicator (key frame)
+    bool payload_unit_start = false;   ///< Payload unit start indicator, a PES packet or PSI section begins here
+    bool pes_start = false;            ///< Payload starts with a PES packet start code
+};
+
+/**
+ * @brief Elementary stream entry of a PMT
+ */
+struct TSElementaryStream {
+    uint8_t stream_type = 0; ///< ISO/IEC 13818-1 stream_type, e.g. 0x1B for H.264, 0x0F for AAC
+    uint16_t pid = 0;        ///< Elementary stream PID
+};
+
+/**
+ * @brief Program map extracted from a PMT section
+ */
+struct TSProgramMap {
+    uint16_t program_number = 0;
+    uint16_t pcr_pid = 0;
+    std::vector<TSElementaryStream> streams;
+};
+
+/**
+ * @brief Which TS packets the remux stage forwards
+ */
+struct TSFilterConfig {
+    bool drop_null_packets = false;    ///< Drop PID 0x1FFF stuffing
+    std::vector<uint8_t> stream_types; ///< PMT stream types to keep, empty keeps every elementary stream
+
+    bool IsEnabled() const { return drop_null_packets || !stream_types.empty(); }
 };
 
 /**
@@ -73,6 +106,36 @@ public:
      */
     static bool IsPCRDiscontinuous(uint64_t prev_pcr, uint64_t curr_pcr, uint64_t max_interval = 2700000);
 
+    /**
+     * @brief Parse a PAT carried in a single TS packet
+     *
+     * @param packet_data TS packet data (must be at least 188 bytes)
+     * @param pmt_pids Output PMT PIDs, the network PID (program 0) is skipped
+     * @return true if the packet starts a PAT section that fits in the packet
+     */
+    static bool ParsePAT(const uint8_t *packet_data, std::vector<uint16_t> &pmt_pids);
+
+    /**
+     * @brief Parse a PMT carried in a single TS packet
+     *
+     * @param packet_data TS packet data (must be at least 188 bytes)
+     * @param program Output program map
+     * @return true if the packet starts a PMT section that fits in the packet
+     */
+    static bool ParsePMT(const uint8_t *packet_data, TSProgramMap &program);
+
+    /**
+     * @brief MPEG-2 section CRC32 (polynomial 0x04C11DB7, no reflection)
+     */
+    static uint32_t SectionCRC32(const uint8_t *data, size_t size);
+
+    /**
+     * @brief Offset of the PSI section in a packet, after the header, adaptation field and pointer field
+     *
+     * @return false if the packet does not start a section or the offsets run past the packet
+     */
+    static bool GetSectionOffset(const uint8_t *packet_data, size_t &offset);
+
 private:
     /**
      * @brief Extract PCR from adaptation field
@@ -85,6 +148,51 @@ private:
     static bool ExtractPCR(const uint8_t *adaptation_field_data, uint8_t adaptation_field_length, uint64_t &pcr);
 };
 
+/**
+ * @brief Drops TS packets a client does not need before they are packetized
+ *
+ * Tracks the PAT and PMTs of the stream. Null packets are dropped when configured, and when stream types are selected
+ * the packets of every other elementary stream are dropped and the PMT is rewritten to list only the kept streams.
+ * The PCR PID is always kept. PMTs that span several packets are forwarded unchanged and disable elementary stream
+ * filtering for their program. Continuity counters are per PID, so dropping whole PIDs leaves them valid.
+ */
+class TSRemuxer {
+public:
+    explicit TSRemuxer(const TSFilterConfig &config) : config_(config) {}
+
+    /**
+     * @brief Filter whole 188-byte packets into out, trailing bytes of an incomplete packet are dropped
+     *
+     * @param out Output buffer of at least size bytes, must not overlap data
+     * @return Number of bytes written to out
+     */
+    size_t Filter(const uint8_t *data, size_t size, uint8_t *out);
+
+    uint64_t GetDroppedPackets() const { return droppedPackets_; }
+
+private:
+    static constexpr size_t TS_MAX_PIDS = 8192;
+
+    // Rewritten section of one PMT PID, reused while the source PMT keeps the same CRC
+    struct PmtRewrite {
+        uint32_t source_crc = 0;
+        std::vector<uint8_t> section;
+        std::vector<uint16_t> dropped_pids;
+    };
+
+    void OnPAT(const uint8_t *packet);
+    // Returns false if the PMT packet is to be forwarded unchanged
+    bool RewritePMT(uint16_t pid, const uint8_t *packet, uint8_t *out);
+    bool BuildRewrite(const uint8_t *packet, PmtRewrite &rewrite) const;
+    void UpdateDroppedPids();
+
+    TSFilterConfig config_;
+    std::bitset<TS_MAX_PIDS> pmtPids_;
+    std::bitset<TS_MAX_PIDS> droppedPids_;
+    std::map<uint16_t, PmtRewrite> pmtRewrites_;
+    uint64_t droppedPackets_ = 0;
+};
+
 } // namespace lmshao::lmrtsp
 
 #endif // LMSHAO_LMRTSP_TS_PARSER_H
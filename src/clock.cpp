@@ -0,0 +1,289 @@
+/**
+ * @author SHAO Liming <lmshao@163.com>
+ * @copyright Copyright (c) 2025 SHAO Liming
+ * @license MIT
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "lmrtsp/clock.h"
+
+#include <lmcore/async_timer.h>
+#include <lmcore/time_utils.h>
+
+#include <time.h>
+
+#include <algorithm>
+#include <chrono>
+
+#if defined(__x86_64__) && defined(__linux__)
+#include <cpuid.h>
+#include <x86intrin.h>
+#define LMRTSP_HAVE_TSC
+#endif
+
+namespace lmshao::lmrtsp {
+
+namespace {
+
+std::mutex g_clockMutex;
+std::shared_ptr<Clock> g_clock;
+
+int64_t ReadRawNs()
+{
+#if defined(CLOCK_MONOTONIC_RAW)
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+#endif
+}
+
+#ifdef LMRTSP_HAVE_TSC
+// TSC to nanoseconds: ns = baseNs + ((tsc - baseTsc) * mult) >> 32
+struct TscCalibration {
+    bool usable = false;
+    uint64_t baseTsc = 0;
+    int64_t baseNs = 0;
+    uint64_t mult = 0;
+};
+
+TscCalibration CalibrateTsc()
+{
+    TscCalibration calibration;
+
+    // Only an invariant TSC runs at a constant rate across P-states and is usable as a clock
+    unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+    if (__get_cpuid(0x80000000, &eax, &ebx, &ecx, &edx) == 0 || eax < 0x80000007) {
+        return calibration;
+    }
+    __get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx);
+    if ((edx & (1u << 8)) == 0) {
+        return calibration;
+    }
+
+    int64_t startNs = ReadRawNs();
+    uint64_t startTsc = __rdtsc();
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    int64_t endNs = ReadRawNs();
+    uint64_t endTsc = __rdtsc();
+
+    if (endTsc <= startTsc || endNs <= startNs) {
+        return calibration;
+    }
+
+    calibration.mult = static_cast<uint64_t>(
+        (static_cast<unsigned __int128>(endNs - startNs) << 32) / static_cast<unsigned __int128>(endTsc - startTsc));
+    calibration.baseTsc = endTsc;
+    calibration.baseNs = endNs;
+    calibration.usable = calibration.mult > 0;
+    return calibration;
+}
+
+const TscCalibration &GetTscCalibration()
+{
+    static const TscCalibration calibration = CalibrateTsc();
+    return calibration;
+}
+#endif
+
+class SystemTimer : public Timer {
+public:
+    SystemTimer() : timer_(1) { timer_.Start(); }
+    ~SystemTimer() override { timer_.Stop(); }
+
+    TimerId ScheduleRepeating(std::function<void()> task, uint32_t interval_ms) override
+    {
+        return timer_.ScheduleRepeating(std::move(task), interval_ms);
+    }
+
+    void Cancel(TimerId id) override { timer_.Cancel(id); }
+
+private:
+    lmcore::AsyncTimer timer_;
+};
+
+} // namespace
+
+class SimulatedTimer : public Timer {
+public:
+    explicit SimulatedTimer(std::shared_ptr<SimulatedClock> clock) : clock_(std::move(clock)) {}
+    ~SimulatedTimer() override { clock_->CancelOwner(this); }
+
+    TimerId ScheduleRepeating(std::function<void()> task, uint32_t interval_ms) override
+    {
+        return clock_->AddTask(this, std::move(task), interval_ms);
+    }
+
+    void Cancel(TimerId id) override { clock_->CancelTask(id); }
+
+private:
+    std::shared_ptr<SimulatedClock> clock_;
+};
+
+std::shared_ptr<Clock> Clock::Get()
+{
+    std::lock_guard<std::mutex> lock(g_clockMutex);
+    if (!g_clock) {
+        g_clock = std::make_shared<SystemClock>();
+    }
+    return g_clock;
+}
+
+void Clock::Set(std::shared_ptr<Clock> clock)
+{
+    std::lock_guard<std::mutex> lock(g_clockMutex);
+    g_clock = std::move(clock);
+}
+
+int64_t FastMonotonicNs()
+{
+#ifdef LMRTSP_HAVE_TSC
+    const TscCalibration &calibration = GetTscCalibration();
+    if (calibration.usable) {
+        unsigned __int128 ticks = __rdtsc() - calibration.baseTsc;
+        return calibration.baseNs + static_cast<int64_t>((ticks * calibration.mult) >> 32);
+    }
+#endif
+    return ReadRawNs();
+}
+
+SystemClock::SystemClock()
+{
+    // Calibrate here rather than on the first send
+    FastMonotonicNs();
+}
+
+int64_t SystemClock::NowMs() const
+{
+    return lmcore::TimeUtils::GetCurrentTimeMs();
+}
+
+int64_t SystemClock::MonotonicNs() const
+{
+    return FastMonotonicNs();
+}
+
+void SystemClock::SleepUs(int64_t us)
+{
+    std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
+
+std::unique_ptr<Timer> SystemClock::CreateTimer()
+{
+    return std::make_unique<SystemTimer>();
+}
+
+SimulatedClock::SimulatedClock(int64_t start_ms) : startMs_(start_ms) {}
+
+int64_t SimulatedClock::NowMs() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return startMs_ + nowUs_ / 1000;
+}
+
+int64_t SimulatedClock::MonotonicNs() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return nowUs_ * 1000;
+}
+
+void SimulatedClock::SleepUs(int64_t us)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (autoAdvance_) {
+        lock.unlock();
+        Advance(us);
+        return;
+    }
+
+    int64_t deadline = nowUs_ + us;
+    advanced_.wait(lock, [this, deadline]() { return nowUs_ >= deadline || autoAdvance_; });
+}
+
+std::unique_ptr<Timer> SimulatedClock::CreateTimer()
+{
+    return std::make_unique<SimulatedTimer>(shared_from_this());
+}
+
+void SimulatedClock::Advance(int64_t us)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    int64_t target = nowUs_ + (us > 0 ? us : 0);
+
+    for (;;) {
+        auto next = tasks_.end();
+        for (auto it = tasks_.begin(); it != tasks_.end(); ++it) {
+            if (it->second.due_us <= target && (next == tasks_.end() || it->second.due_us < next->second.due_us)) {
+                next = it;
+            }
+        }
+        if (next == tasks_.end()) {
+            break;
+        }
+
+        // Stop at the deadline so the task sees the time it was due at
+        nowUs_ = std::max(nowUs_, next->second.due_us);
+        next->second.due_us += next->second.interval_us;
+        auto run = next->second.run;
+        runningId_ = next->first;
+        runningOwner_ = next->second.owner;
+        runningThread_ = std::this_thread::get_id();
+        advanced_.notify_all();
+
+        lock.unlock();
+        run();
+        lock.lock();
+
+        runningId_ = 0;
+        runningOwner_ = nullptr;
+        taskDone_.notify_all();
+    }
+
+    nowUs_ = target;
+    advanced_.notify_all();
+}
+
+void SimulatedClock::SetAutoAdvance(bool enable)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    autoAdvance_ = enable;
+    advanced_.notify_all();
+}
+
+Timer::TimerId SimulatedClock::AddTask(const void *owner, std::function<void()> task, uint32_t interval_ms)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    int64_t interval_us = static_cast<int64_t>(interval_ms > 0 ? interval_ms : 1) * 1000;
+    Timer::TimerId id = nextId_++;
+    tasks_[id] = Task{owner, nowUs_ + interval_us, interval_us, std::move(task)};
+    return id;
+}
+
+void SimulatedClock::CancelTask(Timer::TimerId id)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    tasks_.erase(id);
+    // A task may cancel itself, only wait for runs on other threads
+    taskDone_.wait(lock,
+                   [this, id]() { return runningId_ != id || runningThread_ == std::this_thread::get_id(); });
+}
+
+void SimulatedClock::CancelOwner(const void *owner)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (auto it = tasks_.begin(); it != tasks_.end();) {
+        if (it->second.owner == owner) {
+            it = tasks_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    taskDone_.wait(lock, [this, owner]() {
+        return runningOwner_ != owner || runningThread_ == std::this_thread::get_id();
+    });
+}
+
+} // namespace lmshao::lmrtsp
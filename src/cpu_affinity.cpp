@@ -0,0 +1,213 @@
+/**
+ * @author SHAO Liming <lmshao@163.com>
+ * @copyright Copyright (c) 2025 SHAO Liming
+ * @license MIT
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "lmrtsp/cpu_affinity.h"
+
+#include <algorithm>
+#include <atomic>
+#include <sstream>
+
+#ifdef __linux__
+#include <dirent.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/socket.h>
+#endif
+
+#include "internal_logger.h"
+
+namespace lmshao::lmrtsp {
+
+// Highest CPU count a cpu_set_t holds with glibc's default CPU_SETSIZE
+static constexpr int MAX_CPUS = 1024;
+
+static bool ParseCpu(const std::string &text, int &cpu)
+{
+    if (text.empty() || text.size() > 4 || !std::all_of(text.begin(), text.end(), [](char c) {
+            return c >= '0' && c <= '9';
+        })) {
+        return false;
+    }
+    cpu = std::stoi(text);
+    return cpu < MAX_CPUS;
+}
+
+bool CpuAffinity::ParseCpuList(const std::string &list, std::vector<int> &cpus)
+{
+    cpus.clear();
+
+    std::stringstream stream(list);
+    std::string range;
+    while (std::getline(stream, range, ',')) {
+        if (range.empty()) {
+            continue;
+        }
+
+        size_t dash = range.find('-');
+        std::string firstText = range.substr(0, dash);
+        std::string lastText = dash == std::string::npos ? firstText : range.substr(dash + 1);
+        int first = 0;
+        int last = 0;
+        if (!ParseCpu(firstText, first) || !ParseCpu(lastText, last) || last < first) {
+            cpus.clear();
+            return false;
+        }
+        for (int cpu = first; cpu <= last; ++cpu) {
+            cpus.push_back(cpu);
+        }
+    }
+
+    std::sort(cpus.begin(), cpus.end());
+    cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+    return !cpus.empty();
+}
+
+bool CpuAffinity::PinCurrentThread(const std::vector<int> &cpus)
+{
+    if (cpus.empty()) {
+        return true;
+    }
+
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : cpus) {
+        if (cpu >= 0 && cpu < CPU_SETSIZE) {
+            CPU_SET(cpu, &set);
+        }
+    }
+
+    int result = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    if (result != 0) {
+        LMRTSP_LOGW("Failed to pin thread to %zu CPUs: error %d", cpus.size(), result);
+        return false;
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+int CpuAffinity::GetCurrentCpu()
+{
+#ifdef __linux__
+    return sched_getcpu();
+#else
+    return -1;
+#endif
+}
+
+int CpuAffinity::GetNumaNode(int cpu)
+{
+#ifdef __linux__
+    if (cpu < 0) {
+        return 0;
+    }
+
+    // The node of a CPU shows up as a nodeN link in its sysfs directory
+    std::string path = "/sys/devices/system/cpu/cpu" + std::to_string(cpu);
+    DIR *dir = opendir(path.c_str());
+    if (!dir) {
+        return 0;
+    }
+
+    int node = 0;
+    while (dirent *entry = readdir(dir)) {
+        std::string name = entry->d_name;
+        if (name.size() > 4 && name.compare(0, 4, "node") == 0 &&
+            std::all_of(name.begin() + 4, name.end(), [](char c) { return c >= '0' && c <= '9'; })) {
+            node = std::stoi(name.substr(4));
+            break;
+        }
+    }
+    closedir(dir);
+    return node;
+#else
+    (void)cpu;
+    return 0;
+#endif
+}
+
+std::vector<int> CpuAffinity::GetNodeCpus(const std::vector<int> &cpus, int home_cpu)
+{
+    if (home_cpu < 0) {
+        return cpus;
+    }
+
+    int node = GetNumaNode(home_cpu);
+    std::vector<int> nodeCpus;
+    for (int cpu : cpus) {
+        if (GetNumaNode(cpu) == node) {
+            nodeCpus.push_back(cpu);
+        }
+    }
+    return nodeCpus.empty() ? cpus : nodeCpus;
+}
+
+int CpuAffinity::SelectHomeCpu(const std::vector<int> &cpus, int incoming_cpu)
+{
+    if (cpus.empty()) {
+        return -1;
+    }
+
+    static std::atomic<size_t> next{0};
+
+    if (incoming_cpu >= 0) {
+        if (std::find(cpus.begin(), cpus.end(), incoming_cpu) != cpus.end()) {
+            return incoming_cpu;
+        }
+
+        // Same node as the incoming CPU, spread over that node's CPUs of the set
+        int node = GetNumaNode(incoming_cpu);
+        std::vector<int> nodeCpus;
+        for (int cpu : cpus) {
+            if (GetNumaNode(cpu) == node) {
+                nodeCpus.push_back(cpu);
+            }
+        }
+        if (!nodeCpus.empty()) {
+            return nodeCpus[next++ % nodeCpus.size()];
+        }
+    }
+
+    return cpus[next++ % cpus.size()];
+}
+
+int CpuAffinity::GetIncomingCpu(int fd)
+{
+#if defined(__linux__) && defined(SO_INCOMING_CPU)
+    int cpu = -1;
+    socklen_t len = sizeof(cpu);
+    if (fd >= 0 && getsockopt(fd, SOL_SOCKET, SO_INCOMING_CPU, &cpu, &len) == 0) {
+        return cpu;
+    }
+#else
+    (void)fd;
+#endif
+    return -1;
+}
+
+bool CpuAffinity::SetIncomingCpu(int fd, int cpu)
+{
+#if defined(__linux__) && defined(SO_INCOMING_CPU)
+    if (fd < 0 || cpu < 0) {
+        return false;
+    }
+    if (setsockopt(fd, SOL_SOCKET, SO_INCOMING_CPU, &cpu, sizeof(cpu)) != 0) {
+        LMRTSP_LOGD("SO_INCOMING_CPU %d not set on fd %d", cpu, fd);
+        return false;
+    }
+    return true;
+#else
+    (void)fd;
+    (void)cpu;
+    return false;
+#endif
+}
+
+} // namespace lmshao::lmrtsp
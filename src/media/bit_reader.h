@@ -0,0 +1,179 @@
+/**
+ * @author SHAO Liming <lmshao@163.com>
+ * @copyright Copyright (c) 2025 SHAO Liming
+ * @license MIT
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef LMSHAO_LMRTSP_BIT_READER_H
+#define LMSHAO_LMRTSP_BIT_READER_H
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace lmshao::lmrtsp {
+
+/**
+ * @brief MSB-first bit reader for H.264/H.265 NAL unit payloads
+ *
+ * Reads the escaped NAL unit in place. Emulation prevention bytes (0x03 after two zero bytes) are dropped while the
+ * 64-bit cache is refilled, so parsers need no RBSP copy. Exp-Golomb codes up to 31 bits are decoded from the cache
+ * with one count-leading-zeros. Reads past the end return zero bits and set Overrun(), so parsers check once after a
+ * syntax structure instead of on every field.
+ */
+class BitReader {
+public:
+    /**
+     * @brief Constructor
+     * @param data NAL unit bytes, without start code
+     * @param size Size in bytes
+     */
+    BitReader(const uint8_t *data, size_t size) : ptr_(data), end_(data + size) {}
+
+    /**
+     * @brief Read up to 32 bits
+     */
+    uint32_t ReadBits(uint32_t count)
+    {
+        if (count == 0) {
+            return 0;
+        }
+        if (bits_ < count) {
+            Refill();
+        }
+        uint32_t value = static_cast<uint32_t>(cache_ >> (64 - count));
+        Consume(count);
+        return value;
+    }
+
+    bool ReadFlag() { return ReadBits(1) != 0; }
+
+    /**
+     * @brief Skip any number of bits
+     */
+    void SkipBits(uint32_t count)
+    {
+        while (count > 32) {
+            ReadBits(32);
+            count -= 32;
+        }
+        ReadBits(count);
+    }
+
+    /**
+     * @brief Read an unsigned Exp-Golomb value, ue(v)
+     */
+    uint32_t ReadUE()
+    {
+        if (bits_ < 32) {
+            Refill();
+        }
+        // Fewer than 16 leading zeros, the whole code is in the cache
+        if (cache_ >= (1ULL << 48)) {
+            uint32_t length = CountLeadingZeros(cache_) * 2 + 1;
+            uint32_t value = static_cast<uint32_t>(cache_ >> (64 - length)) - 1;
+            Consume(length);
+            return value;
+        }
+        return ReadLongUE();
+    }
+
+    /**
+     * @brief Read a signed Exp-Golomb value, se(v)
+     */
+    int32_t ReadSE()
+    {
+        uint32_t value = ReadUE();
+        return (value & 1) ? static_cast<int32_t>(value / 2 + 1) : -static_cast<int32_t>(value / 2);
+    }
+
+    /**
+     * @brief Check whether a read went past the end or hit an invalid Exp-Golomb code
+     */
+    bool Overrun() const { return error_ || consumed_ > data_bits_; }
+
+    /**
+     * @brief Bits read so far, counted in RBSP bits without emulation prevention bytes
+     */
+    uint64_t Position() const { return consumed_; }
+
+    bool ByteAligned() const { return (consumed_ & 7) == 0; }
+
+    /**
+     * @brief Upper bound of the bits left, emulation prevention bytes not yet reached are still counted
+     */
+    uint64_t BitsLeft() const
+    {
+        uint64_t unread = data_bits_ > consumed_ ? data_bits_ - consumed_ : 0;
+        return unread + static_cast<uint64_t>(end_ - ptr_) * 8;
+    }
+
+private:
+    void Refill()
+    {
+        while (bits_ <= 56) {
+            uint64_t byte = 0;
+            if (ptr_ < end_) {
+                byte = *ptr_++;
+                if (zeros_ >= 2 && byte == 0x03) {
+                    zeros_ = 0; // emulation_prevention_three_byte
+                    continue;
+                }
+                zeros_ = (byte == 0) ? zeros_ + 1 : 0;
+                data_bits_ += 8;
+            }
+            cache_ |= byte << (56 - bits_);
+            bits_ += 8;
+        }
+    }
+
+    void Consume(uint32_t count)
+    {
+        cache_ <<= count;
+        bits_ -= count;
+        consumed_ += count;
+    }
+
+    uint32_t ReadLongUE()
+    {
+        uint32_t zeros = 0;
+        while (ReadBits(1) == 0) {
+            if (++zeros > 31 || Overrun()) {
+                error_ = true;
+                return 0;
+            }
+        }
+        uint64_t suffix = zeros > 16 ? (static_cast<uint64_t>(ReadBits(zeros - 16)) << 16) | ReadBits(16)
+                                     : ReadBits(zeros);
+        return static_cast<uint32_t>((1ULL << zeros) - 1 + suffix);
+    }
+
+    static uint32_t CountLeadingZeros(uint64_t value)
+    {
+#if defined(_MSC_VER)
+        unsigned long index = 0;
+        _BitScanReverse64(&index, value);
+        return 63 - static_cast<uint32_t>(index);
+#else
+        return static_cast<uint32_t>(__builtin_clzll(value));
+#endif
+    }
+
+    const uint8_t *ptr_;
+    const uint8_t *end_;
+    uint64_t cache_ = 0;     // Next bits, MSB first, the low bits past bits_ are zero
+    uint32_t bits_ = 0;      // Valid bits in cache_
+    uint32_t zeros_ = 0;     // Zero bytes just before ptr_, for emulation prevention
+    uint64_t consumed_ = 0;  // Bits handed out
+    uint64_t data_bits_ = 0; // Bits loaded from the data, the rest of the cache is zero padding
+    bool error_ = false;
+};
+
+} // namespace lmshao::lmrtsp
+
+#endif // LMSHAO_LMRTSP_BIT_READER_H
@@ -0,0 +1,145 @@
+/**
+ * @author SHAO Liming <lmshao@163.com>
+ * @copyright Copyright (c) 2025 SHAO Liming
+ * @license MIT
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "lmrtsp/frame_classifier.h"
+
+#include "lmrtsp/h264_parser.h"
+#include "lmrtsp/h265_parser.h"
+
+namespace lmshao::lmrtsp {
+
+namespace {
+
+size_t StartCodeLength(const uint8_t *data, size_t size)
+{
+    if (size >= 4 && data[0] == 0x00 && data[1] == 0x00 && data[2] == 0x00 && data[3] == 0x01) {
+        return 4;
+    }
+    if (size >= 3 && data[0] == 0x00 && data[1] == 0x00 && data[2] == 0x01) {
+        return 3;
+    }
+    return 0;
+}
+
+// Position of the next 00 00 01, or end
+const uint8_t *FindStartCode(const uint8_t *p, const uint8_t *end)
+{
+    for (; p + 3 <= end; ++p) {
+        if (p[0] == 0x00 && p[1] == 0x00 && p[2] == 0x01) {
+            return p;
+        }
+    }
+    return end;
+}
+
+void SetFrameType(VideoParam &param, FrameType type)
+{
+    param.frame_type = type;
+    if (type == FrameType::IDR) {
+        param.is_key_frame = true;
+    }
+}
+
+} // namespace
+
+bool FrameClassifier::Classify(const uint8_t *data, size_t size, VideoParam &param)
+{
+    if (!data || size == 0 || (mediaType_ != MediaType::H264 && mediaType_ != MediaType::H265)) {
+        return false;
+    }
+
+    // The NAL unit size passed on runs to the end of the buffer, the slice header is read from its first bytes only
+    const uint8_t *end = data + size;
+    const uint8_t *nalu = data + StartCodeLength(data, size);
+    while (nalu < end) {
+        bool done = false;
+        size_t remaining = static_cast<size_t>(end - nalu);
+        bool classified = (mediaType_ == MediaType::H264) ? ClassifyH264(nalu, remaining, param, done)
+                                                          : ClassifyH265(nalu, remaining, param, done);
+        if (done) {
+            return classified;
+        }
+
+        const uint8_t *next = FindStartCode(nalu, end);
+        if (next == end) {
+            break;
+        }
+        nalu = next + 3;
+    }
+    return false;
+}
+
+bool FrameClassifier::Classify(MediaFrame &frame)
+{
+    if (!frame.data || frame.media_type != mediaType_) {
+        return false;
+    }
+    return Classify(frame.data->Data(), frame.data->Size(), frame.video_param);
+}
+
+bool FrameClassifier::ClassifyH264(const uint8_t *nalu, size_t size, VideoParam &param, bool &done)
+{
+    uint8_t nalu_type = nalu[0] & 0x1F;
+    if (nalu_type < 1 || nalu_type > 5) {
+        return false;
+    }
+
+    // All slices of an IDR picture are IDR slices, the first slice stands for the others
+    done = true;
+    H264SliceHeader header = H264Parser::ParseSliceHeader(nalu, size);
+    if (!header.valid) {
+        return false;
+    }
+
+    static const FrameType SLICE_TYPES[] = {FrameType::P, FrameType::B, FrameType::I, FrameType::P, FrameType::I};
+    SetFrameType(param, (nalu_type == 5) ? FrameType::IDR : SLICE_TYPES[header.slice_type]);
+    param.is_reference = header.nal_ref_idc != 0;
+    param.temporal_id = 0;
+    return true;
+}
+
+bool FrameClassifier::ClassifyH265(const uint8_t *nalu, size_t size, VideoParam &param, bool &done)
+{
+    if (size < 2) {
+        return false;
+    }
+
+    uint8_t nalu_type = (nalu[0] >> 1) & 0x3F;
+    if (nalu_type == 34) {
+        int32_t bits = H265Parser::GetNumExtraSliceHeaderBits(nalu, size);
+        if (bits >= 0) {
+            extraSliceHeaderBits_ = static_cast<uint32_t>(bits);
+        }
+        return false;
+    }
+    if (nalu_type > 21 || (nalu_type > 9 && nalu_type < 16)) {
+        return false;
+    }
+
+    done = true;
+    H265SliceHeader header = H265Parser::ParseSliceHeader(nalu, size, extraSliceHeaderBits_);
+    if (!header.valid) {
+        return false;
+    }
+
+    // Without its first slice segment, e.g. after loss, only the NAL header is known
+    static const FrameType SLICE_TYPES[] = {FrameType::B, FrameType::P, FrameType::I};
+    if (nalu_type >= 16) {
+        SetFrameType(param, FrameType::IDR);
+    } else if (header.slice_type >= 0) {
+        SetFrameType(param, SLICE_TYPES[header.slice_type]);
+    } else {
+        param.frame_type = FrameType::UNKNOWN;
+    }
+    // TRAIL_N, TSA_N, STSA_N, RADL_N and RASL_N are not referenced within their temporal sub-layer
+    param.is_reference = !(nalu_type <= 14 && nalu_type % 2 == 0);
+    param.temporal_id = header.temporal_id;
+    return param.frame_type != FrameType::UNKNOWN;
+}
+
+} // namespace lmshao::lmrtsp
@@ -8,92 +8,109 @@
 
 #include "lmrtsp/h264_parser.h"
 
-#include <cmath>
 #include <cstring>
 #include <vector>
 
+#include "bit_reader.h"
+
 namespace lmshao::lmrtsp {
 
 namespace {
 // Internal helper functions using raw pointers for actual parsing logic
 
-uint32_t ReadUE(const uint8_t *buf, uint32_t len, uint32_t &pos)
+size_t StartCodeLength(const uint8_t *data, size_t size)
 {
-    // Count leading zeros
-    uint32_t zero_count = 0;
-    while (pos < len * 8) {
-        if (buf[pos / 8] & (0x80 >> (pos % 8))) {
-            break;
-        }
-        zero_count++;
-        pos++;
+    if (size >= 4 && data[0] == 0x00 && data[1] == 0x00 && data[2] == 0x00 && data[3] == 0x01) {
+        return 4;
     }
-    pos++; // Skip the '1' bit
-
-    // Read the remaining bits
-    uint64_t value = 0;
-    for (uint32_t i = 0; i < zero_count; i++) {
-        value <<= 1;
-        if (buf[pos / 8] & (0x80 >> (pos % 8))) {
-            value += 1;
-        }
-        pos++;
+    if (size >= 3 && data[0] == 0x00 && data[1] == 0x00 && data[2] == 0x01) {
+        return 3;
     }
-
-    return static_cast<uint32_t>((1ULL << zero_count) - 1 + value);
+    return 0;
 }
 
-int32_t ReadSE(const uint8_t *buf, uint32_t len, uint32_t &pos)
+void SkipScalingList(BitReader &reader, int32_t size_of_scaling_list)
 {
-    uint32_t ue_val = ReadUE(buf, len, pos);
-    double k = ue_val;
-    int32_t value = static_cast<int32_t>(std::ceil(k / 2.0));
-    if (ue_val % 2 == 0) {
-        value = -value;
+    int32_t last_scale = 8;
+    int32_t next_scale = 8;
+
+    for (int32_t j = 0; j < size_of_scaling_list; j++) {
+        if (next_scale != 0) {
+            int32_t delta_scale = reader.ReadSE();
+            next_scale = (last_scale + delta_scale) & 0xff;
+        }
+        last_scale = (next_scale == 0) ? last_scale : next_scale;
     }
-    return value;
 }
 
-uint32_t ReadBits(uint32_t bit_count, const uint8_t *buf, uint32_t &pos)
+void ParseHrdParameters(BitReader &reader, H264VideoInfo &info)
 {
-    uint32_t value = 0;
-    for (uint32_t i = 0; i < bit_count; i++) {
-        value <<= 1;
-        if (buf[pos / 8] & (0x80 >> (pos % 8))) {
-            value += 1;
-        }
-        pos++;
+    uint32_t cpb_cnt_minus1 = reader.ReadUE();
+    reader.ReadBits(4); // bit_rate_scale
+    reader.ReadBits(4); // cpb_size_scale
+    for (uint32_t i = 0; i <= cpb_cnt_minus1 && i < 32; i++) {
+        reader.ReadUE();    // bit_rate_value_minus1
+        reader.ReadUE();    // cpb_size_value_minus1
+        reader.ReadBits(1); // cbr_flag
     }
-    return value;
+    reader.ReadBits(5); // initial_cpb_removal_delay_length_minus1
+    info.cpb_removal_delay_length = static_cast<uint8_t>(reader.ReadBits(5) + 1);
+    info.dpb_output_delay_length = static_cast<uint8_t>(reader.ReadBits(5) + 1);
+    reader.ReadBits(5); // time_offset_length
 }
 
-void RemoveEmulationPrevention(uint8_t *buf, uint32_t &size)
+void ParseVUI(BitReader &reader, H264VideoInfo &info)
 {
-    uint32_t tmp_size = size;
-    for (uint32_t i = 0; i < (tmp_size - 2); i++) {
-        // Check for 0x000003 pattern
-        if (buf[i] == 0x00 && buf[i + 1] == 0x00 && buf[i + 2] == 0x03) {
-            // Remove the 0x03 byte
-            for (uint32_t j = i + 2; j < tmp_size - 1; j++) {
-                buf[j] = buf[j + 1];
-            }
-            size--;
-            tmp_size = size;
+    if (reader.ReadFlag()) { // aspect_ratio_info_present_flag
+        uint32_t aspect_ratio_idc = reader.ReadBits(8);
+        if (aspect_ratio_idc == 255) { // Extended_SAR
+            reader.ReadBits(16);       // sar_width
+            reader.ReadBits(16);       // sar_height
         }
     }
-}
 
-void SkipScalingList(const uint8_t *buf, uint32_t len, uint32_t &pos, int32_t size_of_scaling_list)
-{
-    int32_t last_scale = 8;
-    int32_t next_scale = 8;
+    if (reader.ReadFlag()) { // overscan_info_present_flag
+        reader.ReadBits(1);  // overscan_appropriate_flag
+    }
 
-    for (int32_t j = 0; j < size_of_scaling_list; j++) {
-        if (next_scale != 0) {
-            int32_t delta_scale = ReadSE(buf, len, pos);
-            next_scale = (last_scale + delta_scale) & 0xff;
+    if (reader.ReadFlag()) {     // video_signal_type_present_flag
+        reader.ReadBits(3);      // video_format
+        reader.ReadBits(1);      // video_full_range_flag
+        if (reader.ReadFlag()) { // colour_description_present_flag
+            reader.ReadBits(24); // colour_primaries, transfer_characteristics, matrix_coefficients
         }
-        last_scale = (next_scale == 0) ? last_scale : next_scale;
+    }
+
+    if (reader.ReadFlag()) { // chroma_loc_info_present_flag
+        reader.ReadUE();     // chroma_sample_loc_type_top_field
+        reader.ReadUE();     // chroma_sample_loc_type_bottom_field
+    }
+
+    if (reader.ReadFlag()) { // timing_info_present_flag
+        info.num_units_in_tick = reader.ReadBits(32);
+        info.time_scale = reader.ReadBits(32);
+        info.fixed_frame_rate_flag = reader.ReadFlag();
+        info.timing_info_present = !reader.Overrun() && info.num_units_in_tick > 0 && info.time_scale > 0;
+    }
+
+    bool nal_hrd_parameters_present_flag = reader.ReadFlag();
+    if (nal_hrd_parameters_present_flag) {
+        ParseHrdParameters(reader, info);
+    }
+    bool vcl_hrd_parameters_present_flag = reader.ReadFlag();
+    if (vcl_hrd_parameters_present_flag) {
+        ParseHrdParameters(reader, info);
+    }
+    if (nal_hrd_parameters_present_flag || vcl_hrd_parameters_present_flag) {
+        info.cpb_dpb_delays_present = true;
+        reader.ReadBits(1); // low_delay_hrd_flag
+    }
+    info.pic_struct_present_flag = reader.ReadFlag();
+
+    // Truncated VUI, the picture timing SEI layout is unknown
+    if (reader.Overrun()) {
+        info.cpb_dpb_delays_present = false;
+        info.pic_struct_present_flag = false;
     }
 }
 
@@ -105,20 +122,13 @@ H264VideoInfo ParseSPSInternal(const uint8_t *sps, size_t size)
         return info;
     }
 
-    // Make a copy to remove emulation prevention bytes
-    std::vector<uint8_t> sps_copy(sps, sps + size);
-    uint32_t sps_size = static_cast<uint32_t>(size);
-
-    RemoveEmulationPrevention(sps_copy.data(), sps_size);
-
-    const uint8_t *buf = sps_copy.data();
-    uint32_t len = sps_size;
-    uint32_t pos = 0;
+    // Reads the escaped SPS in place, no RBSP copy
+    BitReader reader(sps, size);
 
     // Parse NAL unit header
-    ReadBits(1, buf, pos);                          // forbidden_zero_bit
-    ReadBits(2, buf, pos);                          // nal_ref_idc
-    uint32_t nal_unit_type = ReadBits(5, buf, pos); // nal_unit_type
+    reader.ReadBits(1);                          // forbidden_zero_bit
+    reader.ReadBits(2);                          // nal_ref_idc
+    uint32_t nal_unit_type = reader.ReadBits(5); // nal_unit_type
 
     // Check if this is SPS (type 7)
     if (nal_unit_type != 7) {
@@ -126,10 +136,10 @@ H264VideoInfo ParseSPSInternal(const uint8_t *sps, size_t size)
     }
 
     // Parse SPS
-    info.profile_idc = ReadBits(8, buf, pos);
-    ReadBits(8, buf, pos); // constraint flags and reserved bits
-    info.level_idc = ReadBits(8, buf, pos);
-    ReadUE(buf, len, pos); // seq_parameter_set_id
+    info.profile_idc = reader.ReadBits(8);
+    reader.ReadBits(8); // constraint flags and reserved bits
+    info.level_idc = reader.ReadBits(8);
+    reader.ReadUE(); // seq_parameter_set_id
 
     // High profile check
     if (info.profile_idc == 100 || info.profile_idc == 110 || info.profile_idc == 122 || info.profile_idc == 244 ||
@@ -137,29 +147,29 @@ H264VideoInfo ParseSPSInternal(const uint8_t *sps, size_t size)
         info.profile_idc == 128 || info.profile_idc == 138 || info.profile_idc == 139 || info.profile_idc == 134 ||
         info.profile_idc == 135) {
 
-        info.chroma_format_idc = ReadUE(buf, len, pos);
+        info.chroma_format_idc = reader.ReadUE();
 
         if (info.chroma_format_idc == 3) {
-            ReadBits(1, buf, pos); // separate_colour_plane_flag
+            reader.ReadBits(1); // separate_colour_plane_flag
         }
 
-        int32_t bit_depth_luma_minus8 = ReadUE(buf, len, pos);
+        int32_t bit_depth_luma_minus8 = reader.ReadUE();
         info.bit_depth_luma = 8 + bit_depth_luma_minus8;
 
-        int32_t bit_depth_chroma_minus8 = ReadUE(buf, len, pos);
+        int32_t bit_depth_chroma_minus8 = reader.ReadUE();
         info.bit_depth_chroma = 8 + bit_depth_chroma_minus8;
 
-        ReadBits(1, buf, pos); // qpprime_y_zero_transform_bypass_flag
+        reader.ReadBits(1); // qpprime_y_zero_transform_bypass_flag
 
-        uint32_t seq_scaling_matrix_present_flag = ReadBits(1, buf, pos);
+        uint32_t seq_scaling_matrix_present_flag = reader.ReadBits(1);
 
         if (seq_scaling_matrix_present_flag) {
             int32_t scaling_list_count = (info.chroma_format_idc != 3) ? 8 : 12;
             for (int32_t i = 0; i < scaling_list_count; i++) {
-                uint32_t seq_scaling_list_present_flag = ReadBits(1, buf, pos);
+                uint32_t seq_scaling_list_present_flag = reader.ReadBits(1);
                 if (seq_scaling_list_present_flag) {
                     int32_t size_of_scaling_list = (i < 6) ? 16 : 64;
-                    SkipScalingList(buf, len, pos, size_of_scaling_list);
+                    SkipScalingList(reader, size_of_scaling_list);
                 }
             }
         }
@@ -167,49 +177,49 @@ H264VideoInfo ParseSPSInternal(const uint8_t *sps, size_t size)
         info.chroma_format_idc = 1; // Default 4:2:0
     }
 
-    ReadUE(buf, len, pos); // log2_max_frame_num_minus4
+    reader.ReadUE(); // log2_max_frame_num_minus4
 
-    uint32_t pic_order_cnt_type = ReadUE(buf, len, pos);
+    uint32_t pic_order_cnt_type = reader.ReadUE();
 
     if (pic_order_cnt_type == 0) {
-        ReadUE(buf, len, pos); // log2_max_pic_order_cnt_lsb_minus4
+        reader.ReadUE(); // log2_max_pic_order_cnt_lsb_minus4
     } else if (pic_order_cnt_type == 1) {
-        ReadBits(1, buf, pos); // delta_pic_order_always_zero_flag
-        ReadSE(buf, len, pos); // offset_for_non_ref_pic
-        ReadSE(buf, len, pos); // offset_for_top_to_bottom_field
-        uint32_t num_ref_frames = ReadUE(buf, len, pos);
+        reader.ReadBits(1); // delta_pic_order_always_zero_flag
+        reader.ReadSE();    // offset_for_non_ref_pic
+        reader.ReadSE();    // offset_for_top_to_bottom_field
+        uint32_t num_ref_frames = reader.ReadUE();
 
         // Skip offset_for_ref_frame
-        for (uint32_t i = 0; i < num_ref_frames; i++) {
-            ReadSE(buf, len, pos);
+        for (uint32_t i = 0; i < num_ref_frames && !reader.Overrun(); i++) {
+            reader.ReadSE();
         }
     }
 
-    ReadUE(buf, len, pos); // max_num_ref_frames
-    ReadBits(1, buf, pos); // gaps_in_frame_num_value_allowed_flag
+    reader.ReadUE();    // max_num_ref_frames
+    reader.ReadBits(1); // gaps_in_frame_num_value_allowed_flag
 
-    uint32_t pic_width_in_mbs_minus1 = ReadUE(buf, len, pos);
-    uint32_t pic_height_in_map_units_minus1 = ReadUE(buf, len, pos);
+    uint32_t pic_width_in_mbs_minus1 = reader.ReadUE();
+    uint32_t pic_height_in_map_units_minus1 = reader.ReadUE();
 
     info.width = (pic_width_in_mbs_minus1 + 1) * 16;
     info.height = (pic_height_in_map_units_minus1 + 1) * 16;
 
-    uint32_t frame_mbs_only_flag = ReadBits(1, buf, pos);
+    uint32_t frame_mbs_only_flag = reader.ReadBits(1);
     info.frame_mbs_only_flag = (frame_mbs_only_flag != 0);
 
     if (!frame_mbs_only_flag) {
-        ReadBits(1, buf, pos); // mb_adaptive_frame_field_flag
+        reader.ReadBits(1); // mb_adaptive_frame_field_flag
     }
 
-    ReadBits(1, buf, pos); // direct_8x8_inference_flag
+    reader.ReadBits(1); // direct_8x8_inference_flag
 
-    uint32_t frame_cropping_flag = ReadBits(1, buf, pos);
+    uint32_t frame_cropping_flag = reader.ReadBits(1);
 
     if (frame_cropping_flag) {
-        uint32_t frame_crop_left_offset = ReadUE(buf, len, pos);
-        uint32_t frame_crop_right_offset = ReadUE(buf, len, pos);
-        uint32_t frame_crop_top_offset = ReadUE(buf, len, pos);
-        uint32_t frame_crop_bottom_offset = ReadUE(buf, len, pos);
+        uint32_t frame_crop_left_offset = reader.ReadUE();
+        uint32_t frame_crop_right_offset = reader.ReadUE();
+        uint32_t frame_crop_top_offset = reader.ReadUE();
+        uint32_t frame_crop_bottom_offset = reader.ReadUE();
 
         int32_t crop_unit_x = 2;
         int32_t crop_unit_y = 2 * (2 - frame_mbs_only_flag);
@@ -218,10 +228,91 @@ H264VideoInfo ParseSPSInternal(const uint8_t *sps, size_t size)
         info.height -= crop_unit_y * (frame_crop_top_offset + frame_crop_bottom_offset);
     }
 
+    uint32_t vui_parameters_present_flag = reader.ReadBits(1);
+    if (vui_parameters_present_flag) {
+        ParseVUI(reader, info);
+    }
+
     info.valid = true;
     return info;
 }
 
+int32_t GetPictureTicksInternal(const uint8_t *sei, size_t sei_size, const H264VideoInfo &info)
+{
+    if (!sei || sei_size < 3 || (sei[0] & 0x1F) != 6) {
+        return 0;
+    }
+
+    BitReader reader(sei, sei_size);
+    reader.ReadBits(8); // NAL header
+
+    // sei_message() list, up to rbsp_trailing_bits
+    while (reader.BitsLeft() >= 16 && !reader.Overrun()) {
+        uint32_t payload_type = 0;
+        uint32_t byte = 0;
+        while ((byte = reader.ReadBits(8)) == 0xFF && !reader.Overrun()) {
+            payload_type += 255;
+        }
+        if (payload_type == 0 && byte == 0x80) {
+            return 0; // rbsp_stop_one_bit
+        }
+        payload_type += byte;
+
+        uint32_t payload_size = 0;
+        while ((byte = reader.ReadBits(8)) == 0xFF && !reader.Overrun()) {
+            payload_size += 255;
+        }
+        payload_size += byte;
+        if (reader.Overrun() || static_cast<uint64_t>(payload_size) * 8 > reader.BitsLeft()) {
+            return 0;
+        }
+
+        if (payload_type == 1) { // pic_timing
+            uint32_t delay_bits = 0;
+            if (info.cpb_dpb_delays_present) {
+                delay_bits = info.cpb_removal_delay_length + info.dpb_output_delay_length;
+            }
+            if (delay_bits + 4 > payload_size * 8) {
+                return 0;
+            }
+            reader.SkipBits(delay_bits);
+            // Clock ticks per pic_struct value, Table D-1
+            static const int32_t PIC_STRUCT_TICKS[] = {2, 1, 1, 2, 2, 3, 3, 4, 6};
+            uint32_t pic_struct = reader.ReadBits(4);
+            return pic_struct < 9 ? PIC_STRUCT_TICKS[pic_struct] : 0;
+        }
+        reader.SkipBits(payload_size * 8);
+    }
+    return 0;
+}
+
+H264SliceHeader ParseSliceHeaderInternal(const uint8_t *nalu, size_t size)
+{
+    H264SliceHeader header;
+    if (!nalu || size < 2) {
+        return header;
+    }
+
+    header.nal_ref_idc = (nalu[0] >> 5) & 0x03;
+    header.nal_unit_type = nalu[0] & 0x1F;
+    if (header.nal_unit_type < 1 || header.nal_unit_type > 5) {
+        return header;
+    }
+
+    BitReader reader(nalu + 1, size - 1);
+    header.first_mb_in_slice = reader.ReadUE();
+    uint32_t slice_type = reader.ReadUE();
+    header.pic_parameter_set_id = reader.ReadUE();
+    if (reader.Overrun() || slice_type > 9 || header.pic_parameter_set_id > 255) {
+        return header;
+    }
+
+    // Values 5-9 also promise every slice of the picture has this type
+    header.slice_type = static_cast<uint8_t>(slice_type % 5);
+    header.valid = true;
+    return header;
+}
+
 } // anonymous namespace
 
 H264VideoInfo H264Parser::ParseSPS(const std::shared_ptr<lmcore::DataBuffer> &sps)
@@ -232,6 +323,21 @@ H264VideoInfo H264Parser::ParseSPS(const std::shared_ptr<lmcore::DataBuffer> &sp
     return ParseSPSInternal(sps->Data(), sps->Size());
 }
 
+int32_t H264Parser::GetPictureTicks(const std::shared_ptr<lmcore::DataBuffer> &sei, const H264VideoInfo &info)
+{
+    if (!info.pic_struct_present_flag || !sei) {
+        return 0;
+    }
+    size_t offset = StartCodeLength(sei->Data(), sei->Size());
+    return GetPictureTicksInternal(sei->Data() + offset, sei->Size() - offset, info);
+}
+
+H264SliceHeader H264Parser::ParseSliceHeader(const uint8_t *nalu, size_t size)
+{
+    size_t offset = nalu ? StartCodeLength(nalu, size) : 0;
+    return ParseSliceHeaderInternal(nalu ? nalu + offset : nullptr, size - offset);
+}
+
 bool H264Parser::GetResolution(const std::shared_ptr<lmcore::DataBuffer> &sps, int32_t &width, int32_t &height)
 {
     if (!sps || sps->Empty()) {
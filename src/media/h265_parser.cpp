@@ -8,75 +8,174 @@
 
 #include "lmrtsp/h265_parser.h"
 
-#include <cmath>
+#include <algorithm>
 #include <cstring>
 #include <vector>
 
+#include "bit_reader.h"
+
 namespace lmshao::lmrtsp {
 
 namespace {
 // Internal helper functions
 
-uint32_t ReadUE(const uint8_t *buf, uint32_t len, uint32_t &pos)
+size_t StartCodeLength(const uint8_t *data, size_t size)
 {
-    uint32_t zero_count = 0;
-    while (pos < len * 8) {
-        if (buf[pos / 8] & (0x80 >> (pos % 8))) {
-            break;
-        }
-        zero_count++;
-        pos++;
+    if (size >= 4 && data[0] == 0x00 && data[1] == 0x00 && data[2] == 0x00 && data[3] == 0x01) {
+        return 4;
     }
-    pos++;
-
-    uint64_t value = 0;
-    for (uint32_t i = 0; i < zero_count; i++) {
-        value <<= 1;
-        if (buf[pos / 8] & (0x80 >> (pos % 8))) {
-            value += 1;
-        }
-        pos++;
+    if (size >= 3 && data[0] == 0x00 && data[1] == 0x00 && data[2] == 0x01) {
+        return 3;
     }
-
-    return static_cast<uint32_t>((1ULL << zero_count) - 1 + value);
+    return 0;
 }
 
-int32_t ReadSE(const uint8_t *buf, uint32_t len, uint32_t &pos)
+void SkipScalingListData(BitReader &reader)
 {
-    uint32_t ue_val = ReadUE(buf, len, pos);
-    double k = ue_val;
-    int32_t value = static_cast<int32_t>(std::ceil(k / 2.0));
-    if (ue_val % 2 == 0) {
-        value = -value;
+    for (uint32_t size_id = 0; size_id < 4; size_id++) {
+        for (uint32_t matrix_id = 0; matrix_id < 6; matrix_id += (size_id == 3) ? 3 : 1) {
+            if (!reader.ReadFlag()) { // scaling_list_pred_mode_flag
+                reader.ReadUE();      // scaling_list_pred_matrix_id_delta
+                continue;
+            }
+            uint32_t coef_num = std::min<uint32_t>(64, 1u << (4 + (size_id << 1)));
+            if (size_id > 1) {
+                reader.ReadSE(); // scaling_list_dc_coef_minus8
+            }
+            for (uint32_t i = 0; i < coef_num; i++) {
+                reader.ReadSE(); // scaling_list_delta_coef
+            }
+        }
     }
-    return value;
 }
 
-uint32_t ReadBits(uint32_t bit_count, const uint8_t *buf, uint32_t &pos)
+// st_ref_pic_set() for every set in the SPS. Sets predicted from the previous one have a size that depends on its
+// delta POCs, so those are derived as in (7-61) and (7-62)
+bool SkipShortTermRefPicSets(BitReader &reader, uint32_t count)
 {
-    uint32_t value = 0;
-    for (uint32_t i = 0; i < bit_count; i++) {
-        value <<= 1;
-        if (buf[pos / 8] & (0x80 >> (pos % 8))) {
-            value += 1;
+    std::vector<std::vector<int32_t>> negative(count); // DeltaPocS0
+    std::vector<std::vector<int32_t>> positive(count); // DeltaPocS1
+
+    for (uint32_t idx = 0; idx < count; idx++) {
+        bool inter_ref_pic_set_prediction_flag = idx != 0 && reader.ReadFlag();
+        if (inter_ref_pic_set_prediction_flag) {
+            // delta_idx_minus1 is only coded in slice headers, in the SPS the reference is the previous set
+            const auto &ref_negative = negative[idx - 1];
+            const auto &ref_positive = positive[idx - 1];
+            uint32_t delta_rps_sign = reader.ReadBits(1);
+            int32_t abs_delta_rps = static_cast<int32_t>(reader.ReadUE()) + 1;
+            int32_t delta_rps = delta_rps_sign ? -abs_delta_rps : abs_delta_rps;
+
+            size_t ref_count = ref_negative.size() + ref_positive.size();
+            std::vector<bool> use_delta(ref_count + 1);
+            for (size_t j = 0; j <= ref_count; j++) {
+                bool used_by_curr_pic_flag = reader.ReadFlag();
+                use_delta[j] = used_by_curr_pic_flag || reader.ReadFlag(); // use_delta_flag
+            }
+
+            auto &s0 = negative[idx];
+            auto &s1 = positive[idx];
+            for (size_t j = ref_positive.size(); j-- > 0;) {
+                int32_t d_poc = ref_positive[j] + delta_rps;
+                if (d_poc < 0 && use_delta[ref_negative.size() + j]) {
+                    s0.push_back(d_poc);
+                }
+            }
+            if (delta_rps < 0 && use_delta[ref_count]) {
+                s0.push_back(delta_rps);
+            }
+            for (size_t j = 0; j < ref_negative.size(); j++) {
+                int32_t d_poc = ref_negative[j] + delta_rps;
+                if (d_poc < 0 && use_delta[j]) {
+                    s0.push_back(d_poc);
+                }
+            }
+
+            for (size_t j = ref_negative.size(); j-- > 0;) {
+                int32_t d_poc = ref_negative[j] + delta_rps;
+                if (d_poc > 0 && use_delta[j]) {
+                    s1.push_back(d_poc);
+                }
+            }
+            if (delta_rps > 0 && use_delta[ref_count]) {
+                s1.push_back(delta_rps);
+            }
+            for (size_t j = 0; j < ref_positive.size(); j++) {
+                int32_t d_poc = ref_positive[j] + delta_rps;
+                if (d_poc > 0 && use_delta[ref_negative.size() + j]) {
+                    s1.push_back(d_poc);
+                }
+            }
+        } else {
+            uint32_t num_negative_pics = reader.ReadUE();
+            uint32_t num_positive_pics = reader.ReadUE();
+            if (num_negative_pics > 16 || num_positive_pics > 16) {
+                return false;
+            }
+            int32_t poc = 0;
+            for (uint32_t i = 0; i < num_negative_pics; i++) {
+                poc -= static_cast<int32_t>(reader.ReadUE()) + 1; // delta_poc_s0_minus1
+                reader.ReadBits(1);                                  // used_by_curr_pic_s0_flag
+                negative[idx].push_back(poc);
+            }
+            poc = 0;
+            for (uint32_t i = 0; i < num_positive_pics; i++) {
+                poc += static_cast<int32_t>(reader.ReadUE()) + 1; // delta_poc_s1_minus1
+                reader.ReadBits(1);                                  // used_by_curr_pic_s1_flag
+                positive[idx].push_back(poc);
+            }
+        }
+
+        if (reader.Overrun()) {
+            return false;
         }
-        pos++;
     }
-    return value;
+    return true;
 }
 
-void RemoveEmulationPrevention(uint8_t *buf, uint32_t &size)
+void ParseVUI(BitReader &reader, H265VideoInfo &info)
 {
-    uint32_t tmp_size = size;
-    for (uint32_t i = 0; i < (tmp_size - 2); i++) {
-        if (buf[i] == 0x00 && buf[i + 1] == 0x00 && buf[i + 2] == 0x03) {
-            for (uint32_t j = i + 2; j < tmp_size - 1; j++) {
-                buf[j] = buf[j + 1];
-            }
-            size--;
-            tmp_size = size;
+    if (reader.ReadBits(1)) { // aspect_ratio_info_present_flag
+        uint32_t aspect_ratio_idc = reader.ReadBits(8);
+        if (aspect_ratio_idc == 255) { // EXTENDED_SAR
+            reader.ReadBits(16);    // sar_width
+            reader.ReadBits(16);    // sar_height
+        }
+    }
+
+    if (reader.ReadBits(1)) { // overscan_info_present_flag
+        reader.ReadBits(1);   // overscan_appropriate_flag
+    }
+
+    if (reader.ReadBits(1)) {     // video_signal_type_present_flag
+        reader.ReadBits(3);       // video_format
+        reader.ReadBits(1);       // video_full_range_flag
+        if (reader.ReadBits(1)) { // colour_description_present_flag
+            reader.ReadBits(24);  // colour_primaries, transfer_characteristics, matrix_coeffs
         }
     }
+
+    if (reader.ReadBits(1)) { // chroma_loc_info_present_flag
+        reader.ReadUE();   // chroma_sample_loc_type_top_field
+        reader.ReadUE();   // chroma_sample_loc_type_bottom_field
+    }
+
+    reader.ReadBits(1); // neutral_chroma_indication_flag
+    reader.ReadBits(1); // field_seq_flag
+    reader.ReadBits(1); // frame_field_info_present_flag
+
+    if (reader.ReadBits(1)) { // default_display_window_flag
+        reader.ReadUE();   // def_disp_win_left_offset
+        reader.ReadUE();   // def_disp_win_right_offset
+        reader.ReadUE();   // def_disp_win_top_offset
+        reader.ReadUE();   // def_disp_win_bottom_offset
+    }
+
+    if (reader.ReadBits(1)) { // vui_timing_info_present_flag
+        info.num_units_in_tick = reader.ReadBits(32);
+        info.time_scale = reader.ReadBits(32);
+        info.timing_info_present = !reader.Overrun() && info.num_units_in_tick > 0 && info.time_scale > 0;
+    }
 }
 
 H265VideoInfo ParseSPSInternal(const uint8_t *sps, size_t size)
@@ -87,99 +186,91 @@ H265VideoInfo ParseSPSInternal(const uint8_t *sps, size_t size)
         return info;
     }
 
-    std::vector<uint8_t> rbsp(sps, sps + size);
-    uint32_t rbsp_size = size;
-    RemoveEmulationPrevention(rbsp.data(), rbsp_size);
-
-    uint32_t pos = 0;
-    const uint8_t *buf = rbsp.data();
+    // Reads the escaped SPS in place, no RBSP copy
+    BitReader reader(sps, size);
 
     // Skip NAL header (2 bytes)
-    pos += 16;
+    reader.ReadBits(16);
 
     // sps_video_parameter_set_id (4 bits)
-    ReadBits(4, buf, pos);
+    reader.ReadBits(4);
 
     // sps_max_sub_layers_minus1 (3 bits)
-    uint32_t sps_max_sub_layers_minus1 = ReadBits(3, buf, pos);
+    uint32_t sps_max_sub_layers_minus1 = reader.ReadBits(3);
 
     // sps_temporal_id_nesting_flag (1 bit)
-    ReadBits(1, buf, pos);
+    reader.ReadBits(1);
 
     // Parse profile_tier_level
     // general_profile_space (2 bits)
-    ReadBits(2, buf, pos);
+    reader.ReadBits(2);
     // general_tier_flag (1 bit)
-    ReadBits(1, buf, pos);
+    reader.ReadBits(1);
     // general_profile_idc (5 bits)
-    info.profile_idc = ReadBits(5, buf, pos);
+    info.profile_idc = reader.ReadBits(5);
 
     // general_profile_compatibility_flag[32]
-    for (int i = 0; i < 32; i++) {
-        ReadBits(1, buf, pos);
-    }
+    reader.SkipBits(32);
 
     // general_progressive_source_flag, general_interlaced_source_flag,
     // general_non_packed_constraint_flag, general_frame_only_constraint_flag
-    ReadBits(4, buf, pos);
+    reader.ReadBits(4);
 
     // Skip 43 or 44 bits of constraint flags
-    ReadBits(43, buf, pos);
-    ReadBits(1, buf, pos);
+    reader.SkipBits(43);
+    reader.ReadBits(1);
 
     // general_level_idc (8 bits)
-    info.level_idc = ReadBits(8, buf, pos);
+    info.level_idc = reader.ReadBits(8);
 
     // Skip sub_layer info
     std::vector<uint8_t> sub_layer_profile_present_flag(sps_max_sub_layers_minus1);
     std::vector<uint8_t> sub_layer_level_present_flag(sps_max_sub_layers_minus1);
 
     for (uint32_t i = 0; i < sps_max_sub_layers_minus1; i++) {
-        sub_layer_profile_present_flag[i] = ReadBits(1, buf, pos);
-        sub_layer_level_present_flag[i] = ReadBits(1, buf, pos);
+        sub_layer_profile_present_flag[i] = reader.ReadBits(1);
+        sub_layer_level_present_flag[i] = reader.ReadBits(1);
     }
 
     if (sps_max_sub_layers_minus1 > 0) {
         for (uint32_t i = sps_max_sub_layers_minus1; i < 8; i++) {
-            ReadBits(2, buf, pos); // reserved_zero_2bits
+            reader.ReadBits(2); // reserved_zero_2bits
         }
     }
 
     for (uint32_t i = 0; i < sps_max_sub_layers_minus1; i++) {
         if (sub_layer_profile_present_flag[i]) {
-            ReadBits(2, buf, pos); // sub_layer_profile_space
-            ReadBits(1, buf, pos); // sub_layer_tier_flag
-            ReadBits(5, buf, pos); // sub_layer_profile_idc
-            for (int j = 0; j < 32; j++) {
-                ReadBits(1, buf, pos);
-            }
-            ReadBits(4, buf, pos);
-            ReadBits(43, buf, pos);
-            ReadBits(1, buf, pos);
+            reader.ReadBits(2); // sub_layer_profile_space
+            reader.ReadBits(1); // sub_layer_tier_flag
+            reader.ReadBits(5); // sub_layer_profile_idc
+            reader.SkipBits(32); // sub_layer_profile_compatibility_flag[32]
+            reader.ReadBits(4);
+            reader.SkipBits(43);
+            reader.ReadBits(1);
         }
         if (sub_layer_level_present_flag[i]) {
-            ReadBits(8, buf, pos); // sub_layer_level_idc
+            reader.ReadBits(8); // sub_layer_level_idc
         }
     }
 
     // sps_seq_parameter_set_id
-    ReadUE(buf, rbsp_size, pos);
+    reader.ReadUE();
 
     // chroma_format_idc
-    info.chroma_format_idc = ReadUE(buf, rbsp_size, pos);
+    info.chroma_format_idc = reader.ReadUE();
 
     if (info.chroma_format_idc == 3) {
-        ReadBits(1, buf, pos); // separate_colour_plane_flag
+        reader.ReadBits(1); // separate_colour_plane_flag
     }
 
     // pic_width_in_luma_samples
-    uint32_t pic_width_in_luma_samples = ReadUE(buf, rbsp_size, pos);
+    uint32_t pic_width_in_luma_samples = reader.ReadUE();
 
     // pic_height_in_luma_samples
-    uint32_t pic_height_in_luma_samples = ReadUE(buf, rbsp_size, pos);
+    uint32_t pic_height_in_luma_samples = reader.ReadUE();
 
     // conformance_window_flag
-    uint32_t conformance_window_flag = ReadBits(1, buf, pos);
+    uint32_t conformance_window_flag = reader.ReadBits(1);
 
     uint32_t conf_win_left_offset = 0;
     uint32_t conf_win_right_offset = 0;
@@ -187,17 +278,17 @@ H265VideoInfo ParseSPSInternal(const uint8_t *sps, size_t size)
     uint32_t conf_win_bottom_offset = 0;
 
     if (conformance_window_flag) {
-        conf_win_left_offset = ReadUE(buf, rbsp_size, pos);
-        conf_win_right_offset = ReadUE(buf, rbsp_size, pos);
-        conf_win_top_offset = ReadUE(buf, rbsp_size, pos);
-        conf_win_bottom_offset = ReadUE(buf, rbsp_size, pos);
+        conf_win_left_offset = reader.ReadUE();
+        conf_win_right_offset = reader.ReadUE();
+        conf_win_top_offset = reader.ReadUE();
+        conf_win_bottom_offset = reader.ReadUE();
     }
 
     // bit_depth_luma_minus8
-    info.bit_depth_luma = 8 + ReadUE(buf, rbsp_size, pos);
+    info.bit_depth_luma = 8 + reader.ReadUE();
 
     // bit_depth_chroma_minus8
-    info.bit_depth_chroma = 8 + ReadUE(buf, rbsp_size, pos);
+    info.bit_depth_chroma = 8 + reader.ReadUE();
 
     // Calculate actual resolution
     uint32_t sub_width_c = (info.chroma_format_idc == 1 || info.chroma_format_idc == 2) ? 2 : 1;
@@ -205,11 +296,123 @@ H265VideoInfo ParseSPSInternal(const uint8_t *sps, size_t size)
 
     info.width = pic_width_in_luma_samples - sub_width_c * (conf_win_left_offset + conf_win_right_offset);
     info.height = pic_height_in_luma_samples - sub_height_c * (conf_win_top_offset + conf_win_bottom_offset);
-
     info.valid = true;
+
+    // The rest is only walked to reach the VUI timing
+    uint32_t log2_max_pic_order_cnt_lsb_minus4 = reader.ReadUE();
+    uint32_t sps_sub_layer_ordering_info_present_flag = reader.ReadBits(1);
+    for (uint32_t i = sps_sub_layer_ordering_info_present_flag ? 0 : sps_max_sub_layers_minus1;
+         i <= sps_max_sub_layers_minus1; i++) {
+        reader.ReadUE(); // sps_max_dec_pic_buffering_minus1
+        reader.ReadUE(); // sps_max_num_reorder_pics
+        reader.ReadUE(); // sps_max_latency_increase_plus1
+    }
+
+    reader.ReadUE(); // log2_min_luma_coding_block_size_minus3
+    reader.ReadUE(); // log2_diff_max_min_luma_coding_block_size
+    reader.ReadUE(); // log2_min_luma_transform_block_size_minus2
+    reader.ReadUE(); // log2_diff_max_min_luma_transform_block_size
+    reader.ReadUE(); // max_transform_hierarchy_depth_inter
+    reader.ReadUE(); // max_transform_hierarchy_depth_intra
+
+    if (reader.ReadBits(1)) {     // scaling_list_enabled_flag
+        if (reader.ReadBits(1)) { // sps_scaling_list_data_present_flag
+            SkipScalingListData(reader);
+        }
+    }
+
+    reader.ReadBits(1); // amp_enabled_flag
+    reader.ReadBits(1); // sample_adaptive_offset_enabled_flag
+
+    if (reader.ReadBits(1)) {     // pcm_enabled_flag
+        reader.ReadBits(4);       // pcm_sample_bit_depth_luma_minus1
+        reader.ReadBits(4);       // pcm_sample_bit_depth_chroma_minus1
+        reader.ReadUE(); // log2_min_pcm_luma_coding_block_size_minus3
+        reader.ReadUE(); // log2_diff_max_min_pcm_luma_coding_block_size
+        reader.ReadBits(1);       // pcm_loop_filter_disabled_flag
+    }
+
+    uint32_t num_short_term_ref_pic_sets = reader.ReadUE();
+    if (num_short_term_ref_pic_sets > 64) {
+        return info;
+    }
+    if (!SkipShortTermRefPicSets(reader, num_short_term_ref_pic_sets)) {
+        return info;
+    }
+
+    if (reader.ReadBits(1)) { // long_term_ref_pics_present_flag
+        uint32_t num_long_term_ref_pics_sps = reader.ReadUE();
+        if (num_long_term_ref_pics_sps > 32) {
+            return info;
+        }
+        for (uint32_t i = 0; i < num_long_term_ref_pics_sps; i++) {
+            reader.ReadBits(log2_max_pic_order_cnt_lsb_minus4 + 4); // lt_ref_pic_poc_lsb_sps
+            reader.ReadBits(1);                                     // used_by_curr_pic_lt_sps_flag
+        }
+    }
+
+    reader.ReadBits(1); // sps_temporal_mvp_enabled_flag
+    reader.ReadBits(1); // strong_intra_smoothing_enabled_flag
+
+    if (reader.ReadFlag() && !reader.Overrun()) { // vui_parameters_present_flag
+        ParseVUI(reader, info);
+    }
+
     return info;
 }
 
+H265SliceHeader ParseSliceHeaderInternal(const uint8_t *nalu, size_t size, uint32_t num_extra_slice_header_bits)
+{
+    H265SliceHeader header;
+    if (!nalu || size < 3) {
+        return header;
+    }
+
+    header.nal_unit_type = (nalu[0] >> 1) & 0x3F;
+    header.temporal_id = static_cast<uint8_t>((nalu[1] & 0x07) > 0 ? (nalu[1] & 0x07) - 1 : 0);
+    if (header.nal_unit_type > 21 || (header.nal_unit_type > 9 && header.nal_unit_type < 16)) {
+        return header;
+    }
+
+    BitReader reader(nalu + 2, size - 2);
+    header.first_slice_segment_in_pic_flag = reader.ReadFlag();
+    if (header.nal_unit_type >= 16) {
+        reader.ReadBits(1); // no_output_of_prior_pics_flag
+    }
+    header.pic_parameter_set_id = reader.ReadUE();
+
+    // Later segments code their address with a length from the SPS before the slice type
+    if (header.first_slice_segment_in_pic_flag) {
+        reader.SkipBits(num_extra_slice_header_bits); // slice_reserved_flag[]
+        uint32_t slice_type = reader.ReadUE();
+        if (slice_type > 2) {
+            return header;
+        }
+        header.slice_type = static_cast<int32_t>(slice_type);
+    }
+
+    header.valid = !reader.Overrun() && header.pic_parameter_set_id <= 63;
+    if (!header.valid) {
+        header.slice_type = -1;
+    }
+    return header;
+}
+
+int32_t GetNumExtraSliceHeaderBitsInternal(const uint8_t *pps, size_t size)
+{
+    if (!pps || size < 3 || ((pps[0] >> 1) & 0x3F) != 34) {
+        return -1;
+    }
+
+    BitReader reader(pps + 2, size - 2);
+    reader.ReadUE();    // pps_pic_parameter_set_id
+    reader.ReadUE();    // pps_seq_parameter_set_id
+    reader.ReadBits(1); // dependent_slice_segments_enabled_flag
+    reader.ReadBits(1); // output_flag_present_flag
+    uint32_t num_extra_slice_header_bits = reader.ReadBits(3);
+    return reader.Overrun() ? -1 : static_cast<int32_t>(num_extra_slice_header_bits);
+}
+
 } // namespace
 
 H265VideoInfo H265Parser::ParseSPS(const std::shared_ptr<lmcore::DataBuffer> &sps)
@@ -218,8 +421,31 @@ H265VideoInfo H265Parser::ParseSPS(const std::shared_ptr<lmcore::DataBuffer> &sp
         return {};
     }
 
-    auto data = RemoveStartCode(sps);
-    return ParseSPSInternal(data->Data(), data->Size());
+    size_t offset = StartCodeLength(sps->Data(), sps->Size());
+    return ParseSPSInternal(sps->Data() + offset, sps->Size() - offset);
+}
+
+H265SliceHeader H265Parser::ParseSliceHeader(const uint8_t *nalu, size_t size, uint32_t num_extra_slice_header_bits)
+{
+    size_t offset = nalu ? StartCodeLength(nalu, size) : 0;
+    return ParseSliceHeaderInternal(nalu ? nalu + offset : nullptr, size - offset, num_extra_slice_header_bits);
+}
+
+int32_t H265Parser::GetNumExtraSliceHeaderBits(const std::shared_ptr<lmcore::DataBuffer> &pps)
+{
+    if (!pps) {
+        return -1;
+    }
+    return GetNumExtraSliceHeaderBits(pps->Data(), pps->Size());
+}
+
+int32_t H265Parser::GetNumExtraSliceHeaderBits(const uint8_t *pps, size_t size)
+{
+    if (!pps) {
+        return -1;
+    }
+    size_t offset = StartCodeLength(pps, size);
+    return GetNumExtraSliceHeaderBitsInternal(pps + offset, size - offset);
 }
 
 bool H265Parser::GetResolution(const std::shared_ptr<lmcore::DataBuffer> &sps, int32_t &width, int32_t &height)
@@ -284,14 +510,14 @@ int32_t H265Parser::GetNaluType(const std::shared_ptr<lmcore::DataBuffer> &data)
         return -1;
     }
 
-    auto nalu_data = RemoveStartCode(data);
-    if (!nalu_data || nalu_data->Size() < 2) {
+    size_t offset = StartCodeLength(data->Data(), data->Size());
+    if (data->Size() < offset + 2) {
         return -1;
     }
 
     // H.265 NAL unit type is in bits [1-6] of the first byte after start code
     // NAL header is 2 bytes: |F|Type(6)|LayerId(6)|TID(3)|
-    uint8_t first_byte = nalu_data->Data()[0];
+    uint8_t first_byte = data->Data()[offset];
     return (first_byte >> 1) & 0x3F; // Extract 6 bits
 }
 
@@ -8,6 +8,7 @@
 
 #include "lmrtsp/ts_parser.h"
 
+#include <algorithm>
 #include <cstring>
 
 namespace lmshao::lmrtsp {
@@ -19,6 +20,7 @@ static constexpr uint8_t TS_SYNC_BYTE = 0x47;
 // TS header field offsets and masks
 static constexpr uint8_t TS_HEADER_SIZE = 4;
 static constexpr uint8_t TS_PID_MASK = 0x1F;
+static constexpr uint8_t TS_PAYLOAD_UNIT_START_MASK = 0x40;
 static constexpr uint8_t TS_ADAPTATION_FIELD_CONTROL_MASK = 0x30;
 static constexpr uint8_t TS_ADAPTATION_FIELD_CONTROL_PAYLOAD_ONLY = 0x01;
 static constexpr uint8_t TS_ADAPTATION_FIELD_CONTROL_ADAPTATION_ONLY = 0x02;
@@ -29,6 +31,49 @@ static constexpr uint8_t TS_AF_DISCONTINUITY_MASK = 0x80;
 static constexpr uint8_t TS_AF_RANDOM_ACCESS_MASK = 0x40;
 static constexpr uint8_t TS_AF_PCR_FLAG_MASK = 0x10;
 
+// PSI
+static constexpr uint16_t TS_PAT_PID = 0x0000;
+static constexpr uint16_t TS_NULL_PID = 0x1FFF;
+static constexpr uint8_t TS_TABLE_ID_PAT = 0x00;
+static constexpr uint8_t TS_TABLE_ID_PMT = 0x02;
+static constexpr size_t TS_SECTION_HEADER_SIZE = 3; // table_id + section_length
+static constexpr size_t TS_SECTION_CRC_SIZE = 4;
+static constexpr size_t TS_PAT_ENTRIES_OFFSET = 8;
+static constexpr size_t TS_PMT_PROGRAM_INFO_OFFSET = 12;
+static constexpr size_t TS_PMT_ES_HEADER_SIZE = 5;
+
+static uint16_t ReadPid(const uint8_t *data)
+{
+    return ((data[0] & TS_PID_MASK) << 8) | data[1];
+}
+
+static uint16_t ReadLength12(const uint8_t *data)
+{
+    return ((data[0] & 0x0F) << 8) | data[1];
+}
+
+// Locate a complete, CRC-valid section with the given table ID in a single packet
+static bool FindSection(const uint8_t *packet_data, uint8_t table_id, const uint8_t *&section, size_t &section_size)
+{
+    size_t offset = 0;
+    if (!TSParser::GetSectionOffset(packet_data, offset)) {
+        return false;
+    }
+
+    section = packet_data + offset;
+    if (section[0] != table_id) {
+        return false;
+    }
+
+    section_size = TS_SECTION_HEADER_SIZE + ReadLength12(section + 1);
+    if (section_size > TS_PACKET_SIZE - offset || section_size < TS_PAT_ENTRIES_OFFSET + TS_SECTION_CRC_SIZE) {
+        return false;
+    }
+
+    // The CRC over a section including its CRC field is 0
+    return TSParser::SectionCRC32(section, section_size) == 0;
+}
+
 bool TSParser::ParsePacket(const uint8_t *packet_data, TSPacketInfo &info)
 {
     // Initialize output
@@ -46,9 +91,22 @@ bool TSParser::ParsePacket(const uint8_t *packet_data, TSPacketInfo &info)
     // Extract PID (13 bits, bytes 1-2)
     info.pid = ((packet_data[1] & TS_PID_MASK) << 8) | packet_data[2];
 
+    info.payload_unit_start = (packet_data[1] & TS_PAYLOAD_UNIT_START_MASK) != 0;
+
     // Extract adaptation field control (2 bits, byte 3)
     uint8_t adaptation_field_control = (packet_data[3] & TS_ADAPTATION_FIELD_CONTROL_MASK) >> 4;
 
+    // PSI sections start with a pointer field instead, never with a start code
+    if (info.payload_unit_start && (adaptation_field_control == TS_ADAPTATION_FIELD_CONTROL_PAYLOAD_ONLY ||
+                                    adaptation_field_control == TS_ADAPTATION_FIELD_CONTROL_BOTH)) {
+        size_t payload = TS_HEADER_SIZE;
+        if (adaptation_field_control == TS_ADAPTATION_FIELD_CONTROL_BOTH) {
+            payload += 1 + packet_data[TS_HEADER_SIZE];
+        }
+        info.pes_start = payload + 3 <= TS_PACKET_SIZE && packet_data[payload] == 0x00 &&
+                         packet_data[payload + 1] == 0x00 && packet_data[payload + 2] == 0x01;
+    }
+
     // Check if adaptation field is present
     if (adaptation_field_control == TS_ADAPTATION_FIELD_CONTROL_ADAPTATION_ONLY ||
         adaptation_field_control == TS_ADAPTATION_FIELD_CONTROL_BOTH) {
@@ -170,4 +228,263 @@ bool TSParser::IsPCRDiscontinuous(uint64_t prev_pcr, uint64_t curr_pcr, uint64_t
     return pcr_diff > max_interval;
 }
 
+bool TSParser::GetSectionOffset(const uint8_t *packet_data, size_t &offset)
+{
+    if (!packet_data || packet_data[0] != TS_SYNC_BYTE || !(packet_data[1] & TS_PAYLOAD_UNIT_START_MASK)) {
+        return false;
+    }
+
+    uint8_t adaptation_field_control = (packet_data[3] & TS_ADAPTATION_FIELD_CONTROL_MASK) >> 4;
+    if (adaptation_field_control != TS_ADAPTATION_FIELD_CONTROL_PAYLOAD_ONLY &&
+        adaptation_field_control != TS_ADAPTATION_FIELD_CONTROL_BOTH) {
+        return false;
+    }
+
+    size_t pos = TS_HEADER_SIZE;
+    if (adaptation_field_control == TS_ADAPTATION_FIELD_CONTROL_BOTH) {
+        pos += 1 + packet_data[pos];
+        if (pos >= TS_PACKET_SIZE) {
+            return false;
+        }
+    }
+
+    // Skip the pointer field
+    pos += 1 + packet_data[pos];
+    if (pos + TS_SECTION_HEADER_SIZE > TS_PACKET_SIZE) {
+        return false;
+    }
+
+    offset = pos;
+    return true;
+}
+
+uint32_t TSParser::SectionCRC32(const uint8_t *data, size_t size)
+{
+    uint32_t crc = 0xFFFFFFFF;
+    for (size_t i = 0; i < size; ++i) {
+        crc ^= static_cast<uint32_t>(data[i]) << 24;
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc & 0x80000000) ? (crc << 1) ^ 0x04C11DB7 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+bool TSParser::ParsePAT(const uint8_t *packet_data, std::vector<uint16_t> &pmt_pids)
+{
+    pmt_pids.clear();
+
+    const uint8_t *section = nullptr;
+    size_t section_size = 0;
+    if (!FindSection(packet_data, TS_TABLE_ID_PAT, section, section_size)) {
+        return false;
+    }
+
+    // 4-byte entries of program_number and PID up to the CRC
+    for (size_t pos = TS_PAT_ENTRIES_OFFSET; pos + 4 <= section_size - TS_SECTION_CRC_SIZE; pos += 4) {
+        uint16_t program_number = (section[pos] << 8) | section[pos + 1];
+        if (program_number != 0) {
+            pmt_pids.push_back(ReadPid(section + pos + 2));
+        }
+    }
+    return true;
+}
+
+bool TSParser::ParsePMT(const uint8_t *packet_data, TSProgramMap &program)
+{
+    program = TSProgramMap{};
+
+    const uint8_t *section = nullptr;
+    size_t section_size = 0;
+    if (!FindSection(packet_data, TS_TABLE_ID_PMT, section, section_size) ||
+        section_size < TS_PMT_PROGRAM_INFO_OFFSET + TS_SECTION_CRC_SIZE) {
+        return false;
+    }
+
+    program.program_number = (section[3] << 8) | section[4];
+    program.pcr_pid = ReadPid(section + 8);
+
+    size_t end = section_size - TS_SECTION_CRC_SIZE;
+    size_t pos = TS_PMT_PROGRAM_INFO_OFFSET + ReadLength12(section + 10);
+    while (pos + TS_PMT_ES_HEADER_SIZE <= end) {
+        TSElementaryStream stream;
+        stream.stream_type = section[pos];
+        stream.pid = ReadPid(section + pos + 1);
+        pos += TS_PMT_ES_HEADER_SIZE + ReadLength12(section + pos + 3);
+        if (pos > end) {
+            return false;
+        }
+        program.streams.push_back(stream);
+    }
+
+    return pos == end;
+}
+
+size_t TSRemuxer::Filter(const uint8_t *data, size_t size, uint8_t *out)
+{
+    size_t written = 0;
+    for (size_t offset = 0; offset + TS_PACKET_SIZE <= size; offset += TS_PACKET_SIZE) {
+        const uint8_t *packet = data + offset;
+        uint8_t *dst = out + written;
+
+        if (packet[0] == TS_SYNC_BYTE) {
+            uint16_t pid = ReadPid(packet + 1);
+            if (pid == TS_NULL_PID) {
+                if (config_.drop_null_packets) {
+                    ++droppedPackets_;
+                    continue;
+                }
+            } else if (!config_.stream_types.empty()) {
+                if (pid == TS_PAT_PID) {
+                    OnPAT(packet);
+                } else if (pmtPids_.test(pid)) {
+                    if (RewritePMT(pid, packet, dst)) {
+                        written += TS_PACKET_SIZE;
+                        continue;
+                    }
+                } else if (droppedPids_.test(pid)) {
+                    ++droppedPackets_;
+                    continue;
+                }
+            }
+        }
+
+        std::memcpy(dst, packet, TS_PACKET_SIZE);
+        written += TS_PACKET_SIZE;
+    }
+    return written;
+}
+
+void TSRemuxer::OnPAT(const uint8_t *packet)
+{
+    std::vector<uint16_t> pmt_pids;
+    if (!TSParser::ParsePAT(packet, pmt_pids)) {
+        return;
+    }
+
+    pmtPids_.reset();
+    for (uint16_t pid : pmt_pids) {
+        pmtPids_.set(pid);
+    }
+
+    // Forget programs the PAT no longer lists
+    bool changed = false;
+    for (auto it = pmtRewrites_.begin(); it != pmtRewrites_.end();) {
+        if (!pmtPids_.test(it->first)) {
+            it = pmtRewrites_.erase(it);
+            changed = true;
+        } else {
+            ++it;
+        }
+    }
+    if (changed) {
+        UpdateDroppedPids();
+    }
+}
+
+bool TSRemuxer::RewritePMT(uint16_t pid, const uint8_t *packet, uint8_t *out)
+{
+    size_t offset = 0;
+    if (!TSParser::GetSectionOffset(packet, offset)) {
+        // Continuation of a multi-packet section
+        return false;
+    }
+
+    const uint8_t *section = packet + offset;
+    size_t section_size = TS_SECTION_HEADER_SIZE + ReadLength12(section + 1);
+    if (section_size > TS_PACKET_SIZE - offset || section_size < TS_PMT_PROGRAM_INFO_OFFSET + TS_SECTION_CRC_SIZE) {
+        if (pmtRewrites_.erase(pid) > 0) {
+            UpdateDroppedPids();
+        }
+        return false;
+    }
+
+    const uint8_t *crc = section + section_size - TS_SECTION_CRC_SIZE;
+    uint32_t source_crc = (crc[0] << 24) | (crc[1] << 16) | (crc[2] << 8) | crc[3];
+
+    auto it = pmtRewrites_.find(pid);
+    if (it == pmtRewrites_.end() || it->second.source_crc != source_crc) {
+        PmtRewrite rewrite;
+        if (!BuildRewrite(packet, rewrite)) {
+            if (it != pmtRewrites_.end()) {
+                pmtRewrites_.erase(it);
+                UpdateDroppedPids();
+            }
+            return false;
+        }
+        rewrite.source_crc = source_crc;
+        it = pmtRewrites_.insert_or_assign(pid, std::move(rewrite)).first;
+        UpdateDroppedPids();
+    }
+
+    // Keep the header, with its continuity counter, and stuff the rest of the packet
+    const std::vector<uint8_t> &rewritten = it->second.section;
+    std::memcpy(out, packet, offset);
+    std::memcpy(out + offset, rewritten.data(), rewritten.size());
+    std::memset(out + offset + rewritten.size(), 0xFF, TS_PACKET_SIZE - offset - rewritten.size());
+    return true;
+}
+
+bool TSRemuxer::BuildRewrite(const uint8_t *packet, PmtRewrite &rewrite) const
+{
+    TSProgramMap program;
+    if (!TSParser::ParsePMT(packet, program)) {
+        return false;
+    }
+
+    auto selected = [this](const TSElementaryStream &stream) {
+        return std::find(config_.stream_types.begin(), config_.stream_types.end(), stream.stream_type) !=
+               config_.stream_types.end();
+    };
+    auto keep = [&program, &selected](const TSElementaryStream &stream) {
+        return stream.pid == program.pcr_pid || selected(stream);
+    };
+
+    // A selection that matches nothing would leave the client without media, keep the program as it is
+    if (std::none_of(program.streams.begin(), program.streams.end(), selected)) {
+        return false;
+    }
+
+    size_t offset = 0;
+    TSParser::GetSectionOffset(packet, offset);
+    const uint8_t *section = packet + offset;
+
+    size_t pos = TS_PMT_PROGRAM_INFO_OFFSET + ReadLength12(section + 10);
+    rewrite.section.assign(section, section + pos);
+    for (const auto &stream : program.streams) {
+        size_t entry_size = TS_PMT_ES_HEADER_SIZE + ReadLength12(section + pos + 3);
+        if (keep(stream)) {
+            rewrite.section.insert(rewrite.section.end(), section + pos, section + pos + entry_size);
+        } else {
+            rewrite.dropped_pids.push_back(stream.pid);
+        }
+        pos += entry_size;
+    }
+
+    size_t section_length = rewrite.section.size() - TS_SECTION_HEADER_SIZE + TS_SECTION_CRC_SIZE;
+    rewrite.section[1] = (rewrite.section[1] & 0xF0) | ((section_length >> 8) & 0x0F);
+    rewrite.section[2] = section_length & 0xFF;
+
+    uint32_t crc = TSParser::SectionCRC32(rewrite.section.data(), rewrite.section.size());
+    rewrite.section.push_back((crc >> 24) & 0xFF);
+    rewrite.section.push_back((crc >> 16) & 0xFF);
+    rewrite.section.push_back((crc >> 8) & 0xFF);
+    rewrite.section.push_back(crc & 0xFF);
+    return true;
+}
+
+void TSRemuxer::UpdateDroppedPids()
+{
+    droppedPids_.reset();
+    for (const auto &entry : pmtRewrites_) {
+        for (uint16_t pid : entry.second.dropped_pids) {
+            droppedPids_.set(pid);
+        }
+    }
+
+    // PSI PIDs are never dropped, even if a broken PMT lists them as elementary streams
+    droppedPids_ &= ~pmtPids_;
+    droppedPids_.reset(TS_PAT_PID);
+}
+
 } // namespace lmshao::lmrtsp
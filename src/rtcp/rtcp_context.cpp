@@ -12,6 +12,7 @@
 #include <lmcore/data_buffer.h>
 #include <lmcore/time_utils.h>
 
+#include <algorithm>
 #include <cmath>
 #include <cstring>
 
@@ -20,6 +21,54 @@
 
 namespace lmshao::lmrtsp {
 
+namespace {
+
+// Call visit(header, data, size) for each packet of a compound RTCP packet, stop at the first malformed one
+template <typename Visitor>
+void ForEachRtcpPacket(const uint8_t *data, size_t size, Visitor visit)
+{
+    while (size >= sizeof(RtcpHeader)) {
+        const auto *header = reinterpret_cast<const RtcpHeader *>(data);
+        if (header->version != RTCP_VERSION) {
+            LMRTSP_LOGW("Invalid RTCP version: %d", header->version);
+            return;
+        }
+
+        size_t packetSize = header->GetSize();
+        if (packetSize > size) {
+            LMRTSP_LOGW("Truncated RTCP packet: length=%zu, remaining=%zu", packetSize, size);
+            return;
+        }
+
+        visit(header, data, packetSize);
+        data += packetSize;
+        size -= packetSize;
+    }
+}
+
+void CountLossRuns(const std::vector<bool> &received, RtcpXrStats &stats)
+{
+    uint32_t run = 0;
+    for (size_t i = 0; i <= received.size(); ++i) {
+        if (i < received.size() && !received[i]) {
+            ++run;
+            continue;
+        }
+        if (i < received.size()) {
+            ++stats.received_packets;
+        }
+        if (run > 0) {
+            stats.lost_packets += run;
+            ++stats.loss_bursts;
+            stats.isolated_losses += (run == 1) ? 1 : 0;
+            stats.max_burst_length = std::max(stats.max_burst_length, run);
+            run = 0;
+        }
+    }
+}
+
+} // namespace
+
 void RtcpContext::Initialize(uint32_t rtcpSsrc, uint32_t rtpSsrc)
 {
     rtcpSsrc_ = rtcpSsrc;
@@ -32,11 +81,11 @@ void RtcpContext::OnRtcp(const lmcore::DataBuffer &buffer)
     (void)buffer;
 }
 
-void RtcpContext::OnRtp(uint16_t seq, uint32_t timestamp, uint64_t ntpTimestampMs, uint32_t sampleRate, size_t bytes)
+void RtcpContext::OnRtp(uint16_t seq, uint32_t timestamp, int64_t timeNs, uint32_t sampleRate, size_t bytes)
 {
     (void)seq;
     lastRtpTimestamp_ = timestamp;
-    lastNtpTimestampMs_ = ntpTimestampMs;
+    lastRtpTimeNs_ = timeNs;
     totalBytes_ += bytes;
     totalPackets_++;
     (void)sampleRate;
@@ -52,6 +101,11 @@ std::shared_ptr<lmcore::DataBuffer> RtcpContext::CreateRtcpRr()
     return nullptr;
 }
 
+std::shared_ptr<lmcore::DataBuffer> RtcpContext::CreateRtcpXr()
+{
+    return nullptr;
+}
+
 std::shared_ptr<lmcore::DataBuffer> RtcpContext::CreateRtcpSdes(const std::string &cname, const std::string &name)
 {
     if (rtcpSsrc_ == 0) {
@@ -118,20 +172,60 @@ std::shared_ptr<lmcore::DataBuffer> RtcpContext::CreateCompoundPacket(const std:
         return nullptr;
     }
 
-    // Create SDES
-    auto sdes = CreateRtcpSdes(cname, name);
-    if (!sdes) {
-        return srOrRr; // Return SR/RR only if SDES failed
+    // SDES and XR are optional
+    std::shared_ptr<lmcore::DataBuffer> sdes;
+    if (!cname.empty()) {
+        sdes = CreateRtcpSdes(cname, name);
+    }
+    auto xr = CreateRtcpXr();
+    if (!sdes && !xr) {
+        return srOrRr;
     }
 
     // Combine into compound packet
-    size_t totalSize = srOrRr->Size() + sdes->Size();
+    size_t totalSize = srOrRr->Size() + (sdes ? sdes->Size() : 0) + (xr ? xr->Size() : 0);
     auto buffer = lmcore::DataBuffer::Create(totalSize);
 
     buffer->Append(srOrRr);
-    buffer->Append(sdes);
+    if (sdes) {
+        buffer->Append(sdes);
+    }
+    if (xr) {
+        buffer->Append(xr);
+    }
+
+    LMRTSP_LOGD("Created compound packet: SR/RR%s%s, total size=%zu", sdes ? " + SDES" : "", xr ? " + XR" : "",
+                totalSize);
+    return buffer;
+}
+
+std::shared_ptr<lmcore::DataBuffer>
+RtcpContext::CreateFeedbackPacket(const std::shared_ptr<lmcore::DataBuffer> &feedback, const std::string &cname)
+{
+    if (!feedback || reducedSize_) {
+        return feedback;
+    }
 
-    LMRTSP_LOGD("Created compound packet: SR/RR + SDES, total size=%zu", totalSize);
+    // RFC 4585 early feedback: the compound must still start with SR/RR and carry SDES CNAME
+    auto srOrRr = CreateRtcpSr();
+    if (!srOrRr) {
+        srOrRr = CreateRtcpRr();
+    }
+    if (!srOrRr) {
+        return nullptr;
+    }
+    std::shared_ptr<lmcore::DataBuffer> sdes;
+    if (!cname.empty()) {
+        sdes = CreateRtcpSdes(cname);
+    }
+
+    size_t totalSize = srOrRr->Size() + (sdes ? sdes->Size() : 0) + feedback->Size();
+    auto buffer = lmcore::DataBuffer::Create(totalSize);
+    buffer->Append(srOrRr);
+    if (sdes) {
+        buffer->Append(sdes);
+    }
+    buffer->Append(feedback);
     return buffer;
 }
 
@@ -150,34 +244,37 @@ void RtcpSenderContext::OnRtcp(const lmcore::DataBuffer &buffer)
         return;
     }
 
-    const auto *header = reinterpret_cast<const RtcpHeader *>(data);
-
-    // Check version
-    if (header->version != RTCP_VERSION) {
-        LMRTSP_LOGW("Invalid RTCP version: %d", header->version);
-        return;
-    }
-
-    RtcpType type = static_cast<RtcpType>(header->packetType);
+    ForEachRtcpPacket(data, size, [this](const RtcpHeader *header, const uint8_t *packet, size_t packetSize) {
+        RtcpType type = static_cast<RtcpType>(header->packetType);
 
-    switch (type) {
-        case RtcpType::RR: {
-            if (size >= sizeof(RtcpReceiverReport)) {
-                const auto *rr = reinterpret_cast<const RtcpReceiverReport *>(data);
-                ProcessReceiverReport(rr);
+        switch (type) {
+            case RtcpType::RR: {
+                if (packetSize >= sizeof(RtcpReceiverReport) + header->count * sizeof(RtcpReportBlock)) {
+                    const auto *rr = reinterpret_cast<const RtcpReceiverReport *>(packet);
+                    ProcessReceiverReport(rr);
+                }
+                break;
             }
-            break;
+            case RtcpType::XR:
+                ProcessExtendedReport(packet, packetSize);
+                break;
+            case RtcpType::RTPFB:
+            case RtcpType::PSFB:
+                if (packetSize >= sizeof(RtcpFeedback)) {
+                    ProcessFeedback(reinterpret_cast<const RtcpFeedback *>(packet));
+                }
+                break;
+            case RtcpType::SR:
+                LMRTSP_LOGD("Received SR (unexpected for sender context)");
+                break;
+            case RtcpType::BYE:
+                LMRTSP_LOGI("Received BYE");
+                break;
+            default:
+                LMRTSP_LOGD("Received RTCP packet type: %d", static_cast<int>(type));
+                break;
         }
-        case RtcpType::SR:
-            LMRTSP_LOGD("Received SR (unexpected for sender context)");
-            break;
-        case RtcpType::BYE:
-            LMRTSP_LOGI("Received BYE");
-            break;
-        default:
-            LMRTSP_LOGD("Received RTCP packet type: %d", static_cast<int>(type));
-            break;
-    }
+    });
 }
 
 void RtcpSenderContext::ProcessReceiverReport(const RtcpReceiverReport *rr)
@@ -186,8 +283,9 @@ void RtcpSenderContext::ProcessReceiverReport(const RtcpReceiverReport *rr)
         return;
     }
 
-    uint64_t currentTimeMs = lmcore::TimeUtils::GetCurrentTimeMs();
+    uint64_t currentTimeMs = clock_->NowMs();
     uint32_t senderSsrc = lmcore::ByteOrder::NetworkToHost32(rr->ssrc);
+    std::lock_guard<std::mutex> lock(reportMutex_);
 
     // Process each report block
     auto blocks = const_cast<RtcpReceiverReport *>(rr)->GetReportBlocks();
@@ -198,6 +296,7 @@ void RtcpSenderContext::ProcessReceiverReport(const RtcpReceiverReport *rr)
 
         uint32_t lsr = lmcore::ByteOrder::NetworkToHost32(block->lastSr);
         uint32_t dlsr = lmcore::ByteOrder::NetworkToHost32(block->delaySinceLastSr);
+        lastFractionLost_.store(block->fractionLost, std::memory_order_relaxed);
 
         // Calculate RTT if we have sent an SR
         auto it = senderReportNtpMap_.find(lsr);
@@ -208,11 +307,143 @@ void RtcpSenderContext::ProcessReceiverReport(const RtcpReceiverReport *rr)
             uint64_t rttMs = currentTimeMs - srSentTimeMs - dlsrMs;
 
             rttMap_[senderSsrc] = static_cast<uint32_t>(rttMs);
+            lastRttMs_.store(static_cast<uint32_t>(rttMs), std::memory_order_relaxed);
             LMRTSP_LOGD("RTT for SSRC 0x%08x: %u ms", senderSsrc, static_cast<uint32_t>(rttMs));
         }
     }
 
     receiverReportTimeMap_[senderSsrc] = currentTimeMs;
+    lastReportTimeMs_.store(static_cast<int64_t>(currentTimeMs), std::memory_order_release);
+}
+
+void RtcpSenderContext::ProcessFeedback(const RtcpFeedback *fb)
+{
+    uint32_t mediaSsrc = lmcore::ByteOrder::NetworkToHost32(fb->mediaSsrc);
+    if (rtpSsrc_ != 0 && mediaSsrc != rtpSsrc_) {
+        LMRTSP_LOGD("Ignored feedback for SSRC 0x%08x", mediaSsrc);
+        return;
+    }
+
+    RtcpType type = static_cast<RtcpType>(fb->packetType);
+    if (type == RtcpType::RTPFB && fb->count == static_cast<uint8_t>(RtpfbType::NACK)) {
+        std::vector<uint16_t> lostSeqs = fb->GetNackSequences();
+        nackPackets_.fetch_add(1, std::memory_order_relaxed);
+        LMRTSP_LOGD("Received NACK: %zu packets", lostSeqs.size());
+        if (nackCallback_ && !lostSeqs.empty()) {
+            nackCallback_(lostSeqs);
+        }
+    } else if (type == RtcpType::PSFB && fb->count == static_cast<uint8_t>(PsfbType::PLI)) {
+        pliPackets_.fetch_add(1, std::memory_order_relaxed);
+        LMRTSP_LOGD("Received PLI");
+        if (pliCallback_) {
+            pliCallback_();
+        }
+    } else {
+        LMRTSP_LOGD("Received feedback: PT=%d, FMT=%d", static_cast<int>(type), static_cast<int>(fb->count));
+    }
+}
+
+void RtcpSenderContext::ProcessExtendedReport(const uint8_t *data, size_t size)
+{
+    RtcpXrReport report;
+    if (!RtcpXr::Parse(data, size, report)) {
+        LMRTSP_LOGW("Invalid XR packet: size=%zu", size);
+        return;
+    }
+
+    uint64_t currentTimeMs = clock_->NowMs();
+    std::lock_guard<std::mutex> lock(reportMutex_);
+
+    // Answered with DLRR in the next report
+    if (report.hasReferenceTime) {
+        uint32_t lastRr = RtcpUtils::GetLsrFromNtp(report.referenceNtpH, report.referenceNtpL);
+        referenceTimeMap_[report.ssrc] = ReferenceTime{lastRr, currentTimeMs};
+    }
+
+    auto isOurs = [this](uint32_t ssrc) { return rtpSsrc_ == 0 || ssrc == rtpSsrc_; };
+    RtcpXrStats stats;
+    bool haveLoss = false;
+    bool haveDup = false;
+
+    for (const auto &rle : report.lossRle) {
+        if (isOurs(rle.ssrc)) {
+            stats.begin_seq = rle.beginSeq;
+            stats.end_seq = rle.endSeq;
+            CountLossRuns(rle.flags, stats);
+            haveLoss = true;
+        }
+    }
+    for (const auto &rle : report.dupRle) {
+        if (isOurs(rle.ssrc)) {
+            stats.dup_packets += static_cast<uint32_t>(std::count(rle.flags.begin(), rle.flags.end(), true));
+            haveDup = true;
+        }
+    }
+    for (const auto &summary : report.statisticsSummary) {
+        if (!isOurs(summary.ssrc)) {
+            continue;
+        }
+        if (!haveLoss) {
+            stats.begin_seq = summary.beginSeq;
+            stats.end_seq = summary.endSeq;
+            stats.lost_packets = summary.hasLoss ? summary.lostPackets : 0;
+        }
+        if (!haveDup) {
+            stats.dup_packets = summary.hasDup ? summary.dupPackets : 0;
+        }
+        stats.has_jitter = summary.hasJitter;
+        stats.min_jitter = summary.minJitter;
+        stats.max_jitter = summary.maxJitter;
+        stats.mean_jitter = summary.meanJitter;
+        stats.dev_jitter = summary.devJitter;
+        haveLoss = true;
+    }
+
+    if (haveLoss || haveDup) {
+        stats.valid = true;
+        stats.report_time_ms = static_cast<int64_t>(currentTimeMs);
+        xrStats_ = stats;
+        LMRTSP_LOGD("XR from SSRC 0x%08x: lost=%u, bursts=%u, isolated=%u, dup=%u", report.ssrc, stats.lost_packets,
+                    stats.loss_bursts, stats.isolated_losses, stats.dup_packets);
+    }
+}
+
+std::shared_ptr<lmcore::DataBuffer> RtcpSenderContext::CreateRtcpXr()
+{
+    if (rtcpSsrc_ == 0) {
+        return nullptr;
+    }
+
+    RtcpXrReport report;
+    report.ssrc = rtcpSsrc_;
+    uint64_t currentTimeMs = clock_->NowMs();
+    {
+        std::lock_guard<std::mutex> lock(reportMutex_);
+        for (const auto &pair : referenceTimeMap_) {
+            XrDlrrItem item;
+            item.ssrc = pair.first;
+            item.lastRr = pair.second.lastRr;
+            // DLRR is in units of 1/65536 seconds
+            item.delaySinceLastRr = static_cast<uint32_t>(((currentTimeMs - pair.second.receivedMs) * 65536) / 1000);
+            report.dlrr.push_back(item);
+        }
+        referenceTimeMap_.clear();
+    }
+    if (report.dlrr.empty()) {
+        return nullptr;
+    }
+
+    auto xr = RtcpXr::Create(report);
+    if (!xr) {
+        return nullptr;
+    }
+
+    size_t xrSize = xr->GetSize();
+    auto buffer = lmcore::DataBuffer::Create(xrSize);
+    buffer->Append(xr.get(), xrSize);
+
+    LMRTSP_LOGD("Created XR: SSRC=0x%08x, DLRR items=%zu", rtcpSsrc_, report.dlrr.size());
+    return buffer;
 }
 
 std::shared_ptr<lmcore::DataBuffer> RtcpSenderContext::CreateRtcpSr()
@@ -227,16 +458,20 @@ std::shared_ptr<lmcore::DataBuffer> RtcpSenderContext::CreateRtcpSr()
         return nullptr;
     }
 
-    uint64_t currentTimeMs = lmcore::TimeUtils::GetCurrentTimeMs();
+    uint64_t currentTimeMs = clock_->NowMs();
 
     sr->SetSsrc(rtcpSsrc_)
         .SetNtpTimestamp(currentTimeMs)
         .SetRtpTimestamp(lastRtpTimestamp_)
         .SetCounts(static_cast<uint32_t>(totalPackets_), static_cast<uint32_t>(totalBytes_));
 
-    // Store LSR for RTT calculation
-    uint32_t lsr = RtcpUtils::GetLsrFromNtp(sr->ntpTimestampH, sr->ntpTimestampL);
-    senderReportNtpMap_[lsr] = currentTimeMs;
+    // Store LSR for RTT calculation, keyed like the host-order LSR the receiver echoes back
+    uint32_t lsr = RtcpUtils::GetLsrFromNtp(lmcore::ByteOrder::NetworkToHost32(sr->ntpTimestampH),
+                                            lmcore::ByteOrder::NetworkToHost32(sr->ntpTimestampL));
+    {
+        std::lock_guard<std::mutex> lock(reportMutex_);
+        senderReportNtpMap_[lsr] = currentTimeMs;
+    }
 
     // Create data buffer
     size_t srSize = sr->GetSize();
@@ -251,12 +486,14 @@ std::shared_ptr<lmcore::DataBuffer> RtcpSenderContext::CreateRtcpSr()
 
 uint32_t RtcpSenderContext::GetRtt(uint32_t ssrc) const
 {
+    std::lock_guard<std::mutex> lock(reportMutex_);
     auto it = rttMap_.find(ssrc);
     return (it != rttMap_.end()) ? it->second : 0;
 }
 
 uint32_t RtcpSenderContext::GetAverageRtt() const
 {
+    std::lock_guard<std::mutex> lock(reportMutex_);
     if (rttMap_.empty()) {
         return 0;
     }
@@ -269,6 +506,24 @@ uint32_t RtcpSenderContext::GetAverageRtt() const
     return static_cast<uint32_t>(totalRtt / rttMap_.size());
 }
 
+RtcpReceiverFeedback RtcpSenderContext::GetReceiverFeedback() const
+{
+    RtcpReceiverFeedback feedback;
+    feedback.report_time_ms = lastReportTimeMs_.load(std::memory_order_acquire);
+    feedback.valid = feedback.report_time_ms != 0;
+    feedback.fraction_lost = static_cast<uint8_t>(lastFractionLost_.load(std::memory_order_relaxed));
+    feedback.rtt_ms = lastRttMs_.load(std::memory_order_relaxed);
+    feedback.nack_packets = nackPackets_.load(std::memory_order_relaxed);
+    feedback.pli_packets = pliPackets_.load(std::memory_order_relaxed);
+    return feedback;
+}
+
+RtcpXrStats RtcpSenderContext::GetXrStats() const
+{
+    std::lock_guard<std::mutex> lock(reportMutex_);
+    return xrStats_;
+}
+
 RtcpReceiverContext::Ptr RtcpReceiverContext::Create()
 {
     return std::make_shared<RtcpReceiverContext>();
@@ -284,34 +539,32 @@ void RtcpReceiverContext::OnRtcp(const lmcore::DataBuffer &buffer)
         return;
     }
 
-    const auto *header = reinterpret_cast<const RtcpHeader *>(data);
-
-    // Check version
-    if (header->version != RTCP_VERSION) {
-        LMRTSP_LOGW("Invalid RTCP version: %d", header->version);
-        return;
-    }
-
-    RtcpType type = static_cast<RtcpType>(header->packetType);
+    std::lock_guard<std::mutex> lock(stateMutex_);
+    ForEachRtcpPacket(data, size, [this](const RtcpHeader *header, const uint8_t *packet, size_t packetSize) {
+        RtcpType type = static_cast<RtcpType>(header->packetType);
 
-    switch (type) {
-        case RtcpType::SR: {
-            if (size >= sizeof(RtcpSenderReport)) {
-                const auto *sr = reinterpret_cast<const RtcpSenderReport *>(data);
-                ProcessSenderReport(sr);
+        switch (type) {
+            case RtcpType::SR: {
+                if (packetSize >= sizeof(RtcpSenderReport)) {
+                    const auto *sr = reinterpret_cast<const RtcpSenderReport *>(packet);
+                    ProcessSenderReport(sr);
+                }
+                break;
             }
-            break;
+            case RtcpType::XR:
+                ProcessExtendedReport(packet, packetSize);
+                break;
+            case RtcpType::RR:
+                LMRTSP_LOGD("Received RR (unexpected for receiver context)");
+                break;
+            case RtcpType::BYE:
+                LMRTSP_LOGI("Received BYE");
+                break;
+            default:
+                LMRTSP_LOGD("Received RTCP packet type: %d", static_cast<int>(type));
+                break;
         }
-        case RtcpType::RR:
-            LMRTSP_LOGD("Received RR (unexpected for receiver context)");
-            break;
-        case RtcpType::BYE:
-            LMRTSP_LOGI("Received BYE");
-            break;
-        default:
-            LMRTSP_LOGD("Received RTCP packet type: %d", static_cast<int>(type));
-            break;
-    }
+    });
 }
 
 void RtcpReceiverContext::ProcessSenderReport(const RtcpSenderReport *sr)
@@ -324,15 +577,39 @@ void RtcpReceiverContext::ProcessSenderReport(const RtcpSenderReport *sr)
     uint32_t ntpL = lmcore::ByteOrder::NetworkToHost32(sr->ntpTimestampL);
 
     lastSrLsr_ = RtcpUtils::GetLsrFromNtp(ntpH, ntpL);
-    lastSrNtpMs_ = lmcore::TimeUtils::GetCurrentTimeMs();
+    lastSrNtpMs_ = clock_->NowMs();
 
     LMRTSP_LOGD("Processed SR: SSRC=0x%08x, LSR=0x%08x", lmcore::ByteOrder::NetworkToHost32(sr->ssrc), lastSrLsr_);
 }
 
-void RtcpReceiverContext::OnRtp(uint16_t seq, uint32_t timestamp, uint64_t ntpTimestampMs, uint32_t sampleRate,
-                                size_t bytes)
+void RtcpReceiverContext::ProcessExtendedReport(const uint8_t *data, size_t size)
 {
-    RtcpContext::OnRtp(seq, timestamp, ntpTimestampMs, sampleRate, bytes);
+    RtcpXrReport report;
+    if (!RtcpXr::Parse(data, size, report)) {
+        LMRTSP_LOGW("Invalid XR packet: size=%zu", size);
+        return;
+    }
+
+    // RTT = now - time our reference time was sent - delay at the sender
+    for (const auto &item : report.dlrr) {
+        if (item.ssrc != rtcpSsrc_ || lastRrtMs_ == 0 || item.lastRr != lastRrtLrr_) {
+            continue;
+        }
+        uint64_t currentTimeMs = clock_->NowMs();
+        // DLRR is in units of 1/65536 seconds, rounded to the nearest ms
+        uint64_t dlrrMs = (static_cast<uint64_t>(item.delaySinceLastRr) * 1000 + 32768) / 65536;
+        if (currentTimeMs >= lastRrtMs_ + dlrrMs) {
+            uint32_t rttMs = static_cast<uint32_t>(currentTimeMs - lastRrtMs_ - dlrrMs);
+            xrRttMs_.store(rttMs, std::memory_order_relaxed);
+            LMRTSP_LOGD("RTT from DLRR: %u ms", rttMs);
+        }
+    }
+}
+
+void RtcpReceiverContext::OnRtp(uint16_t seq, uint32_t timestamp, int64_t timeNs, uint32_t sampleRate, size_t bytes)
+{
+    std::lock_guard<std::mutex> lock(stateMutex_);
+    RtcpContext::OnRtp(seq, timestamp, timeNs, sampleRate, bytes);
 
     if (!seqInitialized_) {
         InitSequence(seq);
@@ -340,7 +617,39 @@ void RtcpReceiverContext::OnRtp(uint16_t seq, uint32_t timestamp, uint64_t ntpTi
         UpdateSequence(seq);
     }
 
-    UpdateJitter(timestamp, ntpTimestampMs, sampleRate);
+    if (xrEnabled_) {
+        RecordXrPacket(seq);
+    }
+
+    UpdateJitter(timestamp, timeNs, sampleRate);
+}
+
+void RtcpReceiverContext::RecordXrPacket(uint16_t seq)
+{
+    // Extend against the highest sequence number, reordered and duplicate packets fall at or below it
+    int16_t delta = static_cast<int16_t>(seq - maxSeq_);
+    if (delta > 0 || delta < -static_cast<int32_t>(XR_MAX_SEQ_SPAN)) {
+        return; // Jump not accepted by UpdateSequence()
+    }
+    int64_t extended = static_cast<int64_t>((static_cast<uint32_t>(cycles_) << 16) | maxSeq_) + delta;
+    if (extended < static_cast<int64_t>(xrBeginSeq_)) {
+        return; // Already reported
+    }
+
+    size_t index = static_cast<size_t>(extended - xrBeginSeq_);
+    if (index >= XR_MAX_SEQ_SPAN) {
+        // Slide the interval, the oldest sequence numbers are not reported
+        size_t drop = std::min(index - XR_MAX_SEQ_SPAN + 1, xrCounts_.size());
+        xrCounts_.erase(xrCounts_.begin(), xrCounts_.begin() + static_cast<std::ptrdiff_t>(drop));
+        xrBeginSeq_ += static_cast<uint32_t>(index - XR_MAX_SEQ_SPAN + 1);
+        index = XR_MAX_SEQ_SPAN - 1;
+    }
+    if (index >= xrCounts_.size()) {
+        xrCounts_.resize(index + 1, 0);
+    }
+    if (xrCounts_[index] < UINT8_MAX) {
+        xrCounts_[index]++;
+    }
 }
 
 void RtcpReceiverContext::InitSequence(uint16_t seq)
@@ -350,6 +659,8 @@ void RtcpReceiverContext::InitSequence(uint16_t seq)
     lastSeq_ = seq;
     cycles_ = 0;
     seqInitialized_ = true;
+    xrBeginSeq_ = seq;
+    xrCounts_.clear();
     LMRTSP_LOGD("Initialized sequence tracking: baseSeq=%u", seq);
 }
 
@@ -381,29 +692,41 @@ void RtcpReceiverContext::UpdateSequence(uint16_t seq)
     lastSeq_ = seq;
 }
 
-void RtcpReceiverContext::UpdateJitter(uint32_t timestamp, uint64_t ntpTimestampMs, uint32_t sampleRate)
+void RtcpReceiverContext::UpdateJitter(uint32_t timestamp, int64_t arrivalNs, uint32_t sampleRate)
 {
-    if (lastArrivalTimeMs_ == 0) {
-        lastArrivalTimeMs_ = ntpTimestampMs;
+    if (!haveArrival_) {
+        haveArrival_ = true;
+        lastArrivalNs_ = arrivalNs;
+        lastArrivalRtpTs_ = timestamp;
         return;
     }
 
     // Calculate jitter according to RFC 3550
-    int64_t arrivalDiff = static_cast<int64_t>(ntpTimestampMs - lastArrivalTimeMs_);
-    int64_t timestampDiff = static_cast<int64_t>(timestamp - lastRtpTimestamp_);
+    int64_t arrivalDiff = arrivalNs - lastArrivalNs_;
+    int64_t timestampDiff = static_cast<int32_t>(timestamp - lastArrivalRtpTs_);
 
     // Convert to same units (timestamp units)
-    double arrivalDiffTimestamp = (arrivalDiff * sampleRate) / 1000.0;
+    double arrivalDiffTimestamp = (static_cast<double>(arrivalDiff) * sampleRate) / 1e9;
     double d = std::abs(arrivalDiffTimestamp - timestampDiff);
 
     // J(i) = J(i-1) + (|D(i-1,i)| - J(i-1))/16
     jitter_ += (d - jitter_) / 16.0;
 
-    lastArrivalTimeMs_ = ntpTimestampMs;
+    if (xrEnabled_) {
+        xrMinJitter_ = (xrJitterSamples_ == 0) ? d : std::min(xrMinJitter_, d);
+        xrMaxJitter_ = (xrJitterSamples_ == 0) ? d : std::max(xrMaxJitter_, d);
+        xrJitterSum_ += d;
+        xrJitterSquares_ += d * d;
+        xrJitterSamples_++;
+    }
+
+    lastArrivalNs_ = arrivalNs;
+    lastArrivalRtpTs_ = timestamp;
 }
 
 std::shared_ptr<lmcore::DataBuffer> RtcpReceiverContext::CreateRtcpRr()
 {
+    std::lock_guard<std::mutex> lock(stateMutex_);
     if (rtcpSsrc_ == 0 || rtpSsrc_ == 0) {
         LMRTSP_LOGE("RTCP context not initialized");
         return nullptr;
@@ -416,6 +739,7 @@ std::shared_ptr<lmcore::DataBuffer> RtcpReceiverContext::CreateRtcpRr()
 
     rr->ssrc = lmcore::ByteOrder::HostToNetwork32(rtcpSsrc_);
 
+    size_t lost = 0;
     auto blocks = rr->GetReportBlocks();
     if (!blocks.empty()) {
         auto *block = blocks[0];
@@ -430,7 +754,7 @@ std::shared_ptr<lmcore::DataBuffer> RtcpReceiverContext::CreateRtcpRr()
         // Calculate packet loss
         size_t expected = extendedMax - baseSeq_ + 1;
         size_t received = totalPackets_;
-        size_t lost = (expected > received) ? (expected - received) : 0;
+        lost = (expected > received) ? (expected - received) : 0;
 
         block->cumulativeLost = lmcore::ByteOrder::HostToNetwork32(static_cast<uint32_t>(lost) & 0xFFFFFF);
 
@@ -451,7 +775,7 @@ std::shared_ptr<lmcore::DataBuffer> RtcpReceiverContext::CreateRtcpRr()
         // LSR and DLSR
         block->lastSr = lmcore::ByteOrder::HostToNetwork32(lastSrLsr_);
         if (lastSrNtpMs_ > 0) {
-            uint64_t currentTimeMs = lmcore::TimeUtils::GetCurrentTimeMs();
+            uint64_t currentTimeMs = clock_->NowMs();
             uint64_t dlsrMs = currentTimeMs - lastSrNtpMs_;
             // Convert to 1/65536 seconds
             uint32_t dlsr = static_cast<uint32_t>((dlsrMs * 65536) / 1000);
@@ -470,13 +794,119 @@ std::shared_ptr<lmcore::DataBuffer> RtcpReceiverContext::CreateRtcpRr()
     auto buffer = lmcore::DataBuffer::Create(rrSize);
     buffer->Append(rr.get(), rrSize);
 
-    LMRTSP_LOGD("Created RR: SSRC=0x%08x, lost=%zu, jitter=%u", rtcpSsrc_, GetLost(), static_cast<uint32_t>(jitter_));
+    LMRTSP_LOGD("Created RR: SSRC=0x%08x, lost=%zu, jitter=%u", rtcpSsrc_, lost, static_cast<uint32_t>(jitter_));
+
+    return buffer;
+}
+
+std::shared_ptr<lmcore::DataBuffer> RtcpReceiverContext::CreateRtcpXr()
+{
+    if (!xrEnabled_ || rtcpSsrc_ == 0 || rtpSsrc_ == 0) {
+        return nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock(stateMutex_);
+    RtcpXrReport report;
+    report.ssrc = rtcpSsrc_;
+
+    // Receiver reference time, for the sender's DLRR
+    uint64_t currentTimeMs = clock_->NowMs();
+    uint64_t ntp = lmcore::TimeUtils::UnixToNtp(currentTimeMs);
+    report.hasReferenceTime = true;
+    report.referenceNtpH = static_cast<uint32_t>(ntp >> 32);
+    report.referenceNtpL = static_cast<uint32_t>(ntp & 0xFFFFFFFF);
+    lastRrtLrr_ = RtcpUtils::GetLsrFromNtp(report.referenceNtpH, report.referenceNtpL);
+    lastRrtMs_ = currentTimeMs;
+
+    // Loss, duplicates and jitter of the packets received since the last XR
+    if (!xrCounts_.empty()) {
+        XrRleReport loss;
+        loss.ssrc = rtpSsrc_;
+        loss.beginSeq = static_cast<uint16_t>(xrBeginSeq_);
+        loss.endSeq = static_cast<uint16_t>(xrBeginSeq_ + xrCounts_.size());
+        XrRleReport dup = loss;
+
+        XrStatisticsSummary summary;
+        summary.ssrc = rtpSsrc_;
+        summary.beginSeq = loss.beginSeq;
+        summary.endSeq = loss.endSeq;
+        summary.hasLoss = true;
+        summary.hasDup = true;
+        for (uint8_t count : xrCounts_) {
+            loss.flags.push_back(count > 0);
+            dup.flags.push_back(count > 1);
+            summary.lostPackets += (count == 0) ? 1 : 0;
+            summary.dupPackets += (count > 1) ? count - 1 : 0;
+        }
+
+        if (xrJitterSamples_ > 0) {
+            double mean = xrJitterSum_ / xrJitterSamples_;
+            double variance = std::max(0.0, xrJitterSquares_ / xrJitterSamples_ - mean * mean);
+            summary.hasJitter = true;
+            summary.minJitter = static_cast<uint32_t>(xrMinJitter_);
+            summary.maxJitter = static_cast<uint32_t>(xrMaxJitter_);
+            summary.meanJitter = static_cast<uint32_t>(mean);
+            summary.devJitter = static_cast<uint32_t>(std::sqrt(variance));
+        }
+
+        report.lossRle.push_back(std::move(loss));
+        report.dupRle.push_back(std::move(dup));
+        report.statisticsSummary.push_back(summary);
+
+        // Next interval starts after the highest sequence number reported
+        xrBeginSeq_ += static_cast<uint32_t>(xrCounts_.size());
+        xrCounts_.clear();
+        xrJitterSamples_ = 0;
+        xrJitterSum_ = 0.0;
+        xrJitterSquares_ = 0.0;
+    }
+
+    auto xr = RtcpXr::Create(report);
+    if (!xr) {
+        return nullptr;
+    }
+
+    size_t xrSize = xr->GetSize();
+    auto buffer = lmcore::DataBuffer::Create(xrSize);
+    buffer->Append(xr.get(), xrSize);
+
+    LMRTSP_LOGD("Created XR: SSRC=0x%08x, size=%zu", rtcpSsrc_, xrSize);
+    return buffer;
+}
+
+std::shared_ptr<lmcore::DataBuffer> RtcpReceiverContext::CreateNack(const std::vector<uint16_t> &lostSeqs)
+{
+    if (rtcpSsrc_ == 0 || rtpSsrc_ == 0 || lostSeqs.empty()) {
+        return nullptr;
+    }
+
+    auto nack = RtcpFeedback::CreateNack(rtcpSsrc_, rtpSsrc_, lostSeqs);
+    size_t nackSize = nack->GetSize();
+    auto buffer = lmcore::DataBuffer::Create(nackSize);
+    buffer->Append(nack.get(), nackSize);
+
+    LMRTSP_LOGD("Created NACK: SSRC=0x%08x, lost=%zu, size=%zu", rtcpSsrc_, lostSeqs.size(), nackSize);
+    return buffer;
+}
+
+std::shared_ptr<lmcore::DataBuffer> RtcpReceiverContext::CreatePli()
+{
+    if (rtcpSsrc_ == 0 || rtpSsrc_ == 0) {
+        return nullptr;
+    }
+
+    auto pli = RtcpFeedback::CreatePli(rtcpSsrc_, rtpSsrc_);
+    size_t pliSize = pli->GetSize();
+    auto buffer = lmcore::DataBuffer::Create(pliSize);
+    buffer->Append(pli.get(), pliSize);
 
+    LMRTSP_LOGD("Created PLI: SSRC=0x%08x, media SSRC=0x%08x", rtcpSsrc_, rtpSsrc_);
     return buffer;
 }
 
 size_t RtcpReceiverContext::GetLost() const
 {
+    std::lock_guard<std::mutex> lock(stateMutex_);
     if (!seqInitialized_) {
         return 0;
     }
@@ -490,6 +920,7 @@ size_t RtcpReceiverContext::GetLost() const
 
 size_t RtcpReceiverContext::GetLostInterval() const
 {
+    std::lock_guard<std::mutex> lock(stateMutex_);
     if (!seqInitialized_) {
         return 0;
     }
@@ -504,6 +935,7 @@ size_t RtcpReceiverContext::GetLostInterval() const
 
 size_t RtcpReceiverContext::GetExpectedPackets() const
 {
+    std::lock_guard<std::mutex> lock(stateMutex_);
     if (!seqInitialized_) {
         return 0;
     }
@@ -514,6 +946,7 @@ size_t RtcpReceiverContext::GetExpectedPackets() const
 
 size_t RtcpReceiverContext::GetExpectedPacketsInterval() const
 {
+    std::lock_guard<std::mutex> lock(stateMutex_);
     if (!seqInitialized_) {
         return 0;
     }
@@ -536,6 +969,7 @@ double RtcpReceiverContext::GetLossRate() const
 
 uint32_t RtcpReceiverContext::GetJitter() const
 {
+    std::lock_guard<std::mutex> lock(stateMutex_);
     return static_cast<uint32_t>(jitter_);
 }
 
@@ -11,6 +11,7 @@
 #include <lmcore/byte_order.h>
 #include <lmcore/time_utils.h>
 
+#include <algorithm>
 #include <cstring>
 
 namespace lmshao::lmrtsp {
@@ -32,6 +33,85 @@ uint64_t NtpToUnixMs(uint32_t ntpH, uint32_t ntpL)
     return static_cast<uint64_t>(lmcore::TimeUtils::NtpToUnix(ntp));
 }
 
+// RFC 3611 4.1: runs of 15 or more equal flags become run length chunks, the rest 15-bit vector chunks
+std::vector<uint16_t> EncodeRle(const std::vector<bool> &flags)
+{
+    std::vector<uint16_t> chunks;
+    size_t i = 0;
+    while (i < flags.size()) {
+        size_t run = 1;
+        while (i + run < flags.size() && flags[i + run] == flags[i] && run < 0x3FFF) {
+            run++;
+        }
+        if (run >= 15 || i + run == flags.size()) {
+            chunks.push_back(static_cast<uint16_t>((flags[i] ? 0x4000 : 0) | run));
+            i += run;
+            continue;
+        }
+
+        uint16_t vector = 0x8000;
+        for (size_t bit = 0; bit < 15 && i < flags.size(); ++bit, ++i) {
+            if (flags[i]) {
+                vector |= static_cast<uint16_t>(1 << (14 - bit));
+            }
+        }
+        chunks.push_back(vector);
+    }
+
+    // Null chunk to end on a 32-bit boundary
+    if (chunks.size() % 2 != 0) {
+        chunks.push_back(0);
+    }
+    return chunks;
+}
+
+bool DecodeRle(const uint8_t *chunks, size_t size, XrRleReport &report)
+{
+    size_t span = static_cast<uint16_t>(report.endSeq - report.beginSeq);
+    report.flags.clear();
+    report.flags.reserve(span);
+
+    for (size_t offset = 0; offset + 2 <= size && report.flags.size() < span; offset += 2) {
+        uint16_t chunk = lmcore::ByteOrder::ReadBE16(chunks + offset);
+        if (chunk == 0) {
+            break; // Terminating null chunk
+        }
+
+        size_t remaining = span - report.flags.size();
+        if ((chunk & 0x8000) == 0) {
+            size_t run = std::min<size_t>(chunk & 0x3FFF, remaining);
+            report.flags.insert(report.flags.end(), run, (chunk & 0x4000) != 0);
+        } else {
+            for (size_t bit = 0; bit < 15 && bit < remaining; ++bit) {
+                report.flags.push_back((chunk & (1 << (14 - bit))) != 0);
+            }
+        }
+    }
+    return report.flags.size() == span;
+}
+
+uint8_t *WriteXrBlockHeader(uint8_t *ptr, XrBlockType type, uint8_t typeSpecific, size_t blockSize)
+{
+    ptr[0] = static_cast<uint8_t>(type);
+    ptr[1] = typeSpecific;
+    lmcore::ByteOrder::WriteBE16(ptr + 2, static_cast<uint16_t>(blockSize / 4 - 1));
+    return ptr + RTCP_XR_BLOCK_HEADER_SIZE;
+}
+
+uint8_t *WriteRleBlock(uint8_t *ptr, XrBlockType type, const XrRleReport &rle, const std::vector<uint16_t> &chunks)
+{
+    ptr = WriteXrBlockHeader(ptr, type, 0, 12 + chunks.size() * 2); // Thinning T = 0
+    lmcore::ByteOrder::WriteBE32(ptr, rle.ssrc);
+    lmcore::ByteOrder::WriteBE16(ptr + 4, rle.beginSeq);
+    lmcore::ByteOrder::WriteBE16(ptr + 6, rle.endSeq);
+    ptr += 8;
+    for (uint16_t chunk : chunks) {
+        lmcore::ByteOrder::WriteBE16(ptr, chunk);
+        ptr += 2;
+    }
+    return ptr;
+}
+
 } // anonymous namespace
 
 void RtcpHeader::SetSize(size_t sizeBytes)
@@ -351,9 +431,246 @@ std::shared_ptr<RtcpFeedback> RtcpFeedback::CreateRtpfb(RtpfbType fmt, const voi
     return fb;
 }
 
+std::shared_ptr<RtcpFeedback> RtcpFeedback::CreateNack(uint32_t senderSsrcValue, uint32_t mediaSsrcValue,
+                                                       const std::vector<uint16_t> &lostSeqs)
+{
+    if (lostSeqs.empty()) {
+        return nullptr;
+    }
+
+    // Sort in wrap-around order, each item then covers its PID and the 16 sequence numbers after it
+    uint16_t base = lostSeqs.front();
+    std::vector<uint16_t> seqs(lostSeqs);
+    std::sort(seqs.begin(), seqs.end(), [base](uint16_t a, uint16_t b) {
+        return static_cast<int16_t>(a - base) < static_cast<int16_t>(b - base);
+    });
+
+    std::vector<NackItem> items;
+    uint16_t pid = seqs.front();
+    uint16_t blp = 0;
+    for (size_t i = 1; i < seqs.size(); ++i) {
+        uint16_t offset = static_cast<uint16_t>(seqs[i] - pid);
+        if (offset == 0) {
+            continue;
+        }
+        if (offset <= 16) {
+            blp |= static_cast<uint16_t>(1 << (offset - 1));
+            continue;
+        }
+        items.emplace_back(pid, blp);
+        pid = seqs[i];
+        blp = 0;
+    }
+    items.emplace_back(pid, blp);
+
+    auto fb = CreateRtpfb(RtpfbType::NACK, items.data(), items.size() * sizeof(NackItem));
+    fb->senderSsrc = lmcore::ByteOrder::HostToNetwork32(senderSsrcValue);
+    fb->mediaSsrc = lmcore::ByteOrder::HostToNetwork32(mediaSsrcValue);
+    return fb;
+}
+
+std::shared_ptr<RtcpFeedback> RtcpFeedback::CreatePli(uint32_t senderSsrcValue, uint32_t mediaSsrcValue)
+{
+    auto fb = CreatePsfb(PsfbType::PLI);
+    fb->senderSsrc = lmcore::ByteOrder::HostToNetwork32(senderSsrcValue);
+    fb->mediaSsrc = lmcore::ByteOrder::HostToNetwork32(mediaSsrcValue);
+    return fb;
+}
+
+std::vector<uint16_t> RtcpFeedback::GetNackSequences() const
+{
+    std::vector<uint16_t> seqs;
+    const uint8_t *fci = GetFci();
+    size_t itemCount = GetFciSize() / sizeof(NackItem);
+    for (size_t i = 0; i < itemCount; ++i) {
+        uint16_t fields[2];
+        memcpy(fields, fci + i * sizeof(NackItem), sizeof(fields));
+        uint16_t pid = lmcore::ByteOrder::NetworkToHost16(fields[0]);
+        uint16_t blp = lmcore::ByteOrder::NetworkToHost16(fields[1]);
+        seqs.push_back(pid);
+        for (uint16_t bit = 0; bit < 16; ++bit) {
+            if (blp & (1 << bit)) {
+                seqs.push_back(static_cast<uint16_t>(pid + bit + 1));
+            }
+        }
+    }
+    return seqs;
+}
+
 NackItem::NackItem(uint16_t packetId, uint16_t bitmask)
-    : pid(lmcore::ByteOrder::HostToNetwork16(packetId)), blp(bitmask)
+    : pid(lmcore::ByteOrder::HostToNetwork16(packetId)), blp(lmcore::ByteOrder::HostToNetwork16(bitmask))
+{
+}
+
+std::shared_ptr<RtcpXr> RtcpXr::Create(const RtcpXrReport &report)
+{
+    std::vector<std::vector<uint16_t>> lossChunks;
+    std::vector<std::vector<uint16_t>> dupChunks;
+    size_t totalSize = sizeof(RtcpXr);
+    for (const auto &rle : report.lossRle) {
+        lossChunks.push_back(EncodeRle(rle.flags));
+        totalSize += 12 + lossChunks.back().size() * 2;
+    }
+    for (const auto &rle : report.dupRle) {
+        dupChunks.push_back(EncodeRle(rle.flags));
+        totalSize += 12 + dupChunks.back().size() * 2;
+    }
+    if (report.hasReferenceTime) {
+        totalSize += 12;
+    }
+    if (!report.dlrr.empty()) {
+        totalSize += RTCP_XR_BLOCK_HEADER_SIZE + report.dlrr.size() * 12;
+    }
+    totalSize += report.statisticsSummary.size() * 40;
+
+    auto xr = std::shared_ptr<RtcpXr>(reinterpret_cast<RtcpXr *>(new uint8_t[totalSize]),
+                                      [](RtcpXr *p) { delete[] reinterpret_cast<uint8_t *>(p); });
+
+    memset(xr.get(), 0, totalSize);
+    xr->version = RTCP_VERSION;
+    xr->padding = 0;
+    xr->count = 0; // Reserved in XR
+    xr->packetType = static_cast<uint8_t>(RtcpType::XR);
+    xr->SetSize(totalSize);
+    xr->ssrc = lmcore::ByteOrder::HostToNetwork32(report.ssrc);
+
+    uint8_t *ptr = reinterpret_cast<uint8_t *>(xr.get()) + sizeof(RtcpXr);
+    for (size_t i = 0; i < report.lossRle.size(); ++i) {
+        ptr = WriteRleBlock(ptr, XrBlockType::LOSS_RLE, report.lossRle[i], lossChunks[i]);
+    }
+    for (size_t i = 0; i < report.dupRle.size(); ++i) {
+        ptr = WriteRleBlock(ptr, XrBlockType::DUPLICATE_RLE, report.dupRle[i], dupChunks[i]);
+    }
+
+    if (report.hasReferenceTime) {
+        ptr = WriteXrBlockHeader(ptr, XrBlockType::RECEIVER_REFERENCE_TIME, 0, 12);
+        lmcore::ByteOrder::WriteBE32(ptr, report.referenceNtpH);
+        lmcore::ByteOrder::WriteBE32(ptr + 4, report.referenceNtpL);
+        ptr += 8;
+    }
+
+    if (!report.dlrr.empty()) {
+        ptr = WriteXrBlockHeader(ptr, XrBlockType::DLRR, 0, RTCP_XR_BLOCK_HEADER_SIZE + report.dlrr.size() * 12);
+        for (const auto &item : report.dlrr) {
+            lmcore::ByteOrder::WriteBE32(ptr, item.ssrc);
+            lmcore::ByteOrder::WriteBE32(ptr + 4, item.lastRr);
+            lmcore::ByteOrder::WriteBE32(ptr + 8, item.delaySinceLastRr);
+            ptr += 12;
+        }
+    }
+
+    for (const auto &summary : report.statisticsSummary) {
+        // L, D and J flags, ToH = 0 as no TTL or hop limit is reported
+        uint8_t flags = (summary.hasLoss ? 0x80 : 0) | (summary.hasDup ? 0x40 : 0) | (summary.hasJitter ? 0x20 : 0);
+        ptr = WriteXrBlockHeader(ptr, XrBlockType::STATISTICS_SUMMARY, flags, 40);
+        lmcore::ByteOrder::WriteBE32(ptr, summary.ssrc);
+        lmcore::ByteOrder::WriteBE16(ptr + 4, summary.beginSeq);
+        lmcore::ByteOrder::WriteBE16(ptr + 6, summary.endSeq);
+        lmcore::ByteOrder::WriteBE32(ptr + 8, summary.lostPackets);
+        lmcore::ByteOrder::WriteBE32(ptr + 12, summary.dupPackets);
+        lmcore::ByteOrder::WriteBE32(ptr + 16, summary.minJitter);
+        lmcore::ByteOrder::WriteBE32(ptr + 20, summary.maxJitter);
+        lmcore::ByteOrder::WriteBE32(ptr + 24, summary.meanJitter);
+        lmcore::ByteOrder::WriteBE32(ptr + 28, summary.devJitter);
+        ptr += 36; // TTL fields stay zero
+    }
+
+    return xr;
+}
+
+bool RtcpXr::Parse(const uint8_t *data, size_t size, RtcpXrReport &report)
 {
+    if (!data || size < sizeof(RtcpXr)) {
+        return false;
+    }
+
+    const auto *xr = reinterpret_cast<const RtcpXr *>(data);
+    if (xr->version != RTCP_VERSION || xr->packetType != static_cast<uint8_t>(RtcpType::XR) || xr->GetSize() > size) {
+        return false;
+    }
+
+    size_t packetSize = xr->GetSize();
+    if (xr->padding) {
+        size_t paddingSize = xr->GetPaddingSize();
+        if (paddingSize > packetSize - sizeof(RtcpXr)) {
+            return false;
+        }
+        packetSize -= paddingSize;
+    }
+
+    report = RtcpXrReport();
+    report.ssrc = lmcore::ByteOrder::NetworkToHost32(xr->ssrc);
+
+    size_t offset = sizeof(RtcpXr);
+    while (offset + RTCP_XR_BLOCK_HEADER_SIZE <= packetSize) {
+        const uint8_t *block = data + offset;
+        auto type = static_cast<XrBlockType>(block[0]);
+        uint8_t typeSpecific = block[1];
+        size_t blockSize = (static_cast<size_t>(lmcore::ByteOrder::ReadBE16(block + 2)) + 1) * 4;
+        if (offset + blockSize > packetSize) {
+            return false;
+        }
+        const uint8_t *body = block + RTCP_XR_BLOCK_HEADER_SIZE;
+        size_t bodySize = blockSize - RTCP_XR_BLOCK_HEADER_SIZE;
+
+        switch (type) {
+            case XrBlockType::LOSS_RLE:
+            case XrBlockType::DUPLICATE_RLE: {
+                // Thinned reports skip sequence numbers and are not decoded
+                if (bodySize < 8 || (typeSpecific & 0x0F) != 0) {
+                    break;
+                }
+                XrRleReport rle;
+                rle.ssrc = lmcore::ByteOrder::ReadBE32(body);
+                rle.beginSeq = lmcore::ByteOrder::ReadBE16(body + 4);
+                rle.endSeq = lmcore::ByteOrder::ReadBE16(body + 6);
+                if (DecodeRle(body + 8, bodySize - 8, rle)) {
+                    (type == XrBlockType::LOSS_RLE ? report.lossRle : report.dupRle).push_back(std::move(rle));
+                }
+                break;
+            }
+            case XrBlockType::RECEIVER_REFERENCE_TIME:
+                if (bodySize >= 8) {
+                    report.hasReferenceTime = true;
+                    report.referenceNtpH = lmcore::ByteOrder::ReadBE32(body);
+                    report.referenceNtpL = lmcore::ByteOrder::ReadBE32(body + 4);
+                }
+                break;
+            case XrBlockType::DLRR:
+                for (size_t item = 0; item + 12 <= bodySize; item += 12) {
+                    XrDlrrItem dlrr;
+                    dlrr.ssrc = lmcore::ByteOrder::ReadBE32(body + item);
+                    dlrr.lastRr = lmcore::ByteOrder::ReadBE32(body + item + 4);
+                    dlrr.delaySinceLastRr = lmcore::ByteOrder::ReadBE32(body + item + 8);
+                    report.dlrr.push_back(dlrr);
+                }
+                break;
+            case XrBlockType::STATISTICS_SUMMARY:
+                if (bodySize >= 36) {
+                    XrStatisticsSummary summary;
+                    summary.hasLoss = (typeSpecific & 0x80) != 0;
+                    summary.hasDup = (typeSpecific & 0x40) != 0;
+                    summary.hasJitter = (typeSpecific & 0x20) != 0;
+                    summary.ssrc = lmcore::ByteOrder::ReadBE32(body);
+                    summary.beginSeq = lmcore::ByteOrder::ReadBE16(body + 4);
+                    summary.endSeq = lmcore::ByteOrder::ReadBE16(body + 6);
+                    summary.lostPackets = lmcore::ByteOrder::ReadBE32(body + 8);
+                    summary.dupPackets = lmcore::ByteOrder::ReadBE32(body + 12);
+                    summary.minJitter = lmcore::ByteOrder::ReadBE32(body + 16);
+                    summary.maxJitter = lmcore::ByteOrder::ReadBE32(body + 20);
+                    summary.meanJitter = lmcore::ByteOrder::ReadBE32(body + 24);
+                    summary.devJitter = lmcore::ByteOrder::ReadBE32(body + 28);
+                    report.statisticsSummary.push_back(summary);
+                }
+                break;
+            default:
+                break; // Packet receipt times, VoIP metrics and unknown blocks
+        }
+
+        offset += blockSize;
+    }
+
+    return true;
 }
 
 namespace RtcpUtils {
@@ -0,0 +1,190 @@
+/**
+ * @author SHAO Liming <lmshao@163.com>
+ * @copyright Copyright (c) 2025 SHAO Liming
+ * @license MIT
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "lmrtsp/egress_shaper.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "lmrtsp/ts_parser.h"
+
+namespace lmshao::lmrtsp {
+
+static constexpr size_t TS_PACKET_SIZE = 188;
+static constexpr uint16_t TS_NULL_PID = 0x1FFF;
+
+TokenBucket::TokenBucket(uint64_t rate_bps, uint32_t burst_ms)
+    : rateBps_(rate_bps), burstBytes_(static_cast<int64_t>(rate_bps / 8 * burst_ms / 1000)), tokens_(burstBytes_)
+{
+}
+
+void TokenBucket::Refill(int64_t now_ns)
+{
+    if (lastNs_ >= 0 && now_ns > lastNs_) {
+        // Intervals too short to earn a whole byte are not lost, lastNs_ only advances once one is earned
+        int64_t elapsed = now_ns - lastNs_;
+        int64_t bytes = static_cast<int64_t>(static_cast<double>(rateBps_) * elapsed / 8e9);
+        if (bytes == 0) {
+            return;
+        }
+        tokens_ = std::min(tokens_ + bytes, burstBytes_);
+    }
+    lastNs_ = std::max(lastNs_, now_ns);
+}
+
+bool TokenBucket::Fits(size_t bytes, int64_t now_ns, int64_t allowance)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    Refill(now_ns);
+    return tokens_ - static_cast<int64_t>(bytes) >= -allowance;
+}
+
+void TokenBucket::Consume(size_t bytes, int64_t now_ns)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    Refill(now_ns);
+    tokens_ -= static_cast<int64_t>(bytes);
+}
+
+EgressShaper::EgressShaper(std::shared_ptr<TokenBucket> session_bucket, std::shared_ptr<TokenBucket> client_bucket)
+    : sessionBucket_(std::move(session_bucket)), clientBucket_(std::move(client_bucket))
+{
+}
+
+bool EgressShaper::Admit(const MediaFrame &frame, size_t bytes)
+{
+    int64_t now = clock_->MonotonicNs();
+
+    if (frame.media_type == MediaType::MP2T) {
+        return AdmitTransportStream(frame, bytes, now);
+    }
+
+    bool video = frame.media_type == MediaType::H264 || frame.media_type == MediaType::H265;
+    if (!video || frame.video_param.frame_type == FrameType::UNKNOWN) {
+        Consume(bytes, now);
+        return true;
+    }
+
+    const VideoParam &param = frame.video_param;
+    if (param.is_key_frame || param.frame_type == FrameType::IDR) {
+        // Key frames resynchronize the decoder, the caps catch up on the following frames
+        waitKeyFrame_ = false;
+        Consume(bytes, now);
+        return true;
+    }
+
+    if (waitKeyFrame_) {
+        return Drop(bytes, true);
+    }
+
+    if (!param.is_reference) {
+        if (!Fits(bytes, now, false)) {
+            return Drop(bytes, false);
+        }
+    } else if (!Fits(bytes, now, true)) {
+        waitKeyFrame_ = true;
+        return Drop(bytes, true);
+    }
+
+    Consume(bytes, now);
+    return true;
+}
+
+EgressStats EgressShaper::GetStats() const
+{
+    EgressStats stats;
+    stats.sent_frames = sentFrames_.load(std::memory_order_relaxed);
+    stats.sent_bytes = sentBytes_.load(std::memory_order_relaxed);
+    stats.dropped_non_reference = droppedNonReference_.load(std::memory_order_relaxed);
+    stats.dropped_until_key_frame = droppedUntilKeyFrame_.load(std::memory_order_relaxed);
+    stats.dropped_frames = stats.dropped_non_reference + stats.dropped_until_key_frame;
+    stats.dropped_bytes = droppedBytes_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+bool EgressShaper::AdmitTransportStream(const MediaFrame &frame, size_t bytes, int64_t now_ns)
+{
+    const uint8_t *data = frame.data ? frame.data->Data() : nullptr;
+    size_t size = frame.data ? frame.data->Size() : 0;
+
+    std::vector<TSPacketInfo> packets;
+    for (size_t offset = 0; data && offset + TS_PACKET_SIZE <= size; offset += TS_PACKET_SIZE) {
+        TSPacketInfo info;
+        if (TSParser::ParsePacket(data + offset, info) && info.pid != TS_NULL_PID) {
+            packets.push_back(info);
+        }
+    }
+
+    // A PES start needs room under the caps, the tail of a PES that was cut cannot go out at all
+    bool starts = false;
+    bool cut = false;
+    for (size_t i = 0; i < packets.size(); ++i) {
+        if (packets[i].pes_start) {
+            starts = true;
+            continue;
+        }
+        bool startedHere = std::any_of(packets.begin(), packets.begin() + i, [&](const TSPacketInfo &earlier) {
+            return earlier.pid == packets[i].pid && earlier.payload_unit_start;
+        });
+        if (!packets[i].payload_unit_start && !startedHere && droppingPids_.count(packets[i].pid)) {
+            cut = true;
+        }
+    }
+
+    if (!cut && (!starts || Fits(bytes, now_ns, false))) {
+        for (const auto &info : packets) {
+            if (info.payload_unit_start) {
+                droppingPids_.erase(info.pid);
+            }
+        }
+        Consume(bytes, now_ns);
+        return true;
+    }
+
+    // Every PES and section touched by the chunk is now incomplete, skip its PID up to the next unit start
+    for (const auto &info : packets) {
+        droppingPids_.insert(info.pid);
+    }
+    return Drop(bytes, false);
+}
+
+bool EgressShaper::Fits(size_t bytes, int64_t now_ns, bool borrow) const
+{
+    // Both caps must hold, a reference frame may run one burst into debt on each
+    if (sessionBucket_ && !sessionBucket_->Fits(bytes, now_ns, borrow ? sessionBucket_->GetBurstBytes() : 0)) {
+        return false;
+    }
+    return !clientBucket_ || clientBucket_->Fits(bytes, now_ns, borrow ? clientBucket_->GetBurstBytes() : 0);
+}
+
+void EgressShaper::Consume(size_t bytes, int64_t now_ns)
+{
+    if (sessionBucket_) {
+        sessionBucket_->Consume(bytes, now_ns);
+    }
+    if (clientBucket_) {
+        clientBucket_->Consume(bytes, now_ns);
+    }
+    // Counted here, every sent frame is charged exactly once
+    sentFrames_.fetch_add(1, std::memory_order_relaxed);
+    sentBytes_.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+bool EgressShaper::Drop(size_t bytes, bool reference)
+{
+    if (reference) {
+        droppedUntilKeyFrame_.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        droppedNonReference_.fetch_add(1, std::memory_order_relaxed);
+    }
+    droppedBytes_.fetch_add(bytes, std::memory_order_relaxed);
+    return false;
+}
+
+} // namespace lmshao::lmrtsp
@@ -12,6 +12,7 @@
 #include <cstdint>
 #include <string>
 
+#include "lmrtsp/priority_send_queue.h"
 #include "lmrtsp/transport_config.h"
 
 namespace lmshao::lmrtsp {
@@ -23,9 +24,26 @@ public:
     virtual bool Setup(const TransportConfig &config) = 0;
     virtual bool SendPacket(const uint8_t *data, size_t size) = 0;
     virtual bool SendRtcpPacket(const uint8_t *data, size_t size) = 0;
+    // Called once per frame after all its packets were handed to SendPacket; batching backends submit here
+    virtual void Flush() {}
+    // Priority of the packets handed to SendPacket until the next call; transports sharing a link schedule by it
+    virtual void SetSendPriority(SendPriority priority) { (void)priority; }
+    // Departure of the packets handed to SendPacket until Flush, spread evenly over spanNs from startNs in
+    // Clock::MonotonicNs() time; the kernel holds them until then. Ignored unless HasKernelPacing()
+    virtual void SetDeparture(int64_t startNs, int64_t spanNs)
+    {
+        (void)startNs;
+        (void)spanNs;
+    }
+    // Whether packets may be handed over before they are due, otherwise the caller paces in userspace
+    virtual bool HasKernelPacing() const { return false; }
     virtual void Close() = 0;
     virtual std::string GetTransportInfo() const = 0;
     virtual bool IsActive() const = 0;
+    // Approximate memory held by the transport in bytes, kernel socket buffers excluded
+    virtual size_t GetMemoryUsage() const { return 0; }
+    // Bytes of sent RTP waiting in the kernel socket send buffer, 0 where unknown
+    virtual size_t GetSendQueueBytes() const { return 0; }
 };
 
 } // namespace lmshao::lmrtsp
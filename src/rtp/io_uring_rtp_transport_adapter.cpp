@@ -0,0 +1,616 @@
+/**
+ * @author SHAO Liming <lmshao@163.com>
+ * @copyright Copyright (c) 2025 SHAO Liming
+ * @license MIT
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifdef LMRTSP_ENABLE_IO_URING
+
+#include "io_uring_rtp_transport_adapter.h"
+
+#include <arpa/inet.h>
+#include <lmcore/data_buffer.h>
+#include <lmnet/udp_server.h>
+#include <netinet/in.h>
+#include <sys/uio.h>
+#include <sys/utsname.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+
+#include "internal_logger.h"
+#include "lmrtsp/cpu_affinity.h"
+
+namespace lmshao::lmrtsp {
+
+void IoUringRtpTransportAdapter::RtcpClientListener::OnReceive(lmnet::socket_t fd,
+                                                              std::shared_ptr<lmnet::DataBuffer> buffer)
+{
+    if (adapter_ && adapter_->listener_) {
+        adapter_->listener_->OnRtcpDataReceived(buffer);
+    }
+}
+
+void IoUringRtpTransportAdapter::RtcpClientListener::OnError(lmnet::socket_t fd, const std::string &errorInfo)
+{
+    LMRTSP_LOGE("io_uring adapter RTCP client error: fd %d, %s", fd, errorInfo.c_str());
+}
+
+IoUringRtpTransportAdapter::IoUringRtpTransportAdapter() {}
+
+IoUringRtpTransportAdapter::~IoUringRtpTransportAdapter()
+{
+    Close();
+}
+
+bool IoUringRtpTransportAdapter::IsSupported(TransportConfig::Mode mode)
+{
+    struct io_uring ring;
+    if (io_uring_queue_init(4, &ring, 0) < 0) {
+        return false;
+    }
+
+    bool supported = false;
+    struct io_uring_probe *probe = io_uring_get_probe_ring(&ring);
+    if (probe) {
+        supported = io_uring_opcode_supported(probe, IORING_OP_WRITE_FIXED) &&
+                    io_uring_opcode_supported(probe, IORING_OP_RECVMSG);
+        io_uring_free_probe(probe);
+    }
+    io_uring_queue_exit(&ring);
+
+    // Multishot recvmsg has no probe bit, it arrived together with provided buffer rings in 6.0
+    if (supported && mode == TransportConfig::Mode::SINK) {
+        struct utsname name;
+        int major = 0;
+        if (uname(&name) != 0 || sscanf(name.release, "%d", &major) != 1 || major < 6) {
+            supported = false;
+        }
+    }
+
+    return supported;
+}
+
+bool IoUringRtpTransportAdapter::Setup(const TransportConfig &config)
+{
+    config_ = config;
+
+    client_ip_ = config.client_ip;
+    clientRtpPort_ = config.client_rtp_port;
+    clientRtcpPort_ = config.client_rtcp_port;
+    serverRtpPort_ = config.server_rtp_port;
+    serverRtcpPort_ = config.server_rtcp_port;
+
+    LMRTSP_LOGD("io_uring adapter Setup: mode=%s, client=%s:%u/%u, server=%u/%u",
+                config_.mode == TransportConfig::Mode::SOURCE ? "SOURCE" : "SINK", client_ip_.c_str(), clientRtpPort_,
+                clientRtcpPort_, serverRtpPort_, serverRtcpPort_);
+
+    if (!AllocatePorts()) {
+        return false;
+    }
+
+    bool success = false;
+    if (config_.mode == TransportConfig::Mode::SOURCE) {
+        success = InitializeSendRing();
+    } else {
+        success = InitializeRecvRing();
+    }
+
+    if (success) {
+        active_ = true;
+        LMRTSP_LOGI("io_uring RTP transport adapter setup successfully (RTCP %s)",
+                    IsRtcpEnabled() ? "enabled" : "disabled");
+    } else {
+        LMRTSP_LOGE("Failed to setup io_uring RTP transport adapter");
+        Close();
+    }
+
+    return success;
+}
+
+bool IoUringRtpTransportAdapter::SendPacket(const uint8_t *data, size_t size)
+{
+    if (!active_ || config_.mode != TransportConfig::Mode::SOURCE) {
+        LMRTSP_LOGE("io_uring transport not active for sending");
+        return false;
+    }
+
+    if (!data || size == 0 || size > SEND_SLOT_SIZE) {
+        LMRTSP_LOGE("Invalid RTP data, size=%zu", size);
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(sendMutex_);
+
+    int slot = AcquireSendSlot();
+    if (slot < 0) {
+        LMRTSP_LOGE("No io_uring send slot available");
+        return false;
+    }
+
+    uint8_t *buf = sendSlab_.data() + static_cast<size_t>(slot) * SEND_SLOT_SIZE;
+    memcpy(buf, data, size);
+
+    struct io_uring_sqe *sqe = io_uring_get_sqe(&sendRing_);
+    if (!sqe) {
+        // Submission queue is full, push what we have and retry once
+        io_uring_submit(&sendRing_);
+        pending_ = 0;
+        sqe = io_uring_get_sqe(&sendRing_);
+        if (!sqe) {
+            freeSlots_.push_back(static_cast<uint16_t>(slot));
+            LMRTSP_LOGE("io_uring submission queue exhausted");
+            return false;
+        }
+    }
+
+    int fd = fixedFiles_ ? RTP_FILE_INDEX : rtpFd_;
+    if (fixedBuffers_) {
+        io_uring_prep_write_fixed(sqe, fd, buf, static_cast<unsigned>(size), 0, slot);
+    } else {
+        io_uring_prep_write(sqe, fd, buf, static_cast<unsigned>(size), 0);
+    }
+    if (fixedFiles_) {
+        sqe->flags |= IOSQE_FIXED_FILE;
+    }
+    io_uring_sqe_set_data64(sqe, static_cast<uint64_t>(slot));
+    pending_++;
+
+    return true;
+}
+
+bool IoUringRtpTransportAdapter::SendRtcpPacket(const uint8_t *data, size_t size)
+{
+    if (!active_ || !IsRtcpEnabled()) {
+        LMRTSP_LOGE("RTCP is not available on io_uring transport");
+        return false;
+    }
+
+    if (!data || size == 0) {
+        LMRTSP_LOGE("Invalid RTCP data");
+        return false;
+    }
+
+    // RTCP is a few packets per second, a plain send keeps the timer thread off the RTP ring
+    bool sent = false;
+    if (rtcpClient_) {
+        sent = rtcpClient_->Send(data, size);
+    } else if (rtcpFd_ >= 0) {
+        sent = ::send(rtcpFd_, data, size, 0) == static_cast<ssize_t>(size);
+    }
+    if (!sent) {
+        LMRTSP_LOGE("Failed to send RTCP packet to %s:%u, size=%zu: %s", client_ip_.c_str(), clientRtcpPort_, size,
+                    strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+void IoUringRtpTransportAdapter::Flush()
+{
+    std::lock_guard<std::mutex> lock(sendMutex_);
+    if (!sendRingReady_) {
+        return;
+    }
+
+    if (pending_ > 0) {
+        int ret = io_uring_submit(&sendRing_);
+        if (ret < 0) {
+            LMRTSP_LOGE("io_uring_submit failed: %s", strerror(-ret));
+        }
+        pending_ = 0;
+    }
+    ReapSendCompletions(false);
+}
+
+void IoUringRtpTransportAdapter::Close()
+{
+    active_ = false;
+
+    if (recvThread_) {
+        receiving_ = false;
+        if (recvThread_->joinable()) {
+            recvThread_->join();
+        }
+        recvThread_.reset();
+    }
+
+    if (recvRingReady_) {
+        if (recvBufRing_) {
+            io_uring_free_buf_ring(&recvRing_, recvBufRing_, RECV_BUFFER_COUNT, RECV_BUFFER_GROUP);
+            recvBufRing_ = nullptr;
+        }
+        io_uring_queue_exit(&recvRing_);
+        recvRingReady_ = false;
+    }
+
+    if (rtcpClient_) {
+        rtcpClient_->Close();
+        rtcpClient_.reset();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(sendMutex_);
+        if (sendRingReady_) {
+            // Drain in-flight writes before the registered slab goes away, a failing ring is torn down as it is
+            if (pending_ > 0) {
+                io_uring_submit(&sendRing_);
+                pending_ = 0;
+            }
+            while (freeSlots_.size() < SEND_QUEUE_DEPTH) {
+                if (!ReapSendCompletions(true)) {
+                    LMRTSP_LOGW("Closing io_uring send ring with %zu writes in flight",
+                                SEND_QUEUE_DEPTH - freeSlots_.size());
+                    break;
+                }
+            }
+            io_uring_queue_exit(&sendRing_);
+            sendRingReady_ = false;
+        }
+    }
+
+    if (rtpFd_ >= 0) {
+        ::close(rtpFd_);
+        rtpFd_ = -1;
+    }
+    if (rtcpFd_ >= 0) {
+        ::close(rtcpFd_);
+        rtcpFd_ = -1;
+    }
+
+    LMRTSP_LOGI("io_uring RTP transport adapter closed");
+}
+
+std::string IoUringRtpTransportAdapter::GetTransportInfo() const
+{
+    std::ostringstream oss;
+    oss << "UDP;unicast;client_port=" << clientRtpPort_ << "-" << clientRtcpPort_ << ";server_port=" << serverRtpPort_
+        << "-" << serverRtcpPort_;
+    return oss.str();
+}
+
+bool IoUringRtpTransportAdapter::IsActive() const
+{
+    return active_;
+}
+
+size_t IoUringRtpTransportAdapter::GetMemoryUsage() const
+{
+    return sizeof(*this) + sendSlab_.capacity() + recvSlab_.capacity() + freeSlots_.capacity() * sizeof(uint16_t);
+}
+
+bool IoUringRtpTransportAdapter::IsRtcpEnabled() const
+{
+    if (config_.mode == TransportConfig::Mode::SOURCE) {
+        return config_.client_rtcp_port != 0;
+    } else {
+        return config_.server_rtcp_port != 0;
+    }
+}
+
+bool IoUringRtpTransportAdapter::AllocatePorts()
+{
+    bool rtcp_enabled = IsRtcpEnabled();
+    uint16_t &rtp_port = (config_.mode == TransportConfig::Mode::SINK) ? clientRtpPort_ : serverRtpPort_;
+    uint16_t &rtcp_port = (config_.mode == TransportConfig::Mode::SINK) ? clientRtcpPort_ : serverRtcpPort_;
+
+    if (rtp_port == 0 || (rtcp_enabled && rtcp_port == 0)) {
+        uint16_t allocated_port = UdpRtpTransportAdapter::GetIdlePortPair();
+        if (allocated_port == 0) {
+            LMRTSP_LOGE("Failed to allocate local port pair");
+            return false;
+        }
+        rtp_port = allocated_port;
+        if (rtcp_enabled) {
+            rtcp_port = allocated_port + 1;
+        }
+        LMRTSP_LOGI("Allocated local ports: RTP=%u, RTCP=%u", rtp_port, rtcp_enabled ? rtcp_port : 0);
+    }
+
+    return true;
+}
+
+int IoUringRtpTransportAdapter::CreateSocket(uint16_t localPort, const std::string &remoteIp, uint16_t remotePort)
+{
+    int fd = ::socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        LMRTSP_LOGE("Failed to create UDP socket: %s", strerror(errno));
+        return -1;
+    }
+
+    int reuse = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    CpuAffinity::SetIncomingCpu(fd, config_.incoming_cpu);
+
+    struct sockaddr_in local {};
+    local.sin_family = AF_INET;
+    local.sin_addr.s_addr = htonl(INADDR_ANY);
+    local.sin_port = htons(localPort);
+    if (::bind(fd, reinterpret_cast<struct sockaddr *>(&local), sizeof(local)) < 0) {
+        LMRTSP_LOGE("Failed to bind UDP socket to port %u: %s", localPort, strerror(errno));
+        ::close(fd);
+        return -1;
+    }
+
+    // A connected socket lets plain writes carry datagrams, which is what allows fixed-buffer writes
+    if (!remoteIp.empty() && remotePort != 0) {
+        struct sockaddr_in remote {};
+        remote.sin_family = AF_INET;
+        remote.sin_port = htons(remotePort);
+        if (inet_pton(AF_INET, remoteIp.c_str(), &remote.sin_addr) != 1 ||
+            ::connect(fd, reinterpret_cast<struct sockaddr *>(&remote), sizeof(remote)) < 0) {
+            LMRTSP_LOGE("Failed to connect UDP socket to %s:%u", remoteIp.c_str(), remotePort);
+            ::close(fd);
+            return -1;
+        }
+    }
+
+    return fd;
+}
+
+bool IoUringRtpTransportAdapter::InitializeSendRing()
+{
+    if (client_ip_.empty() || clientRtpPort_ == 0) {
+        LMRTSP_LOGE("Client address not configured for io_uring transport");
+        return false;
+    }
+
+    rtpFd_ = CreateSocket(serverRtpPort_, client_ip_, clientRtpPort_);
+    if (rtpFd_ < 0) {
+        return false;
+    }
+
+    if (IsRtcpEnabled() && !InitializeRtcpClient()) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(sendMutex_);
+
+    int ret = io_uring_queue_init(SEND_QUEUE_DEPTH, &sendRing_, 0);
+    if (ret < 0) {
+        LMRTSP_LOGE("io_uring_queue_init failed: %s", strerror(-ret));
+        return false;
+    }
+    sendRingReady_ = true;
+
+    sendSlab_.assign(static_cast<size_t>(SEND_QUEUE_DEPTH) * SEND_SLOT_SIZE, 0);
+    freeSlots_.clear();
+    std::vector<struct iovec> iovecs(SEND_QUEUE_DEPTH);
+    for (unsigned i = 0; i < SEND_QUEUE_DEPTH; ++i) {
+        iovecs[i].iov_base = sendSlab_.data() + static_cast<size_t>(i) * SEND_SLOT_SIZE;
+        iovecs[i].iov_len = SEND_SLOT_SIZE;
+        freeSlots_.push_back(static_cast<uint16_t>(SEND_QUEUE_DEPTH - 1 - i));
+    }
+
+    // Both registrations are optimizations; RLIMIT_MEMLOCK or old kernels only cost us the fast path
+    ret = io_uring_register_buffers(&sendRing_, iovecs.data(), SEND_QUEUE_DEPTH);
+    fixedBuffers_ = (ret == 0);
+    if (!fixedBuffers_) {
+        LMRTSP_LOGW("io_uring_register_buffers failed (%s), using unregistered buffers", strerror(-ret));
+    }
+
+    ret = io_uring_register_files(&sendRing_, &rtpFd_, 1);
+    fixedFiles_ = (ret == 0);
+    if (!fixedFiles_) {
+        LMRTSP_LOGW("io_uring_register_files failed (%s), using plain descriptors", strerror(-ret));
+    }
+
+    pending_ = 0;
+    LMRTSP_LOGI("io_uring send ring ready: depth=%u, fixed buffers %s, fixed files %s", SEND_QUEUE_DEPTH,
+                fixedBuffers_ ? "on" : "off", fixedFiles_ ? "on" : "off");
+    return true;
+}
+
+bool IoUringRtpTransportAdapter::InitializeRtcpClient()
+{
+    rtcpClient_ = lmnet::UdpClient::Create(client_ip_, clientRtcpPort_, "", serverRtcpPort_);
+    if (!rtcpClient_ || !rtcpClient_->Init()) {
+        LMRTSP_LOGE("Failed to init RTCP client for %s:%u, local_port=%u", client_ip_.c_str(), clientRtcpPort_,
+                    serverRtcpPort_);
+        rtcpClient_.reset();
+        return false;
+    }
+    rtcpClientListener_ = std::make_shared<RtcpClientListener>(this);
+    rtcpClient_->SetListener(rtcpClientListener_);
+    CpuAffinity::SetIncomingCpu(rtcpClient_->GetSocketFd(), config_.incoming_cpu);
+    return true;
+}
+
+int IoUringRtpTransportAdapter::AcquireSendSlot()
+{
+    if (freeSlots_.empty()) {
+        ReapSendCompletions(false);
+    }
+
+    if (freeSlots_.empty()) {
+        // Every slot is in flight: make sure they are submitted, then block for the oldest one
+        if (pending_ > 0) {
+            io_uring_submit(&sendRing_);
+            pending_ = 0;
+        }
+        ReapSendCompletions(true);
+    }
+
+    if (freeSlots_.empty()) {
+        return -1;
+    }
+
+    int slot = freeSlots_.back();
+    freeSlots_.pop_back();
+    return slot;
+}
+
+bool IoUringRtpTransportAdapter::ReapSendCompletions(bool wait)
+{
+    struct io_uring_cqe *cqe = nullptr;
+
+    if (wait) {
+        int ret;
+        do {
+            ret = io_uring_wait_cqe(&sendRing_, &cqe);
+        } while (ret == -EINTR);
+        if (ret < 0) {
+            LMRTSP_LOGE("io_uring_wait_cqe failed: %s", strerror(-ret));
+            return false;
+        }
+    }
+
+    while (io_uring_peek_cqe(&sendRing_, &cqe) == 0) {
+        if (cqe->res < 0) {
+            LMRTSP_LOGW("RTP write to %s:%u failed: %s", client_ip_.c_str(), clientRtpPort_, strerror(-cqe->res));
+        }
+        freeSlots_.push_back(static_cast<uint16_t>(io_uring_cqe_get_data64(cqe)));
+        io_uring_cqe_seen(&sendRing_, cqe);
+    }
+    return true;
+}
+
+bool IoUringRtpTransportAdapter::InitializeRecvRing()
+{
+    rtpFd_ = CreateSocket(clientRtpPort_, "", 0);
+    if (rtpFd_ < 0) {
+        return false;
+    }
+
+    bool rtcp_enabled = IsRtcpEnabled();
+    if (rtcp_enabled) {
+        rtcpFd_ = CreateSocket(clientRtcpPort_, "", 0);
+        if (rtcpFd_ < 0) {
+            return false;
+        }
+    }
+
+    int ret = io_uring_queue_init(RECV_QUEUE_DEPTH, &recvRing_, 0);
+    if (ret < 0) {
+        LMRTSP_LOGE("io_uring_queue_init failed: %s", strerror(-ret));
+        return false;
+    }
+    recvRingReady_ = true;
+
+    int files[2] = {rtpFd_, rtcpFd_};
+    ret = io_uring_register_files(&recvRing_, files, rtcp_enabled ? 2 : 1);
+    if (ret < 0) {
+        LMRTSP_LOGE("io_uring_register_files failed: %s", strerror(-ret));
+        return false;
+    }
+
+    recvBufRing_ = io_uring_setup_buf_ring(&recvRing_, RECV_BUFFER_COUNT, RECV_BUFFER_GROUP, 0, &ret);
+    if (!recvBufRing_) {
+        LMRTSP_LOGE("io_uring_setup_buf_ring failed: %s", strerror(-ret));
+        return false;
+    }
+
+    recvSlab_.assign(static_cast<size_t>(RECV_BUFFER_COUNT) * RECV_BUFFER_SIZE, 0);
+    int mask = io_uring_buf_ring_mask(RECV_BUFFER_COUNT);
+    for (unsigned i = 0; i < RECV_BUFFER_COUNT; ++i) {
+        io_uring_buf_ring_add(recvBufRing_, recvSlab_.data() + static_cast<size_t>(i) * RECV_BUFFER_SIZE,
+                              RECV_BUFFER_SIZE, static_cast<unsigned short>(i), mask, static_cast<int>(i));
+    }
+    io_uring_buf_ring_advance(recvBufRing_, RECV_BUFFER_COUNT);
+
+    // The kernel lays out each buffer as io_uring_recvmsg_out + name + control + payload using this template
+    memset(&recvMsg_, 0, sizeof(recvMsg_));
+    recvMsg_.msg_namelen = sizeof(struct sockaddr_in);
+
+    if (!ArmMultishotRecv(RTP_FILE_INDEX) || (rtcp_enabled && !ArmMultishotRecv(RTCP_FILE_INDEX))) {
+        return false;
+    }
+
+    receiving_ = true;
+    recvThread_ = std::make_unique<std::thread>([this]() { ReceiveLoop(); });
+
+    LMRTSP_LOGI("io_uring receive ring ready: RTP port %u, RTCP port %u, %u x %zu byte buffers", clientRtpPort_,
+                rtcp_enabled ? clientRtcpPort_ : 0, RECV_BUFFER_COUNT, RECV_BUFFER_SIZE);
+    return true;
+}
+
+bool IoUringRtpTransportAdapter::ArmMultishotRecv(int fileIndex)
+{
+    struct io_uring_sqe *sqe = io_uring_get_sqe(&recvRing_);
+    if (!sqe) {
+        LMRTSP_LOGE("No SQE available to arm multishot recvmsg");
+        return false;
+    }
+
+    io_uring_prep_recvmsg_multishot(sqe, fileIndex, &recvMsg_, 0);
+    sqe->flags |= IOSQE_FIXED_FILE | IOSQE_BUFFER_SELECT;
+    sqe->buf_group = RECV_BUFFER_GROUP;
+    io_uring_sqe_set_data64(sqe, static_cast<uint64_t>(fileIndex));
+
+    int ret = io_uring_submit(&recvRing_);
+    if (ret < 0) {
+        LMRTSP_LOGE("Failed to arm multishot recvmsg: %s", strerror(-ret));
+        return false;
+    }
+    return true;
+}
+
+void IoUringRtpTransportAdapter::ReceiveLoop()
+{
+    int mask = io_uring_buf_ring_mask(RECV_BUFFER_COUNT);
+
+    while (receiving_) {
+        struct io_uring_cqe *cqe = nullptr;
+        struct __kernel_timespec timeout {};
+        timeout.tv_nsec = 100 * 1000 * 1000; // Wake up periodically to observe Close()
+
+        int ret = io_uring_wait_cqe_timeout(&recvRing_, &cqe, &timeout);
+        if (ret == -ETIME || ret == -EINTR) {
+            continue;
+        }
+        if (ret < 0) {
+            LMRTSP_LOGE("io_uring_wait_cqe_timeout failed: %s", strerror(-ret));
+            break;
+        }
+
+        while (io_uring_peek_cqe(&recvRing_, &cqe) == 0) {
+            int fileIndex = static_cast<int>(io_uring_cqe_get_data64(cqe));
+            bool more = (cqe->flags & IORING_CQE_F_MORE) != 0;
+
+            if (cqe->res < 0) {
+                if (cqe->res == -ENOBUFS) {
+                    LMRTSP_LOGW("io_uring receive buffers exhausted, datagrams dropped");
+                } else {
+                    LMRTSP_LOGE("Multishot recvmsg failed: %s", strerror(-cqe->res));
+                }
+            } else if (cqe->flags & IORING_CQE_F_BUFFER) {
+                unsigned short bid = static_cast<unsigned short>(cqe->flags >> IORING_CQE_BUFFER_SHIFT);
+                uint8_t *buf = recvSlab_.data() + static_cast<size_t>(bid) * RECV_BUFFER_SIZE;
+
+                struct io_uring_recvmsg_out *out = io_uring_recvmsg_validate(buf, cqe->res, &recvMsg_);
+                if (out && !(out->flags & MSG_TRUNC) && listener_) {
+                    auto *payload = static_cast<const uint8_t *>(io_uring_recvmsg_payload(out, &recvMsg_));
+                    unsigned int length = io_uring_recvmsg_payload_length(out, cqe->res, &recvMsg_);
+
+                    auto buffer = lmcore::DataBuffer::PoolAlloc(length);
+                    buffer->Append(payload, length);
+                    if (fileIndex == RTP_FILE_INDEX) {
+                        listener_->OnRtpDataReceived(buffer);
+                    } else {
+                        listener_->OnRtcpDataReceived(buffer);
+                    }
+                }
+
+                // Hand the buffer back to the kernel
+                io_uring_buf_ring_add(recvBufRing_, buf, RECV_BUFFER_SIZE, bid, mask, 0);
+                io_uring_buf_ring_advance(recvBufRing_, 1);
+            }
+
+            io_uring_cqe_seen(&recvRing_, cqe);
+
+            // The kernel terminates multishot requests on errors or buffer exhaustion; re-arm to keep receiving
+            if (!more && receiving_) {
+                ArmMultishotRecv(fileIndex);
+            }
+        }
+    }
+}
+
+} // namespace lmshao::lmrtsp
+
+#endif // LMRTSP_ENABLE_IO_URING
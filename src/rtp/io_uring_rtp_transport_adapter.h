@@ -0,0 +1,150 @@
+/**
+ * @author SHAO Liming <lmshao@163.com>
+ * @copyright Copyright (c) 2025 SHAO Liming
+ * @license MIT
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef LMSHAO_LMRTSP_IO_URING_RTP_TRANSPORT_ADAPTER_H
+#define LMSHAO_LMRTSP_IO_URING_RTP_TRANSPORT_ADAPTER_H
+
+#ifdef LMRTSP_ENABLE_IO_URING
+
+#include <liburing.h>
+#include <lmnet/iclient_listener.h>
+#include <lmnet/udp_client.h>
+#include <sys/socket.h>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "i_rtp_transport_adapter.h"
+#include "udp_rtp_transport_adapter.h"
+
+namespace lmshao::lmrtsp {
+
+/**
+ * @brief UDP RTP transport driven by io_uring (Linux only)
+ *
+ * SOURCE mode copies each RTP packet into a registered buffer and queues a fixed-buffer write on a connected socket
+ * registered as a fixed file. The queued writes of one frame are submitted with a single ring enter in Flush().
+ * RTCP is a few packets per second and goes through an lmnet UDP client, whose reactor also delivers the client's
+ * RR, XR, NACK and PLI to the listener. SINK mode arms one multishot recvmsg per socket backed by a provided buffer
+ * ring, so datagrams keep arriving without re-submission until the adapter is closed.
+ */
+class IoUringRtpTransportAdapter final : public IRtpTransportAdapter {
+public:
+    IoUringRtpTransportAdapter();
+    ~IoUringRtpTransportAdapter() override;
+
+    /**
+     * @brief Check whether the running kernel can serve the given mode
+     *
+     * @param mode SOURCE needs fixed-buffer writes, SINK additionally needs multishot recvmsg (kernel >= 6.0)
+     * @return true if the backend can be used
+     */
+    static bool IsSupported(TransportConfig::Mode mode);
+
+    bool Setup(const TransportConfig &config) override;
+    bool SendPacket(const uint8_t *data, size_t size) override;
+    bool SendRtcpPacket(const uint8_t *data, size_t size) override;
+    void Flush() override;
+    void Close() override;
+    std::string GetTransportInfo() const override;
+    bool IsActive() const override;
+    size_t GetMemoryUsage() const override;
+    size_t GetSendQueueBytes() const override { return UdpRtpTransportAdapter::SocketSendQueueBytes(rtpFd_); }
+
+    void SetOnDataListener(std::shared_ptr<UdpRtpTransportAdapterListener> listener) { listener_ = listener; }
+
+    // Port getters for dynamically allocated ports
+    uint16_t GetServerRtpPort() const { return serverRtpPort_; }
+    uint16_t GetServerRtcpPort() const { return serverRtcpPort_; }
+    uint16_t GetClientRtpPort() const { return clientRtpPort_; }
+    uint16_t GetClientRtcpPort() const { return clientRtcpPort_; }
+
+private:
+    bool IsRtcpEnabled() const;
+    bool AllocatePorts();
+    int CreateSocket(uint16_t localPort, const std::string &remoteIp, uint16_t remotePort);
+
+    bool InitializeSendRing();
+    bool InitializeRtcpClient();
+    int AcquireSendSlot();
+    bool ReapSendCompletions(bool wait);
+
+    bool InitializeRecvRing();
+    bool ArmMultishotRecv(int fileIndex);
+    void ReceiveLoop();
+
+private:
+    class RtcpClientListener : public lmnet::IClientListener {
+    public:
+        explicit RtcpClientListener(IoUringRtpTransportAdapter *adapter) : adapter_(adapter) {}
+        void OnReceive(lmnet::socket_t fd, std::shared_ptr<lmnet::DataBuffer> buffer) override;
+        void OnClose(lmnet::socket_t fd) override {}
+        void OnError(lmnet::socket_t fd, const std::string &errorInfo) override;
+
+    private:
+        IoUringRtpTransportAdapter *adapter_;
+    };
+
+    static constexpr unsigned SEND_QUEUE_DEPTH = 256;
+    static constexpr size_t SEND_SLOT_SIZE = 2048;
+    static constexpr unsigned RECV_QUEUE_DEPTH = 64;
+    static constexpr unsigned RECV_BUFFER_COUNT = 256; // Must be a power of two
+    static constexpr size_t RECV_BUFFER_SIZE = 2048;
+    static constexpr int RECV_BUFFER_GROUP = 0;
+    static constexpr int RTP_FILE_INDEX = 0;
+    static constexpr int RTCP_FILE_INDEX = 1;
+
+    // Transport runtime
+    TransportConfig config_{};
+    std::atomic<bool> active_{false};
+
+    // Endpoint info
+    std::string client_ip_{};
+    uint16_t clientRtpPort_{0};
+    uint16_t clientRtcpPort_{0};
+    uint16_t serverRtpPort_{0};
+    uint16_t serverRtcpPort_{0};
+
+    int rtpFd_{-1};
+    int rtcpFd_{-1};
+
+    // Send ring, owned by the packetizing thread
+    std::mutex sendMutex_;
+    struct io_uring sendRing_ {};
+    bool sendRingReady_{false};
+    bool fixedFiles_{false};
+    bool fixedBuffers_{false};
+    std::vector<uint8_t> sendSlab_;
+    std::vector<uint16_t> freeSlots_;
+    unsigned pending_{0};
+
+    // RTCP in SOURCE mode
+    std::shared_ptr<lmnet::UdpClient> rtcpClient_{};
+    std::shared_ptr<lmnet::IClientListener> rtcpClientListener_{};
+
+    // Receive ring, owned by recvThread_
+    struct io_uring recvRing_ {};
+    bool recvRingReady_{false};
+    struct io_uring_buf_ring *recvBufRing_{nullptr};
+    std::vector<uint8_t> recvSlab_;
+    struct msghdr recvMsg_ {};
+    std::atomic<bool> receiving_{false};
+    std::unique_ptr<std::thread> recvThread_;
+
+    std::shared_ptr<UdpRtpTransportAdapterListener> listener_{};
+};
+
+} // namespace lmshao::lmrtsp
+
+#endif // LMRTSP_ENABLE_IO_URING
+
+#endif // LMSHAO_LMRTSP_IO_URING_RTP_TRANSPORT_ADAPTER_H
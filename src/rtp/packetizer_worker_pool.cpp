@@ -0,0 +1,159 @@
+/**
+ * @author SHAO Liming <lmshao@163.com>
+ * @copyright Copyright (c) 2025 SHAO Liming
+ * @license MIT
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "packetizer_worker_pool.h"
+
+#include <algorithm>
+
+#include "internal_logger.h"
+#include "lmrtsp/cpu_affinity.h"
+
+namespace lmshao::lmrtsp {
+
+PacketizerWorkerPool &PacketizerWorkerPool::GetInstance()
+{
+    static PacketizerWorkerPool instance;
+    return instance;
+}
+
+PacketizerWorkerPool::PacketizerWorkerPool()
+{
+    unsigned int cores = std::thread::hardware_concurrency();
+    threadCount_ = cores > 1 ? cores - 1 : 0;
+}
+
+PacketizerWorkerPool::~PacketizerWorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    workCv_.notify_all();
+
+    for (auto &thread : threads_) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+}
+
+void PacketizerWorkerPool::SetCpus(const std::vector<int> &cpus)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!threads_.empty()) {
+        LMRTSP_LOGW("Packetizer worker pool already running, CPU set ignored");
+        return;
+    }
+
+    cpus_ = cpus;
+    if (!cpus_.empty()) {
+        // The caller takes part in the work, it runs on a sender CPU too
+        threadCount_ = cpus_.size() > 1 ? cpus_.size() - 1 : 0;
+    }
+}
+
+void PacketizerWorkerPool::Start()
+{
+    // Called with mutex_ held
+    for (size_t i = 0; i < threadCount_; ++i) {
+        threads_.emplace_back(&PacketizerWorkerPool::WorkerFunc, this);
+    }
+    LMRTSP_LOGI("Packetizer worker pool started with %zu threads", threadCount_);
+}
+
+void PacketizerWorkerPool::ParallelFor(size_t count, size_t min_chunk, const RangeFunc &func)
+{
+    if (count == 0) {
+        return;
+    }
+
+    size_t chunk = std::max<size_t>(min_chunk, 1);
+    size_t chunks = std::min(threadCount_ + 1, (count + chunk - 1) / chunk);
+    if (chunks <= 1) {
+        func(0, count);
+        return;
+    }
+    chunk = (count + chunks - 1) / chunks;
+
+    size_t pending = 0;
+    std::condition_variable done;
+    CpuAccount *account = CpuScope::CurrentAccount();
+    CpuStage stage = CpuScope::CurrentStage();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (threads_.empty()) {
+            Start();
+        }
+
+        // The first chunk stays on the calling thread
+        for (size_t begin = chunk; begin < count; begin += chunk) {
+            jobs_.push_back(Job{&func, begin, std::min(begin + chunk, count), &pending, &done, account, stage});
+            pending++;
+        }
+    }
+    workCv_.notify_all();
+
+    func(0, chunk);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    // Help with the remaining chunks instead of sleeping on them
+    while (pending > 0) {
+        if (!jobs_.empty()) {
+            Job job = jobs_.front();
+            jobs_.pop_front();
+            lock.unlock();
+            {
+                // The job may belong to another caller, its CPU time goes to that caller's account
+                CpuScope scope(job.account, job.stage);
+                (*job.func)(job.begin, job.end);
+            }
+            lock.lock();
+            if (--(*job.pending) == 0) {
+                job.done->notify_all();
+            }
+            continue;
+        }
+        done.wait(lock, [&pending, this]() { return pending == 0 || !jobs_.empty(); });
+    }
+}
+
+void PacketizerWorkerPool::WorkerFunc()
+{
+    // Copy the CPU set under the lock, the pinning syscall runs outside it
+    std::vector<int> cpus;
+    {
+        std::lock_guard<std::mutex> guard(mutex_);
+        cpus = cpus_;
+    }
+    CpuAffinity::PinCurrentThread(cpus);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        workCv_.wait(lock, [this]() { return stop_ || !jobs_.empty(); });
+        if (stop_) {
+            break;
+        }
+
+        Job job = jobs_.front();
+        jobs_.pop_front();
+
+        lock.unlock();
+        {
+            // Chunks the caller runs itself are already inside its scope
+            CpuScope scope(job.account, job.stage);
+            (*job.func)(job.begin, job.end);
+        }
+        lock.lock();
+
+        if (--(*job.pending) == 0) {
+            job.done->notify_all();
+        }
+    }
+}
+
+} // namespace lmshao::lmrtsp
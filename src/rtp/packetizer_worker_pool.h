@@ -0,0 +1,83 @@
+/**
+ * @author SHAO Liming <lmshao@163.com>
+ * @copyright Copyright (c) 2025 SHAO Liming
+ * @license MIT
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef LMSHAO_LMRTSP_PACKETIZER_WORKER_POOL_H
+#define LMSHAO_LMRTSP_PACKETIZER_WORKER_POOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "lmrtsp/cpu_accounting.h"
+
+namespace lmshao::lmrtsp {
+
+/**
+ * @brief Process-wide worker threads used to packetize very large frames in parallel
+ *
+ * Threads are started on first use, one per hardware thread minus the caller's. The calling thread always takes
+ * part in the work, so a busy pool degrades to serial packetization instead of blocking.
+ */
+class PacketizerWorkerPool {
+public:
+    using RangeFunc = std::function<void(size_t begin, size_t end)>;
+
+    static PacketizerWorkerPool &GetInstance();
+
+    /**
+     * @brief Run func over [0, count) split into chunks of at least min_chunk items, returns when all are done
+     * @note CPU time of chunks run by worker threads is charged to the caller's CpuScope, if any
+     */
+    void ParallelFor(size_t count, size_t min_chunk, const RangeFunc &func);
+
+    size_t GetThreadCount() const { return threadCount_; }
+
+    /**
+     * @brief CPUs the worker threads are pinned to, only effective before the pool starts
+     */
+    void SetCpus(const std::vector<int> &cpus);
+
+private:
+    PacketizerWorkerPool();
+    ~PacketizerWorkerPool();
+
+    // Non-copyable and non-movable
+    PacketizerWorkerPool(const PacketizerWorkerPool &) = delete;
+    PacketizerWorkerPool &operator=(const PacketizerWorkerPool &) = delete;
+    PacketizerWorkerPool(PacketizerWorkerPool &&) = delete;
+    PacketizerWorkerPool &operator=(PacketizerWorkerPool &&) = delete;
+
+    void Start();
+    void WorkerFunc();
+
+    struct Job {
+        const RangeFunc *func;
+        size_t begin;
+        size_t end;
+        size_t *pending;
+        std::condition_variable *done;
+        CpuAccount *account; // The submitting session's account, charged for the job's CPU time
+        CpuStage stage;
+    };
+
+    std::mutex mutex_;
+    std::condition_variable workCv_;
+    std::deque<Job> jobs_;
+    std::vector<std::thread> threads_;
+    size_t threadCount_ = 0;
+    std::vector<int> cpus_;
+    bool stop_ = false;
+};
+
+} // namespace lmshao::lmrtsp
+
+#endif // LMSHAO_LMRTSP_PACKETIZER_WORKER_POOL_H
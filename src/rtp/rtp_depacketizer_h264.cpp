@@ -40,6 +40,7 @@ void RtpDepacketizerH264::FlushFrame()
     frame->timestamp = currentTimestamp_;
     frame->media_type = MediaType::H264;
     frame->data = buffer;
+    classifier_.Classify(*frame);
 
     LMRTSP_LOGD("Calling listener->OnFrame with frame size: %zu", pending_.size());
     l->OnFrame(frame);
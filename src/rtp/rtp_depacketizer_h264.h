@@ -14,6 +14,7 @@
 #include <vector>
 
 #include "i_rtp_depacketizer.h"
+#include "lmrtsp/frame_classifier.h"
 #include "lmrtsp/rtp_packet.h"
 
 namespace lmshao::lmrtsp {
@@ -35,6 +36,7 @@ private:
     bool sequenceInitialized_ = false;
     bool haveFrameData_ = false;
     bool fuaActive_ = false;
+    FrameClassifier classifier_{MediaType::H264};
 };
 
 } // namespace lmshao::lmrtsp
@@ -40,6 +40,7 @@ void RtpDepacketizerH265::FlushFrame()
     frame->timestamp = currentTimestamp_;
     frame->media_type = MediaType::H265;
     frame->data = buffer;
+    classifier_.Classify(*frame);
 
     LMRTSP_LOGD("Calling listener->OnFrame with frame size: %zu", pending_.size());
     l->OnFrame(frame);
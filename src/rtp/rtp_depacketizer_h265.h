@@ -14,6 +14,7 @@
 #include <vector>
 
 #include "i_rtp_depacketizer.h"
+#include "lmrtsp/frame_classifier.h"
 #include "lmrtsp/rtp_packet.h"
 
 namespace lmshao::lmrtsp {
@@ -35,6 +36,7 @@ private:
     bool sequenceInitialized_ = false;
     bool haveFrameData_ = false;
     bool fuActive_ = false; // H.265 uses FU instead of FU-A
+    FrameClassifier classifier_{MediaType::H265};
 };
 
 } // namespace lmshao::lmrtsp
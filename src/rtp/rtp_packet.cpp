@@ -8,6 +8,8 @@
 
 #include "lmrtsp/rtp_packet.h"
 
+#include <cstring>
+
 #include "lmcore/byte_order.h"
 #include "lmcore/data_buffer.h"
 
@@ -154,6 +156,45 @@ std::shared_ptr<lmcore::DataBuffer> RtpPacket::Serialize() const
     return buf;
 }
 
+size_t RtpPacket::SerializeTo(uint8_t *buffer, size_t capacity) const
+{
+    if (!buffer || !Validate())
+        return 0;
+    size_t size = Size();
+    if (size > capacity)
+        return 0;
+
+    uint8_t *p = buffer;
+    p[0] = static_cast<uint8_t>(((version & 0x03) << 6) | ((padding & 0x01) << 5) | ((extension & 0x01) << 4) |
+                                (csrc_count & 0x0F));
+    p[1] = static_cast<uint8_t>(((marker & 0x01) << 7) | (payload_type & 0x7F));
+    lmcore::ByteOrder::WriteBE16(p + 2, sequence_number);
+    lmcore::ByteOrder::WriteBE32(p + 4, timestamp);
+    lmcore::ByteOrder::WriteBE32(p + 8, ssrc);
+    p += 12;
+
+    for (size_t i = 0; i < csrc_list.size(); ++i) {
+        lmcore::ByteOrder::WriteBE32(p, static_cast<uint32_t>(csrc_list[i]));
+        p += 4;
+    }
+
+    if (extension) {
+        lmcore::ByteOrder::WriteBE16(p, static_cast<uint16_t>(extension_profile));
+        lmcore::ByteOrder::WriteBE16(p + 2, static_cast<uint16_t>(extension_data.size() / 4));
+        p += 4;
+        if (!extension_data.empty()) {
+            memcpy(p, extension_data.data(), extension_data.size());
+            p += extension_data.size();
+        }
+    }
+
+    if (payload && payload->Size()) {
+        memcpy(p, payload->Data(), payload->Size());
+        p += payload->Size();
+    }
+    return static_cast<size_t>(p - buffer);
+}
+
 bool RtpPacket::Parse(char *data, size_t length)
 {
     return ParseRtpFromBytes(*this, reinterpret_cast<const uint8_t *>(data), length);
@@ -0,0 +1,61 @@
+/**
+ * @author SHAO Liming <lmshao@163.com>
+ * @copyright Copyright (c) 2025 SHAO Liming
+ * @license MIT
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef LMSHAO_LMRTSP_RTP_PACKET_RECYCLER_H
+#define LMSHAO_LMRTSP_RTP_PACKET_RECYCLER_H
+
+#include <lmcore/data_buffer.h>
+
+#include <cstddef>
+#include <memory>
+
+#include "lmrtsp/rtp_packet.h"
+
+namespace lmshao::lmrtsp {
+
+/**
+ * @brief Hands a packetizer the same RtpPacket and payload buffer again once no sink holds on to them
+ *
+ * TransportSink serializes a packet and lets go of it within the call, so a pipeline packetizes without allocating
+ * once the payload buffer has grown to the MTU. A listener that keeps a packet or its payload, e.g. in a send queue,
+ * makes the next Acquire() allocate a fresh one instead. Owned by the packetizing thread.
+ */
+class RtpPacketRecycler {
+public:
+    /**
+     * @brief A packet with default header fields and an empty payload of at least the given capacity
+     */
+    std::shared_ptr<RtpPacket> Acquire(size_t payloadCapacity)
+    {
+        std::shared_ptr<lmcore::DataBuffer> payload;
+        if (packet_ && packet_.use_count() == 1) {
+            payload = std::move(packet_->payload);
+            *packet_ = RtpPacket();
+        } else {
+            packet_ = std::make_shared<RtpPacket>();
+        }
+
+        if (payload && payload.use_count() == 1) {
+            payload->Clear();
+            if (payload->Capacity() < payloadCapacity) {
+                payload->SetCapacity(payloadCapacity);
+            }
+        } else {
+            payload = lmcore::DataBuffer::PoolAlloc(payloadCapacity);
+        }
+        packet_->payload = std::move(payload);
+        return packet_;
+    }
+
+private:
+    std::shared_ptr<RtpPacket> packet_;
+};
+
+} // namespace lmshao::lmrtsp
+
+#endif // LMSHAO_LMRTSP_RTP_PACKET_RECYCLER_H
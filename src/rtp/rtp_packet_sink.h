@@ -0,0 +1,91 @@
+/**
+ * @author SHAO Liming <lmshao@163.com>
+ * @copyright Copyright (c) 2025 SHAO Liming
+ * @license MIT
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef LMSHAO_LMRTSP_RTP_PACKET_SINK_H
+#define LMSHAO_LMRTSP_RTP_PACKET_SINK_H
+
+#include <cstdint>
+#include <memory>
+
+#include "i_rtp_packetizer.h"
+#include "internal_logger.h"
+#include "lmrtsp/rtcp_context.h"
+#include "lmrtsp/rtp_packet.h"
+
+namespace lmshao::lmrtsp {
+
+/**
+ * @brief Packet sink that forwards to a packetizer listener, used by IRtpPacketizer::SubmitFrame()
+ */
+class ListenerSink {
+public:
+    explicit ListenerSink(IRtpPacketizerListener *listener) : listener_(listener) {}
+
+    void operator()(const std::shared_ptr<RtpPacket> &packet) { listener_->OnPacket(packet); }
+
+private:
+    IRtpPacketizerListener *listener_;
+};
+
+/**
+ * @brief Packet sink that serializes into a stack buffer and sends through a concrete transport
+ *
+ * Transport is the final adapter class, so SendPacket() is a direct call. One sink lives for one frame.
+ *
+ * @tparam Transport Concrete IRtpTransportAdapter
+ */
+template <typename Transport>
+class TransportSink {
+public:
+    /**
+     * @param frameTimeNs Send time of the frame, reported to RTCP for all of its packets
+     */
+    TransportSink(Transport *transport, RtcpSenderContext *rtcpContext, int64_t frameTimeNs)
+        : transport_(transport), rtcpContext_(rtcpContext), frameTimeNs_(frameTimeNs)
+    {
+    }
+
+    void operator()(const std::shared_ptr<RtpPacket> &packet)
+    {
+        size_t size = packet->SerializeTo(buffer_, sizeof(buffer_));
+        const uint8_t *data = buffer_;
+        std::shared_ptr<lmcore::DataBuffer> serialized;
+        if (size == 0) {
+            // Larger than any MTU we packetize for, take the allocating path
+            serialized = packet->Serialize();
+            if (!serialized || serialized->Size() == 0) {
+                return;
+            }
+            data = serialized->Data();
+            size = serialized->Size();
+        }
+
+        if (!transport_->Transport::SendPacket(data, size)) {
+            LMRTSP_LOGE("Failed to send RTP packet - SSRC %u, seq %u, size %zu", packet->ssrc, packet->sequence_number,
+                        size);
+            return;
+        }
+
+        if (rtcpContext_) {
+            rtcpContext_->RtcpSenderContext::OnRtp(packet->sequence_number, packet->timestamp, frameTimeNs_, 90000,
+                                                   size);
+        }
+    }
+
+private:
+    static constexpr size_t MAX_PACKET_SIZE = 2048;
+
+    Transport *transport_;
+    RtcpSenderContext *rtcpContext_;
+    int64_t frameTimeNs_;
+    uint8_t buffer_[MAX_PACKET_SIZE];
+};
+
+} // namespace lmshao::lmrtsp
+
+#endif // LMSHAO_LMRTSP_RTP_PACKET_SINK_H
@@ -11,6 +11,13 @@
 #include <algorithm>
 #include <cstring>
 
+#include "rtp_packet_sink.h"
+#include "tcp_interleaved_transport_adapter.h"
+#include "udp_rtp_transport_adapter.h"
+#ifdef LMRTSP_ENABLE_IO_URING
+#include "io_uring_rtp_transport_adapter.h"
+#endif
+
 namespace lmshao::lmrtsp {
 
 static inline size_t RtpHeaderSize()
@@ -24,10 +31,19 @@ void RtpPacketizerAac::SubmitFrame(const std::shared_ptr<MediaFrame> &frame)
     if (!l || !frame || !frame->data)
         return;
 
-    auto buf = frame->data;
-    const uint8_t *data = buf->Data();
-    size_t size = buf->Size();
-    uint32_t timestamp = frame->timestamp;
+    ListenerSink sink(l.get());
+    Packetize(*frame, sink);
+}
+
+template <typename Sink>
+void RtpPacketizerAac::Packetize(const MediaFrame &frame, Sink &sink)
+{
+    if (!frame.data)
+        return;
+
+    const uint8_t *data = frame.data->Data();
+    size_t size = frame.data->Size();
+    uint32_t timestamp = frame.timestamp;
 
     // RFC 3640 AAC-hbr mode: Add AU headers section
     // AU-headers-length (16 bits) + AU-header (16 bits: 13 bits size + 3 bits index)
@@ -43,7 +59,7 @@ void RtpPacketizerAac::SubmitFrame(const std::shared_ptr<MediaFrame> &frame)
     }
 
     // Build RTP packet with AU headers
-    auto packet = std::make_shared<RtpPacket>();
+    auto packet = recycler_.Acquire(au_header_section_size + size);
     packet->version = 2;
     packet->payload_type = payloadType_;
     packet->sequence_number = sequenceNumber_++;
@@ -52,7 +68,8 @@ void RtpPacketizerAac::SubmitFrame(const std::shared_ptr<MediaFrame> &frame)
     packet->marker = 1; // Single complete AU
 
     // Construct payload: AU-headers-length + AU-header + AAC frame data
-    auto payload = std::make_shared<lmcore::DataBuffer>(au_header_section_size + size);
+    auto &payload = packet->payload;
+    payload->SetSize(au_header_section_size + size);
     uint8_t *p = payload->Data();
 
     // AU-headers-length in bits (16 bits for one AU-header)
@@ -67,12 +84,16 @@ void RtpPacketizerAac::SubmitFrame(const std::shared_ptr<MediaFrame> &frame)
 
     // Copy AAC frame data
     std::memcpy(p + 4, data, size);
-    payload->SetSize(au_header_section_size + size);
 
-    packet->payload = payload;
-
-    if (auto l2 = listener_.lock())
-        l2->OnPacket(packet);
+    sink(packet);
 }
 
-} // namespace lmshao::lmrtsp
\ No newline at end of file
+// One instantiation per pipeline sink, see rtp_pipeline.h
+template void RtpPacketizerAac::Packetize(const MediaFrame &, ListenerSink &);
+template void RtpPacketizerAac::Packetize(const MediaFrame &, TransportSink<UdpRtpTransportAdapter> &);
+template void RtpPacketizerAac::Packetize(const MediaFrame &, TransportSink<TcpInterleavedTransportAdapter> &);
+#ifdef LMRTSP_ENABLE_IO_URING
+template void RtpPacketizerAac::Packetize(const MediaFrame &, TransportSink<IoUringRtpTransportAdapter> &);
+#endif
+
+} // namespace lmshao::lmrtsp
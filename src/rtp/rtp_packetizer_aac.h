@@ -14,6 +14,7 @@
 
 #include "i_rtp_packetizer.h"
 #include "lmrtsp/media_types.h"
+#include "rtp_packet_recycler.h"
 
 namespace lmshao::lmrtsp {
 
@@ -31,12 +32,19 @@ public:
 
     void SubmitFrame(const std::shared_ptr<MediaFrame> &frame) override;
 
+    /**
+     * @brief Packetize a frame into the given sink, see rtp_packet_sink.h
+     */
+    template <typename Sink>
+    void Packetize(const MediaFrame &frame, Sink &sink);
+
 private:
     uint32_t ssrc_ = 0;
     uint16_t sequenceNumber_ = 0;
     uint8_t payloadType_ = 97;   // dynamic for AAC
     uint32_t clockRate_ = 48000; // AAC clock (example)
     uint32_t mtuSize_ = 1400;    // default MTU
+    RtpPacketRecycler recycler_; // Reuses the packet once the sink lets go of it
 };
 
 } // namespace lmshao::lmrtsp
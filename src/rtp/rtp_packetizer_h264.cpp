@@ -12,6 +12,13 @@
 #include <cstring>
 
 #include "internal_logger.h"
+#include "packetizer_worker_pool.h"
+#include "rtp_packet_sink.h"
+#include "tcp_interleaved_transport_adapter.h"
+#include "udp_rtp_transport_adapter.h"
+#ifdef LMRTSP_ENABLE_IO_URING
+#include "io_uring_rtp_transport_adapter.h"
+#endif
 
 namespace lmshao::lmrtsp {
 
@@ -20,6 +27,9 @@ static inline size_t RtpHeaderSize()
     return 12; // fixed RTP header without extensions
 }
 
+// Fragments built per worker chunk, keeps the scheduling overhead small relative to the copies
+static constexpr size_t PARALLEL_MIN_FRAGMENTS = 64;
+
 const uint8_t *RtpPacketizerH264::FindStartCode(const uint8_t *data, size_t size)
 {
     if (!data || size < 3)
@@ -59,13 +69,28 @@ void RtpPacketizerH264::SubmitFrame(const std::shared_ptr<MediaFrame> &frame)
         return;
     }
 
-    auto buf = frame->data;
-    const uint8_t *data = buf->Data();
-    size_t size = buf->Size();
-    uint32_t timestamp = frame->timestamp; // assume already in 90kHz or precomputed
+    ListenerSink sink(l.get());
+    Packetize(*frame, sink);
+}
+
+template <typename Sink>
+void RtpPacketizerH264::Packetize(const MediaFrame &frame, Sink &sink)
+{
+    if (!frame.data) {
+        LMRTSP_LOGE("Packetize failed - frame has no data");
+        return;
+    }
+
+    const uint8_t *data = frame.data->Data();
+    size_t size = frame.data->Size();
+    uint32_t timestamp = frame.timestamp; // assume already in 90kHz or precomputed
 
     LMRTSP_LOGI("Processing frame - size: %u, timestamp: %u", size, timestamp);
 
+    if (parallelThreshold_ > 0 && size >= parallelThreshold_ && PacketizeParallel(data, size, timestamp, sink)) {
+        return;
+    }
+
     const uint8_t *start = FindStartCode(data, size);
     if (!start) {
         LMRTSP_LOGE("No start code found, treat entire buffer as a single NALU without start code");
@@ -121,10 +146,10 @@ void RtpPacketizerH264::SubmitFrame(const std::shared_ptr<MediaFrame> &frame)
         size_t max_payload = mtuSize_ - RtpHeaderSize();
         if (nalu_size <= max_payload) {
             LMRTSP_LOGI("Using Single NALU packetization for NALU #%d", nalu_count);
-            PacketizeSingleNalu(nalu_payload, nalu_size, timestamp, last_nalu);
+            PacketizeSingleNalu(nalu_payload, nalu_size, timestamp, last_nalu, sink);
         } else {
             LMRTSP_LOGI("Using FU-A packetization for NALU #%d", nalu_count);
-            PacketizeFuA(nalu_payload, nalu_size, timestamp, last_nalu);
+            PacketizeFuA(nalu_payload, nalu_size, timestamp, last_nalu, sink);
         }
 
         start = next;
@@ -133,12 +158,14 @@ void RtpPacketizerH264::SubmitFrame(const std::shared_ptr<MediaFrame> &frame)
     LMRTSP_LOGI("SubmitFrame completed - processed %d NALUs", nalu_count);
 }
 
-void RtpPacketizerH264::PacketizeSingleNalu(const uint8_t *nalu, size_t nalu_size, uint32_t timestamp, bool last_nalu)
+template <typename Sink>
+void RtpPacketizerH264::PacketizeSingleNalu(const uint8_t *nalu, size_t nalu_size, uint32_t timestamp, bool last_nalu,
+                                            Sink &sink)
 {
     if (!nalu || nalu_size == 0)
         return;
 
-    auto packet = std::make_shared<RtpPacket>();
+    auto packet = recycler_.Acquire(nalu_size);
     packet->version = 2;
     packet->payload_type = payloadType_;
     packet->sequence_number = sequenceNumber_++;
@@ -146,18 +173,17 @@ void RtpPacketizerH264::PacketizeSingleNalu(const uint8_t *nalu, size_t nalu_siz
     packet->ssrc = ssrc_;
     packet->marker = last_nalu ? 1 : 0;
 
-    auto payload = std::make_shared<lmcore::DataBuffer>(nalu_size);
+    auto &payload = packet->payload;
     payload->Assign(nalu, nalu_size);
-    packet->payload = payload;
 
-    if (auto l = listener_.lock()) {
-        LMRTSP_LOGI("Sent RTP packet with SSRC %u, seq %u, timestamp %u, payload type %u, size %u", packet->ssrc,
-                    packet->sequence_number, packet->timestamp, packet->payload_type, payload->Size());
-        l->OnPacket(packet);
-    }
+    LMRTSP_LOGI("Sent RTP packet with SSRC %u, seq %u, timestamp %u, payload type %u, size %u", packet->ssrc,
+                packet->sequence_number, packet->timestamp, packet->payload_type, payload->Size());
+    sink(packet);
 }
 
-void RtpPacketizerH264::PacketizeFuA(const uint8_t *nalu, size_t nalu_size, uint32_t timestamp, bool last_nalu)
+template <typename Sink>
+void RtpPacketizerH264::PacketizeFuA(const uint8_t *nalu, size_t nalu_size, uint32_t timestamp, bool last_nalu,
+                                     Sink &sink)
 {
     if (!nalu || nalu_size <= 1)
         return;
@@ -187,7 +213,7 @@ void RtpPacketizerH264::PacketizeFuA(const uint8_t *nalu, size_t nalu_size, uint
         uint8_t fu_header =
             static_cast<uint8_t>(((first ? 1 : 0) << 7) | ((is_last_fragment ? 1 : 0) << 6) | (0 << 5) | (type & 0x1F));
 
-        auto packet = std::make_shared<RtpPacket>();
+        auto packet = recycler_.Acquire(chunk + 2);
         packet->version = 2;
         packet->payload_type = payloadType_;
         packet->sequence_number = sequenceNumber_++;
@@ -195,17 +221,14 @@ void RtpPacketizerH264::PacketizeFuA(const uint8_t *nalu, size_t nalu_size, uint
         packet->ssrc = ssrc_;
         packet->marker = (is_last_fragment && last_nalu) ? 1 : 0;
 
-        auto payload = std::make_shared<lmcore::DataBuffer>(chunk + 2);
+        auto &payload = packet->payload;
         payload->Assign((uint8_t)fu_indicator);
         payload->Append((uint8_t)fu_header);
         payload->Append(nalu + offset, chunk);
-        packet->payload = payload;
 
-        if (auto l = listener_.lock()) {
-            LMRTSP_LOGI("Sent RTP packet with SSRC %u, seq %u, timestamp %u, payload type %u, size %u", packet->ssrc,
-                        packet->sequence_number, packet->timestamp, packet->payload_type, payload->Size());
-            l->OnPacket(packet);
-        }
+        LMRTSP_LOGI("Sent RTP packet with SSRC %u, seq %u, timestamp %u, payload type %u, size %u", packet->ssrc,
+                    packet->sequence_number, packet->timestamp, packet->payload_type, payload->Size());
+        sink(packet);
 
         offset += chunk;
         remaining -= chunk;
@@ -213,4 +236,105 @@ void RtpPacketizerH264::PacketizeFuA(const uint8_t *nalu, size_t nalu_size, uint
     }
 }
 
-} // namespace lmshao::lmrtsp
\ No newline at end of file
+template <typename Sink>
+bool RtpPacketizerH264::PacketizeParallel(const uint8_t *data, size_t size, uint32_t timestamp, Sink &sink)
+{
+    if (mtuSize_ <= RtpHeaderSize() + 2) {
+        return false;
+    }
+
+    const size_t max_payload = mtuSize_ - RtpHeaderSize();
+    const size_t max_fragment = max_payload - 2;
+    const uint8_t *end = data + size;
+
+    // Serial pass: split the frame into NALs and the NALs into packet-sized fragments. Only pointers are recorded,
+    // so this is cheap next to building the packets.
+    fragments_.clear();
+    const uint8_t *start = FindStartCode(data, size);
+    while (start) {
+        size_t skip_bytes = (start[2] == 1) ? 3 : 4;
+        const uint8_t *nalu = start + skip_bytes;
+        const uint8_t *next = (nalu < end) ? FindNextStartCode(nalu, static_cast<size_t>(end - nalu)) : nullptr;
+        size_t nalu_size = static_cast<size_t>((next ? next : end) - nalu);
+        bool last_nalu = (next == nullptr);
+
+        if (nalu_size > 0 && nalu_size <= max_payload) {
+            fragments_.push_back(Fragment{nalu, nalu_size, nalu[0], false, true, true, last_nalu});
+        } else if (nalu_size > 1) {
+            for (size_t offset = 1; offset < nalu_size; offset += max_fragment) {
+                size_t chunk = std::min(nalu_size - offset, max_fragment);
+                bool last = (offset + chunk == nalu_size);
+                fragments_.push_back(
+                    Fragment{nalu + offset, chunk, nalu[0], true, offset == 1, last, last && last_nalu});
+            }
+        }
+        start = next;
+    }
+
+    if (fragments_.empty()) {
+        return false;
+    }
+
+    // Reserve the sequence numbers of the whole frame, fragment i gets base + i
+    const uint16_t base_seq = sequenceNumber_;
+    sequenceNumber_ = static_cast<uint16_t>(sequenceNumber_ + fragments_.size());
+
+    std::vector<std::shared_ptr<RtpPacket>> packets(fragments_.size());
+    PacketizerWorkerPool::GetInstance().ParallelFor(fragments_.size(), PARALLEL_MIN_FRAGMENTS,
+                                                    [&](size_t begin, size_t finish) {
+                                                        for (size_t i = begin; i < finish; ++i) {
+                                                            packets[i] = BuildPacket(
+                                                                fragments_[i], static_cast<uint16_t>(base_seq + i),
+                                                                timestamp);
+                                                        }
+                                                    });
+
+    LMRTSP_LOGD("Parallel packetization - size: %zu, packets: %zu, seq %u-%u", size, packets.size(), base_seq,
+                static_cast<uint16_t>(sequenceNumber_ - 1));
+
+    for (const auto &packet : packets) {
+        sink(packet);
+    }
+    return true;
+}
+
+std::shared_ptr<RtpPacket> RtpPacketizerH264::BuildPacket(const Fragment &fragment, uint16_t seq,
+                                                          uint32_t timestamp) const
+{
+    auto packet = std::make_shared<RtpPacket>();
+    packet->version = 2;
+    packet->payload_type = payloadType_;
+    packet->sequence_number = seq;
+    packet->timestamp = timestamp;
+    packet->ssrc = ssrc_;
+    packet->marker = fragment.marker ? 1 : 0;
+
+    if (!fragment.fua) {
+        auto payload = std::make_shared<lmcore::DataBuffer>(fragment.size);
+        payload->Assign(fragment.data, fragment.size);
+        packet->payload = payload;
+        return packet;
+    }
+
+    // FU-A: indicator (F,NRI,Type=28), header (S/E/R=0, Type)
+    const uint8_t fu_indicator = static_cast<uint8_t>((fragment.nal_header & 0xE0) | 28);
+    const uint8_t fu_header = static_cast<uint8_t>(((fragment.first ? 1 : 0) << 7) | ((fragment.last ? 1 : 0) << 6) |
+                                                   (fragment.nal_header & 0x1F));
+
+    auto payload = std::make_shared<lmcore::DataBuffer>(fragment.size + 2);
+    payload->Assign(fu_indicator);
+    payload->Append(fu_header);
+    payload->Append(fragment.data, fragment.size);
+    packet->payload = payload;
+    return packet;
+}
+
+// One instantiation per pipeline sink, see rtp_pipeline.h
+template void RtpPacketizerH264::Packetize(const MediaFrame &, ListenerSink &);
+template void RtpPacketizerH264::Packetize(const MediaFrame &, TransportSink<UdpRtpTransportAdapter> &);
+template void RtpPacketizerH264::Packetize(const MediaFrame &, TransportSink<TcpInterleavedTransportAdapter> &);
+#ifdef LMRTSP_ENABLE_IO_URING
+template void RtpPacketizerH264::Packetize(const MediaFrame &, TransportSink<IoUringRtpTransportAdapter> &);
+#endif
+
+} // namespace lmshao::lmrtsp
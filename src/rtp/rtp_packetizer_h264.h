@@ -11,9 +11,11 @@
 
 #include <cstdint>
 #include <memory>
+#include <vector>
 
 #include "i_rtp_packetizer.h"
 #include "lmrtsp/media_types.h"
+#include "rtp_packet_recycler.h"
 
 namespace lmshao::lmrtsp {
 
@@ -31,13 +33,43 @@ public:
 
     void SubmitFrame(const std::shared_ptr<MediaFrame> &frame) override;
 
+    /**
+     * @brief Packetize a frame into the given sink, see rtp_packet_sink.h
+     */
+    template <typename Sink>
+    void Packetize(const MediaFrame &frame, Sink &sink);
+
+    /**
+     * @brief Packetize frames of at least the given size on the shared worker pool, 0 disables
+     *
+     * Sequence numbers of the whole frame are reserved up front and packets are still delivered to the listener in
+     * order, from the calling thread.
+     */
+    void SetParallelThreshold(size_t bytes) { parallelThreshold_ = bytes; }
+
 private:
+    struct Fragment {
+        const uint8_t *data;
+        size_t size;
+        uint8_t nal_header; // Original NAL header, FU-A fragments only
+        bool fua;
+        bool first;
+        bool last;
+        bool marker;
+    };
+
+    template <typename Sink>
+    bool PacketizeParallel(const uint8_t *data, size_t size, uint32_t timestamp, Sink &sink);
+    std::shared_ptr<RtpPacket> BuildPacket(const Fragment &fragment, uint16_t seq, uint32_t timestamp) const;
+
     // Minimal NALU parsing helpers
     static const uint8_t *FindStartCode(const uint8_t *data, size_t size);
     static const uint8_t *FindNextStartCode(const uint8_t *data, size_t size);
 
-    void PacketizeSingleNalu(const uint8_t *nalu, size_t nalu_size, uint32_t timestamp, bool last_nalu);
-    void PacketizeFuA(const uint8_t *nalu, size_t nalu_size, uint32_t timestamp, bool last_nalu);
+    template <typename Sink>
+    void PacketizeSingleNalu(const uint8_t *nalu, size_t nalu_size, uint32_t timestamp, bool last_nalu, Sink &sink);
+    template <typename Sink>
+    void PacketizeFuA(const uint8_t *nalu, size_t nalu_size, uint32_t timestamp, bool last_nalu, Sink &sink);
 
 private:
     uint32_t ssrc_ = 0;
@@ -45,6 +77,9 @@ private:
     uint8_t payloadType_ = 96;   // dynamic for H264
     uint32_t clockRate_ = 90000; // H264 clock
     uint32_t mtuSize_ = 1400;    // default MTU
+    RtpPacketRecycler recycler_; // Reuses the packet once the sink lets go of it
+    size_t parallelThreshold_ = 0;
+    std::vector<Fragment> fragments_; // Reused by PacketizeParallel
 };
 
 } // namespace lmshao::lmrtsp
@@ -12,6 +12,12 @@
 #include <cstring>
 
 #include "internal_logger.h"
+#include "rtp_packet_sink.h"
+#include "tcp_interleaved_transport_adapter.h"
+#include "udp_rtp_transport_adapter.h"
+#ifdef LMRTSP_ENABLE_IO_URING
+#include "io_uring_rtp_transport_adapter.h"
+#endif
 
 namespace lmshao::lmrtsp {
 
@@ -57,10 +63,21 @@ void RtpPacketizerH265::SubmitFrame(const std::shared_ptr<MediaFrame> &frame)
         return;
     }
 
-    auto buf = frame->data;
-    const uint8_t *data = buf->Data();
-    size_t size = buf->Size();
-    uint32_t timestamp = frame->timestamp;
+    ListenerSink sink(l.get());
+    Packetize(*frame, sink);
+}
+
+template <typename Sink>
+void RtpPacketizerH265::Packetize(const MediaFrame &frame, Sink &sink)
+{
+    if (!frame.data) {
+        LMRTSP_LOGE("Packetize failed - frame has no data");
+        return;
+    }
+
+    const uint8_t *data = frame.data->Data();
+    size_t size = frame.data->Size();
+    uint32_t timestamp = frame.timestamp;
 
     LMRTSP_LOGI("Processing frame - size: %u, timestamp: %u", size, timestamp);
 
@@ -116,10 +133,10 @@ void RtpPacketizerH265::SubmitFrame(const std::shared_ptr<MediaFrame> &frame)
         size_t max_payload = mtuSize_ - RtpHeaderSize();
         if (nalu_size <= max_payload) {
             LMRTSP_LOGI("Using Single NALU packetization for NALU #%d", nalu_count);
-            PacketizeSingleNalu(nalu_payload, nalu_size, timestamp, last_nalu);
+            PacketizeSingleNalu(nalu_payload, nalu_size, timestamp, last_nalu, sink);
         } else {
             LMRTSP_LOGI("Using FU packetization for NALU #%d", nalu_count);
-            PacketizeFuA(nalu_payload, nalu_size, timestamp, last_nalu);
+            PacketizeFuA(nalu_payload, nalu_size, timestamp, last_nalu, sink);
         }
 
         start = next;
@@ -128,30 +145,28 @@ void RtpPacketizerH265::SubmitFrame(const std::shared_ptr<MediaFrame> &frame)
     LMRTSP_LOGI("SubmitFrame completed - processed %d NALUs", nalu_count);
 }
 
-void RtpPacketizerH265::PacketizeSingleNalu(const uint8_t *nalu, size_t nalu_size, uint32_t timestamp, bool last_nalu)
+template <typename Sink>
+void RtpPacketizerH265::PacketizeSingleNalu(const uint8_t *nalu, size_t nalu_size, uint32_t timestamp, bool last_nalu,
+                                            Sink &sink)
 {
     if (!nalu || nalu_size == 0)
         return;
 
-    auto packet = std::make_shared<RtpPacket>();
+    auto packet = recycler_.Acquire(nalu_size);
     packet->version = 2;
     packet->payload_type = payloadType_;
     packet->sequence_number = sequenceNumber_++;
     packet->timestamp = timestamp;
     packet->ssrc = ssrc_;
     packet->marker = last_nalu ? 1 : 0;
+    packet->payload->Assign(nalu, nalu_size);
 
-    auto payload = std::make_shared<lmcore::DataBuffer>(nalu_size);
-    payload->Assign(nalu, nalu_size);
-    packet->payload = payload;
-
-    auto l = listener_.lock();
-    if (l) {
-        l->OnPacket(packet);
-    }
+    sink(packet);
 }
 
-void RtpPacketizerH265::PacketizeFuA(const uint8_t *nalu, size_t nalu_size, uint32_t timestamp, bool last_nalu)
+template <typename Sink>
+void RtpPacketizerH265::PacketizeFuA(const uint8_t *nalu, size_t nalu_size, uint32_t timestamp, bool last_nalu,
+                                     Sink &sink)
 {
     if (!nalu || nalu_size < 2)
         return;
@@ -190,7 +205,7 @@ void RtpPacketizerH265::PacketizeFuA(const uint8_t *nalu, size_t nalu_size, uint
             fu_header |= 0x40; // Set End bit
         }
 
-        auto packet = std::make_shared<RtpPacket>();
+        auto packet = recycler_.Acquire(3 + fragment_size);
         packet->version = 2;
         packet->payload_type = payloadType_;
         packet->sequence_number = sequenceNumber_++;
@@ -199,22 +214,25 @@ void RtpPacketizerH265::PacketizeFuA(const uint8_t *nalu, size_t nalu_size, uint
         packet->marker = (last_fragment && last_nalu) ? 1 : 0;
 
         // Construct FU payload: PayloadHdr (2 bytes) + FU header (1 byte) + fragment data
-        auto payload = std::make_shared<lmcore::DataBuffer>(3 + fragment_size);
+        auto &payload = packet->payload;
         payload->Assign(fu_indicator_byte1);
         payload->Append(fu_indicator_byte2);
         payload->Append(fu_header);
         payload->Append(payload_data + offset, fragment_size);
 
-        packet->payload = payload;
-
-        auto l = listener_.lock();
-        if (l) {
-            l->OnPacket(packet);
-        }
+        sink(packet);
 
         offset += fragment_size;
         first_fragment = false;
     }
 }
 
+// One instantiation per pipeline sink, see rtp_pipeline.h
+template void RtpPacketizerH265::Packetize(const MediaFrame &, ListenerSink &);
+template void RtpPacketizerH265::Packetize(const MediaFrame &, TransportSink<UdpRtpTransportAdapter> &);
+template void RtpPacketizerH265::Packetize(const MediaFrame &, TransportSink<TcpInterleavedTransportAdapter> &);
+#ifdef LMRTSP_ENABLE_IO_URING
+template void RtpPacketizerH265::Packetize(const MediaFrame &, TransportSink<IoUringRtpTransportAdapter> &);
+#endif
+
 } // namespace lmshao::lmrtsp
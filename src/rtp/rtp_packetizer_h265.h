@@ -14,6 +14,7 @@
 
 #include "i_rtp_packetizer.h"
 #include "lmrtsp/media_types.h"
+#include "rtp_packet_recycler.h"
 
 namespace lmshao::lmrtsp {
 
@@ -31,12 +32,20 @@ public:
 
     void SubmitFrame(const std::shared_ptr<MediaFrame> &frame) override;
 
+    /**
+     * @brief Packetize a frame into the given sink, see rtp_packet_sink.h
+     */
+    template <typename Sink>
+    void Packetize(const MediaFrame &frame, Sink &sink);
+
 private:
     static const uint8_t *FindStartCode(const uint8_t *data, size_t size);
     static const uint8_t *FindNextStartCode(const uint8_t *data, size_t size);
 
-    void PacketizeSingleNalu(const uint8_t *nalu, size_t nalu_size, uint32_t timestamp, bool last_nalu);
-    void PacketizeFuA(const uint8_t *nalu, size_t nalu_size, uint32_t timestamp, bool last_nalu);
+    template <typename Sink>
+    void PacketizeSingleNalu(const uint8_t *nalu, size_t nalu_size, uint32_t timestamp, bool last_nalu, Sink &sink);
+    template <typename Sink>
+    void PacketizeFuA(const uint8_t *nalu, size_t nalu_size, uint32_t timestamp, bool last_nalu, Sink &sink);
 
 private:
     uint32_t ssrc_ = 0;
@@ -44,6 +53,7 @@ private:
     uint8_t payloadType_ = 98;   // dynamic for H265
     uint32_t clockRate_ = 90000; // H265 clock
     uint32_t mtuSize_ = 1400;    // default MTU
+    RtpPacketRecycler recycler_; // Reuses the packet once the sink lets go of it
 };
 
 } // namespace lmshao::lmrtsp
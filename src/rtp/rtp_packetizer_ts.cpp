@@ -9,36 +9,75 @@
 #include "rtp_packetizer_ts.h"
 
 #include "internal_logger.h"
+#include "rtp_packet_sink.h"
+#include "tcp_interleaved_transport_adapter.h"
+#include "udp_rtp_transport_adapter.h"
+#ifdef LMRTSP_ENABLE_IO_URING
+#include "io_uring_rtp_transport_adapter.h"
+#endif
 
 namespace lmshao::lmrtsp {
 
 void RtpPacketizerTs::SubmitFrame(const std::shared_ptr<MediaFrame> &frame)
 {
-    if (!frame || !frame->data || frame->data->Size() == 0) {
-        LMRTSP_LOGW("SubmitFrame: invalid frame");
+    auto l = listener_.lock();
+    if (!l) {
+        LMRTSP_LOGW("SubmitFrame: no listener");
         return;
     }
 
-    if (frame->media_type != MediaType::MP2T) {
-        LMRTSP_LOGW("SubmitFrame: not MP2T media type");
+    if (!frame) {
+        LMRTSP_LOGW("SubmitFrame: invalid frame");
         return;
     }
 
-    const uint8_t *data = frame->data->Data();
-    size_t size = frame->data->Size();
+    ListenerSink sink(l.get());
+    Packetize(*frame, sink);
+}
 
-    LMRTSP_LOGD("Packetizing TS data: size=%zu, timestamp=%u", size, frame->timestamp);
-    PacketizeTs(data, size, frame->timestamp);
+void RtpPacketizerTs::SetFilter(const TSFilterConfig &config)
+{
+    if (config.IsEnabled()) {
+        remuxer_ = std::make_unique<TSRemuxer>(config);
+    } else {
+        remuxer_.reset();
+    }
 }
 
-void RtpPacketizerTs::PacketizeTs(const uint8_t *data, size_t size, uint32_t timestamp)
+template <typename Sink>
+void RtpPacketizerTs::Packetize(const MediaFrame &frame, Sink &sink)
 {
-    auto l = listener_.lock();
-    if (!l) {
-        LMRTSP_LOGW("PacketizeTs: no listener");
+    if (!frame.data || frame.data->Size() == 0) {
+        LMRTSP_LOGW("Packetize: invalid frame");
         return;
     }
 
+    if (frame.media_type != MediaType::MP2T) {
+        LMRTSP_LOGW("Packetize: not MP2T media type");
+        return;
+    }
+
+    const uint8_t *data = frame.data->Data();
+    size_t size = frame.data->Size();
+
+    if (remuxer_) {
+        if (filtered_.size() < size) {
+            filtered_.resize(size);
+        }
+        size = remuxer_->Filter(data, size, filtered_.data());
+        data = filtered_.data();
+        if (size == 0) {
+            return;
+        }
+    }
+
+    LMRTSP_LOGD("Packetizing TS data: size=%zu, timestamp=%u", size, frame.timestamp);
+    PacketizeTs(data, size, frame.timestamp, sink);
+}
+
+template <typename Sink>
+void RtpPacketizerTs::PacketizeTs(const uint8_t *data, size_t size, uint32_t timestamp, Sink &sink)
+{
     // Calculate how many TS packets (188 bytes) fit in one RTP payload
     size_t maxTsPacketsPerRtp = (mtuSize_ - 12) / TS_PACKET_SIZE; // 12 bytes RTP header
     if (maxTsPacketsPerRtp == 0) {
@@ -61,7 +100,7 @@ void RtpPacketizerTs::PacketizeTs(const uint8_t *data, size_t size, uint32_t tim
         size_t payloadSize = tsPacketsInThisRtp * TS_PACKET_SIZE;
 
         // Create RTP packet
-        auto rtpPacket = std::make_shared<RtpPacket>();
+        auto rtpPacket = recycler_.Acquire(payloadSize);
         rtpPacket->version = 2;
         rtpPacket->padding = 0;
         rtpPacket->extension = 0;
@@ -73,14 +112,12 @@ void RtpPacketizerTs::PacketizeTs(const uint8_t *data, size_t size, uint32_t tim
         rtpPacket->ssrc = ssrc_;
 
         // Set payload
-        auto payload = std::make_shared<lmcore::DataBuffer>(payloadSize);
-        payload->Assign(data + offset, payloadSize);
-        rtpPacket->payload = payload;
+        rtpPacket->payload->Assign(data + offset, payloadSize);
 
         LMRTSP_LOGD("Created RTP packet: seq=%u, ts=%u, payload_size=%zu (TS packets=%zu)", rtpPacket->sequence_number,
                     rtpPacket->timestamp, payloadSize, tsPacketsInThisRtp);
 
-        l->OnPacket(rtpPacket);
+        sink(rtpPacket);
 
         offset += payloadSize;
     }
@@ -88,4 +125,12 @@ void RtpPacketizerTs::PacketizeTs(const uint8_t *data, size_t size, uint32_t tim
     LMRTSP_LOGD("TS packetization complete: total_bytes=%zu", size);
 }
 
+// One instantiation per pipeline sink, see rtp_pipeline.h
+template void RtpPacketizerTs::Packetize(const MediaFrame &, ListenerSink &);
+template void RtpPacketizerTs::Packetize(const MediaFrame &, TransportSink<UdpRtpTransportAdapter> &);
+template void RtpPacketizerTs::Packetize(const MediaFrame &, TransportSink<TcpInterleavedTransportAdapter> &);
+#ifdef LMRTSP_ENABLE_IO_URING
+template void RtpPacketizerTs::Packetize(const MediaFrame &, TransportSink<IoUringRtpTransportAdapter> &);
+#endif
+
 } // namespace lmshao::lmrtsp
@@ -15,6 +15,8 @@
 
 #include "i_rtp_packetizer.h"
 #include "lmrtsp/rtp_packet.h"
+#include "lmrtsp/ts_parser.h"
+#include "rtp_packet_recycler.h"
 
 namespace lmshao::lmrtsp {
 
@@ -31,20 +33,38 @@ public:
 
     void SubmitFrame(const std::shared_ptr<MediaFrame> &frame) override;
 
+    /**
+     * @brief Packetize a frame into the given sink, see rtp_packet_sink.h
+     */
+    template <typename Sink>
+    void Packetize(const MediaFrame &frame, Sink &sink);
+
     void SetSsrc(uint32_t ssrc) { ssrc_ = ssrc; }
     void SetPayloadType(uint8_t pt) { payloadType_ = pt; }
     void SetMtuSize(uint32_t mtu) { mtuSize_ = mtu; }
 
+    /**
+     * @brief Drop null packets and unselected elementary streams before packetizing, see TSRemuxer
+     */
+    void SetFilter(const TSFilterConfig &config);
+
+    uint64_t GetDroppedPackets() const { return remuxer_ ? remuxer_->GetDroppedPackets() : 0; }
+
 private:
     static constexpr size_t TS_PACKET_SIZE = 188; // Standard TS packet size
 
-    void PacketizeTs(const uint8_t *data, size_t size, uint32_t timestamp);
+    template <typename Sink>
+    void PacketizeTs(const uint8_t *data, size_t size, uint32_t timestamp, Sink &sink);
 
     uint32_t ssrc_ = 0;
     uint16_t sequenceNumber_ = 0;
     uint8_t payloadType_ = 33;   // Static PT for MP2T (RFC 3551)
     uint32_t clockRate_ = 90000; // 90kHz clock for MPEG-2 TS
     uint32_t mtuSize_ = 1400;    // Default MTU
+    RtpPacketRecycler recycler_; // Reuses the packet once the sink lets go of it
+
+    std::unique_ptr<TSRemuxer> remuxer_;
+    std::vector<uint8_t> filtered_; // Remux output, the frame buffer may be shared with other sessions
 };
 
 } // namespace lmshao::lmrtsp
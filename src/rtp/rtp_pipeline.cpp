@@ -0,0 +1,63 @@
+/**
+ * @author SHAO Liming <lmshao@163.com>
+ * @copyright Copyright (c) 2025 SHAO Liming
+ * @license MIT
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "rtp_pipeline.h"
+
+#include "internal_logger.h"
+#include "tcp_interleaved_transport_adapter.h"
+#include "udp_rtp_transport_adapter.h"
+#ifdef LMRTSP_ENABLE_IO_URING
+#include "io_uring_rtp_transport_adapter.h"
+#endif
+
+namespace lmshao::lmrtsp {
+
+namespace {
+// One row per codec, indexed by PipelineTransport
+template <typename CodecTraits>
+constexpr PipelineFunc PIPELINE_ROW[static_cast<size_t>(PipelineTransport::COUNT)] = {
+    &Pipeline<CodecTraits, UdpRtpTransportAdapter>::Send,
+#ifdef LMRTSP_ENABLE_IO_URING
+    &Pipeline<CodecTraits, IoUringRtpTransportAdapter>::Send,
+#else
+    nullptr,
+#endif
+    &Pipeline<CodecTraits, TcpInterleavedTransportAdapter>::Send,
+};
+
+template <typename CodecTraits>
+PipelineFunc Lookup(PipelineTransport transport)
+{
+    PipelineFunc func = PIPELINE_ROW<CodecTraits>[static_cast<size_t>(transport)];
+    LMRTSP_LOGD("Selected %s pipeline for transport %d: %s", CodecTraits::NAME, static_cast<int>(transport),
+                func ? "static" : "none");
+    return func;
+}
+} // namespace
+
+PipelineFunc SelectPipeline(MediaType codec, PipelineTransport transport)
+{
+    if (transport >= PipelineTransport::COUNT) {
+        return nullptr;
+    }
+
+    switch (codec) {
+        case MediaType::H264:
+            return Lookup<H264CodecTraits>(transport);
+        case MediaType::H265:
+            return Lookup<H265CodecTraits>(transport);
+        case MediaType::AAC:
+            return Lookup<AacCodecTraits>(transport);
+        case MediaType::MP2T:
+            return Lookup<TsCodecTraits>(transport);
+        default:
+            return nullptr;
+    }
+}
+
+} // namespace lmshao::lmrtsp
@@ -0,0 +1,84 @@
+/**
+ * @author SHAO Liming <lmshao@163.com>
+ * @copyright Copyright (c) 2025 SHAO Liming
+ * @license MIT
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef LMSHAO_LMRTSP_RTP_PIPELINE_H
+#define LMSHAO_LMRTSP_RTP_PIPELINE_H
+
+#include <cstdint>
+
+#include "lmrtsp/media_types.h"
+#include "rtp_packet_sink.h"
+#include "rtp_packetizer_aac.h"
+#include "rtp_packetizer_h264.h"
+#include "rtp_packetizer_h265.h"
+#include "rtp_packetizer_ts.h"
+
+namespace lmshao::lmrtsp {
+
+class IRtpTransportAdapter;
+
+// Codec traits, map a media type to its packetizer
+struct H264CodecTraits {
+    using Packetizer = RtpPacketizerH264;
+    static constexpr const char *NAME = "H264";
+};
+
+struct H265CodecTraits {
+    using Packetizer = RtpPacketizerH265;
+    static constexpr const char *NAME = "H265";
+};
+
+struct AacCodecTraits {
+    using Packetizer = RtpPacketizerAac;
+    static constexpr const char *NAME = "AAC";
+};
+
+struct TsCodecTraits {
+    using Packetizer = RtpPacketizerTs;
+    static constexpr const char *NAME = "MP2T";
+};
+
+/**
+ * @brief Concrete transport classes a pipeline can be bound to
+ */
+enum class PipelineTransport : uint8_t {
+    UDP = 0,
+    IO_URING,
+    TCP_INTERLEAVED,
+    COUNT
+};
+
+/**
+ * @brief Packetize, serialize and send one frame without virtual calls per packet
+ *
+ * Each codec/transport combination is one instantiation. The packetizer and transport passed in must be of the types
+ * the pipeline was selected for, which SelectPipeline() guarantees as long as the caller reports the transport it
+ * actually created.
+ */
+template <typename CodecTraits, typename Transport>
+struct Pipeline {
+    static void Send(IRtpPacketizer &packetizer, IRtpTransportAdapter &transport, RtcpSenderContext *rtcpContext,
+                     const MediaFrame &frame, int64_t frameTimeNs)
+    {
+        TransportSink<Transport> sink(static_cast<Transport *>(&transport), rtcpContext, frameTimeNs);
+        static_cast<typename CodecTraits::Packetizer &>(packetizer).Packetize(frame, sink);
+    }
+};
+
+using PipelineFunc = void (*)(IRtpPacketizer &packetizer, IRtpTransportAdapter &transport,
+                              RtcpSenderContext *rtcpContext, const MediaFrame &frame, int64_t frameTimeNs);
+
+/**
+ * @brief Look up the pipeline for a codec and transport in the static dispatch table
+ * @return nullptr if the combination has no pipeline, callers fall back to IRtpPacketizer::SubmitFrame()
+ */
+PipelineFunc SelectPipeline(MediaType codec, PipelineTransport transport);
+
+} // namespace lmshao::lmrtsp
+
+#endif // LMSHAO_LMRTSP_RTP_PIPELINE_H
@@ -15,12 +15,14 @@
 #include "i_rtp_depacketizer.h"
 #include "i_rtp_transport_adapter.h"
 #include "internal_logger.h"
-#include "lmcore/time_utils.h"
+#include "io_uring_rtp_transport_adapter.h"
 #include "lmrtsp/rtcp_context.h"
 #include "lmrtsp/rtp_packet.h"
+#include "lmrtsp/rtsp_client_runtime.h"
 #include "rtp_depacketizer_h264.h"
 #include "rtp_depacketizer_h265.h"
 #include "rtp_depacketizer_ts.h"
+#include "shared_udp_transport_adapter.h"
 #include "udp_rtp_transport_adapter.h"
 
 namespace lmshao::lmrtsp {
@@ -86,7 +88,7 @@ private:
     RtpSinkSession *session_;
 };
 
-RtpSinkSession::RtpSinkSession() {}
+RtpSinkSession::RtpSinkSession() : clock_(Clock::Get()) {}
 
 RtpSinkSession::~RtpSinkSession()
 {
@@ -116,10 +118,29 @@ bool RtpSinkSession::Initialize(const RtpSinkSessionConfig &config)
 
     // Create transport adapter based on config
     if (config_.transport.type == TransportConfig::Type::UDP) {
-        auto udp_adapter = std::make_unique<UdpRtpTransportAdapter>();
         transportListener_ = std::make_shared<TransportListener>(this);
-        udp_adapter->SetOnDataListener(transportListener_);
-        transportAdapter_ = std::move(udp_adapter);
+        if (config_.transport.backend == TransportConfig::Backend::SHARED) {
+            auto shared_adapter = std::make_unique<SharedUdpTransportAdapter>();
+            shared_adapter->SetOnDataListener(transportListener_);
+            shared_adapter->SetExpectedSsrc(config_.expected_ssrc);
+            transportAdapter_ = std::move(shared_adapter);
+        } else if (config_.transport.backend == TransportConfig::Backend::IO_URING) {
+#ifdef LMRTSP_ENABLE_IO_URING
+            if (IoUringRtpTransportAdapter::IsSupported(config_.transport.mode)) {
+                auto uring_adapter = std::make_unique<IoUringRtpTransportAdapter>();
+                uring_adapter->SetOnDataListener(transportListener_);
+                transportAdapter_ = std::move(uring_adapter);
+            }
+#endif
+            if (!transportAdapter_) {
+                LMRTSP_LOGW("io_uring backend unavailable, falling back to UDP sockets");
+            }
+        }
+        if (!transportAdapter_) {
+            auto udp_adapter = std::make_unique<UdpRtpTransportAdapter>();
+            udp_adapter->SetOnDataListener(transportListener_);
+            transportAdapter_ = std::move(udp_adapter);
+        }
     } else if (config_.transport.type == TransportConfig::Type::TCP_INTERLEAVED) {
         LMRTSP_LOGE("TCP_INTERLEAVED transport type is not supported in RtpSinkSession");
         return false;
@@ -153,6 +174,8 @@ bool RtpSinkSession::Initialize(const RtpSinkSessionConfig &config)
         rtcpSsrc_ = GenerateRandomSSRC();
         rtcpContext_ = RtcpReceiverContext::Create();
         if (rtcpContext_) {
+            rtcpContext_->SetXrEnabled(config_.enable_rtcp_xr);
+            rtcpContext_->SetReducedSize(config_.rtcp_reduced_size);
             // RTCP context will be fully initialized when first RTP packet arrives (to get sender SSRC)
             LMRTSP_LOGI("RTCP receiver context created: SSRC=0x%08x (pending sender SSRC)", rtcpSsrc_);
         } else {
@@ -178,7 +201,18 @@ bool RtpSinkSession::Start()
     }
 
     // Setup and start transport
-    if (!transportAdapter_->Setup(config_.transport)) {
+    bool setup = transportAdapter_->Setup(config_.transport);
+    if (!setup && config_.transport.backend != TransportConfig::Backend::DEFAULT) {
+        LMRTSP_LOGW("%s backend setup failed, falling back to UDP sockets",
+                    config_.transport.backend == TransportConfig::Backend::SHARED ? "Shared client runtime"
+                                                                                   : "io_uring");
+        auto udp_adapter = std::make_unique<UdpRtpTransportAdapter>();
+        udp_adapter->SetOnDataListener(transportListener_);
+        transportAdapter_ = std::move(udp_adapter);
+        config_.transport.backend = TransportConfig::Backend::DEFAULT;
+        setup = transportAdapter_->Setup(config_.transport);
+    }
+    if (!setup) {
         LMRTSP_LOGE("Failed to setup transport adapter");
         return false;
     }
@@ -257,8 +291,8 @@ void RtpSinkSession::HandleRtpData(std::shared_ptr<lmcore::DataBuffer> buffer)
 
     // Update RTCP statistics
     if (rtcpContext_) {
-        rtcpContext_->OnRtp(rtp_packet->sequence_number, rtp_packet->timestamp, lmcore::TimeUtils::GetCurrentTimeMs(),
-                            90000, // 90kHz for video
+        rtcpContext_->OnRtp(rtp_packet->sequence_number, rtp_packet->timestamp,
+                            rtcpContext_->GetClock().MonotonicNs(), 90000, // 90kHz for video
                             buffer->Size());
     }
 
@@ -321,8 +355,10 @@ void RtpSinkSession::HandleDepacketizerError(int code, const std::string &messag
 void RtpSinkSession::StartRtcpTimer()
 {
     if (!rtcpTimer_) {
-        rtcpTimer_ = std::make_unique<lmcore::AsyncTimer>(1);
-        rtcpTimer_->Start();
+        // Shared sessions report from the runtime's timer thread instead of one timer thread each
+        rtcpTimer_ = config_.transport.backend == TransportConfig::Backend::SHARED
+                         ? RtspClientRuntime::GetInstance().CreateTimer()
+                         : clock_->CreateTimer();
     }
 
     // Schedule repeating RTCP report
@@ -335,7 +371,7 @@ void RtpSinkSession::StopRtcpTimer()
 {
     if (rtcpTimer_ && rtcpTimerId_ != 0) {
         rtcpTimer_->Cancel(rtcpTimerId_);
-        rtcpTimer_->Stop();
+        rtcpTimer_.reset();
         rtcpTimerId_ = 0;
         LMRTSP_LOGI("RTCP timer stopped");
     }
@@ -347,13 +383,11 @@ void RtpSinkSession::SendRtcpReport()
         return;
     }
 
-    // Create compound packet (RR + SDES) if CNAME is provided, otherwise just RR
+    // RR, plus SDES if CNAME is provided and XR if there is an extended report
     std::shared_ptr<lmcore::DataBuffer> rtcpPacket;
-
-    if (!config_.rtcp_cname.empty()) {
+    {
+        std::lock_guard<std::mutex> lock(rtcpMutex_);
         rtcpPacket = rtcpContext_->CreateCompoundPacket(config_.rtcp_cname, config_.rtcp_name);
-    } else {
-        rtcpPacket = rtcpContext_->CreateRtcpRr();
     }
 
     if (rtcpPacket && rtcpPacket->Size() > 0) {
@@ -367,4 +401,44 @@ void RtpSinkSession::SendRtcpReport()
     }
 }
 
+bool RtpSinkSession::SendNack(const std::vector<uint16_t> &lostSeqs)
+{
+    if (!rtcpContext_) {
+        return false;
+    }
+    return SendRtcpFeedback(rtcpContext_->CreateNack(lostSeqs));
+}
+
+bool RtpSinkSession::SendPli()
+{
+    if (!rtcpContext_) {
+        return false;
+    }
+    return SendRtcpFeedback(rtcpContext_->CreatePli());
+}
+
+bool RtpSinkSession::SendRtcpFeedback(const std::shared_ptr<lmcore::DataBuffer> &feedback)
+{
+    if (!running_ || !feedback || !transportAdapter_) {
+        return false;
+    }
+
+    // Alone with reduced-size RTCP, otherwise in an early RR + SDES compound
+    std::shared_ptr<lmcore::DataBuffer> rtcpPacket;
+    {
+        std::lock_guard<std::mutex> lock(rtcpMutex_);
+        rtcpPacket = rtcpContext_->CreateFeedbackPacket(feedback, config_.rtcp_cname);
+    }
+    if (!rtcpPacket) {
+        return false;
+    }
+
+    if (!transportAdapter_->SendRtcpPacket(rtcpPacket->Data(), rtcpPacket->Size())) {
+        LMRTSP_LOGW("Failed to send RTCP feedback");
+        return false;
+    }
+    LMRTSP_LOGD("RTCP feedback sent: size=%zu, reduced-size=%d", rtcpPacket->Size(), rtcpContext_->IsReducedSize());
+    return true;
+}
+
 } // namespace lmshao::lmrtsp
\ No newline at end of file
@@ -8,23 +8,30 @@
 
 #include "lmrtsp/rtp_source_session.h"
 
+#include <algorithm>
 #include <random>
 
 #include "i_rtp_packetizer.h"
 #include "i_rtp_transport_adapter.h"
 #include "internal_logger.h"
-#include "lmcore/time_utils.h"
+#include "io_uring_rtp_transport_adapter.h"
+#include "lmrtsp/cpu_accounting.h"
+#include "lmrtsp/egress_shaper.h"
 #include "lmrtsp/rtcp_context.h"
 #include "rtp_packetizer_aac.h"
 #include "rtp_packetizer_h264.h"
 #include "rtp_packetizer_h265.h"
 #include "rtp_packetizer_ts.h"
+#include "rtp_pipeline.h"
 #include "tcp_interleaved_transport_adapter.h"
 #include "udp_rtp_transport_adapter.h"
 
 namespace lmshao::lmrtsp {
 
 namespace {
+// RTP, UDP and IPv4 headers of each packet; the interleaved framing over TCP costs about the same
+constexpr size_t PACKET_OVERHEAD_BYTES = 40;
+
 // Generate random SSRC
 uint32_t GenerateRandomSSRC()
 {
@@ -42,6 +49,72 @@ uint16_t GenerateRandomSequenceNumber()
     static std::uniform_int_distribution<uint16_t> dis(1, 0xFFFF);
     return dis(gen);
 }
+
+// Visit the header byte(s) of every NAL unit in an Annex B buffer
+template <typename Visitor>
+void ForEachNalHeader(const uint8_t *data, size_t size, size_t headerSize, Visitor visit)
+{
+    for (size_t i = 0; i + 3 + headerSize <= size; ++i) {
+        if (data[i] == 0 && data[i + 1] == 0 && data[i + 2] == 1) {
+            visit(data + i + 3);
+            i += 2;
+        }
+    }
+}
+
+// Send class of a frame: audio first, then IDR / parameter sets, then frames that are referenced
+SendPriority ClassifyFrame(const MediaFrame &frame)
+{
+    if (frame.media_type == MediaType::AAC) {
+        return SendPriority::CONTROL;
+    }
+
+    if (!frame.data || frame.data->Size() == 0 || frame.media_type == MediaType::MP2T) {
+        return SendPriority::REFERENCE;
+    }
+
+    // Frames classified by their producer need no bitstream scan
+    FrameType frameType = frame.video_param.frame_type;
+    if (frameType != FrameType::UNKNOWN) {
+        if (frameType == FrameType::IDR) {
+            return SendPriority::KEY;
+        }
+        return frame.video_param.is_reference ? SendPriority::REFERENCE : SendPriority::NON_REFERENCE;
+    }
+
+    bool key = frame.video_param.is_key_frame;
+    bool referenced = false;
+    bool hasSlice = false;
+    const uint8_t *data = frame.data->Data();
+    size_t size = frame.data->Size();
+
+    if (frame.media_type == MediaType::H264) {
+        ForEachNalHeader(data, size, 1, [&](const uint8_t *nal) {
+            uint8_t type = nal[0] & 0x1F;
+            if (type == 5 || type == 7 || type == 8) {
+                key = true;
+            } else if (type >= 1 && type <= 4) {
+                hasSlice = true;
+                referenced |= (nal[0] & 0x60) != 0; // nal_ref_idc
+            }
+        });
+    } else if (frame.media_type == MediaType::H265) {
+        ForEachNalHeader(data, size, 2, [&](const uint8_t *nal) {
+            uint8_t type = (nal[0] >> 1) & 0x3F;
+            if ((type >= 16 && type <= 23) || (type >= 32 && type <= 34)) {
+                key = true;
+            } else if (type <= 15) {
+                hasSlice = true;
+                referenced |= (type % 2) != 0; // Even VCL types are sub-layer non-reference pictures
+            }
+        });
+    }
+
+    if (key) {
+        return SendPriority::KEY;
+    }
+    return (hasSlice && !referenced) ? SendPriority::NON_REFERENCE : SendPriority::REFERENCE;
+}
 } // namespace
 
 // Helper class to handle packetized RTP packets
@@ -53,6 +126,7 @@ public:
     }
 
     void SetRtcpContext(RtcpSenderContext *context) { rtcpContext_ = context; }
+    void SetFrameTime(int64_t frameTimeNs) { frameTimeNs_ = frameTimeNs; }
 
     void OnPacket(const std::shared_ptr<RtpPacket> &packet) override
     {
@@ -74,8 +148,8 @@ public:
 
                 // Update RTCP statistics
                 if (rtcpContext_) {
-                    rtcpContext_->OnRtp(packet->sequence_number, packet->timestamp,
-                                        lmcore::TimeUtils::GetCurrentTimeMs(), 90000, // 90kHz for video
+                    rtcpContext_->OnRtp(packet->sequence_number, packet->timestamp, frameTimeNs_,
+                                        90000, // 90kHz for video
                                         serialized->Size());
                 }
             }
@@ -93,9 +167,29 @@ public:
 private:
     IRtpTransportAdapter *transport_;
     RtcpSenderContext *rtcpContext_;
+    int64_t frameTimeNs_ = 0;
 };
 
-RtpSourceSession::RtpSourceSession() {}
+// Receives RTCP from the client on the UDP RTCP port
+class RtpSourceSession::TransportListener : public UdpRtpTransportAdapterListener {
+public:
+    explicit TransportListener(RtpSourceSession *session) : session_(session) {}
+
+    void OnRtpDataReceived(std::shared_ptr<lmcore::DataBuffer> /*buffer*/) override {}
+
+    void OnRtcpDataReceived(std::shared_ptr<lmcore::DataBuffer> buffer) override
+    {
+        if (!session_ || !buffer) {
+            return;
+        }
+        session_->OnRtcpData(*buffer);
+    }
+
+private:
+    RtpSourceSession *session_;
+};
+
+RtpSourceSession::RtpSourceSession() : clock_(Clock::Get()) {}
 
 RtpSourceSession::~RtpSourceSession()
 {
@@ -120,8 +214,28 @@ bool RtpSourceSession::Initialize(const RtpSourceSessionConfig &config)
     timestamp_ = 0;
 
     // Create transport adapter based on config
+    PipelineTransport pipelineTransport = PipelineTransport::UDP;
     if (config_.transport.type == TransportConfig::Type::UDP) {
-        transportAdapter_ = std::make_unique<UdpRtpTransportAdapter>();
+        if (config_.transport.backend == TransportConfig::Backend::IO_URING) {
+#ifdef LMRTSP_ENABLE_IO_URING
+            if (IoUringRtpTransportAdapter::IsSupported(config_.transport.mode)) {
+                transportListener_ = std::make_shared<TransportListener>(this);
+                auto uring_adapter = std::make_unique<IoUringRtpTransportAdapter>();
+                uring_adapter->SetOnDataListener(transportListener_);
+                transportAdapter_ = std::move(uring_adapter);
+                pipelineTransport = PipelineTransport::IO_URING;
+            }
+#endif
+            if (!transportAdapter_) {
+                LMRTSP_LOGW("io_uring backend unavailable, falling back to UDP sockets");
+            }
+        }
+        if (!transportAdapter_) {
+            transportListener_ = std::make_shared<TransportListener>(this);
+            auto udp_adapter = std::make_unique<UdpRtpTransportAdapter>();
+            udp_adapter->SetOnDataListener(transportListener_);
+            transportAdapter_ = std::move(udp_adapter);
+        }
         LMRTSP_LOGD("Using UDP transport adapter: client=%s:%u/%u, server=%u/%u", config_.transport.client_ip.c_str(),
                     config_.transport.client_rtp_port, config_.transport.client_rtcp_port,
                     config_.transport.server_rtp_port, config_.transport.server_rtcp_port);
@@ -132,6 +246,7 @@ bool RtpSourceSession::Initialize(const RtpSourceSessionConfig &config)
             return false;
         }
         transportAdapter_ = std::make_unique<TcpInterleavedTransportAdapter>(config_.rtsp_session);
+        pipelineTransport = PipelineTransport::TCP_INTERLEAVED;
         LMRTSP_LOGI("Created TCP interleaved transport adapter");
     } else {
         return false; // Unsupported transport type
@@ -139,7 +254,16 @@ bool RtpSourceSession::Initialize(const RtpSourceSessionConfig &config)
 
     // Setup transport immediately (needed for port allocation)
     if (transportAdapter_) {
-        if (!transportAdapter_->Setup(config_.transport)) {
+        bool setup = transportAdapter_->Setup(config_.transport);
+        if (!setup && pipelineTransport == PipelineTransport::IO_URING) {
+            LMRTSP_LOGW("io_uring transport setup failed, falling back to UDP sockets");
+            auto udp_adapter = std::make_unique<UdpRtpTransportAdapter>();
+            udp_adapter->SetOnDataListener(transportListener_);
+            transportAdapter_ = std::move(udp_adapter);
+            pipelineTransport = PipelineTransport::UDP;
+            setup = transportAdapter_->Setup(config_.transport);
+        }
+        if (!setup) {
             LMRTSP_LOGE("Failed to setup transport in Initialize");
             transportAdapter_.reset();
             return false;
@@ -148,10 +272,12 @@ bool RtpSourceSession::Initialize(const RtpSourceSessionConfig &config)
 
     // Create video packetizer (note: RTCP context will be initialized later)
     if (config_.video_type == MediaType::H264) {
-        videoPacketizer_ =
+        auto h264Packetizer =
             std::make_unique<RtpPacketizerH264>(config_.ssrc, sequenceNumber_, config_.video_payload_type,
                                                 90000, // H264 clock rate
                                                 config_.mtu_size);
+        h264Packetizer->SetParallelThreshold(config_.parallel_packetize_bytes);
+        videoPacketizer_ = std::move(h264Packetizer);
         // Set up listener for video packetizer (RTCP context set after initialization)
         videoListener_ = std::static_pointer_cast<IRtpPacketizerListener>(
             std::make_shared<PacketizerListener>(transportAdapter_.get(), nullptr));
@@ -161,6 +287,7 @@ bool RtpSourceSession::Initialize(const RtpSourceSessionConfig &config)
         tsPacketizer->SetSsrc(config_.ssrc);
         tsPacketizer->SetPayloadType(config_.video_payload_type);
         tsPacketizer->SetMtuSize(config_.mtu_size);
+        tsPacketizer->SetFilter(config_.ts_filter);
         videoPacketizer_ = std::move(tsPacketizer);
         // Set up listener for TS packetizer
         videoListener_ = std::static_pointer_cast<IRtpPacketizerListener>(
@@ -210,6 +337,9 @@ bool RtpSourceSession::Initialize(const RtpSourceSessionConfig &config)
         }
     }
 
+    // Bind the packetizer and transport just created to their static pipeline
+    pipeline_ = SelectPipeline(config_.video_type, pipelineTransport);
+
     initialized_ = true;
     return true;
 }
@@ -266,6 +396,44 @@ void RtpSourceSession::Stop()
     }
 }
 
+size_t RtpSourceSession::GetMemoryUsage() const
+{
+    size_t usage = sizeof(*this) + config_.session_id.capacity() + config_.rtcp_cname.capacity() +
+                   config_.rtcp_name.capacity() + config_.transport.client_ip.capacity();
+
+    if (videoPacketizer_) {
+        switch (config_.video_type) {
+            case MediaType::H264:
+                usage += sizeof(RtpPacketizerH264);
+                break;
+            case MediaType::H265:
+                usage += sizeof(RtpPacketizerH265);
+                break;
+            case MediaType::AAC:
+                usage += sizeof(RtpPacketizerAac);
+                break;
+            case MediaType::MP2T:
+                usage += sizeof(RtpPacketizerTs);
+                break;
+            default:
+                break;
+        }
+    }
+    if (videoListener_) {
+        usage += sizeof(PacketizerListener);
+    }
+    if (rtcpContext_) {
+        usage += sizeof(RtcpSenderContext);
+    }
+    if (rtcpTimer_) {
+        usage += sizeof(Timer);
+    }
+    if (transportAdapter_) {
+        usage += transportAdapter_->GetMemoryUsage();
+    }
+    return usage;
+}
+
 std::string RtpSourceSession::GetTransportInfo() const
 {
     if (transportAdapter_) {
@@ -292,12 +460,50 @@ bool RtpSourceSession::SendFrame(const std::shared_ptr<MediaFrame> &frame)
         return false; // Unsupported media type or no video packetizer
     }
 
+    // Over the egress caps the whole frame is dropped rather than queued, which is not an error for the caller
+    if (config_.egress_shaper && frame->data) {
+        size_t size = frame->data->Size();
+        size_t packets = size / std::max<uint32_t>(config_.mtu_size, PACKET_OVERHEAD_BYTES + 1) + 1;
+        if (!config_.egress_shaper->Admit(*frame, size + packets * PACKET_OVERHEAD_BYTES)) {
+            LMRTSP_LOGD("Frame of %zu bytes dropped by the egress caps", size);
+            return true;
+        }
+    }
+
     LMRTSP_LOGI("About to submit frame to packetizer - frame size: %u", frame->data ? frame->data->Size() : 0);
 
     // Submit frame for packetization
     // The listener is already set up during initialization
     try {
-        videoPacketizer_->SubmitFrame(frame);
+        // Kernel-paced frames leave at their departure time, which also anchors the RTCP sender report mapping
+        bool paced = transportAdapter_ && frame->departure_ns > 0 && transportAdapter_->HasKernelPacing();
+        if (transportAdapter_) {
+            transportAdapter_->SetSendPriority(ClassifyFrame(*frame));
+            if (paced) {
+                transportAdapter_->SetDeparture(frame->departure_ns, frame->departure_span_ns);
+            }
+        }
+        CpuAccount *cpuAccount = config_.cpu_account.get();
+        // One clock read per frame, all of its packets leave within the same burst
+        int64_t frameTimeNs = rtcpContext_ ? (paced ? frame->departure_ns : clock_->MonotonicNs()) : 0;
+        {
+            CpuScope scope(cpuAccount, CpuStage::PACKETIZE);
+            if (pipeline_ && transportAdapter_) {
+                pipeline_(*videoPacketizer_, *transportAdapter_, rtcpContext_.get(), *frame, frameTimeNs);
+            } else {
+                if (videoListener_) {
+                    static_cast<PacketizerListener *>(videoListener_.get())->SetFrameTime(frameTimeNs);
+                }
+                videoPacketizer_->SubmitFrame(frame);
+            }
+        }
+        if (transportAdapter_) {
+            CpuScope scope(cpuAccount, CpuStage::SEND);
+            transportAdapter_->Flush();
+        }
+        if (cpuAccount && CpuAccount::IsEnabled() && frame->data) {
+            cpuAccount->AddSent(frame->data->Size());
+        }
         LMRTSP_LOGI("Frame submitted to packetizer successfully");
     } catch (const std::exception &e) {
         LMRTSP_LOGE("Exception in SubmitFrame: %s", e.what());
@@ -314,8 +520,7 @@ bool RtpSourceSession::SendFrame(const std::shared_ptr<MediaFrame> &frame)
 void RtpSourceSession::StartRtcpTimer()
 {
     if (!rtcpTimer_) {
-        rtcpTimer_ = std::make_unique<lmcore::AsyncTimer>(1);
-        rtcpTimer_->Start();
+        rtcpTimer_ = clock_->CreateTimer();
     }
 
     // Schedule repeating RTCP report
@@ -328,12 +533,22 @@ void RtpSourceSession::StopRtcpTimer()
 {
     if (rtcpTimer_ && rtcpTimerId_ != 0) {
         rtcpTimer_->Cancel(rtcpTimerId_);
-        rtcpTimer_->Stop();
+        rtcpTimer_.reset();
         rtcpTimerId_ = 0;
         LMRTSP_LOGI("RTCP timer stopped");
     }
 }
 
+void RtpSourceSession::OnRtcpData(const lmcore::DataBuffer &buffer)
+{
+    if (!rtcpContext_) {
+        return;
+    }
+
+    rtcpContext_->OnRtcp(buffer);
+    LMRTSP_LOGD("Processed RTCP packet from receiver: size=%zu", buffer.Size());
+}
+
 void RtpSourceSession::SendRtcpReport()
 {
     if (!rtcpContext_ || !transportAdapter_) {
@@ -342,14 +557,8 @@ void RtpSourceSession::SendRtcpReport()
         return;
     }
 
-    // Create compound packet (SR + SDES) if CNAME is provided, otherwise just SR
-    std::shared_ptr<lmcore::DataBuffer> rtcpPacket;
-
-    if (!config_.rtcp_cname.empty()) {
-        rtcpPacket = rtcpContext_->CreateCompoundPacket(config_.rtcp_cname, config_.rtcp_name);
-    } else {
-        rtcpPacket = rtcpContext_->CreateRtcpSr();
-    }
+    // SR, plus SDES if CNAME is provided and XR if there is an extended report
+    auto rtcpPacket = rtcpContext_->CreateCompoundPacket(config_.rtcp_cname, config_.rtcp_name);
 
     if (rtcpPacket && rtcpPacket->Size() > 0) {
         LMRTSP_LOGD("RTCP report ready: size=%zu, cname=%s", rtcpPacket->Size(),
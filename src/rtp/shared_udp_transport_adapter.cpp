@@ -0,0 +1,107 @@
+/**
+ * @author SHAO Liming <lmshao@163.com>
+ * @copyright Copyright (c) 2025 SHAO Liming
+ * @license MIT
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "shared_udp_transport_adapter.h"
+
+#include <sstream>
+
+#include "internal_logger.h"
+
+namespace lmshao::lmrtsp {
+
+SharedUdpTransportAdapter::~SharedUdpTransportAdapter()
+{
+    Close();
+}
+
+bool SharedUdpTransportAdapter::Setup(const TransportConfig &config)
+{
+    if (config.mode != TransportConfig::Mode::SINK) {
+        LMRTSP_LOGE("Shared UDP transport only supports SINK mode");
+        return false;
+    }
+    if (config.client_rtp_port == 0) {
+        LMRTSP_LOGE("Client RTP port not configured for shared UDP transport");
+        return false;
+    }
+
+    config_ = config;
+    auto &runtime = RtspClientRuntime::GetInstance();
+
+    rtpReceiver_ = runtime.AddReceiver(config_.client_rtp_port, RtspClientRuntime::PacketType::RTP, ssrc_,
+                                       [this](std::shared_ptr<lmcore::DataBuffer> buffer) {
+                                           if (listener_) {
+                                               listener_->OnRtpDataReceived(buffer);
+                                           }
+                                       });
+    if (rtpReceiver_ == 0) {
+        LMRTSP_LOGE("Failed to receive RTP on shared port %u", config_.client_rtp_port);
+        return false;
+    }
+
+    // RTCP is enabled when the server announced its RTCP port, same as UdpRtpTransportAdapter
+    if (config_.server_rtcp_port != 0 && config_.client_rtcp_port != 0) {
+        rtcpReceiver_ = runtime.AddReceiver(config_.client_rtcp_port, RtspClientRuntime::PacketType::RTCP, ssrc_,
+                                            [this](std::shared_ptr<lmcore::DataBuffer> buffer) {
+                                                if (listener_) {
+                                                    listener_->OnRtcpDataReceived(buffer);
+                                                }
+                                            });
+        if (rtcpReceiver_ == 0) {
+            LMRTSP_LOGE("Failed to receive RTCP on shared port %u", config_.client_rtcp_port);
+            Close();
+            return false;
+        }
+    }
+
+    active_ = true;
+    LMRTSP_LOGI("Shared UDP transport set up: RTP port %u, RTCP port %u, SSRC 0x%08x", config_.client_rtp_port,
+                rtcpReceiver_ != 0 ? config_.client_rtcp_port : 0, ssrc_);
+    return true;
+}
+
+bool SharedUdpTransportAdapter::SendPacket(const uint8_t *data, size_t size)
+{
+    (void)data;
+    (void)size;
+    LMRTSP_LOGE("SINK mode typically doesn't send RTP packets");
+    return false;
+}
+
+bool SharedUdpTransportAdapter::SendRtcpPacket(const uint8_t *data, size_t size)
+{
+    (void)data;
+    (void)size;
+    LMRTSP_LOGE("SINK mode typically doesn't send RTCP packets");
+    return false;
+}
+
+void SharedUdpTransportAdapter::Close()
+{
+    active_ = false;
+
+    auto &runtime = RtspClientRuntime::GetInstance();
+    if (rtpReceiver_ != 0) {
+        runtime.RemoveReceiver(rtpReceiver_);
+        rtpReceiver_ = 0;
+    }
+    if (rtcpReceiver_ != 0) {
+        runtime.RemoveReceiver(rtcpReceiver_);
+        rtcpReceiver_ = 0;
+    }
+}
+
+std::string SharedUdpTransportAdapter::GetTransportInfo() const
+{
+    std::ostringstream oss;
+    oss << "UDP;unicast;client_port=" << config_.client_rtp_port << "-" << config_.client_rtcp_port
+        << ";server_port=" << config_.server_rtp_port << "-" << config_.server_rtcp_port;
+    return oss.str();
+}
+
+} // namespace lmshao::lmrtsp
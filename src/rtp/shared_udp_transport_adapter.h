@@ -0,0 +1,56 @@
+/**
+ * @author SHAO Liming <lmshao@163.com>
+ * @copyright Copyright (c) 2025 SHAO Liming
+ * @license MIT
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef LMSHAO_LMRTSP_SHARED_UDP_TRANSPORT_ADAPTER_H
+#define LMSHAO_LMRTSP_SHARED_UDP_TRANSPORT_ADAPTER_H
+
+#include <memory>
+#include <string>
+
+#include "i_rtp_transport_adapter.h"
+#include "lmrtsp/rtsp_client_runtime.h"
+#include "udp_rtp_transport_adapter.h"
+
+namespace lmshao::lmrtsp {
+
+/**
+ * @brief SINK-only UDP transport served by the RtspClientRuntime receive reactors
+ *
+ * Registers receivers for the client RTP/RTCP ports instead of opening its own sockets and threads. With an expected
+ * SSRC set, several sessions can share one port pair.
+ */
+class SharedUdpTransportAdapter final : public IRtpTransportAdapter {
+public:
+    SharedUdpTransportAdapter() = default;
+    ~SharedUdpTransportAdapter() override;
+
+    bool Setup(const TransportConfig &config) override;
+    bool SendPacket(const uint8_t *data, size_t size) override;
+    bool SendRtcpPacket(const uint8_t *data, size_t size) override;
+    void Close() override;
+    std::string GetTransportInfo() const override;
+    bool IsActive() const override { return active_; }
+    size_t GetMemoryUsage() const override { return sizeof(*this); }
+
+    void SetOnDataListener(std::shared_ptr<UdpRtpTransportAdapterListener> listener) { listener_ = listener; }
+    void SetExpectedSsrc(uint32_t ssrc) { ssrc_ = ssrc; }
+
+private:
+    TransportConfig config_{};
+    bool active_ = false;
+    uint32_t ssrc_ = 0;
+
+    RtspClientRuntime::ReceiverId rtpReceiver_ = 0;
+    RtspClientRuntime::ReceiverId rtcpReceiver_ = 0;
+
+    std::shared_ptr<UdpRtpTransportAdapterListener> listener_{};
+};
+
+} // namespace lmshao::lmrtsp
+
+#endif // LMSHAO_LMRTSP_SHARED_UDP_TRANSPORT_ADAPTER_H
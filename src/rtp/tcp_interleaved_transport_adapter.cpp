@@ -8,6 +8,7 @@
 
 #include "tcp_interleaved_transport_adapter.h"
 
+#include <atomic>
 #include <sstream>
 
 #include "internal_logger.h"
@@ -57,6 +58,14 @@ bool TcpInterleavedTransportAdapter::Setup(const TransportConfig &config)
     return true;
 }
 
+void TcpInterleavedTransportAdapter::SetSendPriority(SendPriority priority)
+{
+    // Unique across adapters, tracks of one session share its send queue
+    static std::atomic<uint64_t> nextFrame{1};
+    priority_ = priority;
+    frame_ = nextFrame.fetch_add(1, std::memory_order_relaxed);
+}
+
 bool TcpInterleavedTransportAdapter::SendPacket(const uint8_t *data, size_t size)
 {
     if (!isSetup_ || !data || size == 0) {
@@ -71,7 +80,7 @@ bool TcpInterleavedTransportAdapter::SendPacket(const uint8_t *data, size_t size
     }
 
     // Send interleaved RTP data through RTSP session
-    bool ok = session->SendInterleavedData(rtpChannel_, data, size);
+    bool ok = session->SendInterleavedData(rtpChannel_, data, size, priority_, frame_);
     if (!ok) {
         LMRTSP_LOGE("Failed to send interleaved RTP: channel=%d, size=%zu", static_cast<int>(rtpChannel_), size);
     } else {
@@ -93,8 +102,8 @@ bool TcpInterleavedTransportAdapter::SendRtcpPacket(const uint8_t *data, size_t
         return false;
     }
 
-    // Send interleaved RTCP data through RTSP session
-    bool ok = session->SendInterleavedData(rtcpChannel_, data, size);
+    // Send interleaved RTCP data through RTSP session, ahead of queued media
+    bool ok = session->SendInterleavedData(rtcpChannel_, data, size, SendPriority::CONTROL);
     if (!ok) {
         LMRTSP_LOGE("Failed to send interleaved RTCP: channel=%d, size=%zu", static_cast<int>(rtcpChannel_), size);
     } else {
@@ -18,7 +18,7 @@ namespace lmshao::lmrtsp {
 
 class RtspServerSession;
 
-class TcpInterleavedTransportAdapter : public IRtpTransportAdapter {
+class TcpInterleavedTransportAdapter final : public IRtpTransportAdapter {
 public:
     explicit TcpInterleavedTransportAdapter(std::weak_ptr<RtspServerSession> session);
     ~TcpInterleavedTransportAdapter() override;
@@ -26,9 +26,12 @@ public:
     bool Setup(const TransportConfig &config) override;
     bool SendPacket(const uint8_t *data, size_t size) override;
     bool SendRtcpPacket(const uint8_t *data, size_t size) override;
+    // Called once per frame, so it also starts a new frame for the session's send queue
+    void SetSendPriority(SendPriority priority) override;
     void Close() override;
     std::string GetTransportInfo() const override;
     bool IsActive() const override;
+    size_t GetMemoryUsage() const override { return sizeof(*this) + transportInfo_.capacity(); }
 
 private:
     bool ValidateChannels(uint8_t rtpChannel, uint8_t rtcpChannel) const;
@@ -37,6 +40,8 @@ private:
     uint8_t rtpChannel_{0};
     uint8_t rtcpChannel_{1};
     bool isSetup_{false};
+    SendPriority priority_{SendPriority::REFERENCE};
+    uint64_t frame_{0}; // Frame of the packets handed to SendPacket, 0 before the first SetSendPriority
     std::string transportInfo_;
 };
 
@@ -14,12 +14,38 @@
 #include <lmnet/udp_server.h>
 #include <lmrtsp/rtp_packet.h>
 
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
 #include <sstream>
 
+#ifdef __linux__
+#include <arpa/inet.h>
+#include <linux/net_tstamp.h>
+#include <linux/sockios.h>
+#include <netinet/in.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <time.h>
+#endif
+
 #include "internal_logger.h"
+#include "lmrtsp/clock.h"
+#include "lmrtsp/cpu_affinity.h"
 
 namespace lmshao::lmrtsp {
 
+namespace {
+// Attempts to find an idle port pair that is not reserved by another session
+constexpr int PORT_ALLOCATION_ATTEMPTS = 16;
+// fq drops packets due beyond its horizon (10 s by default), departures are clamped well inside it
+constexpr int64_t MAX_DEPARTURE_AHEAD_NS = 1000000000;
+} // namespace
+
+std::mutex UdpRtpTransportAdapter::reservedPortsMutex_;
+std::set<uint16_t> UdpRtpTransportAdapter::reservedPorts_;
+
 // UdpServerReceiveListener implementation
 UdpRtpTransportAdapter::UdpServerReceiveListener::UdpServerReceiveListener(UdpRtpTransportAdapter *adapter,
                                                                            ListenerMode mode)
@@ -146,6 +172,12 @@ bool UdpRtpTransportAdapter::SendPacket(const uint8_t *data, size_t size)
 
     // In SERVER mode, use UdpClient to send data (client was created with remote address)
     if (config_.mode == TransportConfig::Mode::SOURCE && rtp_client_) {
+        // A frame with a departure time is held until Flush() stamps its packets, batching holds every frame
+        if ((txtime_ && departureNs_ > 0) || batch_) {
+            heldPackets_.emplace_back(heldSlab_.size(), size);
+            heldSlab_.insert(heldSlab_.end(), data, data + size);
+            return true;
+        }
         result = rtp_client_->Send(data, size);
     }
     // In CLIENT mode, typically we don't send RTP packets
@@ -214,9 +246,79 @@ bool UdpRtpTransportAdapter::SendRtcpPacket(const uint8_t *data, size_t size)
     return result;
 }
 
+void UdpRtpTransportAdapter::SetDeparture(int64_t startNs, int64_t spanNs)
+{
+    if (!txtime_) {
+        return;
+    }
+    departureNs_ = startNs;
+    departureSpanNs_ = std::max<int64_t>(spanNs, 0);
+}
+
+void UdpRtpTransportAdapter::Flush()
+{
+    if (!heldPackets_.empty() && rtp_client_) {
+        bool paced = txtime_ && departureNs_ > 0;
+        int error = 0;
+        size_t sent = SendHeldPackets(paced, error);
+        if (sent < heldPackets_.size()) {
+            // Only a rejected departure time ends kernel pacing, a full send buffer does not. Without departure
+            // times the caller's userspace pacing takes over from the next frame.
+            if (paced && error == EINVAL) {
+                LMRTSP_LOGW("Kernel pacing rejected for %s:%u, falling back to userspace pacing", client_ip_.c_str(),
+                            clientRtpPort_);
+                txtime_ = false;
+            }
+            for (size_t i = sent; i < heldPackets_.size(); ++i) {
+                if (!rtp_client_->Send(heldSlab_.data() + heldPackets_[i].first, heldPackets_[i].second)) {
+                    LMRTSP_LOGE("Failed to send RTP packet to %s:%u", client_ip_.c_str(), clientRtpPort_);
+                }
+            }
+        }
+    }
+
+    heldPackets_.clear();
+    heldSlab_.clear();
+    departureNs_ = 0;
+    departureSpanNs_ = 0;
+}
+
+size_t UdpRtpTransportAdapter::GetMemoryUsage() const
+{
+    size_t bytes = sizeof(*this) + heldSlab_.capacity() + heldPackets_.capacity() * sizeof(heldPackets_[0]) +
+                   pacedControl_.capacity();
+#ifdef __linux__
+    bytes += sendIovs_.capacity() * sizeof(struct iovec) + sendMsgs_.capacity() * sizeof(struct mmsghdr);
+#endif
+    return bytes;
+}
+
+size_t UdpRtpTransportAdapter::GetSendQueueBytes() const
+{
+    return rtp_client_ ? SocketSendQueueBytes(rtp_client_->GetSocketFd()) : 0;
+}
+
+size_t UdpRtpTransportAdapter::SocketSendQueueBytes(int fd)
+{
+#if defined(__linux__) && defined(SIOCOUTQ)
+    int queued = 0;
+    if (fd >= 0 && ioctl(fd, SIOCOUTQ, &queued) == 0 && queued > 0) {
+        return static_cast<size_t>(queued);
+    }
+#else
+    (void)fd;
+#endif
+    return 0;
+}
+
 void UdpRtpTransportAdapter::Close()
 {
     active_ = false;
+    txtime_ = false;
+    batch_ = false;
+    heldPackets_.clear();
+    heldSlab_.clear();
+    departureNs_ = 0;
 
     if (rtp_client_) {
         rtp_client_->Close();
@@ -386,6 +488,15 @@ bool UdpRtpTransportAdapter::InitializeUdpClients()
     }
     rtp_client_listener_ = std::make_shared<UdpClientReceiveListener>(this, ListenerMode::RTP);
     rtp_client_->SetListener(rtp_client_listener_);
+    CpuAffinity::SetIncomingCpu(rtp_client_->GetSocketFd(), config_.incoming_cpu);
+    if (config_.kernel_pacing) {
+        txtime_ = EnableTxTime(rtp_client_->GetSocketFd());
+    }
+#ifdef __linux__
+    // sendmmsg addresses the IPv4 peer explicitly
+    struct in_addr peer_addr {};
+    batch_ = config_.batch_send && inet_pton(AF_INET, client_ip_.c_str(), &peer_addr) == 1;
+#endif
 
     // Create RTCP client only if RTCP is enabled
     if (rtcp_enabled) {
@@ -404,6 +515,7 @@ bool UdpRtpTransportAdapter::InitializeUdpClients()
         }
         rtcp_client_listener_ = std::make_shared<UdpClientReceiveListener>(this, ListenerMode::RTCP);
         rtcp_client_->SetListener(rtcp_client_listener_);
+        CpuAffinity::SetIncomingCpu(rtcp_client_->GetSocketFd(), config_.incoming_cpu);
 
         LMRTSP_LOGI("UDP clients configured: remote %s:%u(RTP), %s:%u(RTCP); local bind %u(RTP), %u(RTCP)",
                     client_ip_.c_str(), clientRtpPort_, client_ip_.c_str(), clientRtcpPort_, rtp_local_port,
@@ -416,11 +528,153 @@ bool UdpRtpTransportAdapter::InitializeUdpClients()
     return true;
 }
 
+bool UdpRtpTransportAdapter::EnableTxTime(int fd)
+{
+#if defined(__linux__) && defined(SO_TXTIME)
+    struct in_addr addr {};
+    if (inet_pton(AF_INET, client_ip_.c_str(), &addr) != 1) {
+        LMRTSP_LOGW("Kernel pacing needs an IPv4 client, %s is paced in userspace", client_ip_.c_str());
+        return false;
+    }
+
+    struct sock_txtime txtime {};
+    txtime.clockid = CLOCK_MONOTONIC;
+    txtime.flags = 0;
+    if (fd < 0 || setsockopt(fd, SOL_SOCKET, SO_TXTIME, &txtime, sizeof(txtime)) != 0) {
+        LMRTSP_LOGW("SO_TXTIME not available on fd %d (%s), pacing in userspace", fd, strerror(errno));
+        return false;
+    }
+    lastTxtimeNs_ = 0;
+    LMRTSP_LOGI("Kernel pacing enabled on fd %d, departure times need the fq qdisc on the egress interface", fd);
+    return true;
+#else
+    (void)fd;
+    LMRTSP_LOGW("SO_TXTIME not supported on this platform, pacing in userspace");
+    return false;
+#endif
+}
+
+int64_t UdpRtpTransportAdapter::PacketDeparture(int64_t startNs, int64_t spanNs, size_t index, size_t count,
+                                                int64_t nowNs, int64_t lastNs)
+{
+    int64_t step = count > 0 ? std::max<int64_t>(spanNs, 0) / static_cast<int64_t>(count) : 0;
+    int64_t departure = startNs + static_cast<int64_t>(index) * step;
+    return std::min(std::max(departure, lastNs), nowNs + MAX_DEPARTURE_AHEAD_NS);
+}
+
+size_t UdpRtpTransportAdapter::SendHeldPackets(bool paced, int &error)
+{
+    error = 0;
+#ifdef __linux__
+    size_t count = heldPackets_.size();
+#ifdef SO_TXTIME
+    // Departures are in Clock::MonotonicNs() time, the qdisc compares them against CLOCK_MONOTONIC
+    int64_t kernelNow = 0;
+    int64_t start = 0;
+    size_t controlSize = CMSG_SPACE(sizeof(uint64_t));
+    if (paced) {
+        struct timespec ts {};
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        kernelNow = static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+        start = departureNs_ + kernelNow - Clock::Get()->MonotonicNs();
+        pacedControl_.assign(count * controlSize, 0);
+    }
+#else
+    paced = false;
+#endif
+    sendIovs_.resize(count);
+    sendMsgs_.assign(count, mmsghdr{});
+
+    // Addressed explicitly, the lmnet socket is not necessarily connected
+    struct sockaddr_in peer {};
+    peer.sin_family = AF_INET;
+    peer.sin_port = htons(clientRtpPort_);
+    inet_pton(AF_INET, client_ip_.c_str(), &peer.sin_addr);
+
+    for (size_t i = 0; i < count; ++i) {
+        sendIovs_[i].iov_base = heldSlab_.data() + heldPackets_[i].first;
+        sendIovs_[i].iov_len = heldPackets_[i].second;
+
+        struct msghdr &msg = sendMsgs_[i].msg_hdr;
+        msg.msg_name = &peer;
+        msg.msg_namelen = sizeof(peer);
+        msg.msg_iov = &sendIovs_[i];
+        msg.msg_iovlen = 1;
+#ifdef SO_TXTIME
+        if (!paced) {
+            continue;
+        }
+
+        int64_t departure = PacketDeparture(start, departureSpanNs_, i, count, kernelNow, lastTxtimeNs_);
+        lastTxtimeNs_ = departure;
+
+        msg.msg_control = pacedControl_.data() + i * controlSize;
+        msg.msg_controllen = controlSize;
+
+        struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_TXTIME;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(uint64_t));
+        uint64_t txtime = static_cast<uint64_t>(departure);
+        memcpy(CMSG_DATA(cmsg), &txtime, sizeof(txtime));
+#endif
+    }
+
+    int fd = rtp_client_->GetSocketFd();
+    size_t sent = 0;
+    while (sent < count) {
+        int n = sendmmsg(fd, sendMsgs_.data() + sent, static_cast<unsigned int>(count - sent), 0);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            error = errno;
+            LMRTSP_LOGW("sendmmsg%s failed on fd %d: %s", paced ? " with SCM_TXTIME" : "", fd, strerror(error));
+            break;
+        }
+        sent += static_cast<size_t>(n);
+    }
+    return sent;
+#else
+    (void)paced;
+    return 0;
+#endif
+}
+
 uint16_t UdpRtpTransportAdapter::FindAvailablePortPair(uint16_t start_port)
 {
-    // Use lmnet helper to get an idle even port for RTP (RTCP will be +1)
     (void)start_port; // unused
-    return lmnet::UdpServer::GetIdlePortPair();
+    return GetIdlePortPair();
+}
+
+uint16_t UdpRtpTransportAdapter::GetIdlePortPair()
+{
+    std::lock_guard<std::mutex> lock(reservedPortsMutex_);
+    for (int i = 0; i < PORT_ALLOCATION_ATTEMPTS; ++i) {
+        // Use lmnet helper to get an idle even port for RTP (RTCP will be +1)
+        uint16_t port = lmnet::UdpServer::GetIdlePortPair();
+        if (port == 0 || reservedPorts_.count(port) == 0) {
+            return port;
+        }
+    }
+    LMRTSP_LOGE("No idle port pair outside the reserved set");
+    return 0;
+}
+
+uint16_t UdpRtpTransportAdapter::ReservePortPair()
+{
+    uint16_t port = GetIdlePortPair();
+    if (port != 0) {
+        std::lock_guard<std::mutex> lock(reservedPortsMutex_);
+        reservedPorts_.insert(port);
+    }
+    return port;
+}
+
+void UdpRtpTransportAdapter::ReleasePortPair(uint16_t rtpPort)
+{
+    std::lock_guard<std::mutex> lock(reservedPortsMutex_);
+    reservedPorts_.erase(rtpPort);
 }
 
 void UdpRtpTransportAdapter::OnRtpDataReceived(std::shared_ptr<lmnet::DataBuffer> buffer) const
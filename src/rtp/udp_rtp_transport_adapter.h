@@ -14,8 +14,18 @@
 #include <lmnet/udp_client.h>
 #include <lmnet/udp_server.h>
 
+#include <atomic>
 #include <memory>
+#include <mutex>
+#include <set>
 #include <string>
+#include <utility>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/socket.h>
+#include <sys/uio.h>
+#endif
 
 #include "i_rtp_transport_adapter.h"
 
@@ -29,7 +39,18 @@ public:
     virtual void OnRtcpDataReceived(std::shared_ptr<lmnet::DataBuffer> buffer) = 0;
 };
 
-class UdpRtpTransportAdapter : public IRtpTransportAdapter {
+/**
+ * @brief UDP RTP transport on lmnet sockets
+ *
+ * With TransportConfig::kernel_pacing, SOURCE mode sets SO_TXTIME on the RTP socket. The packets of a frame with a
+ * departure time are then held until Flush() and sent in one sendmmsg, each carrying an SCM_TXTIME so the fq qdisc
+ * releases it on time. Without SO_TXTIME, or once the kernel rejects a departure time (EINVAL), packets go out
+ * immediately and the caller keeps pacing in userspace. A full send buffer does not turn kernel pacing off.
+ *
+ * With TransportConfig::batch_send, SOURCE mode holds every frame's packets until Flush() and sends them in one
+ * sendmmsg, one system call per frame instead of one per packet.
+ */
+class UdpRtpTransportAdapter final : public IRtpTransportAdapter {
 public:
     UdpRtpTransportAdapter();
     ~UdpRtpTransportAdapter() override;
@@ -37,9 +58,21 @@ public:
     bool Setup(const TransportConfig &config) override;
     bool SendPacket(const uint8_t *data, size_t size) override;
     bool SendRtcpPacket(const uint8_t *data, size_t size) override;
+    void Flush() override;
+    void SetDeparture(int64_t startNs, int64_t spanNs) override;
+    bool HasKernelPacing() const override { return txtime_; }
     void Close() override;
     std::string GetTransportInfo() const override;
+
+    /**
+     * @brief Departure of packet index of count spread over spanNs from startNs, in CLOCK_MONOTONIC nanoseconds
+     * @note Never before lastNs, so departures stay in send order, and at most 1 s past nowNs
+     */
+    static int64_t PacketDeparture(int64_t startNs, int64_t spanNs, size_t index, size_t count, int64_t nowNs,
+                                   int64_t lastNs);
     bool IsActive() const override;
+    size_t GetMemoryUsage() const override;
+    size_t GetSendQueueBytes() const override;
 
     void SetOnDataListener(std::shared_ptr<UdpRtpTransportAdapterListener> listener) { listener_ = listener; }
 
@@ -49,6 +82,25 @@ public:
     uint16_t GetClientRtpPort() const { return clientRtpPort_; }
     uint16_t GetClientRtcpPort() const { return clientRtcpPort_; }
 
+    /**
+     * @brief Get an idle even port for RTP (RTCP is +1), skipping reserved pairs
+     */
+    static uint16_t GetIdlePortPair();
+
+    /**
+     * @brief Allocate an idle port pair and keep it reserved while its sockets are not open
+     *
+     * Used by sessions that open their sockets lazily on PLAY and close them on PAUSE.
+     * @return RTP port of the reserved pair, 0 on failure
+     */
+    static uint16_t ReservePortPair();
+    static void ReleasePortPair(uint16_t rtpPort);
+
+    /**
+     * @brief Bytes waiting in the send buffer of a socket (SIOCOUTQ), 0 where unsupported
+     */
+    static size_t SocketSendQueueBytes(int fd);
+
 private:
     void OnRtpDataReceived(std::shared_ptr<lmnet::DataBuffer> buffer) const;
     void OnRtcpDataReceived(std::shared_ptr<lmnet::DataBuffer> buffer) const;
@@ -58,6 +110,9 @@ private:
     bool InitializeUdpServers();
     uint16_t FindAvailablePortPair(uint16_t start_port = 0);
 
+    bool EnableTxTime(int fd);
+    size_t SendHeldPackets(bool paced, int &error);
+
 private:
     enum class ListenerMode {
         RTP,
@@ -115,6 +170,25 @@ private:
     std::shared_ptr<lmnet::IClientListener> rtcp_client_listener_{};
 
     std::shared_ptr<UdpRtpTransportAdapterListener> listener_{};
+
+    // Kernel pacing and batching, owned by the packetizing thread. Packets of the current frame wait in heldSlab_
+    // until Flush()
+    std::atomic<bool> txtime_{false};
+    bool batch_{false};
+    int64_t departureNs_{0};
+    int64_t departureSpanNs_{0};
+    int64_t lastTxtimeNs_{0};                           // CLOCK_MONOTONIC, keeps departures in send order
+    std::vector<uint8_t> heldSlab_;
+    std::vector<std::pair<size_t, size_t>> heldPackets_; // Offset and size in heldSlab_
+    std::vector<uint8_t> pacedControl_;                  // One SCM_TXTIME cmsg per packet
+#ifdef __linux__
+    std::vector<struct iovec> sendIovs_; // sendmmsg arguments, reused from frame to frame
+    std::vector<struct mmsghdr> sendMsgs_;
+#endif
+
+    // Port pairs reserved by idle sessions
+    static std::mutex reservedPortsMutex_;
+    static std::set<uint16_t> reservedPorts_;
 };
 
 } // namespace lmshao::lmrtsp
@@ -0,0 +1,249 @@
+/**
+ * @author SHAO Liming <lmshao@163.com>
+ * @copyright Copyright (c) 2025 SHAO Liming
+ * @license MIT
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "lmrtsp/admission_controller.h"
+
+#include <algorithm>
+#include <thread>
+
+#include "internal_logger.h"
+
+namespace lmshao::lmrtsp {
+
+namespace {
+// Shortest window used to turn the byte and CPU counters into rates
+constexpr int64_t EGRESS_SAMPLE_MIN_MS = 200;
+constexpr int64_t LOAD_SAMPLE_MIN_MS = 200;
+} // namespace
+
+AdmissionController::AdmissionController() : cores_(std::max(1u, std::thread::hardware_concurrency())) {}
+
+void AdmissionController::SetLimits(const AdmissionLimits &limits)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    limits_ = limits;
+    LMRTSP_LOGI("Admission limits: sessions=%zu, egress=%llu bps, utilization=%.2f, send queue=%zu bytes",
+                limits_.max_sessions, static_cast<unsigned long long>(limits_.max_egress_bps),
+                limits_.max_sender_utilization, limits_.max_send_queue_bytes);
+}
+
+AdmissionLimits AdmissionController::GetLimits() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return limits_;
+}
+
+AdmissionDecision AdmissionController::AdmitSetup(const std::string &session_id, const std::string &track,
+                                                  uint64_t stream_bps)
+{
+    int64_t now = clock_->NowMs();
+    SampleLoad(now);
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto it = reservations_.find(session_id);
+    bool new_session = (it == reservations_.end());
+    if (!new_session && it->second.tracks.count(track) > 0) {
+        // Re-SETUP of a reserved track, e.g. to change the transport
+        return AdmissionDecision();
+    }
+
+    if (new_session && limits_.max_sessions > 0 && reservations_.size() >= limits_.max_sessions) {
+        return Reject(503, "session limit reached");
+    }
+
+    std::string reason;
+    if (IsOverloaded(reason)) {
+        return Reject(503, reason);
+    }
+
+    uint64_t bps = EffectiveBps(stream_bps);
+    if (limits_.max_egress_bps > 0) {
+        SampleEgress(now);
+        uint64_t current = std::max(reservedBps_, measuredBps_);
+        if (current + bps > limits_.max_egress_bps) {
+            return Reject(453, "egress budget exhausted");
+        }
+    }
+
+    Reservation &reservation = reservations_[session_id];
+    reservation.bps += bps;
+    reservation.tracks[track] = bps;
+    reservedBps_ += bps;
+
+    LMRTSP_LOGD("Admitted SETUP for session %s track %s: +%llu bps, reserved %llu bps, %zu sessions",
+                session_id.c_str(), track.c_str(), static_cast<unsigned long long>(bps),
+                static_cast<unsigned long long>(reservedBps_), reservations_.size());
+    AdmissionDecision decision;
+    decision.reserved = true;
+    return decision;
+}
+
+AdmissionDecision AdmissionController::AdmitPlay(const std::string &session_id)
+{
+    SampleLoad(clock_->NowMs());
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    std::string reason;
+    if (IsOverloaded(reason)) {
+        LMRTSP_LOGD("PLAY for session %s rejected", session_id.c_str());
+        return Reject(503, reason);
+    }
+    return AdmissionDecision();
+}
+
+void AdmissionController::CancelSetup(const std::string &session_id, const std::string &track)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto it = reservations_.find(session_id);
+    if (it == reservations_.end()) {
+        return;
+    }
+
+    auto track_it = it->second.tracks.find(track);
+    if (track_it == it->second.tracks.end()) {
+        return;
+    }
+
+    it->second.bps -= track_it->second;
+    reservedBps_ -= track_it->second;
+    it->second.tracks.erase(track_it);
+    if (it->second.tracks.empty()) {
+        reservations_.erase(it);
+    }
+}
+
+void AdmissionController::Release(const std::string &session_id)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto it = reservations_.find(session_id);
+    if (it == reservations_.end()) {
+        return;
+    }
+
+    reservedBps_ -= it->second.bps;
+    reservations_.erase(it);
+    LMRTSP_LOGD("Released admission for session %s, reserved %llu bps, %zu sessions", session_id.c_str(),
+                static_cast<unsigned long long>(reservedBps_), reservations_.size());
+}
+
+void AdmissionController::SetLoadSampler(LoadSampler sampler)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    loadSampler_ = std::move(sampler);
+    lastLoadSampleMs_ = 0;
+}
+
+AdmissionStats AdmissionController::GetStats()
+{
+    int64_t now = clock_->NowMs();
+    SampleLoad(now);
+    std::lock_guard<std::mutex> lock(mutex_);
+    SampleEgress(now);
+
+    AdmissionStats stats;
+    stats.admitted_sessions = reservations_.size();
+    stats.reserved_bps = reservedBps_;
+    stats.measured_bps = measuredBps_;
+    stats.sender_utilization = senderUtilization_;
+    stats.send_queue_bytes = sendQueueBytes_;
+    stats.rejected_bandwidth = rejectedBandwidth_;
+    stats.rejected_overload = rejectedOverload_;
+    return stats;
+}
+
+uint64_t AdmissionController::EffectiveBps(uint64_t stream_bps) const
+{
+    return stream_bps > 0 ? stream_bps : limits_.default_stream_bps;
+}
+
+void AdmissionController::SampleEgress(int64_t now_ms)
+{
+    uint64_t bytes = bytesSent_.load(std::memory_order_relaxed);
+    if (lastSampleMs_ == 0) {
+        lastSampleMs_ = now_ms;
+        lastSampleBytes_ = bytes;
+        return;
+    }
+
+    int64_t elapsed = now_ms - lastSampleMs_;
+    if (elapsed < EGRESS_SAMPLE_MIN_MS) {
+        return;
+    }
+
+    uint64_t rate = (bytes - lastSampleBytes_) * 8 * 1000 / static_cast<uint64_t>(elapsed);
+    // Smooth with the previous sample so one bursty window does not flip decisions
+    measuredBps_ = (measuredBps_ + rate) / 2;
+    lastSampleMs_ = now_ms;
+    lastSampleBytes_ = bytes;
+}
+
+void AdmissionController::SampleLoad(int64_t now_ms)
+{
+    LoadSampler sampler;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!loadSampler_ || (limits_.max_sender_utilization <= 0.0 && limits_.max_send_queue_bytes == 0)) {
+            return;
+        }
+        if (lastLoadSampleMs_ != 0 && now_ms - lastLoadSampleMs_ < LOAD_SAMPLE_MIN_MS) {
+            return;
+        }
+        sampler = loadSampler_;
+    }
+
+    // The sampler walks the sessions, keep admission checks of other threads running meanwhile
+    SenderLoadSample sample = sampler();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (lastLoadSampleMs_ != 0 && now_ms > lastLoadSampleMs_ && sample.cpu_us >= lastCpuUs_) {
+        double capacity_us = static_cast<double>(now_ms - lastLoadSampleMs_) * 1000.0 * cores_;
+        senderUtilization_ = std::min(1.0, static_cast<double>(sample.cpu_us - lastCpuUs_) / capacity_us);
+    }
+    lastCpuUs_ = sample.cpu_us;
+    sendQueueBytes_ = sample.send_queue_bytes;
+    lastLoadSampleMs_ = now_ms;
+}
+
+bool AdmissionController::IsOverloaded(std::string &reason) const
+{
+    if (limits_.max_sender_utilization > 0.0 && senderUtilization_ >= limits_.max_sender_utilization) {
+        reason = "sender threads saturated";
+        return true;
+    }
+
+    if (limits_.max_send_queue_bytes > 0 && sendQueueBytes_ >= limits_.max_send_queue_bytes) {
+        reason = "socket send queues backed up";
+        return true;
+    }
+
+    return false;
+}
+
+AdmissionDecision AdmissionController::Reject(int status_code, const std::string &reason)
+{
+    if (status_code == 453) {
+        rejectedBandwidth_++;
+    } else {
+        rejectedOverload_++;
+    }
+
+    LMRTSP_LOGW("Admission rejected (%d): %s, reserved %llu bps, measured %llu bps, %zu sessions", status_code,
+                reason.c_str(), static_cast<unsigned long long>(reservedBps_),
+                static_cast<unsigned long long>(measuredBps_), reservations_.size());
+
+    AdmissionDecision decision;
+    decision.admitted = false;
+    decision.status_code = status_code;
+    decision.retry_after = limits_.retry_after_seconds;
+    decision.reason = reason;
+    return decision;
+}
+
+} // namespace lmshao::lmrtsp
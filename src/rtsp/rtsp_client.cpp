@@ -11,11 +11,11 @@
 #include <lmcore/url.h>
 
 #include <chrono>
-#include <thread>
 
 #include "internal_logger.h"
 #include "lmnet/iclient_listener.h"
 #include "lmnet/tcp_client.h"
+#include "lmrtsp/rtsp_client_runtime.h"
 #include "lmrtsp/rtsp_client_session.h"
 #include "lmrtsp/rtsp_headers.h"
 #include "lmrtsp/rtsp_request.h"
@@ -37,16 +37,10 @@ public:
                 LMRTSP_LOGW("Received empty buffer");
                 return;
             }
-            std::string response_str(reinterpret_cast<const char *>(buffer->Data()), buffer->Size());
-            LMRTSP_LOGI("Received RTSP response (%zu bytes):\n%.200s%s", response_str.size(), response_str.c_str(),
-                        response_str.size() > 200 ? "..." : "");
-
             try {
-                RtspResponse response = RtspResponse::FromString(response_str);
-                client->HandleResponse(response);
+                client->OnReceiveData(reinterpret_cast<const char *>(buffer->Data()), buffer->Size());
             } catch (const std::exception &e) {
                 LMRTSP_LOGE("Failed to parse RTSP response: %s", e.what());
-                LMRTSP_LOGE("Response content:\n%s", response_str.c_str());
                 client->NotifyError(-1, std::string("Failed to parse response: ") + e.what());
             }
         } else {
@@ -59,6 +53,7 @@ public:
         if (auto client = client_.lock()) {
             LMRTSP_LOGI("RTSP client disconnected from server");
             client->connected_.store(false);
+            client->SetHandshakeResult(false);
             client->NotifyListener(
                 [client](IRtspClientListener *listener) { listener->OnDisconnected(client->baseUrl_); });
         }
@@ -89,6 +84,9 @@ RtspClient::RtspClient(std::shared_ptr<IRtspClientListener> listener) : listener
 
 RtspClient::~RtspClient()
 {
+    if (runtimeActive_.exchange(false)) {
+        RtspClientRuntime::GetInstance().UnregisterClient(this);
+    }
     Disconnect();
 }
 
@@ -109,6 +107,7 @@ bool RtspClient::Connect(const std::string &url, int timeout_ms)
         // Create and keep the listener alive
         tcpListener_ = std::make_shared<TcpClientListener>(shared_from_this());
         tcpClient_->SetListener(tcpListener_);
+        responseFramer_.Clear();
 
         if (!tcpClient_->Connect()) {
             LMRTSP_LOGE("Failed to connect to %s:%d", serverIP_.c_str(), serverPort_);
@@ -145,6 +144,12 @@ bool RtspClient::Disconnect()
         }
 
         connected_.store(false);
+
+        // The session's sockets are closed, its port pair can go to another session
+        if (runtimePort_ != 0) {
+            RtspClientRuntime::GetInstance().ReleasePortPair(runtimePort_);
+            runtimePort_ = 0;
+        }
         LMRTSP_LOGI("Disconnected from RTSP server");
         return true;
     } catch (const std::exception &e) {
@@ -158,7 +163,7 @@ bool RtspClient::IsConnected() const
     return connected_.load();
 }
 
-bool RtspClient::SendOptionsRequest(const std::string &url)
+bool RtspClient::SendOptionsRequest(const std::string &url, const std::string &session_id)
 {
     if (!connected_.load()) {
         LMRTSP_LOGE("Not connected to server");
@@ -171,8 +176,13 @@ bool RtspClient::SendOptionsRequest(const std::string &url)
         request.uri_ = url;
         request.version_ = RTSP_VERSION;
 
-        request.general_header_[CSEQ] = GenerateCSeq();
-        request.general_header_[USER_AGENT] = userAgent_;
+        request.general_header_.Set(RtspHeaderId::CSEQ, GenerateCSeq());
+        request.general_header_.Set(RtspHeaderId::USER_AGENT, userAgent_);
+
+        // A Session header makes OPTIONS a keep-alive for that session
+        if (!session_id.empty()) {
+            request.general_header_.Set(RtspHeaderId::SESSION, session_id);
+        }
 
         std::string request_str = request.ToString();
         LMRTSP_LOGD("Sending OPTIONS request");
@@ -197,13 +207,13 @@ bool RtspClient::SendDescribeRequest(const std::string &url)
         request.uri_ = url;
         request.version_ = RTSP_VERSION;
 
-        request.general_header_[CSEQ] = GenerateCSeq();
-        request.general_header_[USER_AGENT] = userAgent_;
-        request.general_header_["Accept"] = "application/sdp";
+        request.general_header_.Set(RtspHeaderId::CSEQ, GenerateCSeq());
+        request.general_header_.Set(RtspHeaderId::USER_AGENT, userAgent_);
+        request.general_header_.Set(RtspHeaderId::ACCEPT, "application/sdp");
 
         // For on-demand content, request to start from the beginning
         // Some servers (like Live555) may use this to initialize the session position
-        request.general_header_[RANGE] = "npt=0-";
+        request.general_header_.Set(RtspHeaderId::RANGE, "npt=0-");
 
         std::string request_str = request.ToString();
         LMRTSP_LOGD("Sending DESCRIBE request");
@@ -228,9 +238,9 @@ bool RtspClient::SendSetupRequest(const std::string &url, const std::string &tra
         request.uri_ = url;
         request.version_ = RTSP_VERSION;
 
-        request.general_header_[CSEQ] = GenerateCSeq();
-        request.general_header_[USER_AGENT] = userAgent_;
-        request.general_header_[TRANSPORT] = transport;
+        request.general_header_.Set(RtspHeaderId::CSEQ, GenerateCSeq());
+        request.general_header_.Set(RtspHeaderId::USER_AGENT, userAgent_);
+        request.general_header_.Set(RtspHeaderId::TRANSPORT, transport);
 
         std::string request_str = request.ToString();
         LMRTSP_LOGD("Sending SETUP request:\n%s", request_str.c_str());
@@ -255,16 +265,16 @@ bool RtspClient::SendPlayRequest(const std::string &url, const std::string &sess
         request.uri_ = url;
         request.version_ = RTSP_VERSION;
 
-        request.general_header_[CSEQ] = GenerateCSeq();
-        request.general_header_[USER_AGENT] = userAgent_;
+        request.general_header_.Set(RtspHeaderId::CSEQ, GenerateCSeq());
+        request.general_header_.Set(RtspHeaderId::USER_AGENT, userAgent_);
 
         // Add Session header if provided
         if (!session_id.empty()) {
-            request.general_header_[SESSION] = session_id;
+            request.general_header_.Set(RtspHeaderId::SESSION, session_id);
         }
 
         // Request playback from the beginning
-        request.general_header_[RANGE] = "npt=0.000-";
+        request.general_header_.Set(RtspHeaderId::RANGE, "npt=0.000-");
 
         std::string request_str = request.ToString();
         LMRTSP_LOGD("Sending PLAY request:\n%s", request_str.c_str());
@@ -289,12 +299,12 @@ bool RtspClient::SendPauseRequest(const std::string &url, const std::string &ses
         request.uri_ = url;
         request.version_ = RTSP_VERSION;
 
-        request.general_header_[CSEQ] = GenerateCSeq();
-        request.general_header_[USER_AGENT] = userAgent_;
+        request.general_header_.Set(RtspHeaderId::CSEQ, GenerateCSeq());
+        request.general_header_.Set(RtspHeaderId::USER_AGENT, userAgent_);
 
         // Add Session header if provided
         if (!session_id.empty()) {
-            request.general_header_[SESSION] = session_id;
+            request.general_header_.Set(RtspHeaderId::SESSION, session_id);
         }
 
         std::string request_str = request.ToString();
@@ -320,12 +330,12 @@ bool RtspClient::SendTeardownRequest(const std::string &url, const std::string &
         request.uri_ = url;
         request.version_ = RTSP_VERSION;
 
-        request.general_header_[CSEQ] = GenerateCSeq();
-        request.general_header_[USER_AGENT] = userAgent_;
+        request.general_header_.Set(RtspHeaderId::CSEQ, GenerateCSeq());
+        request.general_header_.Set(RtspHeaderId::USER_AGENT, userAgent_);
 
         // Add Session header if provided
         if (!session_id.empty()) {
-            request.general_header_[SESSION] = session_id;
+            request.general_header_.Set(RtspHeaderId::SESSION, session_id);
         }
 
         std::string request_str = request.ToString();
@@ -407,6 +417,38 @@ int RtspClient::GetTimeout() const
     return timeoutMs_;
 }
 
+void RtspClient::SetPipelining(bool enable)
+{
+    pipelining_ = enable;
+}
+
+bool RtspClient::GetPipelining() const
+{
+    return pipelining_;
+}
+
+void RtspClient::SetSharedRuntime(bool enable)
+{
+    sharedRuntime_ = enable;
+}
+
+bool RtspClient::GetSharedRuntime() const
+{
+    return sharedRuntime_;
+}
+
+void RtspClient::SetKeepAliveInterval(int interval_ms)
+{
+    std::lock_guard<std::mutex> lock(lifecycleMutex_);
+    housekeeping_.SetKeepAliveInterval(interval_ms);
+}
+
+void RtspClient::SetReconnectInterval(int interval_ms, int max_interval_ms)
+{
+    std::lock_guard<std::mutex> lock(lifecycleMutex_);
+    housekeeping_.SetReconnectInterval(interval_ms, max_interval_ms);
+}
+
 std::string RtspClient::GetServerIP() const
 {
     return serverIP_;
@@ -453,6 +495,20 @@ bool RtspClient::Init(const std::string &url)
 }
 
 bool RtspClient::Start()
+{
+    std::lock_guard<std::mutex> lock(lifecycleMutex_);
+    if (!StartStream()) {
+        return false;
+    }
+
+    // Keep-alives and reconnects from now on come from the runtime's housekeeping tick
+    if (sharedRuntime_ && !runtimeActive_.exchange(true)) {
+        RtspClientRuntime::GetInstance().RegisterClient(shared_from_this());
+    }
+    return true;
+}
+
+bool RtspClient::StartStream()
 {
     if (rtspUrl_.empty()) {
         LMRTSP_LOGE("RTSP URL not initialized. Call Init() first.");
@@ -480,6 +536,18 @@ bool RtspClient::Start()
         return false;
     }
 
+    if (sharedRuntime_) {
+        // Receive on the runtime's reactors, from a port pair no other session of the process holds
+        TransportConfig config = currentSession_->GetTransportConfig();
+        config.backend = TransportConfig::Backend::SHARED;
+        runtimePort_ = RtspClientRuntime::GetInstance().AllocatePortPair();
+        if (runtimePort_ != 0) {
+            config.client_rtp_port = runtimePort_;
+            config.client_rtcp_port = runtimePort_ + 1;
+        }
+        currentSession_->SetTransportConfig(config);
+    }
+
     // Step 3: Perform RTSP handshake (OPTIONS -> DESCRIBE -> SETUP -> PLAY)
     // State machine will handle the handshake automatically
     if (!PerformRTSPHandshake()) {
@@ -499,6 +567,12 @@ bool RtspClient::Start()
 
 bool RtspClient::Stop()
 {
+    if (runtimeActive_.exchange(false)) {
+        RtspClientRuntime::GetInstance().UnregisterClient(this);
+    }
+
+    // Waits for a reconnect attempt in progress
+    std::lock_guard<std::mutex> lock(lifecycleMutex_);
     if (!playing_.load()) {
         LMRTSP_LOGW("Not playing. Nothing to stop.");
         return true;
@@ -531,6 +605,64 @@ bool RtspClient::IsPlaying() const
     return playing_.load();
 }
 
+void RtspClient::OnRuntimeTick(int64_t now_ms)
+{
+    if (!runtimeActive_.load() || reconnecting_.load()) {
+        return;
+    }
+
+    // Never block the shared timer thread, Start(), Stop() or a reconnect in progress skip this tick
+    std::unique_lock<std::mutex> lock(lifecycleMutex_, std::try_to_lock);
+    if (!lock.owns_lock()) {
+        return;
+    }
+
+    auto action = housekeeping_.OnTick(now_ms, connected_.load(), playing_.load() && currentSession_);
+    if (action == ClientHousekeeping::Action::KEEP_ALIVE) {
+        SendOptionsRequest(rtspUrl_, currentSession_->GetSessionId());
+        return;
+    }
+    if (action != ClientHousekeeping::Action::RECONNECT) {
+        return;
+    }
+
+    // Connecting blocks, so the attempt runs on the runtime's reconnect pool
+    reconnecting_.store(true);
+    std::weak_ptr<RtspClient> weak = shared_from_this();
+    RtspClientRuntime::GetInstance().PostTask([weak]() {
+        if (auto client = weak.lock()) {
+            client->Reconnect();
+        }
+    });
+}
+
+void RtspClient::Reconnect()
+{
+    {
+        std::lock_guard<std::mutex> lock(lifecycleMutex_);
+        if (runtimeActive_.load() && !connected_.load()) {
+            LMRTSP_LOGI("Reconnecting to %s", rtspUrl_.c_str());
+
+            if (currentSession_) {
+                RemoveSession(currentSession_->GetSessionId());
+                currentSession_.reset();
+            }
+            Disconnect();
+            playing_.store(false);
+
+            bool success = StartStream();
+            housekeeping_.OnReconnectResult(Clock::Get()->MonotonicNs() / 1000000, success);
+            if (success) {
+                LMRTSP_LOGI("Reconnected to %s", rtspUrl_.c_str());
+            } else {
+                LMRTSP_LOGW("Reconnect to %s failed, retrying in %lld ms", rtspUrl_.c_str(),
+                            static_cast<long long>(housekeeping_.GetReconnectDelay()));
+            }
+        }
+    }
+    reconnecting_.store(false);
+}
+
 // Private methods
 std::string RtspClient::GenerateCSeq()
 {
@@ -552,8 +684,16 @@ bool RtspClient::SendRequest(const RtspRequest &request)
         auto buffer = lmcore::DataBuffer::Create(request_str.length());
         buffer->Assign(request_str.data(), request_str.length());
 
+        // Recorded before sending, the response may arrive before Send() returns
+        int cseq = request.general_header_.GetInt(RtspHeaderId::CSEQ, -1);
+        {
+            std::lock_guard<std::mutex> lock(requestMutex_);
+            pendingRequests_[cseq] = request.method_;
+        }
+
         if (!tcpClient_->Send(buffer)) {
             LMRTSP_LOGE("Failed to send request");
+            TakePendingMethod(cseq);
             return false;
         }
 
@@ -565,27 +705,89 @@ bool RtspClient::SendRequest(const RtspRequest &request)
     }
 }
 
+void RtspClient::OnReceiveData(const char *data, size_t size)
+{
+    responseFramer_.Append(data, size);
+
+    for (;;) {
+        RtspResponse response;
+        try {
+            if (!responseFramer_.Next(response)) {
+                break;
+            }
+        } catch (const std::exception &e) {
+            // The framer dropped the bad message, the responses behind it are still delivered
+            LMRTSP_LOGE("Failed to parse RTSP response: %s", e.what());
+            NotifyError(-1, std::string("Failed to parse response: ") + e.what());
+            continue;
+        }
+
+        LMRTSP_LOGI("Received RTSP response: %d, CSeq %d", static_cast<int>(response.status_),
+                    response.general_header_.GetInt(RtspHeaderId::CSEQ, -1));
+        HandleResponse(response);
+    }
+}
+
+std::string RtspClient::TakePendingMethod(int cseq)
+{
+    std::lock_guard<std::mutex> lock(requestMutex_);
+    auto it = pendingRequests_.find(cseq);
+    if (it == pendingRequests_.end()) {
+        return "";
+    }
+    std::string method = it->second;
+    pendingRequests_.erase(it);
+    return method;
+}
+
+void RtspClient::SetHandshakeResult(bool success)
+{
+    {
+        std::lock_guard<std::mutex> lock(handshakeMutex_);
+        // The first result wins, e.g. a disconnect after PLAY does not fail a completed handshake
+        if (handshake_complete_.load() || handshake_failed_.load()) {
+            return;
+        }
+        if (success) {
+            handshake_complete_.store(true);
+        } else {
+            handshake_failed_.store(true);
+        }
+    }
+    handshakeCv_.notify_all();
+}
+
 void RtspClient::HandleResponse(const RtspResponse &response)
 {
     LMRTSP_LOGI("Handling RTSP response: %d %s", static_cast<int>(response.status_),
                 GetReasonPhrase(response.status_).c_str());
 
+    // Responses come back in request order, CSeq tells which request this one answers
+    std::string method = TakePendingMethod(response.general_header_.GetInt(RtspHeaderId::CSEQ, -1));
+
     if (response.status_ != StatusCode::OK) {
         // Error response
-        LMRTSP_LOGE("RTSP response error: %d %s", static_cast<int>(response.status_),
+        LMRTSP_LOGE("RTSP %s response error: %d %s", method.c_str(), static_cast<int>(response.status_),
                     GetReasonPhrase(response.status_).c_str());
         NotifyError(static_cast<int>(response.status_), GetReasonPhrase(response.status_));
-        return;
+
+        // OPTIONS is optional, the state machine goes on with DESCRIBE. Any other failure ends the handshake.
+        if (method != METHOD_OPTIONS) {
+            if (method == METHOD_DESCRIBE || method == METHOD_SETUP || method == METHOD_PLAY) {
+                SetHandshakeResult(false);
+            }
+            return;
+        }
     }
 
-    LMRTSP_LOGI("Status is OK, proceeding to find session");
+    LMRTSP_LOGI("Proceeding to find session");
     std::lock_guard<std::mutex> lock(sessionsMutex_);
 
     // Find session - try by Session ID first, then use current session
     std::shared_ptr<RtspClientSession> session = nullptr;
-    auto session_id_it = response.general_header_.find(SESSION);
+    auto session_id_it = response.general_header_.find(RtspHeaderId::SESSION);
     if (session_id_it != response.general_header_.end()) {
-        std::string session_id = session_id_it->second;
+        std::string session_id(session_id_it->second);
         LMRTSP_LOGI("Response has Session ID: %s", session_id.c_str());
         auto it = sessions_.find(session_id);
         if (it != sessions_.end()) {
@@ -628,51 +830,54 @@ void RtspClient::HandleResponse(const RtspResponse &response)
     // Debug: print all headers
     LMRTSP_LOGI("Response headers count: %zu", response.general_header_.size());
     for (const auto &kv : response.general_header_) {
-        LMRTSP_LOGI("  General Header: '%s' = '%s'", kv.first.c_str(), kv.second.c_str());
+        LMRTSP_LOGI("  General Header: '%.*s' = '%.*s'", static_cast<int>(kv.first.size()), kv.first.data(),
+                    static_cast<int>(kv.second.size()), kv.second.data());
     }
     LMRTSP_LOGI("Response entity headers count: %zu", response.entity_header_.size());
     for (const auto &kv : response.entity_header_) {
-        LMRTSP_LOGI("  Entity Header: '%s' = '%s'", kv.first.c_str(), kv.second.c_str());
+        LMRTSP_LOGI("  Entity Header: '%.*s' = '%.*s'", static_cast<int>(kv.first.size()), kv.first.data(),
+                    static_cast<int>(kv.second.size()), kv.second.data());
+    }
+
+    // Without a matching CSeq, tell the response type from its content/headers
+    std::string rtp_info(response.general_header_.Get(RtspHeaderId::RTP_INFO));
+    if (method.empty()) {
+        if (response.entity_header_.Get(RtspHeaderId::CONTENT_TYPE) == MIME_SDP) {
+            method = METHOD_DESCRIBE;
+        } else if (!response.responseHeader_.publicMethods_.empty()) {
+            method = METHOD_OPTIONS;
+        } else if (response.general_header_.count(RtspHeaderId::TRANSPORT)) {
+            method = METHOD_SETUP;
+        } else if (!rtp_info.empty() || session->GetState() == ClientSessionStateEnum::READY) {
+            method = METHOD_PLAY;
+        }
     }
 
-    // Route response to state machine based on content/headers
+    // Route response to state machine
     ClientStateAction action = ClientStateAction::WAIT;
-
-    // Check Content-Type in entity_header (not general_header)
-    auto content_type_it = response.entity_header_.find(CONTENT_TYPE);
-    if (content_type_it != response.entity_header_.end() && content_type_it->second == MIME_SDP) {
-        // DESCRIBE response
+    if (method == METHOD_DESCRIBE) {
         LMRTSP_LOGI("Identified as DESCRIBE response");
         if (response.messageBody_) {
             session->HandleDescribeResponse(*response.messageBody_);
         }
         action = state->OnDescribeResponse(session.get(), this, response);
-    } else if (!response.responseHeader_.publicMethods_.empty()) {
-        // OPTIONS response (has Public header with methods list)
+    } else if (method == METHOD_OPTIONS) {
         LMRTSP_LOGI("Identified as OPTIONS response, Public methods count: %zu",
                     response.responseHeader_.publicMethods_.size());
         action = state->OnOptionsResponse(session.get(), this, response);
+    } else if (method == METHOD_SETUP) {
+        std::string transport(response.general_header_.Get(RtspHeaderId::TRANSPORT));
+        LMRTSP_LOGI("Identified as SETUP response, Transport: %s", transport.c_str());
+        std::string session_id(response.general_header_.Get(RtspHeaderId::SESSION));
+        session->HandleSetupResponse(session_id, transport);
+        action = state->OnSetupResponse(session.get(), this, response);
+    } else if (method == METHOD_PLAY) {
+        LMRTSP_LOGI("Identified as PLAY response, RTP-Info: %s", rtp_info.c_str());
+        session->HandlePlayResponse(rtp_info);
+        action = state->OnPlayResponse(session.get(), this, response);
     } else {
-        auto transport_it = response.general_header_.find(TRANSPORT);
-        if (transport_it != response.general_header_.end()) {
-            // SETUP response
-            LMRTSP_LOGI("Identified as SETUP response, Transport: %s", transport_it->second.c_str());
-            std::string session_id = session_id_it != response.general_header_.end() ? session_id_it->second : "";
-            session->HandleSetupResponse(session_id, transport_it->second);
-            action = state->OnSetupResponse(session.get(), this, response);
-        } else {
-            auto rtp_info_it = response.general_header_.find(RTP_INFO);
-            std::string rtp_info = (rtp_info_it != response.general_header_.end()) ? rtp_info_it->second : "";
-            if (!rtp_info.empty() || session->GetState() == ClientSessionStateEnum::READY) {
-                // PLAY response
-                LMRTSP_LOGI("Identified as PLAY response, RTP-Info: %s", rtp_info.c_str());
-                session->HandlePlayResponse(rtp_info);
-                action = state->OnPlayResponse(session.get(), this, response);
-            } else {
-                // Unknown response type
-                LMRTSP_LOGD("Unknown response type, might be OPTIONS or other stateless response");
-            }
-        }
+        // Unknown response type
+        LMRTSP_LOGD("Unhandled %s response", method.empty() ? "unknown" : method.c_str());
     }
 
     // Handle state machine action
@@ -684,13 +889,13 @@ void RtspClient::HandleResponse(const RtspResponse &response)
         case ClientStateAction::SUCCESS:
             // Handshake completed
             LMRTSP_LOGI("RTSP handshake completed successfully");
-            handshake_complete_.store(true);
             playing_.store(true);
+            SetHandshakeResult(true);
             break;
         case ClientStateAction::FAIL:
             LMRTSP_LOGE("State machine reported failure");
-            handshake_failed_.store(true);
             NotifyError(-1, "RTSP handshake failed");
+            SetHandshakeResult(false);
             break;
         case ClientStateAction::WAIT:
             // Continue waiting
@@ -736,34 +941,50 @@ bool RtspClient::PerformRTSPHandshake()
     }
 
     // Reset handshake flags
-    handshake_complete_.store(false);
-    handshake_failed_.store(false);
+    {
+        std::lock_guard<std::mutex> lock(handshakeMutex_);
+        handshake_complete_.store(false);
+        handshake_failed_.store(false);
+    }
+    {
+        std::lock_guard<std::mutex> lock(requestMutex_);
+        pendingRequests_.clear();
+    }
+
+    {
+        // Responses are handled under sessionsMutex_, hold it so none is seen before the state is set
+        std::lock_guard<std::mutex> lock(sessionsMutex_);
 
-    // Initialize state machine to Init state
-    currentSession_->ChangeState(&ClientInitialState::GetInstance());
+        // Step 0: Send OPTIONS request (state machine will handle the rest)
+        LMRTSP_LOGD("Sending OPTIONS request to start handshake");
+        currentSession_->ChangeState(&ClientInitialState::GetInstance());
+        if (!SendOptionsRequest(rtspUrl_)) {
+            LMRTSP_LOGE("Failed to send OPTIONS request");
+            return false;
+        }
 
-    // Step 0: Send OPTIONS request (state machine will handle the rest)
-    LMRTSP_LOGD("Sending OPTIONS request to start handshake");
-    if (!SendOptionsRequest(rtspUrl_)) {
-        LMRTSP_LOGE("Failed to send OPTIONS request");
-        return false;
+        // Pipelined: DESCRIBE does not depend on the OPTIONS response, send it right away
+        if (pipelining_) {
+            LMRTSP_LOGD("Pipelining DESCRIBE behind OPTIONS");
+            if (!SendDescribeRequest(rtspUrl_)) {
+                LMRTSP_LOGE("Failed to send DESCRIBE request");
+                return false;
+            }
+            currentSession_->ChangeState(&ClientDescribeSentState::GetInstance());
+        }
     }
 
-    // Wait for handshake to complete (state machine will drive the process)
-    // State machine will automatically send DESCRIBE -> SETUP -> PLAY
-    int wait_count = 0;
-    const int max_wait = 50; // 5 seconds (50 * 100ms)
-    while (wait_count < max_wait && !handshake_complete_.load() && !handshake_failed_.load()) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
-        wait_count++;
-    }
+    // Wait for handshake to complete, the state machine drives DESCRIBE -> SETUP -> PLAY and signals the result
+    std::unique_lock<std::mutex> lock(handshakeMutex_);
+    bool done = handshakeCv_.wait_for(lock, std::chrono::milliseconds(timeoutMs_),
+                                      [this]() { return handshake_complete_.load() || handshake_failed_.load(); });
 
     if (handshake_failed_.load()) {
         LMRTSP_LOGE("RTSP handshake failed");
         return false;
     }
 
-    if (!handshake_complete_.load()) {
+    if (!done) {
         LMRTSP_LOGE("RTSP handshake timeout");
         return false;
     }
@@ -772,4 +993,4 @@ bool RtspClient::PerformRTSPHandshake()
     return true;
 }
 
-} // namespace lmshao::lmrtsp
\ No newline at end of file
+} // namespace lmshao::lmrtsp
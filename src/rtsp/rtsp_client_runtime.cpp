@@ -0,0 +1,679 @@
+/**
+ * @author SHAO Liming <lmshao@163.com>
+ * @copyright Copyright (c) 2025 SHAO Liming
+ * @license MIT
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "lmrtsp/rtsp_client_runtime.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <set>
+
+#ifdef __linux__
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#endif
+
+#include "internal_logger.h"
+#include "lmrtsp/cpu_affinity.h"
+#include "lmrtsp/rtsp_client.h"
+#include "rtp/udp_rtp_transport_adapter.h"
+
+namespace lmshao::lmrtsp {
+
+namespace {
+constexpr size_t RECV_BATCH = 32;
+constexpr size_t RECV_BUFFER_SIZE = 2048;
+constexpr int RECV_ROUNDS = 4; // Batches per wake-up, so one busy port cannot starve the others
+constexpr int MAX_EVENTS = 64;
+constexpr int SOCKET_RECV_BUFFER = 2 * 1024 * 1024;
+
+// SSRC of an RTP packet or of the sender of an RTCP packet, 0 if the packet is too short
+uint32_t ReadSsrc(const uint8_t *data, size_t size, RtspClientRuntime::PacketType type)
+{
+    size_t offset = type == RtspClientRuntime::PacketType::RTP ? 8 : 4;
+    if (size < offset + 4) {
+        return 0;
+    }
+    return (static_cast<uint32_t>(data[offset]) << 24) | (static_cast<uint32_t>(data[offset + 1]) << 16) |
+           (static_cast<uint32_t>(data[offset + 2]) << 8) | data[offset + 3];
+}
+} // namespace
+
+struct RtspClientRuntime::Receiver {
+    uint16_t port = 0;
+    uint32_t ssrc = 0;
+    ReceiveHandler handler;
+    std::recursive_mutex mutex; // Held while the handler runs, a handler may remove its own receiver
+    bool active = true;
+};
+
+struct RtspClientRuntime::Socket {
+    ~Socket()
+    {
+#ifdef __linux__
+        if (fd >= 0) {
+            close(fd);
+        }
+#endif
+    }
+
+    int fd = -1;
+    uint16_t port = 0;
+    PacketType type = PacketType::RTP;
+    std::mutex mutex;
+    std::unordered_map<uint32_t, std::shared_ptr<Receiver>> receivers; // SSRC -> receiver, 0 for any SSRC
+};
+
+struct RtspClientRuntime::Reactor {
+    int epollFd = -1;
+    int wakeFd = -1;
+    std::atomic<bool> running{false};
+    std::thread thread;
+    std::mutex mutex;
+    std::unordered_map<uint16_t, std::shared_ptr<Socket>> sockets; // Local port -> socket
+    std::vector<uint8_t> buffers;                                   // RECV_BATCH datagrams, reactor thread only
+};
+
+class RtspClientRuntime::SharedTimer : public Timer {
+public:
+    explicit SharedTimer(std::shared_ptr<Timer> timer) : timer_(std::move(timer)), state_(std::make_shared<State>()) {}
+
+    ~SharedTimer() override
+    {
+        std::set<TimerId> ids;
+        {
+            // Waits for a running task, later runs see the flag and return
+            std::lock_guard<std::recursive_mutex> lock(state_->mutex);
+            state_->cancelled = true;
+            ids.swap(ids_);
+        }
+        for (TimerId id : ids) {
+            timer_->Cancel(id);
+        }
+    }
+
+    TimerId ScheduleRepeating(std::function<void()> task, uint32_t interval_ms) override
+    {
+        auto state = state_;
+        TimerId id = timer_->ScheduleRepeating(
+            [state, task = std::move(task)]() {
+                std::lock_guard<std::recursive_mutex> lock(state->mutex);
+                if (!state->cancelled) {
+                    task();
+                }
+            },
+            interval_ms);
+
+        if (id != 0) {
+            std::lock_guard<std::recursive_mutex> lock(state_->mutex);
+            ids_.insert(id);
+        }
+        return id;
+    }
+
+    void Cancel(TimerId id) override
+    {
+        {
+            std::lock_guard<std::recursive_mutex> lock(state_->mutex);
+            ids_.erase(id);
+        }
+        timer_->Cancel(id);
+    }
+
+private:
+    struct State {
+        std::recursive_mutex mutex;
+        bool cancelled = false;
+    };
+
+    std::shared_ptr<Timer> timer_;
+    std::shared_ptr<State> state_;
+    std::set<TimerId> ids_;
+};
+
+void ClientHousekeeping::SetReconnectInterval(int interval_ms, int max_interval_ms)
+{
+    reconnectIntervalMs_ = interval_ms;
+    maxReconnectIntervalMs_ = std::max(interval_ms, max_interval_ms);
+}
+
+ClientHousekeeping::Action ClientHousekeeping::OnTick(int64_t now_ms, bool connected, bool playing)
+{
+    if (connected) {
+        // Servers drop sessions that stay silent past their timeout, typically 60 seconds
+        if (!playing || keepAliveIntervalMs_ <= 0) {
+            nextKeepAliveMs_ = 0;
+            return Action::NONE;
+        }
+        if (nextKeepAliveMs_ == 0) {
+            nextKeepAliveMs_ = now_ms + keepAliveIntervalMs_;
+            return Action::NONE;
+        }
+        if (now_ms < nextKeepAliveMs_) {
+            return Action::NONE;
+        }
+        nextKeepAliveMs_ = now_ms + keepAliveIntervalMs_;
+        return Action::KEEP_ALIVE;
+    }
+
+    if (reconnectIntervalMs_ <= 0 || now_ms < nextReconnectMs_) {
+        return Action::NONE;
+    }
+
+    // Held off until the attempt reports back
+    nextReconnectMs_ = now_ms + GetReconnectDelay();
+    return Action::RECONNECT;
+}
+
+void ClientHousekeeping::OnReconnectResult(int64_t now_ms, bool success)
+{
+    nextKeepAliveMs_ = 0;
+    if (success) {
+        failedAttempts_ = 0;
+        nextReconnectMs_ = 0;
+        return;
+    }
+
+    failedAttempts_++;
+    nextReconnectMs_ = now_ms + GetReconnectDelay();
+}
+
+int64_t ClientHousekeeping::GetReconnectDelay() const
+{
+    int64_t delay = reconnectIntervalMs_;
+    for (uint32_t i = 1; i < failedAttempts_ && delay < maxReconnectIntervalMs_; ++i) {
+        delay *= 2;
+    }
+    return std::min<int64_t>(delay, maxReconnectIntervalMs_);
+}
+
+RtspClientRuntime &RtspClientRuntime::GetInstance()
+{
+    static RtspClientRuntime instance;
+    return instance;
+}
+
+RtspClientRuntime::RtspClientRuntime() = default;
+
+RtspClientRuntime::~RtspClientRuntime()
+{
+    {
+        // Timers of sessions still alive keep the timer thread, the tick must not outlive the runtime
+        std::lock_guard<std::mutex> lock(timerMutex_);
+        if (timer_ && tickId_ != 0) {
+            timer_->Cancel(tickId_);
+        }
+        timer_.reset();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(taskMutex_);
+        stop_ = true;
+    }
+    taskCv_.notify_all();
+    for (auto &worker : workers_) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+
+#ifdef __linux__
+    for (auto &reactor : reactors_) {
+        reactor->running = false;
+        uint64_t one = 1;
+        if (write(reactor->wakeFd, &one, sizeof(one)) < 0) {
+            LMRTSP_LOGW("Failed to wake client runtime reactor: %s", strerror(errno));
+        }
+        if (reactor->thread.joinable()) {
+            reactor->thread.join();
+        }
+        reactor->sockets.clear();
+        close(reactor->wakeFd);
+        close(reactor->epollFd);
+    }
+#endif
+}
+
+void RtspClientRuntime::SetConfig(const RtspClientRuntimeConfig &config)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!reactors_.empty()) {
+        LMRTSP_LOGW("Client runtime already running, config ignored");
+        return;
+    }
+    config_ = config;
+}
+
+RtspClientRuntime::ReceiverId RtspClientRuntime::AddReceiver(uint16_t port, PacketType type, uint32_t ssrc,
+                                                             ReceiveHandler handler)
+{
+#ifdef __linux__
+    if (port == 0 || !handler) {
+        LMRTSP_LOGE("Invalid client runtime receiver: port %u", port);
+        return 0;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (reactors_.empty() && !StartReactors()) {
+        return 0;
+    }
+
+    // The port's socket, or the least loaded reactor to open it on
+    std::shared_ptr<Socket> socket;
+    Reactor *owner = nullptr;
+    size_t ownerLoad = SIZE_MAX;
+    for (auto &reactor : reactors_) {
+        std::lock_guard<std::mutex> reactorLock(reactor->mutex);
+        auto it = reactor->sockets.find(port);
+        if (it != reactor->sockets.end()) {
+            socket = it->second;
+            break;
+        }
+        if (reactor->sockets.size() < ownerLoad) {
+            owner = reactor.get();
+            ownerLoad = reactor->sockets.size();
+        }
+    }
+
+    if (socket) {
+        std::lock_guard<std::mutex> socketLock(socket->mutex);
+        if (socket->type != type || socket->receivers.count(ssrc)) {
+            LMRTSP_LOGE("Port %u already has a receiver for SSRC 0x%08x", port, ssrc);
+            return 0;
+        }
+    } else {
+        socket = std::make_shared<Socket>();
+        socket->port = port;
+        socket->type = type;
+        socket->fd = ::socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (socket->fd < 0) {
+            LMRTSP_LOGE("Failed to create UDP socket: %s", strerror(errno));
+            return 0;
+        }
+        int size = SOCKET_RECV_BUFFER;
+        setsockopt(socket->fd, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_ANY);
+        addr.sin_port = htons(port);
+        if (bind(socket->fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0) {
+            LMRTSP_LOGE("Failed to bind UDP port %u: %s", port, strerror(errno));
+            return 0;
+        }
+
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.u32 = port;
+        if (epoll_ctl(owner->epollFd, EPOLL_CTL_ADD, socket->fd, &event) != 0) {
+            LMRTSP_LOGE("Failed to add UDP port %u to reactor: %s", port, strerror(errno));
+            return 0;
+        }
+
+        std::lock_guard<std::mutex> reactorLock(owner->mutex);
+        owner->sockets[port] = socket;
+    }
+
+    auto receiver = std::make_shared<Receiver>();
+    receiver->port = port;
+    receiver->ssrc = ssrc;
+    receiver->handler = std::move(handler);
+    {
+        std::lock_guard<std::mutex> socketLock(socket->mutex);
+        socket->receivers[ssrc] = receiver;
+    }
+
+    ReceiverId id = nextReceiverId_++;
+    receivers_[id] = receiver;
+    LMRTSP_LOGD("Client runtime receiver %llu: port %u, SSRC 0x%08x", static_cast<unsigned long long>(id), port,
+                ssrc);
+    return id;
+#else
+    (void)port;
+    (void)type;
+    (void)ssrc;
+    (void)handler;
+    LMRTSP_LOGE("Client runtime receive pool is only available on Linux");
+    return 0;
+#endif
+}
+
+void RtspClientRuntime::RemoveReceiver(ReceiverId id)
+{
+    std::shared_ptr<Receiver> receiver;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = receivers_.find(id);
+        if (it == receivers_.end()) {
+            return;
+        }
+        receiver = it->second;
+        receivers_.erase(it);
+
+        for (auto &reactor : reactors_) {
+            std::lock_guard<std::mutex> reactorLock(reactor->mutex);
+            auto socketIt = reactor->sockets.find(receiver->port);
+            if (socketIt == reactor->sockets.end()) {
+                continue;
+            }
+
+            auto socket = socketIt->second;
+            bool empty = false;
+            {
+                std::lock_guard<std::mutex> socketLock(socket->mutex);
+                socket->receivers.erase(receiver->ssrc);
+                empty = socket->receivers.empty();
+            }
+
+            // The last receiver closes the socket, once the reactor thread lets go of it
+            if (empty) {
+#ifdef __linux__
+                epoll_ctl(reactor->epollFd, EPOLL_CTL_DEL, socket->fd, nullptr);
+#endif
+                reactor->sockets.erase(socketIt);
+            }
+            break;
+        }
+    }
+
+    // Wait for a handler call in progress, a handler removing itself already holds the lock
+    std::lock_guard<std::recursive_mutex> lock(receiver->mutex);
+    receiver->active = false;
+}
+
+uint16_t RtspClientRuntime::AllocatePortPair()
+{
+    return UdpRtpTransportAdapter::ReservePortPair();
+}
+
+void RtspClientRuntime::ReleasePortPair(uint16_t rtp_port)
+{
+    UdpRtpTransportAdapter::ReleasePortPair(rtp_port);
+}
+
+std::unique_ptr<Timer> RtspClientRuntime::CreateTimer()
+{
+    auto timer = GetSharedTimer();
+    if (!timer) {
+        return nullptr;
+    }
+    return std::make_unique<SharedTimer>(std::move(timer));
+}
+
+void RtspClientRuntime::RegisterClient(const std::shared_ptr<RtspClient> &client)
+{
+    if (!client) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(clientsMutex_);
+        clients_[client.get()] = client;
+    }
+
+    auto timer = GetSharedTimer();
+    std::lock_guard<std::mutex> lock(timerMutex_);
+    if (timer && tickId_ == 0) {
+        tickId_ = timer->ScheduleRepeating([this]() { Tick(); }, config_.tick_interval_ms);
+    }
+}
+
+void RtspClientRuntime::UnregisterClient(const RtspClient *client)
+{
+    std::lock_guard<std::mutex> lock(clientsMutex_);
+    clients_.erase(client);
+}
+
+void RtspClientRuntime::PostTask(std::function<void()> task)
+{
+    {
+        std::lock_guard<std::mutex> lock(taskMutex_);
+        if (stop_) {
+            return;
+        }
+        if (workers_.empty()) {
+            size_t count = config_.reconnect_threads > 0 ? config_.reconnect_threads : 1;
+            for (size_t i = 0; i < count; ++i) {
+                workers_.emplace_back(&RtspClientRuntime::WorkerFunc, this);
+            }
+        }
+        tasks_.push_back(std::move(task));
+    }
+    taskCv_.notify_one();
+}
+
+size_t RtspClientRuntime::GetReactorCount() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return reactors_.size();
+}
+
+size_t RtspClientRuntime::GetClientCount() const
+{
+    std::lock_guard<std::mutex> lock(clientsMutex_);
+    return clients_.size();
+}
+
+bool RtspClientRuntime::StartReactors()
+{
+#ifdef __linux__
+    // Called with mutex_ held
+    size_t count = config_.reactor_count;
+    if (count == 0) {
+        count = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        auto reactor = std::make_unique<Reactor>();
+        reactor->epollFd = epoll_create1(EPOLL_CLOEXEC);
+        reactor->wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (reactor->epollFd < 0 || reactor->wakeFd < 0) {
+            LMRTSP_LOGE("Failed to create client runtime reactor: %s", strerror(errno));
+            if (reactor->epollFd >= 0) {
+                close(reactor->epollFd);
+            }
+            if (reactor->wakeFd >= 0) {
+                close(reactor->wakeFd);
+            }
+            break;
+        }
+
+        // Port 0 is never bound, it tags the wake-up descriptor
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.u32 = 0;
+        epoll_ctl(reactor->epollFd, EPOLL_CTL_ADD, reactor->wakeFd, &event);
+
+        reactor->buffers.resize(RECV_BATCH * RECV_BUFFER_SIZE);
+        reactor->running = true;
+        int cpu = config_.reactor_cpus.empty() ? -1 : config_.reactor_cpus[i % config_.reactor_cpus.size()];
+        reactor->thread = std::thread(&RtspClientRuntime::ReactorLoop, this, reactor.get(), cpu);
+        reactors_.push_back(std::move(reactor));
+    }
+
+    if (reactors_.empty()) {
+        return false;
+    }
+    LMRTSP_LOGI("Client runtime started %zu UDP receive reactors", reactors_.size());
+    return true;
+#else
+    return false;
+#endif
+}
+
+void RtspClientRuntime::ReactorLoop(Reactor *reactor, int cpu)
+{
+#ifdef __linux__
+    if (cpu >= 0) {
+        CpuAffinity::PinCurrentThread({cpu});
+    }
+
+    epoll_event events[MAX_EVENTS];
+    while (reactor->running) {
+        int count = epoll_wait(reactor->epollFd, events, MAX_EVENTS, -1);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            LMRTSP_LOGE("Client runtime epoll_wait failed: %s", strerror(errno));
+            break;
+        }
+
+        for (int i = 0; i < count; ++i) {
+            uint16_t port = static_cast<uint16_t>(events[i].data.u32);
+            if (port == 0) {
+                continue; // Woken up to observe running
+            }
+
+            std::shared_ptr<Socket> socket;
+            {
+                std::lock_guard<std::mutex> lock(reactor->mutex);
+                auto it = reactor->sockets.find(port);
+                if (it != reactor->sockets.end()) {
+                    socket = it->second;
+                }
+            }
+            if (socket) {
+                ReceiveFrom(reactor, socket);
+            }
+        }
+    }
+#else
+    (void)reactor;
+    (void)cpu;
+#endif
+}
+
+void RtspClientRuntime::ReceiveFrom(Reactor *reactor, const std::shared_ptr<Socket> &socket)
+{
+#ifdef __linux__
+    mmsghdr msgs[RECV_BATCH];
+    iovec iovs[RECV_BATCH];
+
+    for (int round = 0; round < RECV_ROUNDS; ++round) {
+        for (size_t i = 0; i < RECV_BATCH; ++i) {
+            iovs[i].iov_base = reactor->buffers.data() + i * RECV_BUFFER_SIZE;
+            iovs[i].iov_len = RECV_BUFFER_SIZE;
+            msgs[i] = {};
+            msgs[i].msg_hdr.msg_iov = &iovs[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+
+        int count = recvmmsg(socket->fd, msgs, RECV_BATCH, MSG_DONTWAIT, nullptr);
+        if (count <= 0) {
+            if (count < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                LMRTSP_LOGW("recvmmsg on port %u failed: %s", socket->port, strerror(errno));
+            }
+            return;
+        }
+
+        for (int i = 0; i < count; ++i) {
+            if (msgs[i].msg_hdr.msg_flags & MSG_TRUNC) {
+                continue;
+            }
+            const uint8_t *data = static_cast<const uint8_t *>(iovs[i].iov_base);
+            size_t size = msgs[i].msg_len;
+
+            std::shared_ptr<Receiver> receiver;
+            {
+                std::lock_guard<std::mutex> lock(socket->mutex);
+                // A lone catch-all receiver takes everything, SSRC-bound receivers only their own stream
+                if (socket->receivers.size() == 1 && socket->receivers.begin()->first == 0) {
+                    receiver = socket->receivers.begin()->second;
+                } else {
+                    auto it = socket->receivers.find(ReadSsrc(data, size, socket->type));
+                    if (it == socket->receivers.end()) {
+                        it = socket->receivers.find(0);
+                    }
+                    if (it != socket->receivers.end()) {
+                        receiver = it->second;
+                    }
+                }
+            }
+            if (!receiver) {
+                continue;
+            }
+
+            auto buffer = lmcore::DataBuffer::PoolAlloc(size);
+            buffer->Append(data, size);
+
+            std::lock_guard<std::recursive_mutex> lock(receiver->mutex);
+            if (receiver->active) {
+                receiver->handler(buffer);
+            }
+        }
+
+        if (static_cast<size_t>(count) < RECV_BATCH) {
+            return;
+        }
+    }
+#else
+    (void)reactor;
+    (void)socket;
+#endif
+}
+
+std::shared_ptr<Timer> RtspClientRuntime::GetSharedTimer()
+{
+    std::lock_guard<std::mutex> lock(timerMutex_);
+    if (!timer_) {
+        timer_ = Clock::Get()->CreateTimer();
+        if (!timer_) {
+            LMRTSP_LOGE("Failed to create client runtime timer");
+        }
+    }
+    return timer_;
+}
+
+void RtspClientRuntime::Tick()
+{
+    std::vector<std::shared_ptr<RtspClient>> clients;
+    {
+        std::lock_guard<std::mutex> lock(clientsMutex_);
+        clients.reserve(clients_.size());
+        for (auto it = clients_.begin(); it != clients_.end();) {
+            if (auto client = it->second.lock()) {
+                clients.push_back(std::move(client));
+                ++it;
+            } else {
+                it = clients_.erase(it);
+            }
+        }
+    }
+
+    int64_t now_ms = Clock::Get()->MonotonicNs() / 1000000;
+    for (auto &client : clients) {
+        client->OnRuntimeTick(now_ms);
+    }
+}
+
+void RtspClientRuntime::WorkerFunc()
+{
+    std::unique_lock<std::mutex> lock(taskMutex_);
+    while (true) {
+        taskCv_.wait(lock, [this]() { return stop_ || !tasks_.empty(); });
+        if (stop_) {
+            break;
+        }
+
+        auto task = std::move(tasks_.front());
+        tasks_.pop_front();
+
+        lock.unlock();
+        task();
+        lock.lock();
+    }
+}
+
+} // namespace lmshao::lmrtsp
@@ -348,6 +348,13 @@ void RtspClientSession::SetTransportConfig(const TransportConfig &config)
 {
     std::lock_guard<std::mutex> lock(sessionMutex_);
     transportConfig_ = config;
+
+    // Client ports chosen by the caller replace the allocated ones in the SETUP Transport header
+    if (config.client_rtp_port != 0 && config.client_rtp_port != clientRtpPort_) {
+        clientRtpPort_ = config.client_rtp_port;
+        clientRtcpPort_ = config.client_rtcp_port;
+        transportInfo_ = GenerateTransportHeader();
+    }
 }
 
 TransportConfig RtspClientSession::GetTransportConfig() const
@@ -513,6 +520,9 @@ bool RtspClientSession::ParseSDP(const std::string &sdp)
                             }
                         }
                     }
+                } else if (media_found && line == "a=rtcp-rsize") {
+                    mediaStreamInfo_->rtcp_reduced_size = true;
+                    LMRTSP_LOGD("Server accepts reduced-size RTCP");
                 } else if (line.find("fmtp:") != std::string::npos) {
                     // Parse format parameters (for H.264/H.265 SPS/PPS, AAC config, etc.)
                     mediaStreamInfo_->profile_level = line.substr(line.find("fmtp:") + 5);
@@ -573,6 +583,7 @@ bool RtspClientSession::SetupRtpSession()
 
         config.video_payload_type = mediaStreamInfo_->payload_type;
         config.transport = transportConfig_;
+        config.rtcp_reduced_size = mediaStreamInfo_->rtcp_reduced_size;
 
         LMRTSP_LOGI("Creating RTP sink session: codec=%s, video_type=%d, payload_type=%u",
                     mediaStreamInfo_->codec.c_str(), static_cast<int>(config.video_type), config.video_payload_type);
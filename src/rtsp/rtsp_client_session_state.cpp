@@ -158,8 +158,9 @@ ClientStateAction ClientOptionsSentState::OnTeardownResponse(RtspClientSession *
 ClientStateAction ClientDescribeSentState::OnOptionsResponse(RtspClientSession *session, RtspClient *client,
                                                              const RtspResponse &response)
 {
-    LMRTSP_LOGD("ClientDescribeSentState: Received OPTIONS response (unexpected in DescribeSent state)");
-    return ClientStateAction::FAIL;
+    // A pipelined handshake sends DESCRIBE before the OPTIONS response is in, nothing to do for it
+    LMRTSP_LOGD("ClientDescribeSentState: Received OPTIONS response");
+    return ClientStateAction::WAIT;
 }
 
 ClientStateAction ClientDescribeSentState::OnDescribeResponse(RtspClientSession *session, RtspClient *client,
@@ -0,0 +1,299 @@
+/**
+ * @author SHAO Liming <lmshao@163.com>
+ * @copyright Copyright (c) 2025 SHAO Liming
+ * @license MIT
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "lmrtsp/rtsp_header_map.h"
+
+#include <charconv>
+#include <stdexcept>
+
+#include "lmrtsp/rtsp_headers.h"
+
+namespace lmshao::lmrtsp {
+
+namespace {
+
+// Indexed by RtspHeaderId
+constexpr const char *HEADER_NAMES[] = {
+    "",
+    CSEQ,
+    DATE,
+    SESSION,
+    TRANSPORT,
+    RANGE,
+    LOCATION,
+    REQUIRE,
+    PROXY_REQUIRE,
+    ACCEPT,
+    ACCEPT_ENCODING,
+    ACCEPT_LANGUAGE,
+    AUTHORIZATION,
+    FROM,
+    IF_MODIFIED_SINCE,
+    REFERER,
+    USER_AGENT,
+    PROXY_AUTHENTICATE,
+    PUBLIC,
+    RETRY_AFTER,
+    SERVER,
+    VARY,
+    WWW_AUTHENTICATE,
+    RTP_INFO,
+    CONTENT_TYPE,
+    CONTENT_LENGTH,
+};
+
+static_assert(sizeof(HEADER_NAMES) / sizeof(HEADER_NAMES[0]) == static_cast<size_t>(RtspHeaderId::COUNT),
+              "HEADER_NAMES must list every RtspHeaderId");
+
+inline char ToLowerAscii(char c)
+{
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+bool EqualsIgnoreCase(std::string_view a, std::string_view b)
+{
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (ToLowerAscii(a[i]) != ToLowerAscii(b[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string_view Trim(std::string_view text)
+{
+    size_t begin = text.find_first_not_of(" \t\r\n");
+    if (begin == std::string_view::npos) {
+        return {};
+    }
+    size_t end = text.find_last_not_of(" \t\r\n");
+    return text.substr(begin, end - begin + 1);
+}
+
+} // namespace
+
+RtspHeaderId LookupRtspHeader(std::string_view name)
+{
+    for (size_t i = 1; i < static_cast<size_t>(RtspHeaderId::COUNT); ++i) {
+        std::string_view candidate = HEADER_NAMES[i];
+        // Length and first letter reject almost every candidate before the full compare
+        if (candidate.size() == name.size() && ToLowerAscii(candidate[0]) == ToLowerAscii(name[0]) &&
+            EqualsIgnoreCase(candidate, name)) {
+            return static_cast<RtspHeaderId>(i);
+        }
+    }
+    return RtspHeaderId::UNKNOWN;
+}
+
+const char *GetRtspHeaderName(RtspHeaderId id)
+{
+    size_t index = static_cast<size_t>(id);
+    return index < static_cast<size_t>(RtspHeaderId::COUNT) ? HEADER_NAMES[index] : "";
+}
+
+bool SplitRtspHeaderLine(std::string_view line, std::string_view &name, std::string_view &value)
+{
+    size_t colon = line.find(':');
+    if (colon == std::string_view::npos) {
+        return false;
+    }
+    name = Trim(line.substr(0, colon));
+    value = Trim(line.substr(colon + 1));
+    return true;
+}
+
+RtspHeaderMap::const_iterator::const_iterator(const RtspHeaderMap *map, size_t index) : map_(map), index_(index)
+{
+    Load();
+}
+
+RtspHeaderMap::const_iterator &RtspHeaderMap::const_iterator::operator++()
+{
+    ++index_;
+    Load();
+    return *this;
+}
+
+RtspHeaderMap::const_iterator RtspHeaderMap::const_iterator::operator++(int)
+{
+    const_iterator previous = *this;
+    ++*this;
+    return previous;
+}
+
+void RtspHeaderMap::const_iterator::Load()
+{
+    if (map_ && index_ < map_->size()) {
+        const Entry &entry = map_->EntryAt(index_);
+        current_ = {map_->NameOf(entry), map_->ValueOf(entry)};
+    } else {
+        current_ = {};
+    }
+}
+
+RtspHeaderMap::const_iterator RtspHeaderMap::find(RtspHeaderId id) const
+{
+    return const_iterator(this, FindIndex(id));
+}
+
+RtspHeaderMap::const_iterator RtspHeaderMap::find(std::string_view name) const
+{
+    return const_iterator(this, FindIndex(name));
+}
+
+std::string_view RtspHeaderMap::at(RtspHeaderId id) const
+{
+    size_t index = FindIndex(id);
+    if (index == size()) {
+        throw std::out_of_range("RtspHeaderMap::at");
+    }
+    return ValueOf(EntryAt(index));
+}
+
+std::string_view RtspHeaderMap::at(std::string_view name) const
+{
+    size_t index = FindIndex(name);
+    if (index == size()) {
+        throw std::out_of_range("RtspHeaderMap::at");
+    }
+    return ValueOf(EntryAt(index));
+}
+
+void RtspHeaderMap::clear()
+{
+    inlineCount_ = 0;
+    overflow_.clear();
+    storage_.clear();
+}
+
+std::string_view RtspHeaderMap::Get(RtspHeaderId id) const
+{
+    size_t index = FindIndex(id);
+    return index == size() ? std::string_view() : ValueOf(EntryAt(index));
+}
+
+int RtspHeaderMap::GetInt(RtspHeaderId id, int default_value) const
+{
+    std::string_view value = Get(id);
+    int result = 0;
+    auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), result);
+    if (value.empty() || error != std::errc() || end == value.data()) {
+        return default_value;
+    }
+    return result;
+}
+
+void RtspHeaderMap::Set(RtspHeaderId id, std::string_view value)
+{
+    if (id == RtspHeaderId::UNKNOWN) {
+        return;
+    }
+
+    size_t index = FindIndex(id);
+    if (index != size()) {
+        StoreValue(EntryAt(index), value);
+        return;
+    }
+
+    Entry entry;
+    entry.id = id;
+    StoreValue(entry, value);
+    if (inlineCount_ < INLINE_ENTRIES) {
+        inline_[inlineCount_++] = entry;
+    } else {
+        overflow_.push_back(entry);
+    }
+}
+
+void RtspHeaderMap::Set(std::string_view name, std::string_view value)
+{
+    RtspHeaderId id = LookupRtspHeader(name);
+    if (id != RtspHeaderId::UNKNOWN) {
+        Set(id, value);
+        return;
+    }
+
+    size_t index = FindIndex(name);
+    if (index != size()) {
+        StoreValue(EntryAt(index), value);
+        return;
+    }
+
+    Entry entry;
+    entry.nameOffset = static_cast<uint32_t>(storage_.size());
+    entry.nameSize = static_cast<uint32_t>(name.size());
+    storage_.append(name);
+    StoreValue(entry, value);
+    overflow_.push_back(entry);
+}
+
+const RtspHeaderMap::Entry &RtspHeaderMap::EntryAt(size_t index) const
+{
+    return index < inlineCount_ ? inline_[index] : overflow_[index - inlineCount_];
+}
+
+RtspHeaderMap::Entry &RtspHeaderMap::EntryAt(size_t index)
+{
+    return index < inlineCount_ ? inline_[index] : overflow_[index - inlineCount_];
+}
+
+size_t RtspHeaderMap::FindIndex(RtspHeaderId id) const
+{
+    for (size_t i = 0; i < inlineCount_; ++i) {
+        if (inline_[i].id == id) {
+            return i;
+        }
+    }
+    for (size_t i = 0; i < overflow_.size(); ++i) {
+        if (overflow_[i].id == id) {
+            return inlineCount_ + i;
+        }
+    }
+    return size();
+}
+
+size_t RtspHeaderMap::FindIndex(std::string_view name) const
+{
+    RtspHeaderId id = LookupRtspHeader(name);
+    if (id != RtspHeaderId::UNKNOWN) {
+        return FindIndex(id);
+    }
+
+    for (size_t i = 0; i < overflow_.size(); ++i) {
+        if (overflow_[i].id == RtspHeaderId::UNKNOWN && EqualsIgnoreCase(NameOf(overflow_[i]), name)) {
+            return inlineCount_ + i;
+        }
+    }
+    return size();
+}
+
+std::string_view RtspHeaderMap::NameOf(const Entry &entry) const
+{
+    if (entry.id != RtspHeaderId::UNKNOWN) {
+        return GetRtspHeaderName(entry.id);
+    }
+    return std::string_view(storage_).substr(entry.nameOffset, entry.nameSize);
+}
+
+std::string_view RtspHeaderMap::ValueOf(const Entry &entry) const
+{
+    return std::string_view(storage_).substr(entry.valueOffset, entry.valueSize);
+}
+
+void RtspHeaderMap::StoreValue(Entry &entry, std::string_view value)
+{
+    // A replaced value stays in the storage unused, headers are rarely set twice
+    entry.valueOffset = static_cast<uint32_t>(storage_.size());
+    entry.valueSize = static_cast<uint32_t>(value.size());
+    storage_.append(value);
+}
+
+} // namespace lmshao::lmrtsp
@@ -7,9 +7,13 @@
 #include <sstream>
 
 #include "internal_logger.h"
+#include "lmrtsp/cpu_accounting.h"
 #include "lmrtsp/media_types.h"
+#include "lmrtsp/rtcp_context.h"
 #include "lmrtsp/rtp_source_session.h"
+#include "lmrtsp/rtsp_server.h"
 #include "lmrtsp/rtsp_server_session.h"
+#include "rtp/io_uring_rtp_transport_adapter.h"
 #include "rtp/udp_rtp_transport_adapter.h"
 
 namespace lmshao::lmrtsp {
@@ -18,6 +22,7 @@ RtspMediaStreamManager::RtspMediaStreamManager(std::weak_ptr<lmshao::lmrtsp::Rts
     : RtspServerSession_(rtsp_session), state_(StreamState::IDLE), active_(false), sendThreadRunning_(false),
       sequenceNumber_(0), timestamp_(0), ssrc_(0)
 {
+    cpuAccount_ = std::make_shared<CpuAccount>();
 }
 
 RtspMediaStreamManager::~RtspMediaStreamManager()
@@ -30,9 +35,6 @@ bool RtspMediaStreamManager::Setup(const lmshao::lmrtsp::TransportConfig &config
     // Persist provided transport config for later response headers
     transport_config_ = config;
 
-    // Create RTP source session
-    rtpSession_ = std::make_unique<RtpSourceSession>();
-
     // Get media stream info from RTSP session to determine codec type
     MediaType video_type = MediaType::H264; // default
     uint8_t payload_type = 96;              // default for H264
@@ -79,53 +81,92 @@ bool RtspMediaStreamManager::Setup(const lmshao::lmrtsp::TransportConfig &config
     LMRTSP_LOGI("Final codec configuration - video_type: %d, payload_type: %d", static_cast<int>(video_type),
                 payload_type);
 
-    // Prepare config for RTP session
+    mediaType_ = video_type;
+    payloadType_ = payload_type;
+
+    if (config.type == TransportConfig::Type::UDP) {
+        if (config.client_ip.empty() || config.client_rtp_port == 0) {
+            LMRTSP_LOGE("Client address not configured for UDP transport");
+            return false;
+        }
+
+        // Reserve server ports now for the SETUP response, sockets are opened on PLAY
+        if (transport_config_.server_rtp_port == 0) {
+            // A repeated SETUP replaces the transport, give back the pair the previous one reserved
+            if (reservedRtpPort_ != 0) {
+                UdpRtpTransportAdapter::ReleasePortPair(reservedRtpPort_);
+            }
+            reservedRtpPort_ = UdpRtpTransportAdapter::ReservePortPair();
+            if (reservedRtpPort_ == 0) {
+                LMRTSP_LOGE("Failed to reserve UDP server ports");
+                return false;
+            }
+            transport_config_.server_rtp_port = reservedRtpPort_;
+            transport_config_.server_rtcp_port = config.client_rtcp_port != 0 ? reservedRtpPort_ + 1 : 0;
+        }
+        LMRTSP_LOGD("Reserved UDP ports: server_rtp=%u, server_rtcp=%u, client_rtp=%u, client_rtcp=%u",
+                    transport_config_.server_rtp_port, transport_config_.server_rtcp_port,
+                    transport_config_.client_rtp_port, transport_config_.client_rtcp_port);
+    } else if (config.type == TransportConfig::Type::TCP_INTERLEAVED) {
+        LMRTSP_LOGI("TCP interleaved mode: interleaved=%d-%d", config.rtpChannel, config.rtcpChannel);
+    }
+
+    state_ = StreamState::SETUP;
+    return true;
+}
+
+bool RtspMediaStreamManager::CreateRtpSession()
+{
     RtpSourceSessionConfig rtp_config;
-    rtp_config.transport = config;
-    rtp_config.video_type = video_type;
-    rtp_config.video_payload_type = payload_type;
+    rtp_config.ssrc = ssrc_;
+    rtp_config.transport = transport_config_;
+    rtp_config.video_type = mediaType_;
+    rtp_config.video_payload_type = payloadType_;
     rtp_config.mtu_size = 1400;
     rtp_config.enable_rtcp = true;
     // Pass RTSP session for TCP interleaved mode
     rtp_config.rtsp_session = RtspServerSession_;
+    rtp_config.cpu_account = cpuAccount_;
+    if (auto rtsp_session = RtspServerSession_.lock()) {
+        if (auto server = rtsp_session->GetRTSPServer().lock()) {
+            rtp_config.parallel_packetize_bytes = server->GetParallelPacketizeBytes();
+            rtp_config.ts_filter = server->GetTSFilter();
+        }
+        rtp_config.transport.incoming_cpu = rtsp_session->GetHomeCpu();
+        if (!egressShaper_) {
+            egressShaper_ = rtsp_session->CreateEgressShaper();
+        }
+    }
+    rtp_config.egress_shaper = egressShaper_;
 
-    // Initialize RTP session (this will create and setup transport)
-    if (!rtpSession_->Initialize(rtp_config)) {
+    // Initialize RTP session (this will create and setup transport on the reserved ports)
+    auto session = std::make_unique<RtpSourceSession>();
+    if (!session->Initialize(rtp_config)) {
         LMRTSP_LOGE("Failed to initialize RTP source session");
-        rtpSession_.reset();
         return false;
     }
 
-    // Get transport adapter and update config with allocated ports
-    if (config.type == TransportConfig::Type::UDP) {
-        auto *transport = rtpSession_->GetTransportAdapter();
-        if (transport) {
-            auto *udp_adapter = dynamic_cast<UdpRtpTransportAdapter *>(transport);
-            if (udp_adapter) {
-                transport_config_.server_rtp_port = udp_adapter->GetServerRtpPort();
-                transport_config_.server_rtcp_port = udp_adapter->GetServerRtcpPort();
-                LMRTSP_LOGD("Allocated UDP ports: server_rtp=%u, server_rtcp=%u, client_rtp=%u, client_rtcp=%u",
-                            transport_config_.server_rtp_port, transport_config_.server_rtcp_port,
-                            transport_config_.client_rtp_port, transport_config_.client_rtcp_port);
-            }
-        }
-    } else if (config.type == TransportConfig::Type::TCP_INTERLEAVED) {
-        LMRTSP_LOGI("TCP interleaved mode: interleaved=%d-%d", config.rtpChannel, config.rtcpChannel);
-    }
-
-    state_ = StreamState::SETUP;
+    ssrc_ = session->GetSsrc();
+    rtpSession_ = std::move(session);
     return true;
 }
 
 bool RtspMediaStreamManager::Play()
 {
+    std::lock_guard<std::mutex> lock(rtpSessionMutex_);
     if (state_ != StreamState::SETUP && state_ != StreamState::PAUSED) {
         return false;
     }
 
-    // Start RTP session
-    if (rtpSession_) {
-        rtpSession_->Start();
+    // Create RTP session on first PLAY or after PAUSE released it
+    if (!rtpSession_ && !CreateRtpSession()) {
+        return false;
+    }
+
+    if (!rtpSession_->Start()) {
+        LMRTSP_LOGE("Failed to start RTP source session");
+        rtpSession_.reset();
+        return false;
     }
 
     active_ = true;
@@ -137,24 +178,28 @@ bool RtspMediaStreamManager::Play()
 
 bool RtspMediaStreamManager::Pause()
 {
+    std::lock_guard<std::mutex> lock(rtpSessionMutex_);
     if (state_ != StreamState::PLAYING) {
         return false;
     }
 
-    // Stop RTP session
+    active_ = false;
+
+    // Release RTP session while paused, ports stay reserved for the next PLAY
     if (rtpSession_) {
         rtpSession_->Stop();
+        rtpSession_.reset();
     }
 
-    active_ = false;
     state_ = StreamState::PAUSED;
 
-    LMRTSP_LOGD("Media playback paused");
+    LMRTSP_LOGD("Media playback paused, RTP session released");
     return true;
 }
 
 void RtspMediaStreamManager::Teardown()
 {
+    std::lock_guard<std::mutex> lock(rtpSessionMutex_);
     active_ = false;
     sendThreadRunning_ = false;
 
@@ -164,13 +209,23 @@ void RtspMediaStreamManager::Teardown()
         rtpSession_.reset();
     }
 
+    if (reservedRtpPort_ != 0) {
+        UdpRtpTransportAdapter::ReleasePortPair(reservedRtpPort_);
+        reservedRtpPort_ = 0;
+    }
+
     state_ = StreamState::IDLE;
     LMRTSP_LOGD("Media stream teardown completed");
 }
 
 bool RtspMediaStreamManager::PushFrame(const lmrtsp::MediaFrame &frame)
 {
-    if (!active_ || !rtpSession_) {
+    if (!active_) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(rtpSessionMutex_);
+    if (!rtpSession_) {
         return false;
     }
 
@@ -233,6 +288,72 @@ bool RtspMediaStreamManager::IsActive() const
     return active_;
 }
 
+size_t RtspMediaStreamManager::GetMemoryUsage() const
+{
+    std::lock_guard<std::mutex> lock(rtpSessionMutex_);
+    size_t usage = sizeof(*this) + transport_config_.client_ip.capacity();
+    if (rtpSession_) {
+        usage += rtpSession_->GetMemoryUsage();
+    }
+    return usage;
+}
+
+bool RtspMediaStreamManager::HasRtpSession() const
+{
+    std::lock_guard<std::mutex> lock(rtpSessionMutex_);
+    return rtpSession_ != nullptr;
+}
+
+bool RtspMediaStreamManager::OnInterleavedRtcp(uint8_t channel, const lmcore::DataBuffer &buffer)
+{
+    if (transport_config_.type != TransportConfig::Type::TCP_INTERLEAVED || channel != transport_config_.rtcpChannel) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(rtpSessionMutex_);
+    if (rtpSession_) {
+        rtpSession_->OnRtcpData(buffer);
+    }
+    return true;
+}
+
+RtcpReceiverFeedback RtspMediaStreamManager::GetReceiverFeedback() const
+{
+    std::lock_guard<std::mutex> lock(rtpSessionMutex_);
+    if (!rtpSession_ || !rtpSession_->GetRtcpContext()) {
+        return RtcpReceiverFeedback{};
+    }
+    return rtpSession_->GetRtcpContext()->GetReceiverFeedback();
+}
+
+RtcpXrStats RtspMediaStreamManager::GetXrStats() const
+{
+    std::lock_guard<std::mutex> lock(rtpSessionMutex_);
+    if (!rtpSession_ || !rtpSession_->GetRtcpContext()) {
+        return RtcpXrStats{};
+    }
+    return rtpSession_->GetRtcpContext()->GetXrStats();
+}
+
+EgressStats RtspMediaStreamManager::GetEgressStats() const
+{
+    std::lock_guard<std::mutex> lock(rtpSessionMutex_);
+    return egressShaper_ ? egressShaper_->GetStats() : EgressStats{};
+}
+
+bool RtspMediaStreamManager::HasKernelPacing() const
+{
+    std::lock_guard<std::mutex> lock(rtpSessionMutex_);
+    return rtpSession_ && rtpSession_->GetTransportAdapter() && rtpSession_->GetTransportAdapter()->HasKernelPacing();
+}
+
+size_t RtspMediaStreamManager::GetSendQueueBytes() const
+{
+    std::lock_guard<std::mutex> lock(rtpSessionMutex_);
+    return rtpSession_ && rtpSession_->GetTransportAdapter() ? rtpSession_->GetTransportAdapter()->GetSendQueueBytes()
+                                                             : 0;
+}
+
 void RtspMediaStreamManager::SendMediaThread()
 {
     // This method can be used for threaded media sending if needed
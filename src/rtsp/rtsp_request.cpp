@@ -76,154 +76,117 @@ RtspRequest RtspRequest::FromString(const std::string &req_str)
         return request;
     }
 
-    // Split the request into lines
-    std::vector<std::string> lines = StringUtils::Split(req_str, CRLF);
-
-    if (lines.empty()) {
-        LMRTSP_LOGD("No lines found in request string");
+    // Parse in place over the text, only the values that are kept get copied
+    std::string_view text(req_str);
+    size_t line_end = text.find(CRLF);
+    std::string_view request_line = text.substr(0, line_end);
+    LMRTSP_LOGD("Request line: [%.*s]", static_cast<int>(request_line.size()), request_line.data());
+
+    // Request line: method SP uri SP version
+    size_t method_end = request_line.find(' ');
+    size_t uri_end = method_end == std::string_view::npos ? method_end : request_line.find(' ', method_end + 1);
+    if (uri_end == std::string_view::npos) {
+        LMRTSP_LOGE("Invalid request line format. Expected 3 parts. Line: [%.*s]",
+                    static_cast<int>(request_line.size()), request_line.data());
         return request;
     }
 
-    // Parse the request line (first line)
-    std::string request_line = lines[0];
-    LMRTSP_LOGD("Request line: [%s]", request_line.c_str());
-
-    std::vector<std::string> request_parts = StringUtils::Split(request_line, SP);
-    LMRTSP_LOGD("Request parts count: %zu", request_parts.size());
-
-    if (request_parts.size() >= 3) {
-        LMRTSP_LOGD("Request parts: [%s] [%s] [%s]", request_parts[0].c_str(), request_parts[1].c_str(),
-                    request_parts[2].c_str());
-
-        // Validate that the version looks like RTSP/x.x
-        if (request_parts[2].find("RTSP/") == 0) {
-            request.method_ = request_parts[0];
-            request.uri_ = request_parts[1];
-            request.version_ = request_parts[2];
-            LMRTSP_LOGD("Successfully parsed request line - Method: %s, URI: %s, Version: %s", request.method_.c_str(),
-                        request.uri_.c_str(), request.version_.c_str());
-        } else {
-            // Invalid version format
-            LMRTSP_LOGE("Invalid RTSP version format: [%s]. Expected RTSP/x.x", request_parts[2].c_str());
-            return request;
-        }
-    } else {
-        // Invalid request line
-        LMRTSP_LOGE("Invalid request line format. Expected at least 3 parts, got %zu. Line: [%s]", request_parts.size(),
-                    request_line.c_str());
+    std::string_view version = request_line.substr(uri_end + 1);
+    version = version.substr(0, version.find(' '));
+    if (version.compare(0, 5, "RTSP/") != 0) {
+        LMRTSP_LOGE("Invalid RTSP version format: [%.*s]. Expected RTSP/x.x", static_cast<int>(version.size()),
+                    version.data());
         return request;
     }
 
-    // Find the empty line that separates headers from body
-    size_t body_start = 0;
-    bool found_empty_line = false;
-
-    for (size_t i = 1; i < lines.size(); ++i) {
-        if (lines[i].empty()) {
-            body_start = i + 1;
-            found_empty_line = true;
-            break;
-        }
+    request.method_ = request_line.substr(0, method_end);
+    request.uri_ = request_line.substr(method_end + 1, uri_end - method_end - 1);
+    request.version_ = version;
+    LMRTSP_LOGD("Successfully parsed request line - Method: %s, URI: %s, Version: %s", request.method_.c_str(),
+                request.uri_.c_str(), request.version_.c_str());
+
+    // Headers run up to the empty line, the body follows it
+    size_t headers_start = line_end == std::string_view::npos ? text.size() : line_end + 2;
+    size_t headers_end = text.find(CRLFCRLF, line_end == std::string_view::npos ? text.size() : line_end);
+    size_t body_start = std::string_view::npos;
+    if (headers_end != std::string_view::npos) {
+        body_start = headers_end + 4;
+    } else {
+        headers_end = text.size();
+    }
+    if (headers_start < headers_end) {
+        request.general_header_.Reserve(headers_end - headers_start);
     }
 
-    // Parse headers
-    std::vector<std::string> header_lines;
-    size_t header_end = found_empty_line ? body_start - 1 : lines.size();
-
-    for (size_t i = 1; i < header_end; ++i) {
-        if (!lines[i].empty()) {
-            header_lines.push_back(lines[i]);
+    size_t pos = headers_start;
+    while (pos < headers_end) {
+        size_t next = text.find(CRLF, pos);
+        if (next == std::string_view::npos || next > headers_end) {
+            next = headers_end;
         }
-    }
+        std::string_view line = text.substr(pos, next - pos);
+        pos = next + 2;
 
-    // Process each header line
-    for (const std::string &line : header_lines) {
-        size_t colon_pos = line.find(COLON);
-        if (colon_pos == std::string::npos) {
+        std::string_view name;
+        std::string_view value;
+        if (!SplitRtspHeaderLine(line, name, value)) {
             continue; // Invalid header line
         }
 
-        std::string header_name = StringUtils::Trim(line.substr(0, colon_pos));
-        std::string header_value = StringUtils::Trim(line.substr(colon_pos + 1));
-
-        // Classify headers into general, request, and entity headers (case-insensitive)
-        if (StringUtils::EqualsIgnoreCase(header_name, CSEQ) || StringUtils::EqualsIgnoreCase(header_name, DATE) ||
-            StringUtils::EqualsIgnoreCase(header_name, SESSION) ||
-            StringUtils::EqualsIgnoreCase(header_name, TRANSPORT) ||
-            StringUtils::EqualsIgnoreCase(header_name, LOCATION) ||
-            StringUtils::EqualsIgnoreCase(header_name, REQUIRE) ||
-            StringUtils::EqualsIgnoreCase(header_name, PROXY_REQUIRE)) {
-            // General headers
-            request.general_header_[header_name] = header_value;
-        } else if (StringUtils::EqualsIgnoreCase(header_name, CONTENT_TYPE) ||
-                   StringUtils::EqualsIgnoreCase(header_name, CONTENT_LENGTH)) {
-            // Entity headers
-            request.entity_header_[header_name] = header_value;
-        } else if (StringUtils::EqualsIgnoreCase(header_name, ACCEPT) ||
-                   StringUtils::EqualsIgnoreCase(header_name, ACCEPT_ENCODING) ||
-                   StringUtils::EqualsIgnoreCase(header_name, ACCEPT_LANGUAGE) ||
-                   StringUtils::EqualsIgnoreCase(header_name, AUTHORIZATION) ||
-                   StringUtils::EqualsIgnoreCase(header_name, FROM) ||
-                   StringUtils::EqualsIgnoreCase(header_name, IF_MODIFIED_SINCE) ||
-                   StringUtils::EqualsIgnoreCase(header_name, RANGE) ||
-                   StringUtils::EqualsIgnoreCase(header_name, REFERER) ||
-                   StringUtils::EqualsIgnoreCase(header_name, USER_AGENT)) {
-            // Request headers - parse using RequestHeader::FromString
-            std::string single_header = header_name + COLON + SP + header_value + CRLF;
-            RequestHeader parsed_header = RequestHeader::FromString(single_header);
-
-            // Merge the parsed header with the request header
-            if (parsed_header.accept_) {
-                request.requestHeader_.accept_ = parsed_header.accept_;
-            }
-            if (parsed_header.acceptEncoding_) {
-                request.requestHeader_.acceptEncoding_ = parsed_header.acceptEncoding_;
-            }
-            if (parsed_header.acceptLanguage_) {
-                request.requestHeader_.acceptLanguage_ = parsed_header.acceptLanguage_;
-            }
-            if (parsed_header.authorization_) {
-                request.requestHeader_.authorization_ = parsed_header.authorization_;
-            }
-            if (parsed_header.from_) {
-                request.requestHeader_.from_ = parsed_header.from_;
-            }
-            if (parsed_header.ifModifiedSince_) {
-                request.requestHeader_.ifModifiedSince_ = parsed_header.ifModifiedSince_;
-            }
-            if (parsed_header.range_) {
-                request.requestHeader_.range_ = parsed_header.range_;
-            }
-            if (parsed_header.referer_) {
-                request.requestHeader_.referer_ = parsed_header.referer_;
-            }
-            if (parsed_header.userAgent_) {
-                request.requestHeader_.userAgent_ = parsed_header.userAgent_;
-            }
-
-            // Add custom headers
-            for (const std::string &custom : parsed_header.customHeader_) {
-                request.requestHeader_.customHeader_.push_back(custom);
-            }
-        } else {
-            // Unknown header, add to request custom headers
-            request.requestHeader_.customHeader_.push_back(header_name + COLON + SP + header_value);
+        // Classify headers into general, request, and entity headers by their interned id
+        RtspHeaderId id = LookupRtspHeader(name);
+        RequestHeader &header = request.requestHeader_;
+        switch (id) {
+            case RtspHeaderId::CSEQ:
+            case RtspHeaderId::DATE:
+            case RtspHeaderId::SESSION:
+            case RtspHeaderId::TRANSPORT:
+            case RtspHeaderId::LOCATION:
+            case RtspHeaderId::REQUIRE:
+            case RtspHeaderId::PROXY_REQUIRE:
+                request.general_header_.Set(id, value);
+                break;
+            case RtspHeaderId::CONTENT_TYPE:
+            case RtspHeaderId::CONTENT_LENGTH:
+                request.entity_header_.Set(id, value);
+                break;
+            case RtspHeaderId::ACCEPT:
+                header.accept_ = value;
+                break;
+            case RtspHeaderId::ACCEPT_ENCODING:
+                header.acceptEncoding_ = value;
+                break;
+            case RtspHeaderId::ACCEPT_LANGUAGE:
+                header.acceptLanguage_ = value;
+                break;
+            case RtspHeaderId::AUTHORIZATION:
+                header.authorization_ = value;
+                break;
+            case RtspHeaderId::FROM:
+                header.from_ = value;
+                break;
+            case RtspHeaderId::IF_MODIFIED_SINCE:
+                header.ifModifiedSince_ = value;
+                break;
+            case RtspHeaderId::RANGE:
+                header.range_ = value;
+                break;
+            case RtspHeaderId::REFERER:
+                header.referer_ = value;
+                break;
+            case RtspHeaderId::USER_AGENT:
+                header.userAgent_ = value;
+                break;
+            default:
+                // Unknown header, add to request custom headers
+                header.customHeader_.push_back(std::string(name) + COLON + SP + std::string(value));
+                break;
         }
     }
 
     // Parse message body if present
-    if (found_empty_line && body_start < lines.size()) {
-        std::ostringstream body_oss;
-        for (size_t i = body_start; i < lines.size(); ++i) {
-            body_oss << lines[i];
-            if (i + 1 < lines.size()) {
-                body_oss << CRLF;
-            }
-        }
-        std::string body = body_oss.str();
-        if (!body.empty()) {
-            request.messageBody_ = body;
-        }
+    if (body_start < text.size()) {
+        request.messageBody_ = std::string(text.substr(body_start));
     }
 
     return request;
@@ -303,43 +266,43 @@ RtspRequestBuilder &RtspRequestBuilder::SetUri(const std::string &uri)
 
 RtspRequestBuilder &RtspRequestBuilder::SetCSeq(int cseq)
 {
-    request_.general_header_[CSEQ] = std::to_string(cseq);
+    request_.general_header_.Set(RtspHeaderId::CSEQ, std::to_string(cseq));
     return *this;
 }
 
 RtspRequestBuilder &RtspRequestBuilder::SetSession(const std::string &session)
 {
-    request_.general_header_[SESSION] = session;
+    request_.general_header_.Set(RtspHeaderId::SESSION, session);
     return *this;
 }
 
 RtspRequestBuilder &RtspRequestBuilder::SetTransport(const std::string &transport)
 {
-    request_.general_header_[TRANSPORT] = transport;
+    request_.general_header_.Set(RtspHeaderId::TRANSPORT, transport);
     return *this;
 }
 
 RtspRequestBuilder &RtspRequestBuilder::SetRange(const std::string &range)
 {
-    request_.general_header_[RANGE] = range;
+    request_.general_header_.Set(RtspHeaderId::RANGE, range);
     return *this;
 }
 
 RtspRequestBuilder &RtspRequestBuilder::SetLocation(const std::string &location)
 {
-    request_.general_header_[LOCATION] = location;
+    request_.general_header_.Set(RtspHeaderId::LOCATION, location);
     return *this;
 }
 
 RtspRequestBuilder &RtspRequestBuilder::SetRequire(const std::string &require)
 {
-    request_.general_header_[REQUIRE] = require;
+    request_.general_header_.Set(RtspHeaderId::REQUIRE, require);
     return *this;
 }
 
 RtspRequestBuilder &RtspRequestBuilder::SetProxyRequire(const std::string &proxy_require)
 {
-    request_.general_header_[PROXY_REQUIRE] = proxy_require;
+    request_.general_header_.Set(RtspHeaderId::PROXY_REQUIRE, proxy_require);
     return *this;
 }
 
@@ -369,20 +332,20 @@ RtspRequestBuilder &RtspRequestBuilder::AddCustomHeader(const std::string &heade
 
 RtspRequestBuilder &RtspRequestBuilder::SetContentType(const std::string &content_type)
 {
-    request_.entity_header_[CONTENT_TYPE] = content_type;
+    request_.entity_header_.Set(RtspHeaderId::CONTENT_TYPE, content_type);
     return *this;
 }
 
 RtspRequestBuilder &RtspRequestBuilder::SetContentLength(size_t length)
 {
-    request_.entity_header_[CONTENT_LENGTH] = std::to_string(length);
+    request_.entity_header_.Set(RtspHeaderId::CONTENT_LENGTH, std::to_string(length));
     return *this;
 }
 
 RtspRequestBuilder &RtspRequestBuilder::SetMessageBody(const std::string &body)
 {
     request_.messageBody_ = body;
-    if (request_.entity_header_.find(CONTENT_LENGTH) == request_.entity_header_.end()) {
+    if (request_.entity_header_.find(RtspHeaderId::CONTENT_LENGTH) == request_.entity_header_.end()) {
         SetContentLength(body.size());
     }
     return *this;
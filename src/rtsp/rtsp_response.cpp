@@ -10,6 +10,7 @@
 
 #include <lmcore/string_utils.h>
 
+#include <charconv>
 #include <sstream>
 
 namespace lmshao::lmrtsp {
@@ -18,15 +19,17 @@ using lmcore::StringUtils;
 
 namespace {
 
+constexpr std::string_view STATUS_LINE_PREFIX = "RTSP/";
+
 // Helper function to parse status code from string
-StatusCode parseStatusCode(const std::string &status_str)
+StatusCode parseStatusCode(std::string_view status_str)
 {
-    try {
-        int code = std::stoi(status_str);
-        return static_cast<StatusCode>(code);
-    } catch (const std::exception &) {
+    int code = 0;
+    auto [end, error] = std::from_chars(status_str.data(), status_str.data() + status_str.size(), code);
+    if (error != std::errc() || end == status_str.data()) {
         return StatusCode::InternalServerError; // Default on parse error
     }
+    return static_cast<StatusCode>(code);
 }
 
 // Helper function to split comma-separated values
@@ -101,136 +104,153 @@ RtspResponse RtspResponse::FromString(const std::string &resp_str)
         return response;
     }
 
-    // Split the response into lines
-    std::vector<std::string> lines = StringUtils::Split(resp_str, CRLF);
-
-    if (lines.empty()) {
-        return response;
-    }
+    // Parse in place over the text, only the values that are kept get copied
+    std::string_view text(resp_str);
+    size_t line_end = text.find(CRLF);
+    std::string_view status_line = text.substr(0, line_end);
 
-    // Parse the status line (first line)
-    std::string status_line = lines[0];
-    std::vector<std::string> status_parts = StringUtils::Split(status_line, SP);
-
-    if (status_parts.size() >= 3) {
-        response.version_ = status_parts[0];
-        response.status_ = parseStatusCode(status_parts[1]);
-        // Note: status_parts[2] and beyond contain the reason phrase, but we don't store it
-        // as it's generated automatically by GetReasonPhrase()
-    } else {
+    // Status line: version SP code SP reason. The reason phrase is not stored, GetReasonPhrase() generates it.
+    size_t version_end = status_line.find(' ');
+    size_t code_end = version_end == std::string_view::npos ? version_end : status_line.find(' ', version_end + 1);
+    if (code_end == std::string_view::npos) {
         // Invalid status line
         response.status_ = StatusCode::InternalServerError;
         return response;
     }
+    response.version_ = status_line.substr(0, version_end);
+    response.status_ = parseStatusCode(status_line.substr(version_end + 1, code_end - version_end - 1));
+
+    // Headers run up to the empty line, the body follows it
+    size_t headers_start = line_end == std::string_view::npos ? text.size() : line_end + 2;
+    size_t headers_end = text.find(CRLFCRLF, line_end == std::string_view::npos ? text.size() : line_end);
+    size_t body_start = std::string_view::npos;
+    if (headers_end != std::string_view::npos) {
+        body_start = headers_end + 4;
+    } else {
+        headers_end = text.size();
+    }
+    if (headers_start < headers_end) {
+        response.general_header_.Reserve(headers_end - headers_start);
+    }
 
-    // Find the empty line that separates headers from body
-    size_t body_start = 0;
-    bool found_empty_line = false;
-
-    for (size_t i = 1; i < lines.size(); ++i) {
-        if (lines[i].empty()) {
-            body_start = i + 1;
-            found_empty_line = true;
-            break;
+    size_t pos = headers_start;
+    while (pos < headers_end) {
+        size_t next = text.find(CRLF, pos);
+        if (next == std::string_view::npos || next > headers_end) {
+            next = headers_end;
         }
-    }
+        std::string_view line = text.substr(pos, next - pos);
+        pos = next + 2;
 
-    // Parse headers
-    std::vector<std::string> header_lines;
-    size_t header_end = found_empty_line ? body_start - 1 : lines.size();
+        std::string_view name;
+        std::string_view value;
+        if (!SplitRtspHeaderLine(line, name, value)) {
+            continue; // Invalid header line
+        }
 
-    for (size_t i = 1; i < header_end; ++i) {
-        if (!lines[i].empty()) {
-            header_lines.push_back(lines[i]);
+        // Classify headers into general, response, and entity headers by their interned id
+        RtspHeaderId id = LookupRtspHeader(name);
+        ResponseHeader &header = response.responseHeader_;
+        switch (id) {
+            case RtspHeaderId::CSEQ:
+            case RtspHeaderId::DATE:
+            case RtspHeaderId::SESSION:
+            case RtspHeaderId::TRANSPORT:
+            case RtspHeaderId::RANGE:
+            case RtspHeaderId::REQUIRE:
+            case RtspHeaderId::PROXY_REQUIRE:
+                response.general_header_.Set(id, value);
+                break;
+            case RtspHeaderId::CONTENT_TYPE:
+            case RtspHeaderId::CONTENT_LENGTH:
+                response.entity_header_.Set(id, value);
+                break;
+            case RtspHeaderId::LOCATION:
+                header.location_ = value;
+                break;
+            case RtspHeaderId::PROXY_AUTHENTICATE:
+                header.proxyAuthenticate_ = value;
+                break;
+            case RtspHeaderId::PUBLIC:
+                header.publicMethods_ = splitCommaSeparated(std::string(value));
+                break;
+            case RtspHeaderId::RETRY_AFTER:
+                header.retryAfter_ = value;
+                break;
+            case RtspHeaderId::SERVER:
+                header.server_ = value;
+                break;
+            case RtspHeaderId::VARY:
+                header.vary_ = value;
+                break;
+            case RtspHeaderId::WWW_AUTHENTICATE:
+                header.wwwAuthenticate_ = value;
+                break;
+            case RtspHeaderId::RTP_INFO:
+                header.rtpInfo_ = value;
+                break;
+            default:
+                // Unknown header, add to response custom headers
+                header.customHeader_.push_back(std::string(name) + COLON + SP + std::string(value));
+                break;
         }
     }
 
-    // Process each header line
-    for (const std::string &line : header_lines) {
-        size_t colon_pos = line.find(COLON);
-        if (colon_pos == std::string::npos) {
-            continue; // Invalid header line
-        }
+    // Parse message body if present
+    if (body_start < text.size()) {
+        response.messageBody_ = std::string(text.substr(body_start));
+    }
 
-        std::string header_name = StringUtils::Trim(line.substr(0, colon_pos));
-        std::string header_value = StringUtils::Trim(line.substr(colon_pos + 1));
+    return response;
+}
 
-        // Classify headers into general, response, and entity headers (case-insensitive)
-        if (StringUtils::EqualsIgnoreCase(header_name, CSEQ) || StringUtils::EqualsIgnoreCase(header_name, DATE) ||
-            StringUtils::EqualsIgnoreCase(header_name, SESSION) ||
-            StringUtils::EqualsIgnoreCase(header_name, TRANSPORT) ||
-            StringUtils::EqualsIgnoreCase(header_name, RANGE) || StringUtils::EqualsIgnoreCase(header_name, REQUIRE) ||
-            StringUtils::EqualsIgnoreCase(header_name, PROXY_REQUIRE)) {
-            // General headers
-            response.general_header_[header_name] = header_value;
-        } else if (StringUtils::EqualsIgnoreCase(header_name, CONTENT_TYPE) ||
-                   StringUtils::EqualsIgnoreCase(header_name, CONTENT_LENGTH)) {
-            // Entity headers
-            response.entity_header_[header_name] = header_value;
-        } else if (StringUtils::EqualsIgnoreCase(header_name, LOCATION) ||
-                   StringUtils::EqualsIgnoreCase(header_name, PROXY_AUTHENTICATE) ||
-                   StringUtils::EqualsIgnoreCase(header_name, PUBLIC) ||
-                   StringUtils::EqualsIgnoreCase(header_name, RETRY_AFTER) ||
-                   StringUtils::EqualsIgnoreCase(header_name, SERVER) ||
-                   StringUtils::EqualsIgnoreCase(header_name, VARY) ||
-                   StringUtils::EqualsIgnoreCase(header_name, WWW_AUTHENTICATE) ||
-                   StringUtils::EqualsIgnoreCase(header_name, RTP_INFO)) {
-            // Response headers - parse using ResponseHeader::FromString
-            std::string single_header = header_name + COLON + SP + header_value + CRLF;
-            ResponseHeader parsed_header = ResponseHeader::FromString(single_header);
-
-            // Merge the parsed header with the response header
-            if (parsed_header.location_) {
-                response.responseHeader_.location_ = parsed_header.location_;
-            }
-            if (parsed_header.proxyAuthenticate_) {
-                response.responseHeader_.proxyAuthenticate_ = parsed_header.proxyAuthenticate_;
-            }
-            if (!parsed_header.publicMethods_.empty()) {
-                response.responseHeader_.publicMethods_ = parsed_header.publicMethods_;
-            }
-            if (parsed_header.retryAfter_) {
-                response.responseHeader_.retryAfter_ = parsed_header.retryAfter_;
-            }
-            if (parsed_header.server_) {
-                response.responseHeader_.server_ = parsed_header.server_;
-            }
-            if (parsed_header.vary_) {
-                response.responseHeader_.vary_ = parsed_header.vary_;
-            }
-            if (parsed_header.wwwAuthenticate_) {
-                response.responseHeader_.wwwAuthenticate_ = parsed_header.wwwAuthenticate_;
-            }
-            if (parsed_header.rtpInfo_) {
-                response.responseHeader_.rtpInfo_ = parsed_header.rtpInfo_;
-            }
+void RtspResponseFramer::Append(const char *data, size_t size)
+{
+    buffer_.append(data, size);
+}
 
-            // Add custom headers
-            for (const std::string &custom : parsed_header.customHeader_) {
-                response.responseHeader_.customHeader_.push_back(custom);
-            }
-        } else {
-            // Unknown header, add to response custom headers
-            response.responseHeader_.customHeader_.push_back(header_name + COLON + SP + header_value);
+bool RtspResponseFramer::Next(RtspResponse &response)
+{
+    for (;;) {
+        size_t header_end = buffer_.find(CRLFCRLF);
+        if (header_end == std::string::npos) {
+            return false;
         }
-    }
+        size_t header_size = header_end + 4;
 
-    // Parse message body if present
-    if (found_empty_line && body_start < lines.size()) {
-        std::ostringstream body_oss;
-        for (size_t i = body_start; i < lines.size(); ++i) {
-            body_oss << lines[i];
-            if (i + 1 < lines.size()) {
-                body_oss << CRLF;
-            }
+        // Leftovers of a discarded message, or garbage: resume at the next status line
+        if (buffer_.compare(0, STATUS_LINE_PREFIX.size(), STATUS_LINE_PREFIX) != 0) {
+            DiscardMessage(0);
+            continue;
+        }
+
+        RtspResponse parsed;
+        try {
+            parsed = RtspResponse::FromString(buffer_.substr(0, header_size));
+        } catch (...) {
+            DiscardMessage(header_size);
+            throw;
         }
-        std::string body = body_oss.str();
-        if (!body.empty()) {
-            response.messageBody_ = body;
+
+        int content_length = parsed.entity_header_.GetInt(RtspHeaderId::CONTENT_LENGTH);
+        size_t body_size = content_length > 0 ? static_cast<size_t>(content_length) : 0;
+        if (buffer_.size() < header_size + body_size) {
+            return false; // Wait for the rest of the body
         }
+
+        if (body_size > 0) {
+            parsed.messageBody_ = buffer_.substr(header_size, body_size);
+        }
+        buffer_.erase(0, header_size + body_size);
+        response = std::move(parsed);
+        return true;
     }
+}
 
-    return response;
+void RtspResponseFramer::DiscardMessage(size_t from)
+{
+    size_t next = buffer_.find(STATUS_LINE_PREFIX, from == 0 ? 1 : from);
+    buffer_.erase(0, next == std::string::npos ? buffer_.size() : next);
 }
 
 std::string GetReasonPhrase(StatusCode code)
@@ -402,31 +422,31 @@ RtspResponseBuilder &RtspResponseBuilder::SetStatus(StatusCode status)
 
 RtspResponseBuilder &RtspResponseBuilder::SetCSeq(int cseq)
 {
-    response_.general_header_[CSEQ] = std::to_string(cseq);
+    response_.general_header_.Set(RtspHeaderId::CSEQ, std::to_string(cseq));
     return *this;
 }
 
 RtspResponseBuilder &RtspResponseBuilder::SetSession(const std::string &session)
 {
-    response_.general_header_[SESSION] = session;
+    response_.general_header_.Set(RtspHeaderId::SESSION, session);
     return *this;
 }
 
 RtspResponseBuilder &RtspResponseBuilder::SetTransport(const std::string &transport)
 {
-    response_.general_header_[TRANSPORT] = transport;
+    response_.general_header_.Set(RtspHeaderId::TRANSPORT, transport);
     return *this;
 }
 
 RtspResponseBuilder &RtspResponseBuilder::SetRange(const std::string &range)
 {
-    response_.general_header_[RANGE] = range;
+    response_.general_header_.Set(RtspHeaderId::RANGE, range);
     return *this;
 }
 
 RtspResponseBuilder &RtspResponseBuilder::SetDate(const std::string &date)
 {
-    response_.general_header_[DATE] = date;
+    response_.general_header_.Set(RtspHeaderId::DATE, date);
     return *this;
 }
 
@@ -482,6 +502,12 @@ RtspResponseBuilder &RtspResponseBuilder::SetRTPInfo(const std::string &rtp_info
     return *this;
 }
 
+RtspResponseBuilder &RtspResponseBuilder::SetRetryAfter(const std::string &retry_after)
+{
+    response_.responseHeader_.retryAfter_ = retry_after;
+    return *this;
+}
+
 RtspResponseBuilder &RtspResponseBuilder::AddCustomHeader(const std::string &header)
 {
     response_.responseHeader_.customHeader_.push_back(header);
@@ -490,20 +516,20 @@ RtspResponseBuilder &RtspResponseBuilder::AddCustomHeader(const std::string &hea
 
 RtspResponseBuilder &RtspResponseBuilder::SetContentType(const std::string &content_type)
 {
-    response_.entity_header_[CONTENT_TYPE] = content_type;
+    response_.entity_header_.Set(RtspHeaderId::CONTENT_TYPE, content_type);
     return *this;
 }
 
 RtspResponseBuilder &RtspResponseBuilder::SetContentLength(size_t length)
 {
-    response_.entity_header_[CONTENT_LENGTH] = std::to_string(length);
+    response_.entity_header_.Set(RtspHeaderId::CONTENT_LENGTH, std::to_string(length));
     return *this;
 }
 
 RtspResponseBuilder &RtspResponseBuilder::SetMessageBody(const std::string &body)
 {
     response_.messageBody_ = body;
-    if (response_.entity_header_.find(CONTENT_LENGTH) == response_.entity_header_.end()) {
+    if (response_.entity_header_.find(RtspHeaderId::CONTENT_LENGTH) == response_.entity_header_.end()) {
         SetContentLength(body.size());
     }
     return *this;
@@ -10,11 +10,11 @@
 #define LMSHAO_LMRTSP_RTSP_RESPONSE_H
 
 #include <cstdint>
-#include <map>
 #include <optional>
 #include <string>
 #include <vector>
 
+#include "lmrtsp/rtsp_header_map.h"
 #include "lmrtsp/rtsp_headers.h"
 
 namespace lmshao::lmrtsp {
@@ -108,12 +108,31 @@ public:
 public:
     std::string version_;
     StatusCode status_;
-    std::map<std::string, std::string> general_header_;
+    RtspHeaderMap general_header_;
     ResponseHeader responseHeader_;
-    std::map<std::string, std::string> entity_header_;
+    RtspHeaderMap entity_header_;
     std::optional<std::string> messageBody_;
 };
 
+// Splits the bytes of an RTSP connection into responses. Pipelined responses can share a read and a
+// response can span reads, so each message is framed by its Content-Length.
+class RtspResponseFramer {
+public:
+    void Append(const char *data, size_t size);
+
+    // Takes the next complete response, false while more data is needed. A message that fails to parse
+    // is discarded up to the next status line before the exception propagates.
+    bool Next(RtspResponse &response);
+
+    void Clear() { buffer_.clear(); }
+    size_t BufferedSize() const { return buffer_.size(); }
+
+private:
+    void DiscardMessage(size_t from);
+
+    std::string buffer_;
+};
+
 // Builder class for constructing RTSP responses
 class RtspResponseBuilder {
 
@@ -137,6 +156,7 @@ public:
     RtspResponseBuilder &SetPublic(const std::string &methods_str);
     RtspResponseBuilder &SetWWWAuthenticate(const std::string &auth);
     RtspResponseBuilder &SetRTPInfo(const std::string &rtp_info);
+    RtspResponseBuilder &SetRetryAfter(const std::string &retry_after);
     RtspResponseBuilder &AddCustomHeader(const std::string &header);
 
     // Entity headers
@@ -15,6 +15,7 @@
 #include "internal_logger.h"
 #include "lmrtsp/irtsp_server_listener.h"
 #include "lmrtsp/rtsp_server_session.h"
+#include "rtp/packetizer_worker_pool.h"
 #include "rtsp_response.h"
 #include "rtsp_server_listener.h"
 
@@ -23,6 +24,27 @@ namespace lmshao::lmrtsp {
 RtspServer::RtspServer()
 {
     LMRTSP_LOGD("RtspServer constructor called");
+
+    // Sender load for admission control: CPU time charged to streams (retired sessions included, so it never
+    // decreases) and bytes still waiting in the socket send buffers of the live sessions
+    admission_.SetLoadSampler([this]() {
+        SenderLoadSample sample;
+        for (const auto &stream : GetCpuStats()) {
+            sample.cpu_us += stream.usage.TotalUs();
+        }
+        for (const auto &[session_id, session] : GetSessions()) {
+            sample.send_queue_bytes += session->GetSendQueueBytes();
+        }
+        return sample;
+    });
+}
+
+void RtspServer::SetAdmissionLimits(const AdmissionLimits &limits)
+{
+    if (limits.max_sender_utilization > 0.0) {
+        CpuAccount::SetEnabled(true);
+    }
+    admission_.SetLimits(limits);
 }
 
 bool RtspServer::Init(const std::string &ip, uint16_t port)
@@ -104,6 +126,8 @@ void RtspServer::HandleRequest(std::shared_ptr<RtspServerSession> session, const
 
     // Pre-process SETUP request - extract and set media stream info BEFORE processing
     const std::string &method = request.method_;
+    AdmissionDecision admission;
+    std::string setup_track;
     if (method == "SETUP") {
         // Extract stream path from URI (remove /track0, /track1, etc and rtsp:// prefix)
         std::string stream_path = request.uri_;
@@ -145,12 +169,14 @@ void RtspServer::HandleRequest(std::shared_ptr<RtspServerSession> session, const
 
         // Get media stream info
         auto stream_info = GetMediaStream(stream_path);
+        uint64_t setup_bps = stream_info ? stream_info->bitrate : 0;
         if (stream_info) {
             // Check if this is a multi-track stream and track index is specified
             if (track_index >= 0 && !stream_info->sub_tracks.empty()) {
                 if (track_index < static_cast<int>(stream_info->sub_tracks.size())) {
                     // Set the specific sub-track as media stream info
                     session->SetMediaStreamInfo(stream_info->sub_tracks[track_index]);
+                    setup_bps = stream_info->sub_tracks[track_index]->bitrate;
                     LMRTSP_LOGD("Set sub-track %d MediaStreamInfo - codec: %s", track_index,
                                 stream_info->sub_tracks[track_index]->codec.c_str());
                 } else {
@@ -166,27 +192,39 @@ void RtspServer::HandleRequest(std::shared_ptr<RtspServerSession> session, const
         } else {
             LMRTSP_LOGW("No MediaStreamInfo found for stream: %s", stream_path.c_str());
         }
+
+        // A repeated SETUP of the same track must not reserve its bitrate twice
+        setup_track = stream_path + "/track" + std::to_string(track_index < 0 ? 0 : track_index);
+        admission = admission_.AdmitSetup(session->GetSessionId(), setup_track, setup_bps);
+        if (!admission.admitted) {
+            SendAdmissionRejection(session->GetNetworkSession(), request, admission);
+            return;
+        }
+    } else if (method == "PLAY") {
+        auto decision = admission_.AdmitPlay(session->GetSessionId());
+        if (!decision.admitted) {
+            SendAdmissionRejection(session->GetNetworkSession(), request, decision);
+            return;
+        }
     }
 
     // Process request directly through session state machine
     RtspResponse response = session->ProcessRequest(request);
 
+    if (method == "SETUP" && response.status_ != StatusCode::OK && admission.reserved) {
+        admission_.CancelSetup(session->GetSessionId(), setup_track);
+    } else if (method == "TEARDOWN") {
+        admission_.Release(session->GetSessionId());
+    }
+
     // Notify callback about the request after processing
     if (method == "SETUP") {
-        std::string transport = "";
-        auto it = request.general_header_.find("Transport");
-        if (it != request.general_header_.end()) {
-            transport = it->second;
-        }
+        std::string transport(request.general_header_.Get(RtspHeaderId::TRANSPORT));
         LMRTSP_LOGD("invoke OnStreamRequested");
         NotifyListener(
             [&](IRtspServerListener *listener) { listener->OnSetupReceived(client_ip, transport, request.uri_); });
     } else if (method == "PLAY") {
-        std::string range = "";
-        auto it = request.general_header_.find("Range");
-        if (it != request.general_header_.end()) {
-            range = it->second;
-        }
+        std::string range(request.general_header_.Get(RtspHeaderId::RANGE));
         NotifyListener(
             [&](IRtspServerListener *listener) { listener->OnPlayReceived(client_ip, request.uri_, range); });
     } else if (method == "PAUSE") {
@@ -208,12 +246,7 @@ void RtspServer::HandleStatelessRequest(std::shared_ptr<lmnet::Session> lmnetSes
     LMRTSP_LOGD("Handling stateless %s request", request.method_.c_str());
 
     RtspResponse response;
-    int cseq = 0;
-
-    // Extract CSeq from request
-    if (request.general_header_.find(CSEQ) != request.general_header_.end()) {
-        cseq = std::stoi(request.general_header_.at(CSEQ));
-    }
+    int cseq = request.general_header_.GetInt(RtspHeaderId::CSEQ);
 
     if (request.method_ == METHOD_OPTIONS) {
         response = RtspResponseFactory::CreateOptionsOK(cseq).SetServer("RTSP Server/1.0").Build();
@@ -244,12 +277,7 @@ void RtspServer::HandleStatelessRequest(std::shared_ptr<lmnet::Session> lmnetSes
 void RtspServer::SendErrorResponse(std::shared_ptr<lmnet::Session> lmnetSession, const RtspRequest &request,
                                    int statusCode, const std::string &reasonPhrase)
 {
-    int cseq = 0;
-
-    // Extract CSeq from request
-    if (request.general_header_.find(CSEQ) != request.general_header_.end()) {
-        cseq = std::stoi(request.general_header_.at(CSEQ));
-    }
+    int cseq = request.general_header_.GetInt(RtspHeaderId::CSEQ);
 
     RtspResponse response;
     switch (statusCode) {
@@ -277,6 +305,22 @@ void RtspServer::SendErrorResponse(std::shared_ptr<lmnet::Session> lmnetSession,
     }
 }
 
+void RtspServer::SendAdmissionRejection(std::shared_ptr<lmnet::Session> lmnetSession, const RtspRequest &request,
+                                        const AdmissionDecision &decision)
+{
+    int cseq = request.general_header_.GetInt(RtspHeaderId::CSEQ);
+
+    auto response = RtspResponseFactory::CreateError(static_cast<StatusCode>(decision.status_code), cseq)
+                        .SetRetryAfter(std::to_string(decision.retry_after))
+                        .Build();
+
+    if (lmnetSession) {
+        LMRTSP_LOGD("Send admission rejection (%d %s): \n%s", decision.status_code, decision.reason.c_str(),
+                    response.ToString().c_str());
+        lmnetSession->Send(response.ToString());
+    }
+}
+
 std::shared_ptr<RtspServerSession> RtspServer::CreateSession(std::shared_ptr<lmnet::Session> lmnetSession)
 {
     auto session = std::make_shared<RtspServerSession>(lmnetSession, weak_from_this());
@@ -303,6 +347,13 @@ void RtspServer::RemoveSession(const std::string &sessionId)
 
     // Notify callback about session destruction (outside lock to avoid deadlock)
     if (session) {
+        admission_.Release(sessionId);
+        if (CpuAccount::IsEnabled()) {
+            std::lock_guard<std::mutex> lock(cpuStatsMutex_);
+            for (const auto &stream : session->GetCpuUsage()) {
+                retiredCpu_[{stream.stream, stream.codec}] += stream.usage;
+            }
+        }
         NotifyListener([&](IRtspServerListener *listener) { listener->OnSessionDestroyed(sessionId); });
     }
 }
@@ -323,6 +374,92 @@ std::unordered_map<std::string, std::shared_ptr<RtspServerSession>> RtspServer::
     return sessions_;
 }
 
+std::vector<StreamCpuUsage> RtspServer::GetCpuStats()
+{
+    std::map<std::pair<std::string, std::string>, CpuUsage> totals;
+    {
+        std::lock_guard<std::mutex> lock(cpuStatsMutex_);
+        totals = retiredCpu_;
+    }
+
+    for (const auto &[session_id, session] : GetSessions()) {
+        for (const auto &stream : session->GetCpuUsage()) {
+            totals[{stream.stream, stream.codec}] += stream.usage;
+        }
+    }
+
+    std::vector<StreamCpuUsage> result;
+    result.reserve(totals.size());
+    for (const auto &[key, usage] : totals) {
+        result.push_back({key.first, key.second, usage});
+    }
+    return result;
+}
+
+void RtspServer::SetCpuAffinity(const CpuAffinityConfig &config)
+{
+    {
+        std::lock_guard<std::mutex> lock(affinityMutex_);
+        affinity_ = config;
+    }
+    PacketizerWorkerPool::GetInstance().SetCpus(config.sender_cpus);
+    affinityGeneration_++;
+    LMRTSP_LOGI("CPU affinity: %zu reactor CPUs, %zu sender CPUs", config.reactor_cpus.size(),
+                config.sender_cpus.size());
+}
+
+CpuAffinityConfig RtspServer::GetCpuAffinity() const
+{
+    std::lock_guard<std::mutex> lock(affinityMutex_);
+    return affinity_;
+}
+
+void RtspServer::SetEgressLimits(const EgressLimits &limits)
+{
+    std::lock_guard<std::mutex> lock(egressMutex_);
+    egressLimits_ = limits;
+    LMRTSP_LOGI("Egress caps: session=%llu bps, client IP=%llu bps, burst=%u ms",
+                static_cast<unsigned long long>(limits.session_bps),
+                static_cast<unsigned long long>(limits.client_ip_bps), limits.burst_ms);
+}
+
+EgressLimits RtspServer::GetEgressLimits() const
+{
+    std::lock_guard<std::mutex> lock(egressMutex_);
+    return egressLimits_;
+}
+
+std::shared_ptr<TokenBucket> RtspServer::GetClientEgressBucket(const std::string &client_ip)
+{
+    std::lock_guard<std::mutex> lock(egressMutex_);
+    if (egressLimits_.client_ip_bps == 0) {
+        return nullptr;
+    }
+
+    auto bucket = clientEgressBuckets_[client_ip].lock();
+    if (!bucket) {
+        // Buckets of clients without sessions left are dropped as new clients come in
+        for (auto it = clientEgressBuckets_.begin(); it != clientEgressBuckets_.end();) {
+            it = it->second.expired() ? clientEgressBuckets_.erase(it) : std::next(it);
+        }
+        bucket = std::make_shared<TokenBucket>(egressLimits_.client_ip_bps, egressLimits_.burst_ms);
+        clientEgressBuckets_[client_ip] = bucket;
+    }
+    return bucket;
+}
+
+void RtspServer::PinReactorThread()
+{
+    // lmnet owns its reactor threads, each one is pinned from the first callback it runs after a configuration change
+    thread_local uint64_t pinnedGeneration = 0;
+    uint64_t generation = affinityGeneration_.load(std::memory_order_relaxed);
+    if (pinnedGeneration == generation) {
+        return;
+    }
+    pinnedGeneration = generation;
+    CpuAffinity::PinCurrentThread(GetCpuAffinity().reactor_cpus);
+}
+
 // Listener interface implementation
 void RtspServer::SetListener(std::shared_ptr<IRtspServerListener> listener)
 {
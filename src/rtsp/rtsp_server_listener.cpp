@@ -111,6 +111,7 @@ void RtspServerListener::OnAccept(std::shared_ptr<lmnet::Session> session)
     // Notify callback about client connection
     auto server = rtspServer_.lock();
     if (server) {
+        server->PinReactorThread();
         server->NotifyListener([&](IRtspServerListener *listener) {
             listener->OnClientConnected(session->host, ""); // User-Agent will be obtained from RTSP request
         });
@@ -121,6 +122,10 @@ void RtspServerListener::OnAccept(std::shared_ptr<lmnet::Session> session)
 
 void RtspServerListener::OnReceive(std::shared_ptr<lmnet::Session> session, std::shared_ptr<lmcore::DataBuffer> buffer)
 {
+    if (auto server = rtspServer_.lock()) {
+        server->PinReactorThread();
+    }
+
     // Get received data
     std::string data(reinterpret_cast<const char *>(buffer->Data()), buffer->Size());
     LMRTSP_LOGD("Received data from %s:%d, size: %zu", session->host.c_str(), session->port, data.size());
@@ -241,8 +246,8 @@ bool RtspServerListener::ParseRTSPRequest(const std::string &data, std::shared_p
 
             // Check if session ID already exists
             std::string sessionId;
-            if (request.general_header_.find(SESSION) != request.general_header_.end()) {
-                sessionId = request.general_header_.at(SESSION);
+            if (request.general_header_.count(RtspHeaderId::SESSION)) {
+                sessionId = request.general_header_.at(RtspHeaderId::SESSION);
                 RtspServerSession = server->GetSession(sessionId);
                 LMRTSP_LOGD("Found existing session ID: %s", sessionId.c_str());
             }
@@ -290,16 +295,41 @@ void RtspServerListener::HandleIncompleteData(std::shared_ptr<lmnet::Session> se
 
 void RtspServerListener::HandleInterleavedData(std::shared_ptr<lmnet::Session> session, const std::string &data)
 {
-    // TCP interleaved data format: $<channel><length><data>
-    // This data should be ignored as it's from VLC (client to server RTCP feedback)
-    // and not needed for our simple streaming implementation
+    // TCP interleaved data format: $<channel><length><data>, clients send RTCP receiver reports this way
+    auto server = rtspServer_.lock();
+    std::shared_ptr<RtspServerSession> rtspSession;
+    if (server) {
+        for (const auto &[sessionId, candidate] : server->GetSessions()) {
+            if (candidate && candidate->GetNetworkSession() == session) {
+                rtspSession = candidate;
+                break;
+            }
+        }
+    }
 
-    LMRTSP_LOGD("Received TCP interleaved data from %s:%d, size: %zu (ignored)", session->host.c_str(), session->port,
-                data.size());
+    size_t pos = 0;
+    while (pos + 4 <= data.size() && data[pos] == '$') {
+        uint8_t channel = static_cast<uint8_t>(data[pos + 1]);
+        size_t length = (static_cast<uint8_t>(data[pos + 2]) << 8) | static_cast<uint8_t>(data[pos + 3]);
+        if (pos + 4 + length > data.size()) {
+            // A report split across reads is dropped, the next one replaces it
+            LMRTSP_LOGD("Incomplete interleaved frame on channel %d, dropped", static_cast<int>(channel));
+            return;
+        }
 
-    // Note: In a complete implementation, we would parse this as RTCP feedback
-    // from the client and use it to adjust streaming parameters
-    // For our simple streaming server, we can safely ignore client RTCP packets
+        if (rtspSession) {
+            rtspSession->OnInterleavedData(channel, reinterpret_cast<const uint8_t *>(data.data()) + pos + 4, length);
+        }
+        pos += 4 + length;
+    }
+
+    // An RTSP request (e.g. a keep-alive) may follow in the same read
+    if (pos < data.size() && data[pos] != '$') {
+        std::string remainingData = data.substr(pos);
+        if (!ParseRTSPRequest(remainingData, session)) {
+            HandleIncompleteData(session, remainingData);
+        }
+    }
 }
 
 } // namespace lmshao::lmrtsp
\ No newline at end of file
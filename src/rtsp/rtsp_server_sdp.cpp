@@ -62,6 +62,9 @@ static std::string GenerateTrackSDP(const std::shared_ptr<MediaStreamInfo> &trac
             sdp += "a=framerate:" + std::to_string(track_info->frame_rate) + "\r\n";
         }
 
+        // Feedback from the client may come as single packets (RFC 5506)
+        sdp += "a=rtcp-rsize\r\n";
+
         // Media-level control attribute
         // For single-track streams (track_index < 0), omit media-level control
         // Client will use session-level "a=control:*"
@@ -131,6 +134,8 @@ static std::string GenerateTrackSDP(const std::shared_ptr<MediaStreamInfo> &trac
                 std::string(config_hex) + "\r\n";
         }
 
+        sdp += "a=rtcp-rsize\r\n";
+
         // Media-level control attribute
         // For single-track streams (track_index < 0), omit media-level control
         // Client will use session-level "a=control:*"
@@ -8,12 +8,17 @@
 
 #include "lmrtsp/rtsp_server_session.h"
 
-#include <lmcore/time_utils.h>
 #include <lmcore/uuid.h>
 
+#ifdef __linux__
+#include <linux/sockios.h>
+#include <sys/ioctl.h>
+#endif
+
 #include <string>
 
 #include "internal_logger.h"
+#include "lmrtsp/cpu_affinity.h"
 #include "lmrtsp/rtsp_media_stream_manager.h"
 #include "lmrtsp/rtsp_server.h"
 #include "rtsp_response.h"
@@ -21,6 +26,24 @@
 
 namespace lmshao::lmrtsp {
 
+namespace {
+// Unsent bytes in the socket above which interleaved packets are held back in the priority queue
+constexpr size_t INTERLEAVED_CONGESTION_BYTES = 256 * 1024;
+// Poll interval for draining held back interleaved packets
+constexpr uint32_t INTERLEAVED_DRAIN_INTERVAL_MS = 5;
+
+// Path of an RTSP URI, so CPU usage of a stream aggregates across the host names clients use
+std::string UriPath(const std::string &uri)
+{
+    size_t scheme = uri.find("://");
+    if (scheme == std::string::npos) {
+        return uri;
+    }
+    size_t path = uri.find('/', scheme + 3);
+    return path == std::string::npos ? "/" : uri.substr(path);
+}
+} // namespace
+
 RtspServerSession::RtspServerSession(std::shared_ptr<lmnet::Session> lmnetSession)
     : lmnetSession_(lmnetSession), timeout_(60),
       mediaStreamManager_(std::make_unique<lmshao::lmrtsp::RtspMediaStreamManager>(std::weak_ptr<RtspServerSession>()))
@@ -30,7 +53,7 @@ RtspServerSession::RtspServerSession(std::shared_ptr<lmnet::Session> lmnetSessio
     sessionId_ = GenerateSessionId();
 
     // Initialize last active time
-    lastActiveTime_ = lmcore::TimeUtils::GetCurrentTimeMs();
+    lastActiveTime_ = clock_->NowMs();
 
     // Initialize state machine to Initial state
     currentState_ = &ServerInitialState::GetInstance();
@@ -46,7 +69,7 @@ RtspServerSession::RtspServerSession(std::shared_ptr<lmnet::Session> lmnetSessio
     sessionId_ = GenerateSessionId();
 
     // Initialize last active time
-    lastActiveTime_ = lmcore::TimeUtils::GetCurrentTimeMs();
+    lastActiveTime_ = clock_->NowMs();
 
     // Initialize state machine to Initial state
     currentState_ = &ServerInitialState::GetInstance();
@@ -98,11 +121,7 @@ RtspResponse RtspServerSession::ProcessRequest(const RtspRequest &request)
         return currentState_->OnSetParameterRequest(this, request);
     } else {
         // Unknown method
-        int cseq = 0;
-        auto cseq_it = request.general_header_.find(CSEQ);
-        if (cseq_it != request.general_header_.end()) {
-            cseq = std::stoi(cseq_it->second);
-        }
+        int cseq = request.general_header_.GetInt(RtspHeaderId::CSEQ);
         return RtspResponseBuilder().SetStatus(StatusCode::NotImplemented).SetCSeq(cseq).Build();
     }
 }
@@ -190,6 +209,10 @@ bool RtspServerSession::SetupMedia(const std::string &uri, const std::string &tr
         transportConfig.type = lmshao::lmrtsp::TransportConfig::Type::UDP;
         transportConfig.client_ip = GetClientIP();
         transportConfig.mode = lmshao::lmrtsp::TransportConfig::Mode::SOURCE;
+        if (auto server = rtspServer_.lock()) {
+            transportConfig.backend = server->GetTransportBackend();
+            transportConfig.kernel_pacing = server->GetKernelPacing();
+        }
 
         // Parse client_port parameter
         size_t clientPortPos = transport.find("client_port=");
@@ -355,16 +378,30 @@ bool RtspServerSession::PauseMedia(const std::string &uri)
         return false;
     }
 
-    // Pause media stream manager
-    std::lock_guard<std::mutex> lock(mediaStreamManagerMutex_);
-    if (!mediaStreamManager_) {
-        LMRTSP_LOGE("Media stream manager not initialized");
-        return false;
+    // Multi-track: pause all track stream managers
+    bool is_multi_track = false;
+    {
+        std::lock_guard<std::mutex> lock(tracksMutex_);
+        is_multi_track = !tracks_.empty();
+        for (auto &[track_index, track_info] : tracks_) {
+            if (track_info.stream_manager && !track_info.stream_manager->Pause()) {
+                LMRTSP_LOGW("Failed to pause track %d", track_index);
+            }
+        }
     }
 
-    if (!mediaStreamManager_->Pause()) {
-        LMRTSP_LOGE("Failed to pause media stream");
-        return false;
+    // Single-track (legacy mode)
+    if (!is_multi_track) {
+        std::lock_guard<std::mutex> lock(mediaStreamManagerMutex_);
+        if (!mediaStreamManager_) {
+            LMRTSP_LOGE("Media stream manager not initialized");
+            return false;
+        }
+
+        if (!mediaStreamManager_->Pause()) {
+            LMRTSP_LOGE("Failed to pause media stream");
+            return false;
+        }
     }
 
     // Set paused state
@@ -497,12 +534,12 @@ std::string RtspServerSession::GetStateString(ServerSessionStateEnum state)
 
 void RtspServerSession::UpdateLastActiveTime()
 {
-    lastActiveTime_ = lmcore::TimeUtils::GetCurrentTimeMs();
+    lastActiveTime_ = clock_->NowMs();
 }
 
 bool RtspServerSession::IsExpired(uint32_t timeout_seconds) const
 {
-    int64_t current_time = lmcore::TimeUtils::GetCurrentTimeMs();
+    int64_t current_time = clock_->NowMs();
     return (current_time - lastActiveTime_) > static_cast<int64_t>(timeout_seconds) * 1000;
 }
 
@@ -598,7 +635,13 @@ bool RtspServerSession::PushFrame(const lmrtsp::MediaFrame &frame)
         return false;
     }
 
-    return mediaStreamManager_->PushFrame(frame);
+    bool sent = mediaStreamManager_->PushFrame(frame);
+    if (sent && frame.data) {
+        if (auto server = rtspServer_.lock()) {
+            server->GetAdmissionController().OnBytesSent(frame.data->Size());
+        }
+    }
+    return sent;
 }
 
 bool RtspServerSession::PushFrame(const lmrtsp::MediaFrame &frame, int track_index)
@@ -621,7 +664,13 @@ bool RtspServerSession::PushFrame(const lmrtsp::MediaFrame &frame, int track_ind
         return false;
     }
 
-    return it->second.stream_manager->PushFrame(frame);
+    bool sent = it->second.stream_manager->PushFrame(frame);
+    if (sent && frame.data) {
+        if (auto server = rtspServer_.lock()) {
+            server->GetAdmissionController().OnBytesSent(frame.data->Size());
+        }
+    }
+    return sent;
 }
 
 std::string RtspServerSession::GetRtpInfo() const
@@ -681,7 +730,8 @@ bool RtspServerSession::IsMultiTrack() const
     return !tracks_.empty();
 }
 
-bool RtspServerSession::SendInterleavedData(uint8_t channel, const uint8_t *data, size_t size)
+bool RtspServerSession::SendInterleavedData(uint8_t channel, const uint8_t *data, size_t size, SendPriority priority,
+                                            uint64_t frame)
 {
     if (!lmnetSession_) {
         LMRTSP_LOGE("Network session not available");
@@ -700,16 +750,359 @@ bool RtspServerSession::SendInterleavedData(uint8_t channel, const uint8_t *data
     // Append data
     interleavedFrame.insert(interleavedFrame.end(), data, data + size);
 
-    // Send via network session
-    bool ok = lmnetSession_->Send(interleavedFrame.data(), interleavedFrame.size());
-    if (!ok) {
-        LMRTSP_LOGE("SendInterleavedData failed: channel=%d, payload_size=%zu, frame_size=%zu",
-                    static_cast<int>(channel), size, interleavedFrame.size());
+    // An idle drain timer is destroyed after the lock is released, a tick of its task may be waiting for the lock
+    std::unique_ptr<Timer> idleTimer;
+    std::lock_guard<std::mutex> lock(interleavedMutex_);
+
+    // SIOCOUTQ costs a syscall, it is read once per frame and again after a failed write
+    if (frame == 0 || frame != congestionFrame_) {
+        congestionFrame_ = frame;
+        sendCongested_ = IsSendCongested();
+    }
+
+    // Nothing held back: straight to the socket, the queue only orders packets while it is congested
+    if (interleavedQueue_.Empty() && !sendCongested_) {
+        StopDrainTimer();
+        idleTimer = std::move(drainTimer_);
+        if (!lmnetSession_->Send(interleavedFrame.data(), interleavedFrame.size())) {
+            LMRTSP_LOGE("SendInterleavedData failed: channel=%d, frame_size=%zu", static_cast<int>(channel),
+                        interleavedFrame.size());
+            congestionFrame_ = 0;
+            return false;
+        }
+        return true;
+    }
+
+    size_t frameSize = interleavedFrame.size();
+    if (!interleavedQueue_.Push(priority, std::move(interleavedFrame), frameSize, frame)) {
+        LMRTSP_LOGW("Interleaved queue full, dropped packet: channel=%d, priority=%d, queued=%zu bytes",
+                    static_cast<int>(channel), static_cast<int>(priority), interleavedQueue_.Bytes());
+        return false;
+    }
+
+    // Still congested within this frame: the drain timer or the next frame sends the queue
+    if (sendCongested_) {
+        StartDrainTimer();
+        return true;
+    }
+
+    bool sent = DrainInterleavedQueue();
+    if (drainTaskId_ == 0) {
+        idleTimer = std::move(drainTimer_);
+    }
+    return sent;
+}
+
+SessionMemoryUsage RtspServerSession::GetMemoryUsage() const
+{
+    SessionMemoryUsage usage;
+    usage.session_bytes = sizeof(*this) + sessionId_.capacity() + sdpDescription_.capacity() +
+                          transportInfo_.capacity() + streamUri_.capacity();
+
+    {
+        std::lock_guard<std::mutex> lock(tracksMutex_);
+        for (const auto &[track_index, track_info] : tracks_) {
+            usage.session_bytes +=
+                sizeof(track_info) + track_info.uri.capacity() + track_info.transport_info.capacity();
+            if (track_info.stream_manager) {
+                usage.stream_bytes += track_info.stream_manager->GetMemoryUsage();
+                usage.rtp_sessions += track_info.stream_manager->HasRtpSession() ? 1 : 0;
+            }
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mediaStreamManagerMutex_);
+        if (mediaStreamManager_) {
+            usage.stream_bytes += mediaStreamManager_->GetMemoryUsage();
+            usage.rtp_sessions += mediaStreamManager_->HasRtpSession() ? 1 : 0;
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(interleavedMutex_);
+        usage.send_queue_bytes = interleavedQueue_.Bytes();
+    }
+
+    return usage;
+}
+
+std::shared_ptr<CpuAccount> RtspServerSession::GetCpuAccount(int track_index) const
+{
+    if (track_index >= 0) {
+        std::lock_guard<std::mutex> lock(tracksMutex_);
+        auto it = tracks_.find(track_index);
+        if (it != tracks_.end() && it->second.stream_manager) {
+            return it->second.stream_manager->GetCpuAccount();
+        }
+        return nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock(mediaStreamManagerMutex_);
+    return mediaStreamManager_ ? mediaStreamManager_->GetCpuAccount() : nullptr;
+}
+
+std::vector<StreamCpuUsage> RtspServerSession::GetCpuUsage() const
+{
+    std::vector<StreamCpuUsage> result;
+
+    // A stream counts once it has an RTP session. The account outlives PAUSE, so a paused stream that sent frames
+    // stays in. The single-track manager of a multi-track session never streams and is left out.
+    auto add = [&result](const std::string &uri, const RtspMediaStreamManager &manager) {
+        CpuUsage usage = manager.GetCpuAccount()->Snapshot();
+        if (manager.HasRtpSession() || usage.frames > 0) {
+            result.push_back({UriPath(uri), MediaTypeToCodec(manager.GetMediaType()), usage});
+        }
+    };
+
+    {
+        std::lock_guard<std::mutex> lock(tracksMutex_);
+        for (const auto &[track_index, track_info] : tracks_) {
+            if (track_info.stream_manager) {
+                add(track_info.uri, *track_info.stream_manager);
+            }
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mediaStreamManagerMutex_);
+        if (mediaStreamManager_) {
+            add(streamUri_, *mediaStreamManager_);
+        }
+    }
+
+    return result;
+}
+
+uint64_t RtspServerSession::GetInterleavedDropped(SendPriority priority) const
+{
+    std::lock_guard<std::mutex> lock(interleavedMutex_);
+    return interleavedQueue_.GetDropped(priority);
+}
+
+void RtspServerSession::OnInterleavedData(uint8_t channel, const uint8_t *data, size_t size)
+{
+    auto buffer = lmcore::DataBuffer::Create(size);
+    buffer->Assign(data, size);
+
+    {
+        std::lock_guard<std::mutex> lock(tracksMutex_);
+        for (auto &[track_index, track_info] : tracks_) {
+            if (track_info.stream_manager && track_info.stream_manager->OnInterleavedRtcp(channel, *buffer)) {
+                return;
+            }
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mediaStreamManagerMutex_);
+    if (!mediaStreamManager_ || !mediaStreamManager_->OnInterleavedRtcp(channel, *buffer)) {
+        LMRTSP_LOGD("Ignored interleaved data on channel %d, size: %zu", static_cast<int>(channel), size);
+    }
+}
+
+DeliveryStats RtspServerSession::GetDeliveryStats(int track_index) const
+{
+    RtcpReceiverFeedback feedback;
+    bool interleaved = false;
+    if (track_index >= 0) {
+        std::lock_guard<std::mutex> lock(tracksMutex_);
+        auto it = tracks_.find(track_index);
+        if (it != tracks_.end() && it->second.stream_manager) {
+            feedback = it->second.stream_manager->GetReceiverFeedback();
+            interleaved =
+                it->second.stream_manager->GetTransportConfig().type == TransportConfig::Type::TCP_INTERLEAVED;
+        }
     } else {
-        LMRTSP_LOGD("SendInterleavedData ok: channel=%d, payload_size=%zu, frame_size=%zu", static_cast<int>(channel),
-                    size, interleavedFrame.size());
+        std::lock_guard<std::mutex> lock(mediaStreamManagerMutex_);
+        if (mediaStreamManager_) {
+            feedback = mediaStreamManager_->GetReceiverFeedback();
+            interleaved = mediaStreamManager_->GetTransportConfig().type == TransportConfig::Type::TCP_INTERLEAVED;
+        }
+    }
+
+    DeliveryStats stats;
+    stats.has_receiver_report = feedback.valid;
+    stats.fraction_lost = feedback.fraction_lost;
+    stats.rtt_ms = feedback.rtt_ms;
+    stats.report_age_ms = feedback.valid ? clock_->NowMs() - feedback.report_time_ms : 0;
+
+    if (interleaved) {
+        stats.send_queue_bytes = GetSocketSendQueueBytes();
+        std::lock_guard<std::mutex> lock(interleavedMutex_);
+        stats.send_queue_bytes += interleavedQueue_.Bytes();
+    }
+    return stats;
+}
+
+bool RtspServerSession::HasKernelPacing(int track_index) const
+{
+    if (track_index >= 0) {
+        std::lock_guard<std::mutex> lock(tracksMutex_);
+        auto it = tracks_.find(track_index);
+        return it != tracks_.end() && it->second.stream_manager && it->second.stream_manager->HasKernelPacing();
+    }
+    std::lock_guard<std::mutex> lock(mediaStreamManagerMutex_);
+    return mediaStreamManager_ && mediaStreamManager_->HasKernelPacing();
+}
+
+size_t RtspServerSession::GetSendQueueBytes() const
+{
+    size_t bytes = GetSocketSendQueueBytes();
+    {
+        std::lock_guard<std::mutex> lock(tracksMutex_);
+        for (const auto &[track_index, track_info] : tracks_) {
+            if (track_info.stream_manager) {
+                bytes += track_info.stream_manager->GetSendQueueBytes();
+            }
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(mediaStreamManagerMutex_);
+        if (mediaStreamManager_) {
+            bytes += mediaStreamManager_->GetSendQueueBytes();
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(interleavedMutex_);
+    return bytes + interleavedQueue_.Bytes();
+}
+
+std::shared_ptr<EgressShaper> RtspServerSession::CreateEgressShaper()
+{
+    auto server = rtspServer_.lock();
+    if (!server) {
+        return nullptr;
+    }
+
+    EgressLimits limits = server->GetEgressLimits();
+    if (limits.session_bps == 0 && limits.client_ip_bps == 0) {
+        return nullptr;
+    }
+
+    std::shared_ptr<TokenBucket> session_bucket;
+    if (limits.session_bps > 0) {
+        std::lock_guard<std::mutex> lock(egressMutex_);
+        if (!egressBucket_) {
+            egressBucket_ = std::make_shared<TokenBucket>(limits.session_bps, limits.burst_ms);
+        }
+        session_bucket = egressBucket_;
+    }
+    return std::make_shared<EgressShaper>(session_bucket, server->GetClientEgressBucket(GetClientIP()));
+}
+
+EgressStats RtspServerSession::GetEgressStats(int track_index) const
+{
+    if (track_index >= 0) {
+        std::lock_guard<std::mutex> lock(tracksMutex_);
+        auto it = tracks_.find(track_index);
+        return it != tracks_.end() && it->second.stream_manager ? it->second.stream_manager->GetEgressStats()
+                                                                : EgressStats{};
+    }
+    std::lock_guard<std::mutex> lock(mediaStreamManagerMutex_);
+    return mediaStreamManager_ ? mediaStreamManager_->GetEgressStats() : EgressStats{};
+}
+
+int RtspServerSession::GetHomeCpu()
+{
+    int cpu = homeCpu_.load();
+    if (cpu != -2) {
+        return cpu;
+    }
+
+    std::vector<int> senderCpus;
+    if (auto server = rtspServer_.lock()) {
+        senderCpus = server->GetCpuAffinity().sender_cpus;
+    }
+
+    // Follow the CPU that processes this client's RTSP connection, RSS keeps the client's flows there
+    cpu = CpuAffinity::SelectHomeCpu(senderCpus, lmnetSession_ ? CpuAffinity::GetIncomingCpu(lmnetSession_->fd) : -1);
+    int unset = -2;
+    if (!homeCpu_.compare_exchange_strong(unset, cpu)) {
+        return unset;
+    }
+    if (cpu >= 0) {
+        LMRTSP_LOGI("Session %s served from CPU %d (NUMA node %d)", sessionId_.c_str(), cpu,
+                    CpuAffinity::GetNumaNode(cpu));
+    }
+    return cpu;
+}
+
+size_t RtspServerSession::GetSocketSendQueueBytes() const
+{
+#ifdef __linux__
+    int pending = 0;
+    if (lmnetSession_ && ioctl(lmnetSession_->fd, SIOCOUTQ, &pending) == 0 && pending > 0) {
+        return static_cast<size_t>(pending);
+    }
+#endif
+    return 0;
+}
+
+bool RtspServerSession::IsSendCongested() const
+{
+    return GetSocketSendQueueBytes() >= INTERLEAVED_CONGESTION_BYTES;
+}
+
+bool RtspServerSession::DrainInterleavedQueue()
+{
+    std::vector<uint8_t> interleavedFrame;
+    while (!interleavedQueue_.Empty()) {
+        sendCongested_ = IsSendCongested();
+        if (sendCongested_ || !interleavedQueue_.Pop(interleavedFrame)) {
+            break;
+        }
+
+        // Send via network session
+        if (!lmnetSession_->Send(interleavedFrame.data(), interleavedFrame.size())) {
+            LMRTSP_LOGE("SendInterleavedData failed: channel=%d, frame_size=%zu", static_cast<int>(interleavedFrame[1]),
+                        interleavedFrame.size());
+            congestionFrame_ = 0;
+            StartDrainTimer();
+            return false;
+        }
+        LMRTSP_LOGD("SendInterleavedData ok: channel=%d, frame_size=%zu", static_cast<int>(interleavedFrame[1]),
+                    interleavedFrame.size());
+    }
+
+    if (!interleavedQueue_.Empty()) {
+        LMRTSP_LOGD("Interleaved socket congested, %zu packets (%zu bytes) queued", interleavedQueue_.Count(),
+                    interleavedQueue_.Bytes());
+        StartDrainTimer();
+    } else {
+        StopDrainTimer();
+    }
+    return true;
+}
+
+void RtspServerSession::StartDrainTimer()
+{
+    if (drainTaskId_ != 0) {
+        return;
+    }
+
+    // Held back packets must not wait for the next media packet, a stalled stream or a paused session sends none
+    if (!drainTimer_) {
+        drainTimer_ = clock_->CreateTimer();
+    }
+    drainTaskId_ = drainTimer_->ScheduleRepeating(
+        [this]() {
+            std::lock_guard<std::mutex> lock(interleavedMutex_);
+            if (lmnetSession_ && !interleavedQueue_.Empty()) {
+                DrainInterleavedQueue();
+            } else {
+                StopDrainTimer();
+            }
+        },
+        INTERLEAVED_DRAIN_INTERVAL_MS);
+}
+
+void RtspServerSession::StopDrainTimer()
+{
+    // Only the task is cancelled here, this may run on the timer's own thread; the next send destroys the timer
+    if (drainTaskId_ != 0) {
+        drainTimer_->Cancel(drainTaskId_);
+        drainTaskId_ = 0;
     }
-    return ok;
 }
 
-} // namespace lmshao::lmrtsp
\ No newline at end of file
+} // namespace lmshao::lmrtsp
@@ -20,7 +20,7 @@ namespace {
 RtspResponse HandleOptions(RtspServerSession *session, const RtspRequest &request)
 {
     LMRTSP_LOGD("Processing OPTIONS request");
-    int cseq = std::stoi(request.general_header_.at(CSEQ));
+    int cseq = request.general_header_.GetInt(RtspHeaderId::CSEQ);
     auto response = RtspResponseBuilder()
                         .SetStatus(StatusCode::OK)
                         .SetCSeq(cseq)
@@ -32,7 +32,7 @@ RtspResponse HandleOptions(RtspServerSession *session, const RtspRequest &reques
 RtspResponse HandleDescribe(RtspServerSession *session, const RtspRequest &request)
 {
     LMRTSP_LOGD("Processing DESCRIBE request");
-    int cseq = std::stoi(request.general_header_.at(CSEQ));
+    int cseq = request.general_header_.GetInt(RtspHeaderId::CSEQ);
     RtspResponseBuilder builder;
 
     // Get server reference from session
@@ -67,7 +67,7 @@ RtspResponse HandleDescribe(RtspServerSession *session, const RtspRequest &reque
 RtspResponse HandleGetParameter(RtspServerSession *session, const RtspRequest &request)
 {
     LMRTSP_LOGD("Processing GET_PARAMETER request");
-    int cseq = std::stoi(request.general_header_.at(CSEQ));
+    int cseq = request.general_header_.GetInt(RtspHeaderId::CSEQ);
     auto response = RtspResponseBuilder().SetStatus(StatusCode::OK).SetCSeq(cseq).Build();
     return response;
 }
@@ -75,7 +75,7 @@ RtspResponse HandleGetParameter(RtspServerSession *session, const RtspRequest &r
 RtspResponse HandleSetParameter(RtspServerSession *session, const RtspRequest &request)
 {
     LMRTSP_LOGD("Processing SET_PARAMETER request");
-    int cseq = std::stoi(request.general_header_.at(CSEQ));
+    int cseq = request.general_header_.GetInt(RtspHeaderId::CSEQ);
     auto response = RtspResponseBuilder().SetStatus(StatusCode::OK).SetCSeq(cseq).Build();
     return response;
 }
@@ -83,7 +83,7 @@ RtspResponse HandleSetParameter(RtspServerSession *session, const RtspRequest &r
 RtspResponse HandleAnnounce(RtspServerSession *session, const RtspRequest &request)
 {
     LMRTSP_LOGD("Processing ANNOUNCE request");
-    int cseq = std::stoi(request.general_header_.at(CSEQ));
+    int cseq = request.general_header_.GetInt(RtspHeaderId::CSEQ);
     auto response = RtspResponseBuilder().SetStatus(StatusCode::NotImplemented).SetCSeq(cseq).Build();
     return response;
 }
@@ -91,7 +91,7 @@ RtspResponse HandleAnnounce(RtspServerSession *session, const RtspRequest &reque
 RtspResponse HandleRecord(RtspServerSession *session, const RtspRequest &request)
 {
     LMRTSP_LOGD("Processing RECORD request");
-    int cseq = std::stoi(request.general_header_.at(CSEQ));
+    int cseq = request.general_header_.GetInt(RtspHeaderId::CSEQ);
     auto response = RtspResponseBuilder().SetStatus(StatusCode::NotImplemented).SetCSeq(cseq).Build();
     return response;
 }
@@ -132,9 +132,9 @@ RtspResponse ServerInitialState::OnSetParameterRequest(RtspServerSession *sessio
 RtspResponse ServerInitialState::OnSetupRequest(RtspServerSession *session, const RtspRequest &request)
 {
     LMRTSP_LOGD("Processing SETUP request in InitialState");
-    int cseq = std::stoi(request.general_header_.at(CSEQ));
+    int cseq = request.general_header_.GetInt(RtspHeaderId::CSEQ);
 
-    if (session->SetupMedia(request.uri_, request.general_header_.at("Transport"))) {
+    if (session->SetupMedia(request.uri_, std::string(request.general_header_.Get(RtspHeaderId::TRANSPORT)))) {
         session->ChangeState(&ServerReadyState::GetInstance());
         auto response = RtspResponseBuilder()
                             .SetStatus(StatusCode::OK)
@@ -151,21 +151,21 @@ RtspResponse ServerInitialState::OnSetupRequest(RtspServerSession *session, cons
 
 RtspResponse ServerInitialState::OnPlayRequest(RtspServerSession *session, const RtspRequest &request)
 {
-    int cseq = std::stoi(request.general_header_.at(CSEQ));
+    int cseq = request.general_header_.GetInt(RtspHeaderId::CSEQ);
     auto response = RtspResponseBuilder().SetStatus(StatusCode::MethodNotValidInThisState).SetCSeq(cseq).Build();
     return response;
 }
 
 RtspResponse ServerInitialState::OnPauseRequest(RtspServerSession *session, const RtspRequest &request)
 {
-    int cseq = std::stoi(request.general_header_.at(CSEQ));
+    int cseq = request.general_header_.GetInt(RtspHeaderId::CSEQ);
     auto response = RtspResponseBuilder().SetStatus(StatusCode::MethodNotValidInThisState).SetCSeq(cseq).Build();
     return response;
 }
 
 RtspResponse ServerInitialState::OnTeardownRequest(RtspServerSession *session, const RtspRequest &request)
 {
-    int cseq = std::stoi(request.general_header_.at(CSEQ));
+    int cseq = request.general_header_.GetInt(RtspHeaderId::CSEQ);
     auto response = RtspResponseBuilder().SetStatus(StatusCode::OK).SetCSeq(cseq).Build();
     return response;
 }
@@ -205,10 +205,10 @@ RtspResponse ServerReadyState::OnSetupRequest(RtspServerSession *session, const
 {
     // Allow multiple SETUP requests for multi-track streams (e.g., MKV with video+audio)
     LMRTSP_LOGD("Processing additional SETUP request in ReadyState (multi-track support)");
-    int cseq = std::stoi(request.general_header_.at(CSEQ));
+    int cseq = request.general_header_.GetInt(RtspHeaderId::CSEQ);
 
     // Process the SETUP request (for additional tracks)
-    if (session->SetupMedia(request.uri_, request.general_header_.at("Transport"))) {
+    if (session->SetupMedia(request.uri_, std::string(request.general_header_.Get(RtspHeaderId::TRANSPORT)))) {
         // Stay in ReadyState (already setup)
         auto response = RtspResponseBuilder()
                             .SetStatus(StatusCode::OK)
@@ -226,7 +226,7 @@ RtspResponse ServerReadyState::OnSetupRequest(RtspServerSession *session, const
 RtspResponse ServerReadyState::OnPlayRequest(RtspServerSession *session, const RtspRequest &request)
 {
     LMRTSP_LOGD("Processing PLAY request in ReadyState");
-    int cseq = std::stoi(request.general_header_.at(CSEQ));
+    int cseq = request.general_header_.GetInt(RtspHeaderId::CSEQ);
 
     std::string range = "";
     if (request.requestHeader_.range_) {
@@ -251,7 +251,7 @@ RtspResponse ServerReadyState::OnPlayRequest(RtspServerSession *session, const R
 
 RtspResponse ServerReadyState::OnPauseRequest(RtspServerSession *session, const RtspRequest &request)
 {
-    int cseq = std::stoi(request.general_header_.at(CSEQ));
+    int cseq = request.general_header_.GetInt(RtspHeaderId::CSEQ);
     auto response = RtspResponseBuilder().SetStatus(StatusCode::MethodNotValidInThisState).SetCSeq(cseq).Build();
     return response;
 }
@@ -259,7 +259,7 @@ RtspResponse ServerReadyState::OnPauseRequest(RtspServerSession *session, const
 RtspResponse ServerReadyState::OnTeardownRequest(RtspServerSession *session, const RtspRequest &request)
 {
     LMRTSP_LOGD("Processing TEARDOWN request in ReadyState");
-    int cseq = std::stoi(request.general_header_.at(CSEQ));
+    int cseq = request.general_header_.GetInt(RtspHeaderId::CSEQ);
 
     session->TeardownMedia(request.uri_);
     session->ChangeState(&ServerInitialState::GetInstance());
@@ -301,14 +301,14 @@ RtspResponse ServerPlayingState::OnSetParameterRequest(RtspServerSession *sessio
 
 RtspResponse ServerPlayingState::OnSetupRequest(RtspServerSession *session, const RtspRequest &request)
 {
-    int cseq = std::stoi(request.general_header_.at(CSEQ));
+    int cseq = request.general_header_.GetInt(RtspHeaderId::CSEQ);
     auto response = RtspResponseBuilder().SetStatus(StatusCode::MethodNotValidInThisState).SetCSeq(cseq).Build();
     return response;
 }
 
 RtspResponse ServerPlayingState::OnPlayRequest(RtspServerSession *session, const RtspRequest &request)
 {
-    int cseq = std::stoi(request.general_header_.at(CSEQ));
+    int cseq = request.general_header_.GetInt(RtspHeaderId::CSEQ);
     auto response = RtspResponseBuilder().SetStatus(StatusCode::OK).SetCSeq(cseq).Build();
     return response;
 }
@@ -316,7 +316,7 @@ RtspResponse ServerPlayingState::OnPlayRequest(RtspServerSession *session, const
 RtspResponse ServerPlayingState::OnPauseRequest(RtspServerSession *session, const RtspRequest &request)
 {
     LMRTSP_LOGD("Processing PAUSE request in PlayingState");
-    int cseq = std::stoi(request.general_header_.at(CSEQ));
+    int cseq = request.general_header_.GetInt(RtspHeaderId::CSEQ);
 
     if (session->PauseMedia(request.uri_)) {
         session->ChangeState(&ServerPausedState::GetInstance());
@@ -331,7 +331,7 @@ RtspResponse ServerPlayingState::OnPauseRequest(RtspServerSession *session, cons
 RtspResponse ServerPlayingState::OnTeardownRequest(RtspServerSession *session, const RtspRequest &request)
 {
     LMRTSP_LOGD("Processing TEARDOWN request in PlayingState");
-    int cseq = std::stoi(request.general_header_.at(CSEQ));
+    int cseq = request.general_header_.GetInt(RtspHeaderId::CSEQ);
 
     session->TeardownMedia(request.uri_);
     session->ChangeState(&ServerInitialState::GetInstance());
@@ -373,7 +373,7 @@ RtspResponse ServerPausedState::OnSetParameterRequest(RtspServerSession *session
 
 RtspResponse ServerPausedState::OnSetupRequest(RtspServerSession *session, const RtspRequest &request)
 {
-    int cseq = std::stoi(request.general_header_.at(CSEQ));
+    int cseq = request.general_header_.GetInt(RtspHeaderId::CSEQ);
     auto response = RtspResponseBuilder().SetStatus(StatusCode::MethodNotValidInThisState).SetCSeq(cseq).Build();
     return response;
 }
@@ -381,7 +381,7 @@ RtspResponse ServerPausedState::OnSetupRequest(RtspServerSession *session, const
 RtspResponse ServerPausedState::OnPlayRequest(RtspServerSession *session, const RtspRequest &request)
 {
     LMRTSP_LOGD("Processing PLAY request in PausedState");
-    int cseq = std::stoi(request.general_header_.at(CSEQ));
+    int cseq = request.general_header_.GetInt(RtspHeaderId::CSEQ);
 
     std::string range = "";
     if (request.requestHeader_.range_) {
@@ -406,7 +406,7 @@ RtspResponse ServerPausedState::OnPlayRequest(RtspServerSession *session, const
 
 RtspResponse ServerPausedState::OnPauseRequest(RtspServerSession *session, const RtspRequest &request)
 {
-    int cseq = std::stoi(request.general_header_.at(CSEQ));
+    int cseq = request.general_header_.GetInt(RtspHeaderId::CSEQ);
     auto response = RtspResponseBuilder().SetStatus(StatusCode::OK).SetCSeq(cseq).Build();
     return response;
 }
@@ -414,7 +414,7 @@ RtspResponse ServerPausedState::OnPauseRequest(RtspServerSession *session, const
 RtspResponse ServerPausedState::OnTeardownRequest(RtspServerSession *session, const RtspRequest &request)
 {
     LMRTSP_LOGD("Processing TEARDOWN request in PausedState");
-    int cseq = std::stoi(request.general_header_.at(CSEQ));
+    int cseq = request.general_header_.GetInt(RtspHeaderId::CSEQ);
 
     session->TeardownMedia(request.uri_);
     session->ChangeState(&ServerInitialState::GetInstance());
@@ -0,0 +1,87 @@
+/**
+ * @author SHAO Liming <lmshao@163.com>
+ * @copyright Copyright (c) 2025 SHAO Liming
+ * @license MIT
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef LMSHAO_LMRTSP_TEST_BIT_WRITER_H
+#define LMSHAO_LMRTSP_TEST_BIT_WRITER_H
+
+#include <lmcore/data_buffer.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace test_support {
+
+/**
+ * @brief Builds H.264/H.265 NAL units bit by bit for parser tests
+ */
+class BitWriter {
+public:
+    void Bits(uint32_t value, uint32_t count)
+    {
+        for (uint32_t i = count; i-- > 0;) {
+            Bit((value >> i) & 1);
+        }
+    }
+
+    void UE(uint32_t value)
+    {
+        uint32_t code = value + 1;
+        uint32_t length = 0;
+        while ((code >> length) > 1) {
+            length++;
+        }
+        Bits(0, length);
+        Bits(code, length + 1);
+    }
+
+    void SE(int32_t value) { UE(value > 0 ? 2 * value - 1 : -2 * value); }
+
+    // rbsp_trailing_bits, then the NAL unit with emulation prevention bytes inserted
+    std::shared_ptr<lmshao::lmcore::DataBuffer> Finish()
+    {
+        Bit(1);
+        while (bit_count_ % 8 != 0) {
+            Bit(0);
+        }
+
+        std::vector<uint8_t> nalu;
+        size_t zeros = 0;
+        for (uint8_t byte : bytes_) {
+            if (zeros >= 2 && byte <= 3) {
+                nalu.push_back(0x03);
+                zeros = 0;
+            }
+            nalu.push_back(byte);
+            zeros = (byte == 0) ? zeros + 1 : 0;
+        }
+        auto buffer = lmshao::lmcore::DataBuffer::Create(nalu.size());
+        buffer->Assign(nalu.data(), nalu.size());
+        return buffer;
+    }
+
+private:
+    void Bit(uint32_t bit)
+    {
+        if (bit_count_ % 8 == 0) {
+            bytes_.push_back(0);
+        }
+        if (bit) {
+            bytes_.back() |= 0x80 >> (bit_count_ % 8);
+        }
+        bit_count_++;
+    }
+
+    std::vector<uint8_t> bytes_;
+    size_t bit_count_ = 0;
+};
+
+} // namespace test_support
+
+#endif // LMSHAO_LMRTSP_TEST_BIT_WRITER_H
@@ -0,0 +1,218 @@
+/**
+ * @author SHAO Liming <lmshao@163.com>
+ * @copyright Copyright (c) 2025 SHAO Liming
+ * @license MIT
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+#include "lmrtsp/admission_controller.h"
+#include "lmrtsp/clock.h"
+#include "test_framework.h"
+
+using namespace test_framework;
+using namespace lmshao::lmrtsp;
+
+void test_admission_session_limit()
+{
+    auto clock = std::make_shared<SimulatedClock>();
+    Clock::Set(clock);
+
+    AdmissionController controller;
+    AdmissionLimits limits;
+    limits.max_sessions = 2;
+    limits.retry_after_seconds = 7;
+    controller.SetLimits(limits);
+
+    ASSERT_TRUE(controller.AdmitSetup("a", "/live/track0", 0).admitted);
+    ASSERT_TRUE(controller.AdmitSetup("b", "/live/track0", 0).admitted);
+
+    // More tracks of an admitted session do not count as a new session
+    ASSERT_TRUE(controller.AdmitSetup("a", "/live/track1", 0).admitted);
+
+    AdmissionDecision decision = controller.AdmitSetup("c", "/live/track0", 0);
+    ASSERT_FALSE(decision.admitted);
+    ASSERT_FALSE(decision.reserved);
+    ASSERT_EQ(503, decision.status_code);
+    ASSERT_EQ(7u, decision.retry_after);
+    ASSERT_EQ(1u, controller.GetStats().rejected_overload);
+
+    // TEARDOWN frees the slot
+    controller.Release("a");
+    ASSERT_EQ(1u, controller.GetStats().admitted_sessions);
+    ASSERT_TRUE(controller.AdmitSetup("c", "/live/track0", 0).admitted);
+
+    Clock::Set(nullptr);
+}
+
+void test_admission_egress_budget()
+{
+    auto clock = std::make_shared<SimulatedClock>();
+    Clock::Set(clock);
+
+    AdmissionController controller;
+    AdmissionLimits limits;
+    limits.max_egress_bps = 5000000;
+    controller.SetLimits(limits);
+
+    ASSERT_TRUE(controller.AdmitSetup("a", "/live/track0", 2000000).admitted);
+    ASSERT_TRUE(controller.AdmitSetup("b", "/live/track0", 2000000).admitted);
+    ASSERT_EQ(4000000u, controller.GetStats().reserved_bps);
+
+    AdmissionDecision decision = controller.AdmitSetup("c", "/live/track0", 2000000);
+    ASSERT_FALSE(decision.admitted);
+    ASSERT_EQ(453, decision.status_code);
+    ASSERT_EQ(1u, controller.GetStats().rejected_bandwidth);
+
+    // A stream that still fits is admitted
+    ASSERT_TRUE(controller.AdmitSetup("c", "/live/track0", 1000000).admitted);
+    ASSERT_EQ(5000000u, controller.GetStats().reserved_bps);
+
+    controller.Release("a");
+    controller.Release("b");
+    controller.Release("c");
+    ASSERT_EQ(0u, controller.GetStats().reserved_bps);
+    ASSERT_EQ(0u, controller.GetStats().admitted_sessions);
+
+    Clock::Set(nullptr);
+}
+
+void test_admission_repeated_setup()
+{
+    auto clock = std::make_shared<SimulatedClock>();
+    Clock::Set(clock);
+
+    AdmissionController controller;
+    AdmissionLimits limits;
+    limits.max_egress_bps = 5000000;
+    controller.SetLimits(limits);
+
+    AdmissionDecision first = controller.AdmitSetup("a", "/live/track0", 2000000);
+    ASSERT_TRUE(first.admitted);
+    ASSERT_TRUE(first.reserved);
+
+    // A client re-SETUPs the same track, e.g. to switch transport: no second reservation
+    for (int i = 0; i < 5; ++i) {
+        AdmissionDecision again = controller.AdmitSetup("a", "/live/track0", 2000000);
+        ASSERT_TRUE(again.admitted);
+        ASSERT_FALSE(again.reserved);
+    }
+    ASSERT_EQ(2000000u, controller.GetStats().reserved_bps);
+    ASSERT_EQ(1u, controller.GetStats().admitted_sessions);
+
+    // Cancelling a failed SETUP of another track leaves the first one reserved
+    ASSERT_TRUE(controller.AdmitSetup("a", "/live/track1", 1000000).reserved);
+    ASSERT_EQ(3000000u, controller.GetStats().reserved_bps);
+    controller.CancelSetup("a", "/live/track1");
+    ASSERT_EQ(2000000u, controller.GetStats().reserved_bps);
+    ASSERT_EQ(1u, controller.GetStats().admitted_sessions);
+
+    // Cancelling the last track drops the session
+    controller.CancelSetup("a", "/live/track0");
+    ASSERT_EQ(0u, controller.GetStats().reserved_bps);
+    ASSERT_EQ(0u, controller.GetStats().admitted_sessions);
+
+    // Unknown sessions and tracks are ignored
+    controller.CancelSetup("a", "/live/track0");
+    controller.Release("missing");
+    ASSERT_EQ(0u, controller.GetStats().reserved_bps);
+
+    Clock::Set(nullptr);
+}
+
+void test_admission_egress_rate()
+{
+    auto clock = std::make_shared<SimulatedClock>();
+    Clock::Set(clock);
+
+    AdmissionController controller;
+    controller.GetStats(); // First sample sets the baseline
+
+    controller.OnBytesSent(125000);
+    clock->Advance(1000000);
+
+    // 1 Mbps over the window, smoothed with the previous estimate of 0
+    AdmissionStats stats = controller.GetStats();
+    ASSERT_EQ(500000u, stats.measured_bps);
+
+    Clock::Set(nullptr);
+}
+
+void test_admission_sender_load()
+{
+    auto clock = std::make_shared<SimulatedClock>();
+    Clock::Set(clock);
+
+    AdmissionController controller;
+    AdmissionLimits limits;
+    limits.max_sender_utilization = 0.5;
+    limits.max_send_queue_bytes = 1000000;
+    controller.SetLimits(limits);
+
+    uint64_t cores = std::max(1u, std::thread::hardware_concurrency());
+    SenderLoadSample load;
+    int samples = 0;
+    controller.SetLoadSampler([&]() {
+        samples++;
+        return load;
+    });
+
+    ASSERT_TRUE(controller.AdmitSetup("a", "/live/track0", 0).admitted);
+    ASSERT_EQ(1, samples);
+
+    // Samples are rate limited
+    ASSERT_TRUE(controller.AdmitPlay("a").admitted);
+    ASSERT_EQ(1, samples);
+
+    // Senders busy on 3/4 of all cores over the next second
+    clock->Advance(1000000);
+    load.cpu_us += cores * 750000;
+    AdmissionDecision decision = controller.AdmitPlay("a");
+    ASSERT_EQ(2, samples);
+    ASSERT_FALSE(decision.admitted);
+    ASSERT_EQ(503, decision.status_code);
+    ASSERT_FALSE(controller.AdmitSetup("b", "/live/track0", 0).admitted);
+
+    // Load drops to 1/4
+    clock->Advance(1000000);
+    load.cpu_us += cores * 250000;
+    ASSERT_TRUE(controller.AdmitSetup("b", "/live/track0", 0).admitted);
+
+    // Socket send buffers back up
+    clock->Advance(1000000);
+    load.send_queue_bytes = 2000000;
+    ASSERT_FALSE(controller.AdmitPlay("b").admitted);
+    AdmissionStats stats = controller.GetStats();
+    ASSERT_EQ(2000000u, stats.send_queue_bytes);
+    ASSERT_EQ(3u, stats.rejected_overload);
+
+    // No load limit set: the sampler is not called at all
+    limits.max_sender_utilization = 0.0;
+    limits.max_send_queue_bytes = 0;
+    controller.SetLimits(limits);
+    clock->Advance(1000000);
+    int before = samples;
+    ASSERT_TRUE(controller.AdmitPlay("b").admitted);
+    ASSERT_EQ(before, samples);
+
+    Clock::Set(nullptr);
+}
+
+int main()
+{
+    TestSuite suite("Admission Controller Tests");
+
+    suite.AddTest("Session Limit", test_admission_session_limit);
+    suite.AddTest("Egress Budget", test_admission_egress_budget);
+    suite.AddTest("Repeated SETUP", test_admission_repeated_setup);
+    suite.AddTest("Egress Rate", test_admission_egress_rate);
+    suite.AddTest("Sender Load", test_admission_sender_load);
+
+    bool success = suite.RunAll();
+    return success ? 0 : 1;
+}
@@ -0,0 +1,469 @@
+/**
+ * @author SHAO Liming <lmshao@163.com>
+ * @copyright Copyright (c) 2025 SHAO Liming
+ * @license MIT
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+// Heap allocation budgets for the steady-state paths.
+//
+// Every heap allocation of the process is counted, per thread and in total, by replacing operator new and, on glibc,
+// malloc. Each test warms a path up, then measures a fixed number of iterations and fails if the allocations per
+// frame / per packet / per request exceed the budget below. When an allocation is removed from a path, lower its
+// budget in the same change so it cannot silently come back.
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <thread>
+
+#include "lmrtsp/lmrtsp_logger.h"
+#include "lmrtsp/media_types.h"
+#include "lmrtsp/rtp_sink_session.h"
+#include "lmrtsp/rtp_source_session.h"
+#include "lmrtsp/rtsp_request.h"
+#include "lmrtsp/rtsp_response.h"
+#include "test_framework.h"
+
+using namespace test_framework;
+using namespace lmshao::lmrtsp;
+
+namespace {
+
+// RtpSourceSession::SendFrame over UDP, H.264, measured at 0: the packetizer recycles its RtpPacket and payload
+constexpr double SEND_ALLOCS_PER_FRAME = 1; // Slack for the transport's send path
+constexpr double SEND_ALLOCS_PER_PACKET = 0;
+
+// RtpSinkSession receive over UDP, H.264, measured at 3 per frame and 6 per packet
+constexpr double RECV_ALLOCS_PER_FRAME = 4;  // Reassembled DataBuffer and its storage, MediaFrame, slack
+constexpr double RECV_ALLOCS_PER_PACKET = 6; // Socket read buffer, RtpPacket, payload DataBuffer and its storage
+
+// RTSP keep-alive: parse a GET_PARAMETER request and build its response
+constexpr double KEEPALIVE_ALLOCS_PER_REQUEST = 10; // Measured: 3 to parse, 7 to build and serialize the response
+
+constexpr int WARMUP_ITERATIONS = 50;
+constexpr int MEASURED_ITERATIONS = 500;
+
+std::atomic<uint64_t> g_totalAllocs{0};
+thread_local uint64_t t_threadAllocs = 0;
+
+inline void CountAlloc()
+{
+    t_threadAllocs++;
+    g_totalAllocs.fetch_add(1, std::memory_order_relaxed);
+}
+
+} // namespace
+
+// Allocation interposer. On glibc malloc itself is replaced and operator new counts and then goes straight to the libc
+// allocator, so each allocation is counted exactly once whichever entry point it came through.
+#if defined(__GLIBC__)
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+void *__libc_memalign(size_t alignment, size_t size);
+void __libc_free(void *ptr);
+
+void *malloc(size_t size)
+{
+    CountAlloc();
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size)
+{
+    CountAlloc();
+    return __libc_calloc(count, size);
+}
+
+void *realloc(void *ptr, size_t size)
+{
+    CountAlloc();
+    return __libc_realloc(ptr, size);
+}
+
+void free(void *ptr)
+{
+    __libc_free(ptr);
+}
+}
+
+static void *RawAlloc(size_t size)
+{
+    CountAlloc();
+    return __libc_malloc(size == 0 ? 1 : size);
+}
+
+static void *RawAlignedAlloc(size_t size, size_t alignment)
+{
+    CountAlloc();
+    return __libc_memalign(alignment, size == 0 ? 1 : size);
+}
+
+static void RawFree(void *ptr)
+{
+    __libc_free(ptr);
+}
+#else
+static void *RawAlloc(size_t size)
+{
+    CountAlloc();
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+static void *RawAlignedAlloc(size_t size, size_t alignment)
+{
+    CountAlloc();
+    void *ptr = nullptr;
+    return posix_memalign(&ptr, alignment < sizeof(void *) ? sizeof(void *) : alignment, size == 0 ? 1 : size) == 0
+               ? ptr
+               : nullptr;
+}
+
+static void RawFree(void *ptr)
+{
+    std::free(ptr);
+}
+#endif
+
+void *operator new(size_t size)
+{
+    void *ptr = RawAlloc(size);
+    if (!ptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void *operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void *operator new(size_t size, const std::nothrow_t &) noexcept
+{
+    return RawAlloc(size);
+}
+
+void *operator new[](size_t size, const std::nothrow_t &) noexcept
+{
+    return RawAlloc(size);
+}
+
+void *operator new(size_t size, std::align_val_t alignment)
+{
+    void *ptr = RawAlignedAlloc(size, static_cast<size_t>(alignment));
+    if (!ptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void *operator new[](size_t size, std::align_val_t alignment)
+{
+    return operator new(size, alignment);
+}
+
+void operator delete(void *ptr) noexcept
+{
+    RawFree(ptr);
+}
+
+void operator delete[](void *ptr) noexcept
+{
+    RawFree(ptr);
+}
+
+void operator delete(void *ptr, size_t) noexcept
+{
+    RawFree(ptr);
+}
+
+void operator delete[](void *ptr, size_t) noexcept
+{
+    RawFree(ptr);
+}
+
+void operator delete(void *ptr, std::align_val_t) noexcept
+{
+    RawFree(ptr);
+}
+
+void operator delete[](void *ptr, std::align_val_t) noexcept
+{
+    RawFree(ptr);
+}
+
+void operator delete(void *ptr, size_t, std::align_val_t) noexcept
+{
+    RawFree(ptr);
+}
+
+void operator delete[](void *ptr, size_t, std::align_val_t) noexcept
+{
+    RawFree(ptr);
+}
+
+namespace {
+
+void CheckBudget(const char *path, uint64_t allocs, int frames, int packets, double per_frame, double per_packet)
+{
+    double budget = frames * per_frame + packets * per_packet;
+    std::cout << "[" << path << ": " << allocs << " allocs, " << frames << " frames, " << packets << " packets, "
+              << static_cast<double>(allocs) / frames << " per frame, budget " << budget << "] ";
+    if (static_cast<double>(allocs) > budget) {
+        throw std::runtime_error(std::string(path) + " exceeds its allocation budget: " + std::to_string(allocs) +
+                                 " > " + std::to_string(budget));
+    }
+}
+
+// Bind a UDP socket on a free loopback port, used to learn a port number and to receive or drain packets
+int OpenLoopbackSocket(uint16_t &port)
+{
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0) {
+        return -1;
+    }
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    socklen_t len = sizeof(addr);
+    if (bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0 ||
+        getsockname(fd, reinterpret_cast<sockaddr *>(&addr), &len) != 0) {
+        close(fd);
+        return -1;
+    }
+
+    port = ntohs(addr.sin_port);
+    return fd;
+}
+
+int DrainSocket(int fd)
+{
+    uint8_t buffer[2048];
+    int count = 0;
+    while (recv(fd, buffer, sizeof(buffer), MSG_DONTWAIT) > 0) {
+        count++;
+    }
+    return count;
+}
+
+void test_send_frame_allocations()
+{
+    // The client side is a plain socket that only counts the packets, so no ICMP errors are generated
+    uint16_t client_port = 0;
+    int client_fd = OpenLoopbackSocket(client_port);
+    ASSERT_TRUE(client_fd >= 0);
+
+    RtpSourceSessionConfig config;
+    config.session_id = "alloc-send";
+    config.video_type = MediaType::H264;
+    config.transport.type = TransportConfig::Type::UDP;
+    config.transport.mode = TransportConfig::Mode::SOURCE;
+    config.transport.client_ip = "127.0.0.1";
+    config.transport.client_rtp_port = client_port;
+
+    RtpSourceSession session;
+    ASSERT_TRUE(session.Initialize(config));
+    ASSERT_TRUE(session.Start());
+
+    // One IDR slice, fragmented into several FU-A packets
+    const size_t nal_size = 10000;
+    auto frame = std::make_shared<MediaFrame>();
+    frame->media_type = MediaType::H264;
+    frame->data = lmshao::lmcore::DataBuffer::Create(nal_size + 4);
+    std::string nal(nal_size, '\x5a');
+    nal[0] = '\x65';
+    frame->data->Assign("\x00\x00\x00\x01", 4);
+    frame->data->Append(nal.data(), nal.size());
+
+    for (int i = 0; i < WARMUP_ITERATIONS; ++i) {
+        frame->timestamp += 3000;
+        session.SendFrame(frame);
+        DrainSocket(client_fd);
+    }
+
+    int packets = 0;
+    uint64_t before = t_threadAllocs;
+    for (int i = 0; i < MEASURED_ITERATIONS; ++i) {
+        frame->timestamp += 3000;
+        ASSERT_TRUE(session.SendFrame(frame));
+        packets += DrainSocket(client_fd);
+    }
+    uint64_t allocs = t_threadAllocs - before;
+
+    session.Stop();
+    close(client_fd);
+
+    ASSERT_TRUE(packets >= MEASURED_ITERATIONS);
+    CheckBudget("SendFrame", allocs, MEASURED_ITERATIONS, packets, SEND_ALLOCS_PER_FRAME, SEND_ALLOCS_PER_PACKET);
+}
+
+class CountingSinkListener : public RtpSinkSessionListener {
+public:
+    void OnFrame(const std::shared_ptr<MediaFrame> &) override { frames.fetch_add(1, std::memory_order_release); }
+    void OnError(int, const std::string &) override {}
+
+    std::atomic<int> frames{0};
+};
+
+// Send one H.264 frame as FU-A packets straight from a socket, without allocating
+int SendFragmentedFrame(int fd, const sockaddr_in &dest, uint16_t &seq, uint32_t timestamp, int fragments)
+{
+    uint8_t packet[12 + 2 + 1000];
+    std::memset(packet + 14, 0x5a, 1000);
+
+    for (int i = 0; i < fragments; ++i) {
+        bool last = (i == fragments - 1);
+        packet[0] = 0x80;
+        packet[1] = static_cast<uint8_t>((last ? 0x80 : 0x00) | 96);
+        packet[2] = static_cast<uint8_t>(seq >> 8);
+        packet[3] = static_cast<uint8_t>(seq & 0xff);
+        packet[4] = static_cast<uint8_t>(timestamp >> 24);
+        packet[5] = static_cast<uint8_t>(timestamp >> 16);
+        packet[6] = static_cast<uint8_t>(timestamp >> 8);
+        packet[7] = static_cast<uint8_t>(timestamp);
+        packet[8] = 0x12;
+        packet[9] = 0x34;
+        packet[10] = 0x56;
+        packet[11] = 0x78;
+        packet[12] = 0x7c; // FU indicator, NRI 3, type 28
+        packet[13] = static_cast<uint8_t>((i == 0 ? 0x80 : 0x00) | (last ? 0x40 : 0x00) | 0x05);
+        seq++;
+
+        if (sendto(fd, packet, sizeof(packet), 0, reinterpret_cast<const sockaddr *>(&dest), sizeof(dest)) < 0) {
+            return i;
+        }
+    }
+    return fragments;
+}
+
+bool WaitForFrames(const CountingSinkListener &listener, int frames)
+{
+    for (int i = 0; i < 2000; ++i) {
+        if (listener.frames.load(std::memory_order_acquire) >= frames) {
+            return true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return false;
+}
+
+void test_sink_receive_allocations()
+{
+    uint16_t sink_port = 0;
+    int probe_fd = OpenLoopbackSocket(sink_port);
+    ASSERT_TRUE(probe_fd >= 0);
+    close(probe_fd);
+
+    RtpSinkSessionConfig config;
+    config.session_id = "alloc-recv";
+    config.video_type = MediaType::H264;
+    config.transport.type = TransportConfig::Type::UDP;
+    config.transport.mode = TransportConfig::Mode::SINK;
+    config.transport.client_rtp_port = sink_port;
+
+    auto listener = std::make_shared<CountingSinkListener>();
+    RtpSinkSession session;
+    ASSERT_TRUE(session.Initialize(config));
+    session.SetListener(listener);
+    ASSERT_TRUE(session.Start());
+
+    int sender_fd = socket(AF_INET, SOCK_DGRAM, 0);
+    ASSERT_TRUE(sender_fd >= 0);
+    sockaddr_in dest{};
+    dest.sin_family = AF_INET;
+    dest.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    dest.sin_port = htons(sink_port);
+
+    const int fragments = 4;
+    uint16_t seq = 1;
+    uint32_t timestamp = 0;
+
+    // Frames are sent one at a time and waited for, so no packet is lost to a full socket buffer. The marker bit
+    // completes each frame, so every warm-up frame is delivered before counting starts.
+    for (int i = 1; i <= WARMUP_ITERATIONS; ++i) {
+        timestamp += 3000;
+        SendFragmentedFrame(sender_fd, dest, seq, timestamp, fragments);
+        WaitForFrames(*listener, i);
+    }
+    ASSERT_TRUE(WaitForFrames(*listener, WARMUP_ITERATIONS));
+
+    // Receive runs on the network threads, so count every thread and take this one out
+    int start_frames = listener->frames.load(std::memory_order_acquire);
+    int packets = 0;
+    uint64_t total_before = g_totalAllocs.load(std::memory_order_relaxed);
+    uint64_t thread_before = t_threadAllocs;
+    for (int i = 1; i <= MEASURED_ITERATIONS; ++i) {
+        timestamp += 3000;
+        packets += SendFragmentedFrame(sender_fd, dest, seq, timestamp, fragments);
+        WaitForFrames(*listener, start_frames + i);
+    }
+    uint64_t allocs = (g_totalAllocs.load(std::memory_order_relaxed) - total_before) - (t_threadAllocs - thread_before);
+    int frames = listener->frames.load(std::memory_order_acquire) - start_frames;
+
+    close(sender_fd);
+    session.Stop();
+
+    ASSERT_EQ(MEASURED_ITERATIONS, frames);
+    CheckBudget("RtpSinkSession receive", allocs, frames, packets, RECV_ALLOCS_PER_FRAME, RECV_ALLOCS_PER_PACKET);
+}
+
+void test_keepalive_allocations()
+{
+    const std::string request_text = "GET_PARAMETER rtsp://127.0.0.1:8554/live RTSP/1.0\r\n"
+                                     "CSeq: 42\r\n"
+                                     "Session: 4F2A1C9B7D3E5A60\r\n"
+                                     "User-Agent: LibVLC/3.0.20 (LIVE555 Streaming Media v2016.11.28)\r\n"
+                                     "\r\n";
+
+    size_t bytes = 0;
+    auto handle = [&request_text, &bytes]() {
+        RtspRequest request = RtspRequest::FromString(request_text);
+        std::string response =
+            RtspResponseFactory::CreateOK(42).SetServer("lmrtsp").SetSession("4F2A1C9B7D3E5A60").Build().ToString();
+        bytes += request.method_.size() + response.size();
+    };
+
+    for (int i = 0; i < WARMUP_ITERATIONS; ++i) {
+        handle();
+    }
+
+    uint64_t before = t_threadAllocs;
+    for (int i = 0; i < MEASURED_ITERATIONS; ++i) {
+        handle();
+    }
+    uint64_t allocs = t_threadAllocs - before;
+
+    ASSERT_TRUE(bytes > 0);
+    CheckBudget("Keep-alive", allocs, MEASURED_ITERATIONS, 0, KEEPALIVE_ALLOCS_PER_REQUEST, 0);
+}
+
+} // namespace
+
+int main()
+{
+    InitLmrtspLogger(lmshao::lmcore::LogLevel::kError);
+
+    TestSuite suite("Allocation Budget Tests");
+
+    suite.AddTest("RtpSourceSession SendFrame", test_send_frame_allocations);
+    suite.AddTest("RtpSinkSession Receive", test_sink_receive_allocations);
+    suite.AddTest("RTSP Keep-Alive", test_keepalive_allocations);
+
+    bool success = suite.RunAll();
+    return success ? 0 : 1;
+}
@@ -0,0 +1,117 @@
+/**
+ * @author SHAO Liming <lmshao@163.com>
+ * @copyright Copyright (c) 2025 SHAO Liming
+ * @license MIT
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "lmrtsp/clock.h"
+#include "test_framework.h"
+
+using namespace test_framework;
+using namespace lmshao::lmrtsp;
+
+void test_simulated_clock_time()
+{
+    auto clock = std::make_shared<SimulatedClock>(1000);
+
+    ASSERT_EQ(0, clock->MonotonicUs());
+    ASSERT_EQ(1000, clock->NowMs());
+
+    clock->Advance(2500);
+    ASSERT_EQ(2500, clock->MonotonicUs());
+    ASSERT_EQ(1002, clock->NowMs());
+
+    // Auto advance lets a paced loop run without waiting
+    for (int i = 0; i < 1000; ++i) {
+        clock->SleepUs(1000);
+    }
+    ASSERT_EQ(1002500, clock->MonotonicUs());
+}
+
+void test_simulated_clock_timers()
+{
+    auto clock = std::make_shared<SimulatedClock>();
+    auto timer = clock->CreateTimer();
+
+    std::vector<int64_t> fired;
+    auto id = timer->ScheduleRepeating([&]() { fired.push_back(clock->MonotonicUs()); }, 5000);
+    ASSERT_TRUE(id != 0);
+
+    clock->Advance(4999000);
+    ASSERT_EQ(0u, fired.size());
+
+    // Tasks run at their due time, not at the end of the advance
+    clock->Advance(5001000);
+    ASSERT_EQ(2u, fired.size());
+    ASSERT_EQ(5000000, fired[0]);
+    ASSERT_EQ(10000000, fired[1]);
+
+    timer->Cancel(id);
+    clock->Advance(60000000);
+    ASSERT_EQ(2u, fired.size());
+
+    // Destroying a timer drops its tasks
+    timer->ScheduleRepeating([&]() { fired.push_back(clock->MonotonicUs()); }, 1000);
+    timer.reset();
+    clock->Advance(60000000);
+    ASSERT_EQ(2u, fired.size());
+}
+
+void test_simulated_clock_manual_advance()
+{
+    auto clock = std::make_shared<SimulatedClock>();
+    clock->SetAutoAdvance(false);
+
+    std::atomic<int64_t> woke_at{-1};
+    std::thread sleeper([&]() {
+        int64_t start = clock->MonotonicUs();
+        clock->SleepUs(3000);
+        woke_at = clock->MonotonicUs() - start;
+    });
+
+    while (woke_at < 0) {
+        clock->Advance(1000);
+        std::this_thread::yield();
+    }
+    sleeper.join();
+
+    ASSERT_TRUE(woke_at >= 3000);
+}
+
+void test_fast_monotonic_clock()
+{
+    int64_t previous = FastMonotonicNs();
+    for (int i = 0; i < 100000; ++i) {
+        int64_t now = FastMonotonicNs();
+        ASSERT_TRUE(now >= previous);
+        previous = now;
+    }
+
+    int64_t start = FastMonotonicNs();
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    int64_t elapsed = FastMonotonicNs() - start;
+    ASSERT_TRUE(elapsed >= 20000000);
+    ASSERT_TRUE(elapsed < 2000000000);
+}
+
+int main()
+{
+    TestSuite suite("Clock Tests");
+
+    suite.AddTest("Simulated Clock Time", test_simulated_clock_time);
+    suite.AddTest("Simulated Clock Timers", test_simulated_clock_timers);
+    suite.AddTest("Simulated Clock Manual Advance", test_simulated_clock_manual_advance);
+    suite.AddTest("Fast Monotonic Clock", test_fast_monotonic_clock);
+
+    bool success = suite.RunAll();
+    return success ? 0 : 1;
+}
@@ -0,0 +1,213 @@
+/**
+ * @author SHAO Liming <lmshao@163.com>
+ * @copyright Copyright (c) 2025 SHAO Liming
+ * @license MIT
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+#include "lmrtsp/clock.h"
+#include "lmrtsp/cpu_accounting.h"
+#include "rtp/packetizer_worker_pool.h"
+#include "test_framework.h"
+
+using namespace test_framework;
+using namespace lmshao::lmrtsp;
+
+namespace {
+// Spins until the calling thread has used the given CPU time, returns what it actually used
+uint64_t BurnCpu(uint64_t ns)
+{
+    uint64_t start = CpuAccount::ThreadCpuTimeNs();
+    volatile uint64_t sink = 0;
+    while (CpuAccount::ThreadCpuTimeNs() - start < ns) {
+        for (int i = 0; i < 1000; ++i) {
+            sink = sink + i;
+        }
+    }
+    return CpuAccount::ThreadCpuTimeNs() - start;
+}
+
+const size_t PACKETIZE = static_cast<size_t>(CpuStage::PACKETIZE);
+const size_t SEND = static_cast<size_t>(CpuStage::SEND);
+} // namespace
+
+void test_usage_rates()
+{
+    CpuUsage usage;
+    usage.stage_us[PACKETIZE] = 3000;
+    usage.stage_us[SEND] = 1000;
+    usage.bytes = 2 * 1048576;
+    usage.active_ms = 2000;
+    ASSERT_EQ(4000u, usage.TotalUs());
+    ASSERT_TRUE(usage.UsPerSecond() == 2000.0);
+    ASSERT_TRUE(usage.UsPerMB() == 2000.0);
+
+    CpuUsage total;
+    total += usage;
+    total += usage;
+    ASSERT_EQ(8000u, total.TotalUs());
+    ASSERT_EQ(4u * 1048576, total.bytes);
+    ASSERT_EQ(4000u, total.active_ms);
+
+    // Nothing sent yet
+    ASSERT_TRUE(CpuUsage().UsPerSecond() == 0.0);
+    ASSERT_TRUE(CpuUsage().UsPerMB() == 0.0);
+}
+
+void test_scope_charges_stage()
+{
+    CpuAccount account;
+
+    // Disabled: no clock reads, nothing charged
+    CpuAccount::SetEnabled(false);
+    {
+        CpuScope scope(&account, CpuStage::PACKETIZE);
+        ASSERT_TRUE(CpuScope::CurrentAccount() == nullptr);
+        BurnCpu(2000000);
+    }
+    ASSERT_EQ(0u, account.Snapshot().TotalUs());
+
+    CpuAccount::SetEnabled(true);
+    uint64_t used = 0;
+    uint64_t innerUsed = 0;
+    {
+        CpuScope scope(&account, CpuStage::PACKETIZE);
+        ASSERT_TRUE(CpuScope::CurrentAccount() == &account);
+        used = BurnCpu(5000000);
+
+        // Nested scopes charge the inner stage and restore the outer one
+        {
+            CpuScope inner(&account, CpuStage::SEND);
+            ASSERT_TRUE(CpuScope::CurrentStage() == CpuStage::SEND);
+            innerUsed = BurnCpu(1000000);
+        }
+        ASSERT_TRUE(CpuScope::CurrentStage() == CpuStage::PACKETIZE);
+    }
+    ASSERT_TRUE(CpuScope::CurrentAccount() == nullptr);
+    CpuAccount::SetEnabled(false);
+
+    CpuUsage usage = account.Snapshot();
+    ASSERT_TRUE(usage.stage_us[PACKETIZE] >= used / 1000);
+    ASSERT_TRUE(usage.stage_us[SEND] >= 1000);
+
+    // The outer stage is not charged for the nested one a second time
+    ASSERT_TRUE(usage.stage_us[PACKETIZE] < (used + innerUsed) / 1000);
+    ASSERT_EQ(0u, usage.stage_us[static_cast<size_t>(CpuStage::READ)]);
+
+    account.AddSent(1500);
+    account.AddSent(500);
+    ASSERT_EQ(2000u, account.Snapshot().bytes);
+    ASSERT_EQ(2u, account.Snapshot().frames);
+}
+
+void test_active_time()
+{
+    auto clock = std::make_shared<SimulatedClock>();
+    Clock::Set(clock);
+    CpuAccount account;
+
+    // Streaming time is the sum of the gaps between charges, gaps over a second are pauses
+    account.AddCpu(CpuStage::PACKETIZE, 1000);
+    clock->Advance(40000);
+    account.AddCpu(CpuStage::PACKETIZE, 1000);
+    clock->Advance(960000);
+    account.AddCpu(CpuStage::SEND, 1000);
+    ASSERT_EQ(1000u, account.Snapshot().active_ms);
+
+    clock->Advance(5000000);
+    account.AddCpu(CpuStage::PACKETIZE, 1000);
+    clock->Advance(250000);
+    account.AddCpu(CpuStage::PACKETIZE, 1000);
+    ASSERT_EQ(1250u, account.Snapshot().active_ms);
+
+    Clock::Set(nullptr);
+}
+
+void test_worker_pool_charges_submitter()
+{
+    auto &pool = PacketizerWorkerPool::GetInstance();
+    ASSERT_TRUE(pool.GetThreadCount() >= 2);
+
+    CpuAccount submitter;
+    std::atomic<uint64_t> workNs{0};
+
+    CpuAccount::SetEnabled(true);
+    {
+        CpuScope scope(&submitter, CpuStage::PACKETIZE);
+        pool.ParallelFor(6, 1, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                workNs += BurnCpu(3000000);
+            }
+        });
+    }
+
+    uint64_t charged = submitter.Snapshot().TotalUs();
+
+    // Work submitted outside any scope is charged to nobody
+    pool.ParallelFor(6, 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            BurnCpu(1000000);
+        }
+    });
+    CpuAccount::SetEnabled(false);
+
+    // All chunks count, including those the worker threads ran, against the submitter's stage
+    ASSERT_TRUE(submitter.Snapshot().stage_us[PACKETIZE] >= workNs / 1000);
+    ASSERT_EQ(0u, submitter.Snapshot().stage_us[SEND]);
+    ASSERT_EQ(charged, submitter.Snapshot().TotalUs());
+}
+
+void test_helped_jobs_charge_owner()
+{
+    auto &pool = PacketizerWorkerPool::GetInstance();
+
+    // Two submitters at once, each helps with whatever chunks are queued, including the other's
+    CpuAccount heavy;
+    CpuAccount light;
+    std::atomic<uint64_t> heavyNs{0};
+    std::atomic<uint64_t> lightNs{0};
+    auto submit = [&pool](CpuAccount *account, std::atomic<uint64_t> *workNs, uint64_t chunkNs) {
+        for (int round = 0; round < 20; ++round) {
+            CpuScope scope(account, CpuStage::PACKETIZE);
+            pool.ParallelFor(16, 1, [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++i) {
+                    *workNs += BurnCpu(chunkNs);
+                }
+            });
+        }
+    };
+
+    CpuAccount::SetEnabled(true);
+    std::thread heavyThread(submit, &heavy, &heavyNs, 500000);
+    std::thread lightThread(submit, &light, &lightNs, 20000);
+    heavyThread.join();
+    lightThread.join();
+    CpuAccount::SetEnabled(false);
+
+    // Every chunk is charged to the account that submitted it, whichever thread ran it
+    ASSERT_TRUE(heavy.Snapshot().TotalUs() >= heavyNs / 1000);
+    ASSERT_TRUE(light.Snapshot().TotalUs() >= lightNs / 1000);
+    ASSERT_TRUE(light.Snapshot().TotalUs() < heavyNs / 1000 / 4);
+}
+
+int main()
+{
+    // Worker threads even on a single-CPU machine, set before the pool starts
+    PacketizerWorkerPool::GetInstance().SetCpus({0, 0, 0});
+
+    TestSuite suite("CPU Accounting Tests");
+
+    suite.AddTest("Usage Rates", test_usage_rates);
+    suite.AddTest("Scope Charges Stage", test_scope_charges_stage);
+    suite.AddTest("Active Time", test_active_time);
+    suite.AddTest("Worker Pool Charges Submitter", test_worker_pool_charges_submitter);
+    suite.AddTest("Helped Jobs Charge Owner", test_helped_jobs_charge_owner);
+
+    bool success = suite.RunAll();
+    return success ? 0 : 1;
+}
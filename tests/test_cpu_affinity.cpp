@@ -0,0 +1,71 @@
+/**
+ * @author SHAO Liming <lmshao@163.com>
+ * @copyright Copyright (c) 2025 SHAO Liming
+ * @license MIT
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <string>
+#include <vector>
+
+#include "lmrtsp/cpu_affinity.h"
+#include "test_framework.h"
+
+using namespace test_framework;
+using namespace lmshao::lmrtsp;
+
+void test_parse_cpu_ranges()
+{
+    std::vector<int> cpus;
+    ASSERT_TRUE(CpuAffinity::ParseCpuList("0-3", cpus));
+    ASSERT_TRUE(cpus == std::vector<int>({0, 1, 2, 3}));
+
+    ASSERT_TRUE(CpuAffinity::ParseCpuList("0-1,4-5", cpus));
+    ASSERT_TRUE(cpus == std::vector<int>({0, 1, 4, 5}));
+
+    // A single CPU is a range of one
+    ASSERT_TRUE(CpuAffinity::ParseCpuList("7-7", cpus));
+    ASSERT_TRUE(cpus == std::vector<int>({7}));
+}
+
+void test_parse_cpu_lists()
+{
+    std::vector<int> cpus;
+    ASSERT_TRUE(CpuAffinity::ParseCpuList("2", cpus));
+    ASSERT_TRUE(cpus == std::vector<int>({2}));
+
+    // Sorted and deduplicated, empty entries are skipped
+    ASSERT_TRUE(CpuAffinity::ParseCpuList("6,2,,3-4,2", cpus));
+    ASSERT_TRUE(cpus == std::vector<int>({2, 3, 4, 6}));
+
+    ASSERT_TRUE(CpuAffinity::ParseCpuList("16-17,1", cpus));
+    ASSERT_TRUE(cpus == std::vector<int>({1, 16, 17}));
+}
+
+void test_parse_cpu_malformed()
+{
+    std::vector<int> cpus = {1};
+    ASSERT_FALSE(CpuAffinity::ParseCpuList("", cpus));
+    ASSERT_TRUE(cpus.empty());
+    ASSERT_FALSE(CpuAffinity::ParseCpuList(",", cpus));
+
+    const char *malformed[] = {"a", "1x", "x1", "3-1", "-1", "1-", "-", "1-2-3", "1,b", "+1", " 1", "0-99999"};
+    for (const char *list : malformed) {
+        cpus = {1};
+        ASSERT_FALSE(CpuAffinity::ParseCpuList(list, cpus));
+        ASSERT_TRUE(cpus.empty());
+    }
+}
+
+int main()
+{
+    TestSuite suite("CPU Affinity Tests");
+
+    suite.AddTest("Parse CPU Ranges", test_parse_cpu_ranges);
+    suite.AddTest("Parse CPU Lists", test_parse_cpu_lists);
+    suite.AddTest("Parse CPU Malformed", test_parse_cpu_malformed);
+
+    bool success = suite.RunAll();
+    return success ? 0 : 1;
+}
@@ -0,0 +1,196 @@
+/**
+ * @author SHAO Liming <lmshao@163.com>
+ * @copyright Copyright (c) 2025 SHAO Liming
+ * @license MIT
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "lmrtsp/clock.h"
+#include "lmrtsp/egress_shaper.h"
+#include "lmrtsp/media_types.h"
+#include "test_framework.h"
+
+using namespace test_framework;
+using namespace lmshao::lmrtsp;
+
+namespace {
+
+MediaFrame MakeVideoFrame(FrameType type, bool reference)
+{
+    MediaFrame frame;
+    frame.media_type = MediaType::H264;
+    frame.video_param.frame_type = type;
+    frame.video_param.is_key_frame = type == FrameType::IDR;
+    frame.video_param.is_reference = reference;
+    return frame;
+}
+
+struct TsPacket {
+    uint16_t pid;
+    bool unit_start;
+};
+
+// One TS packet per entry, unit starts carry a PES start code except on the PAT PID
+MediaFrame MakeTsFrame(const std::vector<TsPacket> &packets)
+{
+    std::vector<uint8_t> bytes;
+    for (const auto &packet : packets) {
+        std::vector<uint8_t> ts(188, 0xFF);
+        ts[0] = 0x47;
+        ts[1] = static_cast<uint8_t>((packet.unit_start ? 0x40 : 0x00) | (packet.pid >> 8));
+        ts[2] = static_cast<uint8_t>(packet.pid & 0xFF);
+        ts[3] = 0x10;
+        if (packet.unit_start && packet.pid != 0) {
+            ts[4] = 0x00;
+            ts[5] = 0x00;
+            ts[6] = 0x01;
+        } else if (packet.unit_start) {
+            ts[4] = 0x00;
+            ts[5] = 0x00;
+            ts[6] = 0xB0;
+        }
+        bytes.insert(bytes.end(), ts.begin(), ts.end());
+    }
+
+    MediaFrame frame;
+    frame.media_type = MediaType::MP2T;
+    frame.data = lmshao::lmcore::DataBuffer::Create(bytes.size());
+    frame.data->Assign(bytes.data(), bytes.size());
+    return frame;
+}
+
+} // namespace
+
+void test_token_bucket()
+{
+    // 8 Mbps is 1000 bytes per ms, 100 ms deep
+    TokenBucket bucket(8000000, 100);
+    ASSERT_EQ(100000, bucket.GetBurstBytes());
+    ASSERT_TRUE(bucket.Fits(100000, 0));
+    ASSERT_FALSE(bucket.Fits(100001, 0));
+
+    // Debt is repaid by refills, and refills stop at the burst depth
+    bucket.Consume(150000, 0);
+    ASSERT_FALSE(bucket.Fits(1, 0));
+    ASSERT_TRUE(bucket.Fits(1, 0, 50001));
+    ASSERT_TRUE(bucket.Fits(10000, 60000000));
+    ASSERT_FALSE(bucket.Fits(10001, 60000000));
+    ASSERT_TRUE(bucket.Fits(100000, 10000000000));
+    ASSERT_FALSE(bucket.Fits(100001, 10000000000));
+}
+
+void test_shaper_drop_policy()
+{
+    auto clock = std::make_shared<SimulatedClock>();
+    Clock::Set(clock);
+
+    // 8 Mbps with a 10 ms burst: 10000 bytes deep
+    auto bucket = std::make_shared<TokenBucket>(8000000, 10);
+    EgressShaper shaper(bucket, nullptr);
+
+    // The key frame goes out regardless and leaves 5000 bytes of debt
+    ASSERT_TRUE(shaper.Admit(MakeVideoFrame(FrameType::IDR, true), 15000));
+
+    // A B frame needs a positive balance, a P frame may borrow one burst
+    ASSERT_FALSE(shaper.Admit(MakeVideoFrame(FrameType::B, false), 100));
+    ASSERT_TRUE(shaper.Admit(MakeVideoFrame(FrameType::P, true), 4000));
+
+    // A P frame beyond the burst is dropped, and so is the rest of its GOP however much the caps recover
+    ASSERT_FALSE(shaper.Admit(MakeVideoFrame(FrameType::P, true), 2000));
+    clock->Advance(100000);
+    ASSERT_FALSE(shaper.Admit(MakeVideoFrame(FrameType::P, true), 100));
+    ASSERT_FALSE(shaper.Admit(MakeVideoFrame(FrameType::B, false), 100));
+
+    // Audio is charged but never dropped
+    MediaFrame audio;
+    audio.media_type = MediaType::AAC;
+    ASSERT_TRUE(shaper.Admit(audio, 400));
+
+    // The next key frame resumes the stream
+    ASSERT_TRUE(shaper.Admit(MakeVideoFrame(FrameType::IDR, true), 8000));
+    ASSERT_TRUE(shaper.Admit(MakeVideoFrame(FrameType::B, false), 1000));
+
+    EgressStats stats = shaper.GetStats();
+    ASSERT_EQ(5u, stats.sent_frames);
+    ASSERT_EQ(28400u, stats.sent_bytes);
+    ASSERT_EQ(4u, stats.dropped_frames);
+    ASSERT_EQ(1u, stats.dropped_non_reference);
+    ASSERT_EQ(3u, stats.dropped_until_key_frame);
+    ASSERT_EQ(2300u, stats.dropped_bytes);
+
+    Clock::Set(nullptr);
+}
+
+void test_shared_client_bucket()
+{
+    auto clock = std::make_shared<SimulatedClock>();
+    Clock::Set(clock);
+
+    // Two sessions of one client: the heavy one drains the shared bucket, its own cap is generous
+    auto client = std::make_shared<TokenBucket>(8000000, 10);
+    EgressShaper heavy(std::make_shared<TokenBucket>(80000000, 10), client);
+    EgressShaper light(std::make_shared<TokenBucket>(80000000, 10), client);
+
+    ASSERT_TRUE(heavy.Admit(MakeVideoFrame(FrameType::B, false), 10000));
+    ASSERT_FALSE(light.Admit(MakeVideoFrame(FrameType::B, false), 1000));
+
+    // 1 ms refills 1000 bytes on the client bucket
+    clock->Advance(1000);
+    ASSERT_TRUE(light.Admit(MakeVideoFrame(FrameType::B, false), 1000));
+
+    Clock::Set(nullptr);
+}
+
+void test_transport_stream_pes_boundaries()
+{
+    auto clock = std::make_shared<SimulatedClock>();
+    Clock::Set(clock);
+
+    // 8 Mbps with a 1 ms burst: 1000 bytes deep
+    auto bucket = std::make_shared<TokenBucket>(8000000, 1);
+    EgressShaper shaper(bucket, nullptr);
+
+    // A video PES that started under the cap is finished as debt
+    ASSERT_TRUE(shaper.Admit(MakeTsFrame({{0x100, true}}), 188));
+    ASSERT_TRUE(shaper.Admit(MakeTsFrame({{0x100, false}}), 2000));
+
+    // An audio PES starting over the cap is dropped to its end, however much the cap recovers meanwhile
+    ASSERT_FALSE(shaper.Admit(MakeTsFrame({{0x101, true}}), 188));
+    ASSERT_TRUE(shaper.Admit(MakeTsFrame({{0x000, true}}), 188));
+    clock->Advance(10000);
+    ASSERT_FALSE(shaper.Admit(MakeTsFrame({{0x101, false}}), 188));
+
+    // Its next PES resumes the PID
+    ASSERT_TRUE(shaper.Admit(MakeTsFrame({{0x101, true}}), 188));
+    ASSERT_TRUE(shaper.Admit(MakeTsFrame({{0x101, false}}), 188));
+
+    // Dropping a chunk cuts every PES it carries, the video PES waits for its next start too
+    ASSERT_FALSE(shaper.Admit(MakeTsFrame({{0x100, false}, {0x101, true}}), 2000));
+    ASSERT_FALSE(shaper.Admit(MakeTsFrame({{0x100, false}}), 188));
+    ASSERT_TRUE(shaper.Admit(MakeTsFrame({{0x100, true}}), 188));
+
+    EgressStats stats = shaper.GetStats();
+    ASSERT_EQ(6u, stats.sent_frames);
+    ASSERT_EQ(4u, stats.dropped_frames);
+    ASSERT_EQ(2564u, stats.dropped_bytes);
+
+    Clock::Set(nullptr);
+}
+
+int main()
+{
+    TestSuite suite("Egress Shaper Tests");
+
+    suite.AddTest("Token Bucket", test_token_bucket);
+    suite.AddTest("Shaper Drop Policy", test_shaper_drop_policy);
+    suite.AddTest("Shared Client Bucket", test_shared_client_bucket);
+    suite.AddTest("Transport Stream PES Boundaries", test_transport_stream_pes_boundaries);
+
+    bool success = suite.RunAll();
+    return success ? 0 : 1;
+}
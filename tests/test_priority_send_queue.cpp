@@ -0,0 +1,159 @@
+/**
+ * @author SHAO Liming <lmshao@163.com>
+ * @copyright Copyright (c) 2025 SHAO Liming
+ * @license MIT
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <cstdint>
+#include <map>
+#include <vector>
+
+#include "lmrtsp/priority_send_queue.h"
+#include "test_framework.h"
+
+using namespace test_framework;
+using namespace lmshao::lmrtsp;
+
+namespace {
+struct Packet {
+    SendPriority priority = SendPriority::CONTROL;
+    uint64_t frame = 0;
+    int index = 0;
+};
+} // namespace
+
+void test_control_first()
+{
+    PrioritySendQueue<Packet> queue;
+    queue.Push(SendPriority::NON_REFERENCE, Packet{SendPriority::NON_REFERENCE, 0, 0}, 1000);
+    queue.Push(SendPriority::KEY, Packet{SendPriority::KEY, 0, 1}, 1000);
+    queue.Push(SendPriority::CONTROL, Packet{SendPriority::CONTROL, 0, 2}, 100);
+    queue.Push(SendPriority::CONTROL, Packet{SendPriority::CONTROL, 0, 3}, 100);
+
+    Packet packet;
+    ASSERT_TRUE(queue.Pop(packet));
+    ASSERT_EQ(2, packet.index);
+    ASSERT_TRUE(queue.Pop(packet));
+    ASSERT_EQ(3, packet.index);
+
+    // A CONTROL packet pushed later still overtakes queued video
+    queue.Push(SendPriority::CONTROL, Packet{SendPriority::CONTROL, 0, 4}, 100);
+    ASSERT_TRUE(queue.Pop(packet));
+    ASSERT_EQ(4, packet.index);
+
+    ASSERT_EQ(2u, queue.Count());
+    ASSERT_EQ(2000u, queue.Bytes());
+}
+
+void test_drr_weights()
+{
+    PrioritySendQueue<Packet> queue(64 * 1024 * 1024, 1500);
+
+    // Backlog in all three video classes, equal packet sizes
+    for (int i = 0; i < 700; ++i) {
+        queue.Push(SendPriority::KEY, Packet{SendPriority::KEY, 0, i}, 1500);
+        queue.Push(SendPriority::REFERENCE, Packet{SendPriority::REFERENCE, 0, i}, 1500);
+        queue.Push(SendPriority::NON_REFERENCE, Packet{SendPriority::NON_REFERENCE, 0, i}, 1500);
+    }
+
+    // 700 packets is 100 rounds of 4 + 2 + 1
+    std::map<SendPriority, int> sent;
+    Packet packet;
+    for (int i = 0; i < 700; ++i) {
+        ASSERT_TRUE(queue.Pop(packet));
+        sent[packet.priority]++;
+    }
+    ASSERT_EQ(400, sent[SendPriority::KEY]);
+    ASSERT_EQ(200, sent[SendPriority::REFERENCE]);
+    ASSERT_EQ(100, sent[SendPriority::NON_REFERENCE]);
+
+    // Within a class the order is FIFO
+    int expected = 400;
+    while (queue.Pop(packet)) {
+        if (packet.priority == SendPriority::KEY) {
+            ASSERT_EQ(expected, packet.index);
+            expected++;
+        }
+    }
+    ASSERT_EQ(700, expected);
+    ASSERT_TRUE(queue.Empty());
+    ASSERT_EQ(0u, queue.Bytes());
+}
+
+void test_drop_whole_frames()
+{
+    PrioritySendQueue<Packet> queue(10000);
+
+    // Two disposable frames of 4 packets each, then a reference frame
+    for (int i = 0; i < 4; ++i) {
+        ASSERT_TRUE(queue.Push(SendPriority::NON_REFERENCE, Packet{SendPriority::NON_REFERENCE, 1, i}, 1000, 1));
+    }
+    for (int i = 0; i < 4; ++i) {
+        ASSERT_TRUE(queue.Push(SendPriority::NON_REFERENCE, Packet{SendPriority::NON_REFERENCE, 2, i}, 1000, 2));
+    }
+    ASSERT_TRUE(queue.Push(SendPriority::REFERENCE, Packet{SendPriority::REFERENCE, 3, 0}, 1000, 3));
+    ASSERT_TRUE(queue.Push(SendPriority::REFERENCE, Packet{SendPriority::REFERENCE, 3, 1}, 1000, 3));
+    ASSERT_EQ(10000u, queue.Bytes());
+
+    // One more packet drops all of the oldest disposable frame, not a single packet of it
+    ASSERT_TRUE(queue.Push(SendPriority::REFERENCE, Packet{SendPriority::REFERENCE, 3, 2}, 1000, 3));
+    ASSERT_EQ(4u, queue.GetDropped(SendPriority::NON_REFERENCE));
+    ASSERT_EQ(7000u, queue.Bytes());
+
+    Packet packet;
+    std::map<uint64_t, int> frames;
+    while (queue.Pop(packet)) {
+        frames[packet.frame]++;
+    }
+    ASSERT_EQ(0, frames[1]);
+    ASSERT_EQ(4, frames[2]);
+    ASSERT_EQ(3, frames[3]);
+}
+
+void test_drop_rest_of_frame()
+{
+    PrioritySendQueue<Packet> queue(4000);
+
+    // A reference frame fills the queue while its disposable predecessor is still arriving
+    ASSERT_TRUE(queue.Push(SendPriority::NON_REFERENCE, Packet{SendPriority::NON_REFERENCE, 1, 0}, 1000, 1));
+    ASSERT_TRUE(queue.Push(SendPriority::NON_REFERENCE, Packet{SendPriority::NON_REFERENCE, 1, 1}, 1000, 1));
+    for (int i = 0; i < 3; ++i) {
+        ASSERT_TRUE(queue.Push(SendPriority::REFERENCE, Packet{SendPriority::REFERENCE, 2, i}, 1000, 2));
+    }
+
+    // Frame 1 is gone, its late packets are dropped too even though they would fit now
+    ASSERT_EQ(3000u, queue.Bytes());
+    ASSERT_FALSE(queue.Push(SendPriority::NON_REFERENCE, Packet{SendPriority::NON_REFERENCE, 1, 2}, 100, 1));
+    ASSERT_EQ(3u, queue.GetDropped(SendPriority::NON_REFERENCE));
+
+    // Packets that are not part of a frame are unaffected
+    ASSERT_TRUE(queue.Push(SendPriority::NON_REFERENCE, Packet{SendPriority::NON_REFERENCE, 0, 3}, 100));
+
+    // A packet that cannot get room for itself takes the rest of its frame with it
+    ASSERT_TRUE(queue.Push(SendPriority::KEY, Packet{SendPriority::KEY, 3, 0}, 100, 3));
+    ASSERT_TRUE(queue.Push(SendPriority::CONTROL, Packet{SendPriority::CONTROL, 0, 0}, 800));
+    ASSERT_EQ(4000u, queue.Bytes());
+    ASSERT_FALSE(queue.Push(SendPriority::REFERENCE, Packet{SendPriority::REFERENCE, 4, 0}, 3500, 4));
+    ASSERT_FALSE(queue.Push(SendPriority::REFERENCE, Packet{SendPriority::REFERENCE, 4, 1}, 10, 4));
+    ASSERT_EQ(5u, queue.GetDropped(SendPriority::REFERENCE)); // Frame 2 made room in vain, then both of frame 4
+    ASSERT_EQ(900u, queue.Bytes());
+
+    // Higher classes are never dropped for lower ones
+    ASSERT_EQ(0u, queue.GetDropped(SendPriority::KEY));
+    ASSERT_EQ(0u, queue.GetDropped(SendPriority::CONTROL));
+}
+
+int main()
+{
+    TestSuite suite("Priority Send Queue Tests");
+
+    suite.AddTest("Control First", test_control_first);
+    suite.AddTest("DRR Weights", test_drr_weights);
+    suite.AddTest("Drop Whole Frames", test_drop_whole_frames);
+    suite.AddTest("Drop Rest Of Frame", test_drop_rest_of_frame);
+
+    bool success = suite.RunAll();
+    return success ? 0 : 1;
+}
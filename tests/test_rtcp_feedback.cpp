@@ -0,0 +1,210 @@
+/**
+ * @author SHAO Liming <lmshao@163.com>
+ * @copyright Copyright (c) 2025 SHAO Liming
+ * @license MIT
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "lmrtsp/clock.h"
+#include "lmrtsp/rtcp_context.h"
+#include "lmrtsp/rtcp_packet.h"
+#include "test_framework.h"
+
+using namespace test_framework;
+using namespace lmshao::lmrtsp;
+
+void test_nack_packing()
+{
+    // Unordered, across the wrap, with a duplicate; 65530..65535, 0..10 fit one item, 40 needs another
+    std::vector<uint16_t> lost = {3, 65530, 40, 10, 65535, 3};
+    auto nack = RtcpFeedback::CreateNack(0x2222, 0x1111, lost);
+    ASSERT_TRUE(nack != nullptr);
+    ASSERT_EQ(2u * sizeof(NackItem), nack->GetFciSize());
+
+    std::vector<uint16_t> expected = {65530, 65535, 3, 10, 40};
+    ASSERT_TRUE(nack->GetNackSequences() == expected);
+}
+
+void test_feedback_packet_size()
+{
+    auto clock = std::make_shared<SimulatedClock>();
+    Clock::Set(clock);
+
+    auto receiver = RtcpReceiverContext::Create();
+    receiver->Initialize(0x2222, 0x1111);
+    receiver->OnRtp(100, 0, clock->MonotonicNs(), 90000, 1200);
+
+    // Compound by default: RR + SDES + PLI
+    auto pli = receiver->CreatePli();
+    ASSERT_TRUE(pli != nullptr);
+    auto compound = receiver->CreateFeedbackPacket(pli, "receiver@host");
+    ASSERT_TRUE(compound != nullptr);
+    ASSERT_TRUE(compound->Size() > pli->Size());
+    ASSERT_EQ(static_cast<uint8_t>(RtcpType::RR), compound->Data()[1]);
+
+    // Reduced-size: the 12-byte PLI alone
+    receiver->SetReducedSize(true);
+    auto single = receiver->CreateFeedbackPacket(pli, "receiver@host");
+    ASSERT_EQ(12u, single->Size());
+    ASSERT_EQ(static_cast<uint8_t>(RtcpType::PSFB), single->Data()[1]);
+
+    Clock::Set(nullptr);
+}
+
+void test_sender_feedback_callbacks()
+{
+    auto clock = std::make_shared<SimulatedClock>();
+    Clock::Set(clock);
+
+    auto sender = RtcpSenderContext::Create();
+    auto receiver = RtcpReceiverContext::Create();
+    sender->Initialize(0x1111, 0x1111);
+    receiver->Initialize(0x2222, 0x1111);
+    receiver->OnRtp(100, 0, clock->MonotonicNs(), 90000, 1200);
+
+    std::vector<uint16_t> nacked;
+    int plis = 0;
+    sender->SetNackCallback([&nacked](const std::vector<uint16_t> &lostSeqs) { nacked = lostSeqs; });
+    sender->SetPliCallback([&plis]() { plis++; });
+
+    // A reduced-size NACK and a compound PLI are both understood
+    receiver->SetReducedSize(true);
+    sender->OnRtcp(*receiver->CreateFeedbackPacket(receiver->CreateNack({101, 102, 105}), ""));
+    receiver->SetReducedSize(false);
+    sender->OnRtcp(*receiver->CreateFeedbackPacket(receiver->CreatePli(), "receiver@host"));
+
+    std::vector<uint16_t> expected = {101, 102, 105};
+    ASSERT_TRUE(nacked == expected);
+    ASSERT_EQ(1, plis);
+
+    // The compound PLI also carried a receiver report
+    RtcpReceiverFeedback feedback = sender->GetReceiverFeedback();
+    ASSERT_TRUE(feedback.valid);
+    ASSERT_EQ(1u, feedback.nack_packets);
+    ASSERT_EQ(1u, feedback.pli_packets);
+
+    // Feedback about another stream is ignored
+    auto other = RtcpReceiverContext::Create();
+    other->Initialize(0x3333, 0x4444);
+    other->SetReducedSize(true);
+    sender->OnRtcp(*other->CreateFeedbackPacket(other->CreatePli(), ""));
+    ASSERT_EQ(1, plis);
+
+    Clock::Set(nullptr);
+}
+
+void test_receiver_feedback()
+{
+    auto clock = std::make_shared<SimulatedClock>();
+    Clock::Set(clock);
+
+    auto sender = RtcpSenderContext::Create();
+    auto receiver = RtcpReceiverContext::Create();
+    sender->Initialize(0x1111, 0x1111);
+    receiver->Initialize(0x2222, 0x1111);
+    ASSERT_FALSE(sender->GetReceiverFeedback().valid);
+
+    // Every tenth packet lost
+    for (uint16_t seq = 0; seq < 100; ++seq) {
+        sender->OnRtp(seq, seq * 3600u, clock->MonotonicNs(), 90000, 1200);
+        if (seq % 10 != 5) {
+            receiver->OnRtp(seq, seq * 3600u, clock->MonotonicNs(), 90000, 1200);
+        }
+    }
+
+    auto sr = sender->CreateRtcpSr();
+    receiver->OnRtcp(*sr);
+
+    // The receiver holds the SR for 50 ms, the report then takes 30 ms to come back
+    clock->Advance(50000);
+    auto rr = receiver->CreateRtcpRr();
+    clock->Advance(30000);
+    sender->OnRtcp(*rr);
+
+    RtcpReceiverFeedback feedback = sender->GetReceiverFeedback();
+    ASSERT_TRUE(feedback.valid);
+    ASSERT_EQ(25, feedback.fraction_lost); // 10 of 100, in 1/256
+    ASSERT_TRUE(feedback.rtt_ms >= 30 && feedback.rtt_ms <= 31);
+    ASSERT_EQ(clock->NowMs(), feedback.report_time_ms);
+
+    Clock::Set(nullptr);
+}
+
+void test_receiver_jitter()
+{
+    auto rtcp = RtcpReceiverContext::Create();
+
+    // 25 fps at 90 kHz, arriving exactly on time
+    int64_t arrival = 0;
+    uint32_t timestamp = 0;
+    for (uint16_t seq = 0; seq < 50; ++seq) {
+        rtcp->OnRtp(seq, timestamp, arrival, 90000, 1200);
+        arrival += 40000000;
+        timestamp += 3600;
+    }
+    ASSERT_EQ(0u, rtcp->GetJitter());
+
+    // One packet 1 ms late is 90 timestamp units of transit difference, J = 90 / 16
+    rtcp->OnRtp(50, timestamp, arrival + 1000000, 90000, 1200);
+    ASSERT_EQ(5u, rtcp->GetJitter());
+}
+
+void test_paced_stream_jitter()
+{
+    auto clock = std::make_shared<SimulatedClock>();
+    auto rtcp = RtcpReceiverContext::Create();
+
+    // Sender paces one 90 kHz frame every 40 ms, the network adds 2 ms to every other one
+    uint16_t seq = 0;
+    uint32_t timestamp = 0;
+    bool wobble = true;
+    std::vector<int64_t> sent;
+    auto timer = clock->CreateTimer();
+    auto id = timer->ScheduleRepeating(
+        [&]() {
+            int64_t now = clock->MonotonicNs();
+            sent.push_back(now);
+            int64_t delay = (wobble && (seq & 1)) ? 2000000 : 0;
+            rtcp->OnRtp(seq++, timestamp, now + 5000000 + delay, 90000, 1200);
+            timestamp += 3600;
+        },
+        40);
+
+    clock->Advance(8000000);
+    ASSERT_EQ(200u, sent.size());
+    for (size_t i = 1; i < sent.size(); ++i) {
+        ASSERT_EQ(40000000, sent[i] - sent[i - 1]);
+    }
+
+    // Every transit difference is 2 ms = 180 units, so J settles just under 180
+    uint32_t jitter = rtcp->GetJitter();
+    ASSERT_TRUE(jitter >= 170 && jitter <= 180);
+
+    // Once delivery is steady again the estimate decays by 15/16 per packet
+    wobble = false;
+    clock->Advance(4000000);
+    ASSERT_EQ(300u, sent.size());
+    ASSERT_TRUE(rtcp->GetJitter() <= 1);
+
+    timer->Cancel(id);
+}
+
+int main()
+{
+    TestSuite suite("RTCP Feedback Tests");
+
+    suite.AddTest("NACK Packing", test_nack_packing);
+    suite.AddTest("Feedback Packet Size", test_feedback_packet_size);
+    suite.AddTest("Sender Feedback Callbacks", test_sender_feedback_callbacks);
+    suite.AddTest("Receiver Feedback", test_receiver_feedback);
+    suite.AddTest("Receiver Jitter", test_receiver_jitter);
+    suite.AddTest("Paced Stream Jitter", test_paced_stream_jitter);
+
+    bool success = suite.RunAll();
+    return success ? 0 : 1;
+}
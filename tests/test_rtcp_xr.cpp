@@ -0,0 +1,195 @@
+/**
+ * @author SHAO Liming <lmshao@163.com>
+ * @copyright Copyright (c) 2025 SHAO Liming
+ * @license MIT
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "lmrtsp/clock.h"
+#include "lmrtsp/rtcp_context.h"
+#include "lmrtsp/rtcp_packet.h"
+#include "test_framework.h"
+
+using namespace test_framework;
+using namespace lmshao::lmrtsp;
+
+namespace {
+
+// 100 packets from seq 65500, a burst of 20 losses, two isolated ones
+std::vector<bool> MakeReceivedFlags()
+{
+    std::vector<bool> received(100, true);
+    for (size_t i = 30; i < 50; ++i) {
+        received[i] = false;
+    }
+    received[10] = false;
+    received[70] = false;
+    return received;
+}
+
+} // namespace
+
+void test_xr_packet_round_trip()
+{
+    RtcpXrReport report;
+    report.ssrc = 0x2222;
+
+    XrRleReport loss;
+    loss.ssrc = 0x1111;
+    loss.beginSeq = 65500;
+    loss.endSeq = static_cast<uint16_t>(65500 + 100);
+    loss.flags = MakeReceivedFlags();
+    report.lossRle.push_back(loss);
+
+    XrRleReport dup = loss;
+    dup.flags.assign(100, false);
+    dup.flags[80] = true;
+    report.dupRle.push_back(dup);
+
+    XrStatisticsSummary summary;
+    summary.ssrc = 0x1111;
+    summary.beginSeq = loss.beginSeq;
+    summary.endSeq = loss.endSeq;
+    summary.hasLoss = true;
+    summary.hasDup = true;
+    summary.hasJitter = true;
+    summary.lostPackets = 22;
+    summary.dupPackets = 1;
+    summary.minJitter = 10;
+    summary.maxJitter = 900;
+    summary.meanJitter = 120;
+    summary.devJitter = 45;
+    report.statisticsSummary.push_back(summary);
+
+    report.hasReferenceTime = true;
+    report.referenceNtpH = 0x12345678;
+    report.referenceNtpL = 0x9ABCDEF0;
+
+    XrDlrrItem item;
+    item.ssrc = 0x3333;
+    item.lastRr = 0x56789ABC;
+    item.delaySinceLastRr = 65536;
+    report.dlrr.push_back(item);
+
+    auto xr = RtcpXr::Create(report);
+    ASSERT_TRUE(xr != nullptr);
+    ASSERT_EQ(0u, xr->GetSize() % 4);
+
+    RtcpXrReport parsed;
+    ASSERT_TRUE(RtcpXr::Parse(reinterpret_cast<const uint8_t *>(xr.get()), xr->GetSize(), parsed));
+    ASSERT_EQ(0x2222u, parsed.ssrc);
+
+    ASSERT_EQ(1u, parsed.lossRle.size());
+    ASSERT_EQ(0x1111u, parsed.lossRle[0].ssrc);
+    ASSERT_EQ(65500, parsed.lossRle[0].beginSeq);
+    ASSERT_EQ(static_cast<uint16_t>(65600), parsed.lossRle[0].endSeq);
+    ASSERT_TRUE(parsed.lossRle[0].flags == loss.flags);
+
+    ASSERT_EQ(1u, parsed.dupRle.size());
+    ASSERT_TRUE(parsed.dupRle[0].flags == dup.flags);
+
+    ASSERT_EQ(1u, parsed.statisticsSummary.size());
+    ASSERT_TRUE(parsed.statisticsSummary[0].hasJitter);
+    ASSERT_EQ(22u, parsed.statisticsSummary[0].lostPackets);
+    ASSERT_EQ(1u, parsed.statisticsSummary[0].dupPackets);
+    ASSERT_EQ(900u, parsed.statisticsSummary[0].maxJitter);
+    ASSERT_EQ(45u, parsed.statisticsSummary[0].devJitter);
+
+    ASSERT_TRUE(parsed.hasReferenceTime);
+    ASSERT_EQ(0x12345678u, parsed.referenceNtpH);
+    ASSERT_EQ(0x9ABCDEF0u, parsed.referenceNtpL);
+
+    ASSERT_EQ(1u, parsed.dlrr.size());
+    ASSERT_EQ(0x3333u, parsed.dlrr[0].ssrc);
+    ASSERT_EQ(0x56789ABCu, parsed.dlrr[0].lastRr);
+    ASSERT_EQ(65536u, parsed.dlrr[0].delaySinceLastRr);
+
+    // Truncated packets are rejected
+    ASSERT_FALSE(RtcpXr::Parse(reinterpret_cast<const uint8_t *>(xr.get()), xr->GetSize() - 4, parsed));
+}
+
+void test_xr_loss_pattern_and_rtt()
+{
+    auto clock = std::make_shared<SimulatedClock>();
+    Clock::Set(clock);
+
+    auto sender = RtcpSenderContext::Create();
+    auto receiver = RtcpReceiverContext::Create();
+    sender->Initialize(0x1111, 0x1111);
+    receiver->Initialize(0x2222, 0x1111);
+    receiver->SetXrEnabled(true);
+    ASSERT_FALSE(sender->GetXrStats().valid);
+
+    // One packet every 40 ms, 3600 ticks at 90 kHz, so the transit time never changes; sequence numbers wrap
+    std::vector<bool> received = MakeReceivedFlags();
+    for (uint16_t i = 0; i < 100; ++i) {
+        uint16_t seq = static_cast<uint16_t>(65500 + i);
+        sender->OnRtp(seq, i * 3600u, clock->MonotonicNs(), 90000, 1200);
+        if (received[i]) {
+            receiver->OnRtp(seq, i * 3600u, clock->MonotonicNs(), 90000, 1200);
+        }
+        if (i == 80) {
+            receiver->OnRtp(seq, i * 3600u, clock->MonotonicNs(), 90000, 1200);
+        }
+        clock->Advance(40000);
+    }
+
+    // RR + XR, then XR takes 10 ms to reach the sender
+    auto report = receiver->CreateCompoundPacket("", "");
+    ASSERT_TRUE(report != nullptr);
+    clock->Advance(10000);
+    sender->OnRtcp(*report);
+
+    RtcpXrStats stats = sender->GetXrStats();
+    ASSERT_TRUE(stats.valid);
+    ASSERT_EQ(65500, stats.begin_seq);
+    ASSERT_EQ(static_cast<uint16_t>(65600), stats.end_seq);
+    ASSERT_EQ(78u, stats.received_packets);
+    ASSERT_EQ(22u, stats.lost_packets);
+    ASSERT_EQ(3u, stats.loss_bursts);
+    ASSERT_EQ(2u, stats.isolated_losses);
+    ASSERT_EQ(20u, stats.max_burst_length);
+    ASSERT_EQ(1u, stats.dup_packets);
+    ASSERT_TRUE(stats.has_jitter);
+    ASSERT_EQ(0u, stats.min_jitter);
+    ASSERT_EQ(clock->NowMs(), stats.report_time_ms);
+
+    // The sender answers 40 ms later with DLRR, the answer takes another 10 ms back
+    ASSERT_EQ(0u, receiver->GetRtt());
+    clock->Advance(40000);
+    auto answer = sender->CreateCompoundPacket("", "");
+    ASSERT_TRUE(answer != nullptr);
+    clock->Advance(10000);
+    receiver->OnRtcp(*answer);
+    ASSERT_EQ(20u, receiver->GetRtt());
+
+    // Each reference time is answered once
+    auto next = sender->CreateRtcpXr();
+    ASSERT_TRUE(next == nullptr);
+
+    // The next interval starts after the last reported sequence number
+    receiver->OnRtp(static_cast<uint16_t>(65600 + 2), 102 * 3600u, clock->MonotonicNs(), 90000, 1200);
+    sender->OnRtcp(*receiver->CreateCompoundPacket("", ""));
+    stats = sender->GetXrStats();
+    ASSERT_EQ(static_cast<uint16_t>(65600), stats.begin_seq);
+    ASSERT_EQ(2u, stats.lost_packets);
+    ASSERT_EQ(1u, stats.loss_bursts);
+
+    Clock::Set(nullptr);
+}
+
+int main()
+{
+    TestSuite suite("RTCP XR Tests");
+
+    suite.AddTest("XR Packet Round Trip", test_xr_packet_round_trip);
+    suite.AddTest("XR Loss Pattern And RTT", test_xr_loss_pattern_and_rtt);
+
+    bool success = suite.RunAll();
+    return success ? 0 : 1;
+}
@@ -0,0 +1,327 @@
+/**
+ * @author SHAO Liming <lmshao@163.com>
+ * @copyright Copyright (c) 2025 SHAO Liming
+ * @license MIT
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+#endif
+
+#include "rtp/rtp_packet_recycler.h"
+#include "rtp/rtp_pipeline.h"
+#include "rtp/udp_rtp_transport_adapter.h"
+#include "test_framework.h"
+
+using namespace test_framework;
+using namespace lmshao::lmrtsp;
+
+namespace {
+using Packets = std::vector<std::string>;
+
+// The listener path: keeps every packet until the frame is done, so a recycled packet would show up corrupted
+class CollectingListener : public IRtpPacketizerListener {
+public:
+    void OnPacket(const std::shared_ptr<RtpPacket> &packet) override { packets_.push_back(packet); }
+    void OnError(int code, const std::string &message) override
+    {
+        (void)code;
+        (void)message;
+    }
+
+    Packets Take()
+    {
+        Packets serialized;
+        for (const auto &packet : packets_) {
+            auto buffer = packet->Serialize();
+            serialized.emplace_back(reinterpret_cast<const char *>(buffer->Data()), buffer->Size());
+        }
+        packets_.clear();
+        return serialized;
+    }
+
+private:
+    std::vector<std::shared_ptr<RtpPacket>> packets_;
+};
+
+std::shared_ptr<MediaFrame> MakeFrame(MediaType type, uint32_t timestamp, const std::vector<uint8_t> &bytes)
+{
+    auto frame = std::make_shared<MediaFrame>();
+    frame->media_type = type;
+    frame->timestamp = timestamp;
+    frame->data = lmshao::lmcore::DataBuffer::Create(bytes.size());
+    frame->data->Assign(bytes.data(), bytes.size());
+    return frame;
+}
+
+void AppendNalu(std::vector<uint8_t> &frame, std::vector<uint8_t> header, size_t size)
+{
+    frame.insert(frame.end(), {0, 0, 0, 1});
+    frame.insert(frame.end(), header.begin(), header.end());
+    for (size_t i = header.size(); i < size; ++i) {
+        frame.push_back(static_cast<uint8_t>(i * 7 + 3));
+    }
+}
+
+std::vector<std::shared_ptr<MediaFrame>> H264Frames()
+{
+    std::vector<uint8_t> key;
+    AppendNalu(key, {0x67}, 20);   // SPS, single NAL unit packet
+    AppendNalu(key, {0x68}, 6);    // PPS
+    AppendNalu(key, {0x65}, 5000); // IDR slice, FU-A
+    std::vector<uint8_t> delta;
+    AppendNalu(delta, {0x41}, 900);
+    return {MakeFrame(MediaType::H264, 3000, key), MakeFrame(MediaType::H264, 6000, delta)};
+}
+
+std::vector<std::shared_ptr<MediaFrame>> H265Frames()
+{
+    std::vector<uint8_t> key;
+    AppendNalu(key, {0x40, 0x01}, 24);   // VPS
+    AppendNalu(key, {0x26, 0x01}, 4200); // IDR_W_RADL, fragmented
+    std::vector<uint8_t> delta;
+    AppendNalu(delta, {0x02, 0x01}, 700);
+    return {MakeFrame(MediaType::H265, 3000, key), MakeFrame(MediaType::H265, 6000, delta)};
+}
+
+std::vector<std::shared_ptr<MediaFrame>> AacFrames()
+{
+    std::vector<uint8_t> first(320, 0x21);
+    std::vector<uint8_t> second(180, 0x42);
+    return {MakeFrame(MediaType::AAC, 1024, first), MakeFrame(MediaType::AAC, 2048, second)};
+}
+
+std::vector<std::shared_ptr<MediaFrame>> TsFrames()
+{
+    std::vector<uint8_t> ts;
+    for (uint8_t i = 0; i < 17; ++i) {
+        std::vector<uint8_t> packet(188, i);
+        packet[0] = 0x47;
+        ts.insert(ts.end(), packet.begin(), packet.end());
+    }
+    return {MakeFrame(MediaType::MP2T, 3000, ts), MakeFrame(MediaType::MP2T, 6000, ts)};
+}
+
+#ifdef __linux__
+class UdpReceiver {
+public:
+    UdpReceiver() : fd_(socket(AF_INET, SOCK_DGRAM, 0))
+    {
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        bind(fd_, reinterpret_cast<sockaddr *>(&addr), sizeof(addr));
+        socklen_t len = sizeof(addr);
+        getsockname(fd_, reinterpret_cast<sockaddr *>(&addr), &len);
+        port_ = ntohs(addr.sin_port);
+
+        int size = 4 * 1024 * 1024;
+        setsockopt(fd_, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+        timeval timeout{0, 200000};
+        setsockopt(fd_, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    }
+    ~UdpReceiver() { close(fd_); }
+
+    uint16_t Port() const { return port_; }
+
+    // Everything sent so far, the read times out once the socket is drained
+    Packets Take()
+    {
+        Packets packets;
+        char buffer[2048];
+        ssize_t n;
+        while ((n = recv(fd_, buffer, sizeof(buffer), 0)) > 0) {
+            packets.emplace_back(buffer, static_cast<size_t>(n));
+        }
+        return packets;
+    }
+
+private:
+    int fd_;
+    uint16_t port_ = 0;
+};
+
+uint16_t FreeUdpPort()
+{
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr));
+    socklen_t len = sizeof(addr);
+    getsockname(fd, reinterpret_cast<sockaddr *>(&addr), &len);
+    close(fd);
+    return ntohs(addr.sin_port);
+}
+
+// Packetizes the frames through SubmitFrame() and through the UDP pipeline, frame by frame
+template <typename Packetizer>
+void ComparePaths(MediaType codec, Packetizer &listenerPath, Packetizer &pipelinePath,
+                  const std::vector<std::shared_ptr<MediaFrame>> &frames)
+{
+    auto listener = std::make_shared<CollectingListener>();
+    listenerPath.SetListener(listener);
+
+    UdpReceiver receiver;
+    TransportConfig config;
+    config.type = TransportConfig::Type::UDP;
+    config.mode = TransportConfig::Mode::SOURCE;
+    config.client_ip = "127.0.0.1";
+    config.client_rtp_port = receiver.Port();
+    config.server_rtp_port = FreeUdpPort();
+    UdpRtpTransportAdapter transport;
+    ASSERT_TRUE(transport.Setup(config));
+
+    PipelineFunc pipeline = SelectPipeline(codec, PipelineTransport::UDP);
+    ASSERT_TRUE(pipeline != nullptr);
+
+    for (const auto &frame : frames) {
+        listenerPath.SubmitFrame(frame);
+        Packets expected = listener->Take();
+        ASSERT_TRUE(!expected.empty());
+
+        pipeline(pipelinePath, transport, nullptr, *frame, 0);
+        Packets sent = receiver.Take();
+        ASSERT_EQ(expected.size(), sent.size());
+        for (size_t i = 0; i < expected.size(); ++i) {
+            ASSERT_TRUE(expected[i] == sent[i]);
+        }
+    }
+    transport.Close();
+}
+#endif
+} // namespace
+
+void test_packet_recycler()
+{
+    RtpPacketRecycler recycler;
+
+    auto first = recycler.Acquire(100);
+    RtpPacket *raw = first.get();
+    auto *payload = first->payload.get();
+    first->sequence_number = 7;
+    first->marker = 1;
+    first->payload->Assign("abc", 3);
+    first.reset();
+
+    // Released by the sink: the same packet and buffer come back, reset
+    auto second = recycler.Acquire(100);
+    ASSERT_TRUE(second.get() == raw);
+    ASSERT_TRUE(second->payload.get() == payload);
+    ASSERT_EQ(0, second->sequence_number);
+    ASSERT_EQ(0, second->marker);
+    ASSERT_EQ(0u, second->payload->Size());
+    ASSERT_TRUE(second->payload->Capacity() >= 100u);
+
+    // Kept by a listener: a fresh packet, the kept one is left alone
+    second->payload->Assign("kept", 4);
+    auto third = recycler.Acquire(100);
+    ASSERT_TRUE(third.get() != second.get());
+    ASSERT_EQ(4u, second->payload->Size());
+
+    // Only the payload kept: the packet is reused, the payload is not
+    auto keptPayload = third->payload;
+    RtpPacket *thirdRaw = third.get();
+    third.reset();
+    auto fourth = recycler.Acquire(100);
+    ASSERT_TRUE(fourth.get() == thirdRaw);
+    ASSERT_TRUE(fourth->payload != keptPayload);
+}
+
+void test_parallel_matches_serial()
+{
+    // Large enough for several worker chunks, starting just before the sequence number wraps
+    std::vector<uint8_t> key;
+    AppendNalu(key, {0x67}, 20);
+    AppendNalu(key, {0x68}, 6);
+    AppendNalu(key, {0x65}, 300000);
+    AppendNalu(key, {0x65}, 1000);
+    auto frame = MakeFrame(MediaType::H264, 3000, key);
+    std::vector<uint8_t> delta;
+    AppendNalu(delta, {0x41}, 200000);
+    auto next = MakeFrame(MediaType::H264, 6000, delta);
+
+    RtpPacketizerH264 serial(0x1234, 0xFFF0, 96);
+    RtpPacketizerH264 parallel(0x1234, 0xFFF0, 96);
+    parallel.SetParallelThreshold(64 * 1024);
+    auto serialListener = std::make_shared<CollectingListener>();
+    auto parallelListener = std::make_shared<CollectingListener>();
+    serial.SetListener(serialListener);
+    parallel.SetListener(parallelListener);
+
+    uint16_t seq = 0xFFF0;
+    for (const auto &f : {frame, next}) {
+        serial.SubmitFrame(f);
+        parallel.SubmitFrame(f);
+        Packets expected = serialListener->Take();
+        Packets actual = parallelListener->Take();
+        ASSERT_TRUE(expected.size() > 100);
+        ASSERT_EQ(expected.size(), actual.size());
+        for (size_t i = 0; i < expected.size(); ++i) {
+            ASSERT_TRUE(expected[i] == actual[i]);
+            uint16_t packetSeq = static_cast<uint16_t>((static_cast<uint8_t>(actual[i][2]) << 8) |
+                                                       static_cast<uint8_t>(actual[i][3]));
+            ASSERT_EQ(seq, packetSeq);
+            seq++;
+        }
+    }
+}
+
+#ifdef __linux__
+void test_h264_pipeline_matches_listener()
+{
+    RtpPacketizerH264 listenerPath(0x1234, 0xFFF0, 96);
+    RtpPacketizerH264 pipelinePath(0x1234, 0xFFF0, 96);
+    ComparePaths(MediaType::H264, listenerPath, pipelinePath, H264Frames());
+}
+
+void test_h265_pipeline_matches_listener()
+{
+    RtpPacketizerH265 listenerPath(0x2345, 100, 98);
+    RtpPacketizerH265 pipelinePath(0x2345, 100, 98);
+    ComparePaths(MediaType::H265, listenerPath, pipelinePath, H265Frames());
+}
+
+void test_aac_pipeline_matches_listener()
+{
+    RtpPacketizerAac listenerPath(0x3456, 200, 97);
+    RtpPacketizerAac pipelinePath(0x3456, 200, 97);
+    ComparePaths(MediaType::AAC, listenerPath, pipelinePath, AacFrames());
+}
+
+void test_ts_pipeline_matches_listener()
+{
+    RtpPacketizerTs listenerPath;
+    RtpPacketizerTs pipelinePath;
+    listenerPath.SetSsrc(0x4567);
+    pipelinePath.SetSsrc(0x4567);
+    ComparePaths(MediaType::MP2T, listenerPath, pipelinePath, TsFrames());
+}
+#endif
+
+int main()
+{
+    TestSuite suite("RTP Pipeline Tests");
+
+    suite.AddTest("Packet Recycler", test_packet_recycler);
+    suite.AddTest("Parallel Packetization Matches Serial", test_parallel_matches_serial);
+#ifdef __linux__
+    suite.AddTest("H264 Pipeline Matches Listener Path", test_h264_pipeline_matches_listener);
+    suite.AddTest("H265 Pipeline Matches Listener Path", test_h265_pipeline_matches_listener);
+    suite.AddTest("AAC Pipeline Matches Listener Path", test_aac_pipeline_matches_listener);
+    suite.AddTest("MP2T Pipeline Matches Listener Path", test_ts_pipeline_matches_listener);
+#endif
+
+    bool success = suite.RunAll();
+    return success ? 0 : 1;
+}
@@ -0,0 +1,348 @@
+/**
+ * @author SHAO Liming <lmshao@163.com>
+ * @copyright Copyright (c) 2025 SHAO Liming
+ * @license MIT
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#include "lmrtsp/clock.h"
+#include "lmrtsp/rtsp_client_runtime.h"
+#include "rtp/shared_udp_transport_adapter.h"
+#include "test_framework.h"
+
+using namespace test_framework;
+using namespace lmshao::lmrtsp;
+
+namespace {
+#ifdef __linux__
+// Loopback sender for datagrams carrying an RTP header with the given SSRC
+class UdpSender {
+public:
+    UdpSender() : fd_(socket(AF_INET, SOCK_DGRAM, 0)) {}
+    ~UdpSender() { close(fd_); }
+
+    void SendRtp(uint16_t port, uint32_t ssrc, uint16_t seq)
+    {
+        uint8_t packet[20] = {0x80, 96, static_cast<uint8_t>(seq >> 8), static_cast<uint8_t>(seq)};
+        packet[8] = static_cast<uint8_t>(ssrc >> 24);
+        packet[9] = static_cast<uint8_t>(ssrc >> 16);
+        packet[10] = static_cast<uint8_t>(ssrc >> 8);
+        packet[11] = static_cast<uint8_t>(ssrc);
+
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(port);
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        sendto(fd_, packet, sizeof(packet), 0, reinterpret_cast<sockaddr *>(&addr), sizeof(addr));
+    }
+
+private:
+    int fd_;
+};
+
+// A port the kernel considers free right now
+uint16_t FreeUdpPort()
+{
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr));
+    socklen_t len = sizeof(addr);
+    getsockname(fd, reinterpret_cast<sockaddr *>(&addr), &len);
+    close(fd);
+    return ntohs(addr.sin_port);
+}
+
+uint32_t PacketSsrc(const lmshao::lmcore::DataBuffer &buffer)
+{
+    const uint8_t *data = buffer.Data();
+    return (static_cast<uint32_t>(data[8]) << 24) | (static_cast<uint32_t>(data[9]) << 16) |
+           (static_cast<uint32_t>(data[10]) << 8) | data[11];
+}
+
+// Polls until the condition holds, datagrams arrive on the reactor threads
+template <typename Predicate>
+bool WaitFor(Predicate predicate, int timeout_ms = 2000)
+{
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    while (!predicate()) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+class CountingListener : public UdpRtpTransportAdapterListener {
+public:
+    void OnRtpDataReceived(std::shared_ptr<lmshao::lmnet::DataBuffer> buffer) override
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ssrcs_.push_back(PacketSsrc(*buffer));
+    }
+    void OnRtcpDataReceived(std::shared_ptr<lmshao::lmnet::DataBuffer> buffer) override { (void)buffer; }
+
+    std::vector<uint32_t> Ssrcs()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return ssrcs_;
+    }
+
+private:
+    std::mutex mutex_;
+    std::vector<uint32_t> ssrcs_;
+};
+#endif
+} // namespace
+
+void test_keep_alive_schedule()
+{
+    ClientHousekeeping housekeeping;
+    housekeeping.SetKeepAliveInterval(30000);
+
+    // Not playing yet: nothing due
+    ASSERT_TRUE(housekeeping.OnTick(1000, true, false) == ClientHousekeeping::Action::NONE);
+
+    // The first tick after PLAY starts the interval
+    ASSERT_TRUE(housekeeping.OnTick(2000, true, true) == ClientHousekeeping::Action::NONE);
+    ASSERT_TRUE(housekeeping.OnTick(31999, true, true) == ClientHousekeeping::Action::NONE);
+    ASSERT_TRUE(housekeeping.OnTick(32000, true, true) == ClientHousekeeping::Action::KEEP_ALIVE);
+
+    // Once per interval, however often the tick runs
+    ASSERT_TRUE(housekeeping.OnTick(32500, true, true) == ClientHousekeeping::Action::NONE);
+    ASSERT_TRUE(housekeeping.OnTick(62000, true, true) == ClientHousekeeping::Action::KEEP_ALIVE);
+
+    // A late tick sends one keep-alive, not one per missed interval
+    ASSERT_TRUE(housekeeping.OnTick(200000, true, true) == ClientHousekeeping::Action::KEEP_ALIVE);
+    ASSERT_TRUE(housekeeping.OnTick(200001, true, true) == ClientHousekeeping::Action::NONE);
+
+    // Disabled
+    housekeeping.SetKeepAliveInterval(0);
+    ASSERT_TRUE(housekeeping.OnTick(500000, true, true) == ClientHousekeeping::Action::NONE);
+}
+
+void test_reconnect_backoff()
+{
+    ClientHousekeeping housekeeping;
+    housekeeping.SetReconnectInterval(1000, 5000);
+
+    // Connection lost: first attempt right away, none while it runs
+    ASSERT_TRUE(housekeeping.OnTick(10000, false, false) == ClientHousekeeping::Action::RECONNECT);
+    ASSERT_TRUE(housekeeping.OnTick(10500, false, false) == ClientHousekeeping::Action::NONE);
+
+    // Failed attempts back off 1 s, 2 s, 4 s, then stay at the 5 s maximum
+    int64_t now = 10000;
+    const int64_t expected[] = {1000, 2000, 4000, 5000, 5000};
+    for (int64_t delay : expected) {
+        housekeeping.OnReconnectResult(now, false);
+        ASSERT_EQ(delay, housekeeping.GetReconnectDelay());
+        ASSERT_TRUE(housekeeping.OnTick(now + delay - 1, false, false) == ClientHousekeeping::Action::NONE);
+        now += delay;
+        ASSERT_TRUE(housekeeping.OnTick(now, false, false) == ClientHousekeeping::Action::RECONNECT);
+    }
+
+    // Success resets the backoff, the next loss retries at once
+    housekeeping.OnReconnectResult(now, true);
+    ASSERT_EQ(1000, housekeeping.GetReconnectDelay());
+    ASSERT_TRUE(housekeeping.OnTick(now + 10, true, true) == ClientHousekeeping::Action::NONE);
+    ASSERT_TRUE(housekeeping.OnTick(now + 20, false, false) == ClientHousekeeping::Action::RECONNECT);
+
+    // Disabled
+    ClientHousekeeping disabled;
+    disabled.SetReconnectInterval(0, 0);
+    ASSERT_TRUE(disabled.OnTick(1000, false, false) == ClientHousekeeping::Action::NONE);
+}
+
+#ifdef __linux__
+void test_ssrc_demux()
+{
+    auto &runtime = RtspClientRuntime::GetInstance();
+    uint16_t port = FreeUdpPort();
+
+    std::atomic<int> first{0};
+    std::atomic<int> second{0};
+    std::atomic<int> other{0};
+    auto a = runtime.AddReceiver(port, RtspClientRuntime::PacketType::RTP, 0x1111, [&](auto) { first++; });
+    auto b = runtime.AddReceiver(port, RtspClientRuntime::PacketType::RTP, 0x2222, [&](auto) { second++; });
+    auto c = runtime.AddReceiver(port, RtspClientRuntime::PacketType::RTP, 0, [&](auto) { other++; });
+    ASSERT_TRUE(a != 0 && b != 0 && c != 0);
+
+    // One receiver per port and SSRC
+    ASSERT_EQ(0u, runtime.AddReceiver(port, RtspClientRuntime::PacketType::RTP, 0x1111, [](auto) {}));
+
+    UdpSender sender;
+    for (uint16_t seq = 0; seq < 10; ++seq) {
+        sender.SendRtp(port, 0x1111, seq);
+        sender.SendRtp(port, 0x2222, seq);
+        sender.SendRtp(port, 0x3333, seq); // Unclaimed SSRC goes to the catch-all receiver
+    }
+    ASSERT_TRUE(WaitFor([&]() { return first == 10 && second == 10 && other == 10; }));
+
+    runtime.RemoveReceiver(a);
+    runtime.RemoveReceiver(b);
+    runtime.RemoveReceiver(c);
+}
+
+void test_receivers_change_while_receiving()
+{
+    auto &runtime = RtspClientRuntime::GetInstance();
+    uint16_t port = FreeUdpPort();
+
+    // Keeps the socket open while the receivers under test come and go
+    std::atomic<int> anchor{0};
+    auto anchorId = runtime.AddReceiver(port, RtspClientRuntime::PacketType::RTP, 0, [&](auto) { anchor++; });
+    ASSERT_TRUE(anchorId != 0);
+
+    std::atomic<bool> running{true};
+    std::thread sendThread([&]() {
+        UdpSender sender;
+        uint16_t seq = 0;
+        while (running) {
+            sender.SendRtp(port, 0x1000 + seq % 4, seq);
+            seq++;
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+    });
+
+    bool callAfterRemove = false;
+    for (int round = 0; round < 50; ++round) {
+        auto state = std::make_shared<std::atomic<int>>(0); // 0 added, 1 removed, 2 called after removal
+        auto id = runtime.AddReceiver(port, RtspClientRuntime::PacketType::RTP, 0x1000 + round % 4,
+                                      [state](auto) {
+                                          if (*state != 0) {
+                                              *state = 2;
+                                          }
+                                      });
+        ASSERT_TRUE(id != 0);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        runtime.RemoveReceiver(id);
+        *state = 1;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        callAfterRemove = callAfterRemove || *state == 2;
+    }
+
+    running = false;
+    sendThread.join();
+    ASSERT_FALSE(callAfterRemove);
+    ASSERT_TRUE(anchor > 0);
+
+    // The last receiver closes the socket, the port can be taken again
+    runtime.RemoveReceiver(anchorId);
+    auto again = runtime.AddReceiver(port, RtspClientRuntime::PacketType::RTCP, 0, [](auto) {});
+    ASSERT_TRUE(again != 0);
+    runtime.RemoveReceiver(again);
+}
+
+void test_shared_transport_demux()
+{
+    uint16_t port = FreeUdpPort();
+
+    TransportConfig config;
+    config.mode = TransportConfig::Mode::SINK;
+    config.backend = TransportConfig::Backend::SHARED;
+    config.client_rtp_port = port;
+
+    // Two sessions on one port pair, told apart by the SSRC their SETUP announced
+    auto listenerA = std::make_shared<CountingListener>();
+    auto listenerB = std::make_shared<CountingListener>();
+    SharedUdpTransportAdapter a;
+    SharedUdpTransportAdapter b;
+    a.SetExpectedSsrc(0xAAAA);
+    b.SetExpectedSsrc(0xBBBB);
+    a.SetOnDataListener(listenerA);
+    b.SetOnDataListener(listenerB);
+    ASSERT_TRUE(a.Setup(config));
+    ASSERT_TRUE(b.Setup(config));
+
+    // A third session expecting a taken SSRC cannot join
+    SharedUdpTransportAdapter c;
+    c.SetExpectedSsrc(0xAAAA);
+    ASSERT_FALSE(c.Setup(config));
+    ASSERT_FALSE(c.IsActive());
+
+    UdpSender sender;
+    for (uint16_t seq = 0; seq < 5; ++seq) {
+        sender.SendRtp(port, 0xAAAA, seq);
+        sender.SendRtp(port, 0xBBBB, seq);
+    }
+    ASSERT_TRUE(WaitFor([&]() { return listenerA->Ssrcs().size() == 5 && listenerB->Ssrcs().size() == 5; }));
+    for (uint32_t ssrc : listenerA->Ssrcs()) {
+        ASSERT_EQ(0xAAAAu, ssrc);
+    }
+    for (uint32_t ssrc : listenerB->Ssrcs()) {
+        ASSERT_EQ(0xBBBBu, ssrc);
+    }
+
+    // A closed session stops receiving, the other keeps its stream
+    a.Close();
+    sender.SendRtp(port, 0xAAAA, 5);
+    sender.SendRtp(port, 0xBBBB, 5);
+    ASSERT_TRUE(WaitFor([&]() { return listenerB->Ssrcs().size() == 6; }));
+    ASSERT_EQ(5u, listenerA->Ssrcs().size());
+    b.Close();
+}
+#endif
+
+void test_shared_timer()
+{
+    // The runtime creates its timer from the clock on first use, which happens here
+    auto clock = std::make_shared<SimulatedClock>();
+    Clock::Set(clock);
+    auto &runtime = RtspClientRuntime::GetInstance();
+
+    int runs = 0;
+    auto timer = runtime.CreateTimer();
+    ASSERT_TRUE(timer != nullptr);
+    ASSERT_TRUE(timer->ScheduleRepeating([&]() { runs++; }, 5) != 0);
+    clock->Advance(15000);
+    ASSERT_EQ(3, runs);
+
+    // Destroying the timer cancels its tasks, a second timer keeps running on the same thread
+    int otherRuns = 0;
+    auto other = runtime.CreateTimer();
+    other->ScheduleRepeating([&]() { otherRuns++; }, 5);
+    timer.reset();
+    clock->Advance(15000);
+    ASSERT_EQ(3, runs);
+    ASSERT_EQ(3, otherRuns);
+
+    // The timer stays valid while a SharedTimer holds it, even after the clock is replaced
+    Clock::Set(nullptr);
+    clock->Advance(5000);
+    ASSERT_EQ(4, otherRuns);
+    other.reset();
+}
+
+int main()
+{
+    TestSuite suite("RTSP Client Runtime Tests");
+
+    suite.AddTest("Keep-Alive Schedule", test_keep_alive_schedule);
+    suite.AddTest("Reconnect Backoff", test_reconnect_backoff);
+#ifdef __linux__
+    suite.AddTest("SSRC Demux", test_ssrc_demux);
+    suite.AddTest("Receivers Change While Receiving", test_receivers_change_while_receiving);
+    suite.AddTest("Shared Transport Demux", test_shared_transport_demux);
+#endif
+    suite.AddTest("Shared Timer", test_shared_timer);
+
+    bool success = suite.RunAll();
+    return success ? 0 : 1;
+}
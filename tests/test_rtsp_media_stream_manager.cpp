@@ -0,0 +1,114 @@
+/**
+ * @author SHAO Liming <lmshao@163.com>
+ * @copyright Copyright (c) 2025 SHAO Liming
+ * @license MIT
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "lmrtsp/rtsp_media_stream_manager.h"
+#include "lmrtsp/transport_config.h"
+#include "rtp/udp_rtp_transport_adapter.h"
+#include "test_framework.h"
+
+using namespace test_framework;
+using namespace lmshao::lmrtsp;
+
+namespace {
+
+TransportConfig MakeUdpConfig()
+{
+    TransportConfig config;
+    config.type = TransportConfig::Type::UDP;
+    config.mode = TransportConfig::Mode::SOURCE;
+    config.client_ip = "127.0.0.1";
+    config.client_rtp_port = 50000;
+    config.client_rtcp_port = 50001;
+    return config;
+}
+
+// The server_port of a Transport header, 0 if there is none
+uint16_t ServerRtpPort(const std::string &transport)
+{
+    size_t pos = transport.find("server_port=");
+    return pos == std::string::npos ? 0 : static_cast<uint16_t>(std::stoi(transport.substr(pos + 12)));
+}
+
+// Whether a UDP socket is currently bound to the loopback or wildcard port
+bool IsPortBound(uint16_t port)
+{
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    bool bound = bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0;
+    close(fd);
+    return bound;
+}
+
+} // namespace
+
+void test_rtp_session_follows_play_pause()
+{
+    RtspMediaStreamManager manager{std::weak_ptr<RtspServerSession>()};
+
+    // SETUP only reserves the ports for the response, no sockets yet
+    ASSERT_TRUE(manager.Setup(MakeUdpConfig()));
+    uint16_t port = ServerRtpPort(manager.GetTransportInfo());
+    ASSERT_TRUE(port != 0);
+    ASSERT_FALSE(manager.HasRtpSession());
+    ASSERT_FALSE(IsPortBound(port));
+
+    ASSERT_TRUE(manager.Play());
+    ASSERT_TRUE(manager.HasRtpSession());
+    ASSERT_TRUE(IsPortBound(port));
+
+    // PAUSE closes the sockets but keeps the ports of the SETUP response
+    ASSERT_TRUE(manager.Pause());
+    ASSERT_FALSE(manager.HasRtpSession());
+    ASSERT_FALSE(IsPortBound(port));
+
+    ASSERT_TRUE(manager.Play());
+    ASSERT_TRUE(manager.HasRtpSession());
+    ASSERT_EQ(port, ServerRtpPort(manager.GetTransportInfo()));
+    ASSERT_TRUE(IsPortBound(port));
+
+    manager.Teardown();
+    ASSERT_FALSE(manager.HasRtpSession());
+    ASSERT_FALSE(IsPortBound(port));
+}
+
+void test_repeated_setup_releases_ports()
+{
+    {
+        RtspMediaStreamManager manager{std::weak_ptr<RtspServerSession>()};
+        ASSERT_TRUE(manager.Setup(MakeUdpConfig()));
+        ASSERT_TRUE(manager.Setup(MakeUdpConfig()));
+        ASSERT_TRUE(ServerRtpPort(manager.GetTransportInfo()) != 0);
+    }
+
+    // Both reservations are gone once the stream is torn down, so a fresh one can take the same pair again
+    uint16_t port = UdpRtpTransportAdapter::ReservePortPair();
+    ASSERT_TRUE(port != 0);
+    UdpRtpTransportAdapter::ReleasePortPair(port);
+}
+
+int main()
+{
+    TestSuite suite("RTSP Media Stream Manager Tests");
+
+    suite.AddTest("RTP Session Follows Play Pause", test_rtp_session_follows_play_pause);
+    suite.AddTest("Repeated Setup Releases Ports", test_repeated_setup_releases_ports);
+
+    bool success = suite.RunAll();
+    return success ? 0 : 1;
+}
@@ -278,6 +278,37 @@ void test_rtsp_request_malformed_parsing()
     ASSERT_STR_EQ(minimal_request.version_, "RTSP/1.0");
 }
 
+void test_rtsp_request_interned_headers()
+{
+    // Header names match case-insensitively and resolve to the same id
+    std::string request_str = "SETUP rtsp://example.com/stream/track0 RTSP/1.0\r\n"
+                              "cseq: 7\r\n"
+                              "TRANSPORT: RTP/AVP;unicast;client_port=5000-5001\r\n"
+                              "X-Custom: value\r\n"
+                              "\r\n";
+
+    RtspRequest request = RtspRequest::FromString(request_str);
+
+    ASSERT_EQ(7, request.general_header_.GetInt(RtspHeaderId::CSEQ));
+    ASSERT_STR_EQ(request.general_header_.at("CSeq"), "7");
+    ASSERT_STR_EQ(request.general_header_.Get(RtspHeaderId::TRANSPORT), "RTP/AVP;unicast;client_port=5000-5001");
+    ASSERT_TRUE(request.general_header_.find(RtspHeaderId::SESSION) == request.general_header_.end());
+    ASSERT_EQ(0, request.general_header_.GetInt(RtspHeaderId::SESSION));
+
+    // Unknown headers stay in the overflow list
+    ASSERT_EQ(1u, request.requestHeader_.customHeader_.size());
+    ASSERT_STR_EQ(request.requestHeader_.customHeader_[0], "X-Custom: value");
+
+    // Unknown names can be set and found as well, and copies keep their values
+    RtspHeaderMap headers = request.general_header_;
+    headers.Set("X-Accept-Dynamic-Rate", "1");
+    headers.Set(RtspHeaderId::CSEQ, "8");
+    ASSERT_EQ(3u, headers.size());
+    ASSERT_STR_EQ(headers.at("x-accept-dynamic-rate"), "1");
+    ASSERT_STR_EQ(headers.at(RtspHeaderId::CSEQ), "8");
+    ASSERT_STR_EQ(request.general_header_.at(RtspHeaderId::CSEQ), "7");
+}
+
 int main()
 {
     TestSuite suite("RTSP Request Builder Tests");
@@ -297,6 +328,7 @@ int main()
     suite.AddTest("Full Request Parsing", test_rtsp_request_full_parsing);
     suite.AddTest("Round-trip Parsing", test_rtsp_request_roundtrip);
     suite.AddTest("Malformed Request Parsing", test_rtsp_request_malformed_parsing);
+    suite.AddTest("Interned Headers", test_rtsp_request_interned_headers);
 
     bool success = suite.RunAll();
     return success ? 0 : 1;
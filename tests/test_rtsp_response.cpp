@@ -138,6 +138,17 @@ void test_rtsp_response_custom_headers()
     ASSERT_STR_CONTAINS(response_str, "X-Another-Header: another-value");
 }
 
+void test_rtsp_response_retry_after()
+{
+    auto response = RtspResponseFactory::CreateError(StatusCode::NotEnoughBandwidth, 8).SetRetryAfter("5").Build();
+
+    std::string response_str = response.ToString();
+
+    ASSERT_STR_CONTAINS(response_str, "RTSP/1.0 453 Not Enough Bandwidth");
+    ASSERT_STR_CONTAINS(response_str, "CSeq: 8");
+    ASSERT_STR_CONTAINS(response_str, "Retry-After: 5");
+}
+
 void test_rtsp_response_with_body()
 {
     std::string body_content = "packets_received: 1000\r\njitter: 0.01\r\npacket_loss: 0";
@@ -340,6 +351,85 @@ void test_rtsp_response_malformed_parsing()
     ASSERT_EQ(static_cast<int>(minimal_response.status_), 200);
 }
 
+void test_rtsp_response_framing_split()
+{
+    // An SDP body holds blank-line-free CRLFs, only Content-Length tells where it ends
+    std::string sdp = "v=0\r\no=- 1 1 IN IP4 127.0.0.1\r\ns=Test\r\nm=video 0 RTP/AVP 96\r\n";
+    std::string wire = RtspResponseFactory::CreateDescribeOK(2).SetSdp(sdp).Build().ToString();
+    ASSERT_STR_CONTAINS(wire, "Content-Length: " + std::to_string(sdp.size()));
+
+    // Fed a byte at a time, the response completes only with its last byte
+    RtspResponseFramer framer;
+    RtspResponse response;
+    for (size_t i = 0; i + 1 < wire.size(); ++i) {
+        framer.Append(wire.data() + i, 1);
+        ASSERT_FALSE(framer.Next(response));
+    }
+    framer.Append(wire.data() + wire.size() - 1, 1);
+    ASSERT_TRUE(framer.Next(response));
+    ASSERT_EQ(2, response.general_header_.GetInt(RtspHeaderId::CSEQ, -1));
+    ASSERT_TRUE(response.messageBody_.has_value());
+    ASSERT_STR_EQ(sdp, response.messageBody_.value());
+    ASSERT_EQ(0u, framer.BufferedSize());
+}
+
+void test_rtsp_response_framing_pipelined()
+{
+    // Pipelined responses coalesced into one read come out in order, matched by CSeq
+    std::string sdp = "v=0\r\ns=Test\r\n";
+    std::string wire = RtspResponseFactory::CreateOptionsOK(1).Build().ToString() +
+                       RtspResponseFactory::CreateDescribeOK(2).SetSdp(sdp).Build().ToString() +
+                       RtspResponseFactory::CreateSessionNotFound(3).Build().ToString();
+    std::string next = RtspResponseFactory::CreatePlayOK(4).SetSession("ABCD").Build().ToString();
+    wire += next.substr(0, 10); // The start of a fourth response
+
+    RtspResponseFramer framer;
+    framer.Append(wire.data(), wire.size());
+
+    RtspResponse response;
+    ASSERT_TRUE(framer.Next(response));
+    ASSERT_EQ(1, response.general_header_.GetInt(RtspHeaderId::CSEQ, -1));
+    ASSERT_FALSE(response.messageBody_.has_value());
+
+    ASSERT_TRUE(framer.Next(response));
+    ASSERT_EQ(2, response.general_header_.GetInt(RtspHeaderId::CSEQ, -1));
+    ASSERT_STR_EQ(sdp, response.messageBody_.value());
+
+    ASSERT_TRUE(framer.Next(response));
+    ASSERT_EQ(3, response.general_header_.GetInt(RtspHeaderId::CSEQ, -1));
+    ASSERT_EQ(454, static_cast<int>(response.status_));
+
+    ASSERT_FALSE(framer.Next(response));
+    framer.Append(next.data() + 10, next.size() - 10);
+    ASSERT_TRUE(framer.Next(response));
+    ASSERT_EQ(4, response.general_header_.GetInt(RtspHeaderId::CSEQ, -1));
+    ASSERT_FALSE(framer.Next(response));
+}
+
+void test_rtsp_response_framing_resync()
+{
+    // Bytes that do not start a response are dropped up to the next status line
+    std::string wire = "garbage\r\n\r\n" + RtspResponseFactory::CreateOK(7).Build().ToString() +
+                       "trailing junk\r\n\r\n" + RtspResponseFactory::CreateOK(8).Build().ToString();
+
+    RtspResponseFramer framer;
+    framer.Append(wire.data(), wire.size());
+
+    RtspResponse response;
+    ASSERT_TRUE(framer.Next(response));
+    ASSERT_EQ(7, response.general_header_.GetInt(RtspHeaderId::CSEQ, -1));
+    ASSERT_TRUE(framer.Next(response));
+    ASSERT_EQ(8, response.general_header_.GetInt(RtspHeaderId::CSEQ, -1));
+    ASSERT_FALSE(framer.Next(response));
+    ASSERT_EQ(0u, framer.BufferedSize());
+
+    // Nothing recognisable at all: the buffer is cleared instead of growing
+    std::string junk = "not rtsp\r\n\r\n";
+    framer.Append(junk.data(), junk.size());
+    ASSERT_FALSE(framer.Next(response));
+    ASSERT_EQ(0u, framer.BufferedSize());
+}
+
 int main()
 {
     TestSuite suite("RTSP Response Builder Tests");
@@ -352,6 +442,7 @@ int main()
     suite.AddTest("Factory PLAY OK", test_rtsp_response_factory_play_ok);
     suite.AddTest("Error Codes", test_rtsp_response_error_codes);
     suite.AddTest("Custom Headers", test_rtsp_response_custom_headers);
+    suite.AddTest("Retry-After Header", test_rtsp_response_retry_after);
     suite.AddTest("Response with Body", test_rtsp_response_with_body);
     suite.AddTest("Unauthorized with Auth", test_rtsp_response_unauthorized_with_auth);
     suite.AddTest("Status Code Coverage", test_rtsp_response_status_code_coverage);
@@ -360,6 +451,9 @@ int main()
     suite.AddTest("Round-trip Parsing", test_rtsp_response_roundtrip);
     suite.AddTest("Error Response Parsing", test_rtsp_response_error_parsing);
     suite.AddTest("Malformed Response Parsing", test_rtsp_response_malformed_parsing);
+    suite.AddTest("Framing Split Response", test_rtsp_response_framing_split);
+    suite.AddTest("Framing Pipelined Responses", test_rtsp_response_framing_pipelined);
+    suite.AddTest("Framing Resync", test_rtsp_response_framing_resync);
 
     bool success = suite.RunAll();
     return success ? 0 : 1;
@@ -0,0 +1,255 @@
+/**
+ * @author SHAO Liming <lmshao@163.com>
+ * @copyright Copyright (c) 2025 SHAO Liming
+ * @license MIT
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "bit_writer.h"
+#include "lmrtsp/frame_classifier.h"
+#include "lmrtsp/h264_parser.h"
+#include "lmrtsp/h265_parser.h"
+#include "test_framework.h"
+
+using namespace test_framework;
+using namespace lmshao::lmrtsp;
+using test_support::BitWriter;
+
+namespace {
+
+std::shared_ptr<lmshao::lmcore::DataBuffer> MakeH264Slice(uint8_t nal_ref_idc, uint8_t nal_unit_type,
+                                                          uint32_t first_mb, uint32_t slice_type, uint32_t pps_id)
+{
+    BitWriter w;
+    w.Bits(0, 1);             // forbidden_zero_bit
+    w.Bits(nal_ref_idc, 2);   // nal_ref_idc
+    w.Bits(nal_unit_type, 5); // nal_unit_type
+    w.UE(first_mb);           // first_mb_in_slice
+    w.UE(slice_type);         // slice_type
+    w.UE(pps_id);             // pic_parameter_set_id
+    w.UE(0);                  // frame_num, the parser stops before it
+    return w.Finish();
+}
+
+std::shared_ptr<lmshao::lmcore::DataBuffer> MakeH265Slice(uint8_t nal_unit_type, uint8_t temporal_id, bool first,
+                                                          uint32_t extra_bits, uint32_t slice_type)
+{
+    BitWriter w;
+    w.Bits(0, 1);               // forbidden_zero_bit
+    w.Bits(nal_unit_type, 6);   // nal_unit_type
+    w.Bits(0, 6);               // nuh_layer_id
+    w.Bits(temporal_id + 1, 3); // nuh_temporal_id_plus1
+    w.Bits(first ? 1 : 0, 1);   // first_slice_segment_in_pic_flag
+    if (nal_unit_type >= 16) {
+        w.Bits(0, 1); // no_output_of_prior_pics_flag
+    }
+    w.UE(3); // slice_pic_parameter_set_id
+    if (first) {
+        w.Bits(0x5, extra_bits); // slice_reserved_flag[]
+        w.UE(slice_type);        // slice_type
+    } else {
+        w.Bits(0x2A, 6); // slice_segment_address, length depends on the SPS
+    }
+    return w.Finish();
+}
+
+H264SliceHeader ParseH264(const std::shared_ptr<lmshao::lmcore::DataBuffer> &nalu)
+{
+    return H264Parser::ParseSliceHeader(nalu->Data(), nalu->Size());
+}
+
+} // namespace
+
+void test_h264_slice_types()
+{
+    H264SliceHeader idr = ParseH264(MakeH264Slice(3, 5, 0, 7, 0));
+    ASSERT_TRUE(idr.valid);
+    ASSERT_EQ(5, idr.nal_unit_type);
+    ASSERT_EQ(3, idr.nal_ref_idc);
+    ASSERT_EQ(0u, idr.first_mb_in_slice);
+    ASSERT_EQ(2, idr.slice_type);
+
+    H264SliceHeader p = ParseH264(MakeH264Slice(2, 1, 0, 0, 1));
+    ASSERT_TRUE(p.valid);
+    ASSERT_EQ(0, p.slice_type);
+    ASSERT_EQ(1u, p.pic_parameter_set_id);
+
+    // Non-reference B slice, second slice of the picture
+    H264SliceHeader b = ParseH264(MakeH264Slice(0, 1, 396, 6, 0));
+    ASSERT_TRUE(b.valid);
+    ASSERT_EQ(0, b.nal_ref_idc);
+    ASSERT_EQ(396u, b.first_mb_in_slice);
+    ASSERT_EQ(1, b.slice_type);
+
+    // Start code is skipped
+    auto slice = MakeH264Slice(2, 1, 0, 5, 0);
+    std::vector<uint8_t> annexb = {0x00, 0x00, 0x00, 0x01};
+    annexb.insert(annexb.end(), slice->Data(), slice->Data() + slice->Size());
+    H264SliceHeader with_start_code = H264Parser::ParseSliceHeader(annexb.data(), annexb.size());
+    ASSERT_TRUE(with_start_code.valid);
+    ASSERT_EQ(0, with_start_code.slice_type);
+
+    // SPS, SEI and other NAL units carry no slice header
+    ASSERT_FALSE(ParseH264(MakeH264Slice(3, 7, 0, 0, 0)).valid);
+    ASSERT_FALSE(ParseH264(MakeH264Slice(0, 6, 0, 0, 0)).valid);
+    ASSERT_FALSE(ParseH264(MakeH264Slice(2, 1, 0, 10, 0)).valid);
+}
+
+void test_h264_slice_escaped_and_truncated()
+{
+    // Codes with more than 16 leading zeros take the slow path of the reader
+    BitWriter w;
+    w.Bits(0x41, 8); // NAL header, nal_ref_idc 2, non-IDR
+    w.UE(131071);    // first_mb_in_slice, 17 leading zeros
+    w.UE(2);         // slice_type
+    w.UE(0);         // pic_parameter_set_id
+    H264SliceHeader long_code = ParseH264(w.Finish());
+    ASSERT_TRUE(long_code.valid);
+    ASSERT_EQ(131071u, long_code.first_mb_in_slice);
+    ASSERT_EQ(2, long_code.slice_type);
+
+    // The leading zeros of first_mb_in_slice put an emulation prevention byte inside the header
+    BitWriter escaped;
+    escaped.Bits(0x01, 8); // NAL header, nal_ref_idc 0, non-IDR
+    escaped.UE(4194303);   // first_mb_in_slice, 22 leading zeros
+    escaped.UE(0);         // slice_type
+    escaped.UE(0);         // pic_parameter_set_id
+    auto nalu = escaped.Finish();
+    bool has_escape = false;
+    for (size_t i = 2; i < nalu->Size(); ++i) {
+        if (nalu->Data()[i] == 0x03 && nalu->Data()[i - 1] == 0 && nalu->Data()[i - 2] == 0) {
+            has_escape = true;
+        }
+    }
+    ASSERT_TRUE(has_escape);
+    H264SliceHeader header = ParseH264(nalu);
+    ASSERT_TRUE(header.valid);
+    ASSERT_EQ(4194303u, header.first_mb_in_slice);
+    ASSERT_EQ(0, header.slice_type);
+    ASSERT_EQ(0u, header.pic_parameter_set_id);
+
+    // A header cut inside its Exp-Golomb codes must not be accepted
+    auto full = MakeH264Slice(2, 1, 8160, 0, 0);
+    ASSERT_FALSE(H264Parser::ParseSliceHeader(full->Data(), 2).valid);
+    ASSERT_FALSE(H264Parser::ParseSliceHeader(full->Data(), 1).valid);
+    ASSERT_FALSE(H264Parser::ParseSliceHeader(nullptr, 0).valid);
+}
+
+void test_h265_slice_header()
+{
+    BitWriter pps;
+    pps.Bits(34 << 1, 8); // NAL header, PPS
+    pps.Bits(1, 8);       // nuh_temporal_id_plus1
+    pps.UE(3);            // pps_pic_parameter_set_id
+    pps.UE(0);            // pps_seq_parameter_set_id
+    pps.Bits(0, 1);       // dependent_slice_segments_enabled_flag
+    pps.Bits(0, 1);       // output_flag_present_flag
+    pps.Bits(2, 3);       // num_extra_slice_header_bits
+    auto pps_nalu = pps.Finish();
+    int32_t extra_bits = H265Parser::GetNumExtraSliceHeaderBits(pps_nalu);
+    ASSERT_EQ(2, extra_bits);
+
+    auto idr = MakeH265Slice(19, 0, true, 2, 2);
+    H265SliceHeader header = H265Parser::ParseSliceHeader(idr->Data(), idr->Size(), extra_bits);
+    ASSERT_TRUE(header.valid);
+    ASSERT_EQ(19, header.nal_unit_type);
+    ASSERT_TRUE(header.first_slice_segment_in_pic_flag);
+    ASSERT_EQ(3u, header.pic_parameter_set_id);
+    ASSERT_EQ(2, header.slice_type);
+
+    // Ignoring the extra bits would read the reserved flags as slice_type
+    auto trail = MakeH265Slice(1, 2, true, 2, 0);
+    header = H265Parser::ParseSliceHeader(trail->Data(), trail->Size(), extra_bits);
+    ASSERT_TRUE(header.valid);
+    ASSERT_EQ(2, header.temporal_id);
+    ASSERT_EQ(0, header.slice_type);
+
+    // Later slice segments leave slice_type unknown
+    auto segment = MakeH265Slice(1, 0, false, 0, 0);
+    header = H265Parser::ParseSliceHeader(segment->Data(), segment->Size());
+    ASSERT_TRUE(header.valid);
+    ASSERT_FALSE(header.first_slice_segment_in_pic_flag);
+    ASSERT_EQ(-1, header.slice_type);
+
+    // Parameter sets and truncated slices are rejected
+    ASSERT_FALSE(H265Parser::ParseSliceHeader(pps_nalu->Data(), pps_nalu->Size()).valid);
+    ASSERT_FALSE(H265Parser::ParseSliceHeader(idr->Data(), 2, extra_bits).valid);
+    ASSERT_EQ(-1, H265Parser::GetNumExtraSliceHeaderBits(idr));
+}
+
+void test_frame_classification()
+{
+    // Access unit: AUD, SEI, then a non-reference B slice
+    std::vector<uint8_t> access_unit = {0x00, 0x00, 0x00, 0x01, 0x09, 0xF0, 0x00, 0x00, 0x01, 0x06, 0x05, 0x80};
+    auto b_slice = MakeH264Slice(0, 1, 0, 1, 0);
+    access_unit.insert(access_unit.end(), {0x00, 0x00, 0x01});
+    access_unit.insert(access_unit.end(), b_slice->Data(), b_slice->Data() + b_slice->Size());
+
+    FrameClassifier h264(MediaType::H264);
+    VideoParam param;
+    ASSERT_TRUE(h264.Classify(access_unit.data(), access_unit.size(), param));
+    ASSERT_TRUE(param.frame_type == FrameType::B);
+    ASSERT_FALSE(param.is_reference);
+    ASSERT_FALSE(param.is_key_frame);
+
+    // A NAL unit without start code, IDR marks the key frame
+    MediaFrame frame;
+    frame.media_type = MediaType::H264;
+    frame.data = MakeH264Slice(3, 5, 0, 2, 0);
+    ASSERT_TRUE(h264.Classify(frame));
+    ASSERT_TRUE(frame.video_param.frame_type == FrameType::IDR);
+    ASSERT_TRUE(frame.video_param.is_reference);
+    ASSERT_TRUE(frame.video_param.is_key_frame);
+
+    // Parameter sets alone are not classified
+    VideoParam sps_param;
+    std::vector<uint8_t> sps = {0x00, 0x00, 0x01, 0x67, 0x42, 0x00, 0x1E};
+    ASSERT_FALSE(h264.Classify(sps.data(), sps.size(), sps_param));
+    ASSERT_TRUE(sps_param.frame_type == FrameType::UNKNOWN);
+
+    // H.265: the PPS in front sets num_extra_slice_header_bits for the slice behind it
+    BitWriter pps;
+    pps.Bits(34 << 1, 8); // NAL header, PPS
+    pps.Bits(1, 8);       // nuh_temporal_id_plus1
+    pps.UE(3);            // pps_pic_parameter_set_id
+    pps.UE(0);            // pps_seq_parameter_set_id
+    pps.Bits(0, 2);       // dependent_slice_segments_enabled_flag, output_flag_present_flag
+    pps.Bits(2, 3);       // num_extra_slice_header_bits
+    auto pps_nalu = pps.Finish();
+    auto p_slice = MakeH265Slice(0, 2, true, 2, 1);
+    std::vector<uint8_t> h265_unit = {0x00, 0x00, 0x00, 0x01};
+    h265_unit.insert(h265_unit.end(), pps_nalu->Data(), pps_nalu->Data() + pps_nalu->Size());
+    h265_unit.insert(h265_unit.end(), {0x00, 0x00, 0x01});
+    h265_unit.insert(h265_unit.end(), p_slice->Data(), p_slice->Data() + p_slice->Size());
+
+    FrameClassifier h265(MediaType::H265);
+    VideoParam h265_param;
+    ASSERT_TRUE(h265.Classify(h265_unit.data(), h265_unit.size(), h265_param));
+    ASSERT_TRUE(h265_param.frame_type == FrameType::P);
+    ASSERT_FALSE(h265_param.is_reference); // TRAIL_N
+    ASSERT_EQ(2, h265_param.temporal_id);
+
+    auto cra = MakeH265Slice(21, 0, true, 2, 2);
+    ASSERT_TRUE(h265.Classify(cra->Data(), cra->Size(), h265_param));
+    ASSERT_TRUE(h265_param.frame_type == FrameType::IDR);
+    ASSERT_TRUE(h265_param.is_reference);
+    ASSERT_TRUE(h265_param.is_key_frame);
+}
+
+int main()
+{
+    TestSuite suite("Slice Header Tests");
+
+    suite.AddTest("H.264 Slice Types", test_h264_slice_types);
+    suite.AddTest("H.264 Escaped And Truncated Slices", test_h264_slice_escaped_and_truncated);
+    suite.AddTest("H.265 Slice Header", test_h265_slice_header);
+    suite.AddTest("Frame Classification", test_frame_classification);
+
+    bool success = suite.RunAll();
+    return success ? 0 : 1;
+}
@@ -0,0 +1,174 @@
+/**
+ * @author SHAO Liming <lmshao@163.com>
+ * @copyright Copyright (c) 2025 SHAO Liming
+ * @license MIT
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <cstdint>
+#include <vector>
+
+#include "lmrtsp/ts_parser.h"
+#include "test_framework.h"
+
+using namespace test_framework;
+using namespace lmshao::lmrtsp;
+
+namespace {
+
+constexpr uint16_t PMT_PID = 0x1000;
+constexpr uint16_t VIDEO_PID = 0x100;
+constexpr uint16_t AUDIO_PID = 0x101;
+constexpr uint16_t AC3_PID = 0x102;
+constexpr uint16_t NULL_PID = 0x1FFF;
+
+std::vector<uint8_t> MakePacket(uint16_t pid, bool unit_start, uint8_t counter)
+{
+    std::vector<uint8_t> packet(188, 0xFF);
+    packet[0] = 0x47;
+    packet[1] = (unit_start ? 0x40 : 0x00) | ((pid >> 8) & 0x1F);
+    packet[2] = pid & 0xFF;
+    packet[3] = 0x10 | (counter & 0x0F);
+    return packet;
+}
+
+// Wrap a section body (after section_length) into a packet with a valid length and CRC
+std::vector<uint8_t> MakeSectionPacket(uint16_t pid, uint8_t table_id, const std::vector<uint8_t> &body)
+{
+    std::vector<uint8_t> section = {table_id, 0, 0};
+    section.insert(section.end(), body.begin(), body.end());
+    size_t section_length = body.size() + 4;
+    section[1] = 0xB0 | ((section_length >> 8) & 0x0F);
+    section[2] = section_length & 0xFF;
+    uint32_t crc = TSParser::SectionCRC32(section.data(), section.size());
+    section.push_back(crc >> 24);
+    section.push_back(crc >> 16);
+    section.push_back(crc >> 8);
+    section.push_back(crc);
+
+    auto packet = MakePacket(pid, true, 0);
+    packet[4] = 0; // pointer_field
+    std::copy(section.begin(), section.end(), packet.begin() + 5);
+    return packet;
+}
+
+std::vector<uint8_t> MakePat()
+{
+    return MakeSectionPacket(0, 0x00,
+                             {0x00, 0x01, 0xC1, 0x00, 0x00, 0x00, 0x01, 0xE0 | (PMT_PID >> 8), PMT_PID & 0xFF});
+}
+
+std::vector<uint8_t> MakePmt()
+{
+    return MakeSectionPacket(PMT_PID, 0x02,
+                             {0x00, 0x01, 0xC1, 0x00, 0x00, 0xE0 | (VIDEO_PID >> 8), VIDEO_PID & 0xFF, 0xF0, 0x00,
+                              // H.264, AAC, and AC-3 with a 2-byte descriptor
+                              0x1B, 0xE0 | (VIDEO_PID >> 8), VIDEO_PID & 0xFF, 0xF0, 0x00, 0x0F,
+                              0xE0 | (AUDIO_PID >> 8), AUDIO_PID & 0xFF, 0xF0, 0x00, 0x81, 0xE0 | (AC3_PID >> 8),
+                              AC3_PID & 0xFF, 0xF0, 0x02, 0x05, 0x00});
+}
+
+uint16_t PidOf(const uint8_t *packet)
+{
+    return ((packet[1] & 0x1F) << 8) | packet[2];
+}
+
+std::vector<uint8_t> MakeStream()
+{
+    std::vector<uint8_t> stream;
+    auto append = [&stream](const std::vector<uint8_t> &packet) {
+        stream.insert(stream.end(), packet.begin(), packet.end());
+    };
+    append(MakePat());
+    append(MakePmt());
+    append(MakePacket(VIDEO_PID, true, 0));
+    append(MakePacket(NULL_PID, false, 0));
+    append(MakePacket(AUDIO_PID, true, 0));
+    append(MakePacket(AC3_PID, true, 0));
+    append(MakePacket(NULL_PID, false, 0));
+    append(MakePacket(VIDEO_PID, false, 1));
+    return stream;
+}
+
+} // namespace
+
+void test_parse_psi()
+{
+    std::vector<uint16_t> pmt_pids;
+    ASSERT_TRUE(TSParser::ParsePAT(MakePat().data(), pmt_pids));
+    ASSERT_EQ(1u, pmt_pids.size());
+    ASSERT_EQ(PMT_PID, pmt_pids[0]);
+
+    TSProgramMap program;
+    ASSERT_TRUE(TSParser::ParsePMT(MakePmt().data(), program));
+    ASSERT_EQ(1, program.program_number);
+    ASSERT_EQ(VIDEO_PID, program.pcr_pid);
+    ASSERT_EQ(3u, program.streams.size());
+    ASSERT_EQ(0x81, program.streams[2].stream_type);
+    ASSERT_EQ(AC3_PID, program.streams[2].pid);
+
+    // A corrupted section fails its CRC
+    auto pmt = MakePmt();
+    pmt[20] ^= 0x01;
+    ASSERT_FALSE(TSParser::ParsePMT(pmt.data(), program));
+}
+
+void test_drop_null_packets()
+{
+    TSFilterConfig config;
+    config.drop_null_packets = true;
+    TSRemuxer remuxer(config);
+
+    auto stream = MakeStream();
+    std::vector<uint8_t> out(stream.size());
+    size_t size = remuxer.Filter(stream.data(), stream.size(), out.data());
+
+    ASSERT_EQ(6u * 188, size);
+    ASSERT_EQ(2u, remuxer.GetDroppedPackets());
+    for (size_t offset = 0; offset < size; offset += 188) {
+        ASSERT_TRUE(PidOf(out.data() + offset) != NULL_PID);
+    }
+}
+
+void test_select_stream_types()
+{
+    TSFilterConfig config;
+    config.drop_null_packets = true;
+    config.stream_types = {0x1B, 0x0F};
+    TSRemuxer remuxer(config);
+
+    auto stream = MakeStream();
+    std::vector<uint8_t> out(stream.size());
+    size_t size = remuxer.Filter(stream.data(), stream.size(), out.data());
+
+    // PAT, PMT, video, audio, video
+    ASSERT_EQ(5u * 188, size);
+    ASSERT_EQ(3u, remuxer.GetDroppedPackets());
+    ASSERT_EQ(AUDIO_PID, PidOf(out.data() + 3 * 188));
+
+    // The rewritten PMT lists the kept streams and carries a valid CRC
+    TSProgramMap program;
+    ASSERT_TRUE(TSParser::ParsePMT(out.data() + 188, program));
+    ASSERT_EQ(2u, program.streams.size());
+    ASSERT_EQ(VIDEO_PID, program.streams[0].pid);
+    ASSERT_EQ(AUDIO_PID, program.streams[1].pid);
+
+    // Selecting nothing present keeps the program unfiltered
+    config.stream_types = {0x24};
+    TSRemuxer unmatched(config);
+    size = unmatched.Filter(stream.data(), stream.size(), out.data());
+    ASSERT_EQ(6u * 188, size);
+}
+
+int main()
+{
+    TestSuite suite("TS Remux Tests");
+
+    suite.AddTest("Parse PSI", test_parse_psi);
+    suite.AddTest("Drop Null Packets", test_drop_null_packets);
+    suite.AddTest("Select Stream Types", test_select_stream_types);
+
+    bool success = suite.RunAll();
+    return success ? 0 : 1;
+}
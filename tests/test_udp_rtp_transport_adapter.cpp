@@ -0,0 +1,222 @@
+/**
+ * @author SHAO Liming <lmshao@163.com>
+ * @copyright Copyright (c) 2025 SHAO Liming
+ * @license MIT
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <cstdint>
+#include <vector>
+
+#ifdef __linux__
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+#endif
+
+#include "lmrtsp/clock.h"
+#include "rtp/udp_rtp_transport_adapter.h"
+#include "test_framework.h"
+
+using namespace test_framework;
+using namespace lmshao::lmrtsp;
+
+namespace {
+#ifdef __linux__
+// Loopback socket standing in for the RTSP client
+class UdpReceiver {
+public:
+    UdpReceiver() : fd_(socket(AF_INET, SOCK_DGRAM, 0))
+    {
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        bind(fd_, reinterpret_cast<sockaddr *>(&addr), sizeof(addr));
+        socklen_t len = sizeof(addr);
+        getsockname(fd_, reinterpret_cast<sockaddr *>(&addr), &len);
+        port_ = ntohs(addr.sin_port);
+
+        timeval timeout{1, 0};
+        setsockopt(fd_, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    }
+    ~UdpReceiver() { close(fd_); }
+
+    uint16_t Port() const { return port_; }
+
+    // First byte of each datagram received, waiting up to a second for the first one
+    std::vector<uint8_t> Receive(size_t count)
+    {
+        std::vector<uint8_t> ids;
+        uint8_t buffer[1500];
+        while (ids.size() < count && recv(fd_, buffer, sizeof(buffer), 0) > 0) {
+            ids.push_back(buffer[0]);
+        }
+        return ids;
+    }
+
+    bool Pending()
+    {
+        uint8_t buffer[1500];
+        return recv(fd_, buffer, sizeof(buffer), MSG_DONTWAIT | MSG_PEEK) > 0;
+    }
+
+private:
+    int fd_;
+    uint16_t port_ = 0;
+};
+
+uint16_t FreeUdpPort()
+{
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr));
+    socklen_t len = sizeof(addr);
+    getsockname(fd, reinterpret_cast<sockaddr *>(&addr), &len);
+    close(fd);
+    return ntohs(addr.sin_port);
+}
+
+TransportConfig SourceConfig(uint16_t client_port)
+{
+    TransportConfig config;
+    config.type = TransportConfig::Type::UDP;
+    config.mode = TransportConfig::Mode::SOURCE;
+    config.client_ip = "127.0.0.1";
+    config.client_rtp_port = client_port;
+    config.server_rtp_port = FreeUdpPort();
+    return config;
+}
+
+void SendFrame(UdpRtpTransportAdapter &adapter, uint8_t first, uint8_t count)
+{
+    for (uint8_t id = first; id < first + count; ++id) {
+        std::vector<uint8_t> packet(200, id);
+        ASSERT_TRUE(adapter.SendPacket(packet.data(), packet.size()));
+    }
+}
+#endif
+} // namespace
+
+void test_departure_spacing()
+{
+    // Spread evenly over the span from the start
+    ASSERT_EQ(1000, UdpRtpTransportAdapter::PacketDeparture(1000, 900, 0, 3, 0, 0));
+    ASSERT_EQ(1300, UdpRtpTransportAdapter::PacketDeparture(1000, 900, 1, 3, 0, 0));
+    ASSERT_EQ(1600, UdpRtpTransportAdapter::PacketDeparture(1000, 900, 2, 3, 0, 0));
+
+    // Never before the previous departure, never more than a second ahead
+    ASSERT_EQ(1600, UdpRtpTransportAdapter::PacketDeparture(500, 0, 0, 1, 0, 1600));
+    ASSERT_EQ(2000000000, UdpRtpTransportAdapter::PacketDeparture(5000000000, 0, 0, 1, 1000000000, 0));
+}
+
+void test_departure_order()
+{
+    // A frame scheduled to start before the previous one ends keeps the send order
+    int64_t last = 0;
+    std::vector<int64_t> departures;
+    const int64_t starts[] = {1000000, 1500000, 1400000, 3000000};
+    for (int64_t start : starts) {
+        for (size_t i = 0; i < 10; ++i) {
+            last = UdpRtpTransportAdapter::PacketDeparture(start, 1000000, i, 10, 0, last);
+            departures.push_back(last);
+        }
+    }
+    for (size_t i = 1; i < departures.size(); ++i) {
+        ASSERT_TRUE(departures[i] >= departures[i - 1]);
+    }
+    ASSERT_EQ(3000000, departures[30]);
+}
+
+#ifdef __linux__
+void test_hold_until_flush()
+{
+    UdpReceiver receiver;
+    auto config = SourceConfig(receiver.Port());
+    config.batch_send = true;
+
+    UdpRtpTransportAdapter adapter;
+    ASSERT_TRUE(adapter.Setup(config));
+
+    // Nothing leaves before Flush, then the whole frame in order
+    SendFrame(adapter, 1, 8);
+    ASSERT_FALSE(receiver.Pending());
+    adapter.Flush();
+    ASSERT_TRUE(receiver.Receive(8) == std::vector<uint8_t>({1, 2, 3, 4, 5, 6, 7, 8}));
+
+    // The next frame reuses the buffers
+    SendFrame(adapter, 9, 3);
+    ASSERT_FALSE(receiver.Pending());
+    adapter.Flush();
+    ASSERT_TRUE(receiver.Receive(3) == std::vector<uint8_t>({9, 10, 11}));
+    adapter.Close();
+}
+
+void test_kernel_pacing_off()
+{
+    UdpReceiver receiver;
+    UdpRtpTransportAdapter adapter;
+    ASSERT_TRUE(adapter.Setup(SourceConfig(receiver.Port())));
+    ASSERT_FALSE(adapter.HasKernelPacing());
+
+    // Without kernel pacing a departure time is ignored and packets go out as they are sent
+    adapter.SetDeparture(Clock::Get()->MonotonicNs() + 10000000, 10000000);
+    SendFrame(adapter, 1, 4);
+    ASSERT_TRUE(receiver.Receive(4) == std::vector<uint8_t>({1, 2, 3, 4}));
+    adapter.Flush();
+    ASSERT_FALSE(receiver.Pending());
+    adapter.Close();
+}
+
+void test_kernel_pacing_loopback()
+{
+    UdpReceiver receiver;
+    auto config = SourceConfig(receiver.Port());
+    config.kernel_pacing = true;
+
+    UdpRtpTransportAdapter adapter;
+    ASSERT_TRUE(adapter.Setup(config));
+    if (!adapter.HasKernelPacing()) {
+        // No SO_TXTIME here: the userspace fallback sends at once
+        adapter.SetDeparture(Clock::Get()->MonotonicNs(), 1000000);
+        SendFrame(adapter, 1, 4);
+        ASSERT_TRUE(receiver.Receive(4) == std::vector<uint8_t>({1, 2, 3, 4}));
+        adapter.Close();
+        return;
+    }
+
+    // Held until Flush stamps the departures, loopback has no fq qdisc so they arrive at once, in order
+    for (uint8_t frame = 0; frame < 3; ++frame) {
+        adapter.SetDeparture(Clock::Get()->MonotonicNs(), 1000000);
+        SendFrame(adapter, frame * 10, 5);
+        ASSERT_FALSE(receiver.Pending());
+        adapter.Flush();
+        std::vector<uint8_t> expected;
+        for (uint8_t id = frame * 10; id < frame * 10 + 5; ++id) {
+            expected.push_back(id);
+        }
+        ASSERT_TRUE(receiver.Receive(5) == expected);
+        ASSERT_TRUE(adapter.HasKernelPacing());
+    }
+    adapter.Close();
+}
+#endif
+
+int main()
+{
+    TestSuite suite("UDP RTP Transport Adapter Tests");
+
+    suite.AddTest("Departure Spacing", test_departure_spacing);
+    suite.AddTest("Departure Order", test_departure_order);
+#ifdef __linux__
+    suite.AddTest("Hold Until Flush", test_hold_until_flush);
+    suite.AddTest("Kernel Pacing Off", test_kernel_pacing_off);
+    suite.AddTest("Kernel Pacing Loopback", test_kernel_pacing_loopback);
+#endif
+
+    bool success = suite.RunAll();
+    return success ? 0 : 1;
+}
@@ -0,0 +1,277 @@
+/**
+ * @author SHAO Liming <lmshao@163.com>
+ * @copyright Copyright (c) 2025 SHAO Liming
+ * @license MIT
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <lmcore/data_buffer.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "bit_writer.h"
+#include "lmrtsp/h264_parser.h"
+#include "lmrtsp/h265_parser.h"
+#include "test_framework.h"
+
+using namespace test_framework;
+using namespace lmshao::lmrtsp;
+using test_support::BitWriter;
+
+namespace {
+
+// 320x240 Baseline SPS at 60000/1001 ticks per second with NAL HRD parameters and pic_struct
+std::shared_ptr<lmshao::lmcore::DataBuffer> MakeH264Sps(bool pic_struct_present)
+{
+    BitWriter w;
+    w.Bits(0x67, 8); // NAL header, SPS
+    w.Bits(66, 8);   // profile_idc
+    w.Bits(0, 8);    // constraint flags
+    w.Bits(30, 8);   // level_idc
+    w.UE(0);         // seq_parameter_set_id
+    w.UE(0);         // log2_max_frame_num_minus4
+    w.UE(2);         // pic_order_cnt_type
+    w.UE(1);         // max_num_ref_frames
+    w.Bits(0, 1);    // gaps_in_frame_num_value_allowed_flag
+    w.UE(19);        // pic_width_in_mbs_minus1
+    w.UE(14);        // pic_height_in_map_units_minus1
+    w.Bits(1, 1);    // frame_mbs_only_flag
+    w.Bits(1, 1);    // direct_8x8_inference_flag
+    w.Bits(0, 1);    // frame_cropping_flag
+    w.Bits(1, 1);    // vui_parameters_present_flag
+
+    w.Bits(1, 1);      // aspect_ratio_info_present_flag
+    w.Bits(255, 8);    // Extended_SAR
+    w.Bits(1, 16);     // sar_width
+    w.Bits(1, 16);     // sar_height
+    w.Bits(0, 1);      // overscan_info_present_flag
+    w.Bits(1, 1);      // video_signal_type_present_flag
+    w.Bits(5, 3);      // video_format
+    w.Bits(0, 1);      // video_full_range_flag
+    w.Bits(0, 1);      // colour_description_present_flag
+    w.Bits(0, 1);      // chroma_loc_info_present_flag
+    w.Bits(1, 1);      // timing_info_present_flag
+    w.Bits(1001, 32);  // num_units_in_tick
+    w.Bits(60000, 32); // time_scale
+    w.Bits(1, 1);      // fixed_frame_rate_flag
+    w.Bits(1, 1);      // nal_hrd_parameters_present_flag
+    w.UE(0);           // cpb_cnt_minus1
+    w.Bits(0, 4);      // bit_rate_scale
+    w.Bits(0, 4);      // cpb_size_scale
+    w.UE(1000);        // bit_rate_value_minus1
+    w.UE(2000);        // cpb_size_value_minus1
+    w.Bits(0, 1);      // cbr_flag
+    w.Bits(23, 5);     // initial_cpb_removal_delay_length_minus1
+    w.Bits(9, 5);      // cpb_removal_delay_length_minus1
+    w.Bits(4, 5);      // dpb_output_delay_length_minus1
+    w.Bits(0, 5);      // time_offset_length
+    w.Bits(0, 1);      // vcl_hrd_parameters_present_flag
+    w.Bits(0, 1);      // low_delay_hrd_flag
+    w.Bits(pic_struct_present ? 1 : 0, 1);
+    w.Bits(0, 1); // bitstream_restriction_flag
+    return w.Finish();
+}
+
+std::shared_ptr<lmshao::lmcore::DataBuffer> MakePicTimingSei(uint32_t pic_struct)
+{
+    BitWriter w;
+    w.Bits(0x06, 8); // NAL header, SEI
+    w.Bits(5, 8);    // payloadType, user_data_unregistered ahead of the picture timing
+    w.Bits(17, 8);   // payloadSize
+    w.Bits(0, 32);
+    w.Bits(0, 32);
+    w.Bits(0, 32);
+    w.Bits(0, 32);
+    w.Bits(0, 8);
+    w.Bits(1, 8);  // payloadType, pic_timing
+    w.Bits(3, 8);  // payloadSize
+    w.Bits(7, 10); // cpb_removal_delay
+    w.Bits(2, 5);  // dpb_output_delay
+    w.Bits(pic_struct, 4);
+    w.Bits(0, 5); // clock_timestamp_flag for up to 3 fields, then alignment
+    return w.Finish();
+}
+
+void WriteProfileTierLevel(BitWriter &w)
+{
+    w.Bits(0, 2); // general_profile_space
+    w.Bits(0, 1); // general_tier_flag
+    w.Bits(1, 5); // general_profile_idc, Main
+    w.Bits(0x60000000, 32);
+    w.Bits(0x9, 4); // progressive, interlaced, non_packed, frame_only
+    w.Bits(0, 32);
+    w.Bits(0, 11);
+    w.Bits(0, 1);
+    w.Bits(93, 8); // general_level_idc, 3.1
+}
+
+// 1920x1080 Main SPS with inter-predicted short-term RPS and 30000/1001 VUI timing
+std::shared_ptr<lmshao::lmcore::DataBuffer> MakeH265Sps()
+{
+    BitWriter w;
+    w.Bits(0x4201, 16); // NAL header, SPS
+    w.Bits(0, 4);       // sps_video_parameter_set_id
+    w.Bits(0, 3);       // sps_max_sub_layers_minus1
+    w.Bits(1, 1);       // sps_temporal_id_nesting_flag
+    WriteProfileTierLevel(w);
+    w.UE(0);      // sps_seq_parameter_set_id
+    w.UE(1);      // chroma_format_idc
+    w.UE(1920);   // pic_width_in_luma_samples
+    w.UE(1088);   // pic_height_in_luma_samples
+    w.Bits(1, 1); // conformance_window_flag
+    w.UE(0);
+    w.UE(0);
+    w.UE(0);
+    w.UE(4); // conf_win_bottom_offset, 8 rows
+    w.UE(0); // bit_depth_luma_minus8
+    w.UE(0); // bit_depth_chroma_minus8
+    w.UE(4); // log2_max_pic_order_cnt_lsb_minus4
+    w.Bits(1, 1);
+    w.UE(4); // sps_max_dec_pic_buffering_minus1
+    w.UE(2); // sps_max_num_reorder_pics
+    w.UE(0); // sps_max_latency_increase_plus1
+    w.UE(0);
+    w.UE(3);
+    w.UE(0);
+    w.UE(3);
+    w.UE(1);
+    w.UE(1);
+    w.Bits(1, 1); // scaling_list_enabled_flag
+    w.Bits(1, 1); // sps_scaling_list_data_present_flag
+    for (uint32_t size_id = 0; size_id < 4; size_id++) {
+        for (uint32_t matrix_id = 0; matrix_id < 6; matrix_id += (size_id == 3) ? 3 : 1) {
+            if (size_id == 2 && matrix_id == 1) {
+                w.Bits(1, 1); // Explicit list
+                w.SE(8);      // scaling_list_dc_coef_minus8
+                for (int i = 0; i < 64; i++) {
+                    w.SE(i % 2 ? -1 : 1);
+                }
+            } else {
+                w.Bits(0, 1);
+                w.UE(0);
+            }
+        }
+    }
+    w.Bits(0, 1); // amp_enabled_flag
+    w.Bits(1, 1); // sample_adaptive_offset_enabled_flag
+    w.Bits(1, 1); // pcm_enabled_flag
+    w.Bits(7, 4);
+    w.Bits(7, 4);
+    w.UE(0);
+    w.UE(1);
+    w.Bits(1, 1);
+
+    w.UE(3); // num_short_term_ref_pic_sets
+    // Set 0: S0 = {-1}
+    w.UE(1);
+    w.UE(0);
+    w.UE(0);
+    w.Bits(1, 1);
+    // Set 1, predicted from set 0 with deltaRps = -1: S0 = {-1, -2}
+    w.Bits(1, 1); // inter_ref_pic_set_prediction_flag
+    w.Bits(1, 1); // delta_rps_sign
+    w.UE(0);      // abs_delta_rps_minus1
+    w.Bits(1, 1);
+    w.Bits(1, 1);
+    // Set 2, predicted from set 1 with deltaRps = +1: three entries, the count depends on set 1's derivation
+    w.Bits(1, 1);
+    w.Bits(0, 1);
+    w.UE(0);
+    w.Bits(0, 1); // used_by_curr_pic_flag
+    w.Bits(1, 1); // use_delta_flag
+    w.Bits(1, 1);
+    w.Bits(0, 1);
+    w.Bits(0, 1);
+
+    w.Bits(1, 1); // long_term_ref_pics_present_flag
+    w.UE(1);
+    w.Bits(5, 8); // lt_ref_pic_poc_lsb_sps
+    w.Bits(1, 1);
+    w.Bits(1, 1); // sps_temporal_mvp_enabled_flag
+    w.Bits(1, 1); // strong_intra_smoothing_enabled_flag
+    w.Bits(1, 1); // vui_parameters_present_flag
+
+    w.Bits(0, 1); // aspect_ratio_info_present_flag
+    w.Bits(0, 1); // overscan_info_present_flag
+    w.Bits(0, 1); // video_signal_type_present_flag
+    w.Bits(1, 1); // chroma_loc_info_present_flag
+    w.UE(0);
+    w.UE(0);
+    w.Bits(0, 3);      // neutral_chroma_indication_flag, field_seq_flag, frame_field_info_present_flag
+    w.Bits(0, 1);      // default_display_window_flag
+    w.Bits(1, 1);      // vui_timing_info_present_flag
+    w.Bits(1001, 32);  // vui_num_units_in_tick
+    w.Bits(30000, 32); // vui_time_scale
+    w.Bits(0, 1);      // vui_poc_proportional_to_timing_flag
+    w.Bits(0, 1);      // vui_hrd_parameters_present_flag
+    w.Bits(0, 1);      // bitstream_restriction_flag
+    w.Bits(0, 1);      // sps_extension_present_flag
+    return w.Finish();
+}
+
+} // namespace
+
+void test_h264_vui_timing()
+{
+    H264VideoInfo info = H264Parser::ParseSPS(MakeH264Sps(true));
+    ASSERT_TRUE(info.valid);
+    ASSERT_EQ(320, info.width);
+    ASSERT_EQ(240, info.height);
+    ASSERT_TRUE(info.timing_info_present);
+    ASSERT_EQ(1001u, info.num_units_in_tick);
+    ASSERT_EQ(60000u, info.time_scale);
+    ASSERT_TRUE(info.fixed_frame_rate_flag);
+    ASSERT_TRUE(info.cpb_dpb_delays_present);
+    ASSERT_EQ(10, info.cpb_removal_delay_length);
+    ASSERT_EQ(5, info.dpb_output_delay_length);
+    ASSERT_TRUE(info.pic_struct_present_flag);
+
+    // A truncated SPS keeps its resolution but reports no timing
+    auto sps = MakeH264Sps(true);
+    auto truncated = lmshao::lmcore::DataBuffer::Create(12);
+    truncated->Assign(sps->Data(), 12);
+    info = H264Parser::ParseSPS(truncated);
+    ASSERT_TRUE(info.valid);
+    ASSERT_EQ(320, info.width);
+    ASSERT_FALSE(info.timing_info_present);
+}
+
+void test_h264_pic_timing_sei()
+{
+    H264VideoInfo info = H264Parser::ParseSPS(MakeH264Sps(true));
+    ASSERT_EQ(2, H264Parser::GetPictureTicks(MakePicTimingSei(0), info));
+    ASSERT_EQ(1, H264Parser::GetPictureTicks(MakePicTimingSei(1), info));
+    ASSERT_EQ(3, H264Parser::GetPictureTicks(MakePicTimingSei(5), info));
+    ASSERT_EQ(6, H264Parser::GetPictureTicks(MakePicTimingSei(8), info));
+    ASSERT_EQ(0, H264Parser::GetPictureTicks(MakePicTimingSei(12), info));
+
+    // Without pic_struct_present_flag the SEI carries no pic_struct
+    H264VideoInfo no_pic_struct = H264Parser::ParseSPS(MakeH264Sps(false));
+    ASSERT_TRUE(no_pic_struct.timing_info_present);
+    ASSERT_EQ(0, H264Parser::GetPictureTicks(MakePicTimingSei(5), no_pic_struct));
+}
+
+void test_h265_vui_timing()
+{
+    H265VideoInfo info = H265Parser::ParseSPS(MakeH265Sps());
+    ASSERT_TRUE(info.valid);
+    ASSERT_EQ(1920, info.width);
+    ASSERT_EQ(1080, info.height);
+    ASSERT_TRUE(info.timing_info_present);
+    ASSERT_EQ(1001u, info.num_units_in_tick);
+    ASSERT_EQ(30000u, info.time_scale);
+}
+
+int main()
+{
+    TestSuite suite("Video Timing Tests");
+
+    suite.AddTest("H.264 VUI Timing", test_h264_vui_timing);
+    suite.AddTest("H.264 Picture Timing SEI", test_h264_pic_timing_sei);
+    suite.AddTest("H.265 VUI Timing", test_h265_vui_timing);
+
+    bool success = suite.RunAll();
+    return success ? 0 : 1;
+}